@@ -77,6 +77,7 @@ set(OGRE_SET_DISABLE_FREEIMAGE 0)
 set(OGRE_SET_DISABLE_DDS 0)
 set(OGRE_SET_DISABLE_PVRTC 0)
 set(OGRE_SET_DISABLE_ZIP 0)
+set(OGRE_SET_DISABLE_PACK 0)
 set(OGRE_SET_DISABLE_VIEWPORT_ORIENTATIONMODE 0)
 set(OGRE_SET_NEW_COMPILERS 0)
 set(OGRE_STATIC_LIB 0)
@@ -109,6 +110,9 @@ endif()
 if (NOT OGRE_CONFIG_ENABLE_ZIP)
   set(OGRE_SET_DISABLE_ZIP 1)
 endif()
+if (NOT OGRE_CONFIG_ENABLE_PACK)
+  set(OGRE_SET_DISABLE_PACK 1)
+endif()
 if (NOT OGRE_CONFIG_ENABLE_VIEWPORT_ORIENTATIONMODE)
   set(OGRE_SET_DISABLE_VIEWPORT_ORIENTATIONMODE 1)
 endif()
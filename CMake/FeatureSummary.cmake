@@ -111,6 +111,9 @@ endif ()
 if (OGRE_CONFIG_ENABLE_ZIP)
 	set(_core "${_core}  + ZIP archives\n")
 endif ()
+if (OGRE_CONFIG_ENABLE_PACK)
+	set(_core "${_core}  + Pack archives\n")
+endif ()
 if (OGRE_CONFIG_ENABLE_VIEWPORT_ORIENTATIONMODE)
 	set(_core "${_core}  + Viewport orientation mode support\n")
 endif ()
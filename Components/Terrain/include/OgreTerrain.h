@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "OgreTerrainMaterialGenerator.h"
 #include "OgreTerrainLayerBlendMap.h"
 #include "OgreWorkQueue.h"
+#include "OgreTiledImage.h"
 
 namespace Ogre
 {
@@ -355,6 +356,21 @@ namespace Ogre
 			*/
 			Image* inputImage;
 
+			/** Optional heightmap, read a region at a time, which is used when 
+				there's no inputImage.
+			@remarks
+				Only inputTiledRegion of it is read, so one very large heightmap
+				can be shared between the terrains of a group without ever being
+				held in memory all at once. If the region isn't terrainSize 
+				square it will be resized. The image is never deleted by this 
+				structure, whatever deleteInputData says, and must last until 
+				the terrain has been prepared.
+			*/
+			TiledImage* inputTiledImage;
+
+			/// The region of inputTiledImage to take the heights from
+			Box inputTiledRegion;
+
 			/** Optional list of terrainSize * terrainSize floats defining the terrain. 
 				The list of floats wil be interpreted such that the first row
 				in the array equates to the bottom row of vertices. 
@@ -399,6 +415,7 @@ namespace Ogre
 				, pos(Vector3::ZERO)
 				, worldSize(1000)
 				, inputImage(0)
+				, inputTiledImage(0)
 				, inputFloat(0)
 				, constantHeight(0)
 				, deleteInputData(false)
@@ -416,6 +433,7 @@ namespace Ogre
 				, pos(Vector3::ZERO)
 				, worldSize(1000)
 				, inputImage(0)
+				, inputTiledImage(0)
 				, inputFloat(0)
 				, constantHeight(0)
 				, deleteInputData(false)
@@ -435,6 +453,8 @@ namespace Ogre
 				pos = rhs.pos;
 				worldSize = rhs.worldSize;
 				constantHeight = rhs.constantHeight;
+				inputTiledImage = rhs.inputTiledImage;
+				inputTiledRegion = rhs.inputTiledRegion;
 				deleteInputData = rhs.deleteInputData;
 				inputScale = rhs.inputScale;
 				inputBias = rhs.inputBias;
@@ -214,6 +214,26 @@ namespace Ogre
 		*/
 		virtual void defineTerrain(long x, long y, const Image* img, const Terrain::LayerInstanceList* layers = 0);
 
+		/** Define the content of a 'slot' in the terrain grid, from part of a 
+			heightmap shared by many slots.
+		@remarks
+			The image covers a block of slots, with (originX, originY) the slot
+			taking its bottom left corner, and the slots up and to the right of 
+			it the rest; neighbouring slots share the row or column of pixels 
+			along their edge. Only the region for this slot is read, when the 
+			terrain is prepared, so the whole heightmap is never in memory at
+			once. 
+		@param x, y The coordinates of the terrain slot relative to the centre slot (signed).
+		@param img Heightfield image; this is not copied, and must last until the 
+			terrain has been loaded
+		@param originX, originY The slot at the bottom left of the image
+		@param layers Optional texture layers to use (if not supplied, default import
+			data layers will be used) - this data is copied during the
+			call so  you may destroy your copy afterwards.
+		*/
+		virtual void defineTerrain(long x, long y, TiledImage* img, long originX, long originY,
+			const Terrain::LayerInstanceList* layers = 0);
+
 		/** Define the content of a 'slot' in the terrain grid.
 		@remarks
 			At this stage the terrain instance isn't actually present in the grid, 
@@ -767,9 +767,21 @@ namespace Ogre
 					*dst++ = (*src++ * importData.inputScale) + importData.inputBias;
 			}
 		}
-		else if (importData.inputImage)
+		else if (importData.inputImage || importData.inputTiledImage)
 		{
 			Image* img = importData.inputImage;
+			Image region;
+			if (!img)
+			{
+				// Read just the part wanted, in the format it's stored in
+				const Box& box = importData.inputTiledRegion;
+				PixelFormat format = importData.inputTiledImage->getFormat();
+				size_t regionSize = PixelUtil::getMemorySize(box.getWidth(), box.getHeight(), 1, format);
+				uchar* data = OGRE_ALLOC_T(uchar, regionSize, MEMCATEGORY_GENERAL);
+				region.loadDynamicImage(data, box.getWidth(), box.getHeight(), 1, format, true);
+				importData.inputTiledImage->readRegion(box, region.getPixelBox());
+				img = &region;
+			}
 
 			if (img->getWidth() != mSize || img->getHeight() != mSize)
 				img->resize(mSize, mSize);
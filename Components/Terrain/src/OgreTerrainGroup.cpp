@@ -184,6 +184,42 @@ namespace Ogre
 
 	}
 	//---------------------------------------------------------------------
+	void TerrainGroup::defineTerrain(long x, long y, TiledImage* img, 
+		long originX, long originY, const Terrain::LayerInstanceList* layers /*= 0*/)
+	{
+		// The image is top down, slots go up in y
+		long step = mTerrainSize - 1;
+		long left = (x - originX) * step;
+		long top = static_cast<long>(img->getHeight()) - mTerrainSize - (y - originY) * step;
+		if (left < 0 || top < 0 || left + mTerrainSize > static_cast<long>(img->getWidth()) ||
+			top + mTerrainSize > static_cast<long>(img->getHeight()))
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Terrain slot " + StringConverter::toString(x) + ", " + 
+				StringConverter::toString(y) + " is outside the image",
+				"TerrainGroup::defineTerrain");
+		}
+
+		TerrainSlot* slot = getTerrainSlot(x, y, true);
+
+		slot->freeInstance();
+		slot->def.useImportData();
+
+		*slot->def.importData = mDefaultImportData;
+
+		// Copy all settings, but make sure our primary settings are immutable
+		slot->def.importData->inputTiledImage = img;
+		slot->def.importData->inputTiledRegion = Box(left, top, left + mTerrainSize, top + mTerrainSize);
+		if (layers)
+		{
+			// copy (held by value)
+			slot->def.importData->layerList = *layers;
+		}
+		slot->def.importData->terrainAlign = mAlignment;
+		slot->def.importData->terrainSize = mTerrainSize;
+		slot->def.importData->worldSize = mTerrainWorldSize;
+
+	}
 	void TerrainGroup::defineTerrain(long x, long y, const float* pFloat /*= 0*/, 
 		const Terrain::LayerInstanceList* layers /*= 0*/)
 	{
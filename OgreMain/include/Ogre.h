@@ -90,6 +90,7 @@ THE SOFTWARE.
 #include "OgreRenderTexture.h"
 #include "OgreRenderWindow.h"
 #include "OgreResourceBackgroundQueue.h"
+#include "OgreResourceBudgetManager.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreRibbonTrail.h"
 #include "OgreRoot.h"
@@ -109,6 +110,7 @@ THE SOFTWARE.
 #include "OgreSubMesh.h"
 #include "OgreTechnique.h"
 #include "OgreTextureManager.h"
+#include "OgreTextureStreamer.h"
 #include "OgreTextureUnitState.h"
 #include "OgreVector2.h"
 #include "OgreViewport.h"
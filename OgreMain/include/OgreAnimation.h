@@ -252,9 +252,11 @@ namespace Ogre {
 			(only affects pose animation)
 		@param software Whether to populate the software morph vertex data
 		@param hardware Whether to populate the hardware morph vertex data
+		@param batch Optional batch to add the software work to instead of 
+			performing it immediately
 		*/
 		void apply(Entity* entity, Real timePos, Real weight, bool software, 
-			bool hardware);
+			bool hardware, SoftwareAnimationBatch* batch = 0);
 
         /** Applies all numeric tracks given a specific time point and weight to the specified animable value.
         @remarks
@@ -387,6 +389,12 @@ namespace Ogre {
 		*/
 		void optimise(bool discardIdentityNodeTracks = true);
 
+		/** Pack the keyframes of all the node tracks in this animation.
+		@see NodeAnimationTrack::pack
+		*/
+		void packNodeTracks(Real translationTolerance = 0.001f, 
+			const Radian& rotationTolerance = Radian(0.001f), Real scaleTolerance = 0.001f);
+
         /// A list of track handles
         typedef set<ushort>::type TrackHandleList;
 
@@ -415,6 +423,14 @@ namespace Ogre {
             changed, which may cause it to rebuild some internal data */
         void _keyFrameListChanged(void) { mKeyFrameTimesDirty = true; }
 
+        /** Internal method to build the data which is otherwise built on demand
+            when the animation is next applied.
+        @remarks
+            Once this has been called, and until the animation is altered, it 
+            may be applied to different skeletons from several threads at once.
+        */
+        void _prepareForApply(void) const;
+
         /** Internal method used to convert time position to time index object.
         @note
             The time index returns by this function are associated with state of
@@ -375,8 +375,40 @@ namespace Ogre
 		/** Optimise the current track by removing any duplicate keyframes. */
 		virtual void optimise(void);
 
+		/** Replace the keyframes of this track with a compact, read-only
+			copy of them.
+		@remarks
+			Packed tracks take much less memory and are quicker to sample, but
+			their keys are always interpolated linearly and no keyframes can be
+			added to them afterwards. Keys which can be interpolated from their
+			neighbours within the tolerances given are dropped.
+		@see PackedTransformTrack
+		@param translationTolerance Maximum error in translation
+		@param rotationTolerance Maximum error in rotation
+		@param scaleTolerance Maximum error in scale
+		*/
+		virtual void pack(Real translationTolerance = 0.001f, 
+			const Radian& rotationTolerance = Radian(0.001f), Real scaleTolerance = 0.001f);
+
+		/** Returns whether this track has been packed. */
+		bool isPacked(void) const { return mPacked != 0; }
+
+		/** Gets the packed keys of this track, or null if it has not been packed. */
+		const PackedTransformTrack* getPackedData(void) const { return mPacked; }
+
+		/** Internal method to give this track packed keys, used when loading.
+		@remarks
+			The track takes ownership of the data, and should have no keyframes.
+		*/
+		void _setPackedData(PackedTransformTrack* packed);
+
 		/** Clone this track (internal use only) */
 		NodeAnimationTrack* _clone(Animation* newParent) const;
+
+		/** Internal method to rebuild the interpolation splines now if they are 
+			out of date, rather than the next time they are interpolated. */
+		void _buildInterpolationSplines(void) const
+		{ if (mSplineBuildNeeded) buildInterpolationSplines(); }
 		
 	protected:
 		/// Specialised keyframe creation
@@ -398,6 +430,8 @@ namespace Ogre
 		mutable bool mSplineBuildNeeded;
 		/// Defines if rotation is done using shortest path
 		mutable bool mUseShortestRotationPath ;
+		/// Packed keys, replacing the keyframes when set
+		PackedTransformTrack* mPacked;
 	};
 
 	/** Type of vertex animation.
@@ -515,10 +549,13 @@ namespace Ogre
 		virtual void apply(const TimeIndex& timeIndex, Real weight = 1.0, Real scale = 1.0f);
 
 		/** As the 'apply' method but applies to specified VertexData instead of 
-			associated data. */
+			associated data. 
+		@param batch Optional batch to add software animation work to instead
+			of performing it immediately
+		*/
 		virtual void applyToVertexData(VertexData* data, 
 			const TimeIndex& timeIndex, Real weight = 1.0, 
-			const PoseList* poseList = 0);
+			const PoseList* poseList = 0, SoftwareAnimationBatch* batch = 0);
 
 
 		/** Returns the morph KeyFrame at the specified index. */
@@ -561,7 +598,8 @@ namespace Ogre
 		KeyFrame* createKeyFrameImpl(Real time);
 
 		/// Utility method for applying pose animation
-		void applyPoseToVertexData(const Pose* pose, VertexData* data, Real influence);
+		void applyPoseToVertexData(const Pose* pose, VertexData* data, Real influence,
+			SoftwareAnimationBatch* batch);
 
 
 	};
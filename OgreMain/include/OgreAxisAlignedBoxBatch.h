@@ -0,0 +1,114 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __AxisAlignedBoxBatch_H__
+#define __AxisAlignedBoxBatch_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreOptimisedUtil.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Math
+	*  @{
+	*/
+
+	/** A batch of axis aligned boxes to be culled against a set of planes in
+		one go.
+	@remarks
+		Culling one box at a time spends most of its time loading the planes and 
+		branching on the results. This class stores the centres and half sizes of
+		the boxes added in separate component arrays, so that cull() can test 
+		several boxes per SIMD instruction (see OptimisedUtil::cullAxisAlignedBoxes).
+		The results are identical to testing each box with Plane::getSide; null 
+		boxes are never visible, infinite boxes always are.
+	@par
+		The storage is kept between uses, so reuse a batch (calling clear) rather 
+		than creating a new one each time.
+	*/
+	class _OgreExport AxisAlignedBoxBatch : public UtilityAlloc
+	{
+	public:
+		AxisAlignedBoxBatch();
+		~AxisAlignedBoxBatch();
+
+		/** Removes all the boxes, keeping the storage. */
+		void clear(void);
+
+		/** Adds a box to the batch, returning its index. */
+		size_t addBox(const AxisAlignedBox& box);
+
+		/** Gets the number of boxes in the batch. */
+		size_t getNumBoxes(void) const { return mNumBoxes; }
+
+		/** Tests every box in the batch against the given planes.
+		@remarks
+			A box is culled if it lies entirely on the negative side of any of 
+			the planes. Use isVisible to get the results.
+		*/
+		void cull(const Plane* planes, size_t numPlanes);
+
+		/** Tests a range of the boxes in the batch against the given planes, 
+			storing the results in the array given rather than in the batch.
+		@remarks
+			Since the batch is not modified, several threads may cull the same 
+			batch at once, for example against different cameras.
+		@param planes The planes to test against.
+		@param numPlanes Number of planes.
+		@param visible Array to store the results in, indexed by box index. 
+			Only the entries in the range tested are written.
+		@param first Index of the first box to test; a multiple of 4 is best
+			for performance.
+		@param count Number of boxes to test.
+		*/
+		void cull(const Plane* planes, size_t numPlanes, 
+			uchar* visible, size_t first, size_t count) const;
+
+		/** Gets whether a box survived the last call to cull. */
+		bool isVisible(size_t index) const { return mVisible[index] != 0; }
+
+	protected:
+		size_t mNumBoxes;
+		size_t mCapacity;
+		/// SIMD aligned storage for the component arrays
+		Real* mStorage;
+		OptimisedUtil::BoundsSoA mBounds;
+		/// The extent of each box, null and infinite boxes skip the test
+		vector<uchar>::type mExtents;
+		vector<uchar>::type mVisible;
+
+		/// Grow the storage to hold at least the given number of boxes
+		void reserve(size_t capacity);
+	};
+	/** @} */
+	/** @} */
+}
+
+#endif
@@ -42,6 +42,70 @@ namespace Ogre {
     */
     class Bitwise {
     public:
+        /** Reverses the byte order of a 16 bit value.
+        */
+        static FORCEINLINE uint16 bswap16(uint16 arg)
+        {
+            return static_cast<uint16>((arg >> 8) | (arg << 8));
+        }
+        /** Reverses the byte order of a 32 bit value.
+        */
+        static FORCEINLINE uint32 bswap32(uint32 arg)
+        {
+            return (arg >> 24) | ((arg >> 8) & 0xff00) |
+                ((arg << 8) & 0xff0000) | (arg << 24);
+        }
+        /** Reverses the byte order of a 64 bit value.
+        */
+        static FORCEINLINE uint64 bswap64(uint64 arg)
+        {
+            return (static_cast<uint64>(bswap32(static_cast<uint32>(arg))) << 32) |
+                bswap32(static_cast<uint32>(arg >> 32));
+        }
+        /** Reverses the byte order of count values of the given size in place.
+            @remarks
+                Values of 2, 4 and 8 bytes are swapped a whole word at a time,
+                in a loop simple enough for the compiler to vectorise. The
+                data need not be aligned.
+        */
+        static void bswapBuffer(void* pData, size_t size, size_t count)
+        {
+            unsigned char* p = static_cast<unsigned char*>(pData);
+            switch (size)
+            {
+            case 2:
+                for (size_t i = 0; i < count; ++i, p += 2)
+                {
+                    uint16 v;
+                    memcpy(&v, p, 2);
+                    v = bswap16(v);
+                    memcpy(p, &v, 2);
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < count; ++i, p += 4)
+                {
+                    uint32 v;
+                    memcpy(&v, p, 4);
+                    v = bswap32(v);
+                    memcpy(p, &v, 4);
+                }
+                break;
+            case 8:
+                for (size_t i = 0; i < count; ++i, p += 8)
+                {
+                    uint64 v;
+                    memcpy(&v, p, 8);
+                    v = bswap64(v);
+                    memcpy(p, &v, 8);
+                }
+                break;
+            default:
+                for (size_t i = 0; i < count; ++i, p += size)
+                    std::reverse(p, p + size);
+                break;
+            }
+        }
         /** Returns the most significant bit set in a value.
         */
         static FORCEINLINE unsigned int mostSignificantBitSet(unsigned int value)
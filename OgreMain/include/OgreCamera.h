@@ -598,6 +598,10 @@ namespace Ogre {
 
 		/// @copydoc Frustum::isVisible
 		bool isVisible(const AxisAlignedBox& bound, FrustumPlane* culledBy = 0) const;
+		/// @copydoc Frustum::isVisible(AxisAlignedBoxBatch&) const
+		void isVisible(AxisAlignedBoxBatch& bounds) const;
+		/// @copydoc Frustum::getCullingPlanes
+		size_t getCullingPlanes(Plane* planes) const;
 		/// @copydoc Frustum::isVisible
 		bool isVisible(const Sphere& bound, FrustumPlane* culledBy = 0) const;
 		/// @copydoc Frustum::isVisible
@@ -188,6 +188,12 @@ WARNING: Disabling this will make the samples unusable.
 #define OGRE_NO_ZIP_ARCHIVE 0
 #endif
 
+/** Disables use of the pack archive support.
+*/
+#ifndef OGRE_NO_PACK_ARCHIVE
+#define OGRE_NO_PACK_ARCHIVE 0
+#endif
+
 /** Enables the use of the new script compilers when Ogre compiles resource scripts.
 */
 #ifndef OGRE_USE_NEW_COMPILERS
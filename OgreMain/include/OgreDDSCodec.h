@@ -38,9 +38,7 @@ namespace Ogre {
 	*/
 
 	// Forward declarations
-	struct DXTColourBlock;
-	struct DXTExplicitAlphaBlock;
-	struct DXTInterpolatedAlphaBlock;
+	struct DDSHeader;
 
     /** Codec specialized in loading DDS (Direct Draw Surface) images.
 	@remarks
@@ -59,12 +57,16 @@ namespace Ogre {
 		PixelFormat convertPixelFormat(uint32 rgbBits, uint32 rMask, 
 			uint32 gMask, uint32 bMask, uint32 aMask) const;
 
-		/// Unpack DXT colours into array of 16 colour values
-		void unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, ColourValue* pCol) const;
-		/// Unpack DXT alphas into array of 16 colour values
-		void unpackDXTAlpha(const DXTExplicitAlphaBlock& block, ColourValue* pCol) const;
-		/// Unpack DXT alphas into array of 16 colour values
-		void unpackDXTAlpha(const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const;
+		/// Read and check the header, and work out the format to decode to
+		void readHeader(DataStreamPtr& stream, DDSHeader& header, ImageData* imgData, 
+			PixelFormat& sourceFormat, bool& decompressDXT, size_t& numFaces) const;
+		/// Size of one face of a mip level in the file
+		size_t getMipSourceSize(const DDSHeader& header, PixelFormat sourceFormat, 
+			size_t mip, size_t width, size_t height, size_t depth) const;
+		/// Decode one face of a mip level, advancing destPtr past it
+		void decodeMip(DataStreamPtr& stream, const DDSHeader& header, 
+			PixelFormat sourceFormat, PixelFormat destFormat, bool decompressDXT, 
+			size_t mip, size_t width, size_t height, size_t depth, void*& destPtr) const;
 
 		/// Single registered codec instance
 		static DDSCodec* msInstance;
@@ -78,6 +80,17 @@ namespace Ogre {
         void codeToFile(MemoryDataStreamPtr& input, const String& outFileName, CodecDataPtr& pData) const;
         /// @copydoc Codec::decode
         DecodeResult decode(DataStreamPtr& input) const;
+		/// @copydoc ImageCodec::decodeHeader
+		CodecDataPtr decodeHeader(DataStreamPtr& input) const;
+		/// @copydoc ImageCodec::decodeMipmaps
+		DecodeResult decodeMipmaps(DataStreamPtr& input, size_t firstMip) const;
+		/** @copydoc ImageCodec::createRegionReader
+		@remarks
+			Regions are read from the top level of the first face or slice.
+			Compressed images are read in PF_BYTE_RGBA, decompressing only 
+			the rows of blocks a region covers.
+		*/
+		ImageRegionReader* createRegionReader(DataStreamPtr& input) const;
 		/// @copydoc Codec::magicNumberToFileExt
 		String magicNumberToFileExt(const char *magicNumberPtr, size_t maxbytes) const;
         
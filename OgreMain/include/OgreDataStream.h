@@ -297,6 +297,15 @@ namespace Ogre {
 
         /** Close the stream; this makes further operations invalid. */
         virtual void close(void) = 0;
+
+		/** Returns a pointer to the data at the current position if the stream
+			is held in read-only memory which may be shared, or null otherwise.
+		@remarks
+			The memory remains valid for as long as the stream exists, so 
+			anything which keeps the pointer must also keep a reference to the 
+			stream. MemoryDataStream uses this to avoid copying such streams.
+		*/
+		virtual const uchar* getSharedMemory(void) const { return 0; }
 		
 
 	};
@@ -324,6 +333,11 @@ namespace Ogre {
 	    uchar* mEnd;
         /// Do we delete the memory on close
 		bool mFreeOnClose;			
+		/// The stream whose memory this one shares, if any
+		DataStreamPtr mSharedSource;
+
+		/// Share the memory of a source stream rather than copying it, if possible
+		bool shareMemory(const DataStreamPtr& sourceStream);
 	public:
 		
 		/** Wrap an existing memory chunk in a stream.
@@ -371,6 +385,11 @@ namespace Ogre {
 			This constructor can be used to intentionally read in the entire
 			contents of another stream, copying them to the internal buffer
 			and thus making them available in memory as a single unit.
+		@par
+			If this stream is read-only and the source is held in shared memory
+			(see DataStream::getSharedMemory), the memory is shared instead of 
+			being copied, and the source stream is kept alive until this one 
+			is closed.
 		@param sourceStream Weak reference to another DataStream which will provide the source
 			of data
 		@param freeOnClose If true, the memory associated will be destroyed
@@ -402,6 +421,11 @@ namespace Ogre {
         This constructor can be used to intentionally read in the entire
         contents of another stream, copying them to the internal buffer
         and thus making them available in memory as a single unit.
+        @par
+        If this stream is read-only and the source is held in shared memory
+        (see DataStream::getSharedMemory), the memory is shared instead of 
+        being copied, and the source stream is kept alive until this one 
+        is closed.
         @param name The name to give the stream
         @param sourceStream Another DataStream which will provide the source
         of data
@@ -412,6 +436,23 @@ namespace Ogre {
         MemoryDataStream(const String& name, const DataStreamPtr& sourceStream, 
             bool freeOnClose = true, bool readOnly = false);
 
+		/** Create a named read-only stream over part of the shared memory of
+			another stream, without copying it.
+		@remarks
+			The source stream is kept alive until this one is closed, and this
+			stream's memory is shared in turn (see DataStream::getSharedMemory).
+			The source is not read or moved, so several streams may be created
+			over one source at the same time.
+		@param name The name to give the stream
+		@param sourceStream A stream whose memory is shared, such as a 
+			MappedFileDataStream
+		@param pMem Pointer to the start of the part, within the memory of 
+			sourceStream
+		@param size The size of the part in bytes
+		*/
+		MemoryDataStream(const String& name, const DataStreamPtr& sourceStream, 
+			const uchar* pMem, size_t size);
+
         /** Create a stream with a brand new empty memory chunk.
 		@param size The size of the memory chunk to create in bytes
 		@param freeOnClose If true, the memory associated will be destroyed
@@ -473,6 +514,10 @@ namespace Ogre {
         */
         void close(void);
 
+		/** @copydoc DataStream::getSharedMemory
+		*/
+		const uchar* getSharedMemory(void) const { return mSharedSource.isNull() ? 0 : mPos; }
+
 		/** Sets whether or not to free the encapsulated memory on close. */
 		void setFreeOnClose(bool free) { mFreeOnClose = free; }
 	};
@@ -482,6 +527,36 @@ namespace Ogre {
     */
     typedef SharedPtr<MemoryDataStream> MemoryDataStreamPtr;
 
+	/** Specialisation of MemoryDataStream which maps a file into memory 
+		rather than reading it.
+	@remarks
+		The operating system reads the file as its pages are accessed, straight 
+		from its file cache, so no memory has to be allocated for the contents
+		and they are not copied. The stream is always read-only.
+	@par
+		Read-only MemoryDataStreams created from this stream share the mapped 
+		memory rather than copying it.
+	@see FileSystemArchive::setUseMappedFiles
+	*/
+	class _OgreExport MappedFileDataStream : public MemoryDataStream
+	{
+	public:
+		/** Map a file into memory.
+		@param name The name to give the stream
+		@param fileName The path of the file to map
+		*/
+		MappedFileDataStream(const String& name, const String& fileName);
+		~MappedFileDataStream();
+
+		/** @copydoc DataStream::getSharedMemory
+		*/
+		const uchar* getSharedMemory(void) const { return mData ? mPos : 0; }
+
+        /** @copydoc DataStream::close
+        */
+        void close(void);
+	};
+
     /** Common subclass of DataStream for handling data from 
 		std::basic_istream.
 	*/
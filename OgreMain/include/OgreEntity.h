@@ -267,8 +267,9 @@ namespace Ogre {
 		*/
 		bool calcVertexProcessing(void);
 	
-		/// Apply vertex animation
-		void applyVertexAnimation(bool hardwareAnimation, bool stencilShadows);
+		/// Apply vertex animation, adding the software work to batch if given
+		void applyVertexAnimation(bool hardwareAnimation, bool stencilShadows,
+			SoftwareAnimationBatch* batch = 0);
 		/// Initialise the hardware animation elements for given vertex data
 		void initHardwareAnimationElements(VertexData* vdata,
 			ushort numberOfElements);
@@ -685,6 +686,25 @@ namespace Ogre {
 		*/
 		void _updateAnimation(void);
 
+		/** Internal method which brings the bone matrices up to date, if the
+			animation has changed since they were last calculated.
+		@remarks
+			This only alters the skeleton instance of this entity (which may be
+			shared with other entities), so it may be called for entities with
+			different skeleton instances from several threads at once, once 
+			Skeleton::_prepareAnimationState has been called for each.
+		*/
+		void _updateBoneMatrices(void);
+
+		/** Internal method which updates the animation of the entity being 
+			displayed for this one (itself, or a manual LOD level) and queues 
+			the objects attached to its bones.
+		@remarks
+			Called from _updateRenderQueue, or later by the SceneManager if it
+			has deferred the animation so as to evaluate skeletons in parallel.
+		*/
+		void _updateAnimationAndQueueChildren(Entity* displayEntity, RenderQueue* queue);
+
         /** Tests if any animation applied to this entity.
         @remarks
             An entity is animated if any animation state is enabled, or any manual bone
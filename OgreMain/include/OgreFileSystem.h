@@ -116,7 +116,25 @@ namespace Ogre {
 			return ms_IgnoreHidden;
 		}
 
+		/** Set whether read-only files are opened as memory-mapped streams.
+		@remarks
+			Mapped streams let the OS page file contents in on demand and
+			let MemoryDataStream instances created from them share the mapping
+			instead of copying it. The default is false (use std::ifstream).
+		*/
+		static void setUseMappedFiles(bool useMapped)
+		{
+			ms_UseMappedFiles = useMapped;
+		}
+
+		/// Get whether read-only files are opened as memory-mapped streams.
+		static bool getUseMappedFiles()
+		{
+			return ms_UseMappedFiles;
+		}
+
 		static bool ms_IgnoreHidden;
+		static bool ms_UseMappedFiles;
     };
 
     /** Specialisation of ArchiveFactory for FileSystem files. */
@@ -439,6 +439,29 @@ namespace Ogre
         */
         virtual bool isVisible(const AxisAlignedBox& bound, FrustumPlane* culledBy = 0) const;
 
+        /** Tests whether each of a batch of bounding boxes is visible in the Frustum.
+            @remarks
+                Gives the same results as calling isVisible on each box in turn, but
+                tests several boxes at once. Subclasses which override 
+                isVisible(const AxisAlignedBox&) should override this as well.
+            @param
+                bounds The boxes to be checked (world space); the results are stored
+                in the batch
+        */
+        virtual void isVisible(AxisAlignedBoxBatch& bounds) const;
+
+        /** Gets the planes which bounds are tested against by isVisible.
+            @remarks
+                This is the frustum planes, less the far plane if the far distance
+                is infinite. The planes are brought up to date first, so they may 
+                be used to cull an AxisAlignedBoxBatch on another thread.
+            @param
+                planes Array of at least 6 planes to receive the culling planes
+            @returns
+                The number of planes
+        */
+        virtual size_t getCullingPlanes(Plane* planes) const;
+
         /** Tests whether the given container is visible in the Frustum.
             @param
                 bound Bounding sphere to be checked (world space)
@@ -447,19 +447,49 @@ namespace Ogre {
 			FILTER_BILINEAR,
 			FILTER_BOX,
 			FILTER_TRIANGLE,
-			FILTER_BICUBIC
+			FILTER_BICUBIC,
+			FILTER_KAISER,
+			FILTER_LANCZOS
 		};
 		/** Scale a 1D, 2D or 3D image volume. 
 			@param 	src			PixelBox containing the source pointer, dimensions and format
 			@param 	dst			PixelBox containing the destination pointer, dimensions and format
 			@param 	filter		Which filter to use
+			@param	gammaCorrect	Whether the colour channels are sRGB encoded, and should
+								be filtered in linear space. Ignored by FILTER_NEAREST.
 			@remarks 	This function can do pixel format conversion in the process.
+			@par
+				FILTER_BOX, FILTER_TRIANGLE, FILTER_BICUBIC (Catmull-Rom), FILTER_KAISER and
+				FILTER_LANCZOS are separable filters which are widened when shrinking the 
+				image, so that every source pixel contributes; Kaiser and Lanczos are the 
+				sharpest, and the slowest. Large images are split into bands of rows which 
+				are scaled in parallel on the threads of the WorkQueue, if Root exists.
 			@note	dst and src can point to the same PixelBox object without any problem
 		*/
-		static void scale(const PixelBox &src, const PixelBox &dst, Filter filter = FILTER_BILINEAR);
+		static void scale(const PixelBox &src, const PixelBox &dst, Filter filter = FILTER_BILINEAR,
+			bool gammaCorrect = false);
 		
 		/** Resize a 2D image, applying the appropriate filter. */
 		void resize(ushort width, ushort height, Filter filter = FILTER_BILINEAR);
+
+		/** Replace any mipmaps the image has with a full chain, down to 1x1.
+			@param	gammaCorrect	Whether the colour channels are sRGB encoded, as 
+								they are in most colour textures. Averaging the encoded
+								values instead darkens the smaller mipmaps.
+			@param	filter		Which filter to use; each level is made from the one above
+			@remarks
+				This works on every face of a cubemap, and reduces the depth of a
+				volume image too. Compressed images are not supported.
+		*/
+		void generateMipmaps(bool gammaCorrect = false, Filter filter = FILTER_BOX);
+
+		/** Convert every face and mipmap of the image to another pixel format.
+			@remarks
+				This is the way to compress an image, to PF_DXT1 to PF_DXT5, before
+				saving it as a DDS file or loading it into a texture. Any other
+				conversion PixelUtil::bulkPixelConversion supports can be done too.
+		*/
+		void convert(PixelFormat format);
 		
         // Static function to calculate size in bytes from the number of mipmaps, faces and the dimensions
         static size_t calculateSize(size_t mipmaps, size_t faces, size_t width, size_t height, size_t depth, PixelFormat format);
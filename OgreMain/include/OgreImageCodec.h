@@ -33,6 +33,8 @@ THE SOFTWARE.
 
 namespace Ogre {
 
+	class ImageRegionReader;
+
 	/** \addtogroup Core
 	*  @{
 	*/
@@ -80,6 +82,42 @@ namespace Ogre {
         {
             return "ImageData";
         }
+
+		/** Read the description of an image without decoding its pixels.
+		@remarks
+			The ImageData returned has the dimensions, format, mipmap count 
+			and size the image would have if it were decoded. The default 
+			implementation decodes the whole image, codecs whose format 
+			allows it should override this to read only the header.
+		*/
+		virtual CodecDataPtr decodeHeader(DataStreamPtr& input) const;
+
+		/** Decode only the smaller mipmaps of an image.
+		@remarks
+			This skips the mipmaps larger than firstMip, so that a texture can 
+			be made usable from the tail of its mipmap chain before the full 
+			size image has been read. The ImageData returned describes the 
+			decoded levels, so its width and height are those of firstMip. 
+			The default implementation decodes the whole image and then 
+			copies out the levels wanted; codecs whose format stores 
+			mipmaps at known offsets should override this to skip the data.
+		@param input The stream to decode from
+		@param firstMip The largest mipmap to decode, clamped to the 
+			number of mipmaps in the image
+		*/
+		virtual DecodeResult decodeMipmaps(DataStreamPtr& input, size_t firstMip) const;
+
+		/** Make a reader for regions of an image, for reading an image too 
+			large to decode all at once.
+		@remarks
+			The reader keeps the stream, and reads only the parts of it it
+			needs; the stream must support seeking. The default 
+			implementation returns 0, meaning the format can't be read a 
+			region at a time; TiledImage then decodes the whole image.
+		@returns
+			A reader created with OGRE_NEW which the caller must delete, or 0
+		*/
+		virtual ImageRegionReader* createRegionReader(DataStreamPtr& input) const;
     };
 
 	/** @} */
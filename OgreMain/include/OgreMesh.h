@@ -721,11 +721,14 @@ namespace Ogre {
         @param numMatrices Number of matrices in the blendMatrices, it might be used
             as a hint for optimisation.
         @param blendNormals If true, normals are blended as well as positions
+        @param batch Optional batch to add the work to instead of doing it 
+            immediately, in which case the buffers stay locked and the 
+            target isn't written until the batch is executed
         */
         static void softwareVertexBlend(const VertexData* sourceVertexData, 
             const VertexData* targetVertexData,
             const Matrix4* const* blendMatrices, size_t numMatrices,
-            bool blendNormals);
+            bool blendNormals, SoftwareAnimationBatch* batch = 0);
 
         /** Performs a software vertex morph, of the kind used for
             morph animation although it can be used for other purposes. 
@@ -738,11 +741,13 @@ namespace Ogre {
 		@param targetVertexData VertexData destination; assumed to have a separate position
 			buffer already bound, and the number of vertices must agree with the
 			number in start and end
+		@param batch Optional batch to add the work to instead of doing it 
+			immediately, see softwareVertexBlend
 		*/
         static void softwareVertexMorph(Real t, 
             const HardwareVertexBufferSharedPtr& b1, 
 			const HardwareVertexBufferSharedPtr& b2, 
-			VertexData* targetVertexData);
+			VertexData* targetVertexData, SoftwareAnimationBatch* batch = 0);
 
         /** Performs a software vertex pose blend, of the kind used for
             morph animation although it can be used for other purposes. 
@@ -757,10 +762,13 @@ namespace Ogre {
 		@param targetVertexData VertexData destination; assumed to have a separate position
 			buffer already bound, and the number of vertices must agree with the
 			number in start and end
+		@param batch Optional batch to add the work to instead of doing it 
+			immediately, see softwareVertexBlend; the offset map must then 
+			still exist when the batch is executed
 		*/
 		static void softwareVertexPoseBlend(Real weight, 
 			const map<size_t, Vector3>::type& vertexOffsetMap,
-			VertexData* targetVertexData);
+			VertexData* targetVertexData, SoftwareAnimationBatch* batch = 0);
         /** Gets a reference to the optional name assignments of the SubMeshes. */
         const SubMeshNameMap& getSubMeshNameMap(void) const { return mSubMeshNameMap; }
 
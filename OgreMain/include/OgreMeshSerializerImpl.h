@@ -145,6 +145,8 @@ namespace Ogre {
         virtual void readMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readSubMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh, 
             SubMesh* sub);
+        /// Reads the body of a bone assignment chunk in one go
+        void readBoneAssignment(DataStreamPtr& stream, VertexBoneAssignment& assign);
         virtual void readMeshLodInfo(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readMeshLodUsageManual(DataStreamPtr& stream, Mesh* pMesh, 
             unsigned short lodNum, MeshLodUsage& usage);
@@ -76,6 +76,8 @@ namespace Ogre {
         typedef HashMap<String, Node*> ChildNodeMap;
         typedef MapIterator<ChildNodeMap> ChildNodeIterator;
 		typedef ConstMapIterator<ChildNodeMap> ConstChildNodeIterator;
+		/// List of children to update, with the 'parentHasChanged' flag to pass to each
+		typedef vector<std::pair<Node*, bool> >::type PendingChildUpdateList;
 
 		/** Listener which gets called back on Node events.
 		*/
@@ -234,6 +236,9 @@ namespace Ogre {
 		/// User objects binding.
 		UserObjectBindings mUserObjectBindings;
 
+		/// Needs access to the pending update flags
+		friend class NodeTransformBatch;
+
     public:
         /** Constructor, should only be called by parent, not directly.
         @remarks
@@ -652,6 +657,30 @@ namespace Ogre {
         */
         virtual void _update(bool updateChildren, bool parentHasChanged);
 
+        /** Internal method to update this Node alone, gathering the children which need
+            updating instead of recursing into them.
+            @remarks
+                This does the same work as _update(true, parentHasChanged) for this node,
+                but rather than updating the children it appends them to the list
+                along with the parentHasChanged flag each must be passed to _update. 
+                The subtrees below sibling nodes share no state, so a SceneManager can
+                use this to update them separately, e.g. on different threads.
+            @note
+                Derived classes which add work to _update must perform it themselves
+                once the gathered children have been updated.
+        */
+        virtual void _updateSelf(bool parentHasChanged, PendingChildUpdateList& childUpdates);
+
+        /** Internal method to set the derived transform of this Node directly.
+            @remarks
+                Used when the derived transform has been calculated elsewhere, e.g. in
+                bulk by NodeTransformBatch. The values must be the same as those 
+                _updateFromParent would calculate. This has the same side effects as
+                _updateFromParent, but leaves the children alone.
+        */
+        virtual void _setDerivedTransform(const Quaternion& orientation,
+            const Vector3& position, const Vector3& scale);
+
         /** Sets a listener for this Node.
 		@remarks
 			Note for size and performance reasons only one listener per node is
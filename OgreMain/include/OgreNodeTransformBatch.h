@@ -0,0 +1,169 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreNodeTransformBatch_H__
+#define __OgreNodeTransformBatch_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreOptimisedUtil.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Scene
+	*  @{
+	*/
+
+	/** Updates the derived transforms of a node hierarchy in bulk.
+	@remarks
+		The normal Node::_update walks the hierarchy depth first and updates each
+		node on its own, which spends most of the time chasing pointers rather 
+		than doing arithmetic. This class keeps a structure-of-arrays copy of 
+		the transforms below a root node, laid out breadth first so that all the
+		nodes at the same depth are contiguous. Each level is then concatenated 
+		with its parents in one call to OptimisedUtil::concatenateTransformsSoA,
+		which processes several nodes per SIMD instruction.
+	@par
+		The nodes remain the owners of their transforms; local transforms are 
+		copied in for the nodes which need updating and the derived transforms 
+		are written back afterwards, through Node::_setDerivedTransform. The 
+		same nodes are updated as by Node::_update(true, false) on the root, and 
+		with bit-identical results. 
+	@par
+		The layout is only rebuilt when _notifyHierarchyChanged has been called,
+		which the owner must do whenever nodes are attached or detached below 
+		the root.
+	*/
+	class _OgreExport NodeTransformBatch : public NodeAlloc
+	{
+	public:
+		typedef vector<Node*>::type NodeList;
+
+		/** Constructor.
+		@param root The root of the hierarchy to update
+		*/
+		NodeTransformBatch(Node* root);
+		virtual ~NodeTransformBatch();
+
+		/** Gets the root of the hierarchy updated by this batch. */
+		Node* getRootNode(void) const { return mRoot; }
+
+		/** Tells the batch that nodes have been attached or detached somewhere
+			in the hierarchy.
+		@remarks
+			The layout will be rebuilt, and every node updated, on the next 
+			call to update().
+		*/
+		void _notifyHierarchyChanged(void) { mLayoutOutOfDate = true; }
+
+		/** Updates the derived transforms of the hierarchy.
+		@remarks
+			Has the same effect on the nodes as calling _update(true, false) on 
+			the root node, except for any work subclasses add to _update, such as
+			SceneNode bounds; use getUpdatedNodes to perform that afterwards.
+		*/
+		void update(void);
+
+		/** Gets the nodes visited by the last update, in breadth first order.
+		@remarks
+			These are the nodes _update would have been called on; iterate 
+			in reverse to visit children before their parents.
+		*/
+		const NodeList& getUpdatedNodes(void) const { return mUpdatedNodes; }
+
+		/** Gets the number of nodes in the current layout. */
+		size_t getNumNodes(void) const { return mNumNodes; }
+
+	protected:
+		/// Number of transforms processed per SIMD operation, levels are padded to this
+		static const size_t BLOCK_SIZE = 4;
+		/// Number of Real components in a transform
+		static const size_t NUM_COMPONENTS = 10;
+		/// Marks the root node, which has no parent in the layout
+		static const size_t NO_PARENT;
+
+		/// A range of slots holding the nodes at one depth
+		struct Level
+		{
+			size_t start;
+			size_t count;
+		};
+		typedef vector<Level>::type LevelList;
+		typedef vector<size_t>::type IndexList;
+		typedef vector<char>::type FlagList;
+
+		Node* mRoot;
+		bool mLayoutOutOfDate;
+		size_t mNumNodes;
+
+		/// Node in each slot, null for padding
+		NodeList mNodes;
+		/// Slot of the parent of each slot
+		IndexList mParents;
+		LevelList mLevels;
+		/// Whether the derived transform of each slot must be recalculated
+		FlagList mSelfDirty;
+		/// Whether the children of each slot must recalculate their transforms
+		FlagList mChildrenDirty;
+		/// Whether each slot is visited by the update
+		FlagList mVisited;
+		/// Inheritance flags of each slot, copied with the local transform
+		FlagList mInheritOrientation;
+		FlagList mInheritScale;
+		NodeList mUpdatedNodes;
+
+		/// Number of slots allocated
+		size_t mCapacity;
+		/// SIMD aligned storage for all the component arrays
+		Real* mStorage;
+		OptimisedUtil::TransformSoA mLocal;
+		OptimisedUtil::TransformSoA mDerived;
+		/// Parent transforms gathered for the level being processed
+		OptimisedUtil::TransformSoA mParentScratch;
+
+		/// Rebuild the breadth first layout
+		void buildLayout(void);
+		/// Make sure there is storage for at least the given number of slots
+		void reserveStorage(size_t capacity);
+		/// Set a slot to the identity transform in the given arrays
+		void setIdentity(const OptimisedUtil::TransformSoA& soa, size_t slot);
+		/// Copy the local transform of a node into a slot
+		void gatherLocal(const Node* node, size_t slot);
+		/// Set up the pending update flags of each slot and copy in changed transforms
+		bool gatherChanges(bool forceAll);
+		/// Calculate the derived transforms of one level
+		void updateLevel(const Level& level);
+		/// Write back the derived transforms and clear the update flags
+		void scatterChanges(void);
+	};
+	/** @} */
+	/** @} */
+}
+
+#endif
@@ -71,6 +71,28 @@ namespace Ogre {
         */
         static OptimisedUtil* getImplementation(void) { return msImplementation; }
 
+        /// The implementations which may be built in
+        enum ImplementationType
+        {
+            /// Plain C++, always available
+            IT_GENERAL,
+            /// SSE, for x86 CPUs with single precision builds
+            IT_SSE,
+            /// AVX, for x86 CPUs with single precision builds
+            IT_AVX
+        };
+
+        /** Gets a specific implementation of this class, whether or not it is
+            the one getImplementation returns.
+        @remarks
+            This is meant for testing and benchmarking the implementations
+            against each other.
+        @returns
+            The implementation, or null if it isn't built in or isn't supported
+            by the CPU and OS.
+        */
+        static OptimisedUtil* _getImplementation(ImplementationType type);
+
         /** Performs software vertex skinning.
         @param srcPosPtr Pointer to source position buffer.
         @param destPosPtr Pointer to destination position buffer.
@@ -199,6 +221,76 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices) = 0;
+
+        /** Structure-of-arrays view of a set of node transforms.
+        @remarks
+            Each component is stored in a separate array, so that several
+            transforms can be processed in a single SIMD operation.
+        */
+        struct TransformSoA
+        {
+            /// Orientation components, in w, x, y, z order
+            Real* orientation[4];
+            /// Position components, in x, y, z order
+            Real* position[3];
+            /// Scale components, in x, y, z order
+            Real* scale[3];
+        };
+
+        /** Concatenate an array of local transforms with an array of parent
+            transforms, in the same way as Node does.
+        @remarks
+            For each element, the derived orientation is parent orientation *
+            local orientation, the derived scale is parent scale * local scale,
+            and the derived position is parent orientation * (parent scale *
+            local position) + parent position. Results are bit-identical to
+            those computed by Node::_getDerivedPosition and friends.
+        @param parent The parent (derived) transforms.
+        @param local The local transforms.
+        @param derived The arrays to store the concatenated transforms, which
+            may alias the local arrays.
+        @param numTransforms Number of transforms to concatenate.
+        @note
+            All arrays should be aligned to SIMD alignment for best performance.
+        */
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms) = 0;
+
+        /** Structure-of-arrays view of a set of axis aligned boxes.
+        */
+        struct BoundsSoA
+        {
+            /// Box centre components, in x, y, z order
+            Real* centre[3];
+            /// Box half size components, in x, y, z order
+            Real* halfSize[3];
+        };
+
+        /** Test an array of axis aligned boxes against a set of planes.
+        @remarks
+            A box is culled if it lies entirely on the negative side of any of
+            the planes, in the same way as Plane::getSide(centre, halfSize)
+            returning Plane::NEGATIVE_SIDE. Results are identical to that test.
+        @param planes The planes to test against.
+        @param numPlanes Number of planes.
+        @param boxes The centres and half sizes of the boxes, which must be
+            finite.
+        @param visible An array of flags to store the results, 1 if the
+            corresponding box is not culled by any plane, 0 otherwise.
+        @param numBoxes Number of boxes to test.
+        @note
+            The box arrays should be aligned to SIMD alignment for best
+            performance.
+        */
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes) = 0;
     };
 
     /** Returns raw offseted of the given pointer.
@@ -0,0 +1,315 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __PackArchive_H__
+#define __PackArchive_H__
+
+#include "OgrePrerequisites.h"
+
+#include "OgreArchive.h"
+#include "OgreArchiveFactory.h"
+#include "OgreDataStream.h"
+
+namespace Ogre {
+
+	class ParallelTaskGroup;
+
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Resources
+	*  @{
+	*/
+	/** Specialisation of the Archive class to allow reading of files from a 
+		single pre-built pack file.
+	@remarks
+		Pack files are built offline (see PackArchiveWriter and the 
+		OgreArchivePacker tool) and are laid out so that they can be used 
+		directly from a memory mapping of the file: a header is followed by the
+		file data, and then by a hashed name table, the entry and block tables 
+		and the file names. Loading the archive therefore only maps the file and
+		builds the file list; opening a file is a hash lookup.
+	@par
+		Each file is split into blocks of a fixed uncompressed size, each of 
+		which is either stored or deflated independently. Files which are 
+		stored are returned as streams sharing the mapped memory, so no copy is
+		made; compressed files with several blocks are decompressed in parallel
+		using a ParallelTaskGroup on the Root WorkQueue.
+	@par
+		Since the archive contents are never modified after load, open() needs 
+		no locking and can be called concurrently from several threads. As with
+		other archives, the streams returned must not be used once the 
+		archive has been unloaded.
+	@note
+		Pack files are written in little-endian byte order, and can only be 
+		read on little-endian platforms.
+	*/
+	class _OgreExport PackArchive : public Archive 
+	{
+	public:
+		/// Identifies a pack file ('OPAK')
+		static const uint32 MAGIC;
+		/// Current version of the pack file format
+		static const uint32 VERSION;
+
+		/// Compression methods for a block
+		enum CompressionMethod
+		{
+			/// Block data is stored uncompressed
+			CM_STORED = 0,
+			/// Block data is compressed with zlib
+			CM_DEFLATE = 1
+		};
+
+		/// Pack file header, at the start of the file
+		struct Header
+		{
+			uint32 magic;
+			uint32 version;
+			uint32 numEntries;
+			/// Number of slots in the name hash table, a power of 2
+			uint32 numBuckets;
+			uint32 numBlocks;
+			/// Uncompressed size of every block except the last of each file
+			uint32 blockSize;
+			/// Size of the file name table in bytes
+			uint32 namesSize;
+			uint32 reserved;
+			/// Offset of the tables from the start of the file, 8 byte aligned
+			uint64 tableOffset;
+		};
+
+		/// Entry table record, one per file
+		struct Entry
+		{
+			/// Offset of the null terminated name in the name table
+			uint32 nameOffset;
+			uint32 nameLength;
+			/// Offset of the file data from the start of the pack file
+			uint64 dataOffset;
+			uint32 size;
+			uint32 compressedSize;
+			/// Index of the first block of this file in the block table
+			uint32 firstBlock;
+			uint32 modifiedTime;
+		};
+
+		/// Name hash table slot; slots are probed linearly from the hash
+		struct Bucket
+		{
+			uint32 hash;
+			/// Index of the entry plus one, or 0 for an empty slot
+			uint32 entry;
+		};
+
+		/// Block table record, blocks of a file are stored consecutively
+		struct Block
+		{
+			uint32 compressedSize;
+			/// CompressionMethod used for this block
+			uint32 method;
+		};
+
+		PackArchive(const String& name, const String& archType );
+		~PackArchive();
+
+		/// @copydoc Archive::isCaseSensitive
+		bool isCaseSensitive(void) const { return false; }
+
+		/// @copydoc Archive::load
+		void load();
+		/// @copydoc Archive::unload
+		void unload();
+
+		/// @copydoc Archive::open
+		DataStreamPtr open(const String& filename, bool readOnly = true) const;
+
+		/// @copydoc Archive::create
+		DataStreamPtr create(const String& filename) const;
+
+		/// @copydoc Archive::remove
+		void remove(const String& filename) const;
+
+		/// @copydoc Archive::list
+		StringVectorPtr list(bool recursive = true, bool dirs = false);
+
+		/// @copydoc Archive::listFileInfo
+		FileInfoListPtr listFileInfo(bool recursive = true, bool dirs = false);
+
+		/// @copydoc Archive::find
+		StringVectorPtr find(const String& pattern, bool recursive = true,
+			bool dirs = false);
+
+		/// @copydoc Archive::findFileInfo
+		FileInfoListPtr findFileInfo(const String& pattern, bool recursive = true,
+			bool dirs = false);
+
+		/// @copydoc Archive::exists
+		bool exists(const String& filename);
+
+		/// @copydoc Archive::getModifiedTime
+		time_t getModifiedTime(const String& filename);
+
+		/** Set the minimum uncompressed size of a file for its blocks to be
+			decompressed in parallel; smaller files are decompressed on the 
+			calling thread. The default is 256KB.
+		*/
+		static void setParallelThreshold(size_t bytes)
+		{
+			ms_ParallelThreshold = bytes;
+		}
+
+		/// Get the minimum size of a file for its blocks to be decompressed in parallel.
+		static size_t getParallelThreshold()
+		{
+			return ms_ParallelThreshold;
+		}
+
+		/** Hash a file name for lookup in the name table.
+		@remarks
+			Names are hashed case insensitively, with backslashes treated as
+			forward slashes.
+		*/
+		static uint32 hashName(const String& name);
+
+		static size_t ms_ParallelThreshold;
+
+	protected:
+		/// The mapped pack file
+		DataStreamPtr mMapping;
+		const uchar* mData;
+		const Header* mHeader;
+		const Bucket* mBuckets;
+		const Entry* mEntries;
+		const Block* mBlocks;
+		const char* mNames;
+		/// File list, built on load
+		FileInfoList mFileList;
+		/// Task group used to decompress large files
+		ParallelTaskGroup* mTaskGroup;
+		OGRE_MUTEX(mTaskGroupMutex)
+
+		class DecompressTask;
+		friend class DecompressTask;
+
+		/// Look up the entry for a file, or null if it is not in the archive
+		const Entry* findEntry(const String& filename) const;
+		/// Decompress the blocks [first, first+count) of an entry into dest
+		bool decompressBlocks(const Entry& entry, uint32 first, uint32 count, 
+			uchar* dest) const;
+		/// Decompress a whole entry into dest, in parallel if it is large enough
+		bool decompressEntry(const Entry& entry, uchar* dest) const;
+		/// Get the number of blocks an entry is split into
+		uint32 getNumBlocks(const Entry& entry) const;
+		/// Throw an exception describing a malformed pack file
+		void throwCorrupt(const String& reason) const;
+	};
+
+	/** Specialisation of ArchiveFactory for pack files. */
+	class _OgrePrivate PackArchiveFactory : public ArchiveFactory
+	{
+	public:
+		virtual ~PackArchiveFactory() {}
+		/// @copydoc FactoryObj::getType
+		const String& getType(void) const;
+		/// @copydoc FactoryObj::createInstance
+		Archive *createInstance( const String& name ) 
+		{
+			return OGRE_NEW PackArchive(name, "Pack");
+		}
+		/// @copydoc FactoryObj::destroyInstance
+		void destroyInstance( Archive* arch) { OGRE_DELETE arch; }
+	};
+
+	/** Builds pack files which can be read by PackArchive.
+	@remarks
+		Files are added from streams or from other archives, and are only read
+		when write() is called, so that packing a large tree does not require
+		all of it to be held in memory at once.
+	*/
+	class _OgreExport PackArchiveWriter : public ArchiveAlloc
+	{
+	public:
+		/** Constructor.
+		@param blockSize The uncompressed size of each block; larger blocks
+			compress better, smaller ones give more parallelism when decompressing
+		@param compressionLevel The zlib compression level, from 0 (store all
+			blocks uncompressed) to 9 (best compression)
+		*/
+		PackArchiveWriter(uint32 blockSize = 65536, int compressionLevel = 6);
+
+		/** Add a file whose contents will be read from a stream.
+		@param name The name of the file in the pack
+		@param stream The stream to read; it is read from the current position
+		@param modifiedTime The modification time to record for the file
+		*/
+		void addFile(const String& name, const DataStreamPtr& stream, 
+			time_t modifiedTime = 0);
+
+		/** Add a file which will be read from an archive.
+		@note The archive must stay loaded until write() has been called.
+		*/
+		void addFile(const String& name, Archive* archive, const String& filename);
+
+		/** Add all the files in an archive.
+		@param archive The source archive, which must stay loaded until 
+			write() has been called
+		@param prefix A path to prepend to the name of every file
+		@returns The number of files added
+		*/
+		size_t addArchive(Archive* archive, const String& prefix = StringUtil::BLANK);
+
+		/// Get the number of files which have been added
+		size_t getNumFiles(void) const { return mFiles.size(); }
+
+		/** Write the pack file.
+		@returns The total size of the file data after compression
+		*/
+		uint64 write(const String& fileName);
+
+	protected:
+		struct PendingFile
+		{
+			String name;
+			DataStreamPtr stream;
+			Archive* archive;
+			String sourceName;
+			time_t modifiedTime;
+		};
+		typedef vector<PendingFile>::type PendingFileList;
+
+		uint32 mBlockSize;
+		int mCompressionLevel;
+		PendingFileList mFiles;
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __PackedTransformTrack_H__
+#define __PackedTransformTrack_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreAnimation.h"
+#include "OgreVector3.h"
+#include "OgreQuaternion.h"
+
+namespace Ogre 
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Animation
+	*  @{
+	*/
+
+	/** A compact, read-only copy of the keyframes of a NodeAnimationTrack.
+	@remarks
+		Rather than one heap allocated TransformKeyFrame per key, translation,
+		rotation and scale are each held as a channel of contiguous arrays: 
+		the key times, and 3 16-bit values per key. Translation and scale are 
+		quantised within the range of the channel, rotations use the 
+		'smallest three' encoding (the largest component is dropped and 
+		rebuilt from the other three).
+	@par
+		Each channel keeps only the keys it needs to reproduce the original
+		track within the given tolerances, so a constant channel takes a 
+		single key, and keys which can be interpolated from their neighbours
+		are dropped. Keys are always interpolated linearly, and rotations 
+		always take the shortest path; spline interpolated tracks get extra 
+		keys between the original ones where the curve needs them.
+	@see NodeAnimationTrack::pack
+	*/
+	class _OgreExport PackedTransformTrack : public AnimationAlloc
+	{
+	public:
+		/// The channels of a track
+		enum ChannelType
+		{
+			CT_TRANSLATE = 0,
+			CT_ROTATE = 1,
+			CT_SCALE = 2,
+			CT_COUNT = 3
+		};
+
+		/// The keys of a single channel
+		struct Channel
+		{
+			/// Time of each key, ascending
+			vector<float>::type times;
+			/// 3 values per key
+			vector<uint16>::type values;
+			/// Minimum of the channel (translation and scale only)
+			Vector3 base;
+			/// Extent of the channel (translation and scale only)
+			Vector3 range;
+		};
+
+		PackedTransformTrack();
+
+		/** Build the packed keys from a track.
+		@remarks
+			The source track is sampled with the interpolation mode of its
+			parent animation, so spline tracks are fitted too.
+		@param track The track to pack, which must have at least one keyframe
+		@param translationTolerance Maximum distance a packed translation 
+			may be from the original
+		@param rotationTolerance Maximum angle a packed rotation may be
+			from the original
+		@param scaleTolerance Maximum difference between a packed scale and 
+			the original
+		*/
+		void build(const NodeAnimationTrack* track, Real translationTolerance,
+			const Radian& rotationTolerance, Real scaleTolerance);
+
+		/** Sample the track at a given time.
+		@param timePos The time position, wrapped into the animation length
+		@param length The length of the animation
+		@param rim How rotations are to be interpolated
+		@param kf Receives the transform
+		*/
+		void sample(Real timePos, Real length, 
+			Animation::RotationInterpolationMode rim, TransformKeyFrame* kf) const;
+
+		/// Get a channel
+		Channel& getChannel(ChannelType type) { return mChannels[type]; }
+		/// Get a channel
+		const Channel& getChannel(ChannelType type) const { return mChannels[type]; }
+		/// Get the number of keys in a channel
+		size_t getNumKeys(ChannelType type) const { return mChannels[type].times.size(); }
+
+		/** Get the times at which any channel has a key, in order.
+		@remarks
+			Keyframes sampled at these times reproduce the packed track, so 
+			this is how to turn it back into keyframes, e.g. for export.
+		*/
+		void getKeyTimes(vector<Real>::type& times) const;
+
+		/** Returns whether any key does something, as 
+			NodeAnimationTrack::hasNonZeroKeyFrames. */
+		bool hasNonZeroKeyFrames(void) const;
+
+		/// Calculate the memory used, in bytes
+		size_t calculateSize(void) const;
+
+		/// Encode a rotation into 3 values
+		static void packRotation(const Quaternion& q, uint16* values);
+		/// Decode a rotation from 3 values
+		static Quaternion unpackRotation(const uint16* values);
+
+	protected:
+		Channel mChannels[CT_COUNT];
+
+		/// Quantise a vector into 3 values
+		static void packVector(const Vector3& v, const Vector3& base, 
+			const Vector3& range, uint16* values);
+		/// Get a key of a channel as a vector
+		Vector3 getVectorKey(ChannelType type, size_t index) const;
+		/// Get a key of the rotation channel
+		Quaternion getRotationKey(size_t index) const;
+		/** Find the keys either side of a time.
+		@returns The interpolation factor between the keys
+		*/
+		Real findKeys(const Channel& channel, Real timePos, Real length, 
+			size_t& key1, size_t& key2) const;
+	};
+	/** @} */
+	/** @} */
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreParallelTaskGroup_H__
+#define __OgreParallelTaskGroup_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreWorkQueue.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup General
+	*  @{
+	*/
+
+	/** Runs a batch of independent tasks on the WorkQueue's worker threads and
+		waits for all of them to complete.
+	@remarks
+		The WorkQueue is designed for asynchronous request / response work which
+		is picked up in a later frame; many per-frame engine operations however
+		need a fork / join style of parallelism, where a batch of work is split 
+		up, run on all available cores and the results are needed immediately.
+		This class provides that on top of the shared WorkQueue, so that no 
+		additional thread pool is required.
+	@par
+		When run() is called, a number of 'helper' requests are placed on the 
+		WorkQueue, and the calling thread starts executing tasks itself. Each 
+		helper which is picked up by a worker thread pulls tasks from the same 
+		list until it is exhausted. run() only returns when every task has been
+		executed, so tasks may safely reference data owned by the caller. 
+		Because the calling thread always participates, the result is correct 
+		even if no worker thread is free (or the queue has not been started);
+		in that case the tasks are simply executed serially.
+	@par
+		Tasks must be independent of each other, and must not make calls which 
+		are not threadsafe (in particular, no render system calls).
+	*/
+	class _OgreExport ParallelTaskGroup : public WorkQueue::RequestHandler, 
+		public WorkQueue::ResponseHandler, public UtilityAlloc
+	{
+	public:
+		/** A unit of work executed by a ParallelTaskGroup. */
+		class _OgreExport Task
+		{
+		public:
+			virtual ~Task() {}
+			/** Perform the work; this may be called on any thread. */
+			virtual void execute() = 0;
+		};
+		typedef vector<Task*>::type TaskList;
+
+		/** Constructor.
+		@param name Name of the group, used to allocate a WorkQueue channel
+		@param queue The WorkQueue to use, or null to use the one from Root
+		*/
+		ParallelTaskGroup(const String& name, WorkQueue* queue = 0);
+		virtual ~ParallelTaskGroup();
+
+		/** Add a task to be executed on the next call to run(). 
+		@note The group does not take ownership of the task.
+		*/
+		void addTask(Task* task);
+		/** Remove all tasks from the group without executing them. */
+		void clearTasks();
+		/** Get the number of tasks waiting for the next call to run(). */
+		size_t getNumTasks() const { return mTasks.size(); }
+
+		/** Execute all the tasks which have been added and wait for them to 
+			complete. The task list is cleared afterwards.
+		*/
+		void run();
+
+		/** Set the maximum number of threads (including the calling thread) 
+			which will execute tasks concurrently. 
+		@remarks
+			Defaults to the hardware concurrency of the machine. Setting this
+			to 1 causes all tasks to be executed serially on the calling thread.
+		*/
+		void setMaxConcurrency(size_t n) { mMaxConcurrency = n ? n : 1; }
+		/** Get the maximum number of threads which will execute tasks concurrently. */
+		size_t getMaxConcurrency() const { return mMaxConcurrency; }
+
+		/// @copydoc WorkQueue::RequestHandler::canHandleRequest
+		bool canHandleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
+		/// @copydoc WorkQueue::RequestHandler::handleRequest
+		WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
+		/// @copydoc WorkQueue::ResponseHandler::handleResponse
+		void handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ);
+
+	protected:
+		String mName;
+		/// The queue requested by the user (null to follow Root's queue)
+		WorkQueue* mQueue;
+		/// The queue our handlers are currently registered with
+		WorkQueue* mRegisteredQueue;
+		uint16 mChannel;
+		size_t mMaxConcurrency;
+		TaskList mTasks;
+		/// Index of the next task to be picked up
+		size_t mNextTask;
+		/// Number of tasks which have finished executing
+		size_t mCompletedTasks;
+		/// Number of helper requests placed on the queue but not yet picked up
+		size_t mQueuedHelpers;
+		/// Identifies the current run, so that a helper finishing late can't take part in the next
+		uint32 mRunID;
+		OGRE_MUTEX(mTaskMutex)
+
+		/// Attach to the WorkQueue if not done already
+		void init();
+		/// Execute tasks until there are none left for the given run
+		void executeTasks(uint32 runID);
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
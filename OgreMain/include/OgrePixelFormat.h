@@ -484,8 +484,42 @@ namespace Ogre {
 		 	@param	dst			PixelBox containing the destination pixels, pitches and format
 		 	@remarks The source and destination boxes must have the same
          	dimensions. In case the source and destination format match, a plain copy is done.
+			@par
+				Any uncompressed format can be compressed to PF_DXT1 to PF_DXT5, or
+				decompressed from them, in which case the compressed box must cover the
+				whole compressed image. Other conversions to or from compressed formats
+				are not supported.
         */
         static void bulkPixelConversion(const PixelBox &src, const PixelBox &dst);
+
+        /** The sets of SIMD kernels bulkPixelConversion can use for the
+            common pairs of formats, and for DXT compression and decompression.
+        */
+        enum ConversionKernels
+        {
+            /// No kernels, only the per pixel conversions
+            CK_NONE,
+            /// SSE2 kernels
+            CK_SSE2,
+            /// AVX2 kernels, with SSE2 for the remainders
+            CK_AVX2
+        };
+
+        /** Selects the kernels used by bulkPixelConversion.
+            @remarks
+                The best set the CPU supports is selected on start up, and all
+                of them give the same pixels, so this is only of use to compare
+                the sets in tests and benchmarks. It must not be called while
+                pixels are being converted.
+            @returns
+                false if the CPU or the build doesn't support the set, which
+                leaves the selection as it was.
+        */
+        static bool _setConversionKernels(ConversionKernels kernels);
+
+        /** Gets the kernels used by bulkPixelConversion.
+        */
+        static ConversionKernels _getConversionKernels(void);
     };
 	/** @} */
 	/** @} */
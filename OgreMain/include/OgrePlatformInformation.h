@@ -113,6 +113,33 @@ namespace Ogre {
 #   define __OGRE_HAVE_VFP  0
 #endif
 
+/* Define whether or not Ogre compiled with AVX supports. The AVX code is
+   compiled for AVX on a per function basis, so the compiler must support
+   AVX intrinsics without AVX being enabled for the whole build. Visual C++
+   has them from VS2010, but checking that the OS supports AVX needs the
+   _xgetbv of VS2010 SP1; without it the AVX code is built but never used.
+*/
+#if __OGRE_HAVE_SSE && OGRE_COMPILER == OGRE_COMPILER_MSVC && OGRE_COMP_VER >= 1600
+#   define __OGRE_HAVE_AVX  1
+#elif __OGRE_HAVE_SSE && OGRE_COMPILER == OGRE_COMPILER_GNUC && OGRE_COMP_VER >= 490 && !defined(__clang__)
+#   define __OGRE_HAVE_AVX  1
+#endif
+
+#ifndef __OGRE_HAVE_AVX
+#   define __OGRE_HAVE_AVX  0
+#endif
+
+/* Define whether or not Ogre compiled with AVX2 supports, for the 256 bit
+   integer instructions. Visual C++ has those intrinsics from VS2012.
+*/
+#if __OGRE_HAVE_AVX && (OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1700)
+#   define __OGRE_HAVE_AVX2  1
+#endif
+
+#ifndef __OGRE_HAVE_AVX2
+#   define __OGRE_HAVE_AVX2  0
+#endif
+
 #ifndef __OGRE_HAVE_NEON
 #   define __OGRE_HAVE_NEON  0
 #endif
@@ -158,6 +185,9 @@ namespace Ogre {
             CPU_FEATURE_FPU         = 1 << 9,
             CPU_FEATURE_PRO         = 1 << 10,
             CPU_FEATURE_HTT         = 1 << 11,
+            CPU_FEATURE_AVX         = 1 << 12,
+            CPU_FEATURE_AVX2        = 1 << 13,
+            CPU_FEATURE_FMA         = 1 << 14,
 #elif OGRE_CPU == OGRE_CPU_ARM
             CPU_FEATURE_VFP         = 1 << 12,
             CPU_FEATURE_NEON        = 1 << 13,
@@ -125,6 +125,7 @@ namespace Ogre {
     class ArchiveManager;
     class AutoParamDataSource;
     class AxisAlignedBox;
+    class AxisAlignedBoxBatch;
     class AxisAlignedBoxSceneQuery;
     class Billboard;
     class BillboardChain;
@@ -193,6 +194,7 @@ namespace Ogre {
     class MovableObject;
     class MovablePlane;
     class Node;
+    class NodeTransformBatch;
 	class NodeAnimationTrack;
 	class NodeKeyFrame;
 	class NumericAnimationTrack;
@@ -202,6 +204,8 @@ namespace Ogre {
     class OverlayElement;
     class OverlayElementFactory;
     class OverlayManager;
+    class PackedTransformTrack;
+    class ParallelTaskGroup;
     class Particle;
     class ParticleAffector;
     class ParticleAffectorFactory;
@@ -247,6 +251,7 @@ namespace Ogre {
     class RenderOperation;
     class Resource;
 	class ResourceBackgroundQueue;
+	class ResourceBudgetManager;
 	class ResourceGroupManager;
     class ResourceManager;
     class RibbonTrail;
@@ -269,6 +274,7 @@ namespace Ogre {
     class SkeletonPtr;
     class SkeletonInstance;
     class SkeletonManager;
+    class SoftwareAnimationBatch;
     class Sphere;
     class SphereSceneQuery;
 	class StaticGeometry;
@@ -285,6 +291,7 @@ namespace Ogre {
     class Texture;
     class TexturePtr;
     class TextureManager;
+    class TextureStreamer;
     class TransformKeyFrame;
 	class Timer;
 	class UserObjectBindings;
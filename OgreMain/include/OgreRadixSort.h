@@ -322,6 +322,180 @@ namespace Ogre {
 
 	};
 
+	/** Converts sort keys to unsigned integers which order the same way, for
+		RadixSort11.
+	@remarks
+		Specialisations are provided for 32-bit signed and unsigned integers, 
+		floats and 64-bit unsigned integers; combine several values into one
+		64-bit key to sort on them all in a single sort.
+	*/
+	template <typename T> struct RadixSortKeyTraits;
+
+	template <> struct RadixSortKeyTraits<uint32>
+	{
+		typedef uint32 UnsignedType;
+		static UnsignedType toUnsigned(uint32 val) { return val; }
+	};
+
+	template <> struct RadixSortKeyTraits<int>
+	{
+		typedef uint32 UnsignedType;
+		// flip the sign bit so that negatives come first
+		static UnsignedType toUnsigned(int val) { return static_cast<uint32>(val) ^ 0x80000000; }
+	};
+
+	template <> struct RadixSortKeyTraits<float>
+	{
+		typedef uint32 UnsignedType;
+		static UnsignedType toUnsigned(float val)
+		{
+			union { float f; uint32 u; } bits;
+			bits.f = val;
+			// Negatives have all bits flipped, to reverse their order and put 
+			// them first; positives have just the sign bit flipped
+			uint32 mask = static_cast<uint32>(-static_cast<int32>(bits.u >> 31)) | 0x80000000;
+			return bits.u ^ mask;
+		}
+	};
+
+	template <> struct RadixSortKeyTraits<uint64>
+	{
+		typedef uint64 UnsignedType;
+		static UnsignedType toUnsigned(uint64 val) { return val; }
+	};
+
+	/** Radix sort which works on 11 bits of the key at a time.
+	@remarks
+		This has the same interface and requirements as RadixSort, but sorts 
+		32-bit keys in 3 passes rather than 4 and 64-bit keys in 6, and skips 
+		any pass where every key has the same digit. Keys are converted to 
+		unsigned integers up front (see RadixSortKeyTraits), so signed values
+		and floats need no special final pass. Unlike RadixSort, the sort is 
+		always stable, including for negative floats. The larger histograms
+		are allocated on first use, so it is best used for large collections,
+		or for sorting on several values at once through a 64-bit key.
+	@par
+		A RadixSort11 instance is not threadsafe, but different instances may
+		be used on different threads at the same time.
+	*/
+	template <class TContainer, class TContainerValueType, typename TCompValueType>
+	class RadixSort11
+	{
+	public:
+		typedef typename TContainer::iterator ContainerIter;
+	protected:
+		typedef RadixSortKeyTraits<TCompValueType> KeyTraits;
+		typedef typename KeyTraits::UnsignedType KeyType;
+
+		enum
+		{
+			DIGIT_BITS = 11,
+			NUM_BUCKETS = 1 << DIGIT_BITS,
+			NUM_DIGITS = (sizeof(KeyType) * 8 + DIGIT_BITS - 1) / DIGIT_BITS
+		};
+
+		struct SortEntry
+		{
+			KeyType key;
+			ContainerIter iter;
+		};
+		typedef std::vector<SortEntry, STLAllocator<SortEntry, GeneralAllocPolicy> > SortVector; 
+		SortVector mSortArea1;
+		SortVector mSortArea2;
+		/// Histogram of each digit, NUM_DIGITS * NUM_BUCKETS entries
+		std::vector<uint32, STLAllocator<uint32, GeneralAllocPolicy> > mCounters;
+		TContainer mTmpContainer; // initial copy
+
+		static inline uint32 getDigit(int digit, KeyType key)
+		{
+			return static_cast<uint32>(key >> (digit * DIGIT_BITS)) & (NUM_BUCKETS - 1);
+		}
+
+	public:
+		RadixSort11() {}
+		~RadixSort11() {}
+
+		/** Main sort function
+		@param container A container of the type you declared when declaring
+		@param func A functor which returns the value for comparison when given
+			a container value
+		*/
+		template <class TFunction>
+		void sort(TContainer& container, TFunction func)
+		{
+			if (container.empty())
+				return;
+
+			size_t sortSize = container.size();
+			mSortArea1.resize(sortSize);
+			mSortArea2.resize(sortSize);
+			mCounters.assign(NUM_DIGITS * NUM_BUCKETS, 0);
+
+			// Copy data now (we need constant iterators for sorting)
+			mTmpContainer = container;
+
+			// Histogram all the digits in one go
+			ContainerIter i = mTmpContainer.begin();
+			KeyType prevKey = KeyTraits::toUnsigned(func.operator()(*i));
+			bool needsSorting = false;
+			uint32* counters = &mCounters[0];
+			for (size_t u = 0; i != mTmpContainer.end(); ++i, ++u)
+			{
+				KeyType key = KeyTraits::toUnsigned(func.operator()(*i));
+				// cheap check to see if needs sorting (temporal coherence)
+				if (key < prevKey)
+					needsSorting = true;
+
+				mSortArea1[u].key = key;
+				mSortArea1[u].iter = i;
+
+				for (int d = 0; d < NUM_DIGITS; ++d)
+				{
+					++counters[d * NUM_BUCKETS + getDigit(d, key)];
+				}
+				prevKey = key;
+			}
+
+			// early exit if already sorted
+			if (!needsSorting)
+				return;
+
+			SortVector* src = &mSortArea1;
+			SortVector* dest = &mSortArea2;
+			for (int d = 0; d < NUM_DIGITS; ++d)
+			{
+				uint32* count = counters + d * NUM_BUCKETS;
+				// Skip the pass if every key has the same digit here
+				if (count[getDigit(d, (*src)[0].key)] == sortSize)
+					continue;
+
+				// Turn counts into offsets
+				uint32 offset = 0;
+				for (int b = 0; b < NUM_BUCKETS; ++b)
+				{
+					uint32 c = count[b];
+					count[b] = offset;
+					offset += c;
+				}
+
+				for (size_t u = 0; u < sortSize; ++u)
+				{
+					const SortEntry& entry = (*src)[u];
+					(*dest)[count[getDigit(d, entry.key)]++] = entry;
+				}
+				std::swap(src, dest);
+			}
+
+			// Copy everything back
+			size_t c = 0;
+			for (i = container.begin(); i != container.end(); ++i, ++c)
+			{
+				*i = *((*src)[c].iter);
+			}
+		}
+
+	};
+
 	/** @} */
 	/** @} */
 
@@ -139,6 +139,7 @@ namespace Ogre {
         bool mSplitPassesByLightingType;
         bool mSplitNoShadowPasses;
 		bool mShadowCastersCannotBeReceivers;
+		bool mKeyedSortEnabled;
 
 		RenderableListener* mRenderableListener;
     public:
@@ -273,6 +274,24 @@ namespace Ogre {
 		*/
 		bool getShadowCastersCannotBeReceivers(void) const;
 
+		/** Sets whether the solids in every queue group are organised with 
+			QueuedRenderableCollection::OM_SORT_KEYED, rather than grouped by 
+			pass in a map.
+		@remarks
+			The keyed mode orders items the same way as OM_PASS_GROUP, but 
+			nearest first within each pass, and avoids a map lookup for every
+			item added. It applies to queue groups created later too, and is 
+			overridden by the solids organisation of a custom 
+			RenderQueueInvocationSequence. Only change it when the queue is 
+			empty. The default is false.
+		*/
+		void setKeyedSortEnabled(bool enabled);
+
+		/** Gets whether the solids in every queue group are organised with 
+			QueuedRenderableCollection::OM_SORT_KEYED.
+		*/
+		bool getKeyedSortEnabled(void) const;
+
 		/** Set a renderable listener on the queue.
 		@remarks
 			There can only be a single renderable listener on the queue, since
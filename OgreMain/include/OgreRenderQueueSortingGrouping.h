@@ -108,7 +108,8 @@ namespace Ogre {
 		The order of the iteration, and whether that iteration is
 		over a RenderablePass list or a 2-level grouped list which 
 		causes a visit call at the Pass level, and a call for each
-		Renderable underneath.
+		Renderable underneath. Collections organised by sort key are
+		visited in the same way as those grouped by pass.
 	*/
 	class _OgreExport QueuedRenderableCollection : public RenderQueueAlloc
 	{
@@ -130,7 +131,27 @@ namespace Ogre {
 			/** Sort ascending camera distance 
 				Note value overlaps with descending since both use same sort
 			*/
-			OM_SORT_ASCENDING = 6
+			OM_SORT_ASCENDING = 6,
+			/** Sort by a compact 64-bit key built when each item is added, 
+				which orders items by pass hash, then material, then ascending
+				quantised camera distance. 
+			@remarks
+				This gives much the same ordering as OM_PASS_GROUP, but adding
+				an item is a plain append rather than a map lookup, and sorting
+				only moves keys and indices around a contiguous array. The 
+				distance part of the key is filled in by sort() with the 
+				camera, so nearer objects are drawn first within a pass. 
+				Visitors see the same calls as for OM_PASS_GROUP, and a request
+				for OM_PASS_GROUP falls back to this mode if it is the only 
+				grouping mode in use, so existing visitors work unchanged.
+				Use RenderQueue::setKeyedSortEnabled to have the scene manager 
+				use this mode for the solids of every queue group.
+			@par
+				The queue group and priority are not part of the key; each 
+				collection belongs to a single group and priority, and the 
+				queue hierarchy already orders those.
+			*/
+			OM_SORT_KEYED = 8
 		};
 
 	protected:
@@ -153,18 +174,38 @@ namespace Ogre {
                 }
             }
         };
+        /** Vector of RenderablePass objects, this is built on the assumption that
+         vectors only ever increase in size, so even if we do clear() the memory stays
+         allocated, ie fast */
+        typedef vector<RenderablePass>::type RenderablePassList;
+        typedef vector<Renderable*>::type RenderableList;
+        /** Map of pass to renderable lists, this is a grouping by pass. */
+        typedef map<Pass*, RenderableList*, PassGroupLess>::type PassGroupRenderableMap;
+
+		/// Depth of an item in mSortedDescending, worked out before sorting
+		struct DepthSortEntry
+		{
+			/// Squared view depth of the renderable
+			Real depth;
+			/// Index of the item in mSortedDescending
+			uint32 index;
+		};
+		typedef vector<DepthSortEntry>::type DepthSortList;
+
         /// Comparator to order objects by descending camera distance
 		struct DepthSortDescendingLess
         {
-            const Camera* camera;
+            const RenderablePassList* items;
 
-            DepthSortDescendingLess(const Camera* cam)
-                : camera(cam)
+            DepthSortDescendingLess(const RenderablePassList* list)
+                : items(list)
             {
             }
 
-            bool _OgreExport operator()(const RenderablePass& a, const RenderablePass& b) const
+            bool _OgreExport operator()(const DepthSortEntry& ea, const DepthSortEntry& eb) const
             {
+				const RenderablePass& a = (*items)[ea.index];
+				const RenderablePass& b = (*items)[eb.index];
                 if (a.renderable == b.renderable)
                 {
                     // Same renderable, sort by pass hash
@@ -173,9 +214,7 @@ namespace Ogre {
                 else
                 {
                     // Different renderables, sort by depth
-                    Real adepth = a.renderable->getSquaredViewDepth(camera);
-                    Real bdepth = b.renderable->getSquaredViewDepth(camera);
-					if (Math::RealEqual(adepth, bdepth))
+					if (Math::RealEqual(ea.depth, eb.depth))
 				    {
                         // Must return deterministic result, doesn't matter what
                         return a.pass < b.pass;
@@ -183,61 +222,96 @@ namespace Ogre {
 				    else
 				    {
 				        // Sort DESCENDING by depth (i.e. far objects first)
-					    return (adepth > bdepth);
+					    return (ea.depth > eb.depth);
 				    }
                 }
 
             }
         };
 
-        /** Vector of RenderablePass objects, this is built on the assumption that
-         vectors only ever increase in size, so even if we do clear() the memory stays
-         allocated, ie fast */
-        typedef vector<RenderablePass>::type RenderablePassList;
-        typedef vector<Renderable*>::type RenderableList;
-        /** Map of pass to renderable lists, this is a grouping by pass. */
-        typedef map<Pass*, RenderableList*, PassGroupLess>::type PassGroupRenderableMap;
-
-		/// Functor for accessing sort value 1 for radix sort (Pass)
-		struct RadixSortFunctorPass
-		{
-			uint32 operator()(const RenderablePass& p) const
-            {
-                return p.pass->getHash();
-            }
-		};
-
-        /// Radix sorter for accessing sort value 1 (Pass)
-		static RadixSort<RenderablePassList, RenderablePass, uint32> msRadixSorter1;
-
-		/// Functor for descending sort value 2 for radix sort (distance)
-		struct RadixSortFunctorDistance
+		/// Functor for the radix sort key; distance in the top half, pass below
+		struct RadixSortFunctorDistancePass
 		{
-			const Camera* camera;
+			const RenderablePassList* items;
 
-            RadixSortFunctorDistance(const Camera* cam)
-                : camera(cam)
+            RadixSortFunctorDistancePass(const RenderablePassList* list)
+                : items(list)
             {
             }
 
-			float operator()(const RenderablePass& p) const
+			uint64 operator()(const DepthSortEntry& e) const
             {
                 // Sort DESCENDING by depth (ie far objects first), use negative distance
-                // here because radix sorter always dealing with accessing sort
-                return static_cast<float>(- p.renderable->getSquaredViewDepth(camera));
+                // here because radix sorter always sorts ascending. Objects at the
+                // same depth are then ordered by pass hash.
+                uint64 distance = RadixSortKeyTraits<float>::toUnsigned(
+                    static_cast<float>(- e.depth));
+                return (distance << 32) | (*items)[e.index].pass->getHash();
             }
 		};
 
-        /// Radix sorter for sort value 2 (distance)
-		static RadixSort<RenderablePassList, RenderablePass, float> msRadixSorter2;
+        /// Radix sorter, per collection so that collections can be sorted in parallel
+		RadixSort11<DepthSortList, DepthSortEntry, uint64> mRadixSorter;
+
+		/// Entry in the keyed organisation, refering to an item in mKeyed
+		struct SortKeyEntry
+		{
+			/// Pass hash, material and depth, see OM_SORT_KEYED
+			uint64 key;
+			/// Index of the item in mKeyed
+			uint32 index;
+		};
+		typedef vector<SortKeyEntry>::type SortKeyList;
+
+		/// Comparator to order sort key entries, for small collections
+		struct SortKeyLess
+		{
+			bool _OgreExport operator()(const SortKeyEntry& a, const SortKeyEntry& b) const
+			{
+				return a.key < b.key;
+			}
+		};
+		/// Functor for the radix sort of sort key entries
+		struct RadixSortFunctorKey
+		{
+			uint64 operator()(const SortKeyEntry& e) const
+			{
+				return e.key;
+			}
+		};
+		/// Radix sorter for the keyed organisation
+		RadixSort11<SortKeyList, SortKeyEntry, uint64> mKeySorter;
 
 		/// Bitmask of the organisation modes requested
 		uint8 mOrganisationMode;
+		/// Camera the contents were last sorted for, or null if they have changed since
+		const Camera* mSortedCamera;
+		/// Derived position of mSortedCamera when the contents were sorted
+		Vector3 mSortedPosition;
+		/// Derived orientation of mSortedCamera when the contents were sorted
+		Quaternion mSortedOrientation;
+		/// Camera the depths were calculated for, or null if they must be calculated again
+		const Camera* mDepthCamera;
+		/// Derived position of mDepthCamera when the depths were calculated
+		Vector3 mDepthPosition;
+		/// Derived orientation of mDepthCamera when the depths were calculated
+		Quaternion mDepthOrientation;
 
 		/// Grouped 
 		PassGroupRenderableMap mGrouped;
 		/// Sorted descending (can iterate backwards to get ascending)
 		RenderablePassList mSortedDescending;
+		/// Depths of mSortedDescending, sorted into the order the items should be in
+		DepthSortList mDepthSortEntries;
+		/// Space to put mSortedDescending into sorted order
+		RenderablePassList mSortScratch;
+		/// Items in the keyed organisation, in the order they were added
+		RenderablePassList mKeyed;
+		/// Sort keys for mKeyed, in sorted order once sort() has been called
+		SortKeyList mSortKeys;
+
+		/// Sort the keyed organisation, once the depths are in the keys
+		void sortKeyed(void);
 
 		/// Internal visitor implementation
 		void acceptVisitorGrouped(QueuedRenderableVisitor* visitor) const;
@@ -245,6 +319,8 @@ namespace Ogre {
 		void acceptVisitorDescending(QueuedRenderableVisitor* visitor) const;
 		/// Internal visitor implementation
 		void acceptVisitorAscending(QueuedRenderableVisitor* visitor) const;
+		/// Internal visitor implementation
+		void acceptVisitorKeyed(QueuedRenderableVisitor* visitor) const;
 
 	public:
 		QueuedRenderableCollection();
@@ -283,11 +359,36 @@ namespace Ogre {
         /// Add a renderable to the collection using a given pass
         void addRenderable(Pass* pass, Renderable* rend);
 		
+		/** Work out the view depth of every item, ready for sort.
+		@remarks
+			This is the only part of sorting which calls the renderables.
+			Renderable::getSquaredViewDepth is not threadsafe in general 
+			(SubEntity caches the result per camera, for example), and one 
+			renderable may be in several collections, so this must be called
+			on one thread for all the collections which are going to be sorted
+			at the same time. sort() calls it itself if it hasn't been called 
+			for the camera since the collection last changed.
+		@param cam The camera
+		*/
+		void _calculateSortDepths(const Camera* cam);
+
 		/** Perform any sorting that is required on this collection.
+		@remarks
+			Does nothing if the collection has already been sorted for this 
+			camera and nothing has been added since. Different collections may 
+			be sorted on different threads at the same time, as long as 
+			_calculateSortDepths has been called for each of them beforehand.
 		@param cam The camera
 		*/
 		void sort(const Camera* cam);
 
+		/** Returns whether sort would need to do any work for the given camera. 
+		@remarks
+			A sort is only reused if the camera is the same one and has neither
+			moved nor turned since.
+		*/
+		bool isSortRequired(const Camera* cam) const;
+
 		/** Accept a visitor over the collection contents.
 		@param visitor Visitor class which should be called back
 		@param om The organisation mode which you want to iterate over.
@@ -419,6 +520,13 @@ namespace Ogre {
             depth in relation to the passed in Camera. */
 		void sort(const Camera* cam);
 
+		typedef vector<QueuedRenderableCollection*>::type CollectionList;
+		/** Internal method which adds the collections that sort would need to
+			sort for the given camera to a list, so that they can be sorted in 
+			parallel.
+		*/
+		void _getCollectionsToSort(const Camera* cam, CollectionList& list);
+
         /** Clears this group of renderables. 
         */
         void clear(void);
@@ -479,6 +587,8 @@ namespace Ogre {
 		bool mShadowsEnabled;
 		/// Bitmask of the organisation modes requested (for new priority groups)
 		uint8 mOrganisationMode;
+		/// Whether the default organisation for the solids is OM_SORT_KEYED
+		bool mKeyedSortEnabled;
 
 
     public:
@@ -492,6 +602,7 @@ namespace Ogre {
             , mShadowCastersNotReceivers(shadowCastersNotReceivers)
             , mShadowsEnabled(true)
 			, mOrganisationMode(0)
+			, mKeyedSortEnabled(false)
         {
         }
 
@@ -628,6 +739,21 @@ namespace Ogre {
 				i->second->setShadowCastersCannotBeReceivers(ind);
 			}
 		}
+		/** Sets whether the solids in this group are organised with 
+			QueuedRenderableCollection::OM_SORT_KEYED by default, rather than
+			OM_PASS_GROUP.
+		@remarks
+			This replaces any organisation modes set on the group, so you can 
+			only do this when the group is empty, ie after clearing the queue.
+		*/
+		void setKeyedSortEnabled(bool enabled)
+		{
+			mKeyedSortEnabled = enabled;
+			defaultOrganisationMode();
+		}
+		/** Gets whether the solids in this group are organised with 
+			QueuedRenderableCollection::OM_SORT_KEYED by default. */
+		bool getKeyedSortEnabled(void) const { return mKeyedSortEnabled; }
 		/** Reset the organisation modes required for the solids in this group. 
 		@remarks
 			You can only do this when the group is empty, ie after clearing the 
@@ -672,6 +798,13 @@ namespace Ogre {
 		*/
 		void defaultOrganisationMode(void)
 		{
+			if (mKeyedSortEnabled)
+			{
+				resetOrganisationModes();
+				addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+				return;
+			}
+
 			mOrganisationMode = 0;
 
 			PriorityMap::iterator i, iend;
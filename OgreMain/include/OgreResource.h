@@ -160,6 +160,8 @@ namespace Ogre {
 		ManualResourceLoader* mLoader;
 		/// State count, the number of times this resource has changed state
 		size_t mStateCount;
+		/// The frame in which the resource was last touched
+		unsigned long mLastUsedFrame;
 
 		typedef set<Listener*>::type ListenerList;
 		ListenerList mListenerList;
@@ -169,7 +171,8 @@ namespace Ogre {
 		*/
 		Resource() 
 			: mCreator(0), mHandle(0), mLoadingState(LOADSTATE_UNLOADED), 
-			mIsBackgroundLoaded(false),	mSize(0), mIsManual(0), mLoader(0)
+			mIsBackgroundLoaded(false),	mSize(0), mIsManual(0), mLoader(0),
+			mStateCount(0), mLastUsedFrame(0)
 		{ 
 		}
 
@@ -304,9 +307,21 @@ namespace Ogre {
         }
 
         /** 'Touches' the resource to indicate it has been used.
+		@remarks
+			This loads the resource if it isn't loaded, so a resource which 
+			has been unloaded to stay within a memory budget is reloaded 
+			when next used. @see ResourceBudgetManager
         */
         virtual void touch(void);
 
+		/** Get the frame in which the resource was last touched, as 
+			counted by ResourceBudgetManager. */
+		unsigned long getLastUsedFrame(void) const { return mLastUsedFrame; }
+
+		/** Notify the resource that it has been used in a frame, called by 
+			ResourceBudgetManager. */
+		void _notifyUsed(unsigned long frame) { mLastUsedFrame = frame; }
+
         /** Gets resource name.
         */
         virtual const String& getName(void) const 
@@ -418,6 +433,17 @@ namespace Ogre {
 		virtual const String& getOrigin(void) const { return mOrigin; }
 		/// Notify this resource of it's origin
 		virtual void _notifyOrigin(const String& origin) { mOrigin = origin; }
+		/** Change whether this resource is manually loaded, and by what.
+		@remarks
+			For use by classes which take over the loading of a resource for 
+			a while and then hand it back. The resource is not reloaded, the 
+			change takes effect the next time it is.
+		*/
+		virtual void _notifyManualLoader(bool isManual, ManualResourceLoader* loader)
+		{
+			mIsManual = isManual;
+			mLoader = loader;
+		}
 
 		/** Returns the number of times this resource has changed state, which 
 			generally means the number of times it has been loaded. Objects that 
@@ -0,0 +1,175 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ResourceBudgetManager_H__
+#define __ResourceBudgetManager_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreSingleton.h"
+#include "OgreResource.h"
+
+namespace Ogre {
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Resources
+	*  @{
+	*/
+
+	/** Keeps the memory used by resources of all types within one budget.
+	@remarks
+		Each ResourceManager only knows about its own resources, so a budget 
+		set on one of them can't trade textures off against meshes or 
+		skeletons. This class looks at all of the resource managers 
+		registered with the ResourceGroupManager together, and when the 
+		memory they use exceeds the budget, unloads the resources which 
+		were used least recently until it doesn't.
+	@par
+		Only resources which nothing outside the resource system refers to 
+		are unloaded, and only if they can be reloaded; resources used in 
+		the current frame are never unloaded. How recently a resource was 
+		used is taken from Resource::touch, which also reloads a resource 
+		that has been unloaded, so this is transparent to the code using 
+		the resource. Materials are touched when queued for rendering, and 
+		meshes when an entity using them is.
+	@par
+		The budget is checked by Root at the end of each frame, and by 
+		ResourceManager::checkUsage for a manager's own budget.
+	*/
+	class _OgreExport ResourceBudgetManager : public Singleton<ResourceBudgetManager>, 
+		public ResourceAlloc
+	{
+	public:
+		/// How well the budget is working
+		struct Statistics
+		{
+			/// Number of times a resource was touched while loaded
+			size_t hits;
+			/// Number of times a resource was touched while not loaded, and had to be loaded
+			size_t misses;
+			/// Number of resources unloaded to stay within a budget
+			size_t evictions;
+			/// Total size of the resources unloaded to stay within a budget
+			size_t bytesEvicted;
+
+			Statistics() : hits(0), misses(0), evictions(0), bytesEvicted(0) {}
+		};
+
+		ResourceBudgetManager();
+		virtual ~ResourceBudgetManager();
+
+		/** Set the memory all resource managers together may use, in bytes.
+		@remarks
+			If the budget is lowered resources are unloaded straight away. 
+			0, the default, means no limit.
+		*/
+		void setMemoryBudget(size_t bytes);
+		/// Get the memory all resource managers together may use, in bytes
+		size_t getMemoryBudget() const { return mMemoryBudget; }
+		/// Get the memory all resource managers are using together, in bytes
+		size_t getMemoryUsage() const;
+
+		/** Unload resources until each manager is within its own budget, and
+			all of them together are within this one. */
+		void checkUsage();
+
+		/** Unload least recently used resources of one manager until it's 
+			within its own budget. */
+		void checkUsage(ResourceManager* rm);
+
+		/** Check the budgets at the end of a frame and move on to the next 
+			one, called by Root. */
+		void _notifyFrameEnded();
+		/// Get the number of the frame resources touched now are recorded against
+		unsigned long getCurrentFrame() const { return mCurrentFrame; }
+
+		/// Get the statistics collected since they were last reset
+		Statistics getStatistics() const;
+		/// Reset the statistics
+		void resetStatistics();
+
+		/** Notify the budget manager that a resource has been touched, called
+			by ResourceManager::_notifyResourceTouched. 
+		@note
+			Resources are also touched by background loading threads, so this 
+			is thread safe.
+		*/
+		void _notifyResourceTouched(Resource* res);
+
+		/** Override standard Singleton retrieval.
+		@remarks
+		Why do we do this? Well, it's because the Singleton
+		implementation is in a .h file, which means it gets compiled
+		into anybody who includes it. This is needed for the
+		Singleton template to work, but we actually only want it
+		compiled into the implementation of the class based on the
+		Singleton, not all of them. If we don't change this, we get
+		link errors when trying to use the Singleton-based class from
+		an outside dll.
+		@par
+		This method just delegates to the template version anyway,
+		but the implementation stays in this single compilation unit,
+		preventing link errors.
+		*/
+		static ResourceBudgetManager& getSingleton(void);
+		/** Override standard Singleton retrieval.
+		@remarks
+		Why do we do this? Well, it's because the Singleton
+		implementation is in a .h file, which means it gets compiled
+		into anybody who includes it. This is needed for the
+		Singleton template to work, but we actually only want it
+		compiled into the implementation of the class based on the
+		Singleton, not all of them. If we don't change this, we get
+		link errors when trying to use the Singleton-based class from
+		an outside dll.
+		@par
+		This method just delegates to the template version anyway,
+		but the implementation stays in this single compilation unit,
+		preventing link errors.
+		*/
+		static ResourceBudgetManager* getSingletonPtr(void);
+
+	protected:
+		typedef vector<ResourceManager*>::type ResourceManagerList;
+
+		size_t mMemoryBudget;
+		Statistics mStatistics;
+		/// Guards mStatistics, which are updated from any thread touching a resource
+		OGRE_MUTEX(mStatisticsMutex)
+		/// Starts at 1 so that resources never touched are the oldest
+		unsigned long mCurrentFrame;
+
+		/** Unload the least recently used resources of some managers until 
+			they use no more than budget between them. */
+		void evict(const ResourceManagerList& managers, size_t usage, size_t budget);
+	};
+
+	/** @} */
+	/** @} */
+}
+
+#endif
@@ -297,8 +297,13 @@ namespace Ogre {
 
 		ResourceLoadingListener *mLoadingListener;
 
-        /// Resource index entry, resourcename->location 
-        typedef map<String, Archive*>::type ResourceLocationIndex;
+        /** Resource index entry, resourcename->location 
+		@note
+			Keyed on the names themselves rather than interned ids; every 
+			lookup starts from a String, so interning it first would cost 
+			the same hash and compare that the lookup itself does.
+		*/
+        typedef HashMap<String, Archive*> ResourceLocationIndex;
 
 		/// List of resources which can be loaded / unloaded
 		typedef list<ResourcePtr>::type LoadUnloadResourceList;
@@ -344,12 +349,37 @@ namespace Ogre {
 			void addToIndex(const String& filename, Archive* arch);
 			void removeFromIndex(const String& filename, Archive* arch);
 			void removeFromIndex(Archive* arch);
+			/// Find the archive a name is indexed in, or null
+			Archive* findInIndex(const String& filename) const;
 
 		};
         /// Map from resource group names to groups
         typedef map<String, ResourceGroup*>::type ResourceGroupMap;
         ResourceGroupMap mResourceGroupMap;
 
+		/// A group and archive a resource name was indexed in
+		struct GlobalIndexEntry
+		{
+			ResourceGroup* group;
+			Archive* archive;
+		};
+		typedef vector<GlobalIndexEntry>::type GlobalIndexEntryList;
+		/** Index of resource names to every group and archive they were found 
+			in, so that a resource can be found without searching each group.
+			Names from case insensitive archives are indexed in lower case.
+		*/
+		typedef HashMap<String, GlobalIndexEntryList> GlobalResourceIndex;
+		GlobalResourceIndex mGlobalResourceIndex;
+		OGRE_MUTEX(mGlobalIndexMutex)
+
+		/// Whether scripts are parsed and resources prepared using multiple threads
+		bool mParallelInitialisation;
+		/// Runs the parallel parts of initialising and preparing groups (created on demand)
+		ParallelTaskGroup* mTaskGroup;
+		OGRE_MUTEX(mTaskGroupMutex)
+		class ScriptPrepareTask;
+		class ResourcePrepareTask;
+
         /// Group name for world resources
         String mWorldGroupName;
 
@@ -372,8 +402,24 @@ namespace Ogre {
 		void dropGroupContents(ResourceGroup* grp);
 		/** Delete a group for shutdown - don't notify ResourceManagers. */
 		void deleteGroup(ResourceGroup* grp);
+		/** Calls Resource::prepare for all the resources in a group concurrently.
+		@remarks
+			Called as part of prepareResourceGroup if parallel initialisation is 
+			enabled. The manager and group locks are not held while the 
+			resources are being prepared, since preparing them opens their 
+			files through this class.
+		*/
+		void prepareResourcesParallel(const String& groupName);
+		/// Get the task group used for parallel initialisation, creating it if necessary
+		ParallelTaskGroup* getTaskGroup();
 		/// Internal find method for auto groups
 		ResourceGroup* findGroupContainingResourceImpl(const String& filename);
+		/// Add a file to a group's index and the global index
+		void addToIndex(ResourceGroup* grp, const String& filename, Archive* arch);
+		/// Remove a file from a group's index and the global index
+		void removeFromIndex(ResourceGroup* grp, const String& filename, Archive* arch);
+		/// Remove the files from an archive (or all archives, if null) from a group's index and the global index
+		void removeFromIndex(ResourceGroup* grp, Archive* arch);
 		/// Internal event firing method
 		void fireResourceGroupScriptingStarted(const String& groupName, size_t scriptCount);
 		/// Internal event firing method
@@ -811,6 +857,14 @@ namespace Ogre {
         bool resourceExistsInAnyGroup(const String& filename);
 
 		/** Find the group in which a resource exists.
+		@remarks
+			The groups which list the file when their locations are indexed 
+			are preferred, and the first of those in order of name is used. 
+			Only if there are none are the groups searched in order for a 
+			file their archives can open but don't list, such as a path 
+			within a non-recursive location. So a group which has the file 
+			indexed wins over one earlier in order which only has it that 
+			way; before the index, the earlier group would have been used.
 		@param filename Fully qualified name of the file the resource should be
 			found as
 		@returns Name of the resource group the resource was found in. An
@@ -1046,6 +1100,30 @@ namespace Ogre {
 		*/		
 		const LocationList& getResourceLocationList(const String& groupName);
 
+		/** Sets whether resource groups are initialised and prepared using 
+			multiple threads.
+		@remarks
+			When this is enabled, initialiseResourceGroup reads every script in 
+			the group and calls ScriptLoader::prepareScript for it on the 
+			WorkQueue's worker threads before parsing them. The scripts are 
+			still parsed one at a time in the usual order on the calling thread,
+			so resources are registered exactly as they are when this is 
+			disabled; only the reading and tokenising of the scripts is done
+			concurrently. Similarly prepareResourceGroup first calls
+			Resource::prepare for all the resources in the group concurrently,
+			and then fires the usual events for each of them in order.
+		@par
+			This requires that the archives of the group can be opened from 
+			several threads at once, and that the prepareImpl of every type of 
+			resource in the group is threadsafe, just as it is when resources
+			are prepared by the ResourceBackgroundQueue. Without a WorkQueue, 
+			or when OGRE is built without thread support, the work is simply 
+			done serially. The default is false.
+		*/
+		void setParallelInitialisation(bool parallel) { mParallelInitialisation = parallel; }
+		/** Gets whether resource groups are initialised and prepared using multiple threads. */
+		bool getParallelInitialisation() const { return mParallelInitialisation; }
+
 		/// Sets a new loading listener
 		void setLoadingListener(ResourceLoadingListener *listener);
 		/// Returns the current loading listener
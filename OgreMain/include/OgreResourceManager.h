@@ -121,10 +121,11 @@ namespace Ogre {
 		
         /** Set a limit on the amount of memory this resource handler may use.
             @remarks
-                If, when asked to load a new resource, the manager believes it will exceed this memory
-                budget, it will temporarily unload a resource to make room for the new one. This unloading
-                is not permanent and the Resource is not destroyed; it simply needs to be reloaded when
-                next used.
+                If the manager uses more memory than this, it will temporarily unload the least 
+                recently used resources which nothing else refers to, when the budget is set and 
+                at the end of each frame. This unloading is not permanent and the Resource is not 
+                destroyed; it is reloaded when next touched. @see ResourceBudgetManager for a 
+                budget shared by all resource managers.
         */
         virtual void setMemoryBudget( size_t bytes);
 
@@ -484,6 +485,7 @@ namespace Ogre {
 		/** Remove a resource from this manager; remove it from the lists. */
 		virtual void removeImpl( ResourcePtr& res );
 		/** Checks memory usage and pages out if required.
+		@see ResourceBudgetManager::checkUsage
 		*/
 		virtual void checkUsage(void);
 
@@ -96,9 +96,12 @@ namespace Ogre
         OverlayManager* mOverlayManager;
         FontManager* mFontManager;
         ArchiveFactory *mZipArchiveFactory;
+        ArchiveFactory *mPackArchiveFactory;
         ArchiveFactory *mFileSystemArchiveFactory;
 		ResourceGroupManager* mResourceGroupManager;
+		ResourceBudgetManager* mResourceBudgetManager;
 		ResourceBackgroundQueue* mResourceBackgroundQueue;
+		TextureStreamer* mTextureStreamer;
 		ShadowTextureManager* mShadowTextureManager;
 		RenderSystemCapabilitiesManager* mRenderSystemCapabilitiesManager;
 		ScriptCompilerManager *mCompilerManager;
@@ -142,6 +145,12 @@ namespace Ogre
 
 		WorkQueue* mWorkQueue;
 
+		/// Shared group for splitting up one-off jobs, created on demand
+		ParallelTaskGroup* mTaskGroup;
+		/// Whether mTaskGroup has been handed out
+		bool mTaskGroupInUse;
+		OGRE_MUTEX(mTaskGroupMutex)
+
         /** Method reads a plugins configuration file and instantiates all
             plugins.
             @param
@@ -540,8 +549,9 @@ namespace Ogre
                 All the application user has to do is specify a 'loctype'
                 string in order to indicate the type of location, which
                 should map onto one of the provided plugins. Ogre comes
-                configured with the 'FileSystem' (folders) and 'Zip' (archive
-                compressed with the pkzip / WinZip etc utilities) types.
+                configured with the 'FileSystem' (folders), 'Zip' (archive
+                compressed with the pkzip / WinZip etc utilities) and 'Pack'
+                (files built with OgreArchivePacker) types.
             @par
 				You can also supply the name of a resource group which should
 				have this location applied to it. The 
@@ -1011,6 +1021,21 @@ namespace Ogre
 			at shutdown, so do not destroy it yourself.
 		*/
 		void setWorkQueue(WorkQueue* queue);
+
+		/** Get sole use of a ParallelTaskGroup, to split up a one-off job such 
+			as scaling a large image across the threads of the WorkQueue.
+		@remarks
+			One group is shared by all the code which only needs one now and 
+			then. If it is in use already, by another thread or by a caller
+			further up the stack of this one, null is returned and the job
+			should be done serially instead; the cores are busy anyway.
+		@returns
+			The group, which must be handed back with _releaseTaskGroup, or 
+			null.
+		*/
+		ParallelTaskGroup* _acquireTaskGroup();
+		/** Hand back a group obtained from _acquireTaskGroup. */
+		void _releaseTaskGroup(ParallelTaskGroup* group);
 			
     };
 	/** @} */
@@ -54,6 +54,8 @@ Torus Knot Software Ltd.
 #include "OgreInstancedGeometry.h"
 #include "OgreLodListener.h"
 #include "OgreRenderSystem.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreNodeTransformBatch.h"
 namespace Ogre {
 	/** \addtogroup Core
 	*  @{
@@ -951,6 +953,205 @@ namespace Ogre {
 		Matrix4 mCachedViewMatrix;
 		Vector3 mCameraRelativePosition;
 
+		/// Whether to update the scene graph using multiple threads
+		bool mParallelSceneGraphUpdate;
+		/// Task group used to distribute per-frame work over threads, created on demand
+		ParallelTaskGroup* mParallelTaskGroup;
+
+		/// Task which updates one subtree of the scene graph
+		class SceneGraphUpdateTask : public ParallelTaskGroup::Task
+		{
+		public:
+			Node* node;
+			bool parentHasChanged;
+			SceneGraphUpdateTask(Node* n, bool changed) : node(n), parentHasChanged(changed) {}
+			void execute() { node->_update(true, parentHasChanged); }
+		};
+		typedef vector<SceneGraphUpdateTask>::type SceneGraphUpdateTaskList;
+		SceneGraphUpdateTaskList mSceneGraphUpdateTasks;
+		/// Nodes split up by the parallel update, in the order they were split
+		typedef vector<SceneNode*>::type SplitSceneNodeList;
+		SplitSceneNodeList mSceneGraphSplitNodes;
+
+		/// Get the task group used for parallel work, creating it if required
+		virtual ParallelTaskGroup* getParallelTaskGroup();
+		/** Update the scene graph from the root by splitting it into independent 
+			subtrees which are updated in parallel.
+		*/
+		virtual void updateSceneGraphParallel();
+		/** Returns whether this SceneManager's nodes can be updated in parallel.
+		@remarks
+			Subclasses whose nodes modify shared structures while updating (for 
+			example to relocate themselves in a spatial partitioning structure)
+			must return false here.
+		*/
+		virtual bool isParallelSceneGraphUpdateSupported() const { return true; }
+
+		/// Whether to update the scene graph transforms in bulk
+		bool mBatchedSceneGraphUpdate;
+		/// Structure-of-arrays copy of the scene graph transforms, created on demand
+		NodeTransformBatch* mNodeTransformBatch;
+		/** Update the scene graph from the root using a NodeTransformBatch. */
+		virtual void updateSceneGraphBatched();
+		/** Returns whether this SceneManager's nodes can be updated using a 
+			NodeTransformBatch.
+		@remarks
+			Subclasses whose nodes do additional work in _update must return 
+			false here, since the batch bypasses it.
+		*/
+		virtual bool isBatchedSceneGraphUpdateSupported() const { return true; }
+
+		/// Whether to cull the scene graph in bulk
+		bool mBatchedFrustumCulling;
+		/// Bounds of the nodes being culled in bulk, created on demand
+		AxisAlignedBoxBatch* mCullBatch;
+		/// A node considered by findVisibleObjectsBatched
+		struct CullCandidate
+		{
+			SceneNode* node;
+			/// Index of the first child candidate, children are contiguous
+			size_t firstChild;
+			size_t numChildren;
+		};
+		typedef vector<CullCandidate>::type CullCandidateList;
+		CullCandidateList mCullCandidates;
+		/// Visibility of each entry in mCullCandidates
+		vector<uchar>::type mCullVisible;
+		/** Find the visible objects from the root, culling each depth of the 
+			hierarchy in one go using mCullBatch.
+		*/
+		virtual void findVisibleObjectsBatched(Camera* cam, 
+			VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters);
+		/** Add the visible objects of a culled candidate and its descendants to
+			the render queue, in the same order as SceneNode::_findVisibleObjects.
+		@param index Index of the candidate in the list
+		@param candidates The culled candidates
+		@param visible The visibility of each candidate
+		*/
+		void addVisibleCandidate(size_t index, const CullCandidateList& candidates, 
+			const uchar* visible, Camera* cam, RenderQueue* queue, 
+			VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters);
+
+		/// Whether to cull shadow cameras and the main camera together
+		bool mMultiCameraCulling;
+		/// Every node in the scene graph, as culled by cullCameras
+		CullCandidateList mCameraCullCandidates;
+		/// Bounds of mCameraCullCandidates, created on demand
+		AxisAlignedBoxBatch* mCameraCullBatch;
+		/// The results of culling one camera in cullCameras
+		struct CulledCamera
+		{
+			Plane planes[6];
+			size_t numPlanes;
+			/// Visibility of each entry in mCameraCullCandidates
+			vector<uchar>::type visible;
+		};
+		typedef vector<CulledCamera>::type CulledCameraList;
+		CulledCameraList mCulledCameras;
+		/// Index into mCulledCameras of each camera with results waiting
+		typedef map<const Camera*, size_t>::type CulledCameraIndexMap;
+		CulledCameraIndexMap mCulledCameraIndex;
+		/// Task which culls a range of mCameraCullBatch against one camera
+		class CameraCullTask : public ParallelTaskGroup::Task
+		{
+		public:
+			const AxisAlignedBoxBatch* batch;
+			const CulledCamera* camera;
+			uchar* visible;
+			size_t first;
+			size_t count;
+			CameraCullTask(const AxisAlignedBoxBatch* b, CulledCamera* c, size_t f, size_t n)
+				: batch(b), camera(c), visible(&c->visible[0]), first(f), count(n) {}
+			void execute();
+		};
+		typedef vector<CameraCullTask>::type CameraCullTaskList;
+		CameraCullTaskList mCameraCullTasks;
+		typedef vector<Camera*>::type CameraPtrList;
+		/// A shadow texture waiting for its camera to be culled with the others
+		struct PendingShadowTarget
+		{
+			Light* light;
+			Camera* camera;
+			/// Texture iteration for this light
+			size_t iteration;
+			RenderTarget* target;
+		};
+		typedef vector<PendingShadowTarget>::type PendingShadowTargetList;
+		/** Cull the whole scene graph against several cameras at once.
+		@remarks
+			The world bounds of every node are gathered once, then culled
+			against each camera in parallel. The results are kept until 
+			they are used by _findVisibleObjects for that camera, or until the
+			next call.
+		*/
+		virtual void cullCameras(const CameraPtrList& cameras);
+		/** Returns whether this SceneManager can find its visible objects using
+			cullCameras.
+		@remarks
+			Subclasses which find visible objects in their own way, rather than 
+			by walking the scene graph from the root, must return false here.
+		*/
+		virtual bool isMultiCameraCullingSupported() const { return true; }
+
+		/// Whether to sort the render queue using multiple threads
+		bool mParallelRenderQueueSort;
+		/// Task which sorts one collection of the render queue
+		class RenderQueueSortTask : public ParallelTaskGroup::Task
+		{
+		public:
+			QueuedRenderableCollection* collection;
+			const Camera* camera;
+			RenderQueueSortTask(QueuedRenderableCollection* c, const Camera* cam) 
+				: collection(c), camera(cam) {}
+			void execute() { collection->sort(camera); }
+		};
+		typedef vector<RenderQueueSortTask>::type RenderQueueSortTaskList;
+		RenderQueueSortTaskList mRenderQueueSortTasks;
+		RenderPriorityGroup::CollectionList mCollectionsToSort;
+		/** Sort every collection in the render queue which needs it for the 
+			camera in progress, in parallel.
+		@remarks
+			The depths are calculated first, on this thread. Rendering then 
+			finds each collection already sorted.
+		*/
+		virtual void sortRenderQueueParallel(void);
+
+		/// Whether to perform software vertex animation using multiple threads
+		bool mParallelSoftwareAnimation;
+		/// Software animation collected while finding visible objects
+		SoftwareAnimationBatch* mSoftwareAnimationBatch;
+		/// Whether software animation is being collected rather than performed
+		bool mCollectingSoftwareAnimation;
+
+		/// Whether to evaluate the skeletons of visible entities using multiple threads
+		bool mParallelSkeletalAnimation;
+		/// Whether entities being queued should defer their skeletal animation
+		bool mCollectingSkeletalAnimation;
+		/// An entity whose animation was deferred while finding visible objects
+		struct DeferredAnimation
+		{
+			Entity* entity;
+			Entity* displayEntity;
+			RenderQueue* queue;
+		};
+		typedef vector<DeferredAnimation>::type DeferredAnimationList;
+		DeferredAnimationList mDeferredAnimations;
+		/// Task which evaluates the skeleton of one entity
+		class SkeletonUpdateTask : public ParallelTaskGroup::Task
+		{
+		public:
+			Entity* entity;
+			SkeletonUpdateTask(Entity* e) : entity(e) {}
+			void execute();
+		};
+		typedef vector<SkeletonUpdateTask>::type SkeletonUpdateTaskList;
+		SkeletonUpdateTaskList mSkeletonUpdateTasks;
+		set<SkeletonInstance*>::type mSkeletonsToUpdate;
+		/** Evaluate the skeletons of the entities whose animation was deferred
+			in parallel, then finish updating their animation in turn.
+		*/
+		virtual void updateDeferredAnimation(void);
+
 		/// Last light sets
 		uint32 mLastLightHash;
 		unsigned short mLastLightLimit;
@@ -3359,6 +3560,190 @@ namespace Ogre {
 		*/
 		virtual bool getCameraRelativeRendering() const { return mCameraRelativeRendering; }
 
+		/** Set whether to update the scene graph using multiple threads.
+		@remarks
+			When enabled, _updateSceneGraph splits the node hierarchy into 
+			independent subtrees below the root and updates these on the worker
+			threads of the Root WorkQueue (see ParallelTaskGroup). The derived
+			transforms and world bounds produced are identical to a serial update.
+			This is worthwhile for large scene graphs, with many nodes directly 
+			or nearly directly below the root.
+		@note
+			Node::Listener and MovableObject::Listener callbacks made while
+			updating will be called from worker threads, so these must be 
+			threadsafe if this option is enabled. It has no effect on SceneManagers
+			which do not support it (isParallelSceneGraphUpdateSupported), or when
+			OGRE_THREAD_SUPPORT is 0.
+		*/
+		virtual void setParallelSceneGraphUpdate(bool parallel) { mParallelSceneGraphUpdate = parallel; }
+
+		/** Get whether to update the scene graph using multiple threads. */
+		virtual bool getParallelSceneGraphUpdate() const { return mParallelSceneGraphUpdate; }
+
+		/** Set whether to update the scene graph transforms in bulk.
+		@remarks
+			When enabled, _updateSceneGraph keeps a structure-of-arrays copy of
+			the node transforms (see NodeTransformBatch) and updates the derived
+			transforms of each depth of the hierarchy in one go, using SIMD where
+			available, instead of visiting each node in turn. The results are 
+			identical to the normal update. This is worthwhile for large scene 
+			graphs where many nodes move every frame. If the parallel scene graph
+			update is enabled as well, that takes precedence.
+		@note
+			It has no effect on SceneManagers which do not support it
+			(isBatchedSceneGraphUpdateSupported).
+		*/
+		virtual void setBatchedSceneGraphUpdate(bool batched) { mBatchedSceneGraphUpdate = batched; }
+
+		/** Get whether to update the scene graph transforms in bulk. */
+		virtual bool getBatchedSceneGraphUpdate() const { return mBatchedSceneGraphUpdate; }
+
+		/** Set whether to frustum cull the scene in bulk.
+		@remarks
+			When enabled, _findVisibleObjects gathers the world bounds of the 
+			nodes to be tested into an AxisAlignedBoxBatch and culls them several
+			at a time using SIMD where available, rather than testing each node 
+			as it is visited. The objects found, and the order they are queued 
+			in, are identical to the normal path. This is worthwhile for scenes 
+			with many nodes; SceneManagers which partition the scene differently 
+			may use it for their own structures or ignore it.
+		*/
+		virtual void setBatchedFrustumCulling(bool batched) { mBatchedFrustumCulling = batched; }
+
+		/** Get whether to frustum cull the scene in bulk. */
+		virtual bool getBatchedFrustumCulling() const { return mBatchedFrustumCulling; }
+
+		/** Set whether to cull the shadow texture cameras and the main camera 
+			together.
+		@remarks
+			With texture shadows, the scene is normally walked once for each 
+			shadow texture and again for the main camera. When enabled, 
+			the shadow cameras are all set up before any shadow texture is 
+			rendered, then the scene graph is culled against all of them, and 
+			the main camera, in one pass: the bounds of each node are gathered 
+			once and each camera culls them on its own thread (see 
+			_findVisibleObjectsMultiCamera). Rendering then only has to queue 
+			the objects found.
+		@par
+			Because culling happens up front, listeners must not move nodes or 
+			cameras between shadowTextureCasterPreViewProj and the rendering of
+			the shadow textures. The main camera is only culled early if 
+			nothing is auto tracking. It has no effect on SceneManagers which 
+			do not support it (isMultiCameraCullingSupported).
+		*/
+		virtual void setMultiCameraCulling(bool multi) { mMultiCameraCulling = multi; }
+
+		/** Get whether to cull the shadow texture cameras and the main camera together. */
+		virtual bool getMultiCameraCulling() const { return mMultiCameraCulling; }
+
+		/** Set whether to sort the render queue using multiple threads.
+		@remarks
+			Normally each priority group of each queue group is sorted just 
+			before it is rendered. When enabled, every collection in the render
+			queue which needs sorting (transparents, and solids where a depth
+			sort has been requested) is sorted up front, each on its own thread
+			using the WorkQueue. This is worthwhile when several large queue 
+			groups need depth sorting.
+		@note
+			Renderable::getSquaredViewDepth is still called on this thread, 
+			once per item, before the sorting threads start; they only sort
+			the depths gathered.
+		*/
+		virtual void setParallelRenderQueueSort(bool parallel) { mParallelRenderQueueSort = parallel; }
+
+		/** Get whether to sort the render queue using multiple threads. */
+		virtual bool getParallelRenderQueueSort() const { return mParallelRenderQueueSort; }
+
+		/** Set whether to perform software vertex animation (skinning, morph
+			and pose animation) using multiple threads.
+		@remarks
+			Normally an Entity performs its software animation as soon as it is
+			queued for rendering. When enabled, the work of all the entities
+			found visible by a camera is collected instead, and performed in 
+			parallel with one job per Entity once all the visible objects have
+			been found, before firePostFindVisibleObjects. This is worthwhile 
+			when many software animated entities are visible.
+		@note
+			The animated vertex data of an Entity is not written until then, so
+			custom Renderables and RenderQueue listeners must not read it while
+			objects are being queued. Entity::_updateAnimation called outside 
+			of rendering still animates immediately.
+		*/
+		virtual void setParallelSoftwareAnimation(bool parallel) { mParallelSoftwareAnimation = parallel; }
+
+		/** Get whether to perform software vertex animation using multiple threads. */
+		virtual bool getParallelSoftwareAnimation() const { return mParallelSoftwareAnimation; }
+
+		/** Internal method for getting the batch which software animation should
+			be added to, or null if it should be performed immediately.
+		*/
+		virtual SoftwareAnimationBatch* _getSoftwareAnimationBatch(void);
+
+		/** Set whether to evaluate the skeletons of visible entities using 
+			multiple threads.
+		@remarks
+			Normally each Entity applies its animation states to its skeleton 
+			as soon as it is queued for rendering. When enabled, the entities
+			found visible by a camera are collected instead, and once all the
+			visible objects have been found their skeletons are evaluated in 
+			parallel, one task per SkeletonInstance. The rest of each entity's
+			animation, and the queueing of objects attached to its bones, then
+			happens in turn. This is worthwhile for scenes with many animated 
+			characters, and combines with setParallelSoftwareAnimation.
+		@note
+			MovableObject::Listener::objectMoved may be called from other 
+			threads for objects attached to bones.
+		*/
+		virtual void setParallelSkeletalAnimation(bool parallel) { mParallelSkeletalAnimation = parallel; }
+
+		/** Get whether to evaluate the skeletons of visible entities using multiple threads. */
+		virtual bool getParallelSkeletalAnimation() const { return mParallelSkeletalAnimation; }
+
+		/** Internal method called by an Entity being queued to have its skeletal
+			animation evaluated in parallel with that of other entities.
+		@param entity The entity being queued
+		@param displayEntity The entity being displayed for it, whose animation
+			is to be updated
+		@param queue The queue objects attached to its bones are to be added to
+		@returns true if the animation will be updated later, false if the 
+			entity should update it now
+		*/
+		virtual bool _deferSkeletalAnimation(Entity* entity, Entity* displayEntity, 
+			RenderQueue* queue);
+
+		/** Describes a camera to be culled by _findVisibleObjectsMultiCamera. */
+		struct CameraCullTarget
+		{
+			Camera* camera;
+			/// The queue to add the visible objects to
+			RenderQueue* queue;
+			/// Bounds information to update, may be null
+			VisibleObjectsBoundsInfo* visibleBounds;
+			bool onlyShadowCasters;
+		};
+		typedef vector<CameraCullTarget>::type CameraCullTargetList;
+
+		/** Internal method for finding the visible objects of several cameras
+			at once, each into its own render queue.
+		@remarks
+			The scene graph is visited once, gathering the bounds of every node,
+			and the bounds are culled against all the cameras in parallel using 
+			the WorkQueue. The visible objects are then added to the queue of 
+			each camera in turn, since queueing an object updates its per-camera 
+			state; the results are the same as calling _findVisibleObjects for 
+			each camera. Where the SceneManager does not support this 
+			(isMultiCameraCullingSupported), _findVisibleObjects is called for 
+			each camera.
+		@note
+			The scene graph must be up to date (_updateSceneGraph).
+		*/
+		virtual void _findVisibleObjectsMultiCamera(const CameraCullTargetList& targets);
+
+		/** Internal method called by SceneNode when it is attached to or 
+			detached from a parent.
+		*/
+		virtual void _notifySceneNodeHierarchyChanged(void);
+
 
         /** Add a level of detail listener. */
         void addLodListener(LodListener *listener);
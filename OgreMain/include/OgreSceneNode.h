@@ -187,6 +187,10 @@ namespace Ogre {
 		*/
 		virtual void _updateBounds(void);
 
+        /** @copydoc Node::_setDerivedTransform */
+        virtual void _setDerivedTransform(const Quaternion& orientation,
+            const Vector3& position, const Vector3& scale);
+
         /** Internal method which locates any visible objects attached to this node and adds them to the passed in queue.
             @remarks
                 Should only be called by a SceneManager implementation, and only after the _updat method has been called to
@@ -209,6 +213,19 @@ namespace Ogre {
 			VisibleObjectsBoundsInfo* visibleBounds, 
             bool includeChildren = true, bool displayNodes = false, bool onlyShadowCasters = false);
 
+        /** Internal method which adds the objects attached to this node to the queue, as
+            _findVisibleObjects does once this node is known to be visible.
+            @remarks
+                Allows a SceneManager to determine visibility by other means, e.g. in bulk.
+        */
+        virtual void _addVisibleObjects(Camera* cam, RenderQueue* queue, 
+            VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters = false);
+
+        /** Internal method which adds the node axes and bounding box to the queue if 
+            required, as _findVisibleObjects does after visiting the children.
+        */
+        virtual void _addDebugRenderables(RenderQueue* queue, bool displayNodes = false);
+
         /** Gets the axis-aligned bounding box of this node (and hence all subnodes).
         @remarks
             Recommended only if you are extending a SceneManager, because the bounding box returned
@@ -399,6 +399,18 @@ namespace Ogre
 
 		// A pointer to the specific compiler instance used
 		OGRE_THREAD_POINTER(ScriptCompiler, mScriptCompiler);
+
+		// The folder parsed scripts are cached in, blank if not caching
+		String mCacheLocation;
+
+		/// Get the name of the cache file for a script
+		String getCacheFileName(const String& scriptName, const String& groupName) const;
+		/// Load the parsed form of a script from the cache, null if it isn't there or is stale
+		ConcreteNodeListPtr loadCachedScript(const String& scriptName, const String& groupName,
+			const String& source);
+		/// Save the parsed form of a script in the cache
+		void saveCachedScript(const String& scriptName, const String& groupName,
+			const String& source, const ConcreteNodeListPtr& nodes);
 	public:
 		ScriptCompilerManager();
 		virtual ~ScriptCompilerManager();
@@ -423,9 +435,32 @@ namespace Ogre
         const StringVector& getScriptPatterns(void) const;
         /// @copydoc ScriptLoader::parseScript
         void parseScript(DataStreamPtr& stream, const String& groupName);
+		/// @copydoc ScriptLoader::prepareScript
+		Any prepareScript(DataStreamPtr& stream, const String& groupName);
+		/// @copydoc ScriptLoader::parsePreparedScript
+		void parsePreparedScript(DataStreamPtr& stream, const String& groupName, 
+			const Any& prepared);
         /// @copydoc ScriptLoader::getLoadingOrder
         Real getLoadingOrder(void) const;
 
+		/** Sets a folder to keep the parsed form of scripts in.
+		@remarks
+			When set, the tree of nodes parsed from each script is saved in a 
+			binary file in this folder, and the next time the same script is 
+			loaded it is read from there rather than lexed and parsed again. 
+			Each file records the engine version and a hash and the length of 
+			the script's text, so it is ignored and replaced when either 
+			changes. Imports, variables and translation into resources still 
+			happen on every load, so listeners see the same events as before.
+		@par
+			The folder must already exist and be writeable. Set this before 
+			initialising resource groups. A blank path, the default, turns 
+			the cache off.
+		*/
+		void setCacheLocation(const String& path);
+		/// Gets the folder the parsed form of scripts is kept in, blank if none
+		const String& getCacheLocation() const { return mCacheLocation; }
+
 		/** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreDataStream.h"
 #include "OgreStringVector.h"
+#include "OgreAny.h"
 
 namespace Ogre {
 
@@ -76,6 +77,30 @@ namespace Ogre {
 		*/
 		virtual void parseScript(DataStreamPtr& stream, const String& groupName) = 0;
 
+		/** Do the part of parsing a script file which can run in a background thread.
+		@remarks
+			When ResourceGroupManager::setParallelInitialisation is enabled, this is 
+			called from a worker thread for every script in a group before any of 
+			them are parsed, and whatever it returns is passed on to 
+			parsePreparedScript, which is called on the initialising thread in the 
+			usual order. Implementations must only do work which neither depends 
+			on nor changes any shared state, such as tokenising the script; 
+			the default implementation does nothing.
+		@param stream The script, which has already been read into memory
+		@param groupName The name of the resource group the script belongs to
+		@returns Data to be passed to parsePreparedScript, or an empty Any
+		*/
+		virtual Any prepareScript(DataStreamPtr& stream, const String& groupName);
+
+		/** Parse a script file which has been passed to prepareScript.
+		@remarks
+			The stream has been rewound to the start. The default implementation 
+			simply calls parseScript.
+		@param prepared The value returned by prepareScript
+		*/
+		virtual void parsePreparedScript(DataStreamPtr& stream, const String& groupName, 
+			const Any& prepared);
+
 		/** Gets the relative loading order of scripts of this type.
 		@remarks
 			There are dependencies between some kinds of scripts, and to enforce
@@ -246,6 +246,14 @@ namespace Ogre {
         */
         virtual void setAnimationState(const AnimationStateSet& animSet);
 
+        /** Internal method which prepares the animations enabled in the passed
+            in set to be applied, see Animation::_prepareForApply.
+        @remarks
+            Call this on one thread before calling setAnimationState for 
+            different SkeletonInstances from several threads at once.
+        */
+        virtual void _prepareAnimationState(const AnimationStateSet& animSet) const;
+
 
         /** Initialise an animation set suitable for use with this skeleton. 
         @remarks
@@ -293,6 +301,13 @@ namespace Ogre {
 		*/
 		virtual void optimiseAllAnimations(bool preservingIdentityNodeTracks = false);
 
+		/** Pack the node tracks of all of this skeleton's animations, to save
+			memory and speed up sampling them.
+		@see NodeAnimationTrack::pack
+		*/
+		virtual void packAllAnimations(Real translationTolerance = 0.001f, 
+			const Radian& rotationTolerance = Radian(0.001f), Real scaleTolerance = 0.001f);
+
 		/** Allows you to use the animations from another Skeleton object to animate
 			this skeleton.
 		@remarks
@@ -93,6 +93,19 @@ namespace Ogre {
                     // Quaternion rotate            : Rotation to apply at this keyframe
                     // Vector3 translate            : Translation to apply at this keyframe
                     // Vector3 scale                : Scale to apply at this keyframe
+
+            SKELETON_ANIMATION_PACKED_TRACK = 0x4200,
+            // A packed animation track (relates to a single bone), written 
+            // instead of SKELETON_ANIMATION_TRACK for tracks which have been packed
+            // Repeating section (within SKELETON_ANIMATION)
+
+                // unsigned short boneIndex     : Index of bone to apply to
+                // Then for each of translation, rotation and scale:
+                // unsigned int numKeys         : Number of keys in the channel
+                // Vector3 base                 : Minimum of the channel
+                // Vector3 range                : Extent of the channel
+                // float times[numKeys]         : Time of each key
+                // unsigned short values[numKeys * 3] : Quantised value of each key
 		SKELETON_ANIMATION_LINK         = 0x5000
 		// Link to another skeleton, to re-use its animations
 
@@ -0,0 +1,211 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreSoftwareAnimationBatch_H__
+#define __OgreSoftwareAnimationBatch_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreVector3.h"
+
+namespace Ogre
+{
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Animation
+	*  @{
+	*/
+
+	/** Collects software vertex animation (skinning, morphing and pose 
+		blending) so that it can be performed in parallel.
+	@remarks
+		Mesh::softwareVertexBlend, Mesh::softwareVertexMorph and 
+		Mesh::softwareVertexPoseBlend add their work here instead of doing it
+		when given a batch. The hardware buffers involved are locked as the 
+		work is added, on the calling thread, and each is locked only once 
+		however much work uses it; everything is unlocked again by execute().
+	@par
+		The work is divided into jobs, typically one per Entity. The work in 
+		a job is done in the order it was added, on one thread, so that for 
+		example skinning can use the result of a morph; separate jobs run 
+		concurrently on a ParallelTaskGroup. Jobs must therefore not write to
+		the same buffers.
+	*/
+	class _OgreExport SoftwareAnimationBatch : public AnimationAlloc
+	{
+	public:
+		/** Constructor.
+		@param taskGroup The group used to execute the jobs, not owned
+		*/
+		SoftwareAnimationBatch(ParallelTaskGroup* taskGroup);
+		/** Destructor, executes any outstanding work first. */
+		~SoftwareAnimationBatch();
+
+		/** Start a new job, the work added from now on may run in parallel with
+			the work added before.
+		*/
+		void beginJob(void);
+
+		/** Lock a buffer until the batch is executed, or get the data of a
+			buffer the batch has already locked.
+		@remarks
+			A buffer first locked for reading can't be locked again for 
+			writing; an exception is thrown.
+		@param buf The buffer to lock
+		@param options HBL_READ_ONLY for reading, or how to lock it for writing
+		@returns The locked data, valid until execute() is called
+		*/
+		void* lockBuffer(const HardwareVertexBufferSharedPtr& buf, 
+			HardwareBuffer::LockOptions options);
+
+		/** Add a skinning operation to the current job.
+		@remarks
+			The parameters are those of OptimisedUtil::softwareVertexSkinning,
+			except that the blend matrices pointed to by blendMatrices are 
+			copied; the matrices themselves must still exist when the batch is
+			executed.
+		*/
+		void addSkinning(
+			const float *srcPosPtr, float *destPosPtr,
+			const float *srcNormPtr, float *destNormPtr,
+			const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+			const Matrix4* const* blendMatrices, size_t numMatrices,
+			size_t srcPosStride, size_t destPosStride,
+			size_t srcNormStride, size_t destNormStride,
+			size_t blendWeightStride, size_t blendIndexStride,
+			size_t numWeightsPerVertex,
+			size_t numVertices);
+
+		/** Add a morph operation to the current job, see 
+			OptimisedUtil::softwareVertexMorph.
+		*/
+		void addMorph(Real t, const float* srcPos1, const float* srcPos2, 
+			float* dstPos, size_t numVertices);
+
+		/** Add a pose blend to the current job, see Mesh::softwareVertexPoseBlend.
+		@param weight The weight to scale the offsets by
+		@param vertexOffsetMap The offsets, which must still exist when the 
+			batch is executed
+		@param dstPos Positions to add the offsets to, 3 floats per vertex
+		*/
+		void addPoseBlend(Real weight, const map<size_t, Vector3>::type* vertexOffsetMap,
+			float* dstPos);
+
+		/** Add a copy of some locked data to the current job. */
+		void addCopy(void* dst, const void* src, size_t length);
+
+		/** Perform all the work added, in parallel, then unlock the buffers.
+		@remarks
+			This must be called on the thread which added the work, since 
+			unlocking buffers is not threadsafe.
+		*/
+		void execute(void);
+
+		/** Returns whether there is no work to be done. */
+		bool isEmpty(void) const { return mOperations.empty() && mLockedBuffers.empty(); }
+
+		/** Returns the number of jobs executed by the last call to execute(). */
+		size_t getNumJobsExecuted(void) const { return mNumJobsExecuted; }
+
+	protected:
+		enum OperationType
+		{
+			OT_SKINNING,
+			OT_MORPH,
+			OT_POSE_BLEND,
+			OT_COPY
+		};
+		/// One piece of work; what the members mean depends on the type
+		struct Operation
+		{
+			OperationType type;
+			/// Source positions, first source for morph, source for copy
+			const void* src1;
+			/// Source normals, second source for morph, offsets for pose blend
+			const void* src2;
+			/// Destination positions, or destination for copy
+			void* dst1;
+			/// Destination normals
+			float* dst2;
+			const float* blendWeights;
+			const unsigned char* blendIndices;
+			/// Index of the first blend matrix in mBlendMatrices
+			size_t firstBlendMatrix;
+			size_t srcPosStride, destPosStride, srcNormStride, destNormStride;
+			size_t blendWeightStride, blendIndexStride, numWeightsPerVertex;
+			/// Vertices, or bytes for a copy
+			size_t count;
+			/// Morph parameter or pose weight
+			Real t;
+		};
+		typedef vector<Operation>::type OperationList;
+
+		/// Executes the operations of one job
+		class JobTask : public ParallelTaskGroup::Task
+		{
+		public:
+			SoftwareAnimationBatch* batch;
+			size_t first;
+			size_t count;
+			JobTask(SoftwareAnimationBatch* b, size_t f, size_t c) 
+				: batch(b), first(f), count(c) {}
+			void execute(void);
+		};
+		typedef vector<JobTask>::type JobTaskList;
+
+		/// A buffer locked by the batch
+		struct LockedBuffer
+		{
+			/// Keeps the buffer alive while it's locked
+			HardwareVertexBufferSharedPtr buffer;
+			void* data;
+			bool readOnly;
+		};
+		typedef map<HardwareVertexBuffer*, LockedBuffer>::type LockedBufferMap;
+
+		ParallelTaskGroup* mTaskGroup;
+		OperationList mOperations;
+		/// Index into mOperations where each job starts
+		vector<size_t>::type mJobStarts;
+		/// The blend matrices of all the skinning operations
+		vector<const Matrix4*>::type mBlendMatrices;
+		LockedBufferMap mLockedBuffers;
+		JobTaskList mTasks;
+		size_t mNumJobsExecuted;
+
+		/// Perform one operation
+		void executeOperation(const Operation& op);
+	};
+
+	/** @} */
+	/** @} */
+
+}
+
+#endif
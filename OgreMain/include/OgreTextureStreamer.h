@@ -0,0 +1,262 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TextureStreamer_H__
+#define __TextureStreamer_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreSingleton.h"
+#include "OgreResource.h"
+#include "OgreTexture.h"
+#include "OgreWorkQueue.h"
+
+namespace Ogre {
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Resources
+	*  @{
+	*/
+
+	/** Loads textures a few mipmaps at a time, smallest first.
+	@remarks
+		A texture loaded through TextureManager is not usable until every 
+		mipmap level has been read, which stalls the frame for large 
+		textures and makes background loading all-or-nothing. Textures 
+		loaded through this class instead become usable as soon as the 
+		tail of their mipmap chain (the levels no larger than getTailSize) 
+		has been read, which is a small fraction of the file. The larger 
+		levels are then read on the threads of Root::getWorkQueue when the 
+		texture is seen to need them.
+	@par
+		How much detail a texture needs is up to the application, which 
+		should call notifyScreenSize each frame for textures which are on 
+		screen, giving the number of pixels the texture covers. Requests for 
+		textures which cover more of the screen are given a higher priority. 
+		When a memory budget is set, the texture memory used by textures 
+		which haven't been seen recently is reclaimed by dropping their 
+		largest levels, so that the textures on screen can have theirs.
+	@par
+		The image format must store its mipmaps, and its codec should 
+		override ImageCodec::decodeMipmaps so that the levels which aren't 
+		wanted can be skipped rather than decoded; DDSCodec does this. 
+		Volume textures are not supported.
+	@note
+		Streamed textures are manually loaded, with this class as their 
+		loader, so if one is reloaded it goes back to its tail and streams 
+		in the rest again. Call remove before removing a streamed texture 
+		from the TextureManager, which also hands the texture back to the 
+		normal loading from file.
+	*/
+	class _OgreExport TextureStreamer : public Singleton<TextureStreamer>, public ResourceAlloc, 
+		public WorkQueue::RequestHandler, public WorkQueue::ResponseHandler, 
+		public ManualResourceLoader
+	{
+	public:
+		TextureStreamer();
+		virtual ~TextureStreamer();
+
+		/// Initialise the streamer, called by Root
+		void initialise();
+		/// Shut down the streamer, called by Root
+		void shutdown();
+
+		/** Load a texture, reading only the tail of its mipmap chain for now.
+		@remarks
+			The texture is created as a manually loaded texture with this 
+			class as its loader, and is loaded before this method returns.
+			If the texture is already being streamed it is simply returned.
+		@param name The name of the image file, which is also the name of the texture
+		@param group The resource group to read the image from
+		*/
+		TexturePtr load(const String& name, const String& group);
+
+		/** Stop streaming a texture.
+		@remarks
+			Any request in progress is abandoned and the texture keeps the 
+			mipmaps it has. The texture itself is not removed from the 
+			TextureManager; it is no longer manually loaded, so if it is 
+			reloaded it reads the whole image from its file.
+		*/
+		void remove(const String& name);
+
+		/// Return whether a texture is being streamed
+		bool isStreaming(const String& name) const;
+
+		/** Tell the streamer how much of the screen a texture covers this frame.
+		@remarks
+			The largest of the values given during a frame is used. If the 
+			texture needs larger mipmaps than it has to be drawn at this size, 
+			they are requested.
+		@param tex The texture, which must have been loaded with load
+		@param pixels The number of pixels across the largest dimension of the 
+			texture as drawn
+		*/
+		void notifyScreenSize(const TexturePtr& tex, Real pixels);
+
+		/** Return the largest mipmap level of the full image a texture has, 
+			where 0 is the full size image. */
+		size_t getResidentMipmap(const String& name) const;
+
+		/** Return the largest mipmap level of the full image a texture needs 
+			for the size it was last drawn at. */
+		size_t getWantedMipmap(const String& name) const;
+
+		/** Set the largest dimension of the mipmaps read when a texture is 
+			first loaded, default 64. */
+		void setTailSize(size_t pixels) { mTailSize = pixels; }
+		/** Get the largest dimension of the mipmaps read when a texture is 
+			first loaded. */
+		size_t getTailSize() const { return mTailSize; }
+
+		/** Set the amount of texture memory streamed textures may use, in bytes.
+		@remarks
+			The tails of the textures are always kept, and textures used in 
+			the current frame are never reduced, so the budget may still be 
+			exceeded if they need more than it allows. If the budget is 
+			lowered, textures are reduced straight away. 0, the default, means 
+			no limit.
+		*/
+		void setMemoryBudget(size_t bytes);
+		/// Get the amount of texture memory streamed textures may use, in bytes
+		size_t getMemoryBudget() const { return mMemoryBudget; }
+		/// Get the amount of texture memory streamed textures are using, in bytes
+		size_t getMemoryUsage() const;
+
+		/// @copydoc WorkQueue::RequestHandler::handleRequest
+		WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
+		/// @copydoc WorkQueue::ResponseHandler::handleResponse
+		void handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ);
+		/// @copydoc ManualResourceLoader::loadResource
+		void loadResource(Resource* resource);
+
+		/** Override standard Singleton retrieval.
+		@remarks
+		Why do we do this? Well, it's because the Singleton
+		implementation is in a .h file, which means it gets compiled
+		into anybody who includes it. This is needed for the
+		Singleton template to work, but we actually only want it
+		compiled into the implementation of the class based on the
+		Singleton, not all of them. If we don't change this, we get
+		link errors when trying to use the Singleton-based class from
+		an outside dll.
+		@par
+		This method just delegates to the template version anyway,
+		but the implementation stays in this single compilation unit,
+		preventing link errors.
+		*/
+		static TextureStreamer& getSingleton(void);
+		/** Override standard Singleton retrieval.
+		@remarks
+		Why do we do this? Well, it's because the Singleton
+		implementation is in a .h file, which means it gets compiled
+		into anybody who includes it. This is needed for the
+		Singleton template to work, but we actually only want it
+		compiled into the implementation of the class based on the
+		Singleton, not all of them. If we don't change this, we get
+		link errors when trying to use the Singleton-based class from
+		an outside dll.
+		@par
+		This method just delegates to the template version anyway,
+		but the implementation stays in this single compilation unit,
+		preventing link errors.
+		*/
+		static TextureStreamer* getSingletonPtr(void);
+
+	protected:
+		/// Everything known about a texture being streamed
+		struct StreamingTexture
+		{
+			TexturePtr texture;
+			/// Size and format of the full image, as decoded
+			size_t width;
+			size_t height;
+			size_t numFaces;
+			size_t numMipmaps;
+			PixelFormat format;
+			/// The smallest level ever wanted, loaded up front
+			size_t tailMip;
+			/// The largest level in the texture
+			size_t residentMip;
+			/// The largest level needed at the size last drawn
+			size_t wantedMip;
+			/// Screen size the texture was last drawn at, and in which frame
+			Real screenSize;
+			unsigned long lastUsedFrame;
+			/// The request reading larger levels, if one is in progress
+			bool requestPending;
+			size_t requestedMip;
+			WorkQueue::RequestID request;
+		};
+		typedef map<String, StreamingTexture>::type StreamingTextureMap;
+		StreamingTextureMap mTextures;
+
+		/// Data of a request to read mipmaps
+		struct StreamRequest
+		{
+			String name;
+			String group;
+			size_t firstMip;
+			_OgreExport friend std::ostream& operator<<(std::ostream& o, const StreamRequest& r)
+			{ (void)r; return o; }
+		};
+		/// Data of a response with the mipmaps read
+		struct StreamResult
+		{
+			SharedPtr<Image> image;
+			_OgreExport friend std::ostream& operator<<(std::ostream& o, const StreamResult& r)
+			{ (void)r; return o; }
+		};
+
+		uint16 mWorkQueueChannel;
+		/// Whether initialise() has registered us with the work queue
+		bool mInitialised;
+		size_t mTailSize;
+		size_t mMemoryBudget;
+
+		/// Read the levels from firstMip down of an image
+		static void readMipmaps(const String& name, const String& group, 
+			size_t firstMip, Image& image);
+		/// Memory used by a texture with levels from mip down
+		static size_t getMemorySize(const StreamingTexture& st, size_t mip);
+		/// Find the state of a streamed texture, or throw
+		const StreamingTexture& getStreamingTexture(const String& name) const;
+		/// Replace the contents of a texture with new levels
+		void applyImage(StreamingTexture& st, const Image& image, size_t firstMip);
+		/// Request the wanted levels of a texture, if there's room
+		void requestMipmaps(StreamingTexture& st);
+		/// Reduce textures not used this frame until bytesNeeded more will fit
+		bool reclaimMemory(size_t bytesNeeded, const StreamingTexture* keep);
+		/// Drop the levels above firstMip from a texture
+		void dropMipmaps(StreamingTexture& st, size_t firstMip);
+	};
+
+	/** @} */
+	/** @} */
+}
+
+#endif
@@ -0,0 +1,272 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __TiledImage_H__
+#define __TiledImage_H__
+
+#include "OgrePrerequisites.h"
+#include "OgreCommon.h"
+#include "OgreImage.h"
+
+namespace Ogre {
+	/** \addtogroup Core
+	*  @{
+	*/
+	/** \addtogroup Image
+	*  @{
+	*/
+
+	/** Reads rectangles of pixels from an image without decoding the rest of it.
+	@remarks
+		Codecs whose format allows it return one of these from 
+		ImageCodec::createRegionReader. Only the top level of the first face
+		or slice of an image is read.
+	*/
+	class _OgreExport ImageRegionReader : public ImageAlloc
+	{
+	public:
+		virtual ~ImageRegionReader() {}
+
+		/// Get the width of the image
+		virtual size_t getWidth() const = 0;
+		/// Get the height of the image
+		virtual size_t getHeight() const = 0;
+		/// Get the format pixels are read in, which is always accessible
+		virtual PixelFormat getFormat() const = 0;
+
+		/** Read a region of the image.
+		@param region The pixels to read, which must be within the image and
+			have a depth of 1
+		@param dst Where to write them; it must be the same size as region, 
+			and can be of any accessible format
+		*/
+		virtual void readRegion(const Box& region, const PixelBox& dst) = 0;
+	};
+
+	/** Reads regions of uncompressed pixels stored one row after another in
+		a stream, such as the raw 16 bit heightmaps terrain tools write.
+	@remarks
+		The stream must support seeking.
+	*/
+	class _OgreExport RawImageRegionReader : public ImageRegionReader
+	{
+	public:
+		/** Constructor.
+		@param stream The stream to read from
+		@param width, height The size of the image
+		@param format The format of the pixels, which must be accessible
+		@param offset Where the first row starts in the stream, in bytes
+		@param rowPitch Bytes from one row to the next, or 0 if the rows are
+			packed together
+		*/
+		RawImageRegionReader(const DataStreamPtr& stream, size_t width, size_t height,
+			PixelFormat format, size_t offset = 0, size_t rowPitch = 0);
+
+		/// @copydoc ImageRegionReader::getWidth
+		size_t getWidth() const { return mWidth; }
+		/// @copydoc ImageRegionReader::getHeight
+		size_t getHeight() const { return mHeight; }
+		/// @copydoc ImageRegionReader::getFormat
+		PixelFormat getFormat() const { return mFormat; }
+		/// @copydoc ImageRegionReader::readRegion
+		void readRegion(const Box& region, const PixelBox& dst);
+
+	protected:
+		DataStreamPtr mStream;
+		size_t mWidth;
+		size_t mHeight;
+		PixelFormat mFormat;
+		size_t mOffset;
+		size_t mRowPitch;
+	};
+
+	/** Reads regions of an image decoded in full, for the formats which can't
+		be read a region at a time.
+	*/
+	class _OgreExport MemoryImageRegionReader : public ImageRegionReader
+	{
+	public:
+		/** Constructor, decoding an image from a stream.
+		@param stream The encoded image
+		@param type The type of the image, as for Image::load
+		*/
+		MemoryImageRegionReader(DataStreamPtr& stream, const String& type = StringUtil::BLANK);
+
+		/// @copydoc ImageRegionReader::getWidth
+		size_t getWidth() const { return mImage.getWidth(); }
+		/// @copydoc ImageRegionReader::getHeight
+		size_t getHeight() const { return mImage.getHeight(); }
+		/// @copydoc ImageRegionReader::getFormat
+		PixelFormat getFormat() const { return mImage.getFormat(); }
+		/// @copydoc ImageRegionReader::readRegion
+		void readRegion(const Box& region, const PixelBox& dst);
+
+	protected:
+		Image mImage;
+	};
+
+	/** An image which is read a tile at a time, as the tiles are needed, 
+		rather than all at once.
+	@remarks
+		Very large images, such as the heightmaps and splat maps of a whole
+		terrain group, can need more memory than it's reasonable to hold at 
+		once. This divides the image into square tiles and reads each one 
+		from an ImageRegionReader when it's first used. Tiles are kept in a
+		cache, and when the cache grows beyond its size the tiles used least
+		recently are dropped, so only the parts of the image being worked on
+		are ever held in memory.
+	@par
+		Tiles can be used directly with lockTile and unlockTile, or any region
+		can be copied out with readRegion. All methods may be called from 
+		several threads at once, for example by terrains being prepared in 
+		the background.
+	*/
+	class _OgreExport TiledImage : public ImageAlloc
+	{
+	public:
+		/// Default size of the tiles along an edge, in pixels
+		static const size_t DEFAULT_TILE_SIZE;
+		/// Default size of the tile cache, in bytes
+		static const size_t DEFAULT_CACHE_SIZE;
+
+		/** Constructor.
+		@param reader Reads the tiles; the TiledImage takes ownership of it 
+			and deletes it with OGRE_DELETE
+		@param tileSize The size of the tiles along an edge, in pixels
+		@param cacheSize How many bytes of tiles to keep
+		*/
+		TiledImage(ImageRegionReader* reader, size_t tileSize = DEFAULT_TILE_SIZE,
+			size_t cacheSize = DEFAULT_CACHE_SIZE);
+		/** Constructor, reading an image file from a resource group.
+		@remarks
+			If the file's codec can read regions the image is read a tile at
+			a time; otherwise it's decoded in full and the tiles are copied 
+			from it.
+		@param filename The name of the file
+		@param groupName The resource group it's in
+		@param tileSize The size of the tiles along an edge, in pixels
+		@param cacheSize How many bytes of tiles to keep
+		*/
+		TiledImage(const String& filename, const String& groupName, 
+			size_t tileSize = DEFAULT_TILE_SIZE, size_t cacheSize = DEFAULT_CACHE_SIZE);
+		virtual ~TiledImage();
+
+		/** Make a reader for an encoded image, which reads regions straight 
+			from the stream if the codec for it can.
+		@param stream The encoded image
+		@param type The type of the image, as for Image::load; if blank it's
+			worked out from the data
+		*/
+		static ImageRegionReader* createReader(DataStreamPtr& stream, 
+			const String& type = StringUtil::BLANK);
+
+		/// Get the width of the image
+		size_t getWidth() const { return mWidth; }
+		/// Get the height of the image
+		size_t getHeight() const { return mHeight; }
+		/// Get the format of the pixels
+		PixelFormat getFormat() const { return mFormat; }
+		/// Get the size of the tiles along an edge, in pixels
+		size_t getTileSize() const { return mTileSize; }
+		/// Get the number of tiles across the image
+		size_t getNumTilesX() const { return (mWidth + mTileSize - 1) / mTileSize; }
+		/// Get the number of tiles down the image
+		size_t getNumTilesY() const { return (mHeight + mTileSize - 1) / mTileSize; }
+		/** Get the pixels of the image a tile covers; tiles at the right and
+			bottom edges may be smaller than the others. */
+		Box getTileBox(size_t tileX, size_t tileY) const;
+
+		/** Get the pixels of a tile, reading it if it isn't in the cache.
+		@remarks
+			The tile stays in the cache, and the PixelBox stays valid, until
+			unlockTile is called as many times as this was. The box is the 
+			size of the tile with its origin at 0; getTileBox says where it 
+			is in the image.
+		*/
+		PixelBox lockTile(size_t tileX, size_t tileY);
+		/// Let a tile locked with lockTile be dropped from the cache again
+		void unlockTile(size_t tileX, size_t tileY);
+
+		/** Copy a region of the image, reading whichever tiles it covers.
+		@param region The pixels to copy, which must be within the image and
+			have a depth of 1
+		@param dst Where to write them; it must be the same size as region, 
+			and can be of any accessible format
+		*/
+		void readRegion(const Box& region, const PixelBox& dst);
+
+		/** Set how many bytes of tiles to keep.
+		@remarks
+			Tiles which are locked are kept even if that's more than this.
+		*/
+		void setCacheSize(size_t bytes);
+		/// Get how many bytes of tiles to keep
+		size_t getCacheSize() const { return mCacheSize; }
+		/// Get how many bytes the tiles in the cache use
+		size_t getCacheMemoryUsage() const;
+		/// Get the number of tiles in the cache
+		size_t getNumCachedTiles() const;
+		/// Get the number of times a tile has been read, for tuning the cache
+		size_t getNumTileReads() const { return mNumTileReads; }
+		/// Drop all the tiles which aren't locked from the cache
+		void clearCache();
+
+	protected:
+		struct Tile
+		{
+			uchar* data;
+			size_t size;
+			size_t locks;
+			/// Where the tile is in mRecentTiles
+			list<size_t>::type::iterator recent;
+		};
+		/// Tiles by their index, tileY * getNumTilesX() + tileX
+		typedef map<size_t, Tile>::type TileMap;
+
+		ImageRegionReader* mReader;
+		size_t mWidth;
+		size_t mHeight;
+		PixelFormat mFormat;
+		size_t mTileSize;
+		size_t mCacheSize;
+		size_t mMemoryUsage;
+		size_t mNumTileReads;
+		TileMap mTiles;
+		/// Indices of the cached tiles, most recently used first
+		list<size_t>::type mRecentTiles;
+		OGRE_AUTO_MUTEX
+
+		void init();
+		/// Drop the least recently used tiles which aren't locked until within bytes
+		void evict(size_t bytes);
+	};
+
+	/** @} */
+	/** @} */
+}
+
+#endif
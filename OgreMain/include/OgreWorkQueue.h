@@ -82,6 +82,7 @@ namespace Ogre
 		class _OgreExport Request : public UtilityAlloc
 		{
 			friend class WorkQueue;
+			friend class DefaultWorkQueueBase;
 		protected:
 			/// The request channel, as an integer 
 			uint16 mChannel;
@@ -95,10 +96,13 @@ namespace Ogre
 			RequestID mID;
 			/// Abort Flag
 			mutable bool mAborted;
+			/// Priority; requests with higher values are processed first
+			int mPriority;
 
 		public:
 			/// Constructor 
-			Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid);
+			Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid, 
+				int priority = 0);
 			~Request();
 			/// Set the abort flag
 			void abortRequest() const { mAborted = true; }
@@ -114,6 +118,8 @@ namespace Ogre
 			RequestID getID() const { return mID; }
 			/// Get the abort flag
 			bool getAborted() const { return mAborted; }
+			/// Get the priority of the request
+			int getPriority() const { return mPriority; }
 		};
 
 		/** General purpose response structure. 
@@ -128,6 +134,8 @@ namespace Ogre
 			String mMessages;
 			/// Data associated with the result of the process
 			Any mData;
+			/// Whether a handler yielded during its last call
+			mutable bool mYielded;
 
 		public:
 			Response(const Request* rq, bool success, const Any& data, const String& msg = StringUtil::BLANK);
@@ -142,6 +150,19 @@ namespace Ogre
 			const Any& getData() const { return mData; }
 			/// Abort the request
 			void abortRequest() { mRequest->abortRequest(); mData.destroy(); }
+			/** Indicate that the handler has only done part of the work for this
+				response, and wants to be called with it again later.
+			@remarks
+				A ResponseHandler can call this from handleResponse when it has 
+				more work to do than it should do in one frame, such as a large 
+				upload to the GPU. The response is then kept, and the handler is
+				called with it again on the next call to processResponses, until
+				it returns without yielding. Queues which don't support this 
+				ignore it, and destroy the response as usual.
+			*/
+			void yield() const { mYielded = true; }
+			/// Return whether the handler yielded during its last call
+			bool hasYielded() const { return mYielded; }
 		};
 
 		/** Interface definition for a handler of requests. 
@@ -211,7 +232,11 @@ namespace Ogre
 			@param res The Response structure. The caller is responsible for
 			deleting this after the call is made, none of the data contained
 			(except pointers to structures in user Any data) will persist
-			after this call is returned.
+			after this call is returned, unless the handler calls 
+			Response::yield to continue with it in a later frame. A handler 
+			which has yielded is called again even if the request has since
+			been aborted, so that it can release what it holds; it should check
+			Request::getAborted.
 			@param srcQ The work queue that this request originated from
 			*/
 			virtual void handleResponse(const Response* res, const WorkQueue* srcQ) = 0;
@@ -266,23 +291,65 @@ namespace Ogre
 		virtual RequestID addRequest(uint16 channel, uint16 requestType, const Any& rData, uint8 retryCount = 0, 
 			bool forceSynchronous = false) = 0;
 
+		/** Add a new request to the queue, with a priority.
+		@remarks
+			Waiting requests with a higher priority are processed before those 
+			with a lower one, and requests with the same priority are processed 
+			in the order they were added. Requests added through addRequest have 
+			priority 0. The default implementation, for queues which don't 
+			support priorities, ignores the priority and calls addRequest.
+		@param priority The priority of the request; may be negative
+		@see WorkQueue::addRequest, WorkQueue::setRequestPriority
+		*/
+		virtual RequestID addRequestWithPriority(uint16 channel, uint16 requestType, const Any& rData, 
+			int priority, uint8 retryCount = 0, bool forceSynchronous = false)
+		{
+			(void)priority;
+			return addRequest(channel, requestType, rData, retryCount, forceSynchronous);
+		}
+
+		/** Change the priority of a previously issued request.
+		@remarks
+			This allows work which has become less urgent, such as a page which 
+			is no longer in view, to be moved behind other requests after it has 
+			been queued.
+		@param id The ID of the previously issued request.
+		@param priority The new priority
+		@returns true if the request was still waiting to be processed; false if 
+			it has already been picked up, or if the queue doesn't support
+			priorities (the default implementation).
+		*/
+		virtual bool setRequestPriority(RequestID id, int priority) 
+		{ (void)id; (void)priority; return false; }
+
 		/** Abort a previously issued request.
-		If the request is still waiting to be processed, it will be 
-		removed from the queue.
+		@remarks
+		The request is flagged as aborted wherever it is; it is not removed 
+		from the queue. A request still waiting to be processed is passed to
+		the request handlers as usual, one being processed still completes,
+		and any response is still passed to the response handlers, with its 
+		data already destroyed. The default RequestHandler::canHandleRequest
+		and ResponseHandler::canHandleResponse turn away aborted requests, so
+		they are simply deleted; handlers which override those to accept 
+		them must check Request::getAborted, and release anything they own 
+		for the request rather than process it. A response handler which 
+		has yielded is called again in the same way.
 		@param id The ID of the previously issued request.
 		*/
 		virtual void abortRequest(RequestID id) = 0;
 
 		/** Abort all previously issued requests in a given channel.
-		Any requests still waiting to be processed of the given channel, will be 
-		removed from the queue.
+		@remarks
+		The requests are flagged as aborted, and are then delivered in the 
+		same way as for abortRequest.
 		@param channel The type of request to be aborted
 		*/
 		virtual void abortRequestsByChannel(uint16 channel) = 0;
 
 		/** Abort all previously issued requests.
-		Any requests still waiting to be processed will be removed from the queue.
-		Any requests that are being processed will still complete.
+		@remarks
+		The requests are flagged as aborted, and are then delivered in the 
+		same way as for abortRequest.
 		*/
 		virtual void abortAllRequests() = 0;
 		
@@ -310,6 +377,7 @@ namespace Ogre
 			try to clear all responses before returning = 0; however, you can specify
 			a time limit on the response processing to limit the impact of
 			spikes in demand by calling setResponseProcessingTimeLimit.
+			Responses are processed in order of the priority of their requests.
 		*/
 		virtual void processResponses() = 0; 
 
@@ -418,6 +486,11 @@ namespace Ogre
 		/// @copydoc WorkQueue::addRequest
 		virtual RequestID addRequest(uint16 channel, uint16 requestType, const Any& rData, uint8 retryCount = 0, 
 			bool forceSynchronous = false);
+		/// @copydoc WorkQueue::addRequestWithPriority
+		virtual RequestID addRequestWithPriority(uint16 channel, uint16 requestType, const Any& rData, 
+			int priority, uint8 retryCount = 0, bool forceSynchronous = false);
+		/// @copydoc WorkQueue::setRequestPriority
+		virtual bool setRequestPriority(RequestID id, int priority);
 		/// @copydoc WorkQueue::abortRequest
 		virtual void abortRequest(RequestID id);
 		/// @copydoc WorkQueue::abortRequestsByChannel
@@ -438,6 +511,71 @@ namespace Ogre
 		virtual unsigned long getResponseProcessingTimeLimit() const { return mResposeTimeLimitMS; }
 		/// @copydoc WorkQueue::setResponseProcessingTimeLimit
 		virtual void setResponseProcessingTimeLimit(unsigned long ms) { mResposeTimeLimitMS = ms; }
+
+		/** Limit the number of requests from one channel which are processed 
+			at the same time.
+		@remarks
+			By default a channel can occupy every worker thread. Limiting it 
+			stops one busy source of work, such as terrain page loading, from 
+			holding up the requests of every other channel; requests from a
+			channel which is at its limit stay in the queue until one of its
+			requests completes.
+		@param channel The channel to limit
+		@param maxWorkers The maximum number of requests processed at once, or 
+			0 for no limit
+		*/
+		virtual void setChannelWorkerLimit(uint16 channel, size_t maxWorkers);
+		/** Get the maximum number of requests from a channel which are processed
+			at the same time (0 indicates no limit). */
+		virtual size_t getChannelWorkerLimit(uint16 channel) const;
+
+		/** Set the time limit imposed on the processing of responses from one 
+			channel in a single frame, in milliseconds (0 indicates no limit).
+		@remarks
+			Once a channel has used its time, its remaining responses are left 
+			for the next frame, while responses from other channels carry on 
+			being processed within the overall limit set by 
+			setResponseProcessingTimeLimit. This stops one expensive kind of 
+			response, such as uploading terrain to the GPU, from starving the 
+			others. A handler can't be interrupted, so handlers with a lot of 
+			work to do should also split it up using Response::yield.
+		*/
+		virtual void setChannelResponseTimeLimit(uint16 channel, unsigned long ms);
+		/** Get the time limit imposed on the processing of responses from one
+			channel in a single frame, in milliseconds (0 indicates no limit).
+		*/
+		virtual unsigned long getChannelResponseTimeLimit(uint16 channel) const;
+
+		/** Statistics about the requests in one channel, for monitoring.
+		@remarks
+			All times are in microseconds. Times are measured for requests 
+			which have finished processing since the statistics were last reset.
+		*/
+		struct ChannelStatistics
+		{
+			/// Number of requests waiting to be processed
+			size_t queueDepth;
+			/// Number of requests being processed
+			size_t activeRequests;
+			/// Number of requests which have been processed
+			size_t processedRequests;
+			/// Total time processed requests spent waiting in the queue
+			unsigned long long totalWaitTime;
+			/// Longest time a processed request spent waiting in the queue
+			unsigned long maxWaitTime;
+			/// Total time spent processing requests
+			unsigned long long totalServiceTime;
+			/// Longest time spent processing a request
+			unsigned long maxServiceTime;
+
+			ChannelStatistics() 
+				: queueDepth(0), activeRequests(0), processedRequests(0), totalWaitTime(0)
+				, maxWaitTime(0), totalServiceTime(0), maxServiceTime(0) {}
+		};
+		/** Get the statistics for a channel. */
+		virtual ChannelStatistics getChannelStatistics(uint16 channel) const;
+		/** Reset the statistics of all channels. */
+		virtual void resetStatistics();
 	protected:
 		String mName;
 		size_t mWorkerThreadCount;
@@ -447,10 +585,65 @@ namespace Ogre
 
 		typedef deque<Request*>::type RequestQueue;
 		typedef deque<Response*>::type ResponseQueue;
-		RequestQueue mRequestQueue;
 		RequestQueue mProcessQueue;
 		ResponseQueue mResponseQueue;
 
+		typedef list<ResponseHandler*>::type ResponseHandlerList;
+		/// A response which handlers have yielded on, to be continued next frame
+		struct YieldedResponse
+		{
+			Response* response;
+			/// The handlers which yielded
+			ResponseHandlerList handlers;
+		};
+		typedef list<YieldedResponse>::type YieldedResponseList;
+		/// Responses to continue, guarded by mResponseMutex
+		YieldedResponseList mYieldedResponses;
+		typedef map<uint16, unsigned long>::type ChannelTimeLimitMap;
+		/// Per channel response time limits, in milliseconds
+		ChannelTimeLimitMap mChannelResponseTimeLimits;
+
+		/// Orders waiting requests by descending priority, then by the order they were added
+		struct RequestPriorityLess
+		{
+			bool operator()(const Request* a, const Request* b) const
+			{
+				if (a->getPriority() != b->getPriority())
+					return a->getPriority() > b->getPriority();
+				return a->getID() < b->getID();
+			}
+		};
+		typedef set<Request*, RequestPriorityLess>::type PriorityRequestQueue;
+		/// The waiting requests and settings of one channel
+		struct ChannelState
+		{
+			PriorityRequestQueue requests;
+			/// Number of requests being processed
+			size_t activeRequests;
+			/// Maximum number of requests processed at once (0 for no limit)
+			size_t workerLimit;
+			/// Totals since the statistics were reset; the counts are filled in on request
+			ChannelStatistics statistics;
+
+			ChannelState() : activeRequests(0), workerLimit(0) {}
+		};
+		typedef map<uint16, ChannelState>::type ChannelStateMap;
+		/// Waiting requests per channel, guarded by mRequestMutex
+		ChannelStateMap mChannelStates;
+		/// A request waiting to be processed
+		struct PendingRequest
+		{
+			Request* request;
+			/// When the request was queued
+			unsigned long queueTime;
+		};
+		typedef HashMap<RequestID, PendingRequest> PendingRequestMap;
+		/// Waiting requests by ID, guarded by mRequestMutex
+		PendingRequestMap mPendingRequests;
+		/// Timer used for the statistics
+		Timer* mTimer;
+		OGRE_MUTEX(mTimerMutex)
+
 		/// Thread function
 		struct WorkerFunc OGRE_THREAD_WORKER_INHERIT
 		{
@@ -515,7 +708,6 @@ namespace Ogre
 		typedef SharedPtr<RequestHandlerHolder> RequestHandlerHolderPtr;
 
 		typedef list<RequestHandlerHolderPtr>::type RequestHandlerList;
-		typedef list<ResponseHandler*>::type ResponseHandlerList;
 		typedef map<uint16, RequestHandlerList>::type RequestHandlerListByChannel;
 		typedef map<uint16, ResponseHandlerList>::type ResponseHandlerListByChannel;
 
@@ -532,13 +724,29 @@ namespace Ogre
 		OGRE_RW_MUTEX(mRequestHandlerMutex);
 
 
+		/// Put a request in the queue of its channel; mRequestMutex must be locked
+		void queueRequest(Request* r);
+		/** Take the highest priority request of any channel which isn't at its
+			worker limit off the queue; mRequestMutex must be locked. */
+		Request* takeNextRequest();
+		/// Return whether takeNextRequest would find a request; mRequestMutex must be locked
+		bool hasRunnableRequests() const;
+		/// Get the current time for the statistics, in microseconds
+		unsigned long getStatisticsTime();
+
 		void processRequestResponse(Request* r, bool synchronous);
 		Response* processRequest(Request* r);
+		/// Pass a response to its handlers, and delete it unless one of them yielded
 		void processResponse(Response* r);
+		/// Call the handlers which yielded on a response again
+		void continueResponse(YieldedResponse& y);
+		/// Delete a response, or keep it for the handlers which yielded on it
+		void finishResponse(Response* r, const ResponseHandlerList& yielded);
 		/// Notify workers about a new request. 
 		virtual void notifyWorkers() = 0;
 		/// Put a Request on the queue with a specific RequestID.
-		void addRequestWithRID(RequestID rid, uint16 channel, uint16 requestType, const Any& rData, uint8 retryCount);
+		void addRequestWithRID(RequestID rid, uint16 channel, uint16 requestType, const Any& rData, 
+			uint8 retryCount, int priority);
 
 	};
 
@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
 #include "OgreStringConverter.h"
+#include "OgreSoftwareAnimationBatch.h"
 
 namespace Ogre {
 
@@ -373,7 +374,7 @@ namespace Ogre {
     }
 	//---------------------------------------------------------------------
 	void Animation::apply(Entity* entity, Real timePos, Real weight, 
-		bool software, bool hardware)
+		bool software, bool hardware, SoftwareAnimationBatch* batch)
 	{
         // Calculate time index for fast keyframe search
         TimeIndex timeIndex = _getTimeIndex(timePos);
@@ -425,11 +426,21 @@ namespace Ogre {
 						origVertexData->vertexBufferBinding->getBuffer(origelem->getSource());
 					HardwareVertexBufferSharedPtr destBuffer = 
 						swVertexData->vertexBufferBinding->getBuffer(destelem->getSource());
-					destBuffer->copyData(*origBuffer.get(), 0, 0, destBuffer->getSizeInBytes(), true);
+					if (batch)
+					{
+						// The original buffer may already be locked by the batch
+						const void* pSrc = batch->lockBuffer(origBuffer, HardwareBuffer::HBL_READ_ONLY);
+						void* pDst = batch->lockBuffer(destBuffer, HardwareBuffer::HBL_DISCARD);
+						batch->addCopy(pDst, pSrc, destBuffer->getSizeInBytes());
+					}
+					else
+					{
+						destBuffer->copyData(*origBuffer.get(), 0, 0, destBuffer->getSizeInBytes(), true);
+					}
 				}
 				track->setTargetMode(VertexAnimationTrack::TM_SOFTWARE);
 				track->applyToVertexData(swVertexData, timeIndex, weight, 
-					&(entity->getMesh()->getPoseList()));
+					&(entity->getMesh()->getPoseList()), batch);
 			}
 			if (hardware)
 			{
@@ -580,6 +591,16 @@ namespace Ogre {
 		}
 	}
 	//-----------------------------------------------------------------------
+	void Animation::packNodeTracks(Real translationTolerance, 
+		const Radian& rotationTolerance, Real scaleTolerance)
+	{
+		NodeTrackList::iterator i;
+		for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
+		{
+			i->second->pack(translationTolerance, rotationTolerance, scaleTolerance);
+		}
+	}
+	//-----------------------------------------------------------------------
 	void Animation::optimiseVertexTracks(void)
 	{
 		// Iterate over the node tracks and identify those with no useful keyframes
@@ -663,6 +684,24 @@ namespace Ogre {
         return TimeIndex(timePos, std::distance(mKeyFrameTimes.begin(), it));
     }
     //-----------------------------------------------------------------------
+    void Animation::_prepareForApply(void) const
+    {
+        if (mKeyFrameTimesDirty)
+        {
+            buildKeyFrameTimeList();
+        }
+
+        // Splines are only used by node tracks, and only when interpolating them
+        if (mInterpolationMode == IM_SPLINE)
+        {
+            NodeTrackList::const_iterator i;
+            for (i = mNodeTrackList.begin(); i != mNodeTrackList.end(); ++i)
+            {
+                i->second->_buildInterpolationSplines();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void Animation::buildKeyFrameTimeList(void) const
     {
         NodeTrackList::const_iterator i;
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreHardwareBufferManager.h"
 #include "OgreMesh.h"
 #include "OgreException.h"
+#include "OgrePackedTransformTrack.h"
 
 namespace Ogre {
 
@@ -358,7 +359,7 @@ namespace Ogre {
 	NodeAnimationTrack::NodeAnimationTrack(Animation* parent, unsigned short handle)
 		: AnimationTrack(parent, handle), mTargetNode(0)
         , mSplines(0), mSplineBuildNeeded(false)
-        , mUseShortestRotationPath(true)
+        , mUseShortestRotationPath(true), mPacked(0)
 	{
 	}
 	//---------------------------------------------------------------------
@@ -366,13 +367,14 @@ namespace Ogre {
 		Node* targetNode)
 		: AnimationTrack(parent, handle), mTargetNode(targetNode)
         , mSplines(0), mSplineBuildNeeded(false)
-        , mUseShortestRotationPath(true)
+        , mUseShortestRotationPath(true), mPacked(0)
 	{
 	}
     //---------------------------------------------------------------------
     NodeAnimationTrack::~NodeAnimationTrack()
     {
         OGRE_DELETE_T(mSplines, Splines, MEMCATEGORY_ANIMATION);
+        OGRE_DELETE mPacked;
     }
 	//---------------------------------------------------------------------
     void NodeAnimationTrack::getInterpolatedKeyFrame(const TimeIndex& timeIndex, KeyFrame* kf) const
@@ -385,6 +387,13 @@ namespace Ogre {
 
 		TransformKeyFrame* kret = static_cast<TransformKeyFrame*>(kf);
 
+		if (mPacked)
+		{
+			mPacked->sample(timeIndex.getTimePos(), mParent->getLength(),
+				mParent->getRotationInterpolationMode(), kret);
+			return;
+		}
+
         // Keyframe pointers
 		KeyFrame *kBase1, *kBase2;
         TransformKeyFrame *k1, *k2;
@@ -479,7 +488,7 @@ namespace Ogre {
 		Real scl)
     {
 		// Nothing to do if no keyframes or zero weight or no node
-		if (mKeyFrames.empty() || !weight || !node)
+		if ((mKeyFrames.empty() && !mPacked) || !weight || !node)
 			return;
 
         TransformKeyFrame kf(0, timeIndex.getTimePos());
@@ -571,6 +580,9 @@ namespace Ogre {
     //---------------------------------------------------------------------
 	bool NodeAnimationTrack::hasNonZeroKeyFrames(void) const
 	{
+		if (mPacked)
+			return mPacked->hasNonZeroKeyFrames();
+
         KeyFrameList::const_iterator i = mKeyFrames.begin();
         for (; i != mKeyFrames.end(); ++i)
         {
@@ -651,10 +663,36 @@ namespace Ogre {
 		}
 
 
+	}
+	//--------------------------------------------------------------------------
+	void NodeAnimationTrack::pack(Real translationTolerance, 
+		const Radian& rotationTolerance, Real scaleTolerance)
+	{
+		// Nothing to pack, or already packed
+		if (mKeyFrames.empty())
+			return;
+
+		PackedTransformTrack* packed = OGRE_NEW PackedTransformTrack();
+		packed->build(this, translationTolerance, rotationTolerance, scaleTolerance);
+
+		removeAllKeyFrames();
+		_setPackedData(packed);
+	}
+	//--------------------------------------------------------------------------
+	void NodeAnimationTrack::_setPackedData(PackedTransformTrack* packed)
+	{
+		OGRE_DELETE mPacked;
+		mPacked = packed;
 	}
 	//--------------------------------------------------------------------------
 	KeyFrame* NodeAnimationTrack::createKeyFrameImpl(Real time)
 	{
+		if (mPacked)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+				"Keyframes cannot be added to a packed track.",
+				"NodeAnimationTrack::createKeyFrameImpl");
+		}
 		return OGRE_NEW TransformKeyFrame(this, time);
 	}
 	//--------------------------------------------------------------------------
@@ -674,6 +712,10 @@ namespace Ogre {
 			newParent->createNodeTrack(mHandle, mTargetNode);
 		newTrack->mUseShortestRotationPath = mUseShortestRotationPath;
 		populateClone(newTrack);
+		// Splines are built from the keyframes, which have just changed
+		newTrack->_keyFrameDataChanged();
+		if (mPacked)
+			newTrack->mPacked = OGRE_NEW PackedTransformTrack(*mPacked);
 		return newTrack;
 	}	
 	//--------------------------------------------------------------------------
@@ -718,7 +760,8 @@ namespace Ogre {
 	}
 	//--------------------------------------------------------------------------
 	void VertexAnimationTrack::applyToVertexData(VertexData* data,
-		const TimeIndex& timeIndex, Real weight, const PoseList* poseList)
+		const TimeIndex& timeIndex, Real weight, const PoseList* poseList,
+		SoftwareAnimationBatch* batch)
 	{
 		// Nothing to do if no keyframes or no vertex data
 		if (mKeyFrames.empty() || !data)
@@ -761,7 +804,7 @@ namespace Ogre {
 				// If target mode is software, need to software interpolate each vertex
 
 				Mesh::softwareVertexMorph(
-					t, vkf1->getVertexBuffer(), vkf2->getVertexBuffer(), data);
+					t, vkf1->getVertexBuffer(), vkf2->getVertexBuffer(), data, batch);
 			}
 		}
 		else
@@ -798,7 +841,7 @@ namespace Ogre {
 				assert (p1->poseIndex <= poseList->size());
 				Pose* pose = (*poseList)[p1->poseIndex];
 				// apply
-				applyPoseToVertexData(pose, data, influence);
+				applyPoseToVertexData(pose, data, influence, batch);
 			}
 			// Now deal with any poses in key 2 which are not in key 1
 			for (VertexPoseKeyFrame::PoseRefList::const_iterator p2 = poseList2.begin();
@@ -824,14 +867,14 @@ namespace Ogre {
 					assert (p2->poseIndex <= poseList->size());
 					const Pose* pose = (*poseList)[p2->poseIndex];
 					// apply
-					applyPoseToVertexData(pose, data, influence);
+					applyPoseToVertexData(pose, data, influence, batch);
 				}
 			} // key 2 iteration
 		} // morph or pose animation
 	}
 	//-----------------------------------------------------------------------------
 	void VertexAnimationTrack::applyPoseToVertexData(const Pose* pose,
-		VertexData* data, Real influence)
+		VertexData* data, Real influence, SoftwareAnimationBatch* batch)
 	{
 		if (mTargetMode == TM_HARDWARE)
 		{
@@ -859,7 +902,7 @@ namespace Ogre {
 		else
 		{
 			// Software
-			Mesh::softwareVertexPoseBlend(influence, pose->getVertexOffsets(), data);
+			Mesh::softwareVertexPoseBlend(influence, pose->getVertexOffsets(), data, batch);
 		}
 
 	}
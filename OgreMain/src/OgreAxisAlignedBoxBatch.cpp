@@ -0,0 +1,166 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreAxisAlignedBoxBatch.h"
+#include "OgreAxisAlignedBox.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	AxisAlignedBoxBatch::AxisAlignedBoxBatch()
+		: mNumBoxes(0)
+		, mCapacity(0)
+		, mStorage(0)
+	{
+		memset(&mBounds, 0, sizeof(mBounds));
+	}
+	//---------------------------------------------------------------------
+	AxisAlignedBoxBatch::~AxisAlignedBoxBatch()
+	{
+		if (mStorage)
+			OGRE_FREE_SIMD(mStorage, MEMCATEGORY_GENERAL);
+	}
+	//---------------------------------------------------------------------
+	void AxisAlignedBoxBatch::clear(void)
+	{
+		mNumBoxes = 0;
+		mExtents.clear();
+	}
+	//---------------------------------------------------------------------
+	size_t AxisAlignedBoxBatch::addBox(const AxisAlignedBox& box)
+	{
+		if (mNumBoxes == mCapacity)
+			reserve(mCapacity ? mCapacity * 2 : 64);
+
+		size_t index = mNumBoxes++;
+		if (box.isNull())
+		{
+			mExtents.push_back(AxisAlignedBox::EXTENT_NULL);
+		}
+		else if (box.isInfinite())
+		{
+			mExtents.push_back(AxisAlignedBox::EXTENT_INFINITE);
+		}
+		else
+		{
+			mExtents.push_back(AxisAlignedBox::EXTENT_FINITE);
+		}
+
+		if (box.isFinite())
+		{
+			// Same calculation as AxisAlignedBox::getCenter / getHalfSize
+			const Vector3& minimum = box.getMinimum();
+			const Vector3& maximum = box.getMaximum();
+			for (size_t c = 0; c < 3; ++c)
+			{
+				mBounds.centre[c][index] = (maximum[c] + minimum[c]) * 0.5f;
+				mBounds.halfSize[c][index] = (maximum[c] - minimum[c]) * 0.5f;
+			}
+		}
+		else
+		{
+			for (size_t c = 0; c < 3; ++c)
+			{
+				mBounds.centre[c][index] = 0;
+				mBounds.halfSize[c][index] = 0;
+			}
+		}
+		return index;
+	}
+	//---------------------------------------------------------------------
+	void AxisAlignedBoxBatch::cull(const Plane* planes, size_t numPlanes)
+	{
+		mVisible.resize(mNumBoxes);
+		if (!mNumBoxes)
+			return;
+
+		cull(planes, numPlanes, &mVisible[0], 0, mNumBoxes);
+	}
+	//---------------------------------------------------------------------
+	void AxisAlignedBoxBatch::cull(const Plane* planes, size_t numPlanes, 
+		uchar* visible, size_t first, size_t count) const
+	{
+		assert(first + count <= mNumBoxes && "Range is outside the batch");
+		if (!count)
+			return;
+
+		OptimisedUtil::BoundsSoA bounds;
+		for (size_t c = 0; c < 3; ++c)
+		{
+			bounds.centre[c] = mBounds.centre[c] + first;
+			bounds.halfSize[c] = mBounds.halfSize[c] + first;
+		}
+		OptimisedUtil::getImplementation()->cullAxisAlignedBoxes(
+			planes, numPlanes, bounds, visible + first, count);
+
+		for (size_t i = first; i < first + count; ++i)
+		{
+			switch (mExtents[i])
+			{
+			case AxisAlignedBox::EXTENT_NULL:
+				visible[i] = 0;
+				break;
+			case AxisAlignedBox::EXTENT_INFINITE:
+				visible[i] = 1;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void AxisAlignedBoxBatch::reserve(size_t capacity)
+	{
+		if (capacity <= mCapacity)
+			return;
+
+		// Keep every component array SIMD aligned
+		capacity = (capacity + 3) & ~static_cast<size_t>(3);
+		Real* storage = static_cast<Real*>(OGRE_MALLOC_SIMD(
+			sizeof(Real) * 6 * capacity, MEMCATEGORY_GENERAL));
+
+		OptimisedUtil::BoundsSoA bounds;
+		for (size_t c = 0; c < 3; ++c)
+		{
+			bounds.centre[c] = storage + c * capacity;
+			bounds.halfSize[c] = storage + (3 + c) * capacity;
+			if (mNumBoxes)
+			{
+				memcpy(bounds.centre[c], mBounds.centre[c], sizeof(Real) * mNumBoxes);
+				memcpy(bounds.halfSize[c], mBounds.halfSize[c], sizeof(Real) * mNumBoxes);
+			}
+		}
+
+		if (mStorage)
+			OGRE_FREE_SIMD(mStorage, MEMCATEGORY_GENERAL);
+		mStorage = storage;
+		mBounds = bounds;
+		mCapacity = capacity;
+		mExtents.reserve(capacity);
+	}
+}
@@ -853,6 +853,30 @@ namespace Ogre {
 		}
 	}
 	//-----------------------------------------------------------------------
+	void Camera::isVisible(AxisAlignedBoxBatch& bounds) const
+	{
+		if (mCullFrustum)
+		{
+			mCullFrustum->isVisible(bounds);
+		}
+		else
+		{
+			Frustum::isVisible(bounds);
+		}
+	}
+	//-----------------------------------------------------------------------
+	size_t Camera::getCullingPlanes(Plane* planes) const
+	{
+		if (mCullFrustum)
+		{
+			return mCullFrustum->getCullingPlanes(planes);
+		}
+		else
+		{
+			return Frustum::getCullingPlanes(planes);
+		}
+	}
+	//-----------------------------------------------------------------------
 	bool Camera::isVisible(const Sphere& bound, FrustumPlane* culledBy) const
 	{
 		if (mCullFrustum)
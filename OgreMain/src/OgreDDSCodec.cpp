@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreRenderSystem.h"
 #include "OgreDDSCodec.h"
 #include "OgreImage.h"
+#include "OgreTiledImage.h"
 #include "OgreException.h"
 
 #include "OgreLogManager.h"
@@ -93,22 +94,6 @@ namespace Ogre {
 		// 16 2-bit indexes, each byte here is one row
 		uint8 indexRow[4];
 	};
-	// An 8-byte DXT explicit alpha block, represents a 4x4 texel area. Used by DXT2/3
-	struct DXTExplicitAlphaBlock
-	{
-		// 16 4-bit values, each 16-bit value is one row
-		uint16 alphaRow[4];
-	};
-	// An 8-byte DXT interpolated alpha block, represents a 4x4 texel area. Used by DXT4/5
-	struct DXTInterpolatedAlphaBlock
-	{
-		// 2 alpha ranges
-		uint8 alpha_0;
-		uint8 alpha_1;
-		// 16 3-bit indexes. Unfortunately 3 bits doesn't map too well to row bytes
-		// so just stored raw
-		uint8 indexes[6];
-	};
 	
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 #pragma pack (pop)
@@ -154,6 +139,59 @@ namespace Ogre {
 
 
 	//---------------------------------------------------------------------
+	/** Reads regions of a DXT compressed image, decompressing the rows of
+		blocks they cover.
+	*/
+	class DXTRegionReader : public ImageRegionReader
+	{
+	public:
+		DXTRegionReader(const DataStreamPtr& stream, size_t width, size_t height, 
+			PixelFormat format, size_t offset)
+			: mStream(stream), mWidth(width), mHeight(height), mFormat(format), mOffset(offset)
+		{
+		}
+
+		size_t getWidth() const { return mWidth; }
+		size_t getHeight() const { return mHeight; }
+		PixelFormat getFormat() const { return PF_BYTE_RGBA; }
+
+		void readRegion(const Box& region, const PixelBox& dst)
+		{
+			assert(region.right <= mWidth && region.bottom <= mHeight && region.getDepth() == 1);
+
+			size_t blockSize = mFormat == PF_DXT1 ? 8 : 16;
+			size_t blocksX = (mWidth + 3) / 4;
+			size_t firstBlockX = region.left / 4;
+			size_t numBlocks = (region.right + 3) / 4 - firstBlockX;
+			MemoryDataStream blocks(numBlocks * blockSize);
+			MemoryDataStream pixels(numBlocks * 4 * 4 * 4);
+			PixelBox compressed(numBlocks * 4, 4, 1, mFormat, blocks.getPtr());
+			PixelBox decoded(numBlocks * 4, 4, 1, PF_BYTE_RGBA, pixels.getPtr());
+
+			for (size_t blockY = region.top / 4; blockY * 4 < region.bottom; ++blockY)
+			{
+				mStream->seek(mOffset + (blockY * blocksX + firstBlockX) * blockSize);
+				mStream->read(blocks.getPtr(), numBlocks * blockSize);
+				PixelUtil::bulkPixelConversion(compressed, decoded);
+
+				size_t top = std::max(region.top, blockY * 4);
+				size_t bottom = std::min(region.bottom, blockY * 4 + 4);
+				PixelUtil::bulkPixelConversion(
+					decoded.getSubVolume(Box(region.left - firstBlockX * 4, top - blockY * 4, 
+						region.right - firstBlockX * 4, bottom - blockY * 4)),
+					dst.getSubVolume(Box(dst.left, dst.top + top - region.top, dst.front, 
+						dst.right, dst.top + bottom - region.top, dst.back)));
+			}
+		}
+
+	protected:
+		DataStreamPtr mStream;
+		size_t mWidth;
+		size_t mHeight;
+		PixelFormat mFormat;
+		size_t mOffset;
+	};
+    //---------------------------------------------------------------------
 	DDSCodec* DDSCodec::msInstance = 0;
 	//---------------------------------------------------------------------
 	void DDSCodec::startup(void)
@@ -209,18 +247,13 @@ namespace Ogre {
 		// Establish texture attributes
 		bool isVolume = (imgData->depth > 1);		
 		bool isFloat32r = (imgData->format == PF_FLOAT32_R);
+		bool isDXT = (imgData->format >= PF_DXT1 && imgData->format <= PF_DXT5);
+		bool hasMipmaps = (imgData->num_mipmaps != 0);
 		bool hasAlpha = false;
 		bool notImplemented = false;
 		String notImplementedString = "";
 
 		// Check for all the 'not implemented' conditions
-		if (imgData->num_mipmaps != 0)
-		{
-			// No mip map functionality yet
-			notImplemented = true;
-			notImplementedString += " mipmaps";
-		}
-
 		if ((isVolume == true)&&(imgData->width != imgData->height))
 		{
 			// Square textures only
@@ -246,6 +279,11 @@ namespace Ogre {
 		case PF_X8R8G8B8:
 		case PF_R8G8B8:
 		case PF_FLOAT32_R:
+		case PF_DXT1:
+		case PF_DXT2:
+		case PF_DXT3:
+		case PF_DXT4:
+		case PF_DXT5:
 			break;
 		default:
 			// No crazy FOURCC or 565 et al. file formats at this stage
@@ -278,6 +316,10 @@ namespace Ogre {
 			// Initalise the header flags
 			ddsHeaderFlags = (isVolume) ? DDSD_CAPS|DDSD_WIDTH|DDSD_HEIGHT|DDSD_DEPTH|DDSD_PIXELFORMAT :
 				DDSD_CAPS|DDSD_WIDTH|DDSD_HEIGHT|DDSD_PIXELFORMAT;	
+			if (hasMipmaps)
+			{
+				ddsHeaderFlags |= DDSD_MIPMAPCOUNT;
+			}
 
 			// Initalise the rgbBits flags
 			switch(imgData->format)
@@ -302,9 +344,20 @@ namespace Ogre {
 
 			// Initalise the SizeOrPitch flags (power two textures for now)
 			ddsHeaderSizeOrPitch = ddsHeaderRgbBits * imgData->width;
+			if (isDXT)
+			{
+				// Compressed data has the size of the top level instead
+				ddsHeaderFlags |= DDSD_LINEARSIZE;
+				ddsHeaderSizeOrPitch = static_cast<uint32>(PixelUtil::getMemorySize(
+					imgData->width, imgData->height, 1, imgData->format));
+			}
 
 			// Initalise the caps flags
 			ddsHeaderCaps1 = (isVolume||isCubeMap) ? DDSCAPS_COMPLEX|DDSCAPS_TEXTURE : DDSCAPS_TEXTURE;
+			if (hasMipmaps)
+			{
+				ddsHeaderCaps1 |= DDSCAPS_COMPLEX|DDSCAPS_MIPMAP;
+			}
 			if (isVolume)
 			{
 				ddsHeaderCaps2 = DDSCAPS2_VOLUME;
@@ -325,7 +378,7 @@ namespace Ogre {
 			ddsHeader.height = (uint32)imgData->height;
 			ddsHeader.depth = (uint32)(isVolume ? imgData->depth : 0);
 			ddsHeader.depth = (uint32)(isCubeMap ? 6 : ddsHeader.depth);
-			ddsHeader.mipMapCount = 0;
+			ddsHeader.mipMapCount = hasMipmaps ? imgData->num_mipmaps + 1 : 0;
 			ddsHeader.sizeOrPitch = ddsHeaderSizeOrPitch;
 			for (uint32 reserved1=0; reserved1<11; reserved1++) // XXX nasty constant 11
 			{
@@ -345,6 +398,19 @@ namespace Ogre {
 			ddsHeader.pixelFormat.greenMask = (isFloat32r) ? 0x00000000 :0x0000FF00;
 			ddsHeader.pixelFormat.blueMask  = (isFloat32r) ? 0x00000000 :0x000000FF;
 
+			if (isDXT)
+			{
+				// PF_DXT1 to PF_DXT5 are consecutive
+				char dxtVersion = static_cast<char>('1' + (imgData->format - PF_DXT1));
+				ddsHeader.pixelFormat.flags = DDPF_FOURCC;
+				ddsHeader.pixelFormat.fourCC = FOURCC('D', 'X', 'T', dxtVersion);
+				ddsHeader.pixelFormat.rgbBits = 0;
+				ddsHeader.pixelFormat.alphaMask = 0;
+				ddsHeader.pixelFormat.redMask = 0;
+				ddsHeader.pixelFormat.greenMask = 0;
+				ddsHeader.pixelFormat.blueMask = 0;
+			}
+
 			ddsHeader.caps.caps1 = ddsHeaderCaps1;
 			ddsHeader.caps.caps2 = ddsHeaderCaps2;
 			ddsHeader.caps.reserved[0] = 0;
@@ -429,151 +495,10 @@ namespace Ogre {
 			"DDSCodec::convertPixelFormat");
 
 	}
-	//---------------------------------------------------------------------
-	void DDSCodec::unpackDXTColour(PixelFormat pf, const DXTColourBlock& block, 
-		ColourValue* pCol) const
-	{
-		// Note - we assume all values have already been endian swapped
-
-		// Colour lookup table
-		ColourValue derivedColours[4];
-
-		if (pf == PF_DXT1 && block.colour_0 <= block.colour_1)
-		{
-			// 1-bit alpha
-			PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-			PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-			// one intermediate colour, half way between the other two
-			derivedColours[2] = (derivedColours[0] + derivedColours[1]) / 2;
-			// transparent colour
-			derivedColours[3] = ColourValue::ZERO;
-		}
-		else
-		{
-			PixelUtil::unpackColour(&(derivedColours[0]), PF_R5G6B5, &(block.colour_0));
-			PixelUtil::unpackColour(&(derivedColours[1]), PF_R5G6B5, &(block.colour_1));
-			// first interpolated colour, 1/3 of the way along
-			derivedColours[2] = (2 * derivedColours[0] + derivedColours[1]) / 3;
-			// second interpolated colour, 2/3 of the way along
-			derivedColours[3] = (derivedColours[0] + 2 * derivedColours[1]) / 3;
-		}
-
-		// Process 4x4 block of texels
-		for (size_t row = 0; row < 4; ++row)
-		{
-			for (size_t x = 0; x < 4; ++x)
-			{
-				// LSB come first
-				uint8 colIdx = static_cast<uint8>(block.indexRow[row] >> (x * 2) & 0x3);
-				if (pf == PF_DXT1)
-				{
-					// Overwrite entire colour
-					pCol[(row * 4) + x] = derivedColours[colIdx];
-				}
-				else
-				{
-					// alpha has already been read (alpha precedes colour)
-					ColourValue& col = pCol[(row * 4) + x];
-					col.r = derivedColours[colIdx].r;
-					col.g = derivedColours[colIdx].g;
-					col.b = derivedColours[colIdx].b;
-				}
-			}
-
-		}
-
-
-	}
-	//---------------------------------------------------------------------
-	void DDSCodec::unpackDXTAlpha(
-		const DXTExplicitAlphaBlock& block, ColourValue* pCol) const
-	{
-		// Note - we assume all values have already been endian swapped
-		
-		// This is an explicit alpha block, 4 bits per pixel, LSB first
-		for (size_t row = 0; row < 4; ++row)
-		{
-			for (size_t x = 0; x < 4; ++x)
-			{
-				// Shift and mask off to 4 bits
-				uint8 val = static_cast<uint8>(block.alphaRow[row] >> (x * 4) & 0xF);
-				// Convert to [0,1]
-				pCol->a = (Real)val / (Real)0xF;
-				pCol++;
-				
-			}
-			
-		}
-
-	}
-	//---------------------------------------------------------------------
-	void DDSCodec::unpackDXTAlpha(
-		const DXTInterpolatedAlphaBlock& block, ColourValue* pCol) const
-	{
-		// 8 derived alpha values to be indexed
-		Real derivedAlphas[8];
-
-		// Explicit extremes
-		derivedAlphas[0] = block.alpha_0 / (Real)0xFF;
-		derivedAlphas[1] = block.alpha_1 / (Real)0xFF;
-		
-		
-		if (block.alpha_0 <= block.alpha_1)
-		{
-			// 4 interpolated alphas, plus zero and one			
-			// full range including extremes at [0] and [5]
-			// we want to fill in [1] through [4] at weights ranging
-			// from 1/5 to 4/5
-			Real denom = 1.0f / 5.0f;
-			for (size_t i = 0; i < 4; ++i) 
-			{
-				Real factor0 = (4 - i) * denom;
-				Real factor1 = (i + 1) * denom;
-				derivedAlphas[i + 2] = 
-					(factor0 * block.alpha_0) + (factor1 * block.alpha_1);
-			}
-			derivedAlphas[6] = 0.0f;
-			derivedAlphas[7] = 1.0f;
-
-		}
-		else
-		{
-			// 6 interpolated alphas
-			// full range including extremes at [0] and [7]
-			// we want to fill in [1] through [6] at weights ranging
-			// from 1/7 to 6/7
-			Real denom = 1.0f / 7.0f;
-			for (size_t i = 0; i < 6; ++i) 
-			{
-				Real factor0 = (6 - i) * denom;
-				Real factor1 = (i + 1) * denom;
-				derivedAlphas[i + 2] = 
-					(factor0 * block.alpha_0) + (factor1 * block.alpha_1);
-			}
-			
-		}
-
-		// Ok, now we've built the reference values, process the indexes
-		for (size_t i = 0; i < 16; ++i)
-		{
-			size_t baseByte = (i * 3) / 8;
-			size_t baseBit = (i * 3) % 8;
-			uint8 bits = static_cast<uint8>(block.indexes[baseByte] >> baseBit & 0x7);
-			// do we need to stitch in next byte too?
-			if (baseBit > 5)
-			{
-				uint8 extraBits = static_cast<uint8>(
-					(block.indexes[baseByte+1] << (8 - baseBit)) & 0xFF);
-				bits |= extraBits & 0x7;
-			}
-			pCol[i].a = derivedAlphas[bits];
-
-		}
-
-	}
     //---------------------------------------------------------------------
-    Codec::DecodeResult DDSCodec::decode(DataStreamPtr& stream) const
-    {
+	void DDSCodec::readHeader(DataStreamPtr& stream, DDSHeader& header, ImageData* imgData, 
+		PixelFormat& sourceFormat, bool& decompressDXT, size_t& numFaces) const
+	{
 		// Read 4 character code
 		uint32 fileType;
 		stream->read(&fileType, sizeof(uint32));
@@ -582,11 +507,10 @@ namespace Ogre {
 		if (FOURCC('D', 'D', 'S', ' ') != fileType)
 		{
 			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
-				"This is not a DDS file!", "DDSCodec::decode");
+				"This is not a DDS file!", "DDSCodec::readHeader");
 		}
 		
 		// Read header in full
-		DDSHeader header;
 		stream->read(&header, sizeof(DDSHeader));
 
 		// Endian flip if required, all 32-bit values
@@ -596,21 +520,18 @@ namespace Ogre {
 		if (header.size != DDS_HEADER_SIZE)
 		{
 			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
-				"DDS header size mismatch!", "DDSCodec::decode");
+				"DDS header size mismatch!", "DDSCodec::readHeader");
 		}
 		if (header.pixelFormat.size != DDS_PIXELFORMAT_SIZE)
 		{
 			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
-				"DDS header size mismatch!", "DDSCodec::decode");
+				"DDS header size mismatch!", "DDSCodec::readHeader");
 		}
 
-		ImageData* imgData = OGRE_NEW ImageData();
-		MemoryDataStreamPtr output;
-
 		imgData->depth = 1; // (deal with volume later)
 		imgData->width = header.width;
 		imgData->height = header.height;
-		size_t numFaces = 1; // assume one face until we know otherwise
+		numFaces = 1; // assume one face until we know otherwise
 
 		if (header.caps.caps1 & DDSCAPS_MIPMAP)
 		{
@@ -622,7 +543,7 @@ namespace Ogre {
 		}
 		imgData->flags = 0;
 
-		bool decompressDXT = false;
+		decompressDXT = false;
 		// Figure out basic image type
 		if (header.caps.caps2 & DDSCAPS2_CUBEMAP)
 		{
@@ -635,7 +556,7 @@ namespace Ogre {
 			imgData->depth = header.depth;
 		}
 		// Pixel format
-		PixelFormat sourceFormat = PF_UNKNOWN;
+		sourceFormat = PF_UNKNOWN;
 
 		if (header.pixelFormat.flags & DDPF_FOURCC)
 		{
@@ -652,8 +573,8 @@ namespace Ogre {
 
 		if (PixelUtil::isCompressed(sourceFormat))
 		{
-			if (!Root::getSingleton().getRenderSystem()->getCapabilities()
-				->hasCapability(RSC_TEXTURE_COMPRESSION_DXT))
+			RenderSystem* rs = Root::getSingleton().getRenderSystem();
+			if (!rs || !rs->getCapabilities()->hasCapability(RSC_TEXTURE_COMPRESSION_DXT))
 			{
 				// We'll need to decompress
 				decompressDXT = true;
@@ -714,149 +635,159 @@ namespace Ogre {
 		// Calculate total size from number of mipmaps, faces and size
 		imgData->size = Image::calculateSize(imgData->num_mipmaps, numFaces, 
 			imgData->width, imgData->height, imgData->depth, imgData->format);
+	}
+	//---------------------------------------------------------------------
+	size_t DDSCodec::getMipSourceSize(const DDSHeader& header, PixelFormat sourceFormat, 
+		size_t mip, size_t width, size_t height, size_t depth) const
+	{
+		if (PixelUtil::isCompressed(sourceFormat))
+		{
+			return PixelUtil::getMemorySize(width, height, depth, sourceFormat);
+		}
+		else
+		{
+			size_t srcPitch = width * PixelUtil::getNumElemBytes(sourceFormat);
+			if (header.flags & DDSD_PITCH)
+				srcPitch = std::max(srcPitch, (size_t)(header.sizeOrPitch >> mip));
+			return srcPitch * height * depth;
+		}
+	}
+	//---------------------------------------------------------------------
+	void DDSCodec::decodeMip(DataStreamPtr& stream, const DDSHeader& header, 
+		PixelFormat sourceFormat, PixelFormat destFormat, bool decompressDXT, 
+		size_t mip, size_t width, size_t height, size_t depth, void*& destPtr) const
+	{
+		size_t dstPitch = width * PixelUtil::getNumElemBytes(destFormat);
 
-		// Bind output buffer
-		output.bind(OGRE_NEW MemoryDataStream(imgData->size));
+		if (PixelUtil::isCompressed(sourceFormat))
+		{
+			// Compressed data
+			if (decompressDXT)
+			{
+				// Read the whole level and decode it straight into the image
+				size_t dxtSize = PixelUtil::getMemorySize(width, height, depth, sourceFormat);
+				MemoryDataStream compressed(dxtSize);
+				stream->read(compressed.getPtr(), dxtSize);
+				PixelBox src(width, height, depth, sourceFormat, compressed.getPtr());
+				PixelBox dst(width, height, depth, destFormat, destPtr);
+				PixelUtil::bulkPixelConversion(src, dst);
+				destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) + 
+					PixelUtil::getMemorySize(width, height, depth, destFormat));
+			}
+			else
+			{
+				// load directly
+				// DDS format lies! sizeOrPitch is not always set for DXT!!
+				size_t dxtSize = PixelUtil::getMemorySize(width, height, depth, destFormat);
+				stream->read(destPtr, dxtSize);
+				destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) + dxtSize);
+			}
 
-		
-		// Now deal with the data
+		}
+		else
+		{
+			// Final data - trim incoming pitch
+			// Each level is its own width and height; the pitch in the header 
+			// is that of the top level and halves with each level down. This 
+			// used to read the full height for every level and divide the 
+			// pitch by mip * 2, which misread all but the top level of a 
+			// mipmapped image.
+			size_t srcPitch;
+			if (header.flags & DDSD_PITCH)
+			{
+				srcPitch = std::max(dstPitch, (size_t)(header.sizeOrPitch >> mip));
+			}
+			else
+			{
+				// assume same as final pitch
+				srcPitch = dstPitch;
+			}
+			assert (dstPitch <= srcPitch);
+			long srcAdvance = static_cast<long>(srcPitch) - static_cast<long>(dstPitch);
+
+			for (size_t z = 0; z < depth; ++z)
+			{
+				for (size_t y = 0; y < height; ++y)
+				{
+					stream->read(destPtr, dstPitch);
+					if (srcAdvance > 0)
+						stream->skip(srcAdvance);
+
+					destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) + dstPitch);
+				}
+			}
+
+		}
+	}
+    //---------------------------------------------------------------------
+    Codec::DecodeResult DDSCodec::decode(DataStreamPtr& stream) const
+    {
+		return decodeMipmaps(stream, 0);
+    }
+    //---------------------------------------------------------------------
+	Codec::CodecDataPtr DDSCodec::decodeHeader(DataStreamPtr& stream) const
+	{
+		DDSHeader header;
+		PixelFormat sourceFormat;
+		bool decompressDXT;
+		size_t numFaces;
+		ImageData* imgData = OGRE_NEW ImageData();
+		CodecDataPtr ret(imgData);
+		readHeader(stream, header, imgData, sourceFormat, decompressDXT, numFaces);
+		return ret;
+	}
+    //---------------------------------------------------------------------
+	Codec::DecodeResult DDSCodec::decodeMipmaps(DataStreamPtr& stream, size_t firstMip) const
+	{
+		DDSHeader header;
+		PixelFormat sourceFormat;
+		bool decompressDXT;
+		size_t numFaces;
+		ImageData* imgData = OGRE_NEW ImageData();
+		CodecDataPtr codecData(imgData);
+		readHeader(stream, header, imgData, sourceFormat, decompressDXT, numFaces);
+
+		// Describe only the levels we're going to decode
+		size_t fullWidth = imgData->width;
+		size_t fullHeight = imgData->height;
+		size_t fullDepth = imgData->depth;
+		size_t numMipmaps = imgData->num_mipmaps;
+		firstMip = std::min(firstMip, numMipmaps);
+		if (firstMip > 0)
+		{
+			imgData->width = std::max((size_t)1, fullWidth >> firstMip);
+			imgData->height = std::max((size_t)1, fullHeight >> firstMip);
+			imgData->depth = std::max((size_t)1, fullDepth >> firstMip);
+			imgData->num_mipmaps = static_cast<ushort>(numMipmaps - firstMip);
+			imgData->size = Image::calculateSize(imgData->num_mipmaps, numFaces, 
+				imgData->width, imgData->height, imgData->depth, imgData->format);
+		}
+
+		// Bind output buffer
+		MemoryDataStreamPtr output(OGRE_NEW MemoryDataStream(imgData->size));
 		void* destPtr = output->getPtr();
 
 		// all mips for a face, then each face
 		for(size_t i = 0; i < numFaces; ++i)
 		{   
-			size_t width = imgData->width;
-			size_t height = imgData->height;
-			size_t depth = imgData->depth;
+			size_t width = fullWidth;
+			size_t height = fullHeight;
+			size_t depth = fullDepth;
 
-			for(size_t mip = 0; mip <= imgData->num_mipmaps; ++mip)
+			for(size_t mip = 0; mip <= numMipmaps; ++mip)
 			{
-				size_t dstPitch = width * PixelUtil::getNumElemBytes(imgData->format);
-
-				if (PixelUtil::isCompressed(sourceFormat))
+				if (mip < firstMip)
 				{
-					// Compressed data
-					if (decompressDXT)
-					{
-						DXTColourBlock col;
-						DXTInterpolatedAlphaBlock iAlpha;
-						DXTExplicitAlphaBlock eAlpha;
-						// 4x4 block of decompressed colour
-						ColourValue tempColours[16];
-						size_t destBpp = PixelUtil::getNumElemBytes(imgData->format);
-						size_t sx = std::min(width, (size_t)4);
-						size_t sy = std::min(height, (size_t)4);
-						size_t destPitchMinus4 = dstPitch - destBpp * sx;
-						// slices are done individually
-						for(size_t z = 0; z < depth; ++z)
-						{
-							// 4x4 blocks in x/y
-							for (size_t y = 0; y < height; y += 4)
-							{
-								for (size_t x = 0; x < width; x += 4)
-								{
-									if (sourceFormat == PF_DXT2 || 
-										sourceFormat == PF_DXT3)
-									{
-										// explicit alpha
-										stream->read(&eAlpha, sizeof(DXTExplicitAlphaBlock));
-										flipEndian(eAlpha.alphaRow, sizeof(uint16), 4);
-										unpackDXTAlpha(eAlpha, tempColours) ;
-									}
-									else if (sourceFormat == PF_DXT4 || 
-										sourceFormat == PF_DXT5)
-									{
-										// interpolated alpha
-										stream->read(&iAlpha, sizeof(DXTInterpolatedAlphaBlock));
-										flipEndian(&(iAlpha.alpha_0), sizeof(uint16), 1);
-										flipEndian(&(iAlpha.alpha_1), sizeof(uint16), 1);
-										unpackDXTAlpha(iAlpha, tempColours) ;
-									}
-									// always read colour
-									stream->read(&col, sizeof(DXTColourBlock));
-									flipEndian(&(col.colour_0), sizeof(uint16), 1);
-									flipEndian(&(col.colour_1), sizeof(uint16), 1);
-									unpackDXTColour(sourceFormat, col, tempColours);
-
-									// write 4x4 block to uncompressed version
-									for (size_t by = 0; by < sy; ++by)
-									{
-										for (size_t bx = 0; bx < sx; ++bx)
-										{
-											PixelUtil::packColour(tempColours[by*4+bx],
-												imgData->format, destPtr);
-											destPtr = static_cast<void*>(
-												static_cast<uchar*>(destPtr) + destBpp);
-										}
-										// advance to next row
-										destPtr = static_cast<void*>(
-											static_cast<uchar*>(destPtr) + destPitchMinus4);
-									}
-									// next block. Our dest pointer is 4 lines down
-									// from where it started
-									if (x + 4 >= width)
-									{
-										// Jump back to the start of the line
-										destPtr = static_cast<void*>(
-											static_cast<uchar*>(destPtr) - destPitchMinus4);
-									}
-									else
-									{
-										// Jump back up 4 rows and 4 pixels to the
-										// right to be at the next block to the right
-										destPtr = static_cast<void*>(
-											static_cast<uchar*>(destPtr) - dstPitch * sy + destBpp * sx);
-
-									}
-
-								}
-
-							}
-						}
-
-					}
-					else
-					{
-						// load directly
-						// DDS format lies! sizeOrPitch is not always set for DXT!!
-						size_t dxtSize = PixelUtil::getMemorySize(width, height, depth, imgData->format);
-						stream->read(destPtr, dxtSize);
-						destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) + dxtSize);
-					}
-
+					// Larger than wanted, skip straight over the data
+					stream->skip(static_cast<long>(
+						getMipSourceSize(header, sourceFormat, mip, width, height, depth)));
 				}
 				else
 				{
-					// Final data - trim incoming pitch
-					size_t srcPitch;
-					if (header.flags & DDSD_PITCH)
-					{
-						srcPitch = header.sizeOrPitch / 
-							std::max((size_t)1, mip * 2);
-					}
-					else
-					{
-						// assume same as final pitch
-						srcPitch = dstPitch;
-					}
-					assert (dstPitch <= srcPitch);
-					long srcAdvance = static_cast<long>(srcPitch) - static_cast<long>(dstPitch);
-
-					for (size_t z = 0; z < imgData->depth; ++z)
-					{
-						for (size_t y = 0; y < imgData->height; ++y)
-						{
-							stream->read(destPtr, dstPitch);
-							if (srcAdvance > 0)
-								stream->skip(srcAdvance);
-
-							destPtr = static_cast<void*>(static_cast<uchar*>(destPtr) + dstPitch);
-						}
-					}
-
+					decodeMip(stream, header, sourceFormat, imgData->format, decompressDXT, 
+						mip, width, height, depth, destPtr);
 				}
 
-				
 				/// Next mip
 				if(width!=1) width /= 2;
 				if(height!=1) height /= 2;
@@ -867,12 +798,33 @@ namespace Ogre {
 
 		DecodeResult ret;
 		ret.first = output;
-		ret.second = CodecDataPtr(imgData);
+		ret.second = codecData;
 		return ret;
-		
-
-
-    }
+	}
+    //---------------------------------------------------------------------
+	ImageRegionReader* DDSCodec::createRegionReader(DataStreamPtr& stream) const
+	{
+		DDSHeader header;
+		PixelFormat sourceFormat;
+		bool decompressDXT;
+		size_t numFaces;
+		ImageData imgData;
+		readHeader(stream, header, &imgData, sourceFormat, decompressDXT, numFaces);
+
+		// The top level of the first face or slice comes first
+		size_t offset = stream->tell();
+		if (PixelUtil::isCompressed(sourceFormat))
+		{
+			return OGRE_NEW DXTRegionReader(stream, imgData.width, imgData.height, 
+				sourceFormat, offset);
+		}
+		else
+		{
+			size_t rowPitch = getMipSourceSize(header, sourceFormat, 0, imgData.width, 1, 1);
+			return OGRE_NEW RawImageRegionReader(stream, imgData.width, imgData.height, 
+				sourceFormat, offset, rowPitch);
+		}
+	}
     //---------------------------------------------------------------------    
     String DDSCodec::getType() const 
     {
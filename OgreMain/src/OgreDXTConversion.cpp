@@ -0,0 +1,927 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreDXTConversion.h"
+#include "OgreImageFilter.h"
+#include "OgreMath.h"
+#include "OgrePlatformInformation.h"
+
+//-------------------------------------------------------------------------
+//
+// DXT block compression. Each 4x4 block is fitted the same way as most
+// real time compressors do it: the colour endpoints are the pixels at
+// either end of the principal axis of the block's colours, improved by one
+// least squares pass if that lowers the error, and each pixel takes the
+// nearest of the colours the decoder will derive from the endpoints.
+// Interpolated alpha uses the lowest and highest alpha as its endpoints.
+// DXT2 and DXT4 store premultiplied colour, so the source is multiplied
+// by its alpha before their colours are fitted.
+//
+// Choosing the nearest colour or alpha for each pixel is where the time
+// goes, so that has an SSE2 version, which gives the same indices as the
+// general one. Source rows are brought to PF_BYTE_RGBA with
+// bulkPixelConversion, so the SIMD conversion kernels do that part.
+//
+// Decompression builds the 4 colours of a block as whole destination
+// pixels, so writing a pixel is a lookup. That covers the 32 bit formats
+// with a byte per channel; any other format is decoded as PF_BYTE_RGBA a
+// row of blocks at a time and converted.
+//
+//-------------------------------------------------------------------------
+
+#if __OGRE_HAVE_SSE && (OGRE_COMPILER == OGRE_COMPILER_MSVC || defined(__SSE2__) || __OGRE_HAVE_AVX)
+#   define __OGRE_HAVE_SSE2_DXT 1
+#   include <emmintrin.h>
+#else
+#   define __OGRE_HAVE_SSE2_DXT 0
+#endif
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC
+#   define __OGRE_SSE2_FUNCTION __attribute__((__target__("sse2")))
+#else
+#   define __OGRE_SSE2_FUNCTION
+#endif
+
+namespace Ogre {
+
+    /** Picks the nearest of numColours palette entries (RGBA, alpha unused)
+        for each pixel of a block, and returns the total squared error of the
+        pixels not in the ignore mask.
+    */
+    typedef uint32 (*ColourIndexFunction)(const uint8* block, const uint8* palette,
+        size_t numColours, uint16 ignore, uint8* indices);
+    /** Picks the nearest of the 8 palette values for the alpha of each pixel
+        of a block.
+    */
+    typedef void (*AlphaIndexFunction)(const uint8* block, const uint8* palette,
+        uint8* indices);
+
+    /// The functions a compression runs with
+    struct DXTFunctions
+    {
+        ColourIndexFunction selectColours;
+        AlphaIndexFunction selectAlphas;
+    };
+
+//-------------------------------------------------------------------------
+// Index selection
+//-------------------------------------------------------------------------
+
+    static uint32 selectColourIndicesGeneral(const uint8* block, const uint8* palette,
+        size_t numColours, uint16 ignore, uint8* indices)
+    {
+        uint32 error = 0;
+        for (size_t i = 0; i < 16; ++i, block += 4)
+        {
+            uint32 best = ~(uint32)0;
+            for (size_t c = 0; c < numColours; ++c)
+            {
+                int dr = block[0] - palette[c * 4];
+                int dg = block[1] - palette[c * 4 + 1];
+                int db = block[2] - palette[c * 4 + 2];
+                uint32 d = static_cast<uint32>(dr * dr + dg * dg + db * db);
+                if (d < best)
+                {
+                    best = d;
+                    indices[i] = static_cast<uint8>(c);
+                }
+            }
+            if (!(ignore & (1 << i)))
+                error += best;
+        }
+        return error;
+    }
+    //---------------------------------------------------------------------
+    static void selectAlphaIndicesGeneral(const uint8* block, const uint8* palette,
+        uint8* indices)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            int alpha = block[i * 4 + 3];
+            int best = 256;
+            for (size_t c = 0; c < 8; ++c)
+            {
+                int d = std::abs(alpha - palette[c]);
+                if (d < best)
+                {
+                    best = d;
+                    indices[i] = static_cast<uint8>(c);
+                }
+            }
+        }
+    }
+
+#if __OGRE_HAVE_SSE2_DXT
+    // A row of the block is one register. The colours are widened to 16 bits
+    // so that madd can square and sum them; the alphas of the whole block
+    // fit in a register as bytes.
+    __OGRE_SSE2_FUNCTION static uint32 selectColourIndicesSSE2(const uint8* block,
+        const uint8* palette, size_t numColours, uint16 ignore, uint8* indices)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+        __m128i entries[4];
+        for (size_t c = 0; c < numColours; ++c)
+        {
+            const uint8* p = palette + c * 4;
+            entries[c] = _mm_set_epi16(0, p[2], p[1], p[0], 0, p[2], p[1], p[0]);
+        }
+
+        uint32 error = 0;
+        for (size_t row = 0; row < 4; ++row)
+        {
+            __m128i pixels = _mm_and_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + row * 16)), rgbMask);
+            __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            __m128i best = _mm_set1_epi32(0x7FFFFFFF);
+            __m128i index = zero;
+            for (size_t c = 0; c < numColours; ++c)
+            {
+                __m128i dlo = _mm_sub_epi16(lo, entries[c]);
+                __m128i dhi = _mm_sub_epi16(hi, entries[c]);
+                // red and green squared in the even lanes, blue in the odd
+                __m128 sumLo = _mm_castsi128_ps(_mm_madd_epi16(dlo, dlo));
+                __m128 sumHi = _mm_castsi128_ps(_mm_madd_epi16(dhi, dhi));
+                __m128i d = _mm_add_epi32(
+                    _mm_castps_si128(_mm_shuffle_ps(sumLo, sumHi, _MM_SHUFFLE(2, 0, 2, 0))),
+                    _mm_castps_si128(_mm_shuffle_ps(sumLo, sumHi, _MM_SHUFFLE(3, 1, 3, 1))));
+                __m128i closer = _mm_cmplt_epi32(d, best);
+                best = _mm_or_si128(_mm_and_si128(closer, d), _mm_andnot_si128(closer, best));
+                index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(c))),
+                    _mm_andnot_si128(closer, index));
+            }
+
+            uint32 distances[4], rowIndices[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(distances), best);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(rowIndices), index);
+            for (size_t x = 0; x < 4; ++x)
+            {
+                size_t i = row * 4 + x;
+                indices[i] = static_cast<uint8>(rowIndices[x]);
+                if (!(ignore & (1 << i)))
+                    error += distances[x];
+            }
+        }
+        return error;
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void selectAlphaIndicesSSE2(const uint8* block,
+        const uint8* palette, uint8* indices)
+    {
+        const __m128i* rows = reinterpret_cast<const __m128i*>(block);
+        __m128i alpha = _mm_packus_epi16(
+            _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(rows), 24),
+                _mm_srli_epi32(_mm_loadu_si128(rows + 1), 24)),
+            _mm_packs_epi32(_mm_srli_epi32(_mm_loadu_si128(rows + 2), 24),
+                _mm_srli_epi32(_mm_loadu_si128(rows + 3), 24)));
+
+        __m128i best = _mm_set1_epi8(static_cast<char>(0xFF));
+        __m128i index = _mm_setzero_si128();
+        for (int c = 0; c < 8; ++c)
+        {
+            __m128i entry = _mm_set1_epi8(static_cast<char>(palette[c]));
+            __m128i d = _mm_or_si128(_mm_subs_epu8(alpha, entry), _mm_subs_epu8(entry, alpha));
+            // unsigned less than, as no more and not equal
+            __m128i lower = _mm_min_epu8(d, best);
+            __m128i closer = _mm_andnot_si128(_mm_cmpeq_epi8(d, best), _mm_cmpeq_epi8(lower, d));
+            best = lower;
+            index = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi8(static_cast<char>(c))),
+                _mm_andnot_si128(closer, index));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), index);
+    }
+#endif
+
+//-------------------------------------------------------------------------
+// Colour blocks
+//-------------------------------------------------------------------------
+
+    /// a * b / 255, rounded
+    static FORCEINLINE int mul8Bit(int a, int b)
+    {
+        int t = a * b + 128;
+        return (t + (t >> 8)) >> 8;
+    }
+    //---------------------------------------------------------------------
+    static uint16 packRGB565(const int* rgb)
+    {
+        return static_cast<uint16>((mul8Bit(rgb[0], 31) << 11) |
+            (mul8Bit(rgb[1], 63) << 5) | mul8Bit(rgb[2], 31));
+    }
+    //---------------------------------------------------------------------
+    static void unpackRGB565(uint16 colour, uint8* rgba)
+    {
+        int r = (colour >> 11) & 0x1F, g = (colour >> 5) & 0x3F, b = colour & 0x1F;
+        rgba[0] = static_cast<uint8>((r << 3) | (r >> 2));
+        rgba[1] = static_cast<uint8>((g << 2) | (g >> 4));
+        rgba[2] = static_cast<uint8>((b << 3) | (b >> 2));
+        rgba[3] = 0;
+    }
+    //---------------------------------------------------------------------
+    /** The colours a decoder derives from a pair of endpoints, which are the
+        first two, followed by 2 colours between them, or 1 in the mode with
+        a transparent colour.
+    */
+    static void buildColourPalette(uint16 c0, uint16 c1, bool threeColour, uint8* palette)
+    {
+        unpackRGB565(c0, palette);
+        unpackRGB565(c1, palette + 4);
+        for (size_t c = 0; c < 3; ++c)
+        {
+            int a = palette[c], b = palette[4 + c];
+            if (threeColour)
+            {
+                palette[8 + c] = static_cast<uint8>((a + b) / 2);
+                palette[12 + c] = 0;
+            }
+            else
+            {
+                palette[8 + c] = static_cast<uint8>((2 * a + b) / 3);
+                palette[12 + c] = static_cast<uint8>((a + 2 * b) / 3);
+            }
+        }
+        palette[11] = palette[15] = 0;
+    }
+    //---------------------------------------------------------------------
+    /** Finds the pixels at either end of the principal axis of the colours
+        of the pixels not in the ignore mask.
+    */
+    static void findColourEndpoints(const uint8* block, uint16 ignore, int* end0, int* end1)
+    {
+        float mean[3] = { 0, 0, 0 };
+        size_t count = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if (ignore & (1 << i))
+                continue;
+            for (size_t c = 0; c < 3; ++c)
+                mean[c] += block[i * 4 + c];
+            ++count;
+        }
+        for (size_t c = 0; c < 3; ++c)
+            mean[c] /= count;
+
+        // Covariance; rr, rg, rb, gg, gb, bb
+        float cov[6] = { 0, 0, 0, 0, 0, 0 };
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if (ignore & (1 << i))
+                continue;
+            float r = block[i * 4] - mean[0];
+            float g = block[i * 4 + 1] - mean[1];
+            float b = block[i * 4 + 2] - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        // Power iteration, from the covariance of the channel which varies
+        // most. The diagonal of the bounding box would be a poor start, it's
+        // at right angles to the axis when channels go opposite ways.
+        const size_t rows[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+        size_t widest = 0;
+        if (cov[3] > cov[0])
+            widest = 1;
+        if (cov[5] > cov[rows[widest][widest]])
+            widest = 2;
+        float axis[3];
+        for (size_t c = 0; c < 3; ++c)
+            axis[c] = cov[rows[widest][c]];
+        for (size_t iter = 0; iter < 4; ++iter)
+        {
+            float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+            float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+            float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+            float largest = std::max(Math::Abs(r), std::max(Math::Abs(g), Math::Abs(b)));
+            if (largest < 1e-6f)
+                break;
+            axis[0] = r / largest;
+            axis[1] = g / largest;
+            axis[2] = b / largest;
+        }
+        if (Math::Abs(axis[0]) + Math::Abs(axis[1]) + Math::Abs(axis[2]) < 1e-6f)
+        {
+            // All one colour, any axis will do
+            axis[0] = 0.299f;
+            axis[1] = 0.587f;
+            axis[2] = 0.114f;
+        }
+
+        float lowest = Math::POS_INFINITY, highest = Math::NEG_INFINITY;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if (ignore & (1 << i))
+                continue;
+            const uint8* p = block + i * 4;
+            float d = p[0] * axis[0] + p[1] * axis[1] + p[2] * axis[2];
+            if (d < lowest)
+            {
+                lowest = d;
+                for (size_t c = 0; c < 3; ++c)
+                    end1[c] = p[c];
+            }
+            if (d > highest)
+            {
+                highest = d;
+                for (size_t c = 0; c < 3; ++c)
+                    end0[c] = p[c];
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    /** Finds the endpoints which best fit the pixels with the indices they
+        have, by least squares.
+    @returns
+        false if the indices don't determine both endpoints.
+    */
+    static bool refineColourEndpoints(const uint8* block, const uint8* indices, uint16 ignore,
+        bool threeColour, int* end0, int* end1)
+    {
+        // The share of endpoint 0 in each index
+        static const float fourWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        static const float threeWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+        const float* weights = threeColour ? threeWeights : fourWeights;
+
+        float aa = 0, bb = 0, ab = 0;
+        float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if (ignore & (1 << i))
+                continue;
+            float a = weights[indices[i]], b = 1.0f - a;
+            aa += a * a;
+            bb += b * b;
+            ab += a * b;
+            for (size_t c = 0; c < 3; ++c)
+            {
+                ax[c] += a * block[i * 4 + c];
+                bx[c] += b * block[i * 4 + c];
+            }
+        }
+
+        float det = aa * bb - ab * ab;
+        if (Math::Abs(det) < 1e-4f)
+            return false;
+        float inv = 1.0f / det;
+        for (size_t c = 0; c < 3; ++c)
+        {
+            float v0 = (ax[c] * bb - bx[c] * ab) * inv;
+            float v1 = (bx[c] * aa - ax[c] * ab) * inv;
+            end0[c] = std::min(255, std::max(0, static_cast<int>(v0 + 0.5f)));
+            end1[c] = std::min(255, std::max(0, static_cast<int>(v1 + 0.5f)));
+        }
+        return true;
+    }
+    //---------------------------------------------------------------------
+    /** Quantises a pair of endpoints, puts them in the order the mode needs
+        and chooses the indices.
+    @returns
+        The squared error of the block.
+    */
+    static uint32 fitColourIndices(const uint8* block, uint16 ignore, bool threeColour,
+        const int* end0, const int* end1, const DXTFunctions& functions,
+        uint16& c0, uint16& c1, uint8* indices)
+    {
+        c0 = packRGB565(end0);
+        c1 = packRGB565(end1);
+        // c0 > c1 selects 4 colours, otherwise there are 3 and transparent
+        if (threeColour ? c0 > c1 : c0 < c1)
+            std::swap(c0, c1);
+
+        uint8 palette[16];
+        buildColourPalette(c0, c1, threeColour, palette);
+        uint32 error = functions.selectColours(block, palette, threeColour ? 3 : 4,
+            ignore, indices);
+        for (size_t i = 0; i < 16; ++i)
+        {
+            if (ignore & (1 << i))
+                indices[i] = 3;
+        }
+        return error;
+    }
+    //---------------------------------------------------------------------
+    /** Encodes the colour of a block.
+    @param allowTransparent Whether pixels with alpha below a half may use
+        the transparent colour, as DXT1 can
+    */
+    static void encodeColourBlock(const uint8* block, bool allowTransparent,
+        const DXTFunctions& functions, uint8* out)
+    {
+        uint16 ignore = 0;
+        if (allowTransparent)
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                if (block[i * 4 + 3] < 128)
+                    ignore |= static_cast<uint16>(1 << i);
+            }
+        }
+
+        uint16 c0 = 0, c1 = 0;
+        uint8 indices[16];
+        if (ignore == 0xFFFF)
+        {
+            // Nothing but the transparent colour
+            memset(indices, 3, sizeof(indices));
+        }
+        else
+        {
+            bool threeColour = ignore != 0;
+            int end0[3], end1[3];
+            findColourEndpoints(block, ignore, end0, end1);
+            uint32 error = fitColourIndices(block, ignore, threeColour, end0, end1,
+                functions, c0, c1, indices);
+
+            if (error > 0 &&
+                refineColourEndpoints(block, indices, ignore, threeColour, end0, end1))
+            {
+                uint16 refined0, refined1;
+                uint8 refinedIndices[16];
+                uint32 refinedError = fitColourIndices(block, ignore, threeColour, 
+                    end0, end1, functions, refined0, refined1, refinedIndices);
+                if (refinedError < error)
+                {
+                    c0 = refined0;
+                    c1 = refined1;
+                    memcpy(indices, refinedIndices, sizeof(indices));
+                }
+            }
+        }
+
+        // Little endian, as the file is
+        out[0] = static_cast<uint8>(c0);
+        out[1] = static_cast<uint8>(c0 >> 8);
+        out[2] = static_cast<uint8>(c1);
+        out[3] = static_cast<uint8>(c1 >> 8);
+        for (size_t row = 0; row < 4; ++row)
+        {
+            const uint8* rowIndices = indices + row * 4;
+            out[4 + row] = static_cast<uint8>(rowIndices[0] | (rowIndices[1] << 2) |
+                (rowIndices[2] << 4) | (rowIndices[3] << 6));
+        }
+    }
+
+//-------------------------------------------------------------------------
+// Alpha blocks
+//-------------------------------------------------------------------------
+
+    /// Encodes the alpha of a block as 4 bits per pixel, as DXT2 and 3 do
+    static void encodeExplicitAlphaBlock(const uint8* block, uint8* out)
+    {
+        for (size_t i = 0; i < 16; i += 2)
+        {
+            out[i / 2] = static_cast<uint8>(mul8Bit(block[i * 4 + 3], 15) |
+                (mul8Bit(block[i * 4 + 7], 15) << 4));
+        }
+    }
+    //---------------------------------------------------------------------
+    /** The alphas a decoder derives from a pair of endpoints: the first two,
+        followed by 6 between them if the first is higher, or else 4 between
+        them then 0 and 255.
+    */
+    static void buildAlphaPalette(int a0, int a1, uint8* palette)
+    {
+        palette[0] = static_cast<uint8>(a0);
+        palette[1] = static_cast<uint8>(a1);
+        if (a0 > a1)
+        {
+            for (int k = 1; k < 7; ++k)
+                palette[k + 1] = static_cast<uint8>(((7 - k) * a0 + k * a1 + 3) / 7);
+        }
+        else
+        {
+            for (int k = 1; k < 5; ++k)
+                palette[k + 1] = static_cast<uint8>(((5 - k) * a0 + k * a1 + 2) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+    //---------------------------------------------------------------------
+    /// Encodes the alpha of a block as endpoints and 3 bit indices, as DXT4 and 5 do
+    static void encodeInterpolatedAlphaBlock(const uint8* block, const DXTFunctions& functions,
+        uint8* out)
+    {
+        int lowest = 255, highest = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            lowest = std::min(lowest, static_cast<int>(block[i * 4 + 3]));
+            highest = std::max(highest, static_cast<int>(block[i * 4 + 3]));
+        }
+
+        // The first higher than the second gives 6 values between the two
+        out[0] = static_cast<uint8>(highest);
+        out[1] = static_cast<uint8>(lowest);
+        if (highest == lowest)
+        {
+            memset(out + 2, 0, 6);
+            return;
+        }
+
+        uint8 palette[8];
+        buildAlphaPalette(highest, lowest, palette);
+
+        uint8 indices[16];
+        functions.selectAlphas(block, palette, indices);
+        uint64 bits = 0;
+        for (size_t i = 0; i < 16; ++i)
+            bits |= static_cast<uint64>(indices[i]) << (i * 3);
+        for (size_t b = 0; b < 6; ++b)
+            out[2 + b] = static_cast<uint8>(bits >> (b * 8));
+    }
+    //---------------------------------------------------------------------
+    /// Multiplies the colour of each pixel of a PF_BYTE_RGBA block by its alpha
+    static void premultiplyBlock(uint8* block)
+    {
+        for (size_t i = 0; i < 64; i += 4)
+        {
+            uint32 alpha = block[i + 3];
+            for (size_t c = 0; c < 3; ++c)
+                block[i + c] = static_cast<uint8>((block[i + c] * alpha + 127) / 255);
+        }
+    }
+
+//-------------------------------------------------------------------------
+// Bands
+//-------------------------------------------------------------------------
+
+    /** Compresses a band of block rows, counting the rows of every slice
+        one after another.
+    */
+    struct CompressBand : public ScaleBand
+    {
+        const PixelBox* src;
+        const PixelBox* dst;
+        DXTFunctions functions;
+
+        void execute(void)
+        {
+            size_t width = src->getWidth(), height = src->getHeight();
+            size_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+            size_t blockSize = dst->format == PF_DXT1 ? 8 : 16;
+            size_t srcPixelSize = PixelUtil::getNumElemBytes(src->format);
+            size_t rowSize = blocksX * 16;
+
+            // 4 rows of pixels as PF_BYTE_RGBA, padded to whole blocks
+            vector<uint8>::type rows(rowSize * 4);
+            uint8 block[64];
+            for (size_t r = firstRow; r < endRow; ++r)
+            {
+                size_t z = r / blocksY, by = r % blocksY;
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    // Rows past the bottom repeat the last one
+                    size_t y = std::min(by * 4 + j, height - 1);
+                    uint8* row = &rows[j * rowSize];
+                    uint8* srcRow = static_cast<uint8*>(src->data) + srcPixelSize *
+                        (src->left + (src->top + y) * src->rowPitch + (src->front + z) * src->slicePitch);
+                    PixelUtil::bulkPixelConversion(PixelBox(width, 1, 1, src->format, srcRow),
+                        PixelBox(width, 1, 1, PF_BYTE_RGBA, row));
+                    for (size_t x = width; x < blocksX * 4; ++x)
+                        memcpy(row + x * 4, row + (width - 1) * 4, 4);
+                }
+
+                uint8* out = static_cast<uint8*>(dst->data) + (z * blocksY + by) * blocksX * blockSize;
+                for (size_t bx = 0; bx < blocksX; ++bx, out += blockSize)
+                {
+                    for (size_t j = 0; j < 4; ++j)
+                        memcpy(block + j * 16, &rows[j * rowSize + bx * 16], 16);
+
+                    switch (dst->format)
+                    {
+                    case PF_DXT1:
+                        encodeColourBlock(block, true, functions, out);
+                        break;
+                    case PF_DXT2:
+                        premultiplyBlock(block);
+                        // Fall through
+                    case PF_DXT3:
+                        encodeExplicitAlphaBlock(block, out);
+                        encodeColourBlock(block, false, functions, out + 8);
+                        break;
+                    case PF_DXT4:
+                        premultiplyBlock(block);
+                        // Fall through
+                    default:
+                        encodeInterpolatedAlphaBlock(block, functions, out);
+                        encodeColourBlock(block, false, functions, out + 8);
+                        break;
+                    }
+                }
+            }
+        }
+    };
+    //---------------------------------------------------------------------
+    void _compressDXT(const PixelBox &src, const PixelBox &dst)
+    {
+        assert(dst.format >= PF_DXT1 && dst.format <= PF_DXT5);
+        assert(PixelUtil::isAccessible(src.format));
+
+        CompressBand band;
+        band.src = &src;
+        band.dst = &dst;
+        band.functions.selectColours = selectColourIndicesGeneral;
+        band.functions.selectAlphas = selectAlphaIndicesGeneral;
+#if __OGRE_HAVE_SSE2_DXT
+        // The conversion kernels are only set to a SIMD level the CPU has
+        if (PixelUtil::_getConversionKernels() != PixelUtil::CK_NONE)
+        {
+            band.functions.selectColours = selectColourIndicesSSE2;
+            band.functions.selectAlphas = selectAlphaIndicesSSE2;
+        }
+#endif
+        size_t blockRows = (src.getHeight() + 3) / 4 * src.getDepth();
+        _runRowBands(band, blockRows, src.getWidth() * src.getHeight() * src.getDepth());
+    }
+
+//-------------------------------------------------------------------------
+// Decompression
+//-------------------------------------------------------------------------
+
+    /** Where the channels go in a destination pixel, for the formats which
+        are 32 bit native endian words with a byte for each channel.
+    */
+    struct DXTPixelLayout
+    {
+        /// Bit shift of red, green, blue and alpha
+        unsigned int shifts[4];
+        /// Mask of the alpha bits
+        uint32 alphaMask;
+    };
+
+    /** Decodes a block to 16 pixels of a layout, one row after another. */
+    typedef void (*BlockDecodeFunction)(const uint8* block, PixelFormat format,
+        const DXTPixelLayout& layout, uint32* pixels);
+
+    //---------------------------------------------------------------------
+    static FORCEINLINE uint32 packLayout(const uint8* rgba, uint8 alpha, const DXTPixelLayout& layout)
+    {
+        return (static_cast<uint32>(rgba[0]) << layout.shifts[0]) |
+            (static_cast<uint32>(rgba[1]) << layout.shifts[1]) |
+            (static_cast<uint32>(rgba[2]) << layout.shifts[2]) |
+            ((static_cast<uint32>(alpha) << layout.shifts[3]) & layout.alphaMask);
+    }
+    //---------------------------------------------------------------------
+    /** The 4 colours of a block, as pixels of the layout. Pixels are opaque
+        unless they're the transparent colour of DXT1.
+    */
+    static void buildDecodePalette(const uint8* colour, PixelFormat format,
+        const DXTPixelLayout& layout, uint32* palette)
+    {
+        uint16 c0 = static_cast<uint16>(colour[0] | (colour[1] << 8));
+        uint16 c1 = static_cast<uint16>(colour[2] | (colour[3] << 8));
+        // Only DXT1 has the mode with a transparent colour
+        bool threeColour = format == PF_DXT1 && c0 <= c1;
+        uint8 rgba[16];
+        buildColourPalette(c0, c1, threeColour, rgba);
+        for (size_t c = 0; c < 4; ++c)
+            palette[c] = packLayout(rgba + c * 4, (threeColour && c == 3) ? 0 : 255, layout);
+    }
+    //---------------------------------------------------------------------
+    /** The alpha of each index of an alpha block, shifted into place in the
+        layout. Only used for DXT2 to 5.
+    */
+    static void buildAlphaLookup(const uint8* block, PixelFormat format,
+        const DXTPixelLayout& layout, uint32* alphas, uint64& indices)
+    {
+        if (format == PF_DXT2 || format == PF_DXT3)
+        {
+            // 4 bits each, so the index is the value
+            for (uint32 a = 0; a < 16; ++a)
+                alphas[a] = ((a * 17) << layout.shifts[3]) & layout.alphaMask;
+            indices = 0;
+            for (size_t b = 0; b < 8; ++b)
+                indices |= static_cast<uint64>(block[b]) << (b * 8);
+        }
+        else
+        {
+            uint8 palette[8];
+            buildAlphaPalette(block[0], block[1], palette);
+            for (size_t a = 0; a < 8; ++a)
+                alphas[a] = (static_cast<uint32>(palette[a]) << layout.shifts[3]) & layout.alphaMask;
+            indices = 0;
+            for (size_t b = 0; b < 6; ++b)
+                indices |= static_cast<uint64>(block[2 + b]) << (b * 8);
+        }
+    }
+    //---------------------------------------------------------------------
+    static void decodeBlockGeneral(const uint8* block, PixelFormat format,
+        const DXTPixelLayout& layout, uint32* pixels)
+    {
+        const uint8* colour = format == PF_DXT1 ? block : block + 8;
+        uint32 palette[4];
+        buildDecodePalette(colour, format, layout, palette);
+        uint32 indices = colour[4] | (colour[5] << 8) | (colour[6] << 16) |
+            (static_cast<uint32>(colour[7]) << 24);
+        for (size_t i = 0; i < 16; ++i)
+            pixels[i] = palette[(indices >> (i * 2)) & 3];
+
+        if (format != PF_DXT1)
+        {
+            uint32 alphas[16];
+            uint64 alphaIndices;
+            buildAlphaLookup(block, format, layout, alphas, alphaIndices);
+            size_t bits = (format == PF_DXT2 || format == PF_DXT3) ? 4 : 3;
+            uint32 mask = (1 << bits) - 1;
+            for (size_t i = 0; i < 16; ++i)
+            {
+                pixels[i] = (pixels[i] & ~layout.alphaMask) | 
+                    alphas[static_cast<uint32>(alphaIndices >> (i * bits)) & mask];
+            }
+        }
+    }
+
+#if __OGRE_HAVE_SSE2_DXT
+    // A row of the block is one register. Each pixel takes the palette entry
+    // whose index matches its field of the row's index byte.
+    __OGRE_SSE2_FUNCTION static void decodeBlockSSE2(const uint8* block, PixelFormat format,
+        const DXTPixelLayout& layout, uint32* pixels)
+    {
+        const uint8* colour = format == PF_DXT1 ? block : block + 8;
+        uint32 palette[4];
+        buildDecodePalette(colour, format, layout, palette);
+
+        const __m128i fields = _mm_set_epi32(3 << 6, 3 << 4, 3 << 2, 3);
+        const __m128i ones = _mm_set_epi32(1 << 6, 1 << 4, 1 << 2, 1);
+        __m128i entries[4], matches[4];
+        for (size_t c = 0; c < 4; ++c)
+            entries[c] = _mm_set1_epi32(static_cast<int>(palette[c]));
+        matches[0] = _mm_setzero_si128();
+        matches[1] = ones;
+        matches[2] = _mm_add_epi32(ones, ones);
+        matches[3] = _mm_add_epi32(matches[2], ones);
+
+        __m128i* out = reinterpret_cast<__m128i*>(pixels);
+        for (size_t row = 0; row < 4; ++row)
+        {
+            __m128i index = _mm_and_si128(_mm_set1_epi32(colour[4 + row]), fields);
+            __m128i result = _mm_setzero_si128();
+            for (size_t c = 0; c < 4; ++c)
+                result = _mm_or_si128(result, 
+                    _mm_and_si128(_mm_cmpeq_epi32(index, matches[c]), entries[c]));
+            _mm_storeu_si128(out + row, result);
+        }
+
+        if (format != PF_DXT1)
+        {
+            uint32 alphas[16];
+            uint64 alphaIndices;
+            buildAlphaLookup(block, format, layout, alphas, alphaIndices);
+            size_t bits = (format == PF_DXT2 || format == PF_DXT3) ? 4 : 3;
+            uint32 mask = (1 << bits) - 1;
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(layout.alphaMask));
+            for (size_t row = 0; row < 4; ++row)
+            {
+                size_t first = row * 4 * bits;
+                __m128i alpha = _mm_set_epi32(
+                    static_cast<int>(alphas[static_cast<uint32>(alphaIndices >> (first + 3 * bits)) & mask]),
+                    static_cast<int>(alphas[static_cast<uint32>(alphaIndices >> (first + 2 * bits)) & mask]),
+                    static_cast<int>(alphas[static_cast<uint32>(alphaIndices >> (first + bits)) & mask]),
+                    static_cast<int>(alphas[static_cast<uint32>(alphaIndices >> first) & mask]));
+                __m128i result = _mm_loadu_si128(out + row);
+                _mm_storeu_si128(out + row, _mm_or_si128(_mm_andnot_si128(alphaMask, result), alpha));
+            }
+        }
+    }
+#endif
+    //---------------------------------------------------------------------
+    /** Finds the layout of a format the blocks can be decoded to directly.
+    @returns
+        false if the format isn't one of them.
+    */
+    static bool getDirectLayout(PixelFormat format, DXTPixelLayout& layout)
+    {
+        if (PixelUtil::getNumElemBytes(format) != 4 ||
+            !(PixelUtil::getFlags(format) & PFF_NATIVEENDIAN) ||
+            PixelUtil::getComponentType(format) != PCT_BYTE)
+            return false;
+
+        int bits[4];
+        uint32 masks[4];
+        uchar shifts[4];
+        PixelUtil::getBitDepths(format, bits);
+        PixelUtil::getBitMasks(format, masks);
+        PixelUtil::getBitShifts(format, shifts);
+        for (size_t c = 0; c < 3; ++c)
+        {
+            if (bits[c] != 8)
+                return false;
+            layout.shifts[c] = shifts[c];
+        }
+        if (bits[3] != 8 && bits[3] != 0)
+            return false;
+        // The X8 formats have the alpha mask too, and get alpha there as
+        // they do from packColour
+        layout.shifts[3] = shifts[3];
+        layout.alphaMask = masks[3];
+        return true;
+    }
+    //---------------------------------------------------------------------
+    /** Decompresses a band of block rows, counting the rows of every slice
+        one after another.
+    */
+    struct DecompressBand : public ScaleBand
+    {
+        const PixelBox* src;
+        const PixelBox* dst;
+        BlockDecodeFunction decodeBlock;
+        /// Whether the blocks go straight into dst, in this layout
+        bool direct;
+        DXTPixelLayout layout;
+
+        void execute(void)
+        {
+            size_t width = dst->getWidth(), height = dst->getHeight();
+            size_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+            size_t blockSize = src->format == PF_DXT1 ? 8 : 16;
+            size_t dstPixelSize = PixelUtil::getNumElemBytes(dst->format);
+
+            // Otherwise 4 rows of PF_BYTE_RGBA, converted into dst afterwards
+            size_t stripPitch = blocksX * 4;
+            vector<uint32>::type strip(direct ? 0 : stripPitch * 4);
+            uint32 pixels[16];
+            for (size_t r = firstRow; r < endRow; ++r)
+            {
+                size_t z = r / blocksY, by = r % blocksY;
+                size_t rows = std::min((size_t)4, height - by * 4);
+                const uint8* block = static_cast<const uint8*>(src->data) + 
+                    (z * blocksY + by) * blocksX * blockSize;
+                uint8* dstRow = static_cast<uint8*>(dst->data) + dstPixelSize *
+                    (dst->left + (dst->top + by * 4) * dst->rowPitch + (dst->front + z) * dst->slicePitch);
+
+                for (size_t bx = 0; bx < blocksX; ++bx, block += blockSize)
+                {
+                    decodeBlock(block, src->format, layout, pixels);
+                    if (direct)
+                    {
+                        size_t columns = std::min((size_t)4, width - bx * 4);
+                        uint8* out = dstRow + bx * 16;
+                        for (size_t y = 0; y < rows; ++y, out += dst->rowPitch * 4)
+                            memcpy(out, pixels + y * 4, columns * 4);
+                    }
+                    else
+                    {
+                        for (size_t y = 0; y < 4; ++y)
+                            memcpy(&strip[y * stripPitch + bx * 4], pixels + y * 4, 16);
+                    }
+                }
+
+                if (!direct)
+                {
+                    for (size_t y = 0; y < rows; ++y)
+                    {
+                        PixelUtil::bulkPixelConversion(
+                            PixelBox(width, 1, 1, PF_BYTE_RGBA, &strip[y * stripPitch]),
+                            PixelBox(width, 1, 1, dst->format, dstRow + y * dst->rowPitch * dstPixelSize));
+                    }
+                }
+            }
+        }
+    };
+    //---------------------------------------------------------------------
+    void _decompressDXT(const PixelBox &src, const PixelBox &dst)
+    {
+        assert(src.format >= PF_DXT1 && src.format <= PF_DXT5);
+        assert(PixelUtil::isAccessible(dst.format));
+
+        DecompressBand band;
+        band.src = &src;
+        band.dst = &dst;
+        band.direct = getDirectLayout(dst.format, band.layout);
+        if (!band.direct)
+            getDirectLayout(PF_BYTE_RGBA, band.layout);
+        band.decodeBlock = decodeBlockGeneral;
+#if __OGRE_HAVE_SSE2_DXT
+        if (PixelUtil::_getConversionKernels() != PixelUtil::CK_NONE)
+            band.decodeBlock = decodeBlockSSE2;
+#endif
+        size_t blockRows = (dst.getHeight() + 3) / 4 * dst.getDepth();
+        _runRowBands(band, blockRows, dst.getWidth() * dst.getHeight() * dst.getDepth());
+    }
+
+}
@@ -0,0 +1,59 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+/** Internal include file -- do not use externally */
+#ifndef __DXTConversion_H__
+#define __DXTConversion_H__
+
+#include "OgrePixelFormat.h"
+
+namespace Ogre {
+
+    /** Compresses a box of pixels to one of the DXT formats.
+    @remarks
+        The source can be any accessible format, and any size; blocks which
+        run off the edge are padded with the pixels on the edge. dst must
+        describe the whole compressed image, as bulkPixelConversion requires
+        of compressed boxes. DXT1 uses its transparent colour for pixels with
+        alpha below a half. Large images are compressed in bands of block rows
+        on the shared task group from Root.
+    */
+    void _compressDXT(const PixelBox &src, const PixelBox &dst);
+
+    /** Decompresses a box in one of the DXT formats to any accessible format.
+    @remarks
+        src must describe the whole compressed image, and dst a box of the
+        same size. The decoded values are exact, with the colours between
+        the endpoints rounded the same way as the compressor assumes. DXT2
+        and DXT4 are decoded as they're stored, without undoing the
+        premultiplied alpha.
+    */
+    void _decompressDXT(const PixelBox &src, const PixelBox &dst);
+
+}
+
+#endif
@@ -30,6 +30,20 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreException.h"
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  if !defined(NOMINMAX) && defined(_MSC_VER)
+#	define NOMINMAX // required to stop windows.h messing up std::min
+#  endif
+#  include <windows.h>
+#else
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 namespace Ogre {
 
     //-----------------------------------------------------------------------
@@ -222,6 +236,9 @@ namespace Ogre {
         bool freeOnClose, bool readOnly)
         : DataStream(static_cast<uint16>(readOnly ? READ : (READ | WRITE)))
     {
+        if (shareMemory(sourceStream))
+            return;
+
         // Copy data from incoming stream
         mSize = sourceStream->size();
         mData = OGRE_ALLOC_T(uchar, mSize, MEMCATEGORY_GENERAL);
@@ -248,6 +265,9 @@ namespace Ogre {
         bool freeOnClose, bool readOnly)
         : DataStream(name, static_cast<uint16>(readOnly ? READ : (READ | WRITE)))
     {
+        if (shareMemory(sourceStream))
+            return;
+
         // Copy data from incoming stream
         mSize = sourceStream->size();
         mData = OGRE_ALLOC_T(uchar, mSize, MEMCATEGORY_GENERAL);
@@ -257,6 +277,18 @@ namespace Ogre {
         assert(mEnd >= mPos);
     }
     //-----------------------------------------------------------------------
+    MemoryDataStream::MemoryDataStream(const String& name, const DataStreamPtr& sourceStream, 
+        const uchar* pMem, size_t size)
+        : DataStream(name, READ)
+    {
+        assert(sourceStream->getSharedMemory() && "Source stream's memory is not shared");
+        mData = mPos = const_cast<uchar*>(pMem);
+        mSize = size;
+        mEnd = mData + mSize;
+        mFreeOnClose = false;
+        mSharedSource = sourceStream;
+    }
+    //-----------------------------------------------------------------------
     MemoryDataStream::MemoryDataStream(size_t size, bool freeOnClose, bool readOnly)
         : DataStream(static_cast<uint16>(readOnly ? READ : (READ | WRITE)))
     {
@@ -285,6 +317,24 @@ namespace Ogre {
         close();
     }
     //-----------------------------------------------------------------------
+    bool MemoryDataStream::shareMemory(const DataStreamPtr& sourceStream)
+    {
+        // Memory we don't own can only be shared if nobody writes to it
+        const uchar* shared = sourceStream->getSharedMemory();
+        if (!shared || isWriteable())
+            return false;
+
+        mData = mPos = const_cast<uchar*>(shared);
+        mSize = sourceStream->size() - sourceStream->tell();
+        mEnd = mData + mSize;
+        mFreeOnClose = false;
+        mSharedSource = sourceStream;
+
+        // Leave the source as if it had been read
+        sourceStream->seek(sourceStream->size());
+        return true;
+    }
+    //-----------------------------------------------------------------------
     size_t MemoryDataStream::read(void* buf, size_t count)
     {
         size_t cnt = count;
@@ -410,6 +460,93 @@ namespace Ogre {
             mData = 0;
         }
 
+        if (!mSharedSource.isNull())
+        {
+            mData = 0;
+            mSharedSource.setNull();
+        }
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::MappedFileDataStream(const String& name, const String& fileName)
+        : MemoryDataStream(name, 0, 0, false, true)
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 
+            0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                "Cannot open file: " + fileName,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize))
+            mSize = static_cast<size_t>(fileSize.QuadPart);
+        if (mSize)
+        {
+            // The view keeps the mapping open once the handles are closed
+            HANDLE mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+            if (mapping)
+            {
+                mData = static_cast<uchar*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+                "Cannot open file: " + fileName,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+        struct stat tagStat;
+        if (fstat(fd, &tagStat) == 0)
+            mSize = static_cast<size_t>(tagStat.st_size);
+        if (mSize)
+        {
+            // The mapping stays valid once the file is closed
+            void* mapped = mmap(0, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                mData = static_cast<uchar*>(mapped);
+#   ifdef MADV_SEQUENTIAL
+                // Serializers mostly read front to back
+                madvise(mapped, mSize, MADV_SEQUENTIAL);
+#   endif
+            }
+        }
+        ::close(fd);
+#endif
+
+        if (mSize && !mData)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR,
+                "Cannot map file: " + fileName,
+                "MappedFileDataStream::MappedFileDataStream");
+        }
+        mPos = mData;
+        mEnd = mData + mSize;
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        close();
+    }
+    //-----------------------------------------------------------------------
+    void MappedFileDataStream::close(void)
+    {
+        if (mData)
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            UnmapViewOfFile(mData);
+#else
+            munmap(mData, mSize);
+#endif
+            mData = mPos = mEnd = 0;
+        }
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
@@ -49,10 +49,12 @@ THE SOFTWARE.
 #include "OgreStringConverter.h"
 #include "OgreAnimation.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreSoftwareAnimationBatch.h"
 #include "OgreSceneNode.h"
 #include "OgreLodStrategy.h"
 #include "OgreLodListener.h"
 #include "OgreMaterialManager.h"
+#include "OgreResourceBudgetManager.h"
 
 namespace Ogre {
     //-----------------------------------------------------------------------
@@ -547,6 +549,15 @@ namespace Ogre {
 		if (!mInitialised)
 			return;
 
+		// Mark the mesh as used, reloading it if it has been unloaded; once a 
+		// frame is enough however many entities share the mesh
+		ResourceBudgetManager* budgetMgr = ResourceBudgetManager::getSingletonPtr();
+		if (!mMesh->isLoaded() || 
+			(budgetMgr && mMesh->getLastUsedFrame() != budgetMgr->getCurrentFrame()))
+		{
+			mMesh->touch();
+		}
+
 		// Check mesh state count, will be incremented if reloaded
 		if (mMesh->getStateCount() != mMeshStateCount)
 		{
@@ -596,35 +607,14 @@ namespace Ogre {
         }
 
         // Since we know we're going to be rendered, take this opportunity to
-        // update the animation
+        // update the animation, unless the scene manager will do it later so
+        // that skeletons can be evaluated in parallel
         if (displayEntity->hasSkeleton() || displayEntity->hasVertexAnimation())
         {
-            displayEntity->updateAnimation();
-
-            //--- pass this point,  we are sure that the transformation matrix of each bone and tagPoint have been updated
-            ChildObjectList::iterator child_itr = mChildObjectList.begin();
-            ChildObjectList::iterator child_itr_end = mChildObjectList.end();
-            for( ; child_itr != child_itr_end; child_itr++)
+            if (!displayEntity->hasSkeleton() || !mManager ||
+                !mManager->_deferSkeletalAnimation(this, displayEntity, queue))
             {
-                MovableObject* child = child_itr->second;
-                bool isVisible = child->isVisible();
-                if (isVisible && (displayEntity != this))
-                {
-                    //Check if the bone exists in the current LOD
-
-                    //The child is connected to a tagpoint which is connected to a bone
-                    Bone* bone = static_cast<Bone*>(child->getParentNode()->getParent());
-                    if (!displayEntity->getSkeleton()->hasBone(bone->getName()))
-                    {
-                        //Current LOD entity does not have the bone that the
-                        //child is connected to. Do not display.
-                        isVisible = false;
-                    }
-                }
-                if (isVisible)
-                {
-                    child->_updateRenderQueue(queue);
-                }   
+                _updateAnimationAndQueueChildren(displayEntity, queue);
             }
         }
 
@@ -656,6 +646,37 @@ namespace Ogre {
 
 
 
+    }
+    //-----------------------------------------------------------------------
+    void Entity::_updateAnimationAndQueueChildren(Entity* displayEntity, RenderQueue* queue)
+    {
+        displayEntity->updateAnimation();
+
+        //--- pass this point,  we are sure that the transformation matrix of each bone and tagPoint have been updated
+        ChildObjectList::iterator child_itr = mChildObjectList.begin();
+        ChildObjectList::iterator child_itr_end = mChildObjectList.end();
+        for( ; child_itr != child_itr_end; child_itr++)
+        {
+            MovableObject* child = child_itr->second;
+            bool isVisible = child->isVisible();
+            if (isVisible && (displayEntity != this))
+            {
+                //Check if the bone exists in the current LOD
+
+                //The child is connected to a tagpoint which is connected to a bone
+                Bone* bone = static_cast<Bone*>(child->getParentNode()->getParent());
+                if (!displayEntity->getSkeleton()->hasBone(bone->getName()))
+                {
+                    //Current LOD entity does not have the bone that the
+                    //child is connected to. Do not display.
+                    isVisible = false;
+                }
+            }
+            if (isVisible)
+            {
+                child->_updateRenderQueue(queue);
+            }   
+        }
     }
     //-----------------------------------------------------------------------
     AnimationState* Entity::getAnimationState(const String& name) const
@@ -750,6 +771,13 @@ namespace Ogre {
 			(softwareAnimation && hasVertexAnimation() && !tempVertexAnimBuffersBound()) ||
 			(softwareAnimation && hasSkeleton() && !tempSkelAnimBuffersBound(blendNormals)))
         {
+			// If the scene manager is collecting software animation, add our
+			// work to its batch as a job of its own instead of doing it now
+			SoftwareAnimationBatch* batch = 
+				(softwareAnimation && mManager) ? mManager->_getSoftwareAnimationBatch() : 0;
+			if (batch)
+				batch->beginJob();
+
 			if (hasVertexAnimation())
 			{
 				if (softwareAnimation)
@@ -781,7 +809,7 @@ namespace Ogre {
 
 					}
 				}
-				applyVertexAnimation(hwAnimation, stencilShadows);
+				applyVertexAnimation(hwAnimation, stencilShadows, batch);
 			}
 
 			if (hasSkeleton())
@@ -813,7 +841,7 @@ namespace Ogre {
 								mSoftwareVertexAnimVertexData :	mMesh->sharedVertexData,
 							mSkelAnimVertexData,
 							blendMatrices, mMesh->sharedBlendIndexToBoneIndexMap.size(),
-							blendNormals);
+							blendNormals, batch);
 					}
 					SubEntityList::iterator i, iend;
 					iend = mSubEntityList.end();
@@ -835,7 +863,7 @@ namespace Ogre {
 									se->mSoftwareVertexAnimVertexData : se->mSubMesh->vertexData,
 								se->mSkelAnimVertexData,
 								blendMatrices, se->mSubMesh->blendIndexToBoneIndexMap.size(),
-								blendNormals);
+								blendNormals, batch);
 						}
 
 					}
@@ -904,7 +932,8 @@ namespace Ogre {
 
 	}
 	//-----------------------------------------------------------------------
-	void Entity::applyVertexAnimation(bool hardwareAnimation, bool stencilShadows)
+	void Entity::applyVertexAnimation(bool hardwareAnimation, bool stencilShadows,
+		SoftwareAnimationBatch* batch)
 	{
 		const MeshPtr& msh = getMesh();
 		bool swAnim = !hardwareAnimation || stencilShadows || (mSoftwareAnimationRequests>0);
@@ -977,7 +1006,7 @@ namespace Ogre {
             if (anim)
             {
                 anim->apply(this, state->getTimePosition(), state->getWeight(),
-                    swAnim, hardwareAnimation);
+                    swAnim, hardwareAnimation, batch);
             }
 		}
 		// Deal with cases where no animation applied
@@ -1163,6 +1192,17 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Entity::_updateBoneMatrices(void)
+    {
+        // Only when updateAnimation would find the animation dirty
+        if (mInitialised && hasSkeleton() &&
+            (mFrameAnimationLastUpdated != mAnimationState->getDirtyFrameNumber() ||
+            getSkeleton()->getManualBonesDirty()))
+        {
+            cacheBoneMatrices();
+        }
+    }
+    //-----------------------------------------------------------------------
     void Entity::setDisplaySkeleton(bool display)
     {
         mDisplaySkeleton = display;
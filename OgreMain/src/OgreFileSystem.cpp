@@ -56,6 +56,7 @@ THE SOFTWARE.
 namespace Ogre {
 
 	bool FileSystemArchive::ms_IgnoreHidden = true;
+	bool FileSystemArchive::ms_UseMappedFiles = false;
 
     //-----------------------------------------------------------------------
     FileSystemArchive::FileSystemArchive(const String& name, const String& archType )
@@ -220,6 +221,9 @@ namespace Ogre {
 		assert(ret == 0 && "Problem getting file size" );
         (void)ret;  // Silence warning
 
+		if (readOnly && ms_UseMappedFiles)
+			return DataStreamPtr(OGRE_NEW MappedFileDataStream(filename, full_path));
+
 		// Always open in binary mode
 		// Also, always include reading
 		std::ios::openmode mode = std::ios::in | std::ios::binary;
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "OgreFrustum.h"
 
 #include "OgreMath.h"
+#include "OgreAxisAlignedBoxBatch.h"
 #include "OgreMatrix3.h"
 #include "OgreSceneNode.h"
 #include "OgreSphere.h"
@@ -260,6 +261,29 @@ namespace Ogre {
         return true;
     }
 
+    //-----------------------------------------------------------------------
+    void Frustum::isVisible(AxisAlignedBoxBatch& bounds) const
+    {
+        Plane planes[6];
+        size_t numPlanes = getCullingPlanes(planes);
+        bounds.cull(planes, numPlanes);
+    }
+    //-----------------------------------------------------------------------
+    size_t Frustum::getCullingPlanes(Plane* planes) const
+    {
+        // Make any pending updates to the calculated frustum planes
+        updateFrustumPlanes();
+
+        // Skip far plane if infinite view frustum
+        size_t numPlanes = 0;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            if (plane == FRUSTUM_PLANE_FAR && mFarDist == 0)
+                continue;
+            planes[numPlanes++] = mFrustumPlanes[plane];
+        }
+        return numPlanes;
+    }
     //-----------------------------------------------------------------------
     bool Frustum::isVisible(const Vector3& vert, FrustumPlane* culledBy) const
     {
@@ -544,10 +568,22 @@ namespace Ogre {
 #endif
 
 		RenderSystem* renderSystem = Root::getSingleton().getRenderSystem();
-		// API specific
-		renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRS);
-		// API specific for Gpu Programs
-		renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRSDepth, true);
+		if (renderSystem)
+		{
+			// API specific
+			renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRS);
+			// API specific for Gpu Programs
+			renderSystem->_convertProjectionMatrix(mProjMatrix, mProjMatrixRSDepth, true);
+		}
+		else
+		{
+			// No render system selected yet (tools, servers, tests). Only the
+			// generic matrix is needed for culling, so keep the API specific
+			// ones in the generic form until a render system is set; they are
+			// recalculated on the next projection change after that.
+			mProjMatrixRS = mProjMatrix;
+			mProjMatrixRSDepth = mProjMatrix;
+		}
 
 
 		// Calculate bounding box (local)
@@ -33,10 +33,78 @@ THE SOFTWARE.
 #include "OgreColourValue.h"
 
 #include "OgreImageResampler.h"
+#include "OgreImageFilter.h"
 
 namespace Ogre {
+	/** Scales a band of rows with one of the resamplers in OgreImageResampler.h.
+	*/
+	template<class Resampler> struct ResampleBand : public ScaleBand
+	{
+		const PixelBox* src;
+		const PixelBox* dst;
+
+		void execute(void)
+		{
+			Resampler::scale(*src, *dst, firstRow, endRow);
+		}
+	};
+	//-----------------------------------------------------------------------------
+	template<class Resampler> static void resample(const PixelBox &src, const PixelBox &dst)
+	{
+		ResampleBand<Resampler> band;
+		band.src = &src;
+		band.dst = &dst;
+		_runScaleBands(band, dst);
+	}
+	//-----------------------------------------------------------------------------
 	ImageCodec::~ImageCodec() {
 	}
+	//-----------------------------------------------------------------------------
+	Codec::CodecDataPtr ImageCodec::decodeHeader(DataStreamPtr& input) const
+	{
+		return decode(input).second;
+	}
+	//-----------------------------------------------------------------------------
+	Codec::DecodeResult ImageCodec::decodeMipmaps(DataStreamPtr& input, size_t firstMip) const
+	{
+		DecodeResult res = decode(input);
+		ImageData* imgData = static_cast<ImageData*>(res.second.getPointer());
+		firstMip = std::min(firstMip, (size_t)imgData->num_mipmaps);
+		if (firstMip == 0)
+			return res;
+
+		// Copy out the levels wanted, all mips for a face, then each face
+		size_t numFaces = (imgData->flags & IF_CUBEMAP) ? 6 : 1;
+		size_t width = std::max((size_t)1, imgData->width >> firstMip);
+		size_t height = std::max((size_t)1, imgData->height >> firstMip);
+		size_t depth = std::max((size_t)1, imgData->depth >> firstMip);
+		size_t numMipmaps = imgData->num_mipmaps - firstMip;
+		size_t size = Image::calculateSize(numMipmaps, numFaces, width, height, depth, imgData->format);
+		size_t faceSize = imgData->size / numFaces;
+		size_t skipSize = faceSize - size / numFaces;
+
+		MemoryDataStreamPtr output(OGRE_NEW MemoryDataStream(size));
+		uchar* src = res.first->getPtr();
+		uchar* dest = output->getPtr();
+		for (size_t face = 0; face < numFaces; ++face)
+		{
+			memcpy(dest, src + face * faceSize + skipSize, size / numFaces);
+			dest += size / numFaces;
+		}
+
+		imgData->width = width;
+		imgData->height = height;
+		imgData->depth = depth;
+		imgData->num_mipmaps = static_cast<ushort>(numMipmaps);
+		imgData->size = size;
+		res.first = output;
+		return res;
+	}
+	//-----------------------------------------------------------------------------
+	ImageRegionReader* ImageCodec::createRegionReader(DataStreamPtr& input) const
+	{
+		return 0;
+	}
 
 	//-----------------------------------------------------------------------------
 	Image::Image()
@@ -340,6 +408,8 @@ namespace Ogre {
 		imgData->width = m_uWidth;
 		imgData->depth = m_uDepth;
 		imgData->size = m_uSize;
+		imgData->num_mipmaps = static_cast<ushort>(m_uNumMipmaps);
+		imgData->flags = m_uFlags;
 		// Wrap in CodecDataPtr, this will delete
 		Codec::CodecDataPtr codeDataPtr(imgData);
 		// Wrap memory, be sure not to delete when stream destroyed
@@ -592,7 +662,81 @@ namespace Ogre {
 		Image::scale(temp.getPixelBox(), getPixelBox(), filter);
 	}
 	//-----------------------------------------------------------------------
-	void Image::scale(const PixelBox &src, const PixelBox &scaled, Filter filter) 
+	void Image::generateMipmaps(bool gammaCorrect, Filter filter)
+	{
+		if (PixelUtil::isCompressed(m_eFormat))
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+				"Mipmaps can't be generated for a compressed image",
+				"Image::generateMipmaps");
+		}
+
+		size_t numMipmaps = 0;
+		for (size_t w = m_uWidth, h = m_uHeight, d = m_uDepth; w > 1 || h > 1 || d > 1; ++numMipmaps)
+		{
+			if (w > 1) w /= 2;
+			if (h > 1) h /= 2;
+			if (d > 1) d /= 2;
+		}
+
+		size_t numFaces = getNumFaces();
+		size_t size = calculateSize(numMipmaps, numFaces, m_uWidth, m_uHeight, m_uDepth, m_eFormat);
+		uchar* buffer = OGRE_ALLOC_T(uchar, size, MEMCATEGORY_GENERAL);
+
+		// Same layout as getPixelBox expects, all the levels of one face together
+		uchar* dest = buffer;
+		for (size_t face = 0; face < numFaces; ++face)
+		{
+			PixelBox level = getPixelBox(face, 0);
+			PixelBox prev(level.getWidth(), level.getHeight(), level.getDepth(), m_eFormat, dest);
+			memcpy(dest, level.data, level.getConsecutiveSize());
+			dest += level.getConsecutiveSize();
+
+			// Each level comes from the one above, which is a quarter of the
+			// work of filtering down from the top one
+			for (size_t mip = 1; mip <= numMipmaps; ++mip)
+			{
+				PixelBox next(std::max((size_t)1, prev.getWidth() / 2), 
+					std::max((size_t)1, prev.getHeight() / 2), 
+					std::max((size_t)1, prev.getDepth() / 2), m_eFormat, dest);
+				Image::scale(prev, next, filter, gammaCorrect);
+				dest += next.getConsecutiveSize();
+				prev = next;
+			}
+		}
+
+		freeMemory();
+		m_pBuffer = buffer;
+		m_uSize = size;
+		m_uNumMipmaps = numMipmaps;
+		m_bAutoDelete = true;
+	}
+	//-----------------------------------------------------------------------
+	void Image::convert(PixelFormat format)
+	{
+		if (format == m_eFormat)
+			return;
+
+		size_t numFaces = getNumFaces();
+		size_t size = calculateSize(m_uNumMipmaps, numFaces, m_uWidth, m_uHeight, m_uDepth, format);
+		uchar* buffer = OGRE_ALLOC_T(uchar, size, MEMCATEGORY_GENERAL);
+		// Owns the buffer until it's filled, in case the conversion throws
+		Image converted;
+		converted.loadDynamicImage(buffer, m_uWidth, m_uHeight, m_uDepth, format, true, 
+			numFaces, m_uNumMipmaps);
+		for (size_t face = 0; face < numFaces; ++face)
+		{
+			for (size_t mip = 0; mip <= m_uNumMipmaps; ++mip)
+				PixelUtil::bulkPixelConversion(getPixelBox(face, mip), converted.getPixelBox(face, mip));
+		}
+
+		converted.m_bAutoDelete = false;
+		loadDynamicImage(buffer, m_uWidth, m_uHeight, m_uDepth, format, true, 
+			numFaces, m_uNumMipmaps);
+	}
+	//-----------------------------------------------------------------------
+	void Image::scale(const PixelBox &src, const PixelBox &scaled, Filter filter, 
+		bool gammaCorrect) 
 	{
 		assert(PixelUtil::isAccessible(src.format));
 		assert(PixelUtil::isAccessible(scaled.format));
@@ -600,6 +744,14 @@ namespace Ogre {
 		PixelBox temp;
 		switch (filter) 
 		{
+		case FILTER_BOX:
+		case FILTER_TRIANGLE:
+		case FILTER_BICUBIC:
+		case FILTER_KAISER:
+		case FILTER_LANCZOS:
+			_filterScale(src, scaled, filter, gammaCorrect);
+			break;
+
 		default:
 		case FILTER_NEAREST:
 			if(src.format == scaled.format) 
@@ -617,14 +769,14 @@ namespace Ogre {
 			// super-optimized: no conversion
 			switch (PixelUtil::getNumElemBytes(src.format)) 
 			{
-			case 1: NearestResampler<1>::scale(src, temp); break;
-			case 2: NearestResampler<2>::scale(src, temp); break;
-			case 3: NearestResampler<3>::scale(src, temp); break;
-			case 4: NearestResampler<4>::scale(src, temp); break;
-			case 6: NearestResampler<6>::scale(src, temp); break;
-			case 8: NearestResampler<8>::scale(src, temp); break;
-			case 12: NearestResampler<12>::scale(src, temp); break;
-			case 16: NearestResampler<16>::scale(src, temp); break;
+			case 1: resample<NearestResampler<1> >(src, temp); break;
+			case 2: resample<NearestResampler<2> >(src, temp); break;
+			case 3: resample<NearestResampler<3> >(src, temp); break;
+			case 4: resample<NearestResampler<4> >(src, temp); break;
+			case 6: resample<NearestResampler<6> >(src, temp); break;
+			case 8: resample<NearestResampler<8> >(src, temp); break;
+			case 12: resample<NearestResampler<12> >(src, temp); break;
+			case 16: resample<NearestResampler<16> >(src, temp); break;
 			default:
 				// never reached
 				assert(false);
@@ -638,6 +790,12 @@ namespace Ogre {
 
 		case FILTER_LINEAR:
 		case FILTER_BILINEAR:
+			if (gammaCorrect)
+			{
+				// the resamplers below blend the encoded values
+				_filterScale(src, scaled, filter, gammaCorrect);
+				break;
+			}
 			switch (src.format) 
 			{
 			case PF_L8: case PF_A8: case PF_BYTE_LA:
@@ -660,10 +818,10 @@ namespace Ogre {
 				// super-optimized: byte-oriented math, no conversion
 				switch (PixelUtil::getNumElemBytes(src.format)) 
 				{
-				case 1: LinearResampler_Byte<1>::scale(src, temp); break;
-				case 2: LinearResampler_Byte<2>::scale(src, temp); break;
-				case 3: LinearResampler_Byte<3>::scale(src, temp); break;
-				case 4: LinearResampler_Byte<4>::scale(src, temp); break;
+				case 1: resample<LinearResampler_Byte<1> >(src, temp); break;
+				case 2: resample<LinearResampler_Byte<2> >(src, temp); break;
+				case 3: resample<LinearResampler_Byte<3> >(src, temp); break;
+				case 4: resample<LinearResampler_Byte<4> >(src, temp); break;
 				default:
 					// never reached
 					assert(false);
@@ -679,13 +837,13 @@ namespace Ogre {
 				if (scaled.format == PF_FLOAT32_RGB || scaled.format == PF_FLOAT32_RGBA)
 				{
 					// float32 to float32, avoid unpack/repack overhead
-					LinearResampler_Float32::scale(src, scaled);
+					resample<LinearResampler_Float32>(src, scaled);
 					break;
 				}
 				// else, fall through
 			default:
 				// non-optimized: floating-point math, performs conversion but always works
-				LinearResampler::scale(src, scaled);
+				resample<LinearResampler>(src, scaled);
 			}
 			break;
 		}
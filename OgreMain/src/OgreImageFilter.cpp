@@ -0,0 +1,496 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreImageFilter.h"
+#include "OgreMath.h"
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_SSE
+#   include <xmmintrin.h>
+#endif
+
+//-------------------------------------------------------------------------
+//
+// Separable filtering for Image::scale. The weights each destination pixel
+// takes from the source are worked out once per axis. Each source row is
+// then unpacked to FLOAT32_RGBA and filtered horizontally, and the
+// destination rows are summed from those. A band keeps the filtered rows
+// it needs in a small ring, indexed by source row, so every source row is
+// filtered horizontally only once in each band however many destination
+// rows it contributes to.
+//
+//-------------------------------------------------------------------------
+
+namespace Ogre {
+
+    /** A filter function, and how far from its centre it reaches.
+    */
+    struct FilterKernel
+    {
+        /// The weight of a source pixel x pixels from the sample point
+        float (*function)(float x);
+        /// Distance beyond which the weight is 0
+        float support;
+        /// Whether to widen the filter when minifying, so that every source
+        /// pixel contributes, rather than interpolating between a few
+        bool widen;
+    };
+
+    static float boxFilter(float x)
+    {
+        // Half open, so that a pixel on the edge isn't counted twice
+        return (x >= -0.5f && x < 0.5f) ? 1.0f : 0.0f;
+    }
+
+    static float triangleFilter(float x)
+    {
+        x = Math::Abs(x);
+        return x < 1.0f ? 1.0f - x : 0.0f;
+    }
+
+    static float cubicFilter(float x)
+    {
+        // Catmull-Rom, which passes through the source pixels
+        x = Math::Abs(x);
+        if (x < 1.0f)
+            return (1.5f * x - 2.5f) * x * x + 1.0f;
+        if (x < 2.0f)
+            return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+        return 0.0f;
+    }
+
+    static float sinc(float x)
+    {
+        if (Math::Abs(x) < 1e-4f)
+            return 1.0f;
+        x *= Math::PI;
+        return std::sin(x) / x;
+    }
+
+    static float lanczosFilter(float x)
+    {
+        return Math::Abs(x) < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+    }
+
+    /// Modified Bessel function of the first kind, order 0
+    static double bessel0(double x)
+    {
+        double sum = 1.0, term = 1.0, halfX = x * 0.5;
+        for (int k = 1; k < 32 && term > sum * 1e-12; ++k)
+        {
+            term *= (halfX / k) * (halfX / k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    static float kaiserFilter(float x)
+    {
+        // Sinc windowed by a Kaiser window, alpha 4, 3 pixels either side
+        static const double alpha = 4.0;
+        static const double scale = 1.0 / bessel0(alpha);
+        float t = x / 3.0f;
+        if (Math::Abs(t) >= 1.0f)
+            return 0.0f;
+        return sinc(x) * static_cast<float>(bessel0(alpha * std::sqrt(1.0 - t * t)) * scale);
+    }
+
+    static FilterKernel getFilterKernel(Image::Filter filter)
+    {
+        FilterKernel kernel;
+        kernel.widen = true;
+        switch (filter)
+        {
+        case Image::FILTER_BOX:
+            kernel.function = boxFilter;
+            kernel.support = 0.5f;
+            break;
+        case Image::FILTER_BICUBIC:
+            kernel.function = cubicFilter;
+            kernel.support = 2.0f;
+            break;
+        case Image::FILTER_KAISER:
+            kernel.function = kaiserFilter;
+            kernel.support = 3.0f;
+            break;
+        case Image::FILTER_LANCZOS:
+            kernel.function = lanczosFilter;
+            kernel.support = 3.0f;
+            break;
+        case Image::FILTER_LINEAR:
+        case Image::FILTER_BILINEAR:
+            // Interpolates between the nearest two pixels whatever the scale,
+            // as the other linear resamplers do
+            kernel.widen = false;
+            // fall through
+        default:
+            kernel.function = triangleFilter;
+            kernel.support = 1.0f;
+            break;
+        }
+        return kernel;
+    }
+
+    /** The weights of the source pixels for each destination pixel along one
+        axis.
+    */
+    struct AxisFilter
+    {
+        /// First source pixel of each destination pixel
+        vector<size_t>::type first;
+        /// Number of source pixels for each destination pixel
+        vector<size_t>::type count;
+        /// maxTaps weights for each destination pixel
+        vector<float>::type weights;
+        size_t maxTaps;
+
+        void build(size_t srcSize, size_t dstSize, const FilterKernel& kernel)
+        {
+            double ratio = static_cast<double>(srcSize) / dstSize;
+            double widen = (kernel.widen && ratio > 1.0) ? ratio : 1.0;
+            double radius = kernel.support * widen;
+            maxTaps = std::min(srcSize, static_cast<size_t>(radius * 2.0) + 2);
+            first.resize(dstSize);
+            count.resize(dstSize);
+            weights.assign(dstSize * maxTaps, 0.0f);
+
+            for (size_t i = 0; i < dstSize; ++i)
+            {
+                // Pixel centres are at whole source coordinates
+                double centre = (i + 0.5) * ratio - 0.5;
+                long lo = static_cast<long>(std::ceil(centre - radius));
+                long hi = static_cast<long>(std::floor(centre + radius));
+                long last = static_cast<long>(srcSize) - 1;
+                size_t start = static_cast<size_t>(std::min(std::max(lo, 0L), last));
+                size_t end = static_cast<size_t>(std::min(std::max(hi, 0L), last));
+                float* w = &weights[i * maxTaps];
+
+                // Pixels off the edge take the weight of the edge pixel
+                float total = 0.0f;
+                for (long j = lo; j <= hi; ++j)
+                {
+                    float f = kernel.function(static_cast<float>((j - centre) / widen));
+                    w[std::min(std::max(j, 0L), last) - start] += f;
+                    total += f;
+                }
+
+                size_t n = end - start + 1;
+                if (Math::Abs(total) < 1e-6f)
+                {
+                    // Nothing in reach, take the nearest pixel
+                    long nearest = static_cast<long>(std::floor(centre + 0.5));
+                    start = static_cast<size_t>(std::min(std::max(nearest, 0L), last));
+                    n = 1;
+                    w[0] = total = 1.0f;
+                }
+
+                // Drop the pixels at the ends which contribute nothing
+                size_t skip = 0;
+                while (n > 1 && Math::Abs(w[skip]) < 1e-6f * Math::Abs(total))
+                {
+                    ++skip;
+                    --n;
+                }
+                while (n > 1 && Math::Abs(w[skip + n - 1]) < 1e-6f * Math::Abs(total))
+                    --n;
+
+                for (size_t t = 0; t < n; ++t)
+                    w[t] = w[skip + t] / total;
+                for (size_t t = n; t < maxTaps; ++t)
+                    w[t] = 0.0f;
+                first[i] = start + skip;
+                count[i] = n;
+            }
+        }
+    };
+
+    //---------------------------------------------------------------------
+    // sRGB
+    //---------------------------------------------------------------------
+
+    static float srgbToLinear(float c)
+    {
+        if (c <= 0.04045f)
+            return c / 12.92f;
+        return std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static float linearToSrgb(float c)
+    {
+        if (c <= 0.0031308f)
+            return c * 12.92f;
+        return 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+
+    /// Entries in the table for encoding, which is interpolated
+    static const size_t SRGB_ENCODE_SIZE = 4096;
+
+    /** Tables for converting to and from sRGB, built when the library loads
+        so that they're ready before any thread needs them.
+    */
+    static struct SrgbTables
+    {
+        /// Linear value of each 8 bit sRGB value
+        float decode[256];
+        /// sRGB value of evenly spaced linear values, with one extra at the end
+        float encode[SRGB_ENCODE_SIZE + 1];
+
+        SrgbTables()
+        {
+            for (size_t i = 0; i < 256; ++i)
+                decode[i] = srgbToLinear(i / 255.0f);
+            for (size_t i = 0; i <= SRGB_ENCODE_SIZE; ++i)
+                encode[i] = linearToSrgb(static_cast<float>(i) / SRGB_ENCODE_SIZE);
+        }
+    } msSrgbTables;
+
+    /** Decode the colour channels of a row of FLOAT32_RGBA pixels.
+    @param fromBytes Whether the values came from 8 bit channels, so that the
+        table can be used
+    */
+    static void decodeSrgb(float* row, size_t count, bool fromBytes)
+    {
+        for (size_t i = 0; i < count; ++i, row += 4)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                if (fromBytes)
+                    row[c] = msSrgbTables.decode[static_cast<size_t>(row[c] * 255.0f + 0.5f)];
+                else
+                    row[c] = srgbToLinear(std::max(row[c], 0.0f));
+            }
+        }
+    }
+
+    /// Encode the colour channels of a row of FLOAT32_RGBA pixels
+    static void encodeSrgb(float* row, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i, row += 4)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                float v = row[c];
+                if (v <= 0.0f)
+                    row[c] = 0.0f;
+                else if (v >= 1.0f)
+                    row[c] = linearToSrgb(v);
+                else
+                {
+                    float pos = v * SRGB_ENCODE_SIZE;
+                    size_t index = static_cast<size_t>(pos);
+                    float frac = pos - index;
+                    row[c] = msSrgbTables.encode[index] +
+                        (msSrgbTables.encode[index + 1] - msSrgbTables.encode[index]) * frac;
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Row functions
+    //---------------------------------------------------------------------
+
+    /// Filter a row of FLOAT32_RGBA pixels along x
+    static void filterRowGeneral(const float* src, float* dst, const AxisFilter& axis,
+        size_t width)
+    {
+        for (size_t x = 0; x < width; ++x, dst += 4)
+        {
+            const float* w = &axis.weights[x * axis.maxTaps];
+            const float* s = src + axis.first[x] * 4;
+            float r = 0.0f, g = 0.0f, b = 0.0f, a = 0.0f;
+            for (size_t t = 0; t < axis.count[x]; ++t, s += 4)
+            {
+                r += w[t] * s[0];
+                g += w[t] * s[1];
+                b += w[t] * s[2];
+                a += w[t] * s[3];
+            }
+            dst[0] = r; dst[1] = g; dst[2] = b; dst[3] = a;
+        }
+    }
+
+    /// Add a row of values times a weight into another
+    static void accumulateRowGeneral(float* acc, const float* row, float weight, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+            acc[i] += row[i] * weight;
+    }
+
+#if __OGRE_HAVE_SSE
+    // A pixel is exactly one register, so the weights are splatted and the
+    // four channels summed together
+    static void filterRowSSE(const float* src, float* dst, const AxisFilter& axis,
+        size_t width)
+    {
+        for (size_t x = 0; x < width; ++x, dst += 4)
+        {
+            const float* w = &axis.weights[x * axis.maxTaps];
+            const float* s = src + axis.first[x] * 4;
+            __m128 sum = _mm_setzero_ps();
+            for (size_t t = 0; t < axis.count[x]; ++t, s += 4)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(w + t), _mm_loadu_ps(s)));
+            _mm_storeu_ps(dst, sum);
+        }
+    }
+
+    static void accumulateRowSSE(float* acc, const float* row, float weight, size_t count)
+    {
+        // count is always a whole number of pixels, so of registers
+        __m128 w = _mm_set1_ps(weight);
+        for (size_t i = 0; i < count; i += 4)
+            _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i),
+                _mm_mul_ps(w, _mm_loadu_ps(row + i))));
+    }
+#endif
+
+    //---------------------------------------------------------------------
+    /** Fills a band of the destination rows.
+    */
+    struct FilterBand : public ScaleBand
+    {
+        const PixelBox* src;
+        const PixelBox* dst;
+        const AxisFilter* xAxis;
+        const AxisFilter* yAxis;
+        const AxisFilter* zAxis;
+        bool gammaCorrect;
+        void (*filterRow)(const float*, float*, const AxisFilter&, size_t);
+        void (*accumulateRow)(float*, const float*, float, size_t);
+
+        const uchar* getSrcRow(size_t y, size_t z) const
+        {
+            return static_cast<const uchar*>(src->data) + PixelUtil::getNumElemBytes(src->format) *
+                (src->left + (src->top + y) * src->rowPitch + (src->front + z) * src->slicePitch);
+        }
+
+        uchar* getDstRow(size_t y, size_t z) const
+        {
+            return static_cast<uchar*>(dst->data) + PixelUtil::getNumElemBytes(dst->format) *
+                (dst->left + (dst->top + y) * dst->rowPitch + (dst->front + z) * dst->slicePitch);
+        }
+
+        void execute(void)
+        {
+            size_t srcWidth = src->getWidth(), srcHeight = src->getHeight();
+            size_t dstWidth = dst->getWidth();
+            size_t rowSize = dstWidth * 4;
+            // Source rows can be used straight from the box if they are
+            // FLOAT32_RGBA already, and need nothing doing to them
+            bool direct = src->format == PF_FLOAT32_RGBA && !gammaCorrect;
+            bool fromBytes = PixelUtil::getComponentType(src->format) == PCT_BYTE;
+
+            // A slot for each source row one destination row can need; rows
+            // of the same source slice go in the same run of yAxis->maxTaps
+            // slots, where consecutive rows can't collide
+            size_t numSlots = yAxis->maxTaps * zAxis->maxTaps;
+            vector<float>::type unpacked(direct ? 0 : srcWidth * 4);
+            vector<float>::type slots(numSlots * rowSize);
+            vector<size_t>::type slotRows(numSlots, ~(size_t)0);
+            vector<float>::type acc(rowSize);
+
+            for (size_t z = 0; z < dst->getDepth(); ++z)
+            {
+                const float* wz = &zAxis->weights[z * zAxis->maxTaps];
+                for (size_t y = firstRow; y < endRow; ++y)
+                {
+                    const float* wy = &yAxis->weights[y * yAxis->maxTaps];
+                    std::fill(acc.begin(), acc.end(), 0.0f);
+                    for (size_t tz = 0; tz < zAxis->count[z]; ++tz)
+                    {
+                        size_t sz = zAxis->first[z] + tz;
+                        for (size_t ty = 0; ty < yAxis->count[y]; ++ty)
+                        {
+                            size_t sy = yAxis->first[y] + ty;
+                            size_t slot = tz * yAxis->maxTaps + sy % yAxis->maxTaps;
+                            float* row = &slots[slot * rowSize];
+                            size_t rowIndex = sz * srcHeight + sy;
+                            if (slotRows[slot] != rowIndex)
+                            {
+                                const float* pixels;
+                                if (direct)
+                                {
+                                    pixels = reinterpret_cast<const float*>(getSrcRow(sy, sz));
+                                }
+                                else
+                                {
+                                    PixelUtil::bulkPixelConversion(
+                                        PixelBox(srcWidth, 1, 1, src->format,
+                                            const_cast<uchar*>(getSrcRow(sy, sz))),
+                                        PixelBox(srcWidth, 1, 1, PF_FLOAT32_RGBA, &unpacked[0]));
+                                    if (gammaCorrect)
+                                        decodeSrgb(&unpacked[0], srcWidth, fromBytes);
+                                    pixels = &unpacked[0];
+                                }
+                                filterRow(pixels, row, *xAxis, dstWidth);
+                                slotRows[slot] = rowIndex;
+                            }
+                            accumulateRow(&acc[0], row, wz[tz] * wy[ty], rowSize);
+                        }
+                    }
+
+                    if (gammaCorrect)
+                        encodeSrgb(&acc[0], dstWidth);
+                    PixelUtil::bulkPixelConversion(
+                        PixelBox(dstWidth, 1, 1, PF_FLOAT32_RGBA, &acc[0]),
+                        PixelBox(dstWidth, 1, 1, dst->format, getDstRow(y, z)));
+                }
+            }
+        }
+    };
+    //---------------------------------------------------------------------
+    void _filterScale(const PixelBox &src, const PixelBox &dst, Image::Filter filter,
+        bool gammaCorrect)
+    {
+        FilterKernel kernel = getFilterKernel(filter);
+        AxisFilter xAxis, yAxis, zAxis;
+        xAxis.build(src.getWidth(), dst.getWidth(), kernel);
+        yAxis.build(src.getHeight(), dst.getHeight(), kernel);
+        zAxis.build(src.getDepth(), dst.getDepth(), kernel);
+
+        FilterBand band;
+        band.src = &src;
+        band.dst = &dst;
+        band.xAxis = &xAxis;
+        band.yAxis = &yAxis;
+        band.zAxis = &zAxis;
+        band.gammaCorrect = gammaCorrect;
+        band.filterRow = filterRowGeneral;
+        band.accumulateRow = accumulateRowGeneral;
+#if __OGRE_HAVE_SSE
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+        {
+            band.filterRow = filterRowSSE;
+            band.accumulateRow = accumulateRowSSE;
+        }
+#endif
+        _runScaleBands(band, dst);
+    }
+
+}
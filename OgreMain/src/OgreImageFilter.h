@@ -0,0 +1,108 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+/** Internal include file -- do not use externally */
+#ifndef __ImageFilter_H__
+#define __ImageFilter_H__
+
+#include "OgreImage.h"
+#include "OgreRoot.h"
+#include "OgreParallelTaskGroup.h"
+
+namespace Ogre {
+
+    /** Scales a box of pixels with one of the separable filters (box,
+        triangle, bicubic, Kaiser or Lanczos; linear and bilinear are done as
+        a triangle which isn't widened when minifying).
+    @remarks
+        The pixels are filtered as FLOAT32_RGBA, so any accessible formats
+        can be used, and are converted on the way. If gammaCorrect is set the
+        colour channels are taken to be sRGB encoded, and are filtered in
+        linear space.
+    */
+    void _filterScale(const PixelBox &src, const PixelBox &dst, Image::Filter filter,
+        bool gammaCorrect);
+
+    /** A part of a job over the rows of an image, such as a scale, which
+        does rows [firstRow, endRow). A scale fills those rows of every
+        slice of the destination.
+    */
+    struct ScaleBand : public ParallelTaskGroup::Task
+    {
+        size_t firstRow;
+        size_t endRow;
+
+        ScaleBand() : firstRow(0), endRow(0) {}
+    };
+
+    /// Pixels below which a job isn't worth splitting up
+    const size_t SCALE_BAND_THRESHOLD = 256 * 256;
+
+    /** Run copies of a ScaleBand which between them do numRows rows, on the
+        shared task group from Root if there are numPixels or more in all and
+        the group is free, or else on this thread.
+    */
+    template<class Band> void _runRowBands(const Band& band, size_t numRows, size_t numPixels)
+    {
+        ParallelTaskGroup* group = 0;
+        if (numPixels >= SCALE_BAND_THRESHOLD && Root::getSingletonPtr())
+            group = Root::getSingleton()._acquireTaskGroup();
+        // A few bands per thread evens out the threads which start late
+        size_t numBands = group ? std::min(numRows, group->getMaxConcurrency() * 4) : 1;
+        if (numBands <= 1)
+        {
+            if (group)
+                Root::getSingleton()._releaseTaskGroup(group);
+            Band whole(band);
+            whole.firstRow = 0;
+            whole.endRow = numRows;
+            whole.execute();
+            return;
+        }
+
+        typename vector<Band>::type bands(numBands, band);
+        for (size_t i = 0; i < numBands; ++i)
+        {
+            bands[i].firstRow = numRows * i / numBands;
+            bands[i].endRow = numRows * (i + 1) / numBands;
+            group->addTask(&bands[i]);
+        }
+        group->run();
+        Root::getSingleton()._releaseTaskGroup(group);
+    }
+
+    /** Run copies of a ScaleBand which between them fill all the rows of
+        dst, in parallel if the image is large enough.
+    */
+    template<class Band> void _runScaleBands(const Band& band, const PixelBox &dst)
+    {
+        _runRowBands(band, dst.getHeight(), dst.getWidth() * dst.getHeight() * dst.getDepth());
+    }
+
+}
+
+#endif
@@ -47,12 +47,18 @@ namespace Ogre {
 // sx2 = upper-bound integer x-position in source
 // sxf = fractional weight beween sx1 and sx2
 // x,y,z = location of output pixel in destination
+//
+// each resampler writes rows [firstRow, endRow) of every slice of the
+// destination, so that bands of rows can be scaled on separate threads
 
 // nearest-neighbor resampler, does not convert formats.
 // templated on bytes-per-pixel to allow compiler optimizations, such
 // as simplifying memcpy() and replacing multiplies with bitshifts
 template<unsigned int elemsize> struct NearestResampler {
-	static void scale(const PixelBox& src, const PixelBox& dst) {
+	static void scale(const PixelBox& src, const PixelBox& dst,
+		size_t firstRow = 0, size_t endRow = ~(size_t)0) {
+		endRow = std::min(endRow, dst.getHeight());
+
 		// assert(src.format == dst.format);
 
 		// srcdata stays at beginning, pdst is a moving pointer
@@ -71,8 +77,10 @@ template<unsigned int elemsize> struct NearestResampler {
 		for (size_t z = dst.front; z < dst.back; z++, sz_48 += stepz) {
 			size_t srczoff = (size_t)(sz_48 >> 48) * src.slicePitch;
 			
-			uint64 sy_48 = (stepy >> 1) - 1;
-			for (size_t y = dst.top; y < dst.bottom; y++, sy_48 += stepy) {
+			pdst = (uchar*)dst.data +
+				elemsize*((z - dst.front)*dst.slicePitch + firstRow*dst.rowPitch);
+			uint64 sy_48 = (stepy >> 1) - 1 + stepy*firstRow;
+			for (size_t y = firstRow; y < endRow; y++, sy_48 += stepy) {
 				size_t srcyoff = (size_t)(sy_48 >> 48) * src.rowPitch;
 			
 				uint64 sx_48 = (stepx >> 1) - 1;
@@ -84,7 +92,6 @@ template<unsigned int elemsize> struct NearestResampler {
 				}
 				pdst += elemsize*dst.getRowSkip();
 			}
-			pdst += elemsize*dst.getSliceSkip();
 		}
 	}
 };
@@ -92,7 +99,10 @@ template<unsigned int elemsize> struct NearestResampler {
 
 // default floating-point linear resampler, does format conversion
 struct LinearResampler {
-	static void scale(const PixelBox& src, const PixelBox& dst) {
+	static void scale(const PixelBox& src, const PixelBox& dst,
+		size_t firstRow = 0, size_t endRow = ~(size_t)0) {
+		endRow = std::min(endRow, dst.getHeight());
+
 		size_t srcelemsize = PixelUtil::getNumElemBytes(src.format);
 		size_t dstelemsize = PixelUtil::getNumElemBytes(dst.format);
 
@@ -122,8 +132,10 @@ struct LinearResampler {
 			size_t sz2 = std::min(sz1+1,src.getDepth()-1);// src z, sample #2
 			float szf = (temp & 0xFFFF) / 65536.f; // weight of sample #2
 
-			uint64 sy_48 = (stepy >> 1) - 1;
-			for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+			pdst = (uchar*)dst.data +
+				dstelemsize*((z - dst.front)*dst.slicePitch + firstRow*dst.rowPitch);
+			uint64 sy_48 = (stepy >> 1) - 1 + stepy*firstRow;
+			for (size_t y = firstRow; y < endRow; y++, sy_48+=stepy) {
 				temp = static_cast<unsigned int>(sy_48 >> 32);
 				temp = (temp > 0x8000)? temp - 0x8000 : 0;
 				size_t sy1 = temp >> 16;					// src y #1
@@ -166,7 +178,6 @@ struct LinearResampler {
 				}
 				pdst += dstelemsize*dst.getRowSkip();
 			}
-			pdst += dstelemsize*dst.getSliceSkip();
 		}
 	}
 };
@@ -175,7 +186,10 @@ struct LinearResampler {
 // float32 linear resampler, converts FLOAT32_RGB/FLOAT32_RGBA only.
 // avoids overhead of pixel unpack/repack function calls
 struct LinearResampler_Float32 {
-	static void scale(const PixelBox& src, const PixelBox& dst) {
+	static void scale(const PixelBox& src, const PixelBox& dst,
+		size_t firstRow = 0, size_t endRow = ~(size_t)0) {
+		endRow = std::min(endRow, dst.getHeight());
+
 		size_t srcchannels = PixelUtil::getNumElemBytes(src.format) / sizeof(float);
 		size_t dstchannels = PixelUtil::getNumElemBytes(dst.format) / sizeof(float);
 		// assert(srcchannels == 3 || srcchannels == 4);
@@ -207,8 +221,10 @@ struct LinearResampler_Float32 {
 			size_t sz2 = std::min(sz1+1,src.getDepth()-1);// src z, sample #2
 			float szf = (temp & 0xFFFF) / 65536.f; // weight of sample #2
 
-			uint64 sy_48 = (stepy >> 1) - 1;
-			for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+			pdst = (float*)dst.data +
+				dstchannels*((z - dst.front)*dst.slicePitch + firstRow*dst.rowPitch);
+			uint64 sy_48 = (stepy >> 1) - 1 + stepy*firstRow;
+			for (size_t y = firstRow; y < endRow; y++, sy_48+=stepy) {
 				temp = static_cast<unsigned int>(sy_48 >> 32);
 				temp = (temp > 0x8000)? temp - 0x8000 : 0;
 				size_t sy1 = temp >> 16;					// src y #1
@@ -270,7 +286,6 @@ struct LinearResampler_Float32 {
 				}
 				pdst += dstchannels*dst.getRowSkip();
 			}
-			pdst += dstchannels*dst.getSliceSkip();
 		}
 	}
 };
@@ -283,18 +298,21 @@ struct LinearResampler_Float32 {
 // templated on bytes-per-pixel to allow compiler optimizations, such
 // as unrolling loops and replacing multiplies with bitshifts
 template<unsigned int channels> struct LinearResampler_Byte {
-	static void scale(const PixelBox& src, const PixelBox& dst) {
+	static void scale(const PixelBox& src, const PixelBox& dst,
+		size_t firstRow = 0, size_t endRow = ~(size_t)0) {
+		endRow = std::min(endRow, dst.getHeight());
+
 		// assert(src.format == dst.format);
 
 		// only optimized for 2D
 		if (src.getDepth() > 1 || dst.getDepth() > 1) {
-			LinearResampler::scale(src, dst);
+			LinearResampler::scale(src, dst, firstRow, endRow);
 			return;
 		}
 
 		// srcdata stays at beginning of slice, pdst is a moving pointer
 		uchar* srcdata = (uchar*)src.data;
-		uchar* pdst = (uchar*)dst.data;
+		uchar* pdst = (uchar*)dst.data + channels*firstRow*dst.rowPitch;
 
 		// sx_48,sy_48 represent current position in source
 		// using 16/48-bit fixed precision, incremented by steps
@@ -307,8 +325,8 @@ template<unsigned int channels> struct LinearResampler_Byte {
 		// fractional bits are the blend weight of the second sample
 		unsigned int temp;
 		
-		uint64 sy_48 = (stepy >> 1) - 1;
-		for (size_t y = dst.top; y < dst.bottom; y++, sy_48+=stepy) {
+		uint64 sy_48 = (stepy >> 1) - 1 + stepy*firstRow;
+		for (size_t y = firstRow; y < endRow; y++, sy_48+=stepy) {
 			temp = static_cast<unsigned int>(sy_48 >> 36);
 			temp = (temp > 0x800)? temp - 0x800: 0;
 			unsigned int syf = temp & 0xFFF;
@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "OgreAnimationState.h"
 #include "OgreAnimationTrack.h"
 #include "OgreOptimisedUtil.h"
+#include "OgreSoftwareAnimationBatch.h"
 #include "OgreTangentSpaceCalc.h"
 #include "OgreLodStrategyManager.h"
 
@@ -268,8 +269,9 @@ namespace Ogre {
             ResourceGroupManager::getSingleton().openResource(
 				mName, mGroup, true, this);
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM (a mapped file is shared, not copied)
+        mFreshFromDisk = DataStreamPtr(
+            OGRE_NEW MemoryDataStream(mName, mFreshFromDisk, true, true));
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -1644,10 +1646,18 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    // Locks a buffer for software animation; when a batch is supplied the
+    // lock is shared with the batch and released when it is executed
+    static void* lockForAnimation(const HardwareVertexBufferSharedPtr& buf,
+        HardwareBuffer::LockOptions options, SoftwareAnimationBatch* batch)
+    {
+        return batch ? batch->lockBuffer(buf, options) : buf->lock(options);
+    }
+    //---------------------------------------------------------------------
     void Mesh::softwareVertexBlend(const VertexData* sourceVertexData,
         const VertexData* targetVertexData,
         const Matrix4* const* blendMatrices, size_t numMatrices,
-        bool blendNormals)
+        bool blendNormals, SoftwareAnimationBatch* batch)
     {
         float *pSrcPos = 0;
         float *pSrcNorm = 0;
@@ -1713,14 +1723,14 @@ namespace Ogre {
         void* pBuffer;
 
         // Lock source buffers for reading
-        pBuffer = srcPosBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+        pBuffer = lockForAnimation(srcPosBuf, HardwareBuffer::HBL_READ_ONLY, batch);
         srcElemPos->baseVertexPointerToElement(pBuffer, &pSrcPos);
         if (includeNormals)
         {
             if (srcNormBuf != srcPosBuf)
             {
                 // Different buffer
-                pBuffer = srcNormBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+                pBuffer = lockForAnimation(srcNormBuf, HardwareBuffer::HBL_READ_ONLY, batch);
             }
             srcElemNorm->baseVertexPointerToElement(pBuffer, &pSrcNorm);
         }
@@ -1728,12 +1738,12 @@ namespace Ogre {
         // Indices must be 4 bytes
         assert(srcElemBlendIndices->getType() == VET_UBYTE4 &&
                "Blend indices must be VET_UBYTE4");
-        pBuffer = srcIdxBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+        pBuffer = lockForAnimation(srcIdxBuf, HardwareBuffer::HBL_READ_ONLY, batch);
         srcElemBlendIndices->baseVertexPointerToElement(pBuffer, &pBlendIdx);
         if (srcWeightBuf != srcIdxBuf)
         {
             // Lock buffer
-            pBuffer = srcWeightBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+            pBuffer = lockForAnimation(srcWeightBuf, HardwareBuffer::HBL_READ_ONLY, batch);
         }
         srcElemBlendWeights->baseVertexPointerToElement(pBuffer, &pBlendWeight);
         unsigned short numWeightsPerVertex =
@@ -1741,22 +1751,38 @@ namespace Ogre {
 
 
         // Lock destination buffers for writing
-        pBuffer = destPosBuf->lock(
+        pBuffer = lockForAnimation(destPosBuf,
             (destNormBuf != destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize()) ||
             (destNormBuf == destPosBuf && destPosBuf->getVertexSize() == destElemPos->getSize() + destElemNorm->getSize()) ?
-            HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
+            HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL, batch);
         destElemPos->baseVertexPointerToElement(pBuffer, &pDestPos);
         if (includeNormals)
         {
             if (destNormBuf != destPosBuf)
             {
-                pBuffer = destNormBuf->lock(
+                pBuffer = lockForAnimation(destNormBuf,
                     destNormBuf->getVertexSize() == destElemNorm->getSize() ?
-                    HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL);
+                    HardwareBuffer::HBL_DISCARD : HardwareBuffer::HBL_NORMAL, batch);
             }
             destElemNorm->baseVertexPointerToElement(pBuffer, &pDestNorm);
         }
 
+        if (batch)
+        {
+            // Buffers stay locked until the batch is executed
+            batch->addSkinning(
+                pSrcPos, pDestPos,
+                pSrcNorm, pDestNorm,
+                pBlendWeight, pBlendIdx,
+                blendMatrices, numMatrices,
+                srcPosStride, destPosStride,
+                srcNormStride, destNormStride,
+                blendWeightStride, blendIdxStride,
+                numWeightsPerVertex,
+                targetVertexData->vertexCount);
+            return;
+        }
+
         OptimisedUtil::getImplementation()->softwareVertexSkinning(
             pSrcPos, pDestPos,
             pSrcNorm, pDestNorm,
@@ -1791,13 +1817,15 @@ namespace Ogre {
 	void Mesh::softwareVertexMorph(Real t,
 		const HardwareVertexBufferSharedPtr& b1,
 		const HardwareVertexBufferSharedPtr& b2,
-		VertexData* targetVertexData)
+		VertexData* targetVertexData, SoftwareAnimationBatch* batch)
 	{
-		float* pb1 = static_cast<float*>(b1->lock(HardwareBuffer::HBL_READ_ONLY));
+		float* pb1 = static_cast<float*>(
+			lockForAnimation(b1, HardwareBuffer::HBL_READ_ONLY, batch));
 		float* pb2;
 		if (b1.get() != b2.get())
 		{
-			pb2 = static_cast<float*>(b2->lock(HardwareBuffer::HBL_READ_ONLY));
+			pb2 = static_cast<float*>(
+				lockForAnimation(b2, HardwareBuffer::HBL_READ_ONLY, batch));
 		}
 		else
 		{
@@ -1816,7 +1844,14 @@ namespace Ogre {
 		assert(posElem->getSize() == destBuf->getVertexSize() &&
 			"Positions must be in a buffer on their own for morphing");
 		float* pdst = static_cast<float*>(
-			destBuf->lock(HardwareBuffer::HBL_DISCARD));
+			lockForAnimation(destBuf, HardwareBuffer::HBL_DISCARD, batch));
+
+		if (batch)
+		{
+			// Buffers stay locked until the batch is executed
+			batch->addMorph(t, pb1, pb2, pdst, targetVertexData->vertexCount);
+			return;
+		}
 
         OptimisedUtil::getImplementation()->softwareVertexMorph(
             t, pb1, pb2, pdst,
@@ -1830,7 +1865,7 @@ namespace Ogre {
 	//---------------------------------------------------------------------
 	void Mesh::softwareVertexPoseBlend(Real weight,
 		const map<size_t, Vector3>::type& vertexOffsetMap,
-		VertexData* targetVertexData)
+		VertexData* targetVertexData, SoftwareAnimationBatch* batch)
 	{
 		// Do nothing if no weight
 		if (weight == 0.0f)
@@ -1847,7 +1882,14 @@ namespace Ogre {
 
 		// Have to lock in normal mode since this is incremental
 		float* pBase = static_cast<float*>(
-			destBuf->lock(HardwareBuffer::HBL_NORMAL));
+			lockForAnimation(destBuf, HardwareBuffer::HBL_NORMAL, batch));
+
+		if (batch)
+		{
+			// Buffer stays locked until the batch is executed
+			batch->addPoseBlend(weight, &vertexOffsetMap, pBase);
+			return;
+		}
 
 		// Iterate over affected vertices
 		for (map<size_t, Vector3>::type::const_iterator i = vertexOffsetMap.begin();
@@ -1119,14 +1119,7 @@ namespace Ogre {
     void MeshSerializerImpl::readMeshBoneAssignment(DataStreamPtr& stream, Mesh* pMesh)
     {
         VertexBoneAssignment assign;
-
-        // unsigned int vertexIndex;
-        readInts(stream, &(assign.vertexIndex),1);
-        // unsigned short boneIndex;
-        readShorts(stream, &(assign.boneIndex),1);
-        // float weight;
-        readFloats(stream, &(assign.weight), 1);
-
+        readBoneAssignment(stream, assign);
         pMesh->addBoneAssignment(assign);
 
     }
@@ -1135,16 +1128,33 @@ namespace Ogre {
         Mesh* pMesh, SubMesh* sub)
     {
         VertexBoneAssignment assign;
+        readBoneAssignment(stream, assign);
+        sub->addBoneAssignment(assign);
+
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readBoneAssignment(DataStreamPtr& stream, 
+        VertexBoneAssignment& assign)
+    {
+        // There's one chunk per assignment, so avoid a read per field
+        unsigned char data[sizeof(uint32) + sizeof(uint16) + sizeof(float)];
+        stream->read(data, sizeof(data));
 
         // unsigned int vertexIndex;
-        readInts(stream, &(assign.vertexIndex),1);
+        uint32 vertexIndex;
+        memcpy(&vertexIndex, data, sizeof(uint32));
+        Serializer::flipFromLittleEndian(&vertexIndex, sizeof(uint32));
+        assign.vertexIndex = vertexIndex;
         // unsigned short boneIndex;
-        readShorts(stream, &(assign.boneIndex),1);
+        uint16 boneIndex;
+        memcpy(&boneIndex, data + sizeof(uint32), sizeof(uint16));
+        Serializer::flipFromLittleEndian(&boneIndex, sizeof(uint16));
+        assign.boneIndex = boneIndex;
         // float weight;
-        readFloats(stream, &(assign.weight), 1);
-
-        sub->addBoneAssignment(assign);
-
+        float weight;
+        memcpy(&weight, data + sizeof(uint32) + sizeof(uint16), sizeof(float));
+        Serializer::flipFromLittleEndian(&weight, sizeof(float));
+        assign.weight = weight;
     }
     //---------------------------------------------------------------------
     size_t MeshSerializerImpl::calcBoneAssignmentSize(void)
@@ -1524,49 +1534,82 @@ namespace Ogre {
 	        flipEndian(pData, vertexCount, vertexSize, elems);
 		}
 	}
+    //---------------------------------------------------------------------
+	namespace
+	{
+		/// Words of one vertex element to flip, see MeshSerializerImpl::flipEndian
+		struct VertexElementSwap
+		{
+			size_t offset;
+			size_t typeSize;
+			size_t count;
+		};
+	}
     //---------------------------------------------------------------------
     void MeshSerializerImpl::flipEndian(void* pData, size_t vertexCount,
         size_t vertexSize, const VertexDeclaration::VertexElementList& elems)
 	{
-		void *pBase = pData;
-		for (size_t v = 0; v < vertexCount; ++v)
+		// Work out the word size of each element once rather than per vertex
+		vector<VertexElementSwap>::type swaps;
+		swaps.reserve(elems.size());
+		size_t swappedSize = 0, commonTypeSize = 0;
+		bool sameTypeSize = true;
+		VertexDeclaration::VertexElementList::const_iterator ei, eiend;
+		eiend = elems.end();
+		for (ei = elems.begin(); ei != eiend; ++ei)
 		{
-			VertexDeclaration::VertexElementList::const_iterator ei, eiend;
-			eiend = elems.end();
-			for (ei = elems.begin(); ei != eiend; ++ei)
+			// Flip the endian based on the type
+			size_t typeSize = 0;
+			switch (VertexElement::getBaseType((*ei).getType()))
 			{
-				void *pElem;
-				// re-base pointer to the element
-				(*ei).baseVertexPointerToElement(pBase, &pElem);
-				// Flip the endian based on the type
-				size_t typeSize = 0;
-				switch (VertexElement::getBaseType((*ei).getType()))
-				{
-					case VET_FLOAT1:
-						typeSize = sizeof(float);
-						break;
-					case VET_SHORT1:
-						typeSize = sizeof(short);
-						break;
-					case VET_COLOUR:
-					case VET_COLOUR_ABGR:
-					case VET_COLOUR_ARGB:
-						typeSize = sizeof(RGBA);
-						break;
-					case VET_UBYTE4:
-						typeSize = 0; // NO FLIPPING
-						break;
-					default:
-						assert(false); // Should never happen
-				};
-                Serializer::flipEndian(pElem, typeSize,
-					VertexElement::getTypeCount((*ei).getType()));
-
+				case VET_FLOAT1:
+					typeSize = sizeof(float);
+					break;
+				case VET_SHORT1:
+					typeSize = sizeof(short);
+					break;
+				case VET_COLOUR:
+				case VET_COLOUR_ABGR:
+				case VET_COLOUR_ARGB:
+					typeSize = sizeof(RGBA);
+					break;
+				case VET_UBYTE4:
+					typeSize = 0; // NO FLIPPING
+					break;
+				default:
+					assert(false); // Should never happen
+			};
+			if (!typeSize)
+			{
+				sameTypeSize = false;
+				continue;
 			}
+			if (commonTypeSize && typeSize != commonTypeSize)
+				sameTypeSize = false;
+			commonTypeSize = typeSize;
+
+			VertexElementSwap swap;
+			swap.offset = (*ei).getOffset();
+			swap.typeSize = typeSize;
+			swap.count = VertexElement::getTypeCount((*ei).getType());
+			swappedSize += typeSize * swap.count;
+			swaps.push_back(swap);
+		}
 
-			pBase = static_cast<void*>(
-				static_cast<unsigned char*>(pBase) + vertexSize);
+		if (sameTypeSize && swappedSize == vertexSize)
+		{
+			// Every byte of the buffer is part of a word of the same size, 
+			// so flip it all in one go
+			Serializer::flipEndian(pData, commonTypeSize, vertexCount * vertexSize / commonTypeSize);
+			return;
+		}
 
+		unsigned char* pBase = static_cast<unsigned char*>(pData);
+		size_t numSwaps = swaps.size();
+		for (size_t v = 0; v < vertexCount; ++v, pBase += vertexSize)
+		{
+			for (size_t i = 0; i < numSwaps; ++i)
+				Serializer::flipEndian(pBase + swaps[i].offset, swaps[i].typeSize, swaps[i].count);
 		}
 	}
     //---------------------------------------------------------------------
@@ -1845,30 +1888,37 @@ namespace Ogre {
         // Allocate correct amount of memory
         edgeData->edgeGroups.resize(numEdgeGroups);
         // Triangle* triangleList
-        uint32 tmp[3];
-        for (size_t t = 0; t < numTriangles; ++t)
+        // Each triangle is 12 4-byte words, read them a block at a time
+        const size_t triWords = 12, trisPerBlock = 256;
+        uint32 triBlock[triWords * trisPerBlock];
+        for (uint32 first = 0; first < numTriangles; first += trisPerBlock)
         {
-            EdgeData::Triangle& tri = edgeData->triangles[t];
-            // unsigned long indexSet
-            readInts(stream, tmp, 1);
-            tri.indexSet = tmp[0];
-            // unsigned long vertexSet
-            readInts(stream, tmp, 1);
-            tri.vertexSet = tmp[0];
-            // unsigned long vertIndex[3]
-            readInts(stream, tmp, 3);
-            tri.vertIndex[0] = tmp[0];
-            tri.vertIndex[1] = tmp[1];
-            tri.vertIndex[2] = tmp[2];
-            // unsigned long sharedVertIndex[3]
-            readInts(stream, tmp, 3);
-            tri.sharedVertIndex[0] = tmp[0];
-            tri.sharedVertIndex[1] = tmp[1];
-            tri.sharedVertIndex[2] = tmp[2];
-            // float normal[4]
-            readFloats(stream, &(edgeData->triangleFaceNormals[t].x), 4);
-
+            uint32 numInBlock = std::min((uint32)trisPerBlock, numTriangles - first);
+            readInts(stream, triBlock, numInBlock * triWords);
+            const uint32* tmp = triBlock;
+            for (uint32 t = first; t < first + numInBlock; ++t, tmp += triWords)
+            {
+                EdgeData::Triangle& tri = edgeData->triangles[t];
+                // unsigned long indexSet
+                tri.indexSet = tmp[0];
+                // unsigned long vertexSet
+                tri.vertexSet = tmp[1];
+                // unsigned long vertIndex[3]
+                tri.vertIndex[0] = tmp[2];
+                tri.vertIndex[1] = tmp[3];
+                tri.vertIndex[2] = tmp[4];
+                // unsigned long sharedVertIndex[3]
+                tri.sharedVertIndex[0] = tmp[5];
+                tri.sharedVertIndex[1] = tmp[6];
+                tri.sharedVertIndex[2] = tmp[7];
+                // float normal[4]
+                float normal[4];
+                memcpy(normal, tmp + 8, sizeof(normal));
+                edgeData->triangleFaceNormals[t] = 
+                    Vector4(normal[0], normal[1], normal[2], normal[3]);
+            }
         }
+        uint32 tmp[3];
 
         for (uint32 eg = 0; eg < numEdgeGroups; ++eg)
         {
@@ -1895,23 +1945,33 @@ namespace Ogre {
             readInts(stream, &numEdges, 1);
             edgeGroup.edges.resize(numEdges);
             // Edge* edgeList
-            for (uint32 e = 0; e < numEdges; ++e)
+            // Each edge is 6 4-byte words and a 1-byte bool, unaligned in
+            // the file, so read a block at a time and pick the fields out
+            const size_t edgeBytes = sizeof(uint32) * 6 + 1, edgesPerBlock = 256;
+            unsigned char edgeBlock[edgeBytes * edgesPerBlock];
+            for (uint32 first = 0; first < numEdges; first += edgesPerBlock)
             {
-                EdgeData::Edge& edge = edgeGroup.edges[e];
-                // unsigned long  triIndex[2]
-                readInts(stream, tmp, 2);
-                edge.triIndex[0] = tmp[0];
-                edge.triIndex[1] = tmp[1];
-                // unsigned long  vertIndex[2]
-                readInts(stream, tmp, 2);
-                edge.vertIndex[0] = tmp[0];
-                edge.vertIndex[1] = tmp[1];
-                // unsigned long  sharedVertIndex[2]
-                readInts(stream, tmp, 2);
-                edge.sharedVertIndex[0] = tmp[0];
-                edge.sharedVertIndex[1] = tmp[1];
-                // bool degenerate
-                readBools(stream, &(edge.degenerate), 1);
+                uint32 numInBlock = std::min((uint32)edgesPerBlock, numEdges - first);
+                stream->read(edgeBlock, numInBlock * edgeBytes);
+                const unsigned char* pEdge = edgeBlock;
+                for (uint32 e = first; e < first + numInBlock; ++e, pEdge += edgeBytes)
+                {
+                    EdgeData::Edge& edge = edgeGroup.edges[e];
+                    uint32 words[6];
+                    memcpy(words, pEdge, sizeof(words));
+                    Serializer::flipFromLittleEndian(words, sizeof(uint32), 6);
+                    // unsigned long  triIndex[2]
+                    edge.triIndex[0] = words[0];
+                    edge.triIndex[1] = words[1];
+                    // unsigned long  vertIndex[2]
+                    edge.vertIndex[0] = words[2];
+                    edge.vertIndex[1] = words[3];
+                    // unsigned long  sharedVertIndex[2]
+                    edge.sharedVertIndex[0] = words[4];
+                    edge.sharedVertIndex[1] = words[5];
+                    // bool degenerate
+                    edge.degenerate = pEdge[sizeof(words)] != 0;
+                }
             }
         }
     }
@@ -2248,15 +2308,18 @@ namespace Ogre {
 				switch(streamID)
 				{
 				case M_POSE_VERTEX:
-					// create vertex offset
-					uint32 vertIndex;
-					Vector3 offset;
-					// unsigned long vertexIndex
-					readInts(stream, &vertIndex, 1);
-					// float xoffset, yoffset, zoffset
-					readFloats(stream, offset.ptr(), 3);
-
-					pose->addVertex(vertIndex, offset);
+					{
+						// create vertex offset
+						// unsigned long vertexIndex
+						// float xoffset, yoffset, zoffset
+						// all 4 byte words, so read and flip them together
+						uint32 data[4];
+						readInts(stream, data, 4);
+						float offset[3];
+						memcpy(offset, data + 1, sizeof(offset));
+
+						pose->addVertex(data[0], Vector3(offset[0], offset[1], offset[2]));
+					}
 					break;
 
 				}
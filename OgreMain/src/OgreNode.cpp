@@ -224,6 +224,54 @@ namespace Ogre {
 
         mNeedChildUpdate = false;
 
+    }
+    //-----------------------------------------------------------------------
+    void Node::_updateSelf(bool parentHasChanged, PendingChildUpdateList& childUpdates)
+    {
+		// Mirrors _update(true, parentHasChanged) but defers the children
+		mParentNotified = false ;
+
+        if (mNeedParentUpdate || parentHasChanged)
+        {
+            _updateFromParent();
+		}
+
+		if (mNeedChildUpdate || parentHasChanged)
+		{
+            ChildNodeMap::iterator it, itend;
+			itend = mChildren.end();
+            for (it = mChildren.begin(); it != itend; ++it)
+            {
+                childUpdates.push_back(std::make_pair(it->second, true));
+            }
+        }
+        else
+        {
+            ChildUpdateSet::iterator it, itend;
+			itend = mChildrenToUpdate.end();
+            for(it = mChildrenToUpdate.begin(); it != itend; ++it)
+            {
+                childUpdates.push_back(std::make_pair(*it, false));
+            }
+        }
+        mChildrenToUpdate.clear();
+
+        mNeedChildUpdate = false;
+    }
+    //-----------------------------------------------------------------------
+    void Node::_setDerivedTransform(const Quaternion& orientation,
+        const Vector3& position, const Vector3& scale)
+    {
+        mDerivedOrientation = orientation;
+        mDerivedPosition = position;
+        mDerivedScale = scale;
+		mCachedTransformOutOfDate = true;
+		mNeedParentUpdate = false;
+
+		if (mListener)
+		{
+			mListener->nodeUpdated(this);
+		}
     }
 	//-----------------------------------------------------------------------
 	void Node::_updateFromParent(void) const
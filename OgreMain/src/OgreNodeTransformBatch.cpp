@@ -0,0 +1,355 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreNodeTransformBatch.h"
+#include "OgreNode.h"
+
+namespace Ogre
+{
+	const size_t NodeTransformBatch::NO_PARENT = ~static_cast<size_t>(0);
+	//---------------------------------------------------------------------
+	NodeTransformBatch::NodeTransformBatch(Node* root)
+		: mRoot(root)
+		, mLayoutOutOfDate(true)
+		, mNumNodes(0)
+		, mCapacity(0)
+		, mStorage(0)
+	{
+		memset(&mLocal, 0, sizeof(mLocal));
+		memset(&mDerived, 0, sizeof(mDerived));
+		memset(&mParentScratch, 0, sizeof(mParentScratch));
+	}
+	//---------------------------------------------------------------------
+	NodeTransformBatch::~NodeTransformBatch()
+	{
+		if (mStorage)
+			OGRE_FREE_SIMD(mStorage, MEMCATEGORY_SCENE_CONTROL);
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::update(void)
+	{
+		bool forceAll = mLayoutOutOfDate;
+		if (mLayoutOutOfDate)
+		{
+			buildLayout();
+			mLayoutOutOfDate = false;
+		}
+
+		if (gatherChanges(forceAll))
+		{
+			// The root has no parent, so its derived transform is its local one
+			if (mSelfDirty[0])
+			{
+				for (size_t c = 0; c < 4; ++c)
+					mDerived.orientation[c][0] = mLocal.orientation[c][0];
+				for (size_t c = 0; c < 3; ++c)
+				{
+					mDerived.position[c][0] = mLocal.position[c][0];
+					mDerived.scale[c][0] = mLocal.scale[c][0];
+				}
+			}
+
+			for (size_t l = 1; l < mLevels.size(); ++l)
+			{
+				const Level& level = mLevels[l];
+				for (size_t slot = level.start; slot < level.start + level.count; ++slot)
+				{
+					if (mSelfDirty[slot])
+					{
+						updateLevel(level);
+						break;
+					}
+				}
+			}
+		}
+
+		scatterChanges();
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::buildLayout(void)
+	{
+		mNodes.clear();
+		mParents.clear();
+		mLevels.clear();
+		mNumNodes = 0;
+
+		NodeList current, next;
+		IndexList currentParents, nextParents;
+		current.push_back(mRoot);
+		currentParents.push_back(NO_PARENT);
+
+		while (!current.empty())
+		{
+			Level level;
+			level.start = mNodes.size();
+			level.count = current.size();
+			mLevels.push_back(level);
+			mNumNodes += level.count;
+
+			mNodes.insert(mNodes.end(), current.begin(), current.end());
+			mParents.insert(mParents.end(), currentParents.begin(), currentParents.end());
+			// Pad the level so that the next one starts on a SIMD boundary
+			while (mNodes.size() % BLOCK_SIZE)
+			{
+				mNodes.push_back(0);
+				mParents.push_back(NO_PARENT);
+			}
+
+			next.clear();
+			nextParents.clear();
+			for (size_t i = 0; i < current.size(); ++i)
+			{
+				Node::ChildNodeIterator it = current[i]->getChildIterator();
+				while (it.hasMoreElements())
+				{
+					next.push_back(it.getNext());
+					nextParents.push_back(level.start + i);
+				}
+			}
+			current.swap(next);
+			currentParents.swap(nextParents);
+		}
+
+		size_t numSlots = mNodes.size();
+		reserveStorage(numSlots);
+
+		// Padding slots take part in the calculations, keep them sane
+		for (size_t slot = 0; slot < numSlots; ++slot)
+		{
+			if (!mNodes[slot])
+			{
+				setIdentity(mLocal, slot);
+				setIdentity(mDerived, slot);
+			}
+		}
+
+		mSelfDirty.assign(numSlots, 0);
+		mChildrenDirty.assign(numSlots, 0);
+		mVisited.assign(numSlots, 0);
+		mInheritOrientation.assign(numSlots, 1);
+		mInheritScale.assign(numSlots, 1);
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::reserveStorage(size_t capacity)
+	{
+		if (capacity <= mCapacity)
+			return;
+
+		if (mStorage)
+			OGRE_FREE_SIMD(mStorage, MEMCATEGORY_SCENE_CONTROL);
+
+		// Grow in blocks so that every component array stays SIMD aligned
+		mCapacity = (capacity + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+		mStorage = static_cast<Real*>(OGRE_MALLOC_SIMD(
+			sizeof(Real) * NUM_COMPONENTS * 3 * mCapacity, MEMCATEGORY_SCENE_CONTROL));
+
+		OptimisedUtil::TransformSoA* sets[3] = { &mLocal, &mDerived, &mParentScratch };
+		Real* p = mStorage;
+		for (size_t s = 0; s < 3; ++s)
+		{
+			for (size_t c = 0; c < 4; ++c, p += mCapacity)
+				sets[s]->orientation[c] = p;
+			for (size_t c = 0; c < 3; ++c, p += mCapacity)
+				sets[s]->position[c] = p;
+			for (size_t c = 0; c < 3; ++c, p += mCapacity)
+				sets[s]->scale[c] = p;
+		}
+
+		for (size_t slot = 0; slot < mCapacity; ++slot)
+			setIdentity(mParentScratch, slot);
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::setIdentity(const OptimisedUtil::TransformSoA& soa, size_t slot)
+	{
+		soa.orientation[0][slot] = 1;
+		soa.orientation[1][slot] = 0;
+		soa.orientation[2][slot] = 0;
+		soa.orientation[3][slot] = 0;
+		for (size_t c = 0; c < 3; ++c)
+		{
+			soa.position[c][slot] = 0;
+			soa.scale[c][slot] = 1;
+		}
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::gatherLocal(const Node* node, size_t slot)
+	{
+		const Quaternion& q = node->getOrientation();
+		const Vector3& p = node->getPosition();
+		const Vector3& s = node->getScale();
+		mLocal.orientation[0][slot] = q.w;
+		mLocal.orientation[1][slot] = q.x;
+		mLocal.orientation[2][slot] = q.y;
+		mLocal.orientation[3][slot] = q.z;
+		for (size_t c = 0; c < 3; ++c)
+		{
+			mLocal.position[c][slot] = p[c];
+			mLocal.scale[c][slot] = s[c];
+		}
+		mInheritOrientation[slot] = node->getInheritOrientation();
+		mInheritScale[slot] = node->getInheritScale();
+	}
+	//---------------------------------------------------------------------
+	bool NodeTransformBatch::gatherChanges(bool forceAll)
+	{
+		bool anyDirty = false;
+		size_t numSlots = mNodes.size();
+
+		// Same rules as Node::_update; parents always come before children
+		for (size_t slot = 0; slot < numSlots; ++slot)
+		{
+			const Node* node = mNodes[slot];
+			if (!node)
+				continue;
+
+			size_t parent = mParents[slot];
+			bool parentHasChanged = parent != NO_PARENT && mChildrenDirty[parent];
+			bool selfDirty = forceAll || node->mNeedParentUpdate || parentHasChanged;
+			mSelfDirty[slot] = selfDirty;
+			mChildrenDirty[slot] = selfDirty || node->mNeedChildUpdate;
+			mVisited[slot] = selfDirty || node->mNeedChildUpdate || 
+				!node->mChildrenToUpdate.empty();
+
+			if (selfDirty)
+			{
+				gatherLocal(node, slot);
+				anyDirty = true;
+			}
+		}
+
+		// Anything visited implies its ancestors were visited too; the root 
+		// is always visited
+		for (size_t slot = numSlots; slot-- > 1; )
+		{
+			if (mVisited[slot] && mParents[slot] != NO_PARENT)
+				mVisited[mParents[slot]] = 1;
+		}
+		mVisited[0] = 1;
+
+		return anyDirty;
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::updateLevel(const Level& level)
+	{
+		// Gather the derived transforms of the parents. Parents which were not
+		// updated this time may have been updated by other means since we 
+		// last saw them, so take those from the node itself
+		for (size_t i = 0; i < level.count; ++i)
+		{
+			size_t parent = mParents[level.start + i];
+			if (mSelfDirty[parent])
+			{
+				for (size_t c = 0; c < 4; ++c)
+					mParentScratch.orientation[c][i] = mDerived.orientation[c][parent];
+				for (size_t c = 0; c < 3; ++c)
+				{
+					mParentScratch.position[c][i] = mDerived.position[c][parent];
+					mParentScratch.scale[c][i] = mDerived.scale[c][parent];
+				}
+			}
+			else
+			{
+				const Node* node = mNodes[parent];
+				const Quaternion& q = node->mDerivedOrientation;
+				const Vector3& p = node->mDerivedPosition;
+				const Vector3& s = node->mDerivedScale;
+				mParentScratch.orientation[0][i] = q.w;
+				mParentScratch.orientation[1][i] = q.x;
+				mParentScratch.orientation[2][i] = q.y;
+				mParentScratch.orientation[3][i] = q.z;
+				for (size_t c = 0; c < 3; ++c)
+				{
+					mParentScratch.position[c][i] = p[c];
+					mParentScratch.scale[c][i] = s[c];
+				}
+			}
+		}
+
+		// Concatenate the whole level; results for clean nodes are not used
+		OptimisedUtil::TransformSoA local, derived;
+		for (size_t c = 0; c < 4; ++c)
+		{
+			local.orientation[c] = mLocal.orientation[c] + level.start;
+			derived.orientation[c] = mDerived.orientation[c] + level.start;
+		}
+		for (size_t c = 0; c < 3; ++c)
+		{
+			local.position[c] = mLocal.position[c] + level.start;
+			local.scale[c] = mLocal.scale[c] + level.start;
+			derived.position[c] = mDerived.position[c] + level.start;
+			derived.scale[c] = mDerived.scale[c] + level.start;
+		}
+		size_t numPadded = (level.count + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+		OptimisedUtil::getImplementation()->concatenateTransformsSoA(
+			mParentScratch, local, derived, numPadded);
+
+		// Nodes which don't inherit orientation or scale use their own
+		for (size_t slot = level.start; slot < level.start + level.count; ++slot)
+		{
+			if (!mInheritOrientation[slot])
+			{
+				for (size_t c = 0; c < 4; ++c)
+					mDerived.orientation[c][slot] = mLocal.orientation[c][slot];
+			}
+			if (!mInheritScale[slot])
+			{
+				for (size_t c = 0; c < 3; ++c)
+					mDerived.scale[c][slot] = mLocal.scale[c][slot];
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void NodeTransformBatch::scatterChanges(void)
+	{
+		mUpdatedNodes.clear();
+
+		size_t numSlots = mNodes.size();
+		for (size_t slot = 0; slot < numSlots; ++slot)
+		{
+			Node* node = mNodes[slot];
+			if (!node || !mVisited[slot])
+				continue;
+
+			if (mSelfDirty[slot])
+			{
+				node->_setDerivedTransform(
+					Quaternion(mDerived.orientation[0][slot], mDerived.orientation[1][slot],
+						mDerived.orientation[2][slot], mDerived.orientation[3][slot]),
+					Vector3(mDerived.position[0][slot], mDerived.position[1][slot],
+						mDerived.position[2][slot]),
+					Vector3(mDerived.scale[0][slot], mDerived.scale[1][slot],
+						mDerived.scale[2][slot]));
+			}
+
+			node->mParentNotified = false;
+			node->mNeedChildUpdate = false;
+			node->mChildrenToUpdate.clear();
+			mUpdatedNodes.push_back(node);
+		}
+	}
+}
@@ -43,6 +43,9 @@ namespace Ogre {
     extern OptimisedUtil* _getOptimisedUtilGeneral(void);
 #if __OGRE_HAVE_SSE
     extern OptimisedUtil* _getOptimisedUtilSSE(void);
+#if __OGRE_HAVE_AVX
+    extern OptimisedUtil* _getOptimisedUtilAVX(void);
+#endif
 //#elif __OGRE_HAVE_NEON
 //    extern OptimisedUtil* _getOptimisedUtilNEON(void);
 //#elif __OGRE_HAVE_VFP
@@ -83,6 +86,9 @@ namespace Ogre {
             IMPL_DEFAULT,
 #if __OGRE_HAVE_SSE
             IMPL_SSE,
+#if __OGRE_HAVE_AVX
+            IMPL_AVX,
+#endif
 //#elif __OGRE_HAVE_NEON
 //            IMPL_NEON,
 //#elif __OGRE_HAVE_VFP
@@ -133,6 +139,12 @@ namespace Ogre {
             {
                 mOptimisedUtils.push_back(_getOptimisedUtilSSE());
             }
+#if __OGRE_HAVE_AVX
+            if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX)
+            {
+                mOptimisedUtils.push_back(_getOptimisedUtilAVX());
+            }
+#endif
 //#elif __OGRE_HAVE_VFP
 //            if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_VFP)
 //            {
@@ -340,6 +352,58 @@ namespace Ogre {
             ++index;    // So we can put break point here even if in release build
         }
 
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->concatenateTransformsSoA(
+                parent,
+                local,
+                derived,
+                numTransforms);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes)
+        {
+            static ProfileItems results;
+            static size_t index;
+            index = Root::getSingleton().getNextFrameNumber() % mOptimisedUtils.size();
+            OptimisedUtil* impl = mOptimisedUtils[index];
+            ProfileItem& profile = results[index];
+
+            profile.begin();
+            impl->cullAxisAlignedBoxes(
+                planes,
+                numPlanes,
+                boxes,
+                visible,
+                numBoxes);
+            profile.end();
+
+            // You can put break point here while running test application, to
+            // watch profile results.
+            ++index;    // So we can put break point here even if in release build
+        }
+
     };
 #endif // __DO_PROFILE__
 
@@ -394,6 +458,14 @@ namespace Ogre {
 #else   // !__DO_PROFILE__
 
 #if __OGRE_HAVE_SSE
+#if __OGRE_HAVE_AVX
+        // AVX is only reported if the OS supports it too
+        if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX)
+        {
+            return _getOptimisedUtilAVX();
+        }
+        else
+#endif  // __OGRE_HAVE_AVX
         if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
         {
             return _getOptimisedUtilSSE();
@@ -418,5 +490,29 @@ namespace Ogre {
 
 #endif  // __DO_PROFILE__
     }
+    //---------------------------------------------------------------------
+    OptimisedUtil* OptimisedUtil::_getImplementation(ImplementationType type)
+    {
+        switch (type)
+        {
+        case IT_GENERAL:
+            return _getOptimisedUtilGeneral();
+#if __OGRE_HAVE_SSE
+        case IT_SSE:
+            if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE)
+                return _getOptimisedUtilSSE();
+            break;
+#if __OGRE_HAVE_AVX
+        case IT_AVX:
+            if (PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX)
+                return _getOptimisedUtilAVX();
+            break;
+#endif  // __OGRE_HAVE_AVX
+#endif  // __OGRE_HAVE_SSE
+        default:
+            break;
+        }
+        return 0;
+    }
 
 }
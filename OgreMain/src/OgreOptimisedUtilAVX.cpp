@@ -0,0 +1,742 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreOptimisedUtil.h"
+#include "OgrePlatformInformation.h"
+
+#if __OGRE_HAVE_AVX
+
+#include "OgreMatrix4.h"
+#include "OgreVector3.h"
+
+#include <immintrin.h>
+
+//-------------------------------------------------------------------------
+//
+// Unlike the SSE version, the rest of the engine is not compiled for AVX,
+// so only the functions in this file which are marked with
+// __OGRE_AVX_FUNCTION may use it, and they are only called once the CPU
+// and OS are known to support it. Anything they call which is not marked,
+// inline functions in the engine headers included, is compiled as usual.
+//
+// The results are the same as those of the general version, bit for bit
+// (except that a zero may have a different sign). So each calculation is
+// done in the same order as there, and FMA is not used, since fusing a
+// multiply with an add rounds differently.
+//
+//-------------------------------------------------------------------------
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC
+#   define __OGRE_AVX_FUNCTION  __attribute__((__target__("avx")))
+#else
+#   define __OGRE_AVX_FUNCTION
+#endif
+
+namespace Ogre {
+
+    // External functions
+    extern OptimisedUtil* _getOptimisedUtilGeneral(void);
+    extern OptimisedUtil* _getOptimisedUtilSSE(void);
+
+//-------------------------------------------------------------------------
+// Local classes
+//-------------------------------------------------------------------------
+
+    /** AVX implementation of OptimisedUtil.
+    @remarks
+        Only AVX instructions are used, so this needs VS2010 rather than the
+        VS2012 which AVX2 intrinsics would.
+    @note
+        Don't use this class directly, use OptimisedUtil instead.
+    */
+    class _OgrePrivate OptimisedUtilAVX : public OptimisedUtil
+    {
+    protected:
+        /// Used for the remainders which don't fill a whole register
+        OptimisedUtil* mGeneral;
+        /// Used for the functions which have no AVX version
+        OptimisedUtil* mSSE;
+
+    public:
+        /// Constructor
+        OptimisedUtilAVX(void);
+
+        /// @copydoc OptimisedUtil::softwareVertexSkinning
+        virtual void softwareVertexSkinning(
+            const float *srcPosPtr, float *destPosPtr,
+            const float *srcNormPtr, float *destNormPtr,
+            const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+            const Matrix4* const* blendMatrices,
+            size_t srcPosStride, size_t destPosStride,
+            size_t srcNormStride, size_t destNormStride,
+            size_t blendWeightStride, size_t blendIndexStride,
+            size_t numWeightsPerVertex,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::softwareVertexMorph
+        virtual void softwareVertexMorph(
+            Real t,
+            const float *srcPos1, const float *srcPos2,
+            float *dstPos,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateAffineMatrices
+        virtual void concatenateAffineMatrices(
+            const Matrix4& baseMatrix,
+            const Matrix4* srcMatrices,
+            Matrix4* dstMatrices,
+            size_t numMatrices);
+
+        /// @copydoc OptimisedUtil::calculateFaceNormals
+        virtual void calculateFaceNormals(
+            const float *positions,
+            const EdgeData::Triangle *triangles,
+            Vector4 *faceNormals,
+            size_t numTriangles);
+
+        /// @copydoc OptimisedUtil::calculateLightFacing
+        virtual void calculateLightFacing(
+            const Vector4& lightPos,
+            const Vector4* faceNormals,
+            char* lightFacings,
+            size_t numFaces);
+
+        /// @copydoc OptimisedUtil::extrudeVertices
+        virtual void extrudeVertices(
+            const Vector4& lightPos,
+            Real extrudeDist,
+            const float* srcPositions,
+            float* destPositions,
+            size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateTransformsSoA
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms);
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes);
+    };
+
+//-------------------------------------------------------------------------
+// Helpers
+//-------------------------------------------------------------------------
+
+    // Vector3::normalise compares the length with 1e-08 in double precision;
+    // this is the largest float which is not greater than that, so the same
+    // test can be done in single precision.
+    static const float msNormaliseThreshold = 1e-08f;
+
+    //---------------------------------------------------------------------
+    // Puts a 128-bit value in each half of a 256-bit register.
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m256 _combine(__m128 lo, __m128 hi)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+    }
+    //---------------------------------------------------------------------
+    // Loads 8 packed xyz vectors and converts them to x, y and z registers,
+    // which hold the vectors in order.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _loadSoA8(const float* p, __m256& x, __m256& y, __m256& z)
+    {
+        // x0y0z0x1 x4y4z4x5, y1z1x2y2 y5z5x6y6, z2x3y3z3 z6x7y7z7
+        __m256 m03 = _combine(_mm_loadu_ps(p + 0), _mm_loadu_ps(p + 12));
+        __m256 m14 = _combine(_mm_loadu_ps(p + 4), _mm_loadu_ps(p + 16));
+        __m256 m25 = _combine(_mm_loadu_ps(p + 8), _mm_loadu_ps(p + 20));
+        // x2y2x3y3, y0z0y1z1
+        __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+        __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+    //---------------------------------------------------------------------
+    // Inverse of _loadSoA8.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _storeSoA8(float* p, __m256 x, __m256 y, __m256 z)
+    {
+        __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 m03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 m14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 m25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(p + 0, _mm256_castps256_ps128(m03));
+        _mm_storeu_ps(p + 4, _mm256_castps256_ps128(m14));
+        _mm_storeu_ps(p + 8, _mm256_castps256_ps128(m25));
+        _mm_storeu_ps(p + 12, _mm256_extractf128_ps(m03, 1));
+        _mm_storeu_ps(p + 16, _mm256_extractf128_ps(m14, 1));
+        _mm_storeu_ps(p + 20, _mm256_extractf128_ps(m25, 1));
+    }
+
+    //---------------------------------------------------------------------
+    // Transposes the rows of a 4x4 matrix in each half of the registers.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _transpose4x2(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+    {
+        __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+        __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+        __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+        r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+        r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    //---------------------------------------------------------------------
+    // Loads x, y and z, without touching the float after them.
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m128 _loadXYZ(const float* p)
+    {
+        return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)p), _mm_load_ss(p + 2));
+    }
+    //---------------------------------------------------------------------
+    // Loads 4 floats from each of 8 places, and transposes them so that
+    // the n-th register holds the n-th float of each.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _loadTransposed8(const float* const* p, 
+        __m256& r0, __m256& r1, __m256& r2, __m256& r3)
+    {
+        r0 = _combine(_mm_loadu_ps(p[0]), _mm_loadu_ps(p[4]));
+        r1 = _combine(_mm_loadu_ps(p[1]), _mm_loadu_ps(p[5]));
+        r2 = _combine(_mm_loadu_ps(p[2]), _mm_loadu_ps(p[6]));
+        r3 = _combine(_mm_loadu_ps(p[3]), _mm_loadu_ps(p[7]));
+        _transpose4x2(r0, r1, r2, r3);
+    }
+    //---------------------------------------------------------------------
+    // Loads the x, y and z of 8 vectors, each a stride apart.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _loadStridedSoA8(const float* p, size_t stride,
+        __m256& x, __m256& y, __m256& z)
+    {
+        if (stride == 3 * sizeof(float))
+        {
+            _loadSoA8(p, x, y, z);
+        }
+        else
+        {
+            // A stride of at least 4 floats, so the fourth is safe to load
+            const float* v[8];
+            for (size_t i = 0; i < 8; ++i)
+                v[i] = rawOffsetPointer(p, i * stride);
+            __m256 w;
+            _loadTransposed8(v, x, y, z, w);
+        }
+    }
+    //---------------------------------------------------------------------
+    // Inverse of _loadStridedSoA8.
+    __OGRE_AVX_FUNCTION static FORCEINLINE void _storeStridedSoA8(float* p, size_t stride,
+        __m256 x, __m256 y, __m256 z)
+    {
+        if (stride == 3 * sizeof(float))
+        {
+            _storeSoA8(p, x, y, z);
+        }
+        else
+        {
+            // xyz0 of vectors 0 and 4, 1 and 5, 2 and 6, 3 and 7
+            __m256 xyLo = _mm256_unpacklo_ps(x, y);
+            __m256 xyHi = _mm256_unpackhi_ps(x, y);
+            __m256 z0Lo = _mm256_unpacklo_ps(z, _mm256_setzero_ps());
+            __m256 z0Hi = _mm256_unpackhi_ps(z, _mm256_setzero_ps());
+            __m256 v[4];
+            v[0] = _mm256_shuffle_ps(xyLo, z0Lo, _MM_SHUFFLE(1, 0, 1, 0));
+            v[1] = _mm256_shuffle_ps(xyLo, z0Lo, _MM_SHUFFLE(3, 2, 3, 2));
+            v[2] = _mm256_shuffle_ps(xyHi, z0Hi, _MM_SHUFFLE(1, 0, 1, 0));
+            v[3] = _mm256_shuffle_ps(xyHi, z0Hi, _MM_SHUFFLE(3, 2, 3, 2));
+            for (size_t i = 0; i < 4; ++i)
+            {
+                __m128 lo = _mm256_castps256_ps128(v[i]);
+                __m128 hi = _mm256_extractf128_ps(v[i], 1);
+                float* pLo = rawOffsetPointer(p, i * stride);
+                float* pHi = rawOffsetPointer(p, (i + 4) * stride);
+                _mm_storel_pi((__m64*)pLo, lo);
+                _mm_store_ss(pLo + 2, _mm_movehl_ps(lo, lo));
+                _mm_storel_pi((__m64*)pHi, hi);
+                _mm_store_ss(pHi + 2, _mm_movehl_ps(hi, hi));
+            }
+        }
+    }
+
+//-------------------------------------------------------------------------
+// Implementation
+//-------------------------------------------------------------------------
+
+    OptimisedUtilAVX::OptimisedUtilAVX(void)
+        : mGeneral(_getOptimisedUtilGeneral())
+        , mSSE(_getOptimisedUtilSSE())
+    {
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::softwareVertexSkinning(
+        const float *pSrcPos, float *pDestPos,
+        const float *pSrcNorm, float *pDestNorm,
+        const float *pBlendWeight, const unsigned char* pBlendIndex,
+        const Matrix4* const* blendMatrices,
+        size_t srcPosStride, size_t destPosStride,
+        size_t srcNormStride, size_t destNormStride,
+        size_t blendWeightStride, size_t blendIndexStride,
+        size_t numWeightsPerVertex,
+        size_t numVertices)
+    {
+        // Eight vertices at a time, one in each element of the registers.
+        // The blend matrices are transposed as they are loaded, and each row
+        // of the result is worked out in the same order as the general version.
+        // More weights than Ogre supports are left to the general version.
+        size_t numBlocks = numWeightsPerVertex <= 4 ? numVertices / 8 : 0;
+        if (numBlocks)
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 threshold = _mm256_set1_ps(msNormaliseThreshold);
+            const __m256 one = _mm256_set1_ps(1.0f);
+
+            // Rows of the blend matrix of each vertex, the zero matrix for
+            // a zero weight, whose index may be garbage
+            OGRE_ALIGNED_DECL(float, weights[4][8], 32);
+            const float* rows[4][8];
+            const float* zeroRows = Matrix4::ZERO[0];
+
+            for (size_t block = 0; block < numBlocks; ++block)
+            {
+                const float* pWeight = pBlendWeight;
+                const unsigned char* pIndex = pBlendIndex;
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    for (size_t w = 0; w < numWeightsPerVertex; ++w)
+                    {
+                        weights[w][i] = pWeight[w];
+                        rows[w][i] = pWeight[w] ? (*blendMatrices[pIndex[w]])[0] : zeroRows;
+                    }
+                    advanceRawPointer(pWeight, blendWeightStride);
+                    advanceRawPointer(pIndex, blendIndexStride);
+                }
+
+                __m256 srcX, srcY, srcZ;
+                _loadStridedSoA8(pSrcPos, srcPosStride, srcX, srcY, srcZ);
+                __m256 normX = zero, normY = zero, normZ = zero;
+                if (pSrcNorm)
+                    _loadStridedSoA8(pSrcNorm, srcNormStride, normX, normY, normZ);
+
+                __m256 accumX = zero, accumY = zero, accumZ = zero;
+                __m256 accumNormX = zero, accumNormY = zero, accumNormZ = zero;
+                for (size_t w = 0; w < numWeightsPerVertex; ++w)
+                {
+                    __m256 weight = _mm256_load_ps(weights[w]);
+                    // Zero weights are skipped by the general version
+                    __m256 mask = _mm256_cmp_ps(weight, zero, _CMP_NEQ_UQ);
+
+                    // The elements of the first three rows, for each vertex
+                    __m256 m[12];
+                    const float* p[8];
+                    for (size_t r = 0; r < 3; ++r)
+                    {
+                        for (size_t i = 0; i < 8; ++i)
+                            p[i] = rows[w][i] + r * 4;
+                        _loadTransposed8(p, m[r * 4], m[r * 4 + 1], m[r * 4 + 2], m[r * 4 + 3]);
+                    }
+
+                    // ((m0 * x + m1 * y) + m2 * z) + m3, then weighted
+                    accumX = _mm256_add_ps(accumX, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], srcX), 
+                        _mm256_mul_ps(m[1], srcY)), _mm256_mul_ps(m[2], srcZ)), m[3]))));
+                    accumY = _mm256_add_ps(accumY, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[4], srcX), 
+                        _mm256_mul_ps(m[5], srcY)), _mm256_mul_ps(m[6], srcZ)), m[7]))));
+                    accumZ = _mm256_add_ps(accumZ, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                        _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[8], srcX), 
+                        _mm256_mul_ps(m[9], srcY)), _mm256_mul_ps(m[10], srcZ)), m[11]))));
+
+                    if (pSrcNorm)
+                    {
+                        // Rotational part only, see the general version
+                        accumNormX = _mm256_add_ps(accumNormX, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[0], normX), 
+                            _mm256_mul_ps(m[1], normY)), _mm256_mul_ps(m[2], normZ)))));
+                        accumNormY = _mm256_add_ps(accumNormY, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[4], normX), 
+                            _mm256_mul_ps(m[5], normY)), _mm256_mul_ps(m[6], normZ)))));
+                        accumNormZ = _mm256_add_ps(accumNormZ, _mm256_and_ps(mask, _mm256_mul_ps(weight,
+                            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m[8], normX), 
+                            _mm256_mul_ps(m[9], normY)), _mm256_mul_ps(m[10], normZ)))));
+                    }
+                }
+
+                _storeStridedSoA8(pDestPos, destPosStride, accumX, accumY, accumZ);
+                if (pSrcNorm)
+                {
+                    // As Vector3::normalise
+                    __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(
+                        _mm256_mul_ps(accumNormX, accumNormX), _mm256_mul_ps(accumNormY, accumNormY)),
+                        _mm256_mul_ps(accumNormZ, accumNormZ)));
+                    __m256 invLen = _mm256_div_ps(one, len);
+                    __m256 normalise = _mm256_cmp_ps(len, threshold, _CMP_GT_OQ);
+                    accumNormX = _mm256_blendv_ps(accumNormX, _mm256_mul_ps(accumNormX, invLen), normalise);
+                    accumNormY = _mm256_blendv_ps(accumNormY, _mm256_mul_ps(accumNormY, invLen), normalise);
+                    accumNormZ = _mm256_blendv_ps(accumNormZ, _mm256_mul_ps(accumNormZ, invLen), normalise);
+                    _storeStridedSoA8(pDestNorm, destNormStride, accumNormX, accumNormY, accumNormZ);
+
+                    advanceRawPointer(pSrcNorm, 8 * srcNormStride);
+                    advanceRawPointer(pDestNorm, 8 * destNormStride);
+                }
+
+                advanceRawPointer(pSrcPos, 8 * srcPosStride);
+                advanceRawPointer(pDestPos, 8 * destPosStride);
+                advanceRawPointer(pBlendWeight, 8 * blendWeightStride);
+                advanceRawPointer(pBlendIndex, 8 * blendIndexStride);
+            }
+        }
+
+        // The remainder
+        size_t numLeft = numVertices - numBlocks * 8;
+        if (numLeft)
+        {
+            mGeneral->softwareVertexSkinning(
+                pSrcPos, pDestPos, pSrcNorm, pDestNorm,
+                pBlendWeight, pBlendIndex, blendMatrices,
+                srcPosStride, destPosStride, srcNormStride, destNormStride,
+                blendWeightStride, blendIndexStride,
+                numWeightsPerVertex, numLeft);
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::softwareVertexMorph(
+        Real t,
+        const float *pSrc1, const float *pSrc2,
+        float *pDst,
+        size_t numVertices)
+    {
+        // The positions are just an array of floats here
+        size_t numFloats = numVertices * 3;
+        size_t numPacked = numFloats & ~size_t(7);
+        __m256 t8 = _mm256_set1_ps(t);
+
+        for (size_t i = 0; i < numPacked; i += 8)
+        {
+            __m256 src1 = _mm256_loadu_ps(pSrc1 + i);
+            __m256 src2 = _mm256_loadu_ps(pSrc2 + i);
+            // src1 + t * (src2 - src1)
+            _mm256_storeu_ps(pDst + i,
+                _mm256_add_ps(src1, _mm256_mul_ps(t8, _mm256_sub_ps(src2, src1))));
+        }
+
+        // The general version works on whole vertices, so finish off on the
+        // floats directly
+        for (size_t i = numPacked; i < numFloats; ++i)
+        {
+            pDst[i] = pSrc1[i] + t * (pSrc2[i] - pSrc1[i]);
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::concatenateAffineMatrices(
+        const Matrix4& baseMatrix,
+        const Matrix4* pSrcMat,
+        Matrix4* pDstMat,
+        size_t numMatrices)
+    {
+        // Two matrices at a time, one in each half of the registers. Each 
+        // row of the result is m[r][0] * s[0] + m[r][1] * s[1] + m[r][2] * s[2],
+        // plus m[r][3] in the last column.
+        const Matrix4& m = baseMatrix;
+        __m256 m0[3], m1[3], m2[3], m3[3];
+        for (size_t r = 0; r < 3; ++r)
+        {
+            m0[r] = _mm256_set1_ps(m[r][0]);
+            m1[r] = _mm256_set1_ps(m[r][1]);
+            m2[r] = _mm256_set1_ps(m[r][2]);
+            m3[r] = _mm256_set1_ps(m[r][3]);
+        }
+        const __m256 lastRow = _mm256_setr_ps(0, 0, 0, 1, 0, 0, 0, 1);
+
+        size_t i = 0;
+        for (; i + 2 <= numMatrices; i += 2)
+        {
+            const float* s1 = pSrcMat[i][0];
+            const float* s2 = pSrcMat[i + 1][0];
+            __m256 s0 = _combine(_mm_loadu_ps(s1 + 0), _mm_loadu_ps(s2 + 0));
+            __m256 sr1 = _combine(_mm_loadu_ps(s1 + 4), _mm_loadu_ps(s2 + 4));
+            __m256 sr2 = _combine(_mm_loadu_ps(s1 + 8), _mm_loadu_ps(s2 + 8));
+
+            float* d1 = pDstMat[i][0];
+            float* d2 = pDstMat[i + 1][0];
+            for (size_t r = 0; r < 3; ++r)
+            {
+                __m256 row = _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(m0[r], s0), _mm256_mul_ps(m1[r], sr1)),
+                    _mm256_mul_ps(m2[r], sr2));
+                // Only the last column has the translation added
+                row = _mm256_blend_ps(row, _mm256_add_ps(row, m3[r]), 0x88);
+                _mm_storeu_ps(d1 + r * 4, _mm256_castps256_ps128(row));
+                _mm_storeu_ps(d2 + r * 4, _mm256_extractf128_ps(row, 1));
+            }
+            _mm_storeu_ps(d1 + 12, _mm256_castps256_ps128(lastRow));
+            _mm_storeu_ps(d2 + 12, _mm256_extractf128_ps(lastRow, 1));
+        }
+
+        if (i < numMatrices)
+        {
+            mGeneral->concatenateAffineMatrices(baseMatrix, pSrcMat + i, pDstMat + i, numMatrices - i);
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::calculateFaceNormals(
+        const float *positions,
+        const EdgeData::Triangle *triangles,
+        Vector4 *faceNormals,
+        size_t numTriangles)
+    {
+        // Eight triangles at a time, with the corners transposed into x, y
+        // and z registers
+        size_t numPacked = numTriangles & ~size_t(7);
+        for (size_t i = 0; i < numPacked; i += 8)
+        {
+            const EdgeData::Triangle* t = triangles + i;
+            __m256 v[3][4];
+            for (size_t c = 0; c < 3; ++c)
+            {
+                // Exactly three floats each, the last vertex may end the buffer
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    v[c][j] = _combine(_loadXYZ(positions + t[j].vertIndex[c] * 3),
+                        _loadXYZ(positions + t[j + 4].vertIndex[c] * 3));
+                }
+                _transpose4x2(v[c][0], v[c][1], v[c][2], v[c][3]);
+            }
+            __m256 v1x = v[0][0], v1y = v[0][1], v1z = v[0][2];
+            __m256 v2x = v[1][0], v2y = v[1][1], v2z = v[1][2];
+            __m256 v3x = v[2][0], v3y = v[2][1], v3z = v[2][2];
+
+            // (v2 - v1).crossProduct(v3 - v1)
+            __m256 ax = _mm256_sub_ps(v2x, v1x);
+            __m256 ay = _mm256_sub_ps(v2y, v1y);
+            __m256 az = _mm256_sub_ps(v2z, v1z);
+            __m256 bx = _mm256_sub_ps(v3x, v1x);
+            __m256 by = _mm256_sub_ps(v3y, v1y);
+            __m256 bz = _mm256_sub_ps(v3z, v1z);
+            __m256 nx = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+            __m256 ny = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+            __m256 nz = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+            // -(normal.dotProduct(v1))
+            __m256 nw = _mm256_xor_ps(_mm256_set1_ps(-0.0f), _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(nx, v1x), _mm256_mul_ps(ny, v1y)),
+                _mm256_mul_ps(nz, v1z)));
+
+            // Transpose back to one Vector4 per triangle
+            __m256 t0 = _mm256_unpacklo_ps(nx, ny);
+            __m256 t1 = _mm256_unpacklo_ps(nz, nw);
+            __m256 t2 = _mm256_unpackhi_ps(nx, ny);
+            __m256 t3 = _mm256_unpackhi_ps(nz, nw);
+            __m256 f04 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f15 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 f26 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 f37 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            float* dst = faceNormals[i].ptr();
+            _mm256_storeu_ps(dst + 0, _mm256_permute2f128_ps(f04, f15, 0x20));
+            _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(f26, f37, 0x20));
+            _mm256_storeu_ps(dst + 16, _mm256_permute2f128_ps(f04, f15, 0x31));
+            _mm256_storeu_ps(dst + 24, _mm256_permute2f128_ps(f26, f37, 0x31));
+        }
+
+        if (numPacked < numTriangles)
+        {
+            mGeneral->calculateFaceNormals(positions, triangles + numPacked, 
+                faceNormals + numPacked, numTriangles - numPacked);
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::calculateLightFacing(
+        const Vector4& lightPos,
+        const Vector4* faceNormals,
+        char* lightFacings,
+        size_t numFaces)
+    {
+        const __m256 lx = _mm256_set1_ps(lightPos.x);
+        const __m256 ly = _mm256_set1_ps(lightPos.y);
+        const __m256 lz = _mm256_set1_ps(lightPos.z);
+        const __m256 lw = _mm256_set1_ps(lightPos.w);
+        const __m256 zero = _mm256_setzero_ps();
+
+        // Eight faces at a time
+        size_t numPacked = numFaces & ~size_t(7);
+        for (size_t i = 0; i < numPacked; i += 8)
+        {
+            const float* src = faceNormals[i].ptr();
+            // Faces 0 and 4 in one register, 1 and 5 in the next, and so on
+            __m256 f04 = _combine(_mm_loadu_ps(src + 0), _mm_loadu_ps(src + 16));
+            __m256 f15 = _combine(_mm_loadu_ps(src + 4), _mm_loadu_ps(src + 20));
+            __m256 f26 = _combine(_mm_loadu_ps(src + 8), _mm_loadu_ps(src + 24));
+            __m256 f37 = _combine(_mm_loadu_ps(src + 12), _mm_loadu_ps(src + 28));
+            // Transpose, so that the faces are in order in x, y, z and w
+            __m256 t0 = _mm256_unpacklo_ps(f04, f15);
+            __m256 t1 = _mm256_unpacklo_ps(f26, f37);
+            __m256 t2 = _mm256_unpackhi_ps(f04, f15);
+            __m256 t3 = _mm256_unpackhi_ps(f26, f37);
+            __m256 nx = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 ny = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 nz = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 nw = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+            // lightPos.dotProduct(faceNormal) > 0
+            __m256 dp = _mm256_add_ps(
+                _mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(lx, nx), _mm256_mul_ps(ly, ny)),
+                    _mm256_mul_ps(lz, nz)),
+                _mm256_mul_ps(lw, nw));
+            __m256i facing = _mm256_castps_si256(_mm256_cmp_ps(dp, zero, _CMP_GT_OQ));
+
+            // All ones or zeros in each element, packed down to a 0 or 1 byte
+            __m128i words = _mm_packs_epi32(
+                _mm256_castsi256_si128(facing), _mm256_extractf128_si256(facing, 1));
+            __m128i bytes = _mm_and_si128(_mm_packs_epi16(words, words), _mm_set1_epi8(1));
+            _mm_storel_epi64((__m128i*)(lightFacings + i), bytes);
+        }
+
+        if (numPacked < numFaces)
+        {
+            mGeneral->calculateLightFacing(lightPos, faceNormals + numPacked,
+                lightFacings + numPacked, numFaces - numPacked);
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION void OptimisedUtilAVX::extrudeVertices(
+        const Vector4& lightPos,
+        Real extrudeDist,
+        const float* pSrcPos,
+        float* pDestPos,
+        size_t numVertices)
+    {
+        // Eight vertices at a time
+        size_t numPacked = numVertices & ~size_t(7);
+
+        if (lightPos.w == 0.0f)
+        {
+            // Directional light, extrusion is along light direction
+            Vector3 extrusionDir(
+                -lightPos.x,
+                -lightPos.y,
+                -lightPos.z);
+            extrusionDir.normalise();
+            extrusionDir *= extrudeDist;
+
+            // Eight vertices are three registers, and the direction repeats
+            // across them
+            const __m256 dir0 = _mm256_setr_ps(
+                extrusionDir.x, extrusionDir.y, extrusionDir.z, extrusionDir.x,
+                extrusionDir.y, extrusionDir.z, extrusionDir.x, extrusionDir.y);
+            const __m256 dir1 = _mm256_setr_ps(
+                extrusionDir.z, extrusionDir.x, extrusionDir.y, extrusionDir.z,
+                extrusionDir.x, extrusionDir.y, extrusionDir.z, extrusionDir.x);
+            const __m256 dir2 = _mm256_setr_ps(
+                extrusionDir.y, extrusionDir.z, extrusionDir.x, extrusionDir.y,
+                extrusionDir.z, extrusionDir.x, extrusionDir.y, extrusionDir.z);
+
+            for (size_t vert = 0; vert < numPacked; vert += 8)
+            {
+                const float* src = pSrcPos + vert * 3;
+                float* dst = pDestPos + vert * 3;
+                _mm256_storeu_ps(dst + 0, _mm256_add_ps(_mm256_loadu_ps(src + 0), dir0));
+                _mm256_storeu_ps(dst + 8, _mm256_add_ps(_mm256_loadu_ps(src + 8), dir1));
+                _mm256_storeu_ps(dst + 16, _mm256_add_ps(_mm256_loadu_ps(src + 16), dir2));
+            }
+        }
+        else
+        {
+            // Point light, calculate extrusionDir for every vertex
+            assert(lightPos.w == 1.0f);
+
+            const __m256 lx = _mm256_set1_ps(lightPos.x);
+            const __m256 ly = _mm256_set1_ps(lightPos.y);
+            const __m256 lz = _mm256_set1_ps(lightPos.z);
+            const __m256 dist = _mm256_set1_ps(extrudeDist);
+            const __m256 threshold = _mm256_set1_ps(msNormaliseThreshold);
+            const __m256 one = _mm256_set1_ps(1.0f);
+
+            for (size_t vert = 0; vert < numPacked; vert += 8)
+            {
+                __m256 x, y, z;
+                _loadSoA8(pSrcPos + vert * 3, x, y, z);
+
+                __m256 dx = _mm256_sub_ps(x, lx);
+                __m256 dy = _mm256_sub_ps(y, ly);
+                __m256 dz = _mm256_sub_ps(z, lz);
+
+                // extrusionDir.normalise()
+                __m256 len = _mm256_sqrt_ps(_mm256_add_ps(
+                    _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                    _mm256_mul_ps(dz, dz)));
+                __m256 mask = _mm256_cmp_ps(len, threshold, _CMP_GT_OQ);
+                __m256 invLen = _mm256_div_ps(one, len);
+                dx = _mm256_blendv_ps(dx, _mm256_mul_ps(dx, invLen), mask);
+                dy = _mm256_blendv_ps(dy, _mm256_mul_ps(dy, invLen), mask);
+                dz = _mm256_blendv_ps(dz, _mm256_mul_ps(dz, invLen), mask);
+
+                _storeSoA8(pDestPos + vert * 3,
+                    _mm256_add_ps(x, _mm256_mul_ps(dx, dist)),
+                    _mm256_add_ps(y, _mm256_mul_ps(dy, dist)),
+                    _mm256_add_ps(z, _mm256_mul_ps(dz, dist)));
+            }
+        }
+
+        if (numPacked < numVertices)
+        {
+            mGeneral->extrudeVertices(lightPos, extrudeDist, pSrcPos + numPacked * 3,
+                pDestPos + numPacked * 3, numVertices - numPacked);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::concatenateTransformsSoA(
+        const TransformSoA& parent,
+        const TransformSoA& local,
+        const TransformSoA& derived,
+        size_t numTransforms)
+    {
+        mSSE->concatenateTransformsSoA(parent, local, derived, numTransforms);
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilAVX::cullAxisAlignedBoxes(
+        const Plane* planes,
+        size_t numPlanes,
+        const BoundsSoA& boxes,
+        uchar* visible,
+        size_t numBoxes)
+    {
+        mSSE->cullAxisAlignedBoxes(planes, numPlanes, boxes, visible, numBoxes);
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    extern OptimisedUtil* _getOptimisedUtilAVX(void)
+    {
+        static OptimisedUtilAVX msOptimisedUtilAVX;
+        return &msOptimisedUtilAVX;
+    }
+
+}
+
+#endif // __OGRE_HAVE_AVX
@@ -31,6 +31,8 @@ THE SOFTWARE.
 
 #include "OgreVector3.h"
 #include "OgreMatrix4.h"
+#include "OgreQuaternion.h"
+#include "OgrePlane.h"
 
 namespace Ogre {
 
@@ -92,6 +94,21 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateTransformsSoA
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms);
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes);
     };
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
@@ -361,6 +378,68 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::concatenateTransformsSoA(
+        const TransformSoA& parent,
+        const TransformSoA& local,
+        const TransformSoA& derived,
+        size_t numTransforms)
+    {
+        for (size_t i = 0; i < numTransforms; ++i)
+        {
+            Quaternion parentOrientation(
+                parent.orientation[0][i], parent.orientation[1][i],
+                parent.orientation[2][i], parent.orientation[3][i]);
+            Vector3 parentScale(
+                parent.scale[0][i], parent.scale[1][i], parent.scale[2][i]);
+            Vector3 parentPosition(
+                parent.position[0][i], parent.position[1][i], parent.position[2][i]);
+
+            Quaternion orientation = parentOrientation * Quaternion(
+                local.orientation[0][i], local.orientation[1][i],
+                local.orientation[2][i], local.orientation[3][i]);
+            Vector3 scale = parentScale * Vector3(
+                local.scale[0][i], local.scale[1][i], local.scale[2][i]);
+            Vector3 position = parentOrientation * (parentScale * Vector3(
+                local.position[0][i], local.position[1][i], local.position[2][i]));
+            position += parentPosition;
+
+            derived.orientation[0][i] = orientation.w;
+            derived.orientation[1][i] = orientation.x;
+            derived.orientation[2][i] = orientation.y;
+            derived.orientation[3][i] = orientation.z;
+            derived.scale[0][i] = scale.x;
+            derived.scale[1][i] = scale.y;
+            derived.scale[2][i] = scale.z;
+            derived.position[0][i] = position.x;
+            derived.position[1][i] = position.y;
+            derived.position[2][i] = position.z;
+        }
+    }
+    //---------------------------------------------------------------------
+    void OptimisedUtilGeneral::cullAxisAlignedBoxes(
+        const Plane* planes,
+        size_t numPlanes,
+        const BoundsSoA& boxes,
+        uchar* visible,
+        size_t numBoxes)
+    {
+        for (size_t i = 0; i < numBoxes; ++i)
+        {
+            Vector3 centre(boxes.centre[0][i], boxes.centre[1][i], boxes.centre[2][i]);
+            Vector3 halfSize(boxes.halfSize[0][i], boxes.halfSize[1][i], boxes.halfSize[2][i]);
+
+            visible[i] = 1;
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                if (planes[p].getSide(centre, halfSize) == Plane::NEGATIVE_SIDE)
+                {
+                    visible[i] = 0;
+                    break;
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilGeneral(void)
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #if __OGRE_HAVE_SSE
 
 #include "OgreMatrix4.h"
+#include "OgrePlane.h"
 
 // Should keep this includes at latest to avoid potential "xmmintrin.h" included by
 // other header file on some platform for some reason.
@@ -130,6 +131,21 @@ namespace Ogre {
             const float* srcPositions,
             float* destPositions,
             size_t numVertices);
+
+        /// @copydoc OptimisedUtil::concatenateTransformsSoA
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms);
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes);
     };
 
 #if defined(__OGRE_SIMD_ALIGN_STACK)
@@ -265,6 +281,40 @@ namespace Ogre {
                 destPositions,
                 numVertices);
         }
+
+        /// @copydoc OptimisedUtil::concatenateTransformsSoA
+        virtual void concatenateTransformsSoA(
+            const TransformSoA& parent,
+            const TransformSoA& local,
+            const TransformSoA& derived,
+            size_t numTransforms)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->concatenateTransformsSoA(
+                parent,
+                local,
+                derived,
+                numTransforms);
+        }
+
+        /// @copydoc OptimisedUtil::cullAxisAlignedBoxes
+        virtual void cullAxisAlignedBoxes(
+            const Plane* planes,
+            size_t numPlanes,
+            const BoundsSoA& boxes,
+            uchar* visible,
+            size_t numBoxes)
+        {
+            __OGRE_SIMD_ALIGN_STACK();
+
+            mImpl->cullAxisAlignedBoxes(
+                planes,
+                numPlanes,
+                boxes,
+                visible,
+                numBoxes);
+        }
     };
 #endif  // !defined(__OGRE_SIMD_ALIGN_STACK)
 
@@ -2061,6 +2111,306 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    static FORCEINLINE bool _isAlignedForSSE(const OptimisedUtil::TransformSoA& t)
+    {
+        return _isAlignedForSSE(t.orientation[0]) && _isAlignedForSSE(t.orientation[1]) &&
+               _isAlignedForSSE(t.orientation[2]) && _isAlignedForSSE(t.orientation[3]) &&
+               _isAlignedForSSE(t.position[0]) && _isAlignedForSSE(t.position[1]) &&
+               _isAlignedForSSE(t.position[2]) &&
+               _isAlignedForSSE(t.scale[0]) && _isAlignedForSSE(t.scale[1]) &&
+               _isAlignedForSSE(t.scale[2]);
+    }
+    //---------------------------------------------------------------------
+    // Concatenate four transforms at the given index. The operation order
+    // follows Quaternion and Vector3 operators exactly, so the results are
+    // bit-identical to the scalar code path used by Node.
+    template <bool aligned>
+    struct ConcatenateTransforms_SSE
+    {
+        static FORCEINLINE void apply(
+            const OptimisedUtil::TransformSoA& parent,
+            const OptimisedUtil::TransformSoA& local,
+            const OptimisedUtil::TransformSoA& derived,
+            size_t i)
+        {
+            typedef SSEMemoryAccessor<aligned> Accessor;
+
+            // Parent orientation
+            __m128 pw = Accessor::load(parent.orientation[0] + i);
+            __m128 px = Accessor::load(parent.orientation[1] + i);
+            __m128 py = Accessor::load(parent.orientation[2] + i);
+            __m128 pz = Accessor::load(parent.orientation[3] + i);
+
+            // Local orientation
+            __m128 lw = Accessor::load(local.orientation[0] + i);
+            __m128 lx = Accessor::load(local.orientation[1] + i);
+            __m128 ly = Accessor::load(local.orientation[2] + i);
+            __m128 lz = Accessor::load(local.orientation[3] + i);
+
+            // Parent scale
+            __m128 psx = Accessor::load(parent.scale[0] + i);
+            __m128 psy = Accessor::load(parent.scale[1] + i);
+            __m128 psz = Accessor::load(parent.scale[2] + i);
+
+            // Scaled local position
+            __m128 vx = _mm_mul_ps(psx, Accessor::load(local.position[0] + i));
+            __m128 vy = _mm_mul_ps(psy, Accessor::load(local.position[1] + i));
+            __m128 vz = _mm_mul_ps(psz, Accessor::load(local.position[2] + i));
+
+            // Derived scale
+            __m128 sx = _mm_mul_ps(psx, Accessor::load(local.scale[0] + i));
+            __m128 sy = _mm_mul_ps(psy, Accessor::load(local.scale[1] + i));
+            __m128 sz = _mm_mul_ps(psz, Accessor::load(local.scale[2] + i));
+
+            // Derived orientation = parent * local
+            __m128 ow = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(
+                _mm_mul_ps(pw, lw), _mm_mul_ps(px, lx)), _mm_mul_ps(py, ly)), _mm_mul_ps(pz, lz));
+            __m128 ox = _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, lx), _mm_mul_ps(px, lw)), _mm_mul_ps(py, lz)), _mm_mul_ps(pz, ly));
+            __m128 oy = _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, ly), _mm_mul_ps(py, lw)), _mm_mul_ps(pz, lx)), _mm_mul_ps(px, lz));
+            __m128 oz = _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(pw, lz), _mm_mul_ps(pz, lw)), _mm_mul_ps(px, ly)), _mm_mul_ps(py, lx));
+
+            // Rotate scaled position by parent orientation (nVidia SDK method)
+            __m128 uvx = _mm_sub_ps(_mm_mul_ps(py, vz), _mm_mul_ps(pz, vy));
+            __m128 uvy = _mm_sub_ps(_mm_mul_ps(pz, vx), _mm_mul_ps(px, vz));
+            __m128 uvz = _mm_sub_ps(_mm_mul_ps(px, vy), _mm_mul_ps(py, vx));
+            __m128 uuvx = _mm_sub_ps(_mm_mul_ps(py, uvz), _mm_mul_ps(pz, uvy));
+            __m128 uuvy = _mm_sub_ps(_mm_mul_ps(pz, uvx), _mm_mul_ps(px, uvz));
+            __m128 uuvz = _mm_sub_ps(_mm_mul_ps(px, uvy), _mm_mul_ps(py, uvx));
+
+            const __m128 two = _mm_load_ps1(&msTwo);
+            __m128 w2 = _mm_mul_ps(two, pw);
+            uvx = _mm_mul_ps(uvx, w2);
+            uvy = _mm_mul_ps(uvy, w2);
+            uvz = _mm_mul_ps(uvz, w2);
+            uuvx = _mm_mul_ps(uuvx, two);
+            uuvy = _mm_mul_ps(uuvy, two);
+            uuvz = _mm_mul_ps(uuvz, two);
+
+            // Derived position = rotated + parent position
+            __m128 dx = _mm_add_ps(_mm_add_ps(_mm_add_ps(vx, uvx), uuvx),
+                Accessor::load(parent.position[0] + i));
+            __m128 dy = _mm_add_ps(_mm_add_ps(_mm_add_ps(vy, uvy), uuvy),
+                Accessor::load(parent.position[1] + i));
+            __m128 dz = _mm_add_ps(_mm_add_ps(_mm_add_ps(vz, uvz), uuvz),
+                Accessor::load(parent.position[2] + i));
+
+            // Store results, derived arrays might alias local arrays, so
+            // store after all loads were done
+            Accessor::store(derived.orientation[0] + i, ow);
+            Accessor::store(derived.orientation[1] + i, ox);
+            Accessor::store(derived.orientation[2] + i, oy);
+            Accessor::store(derived.orientation[3] + i, oz);
+            Accessor::store(derived.position[0] + i, dx);
+            Accessor::store(derived.position[1] + i, dy);
+            Accessor::store(derived.position[2] + i, dz);
+            Accessor::store(derived.scale[0] + i, sx);
+            Accessor::store(derived.scale[1] + i, sy);
+            Accessor::store(derived.scale[2] + i, sz);
+        }
+
+        static const float msTwo;
+    };
+    template <bool aligned>
+    const float ConcatenateTransforms_SSE<aligned>::msTwo = 2.0f;
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::concatenateTransformsSoA(
+        const TransformSoA& parent,
+        const TransformSoA& local,
+        const TransformSoA& derived,
+        size_t numTransforms)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        size_t numIterations = numTransforms / 4;
+        size_t i = 0;
+
+        if (_isAlignedForSSE(parent) && _isAlignedForSSE(local) && _isAlignedForSSE(derived))
+        {
+            for (size_t iter = 0; iter < numIterations; ++iter, i += 4)
+                ConcatenateTransforms_SSE<true>::apply(parent, local, derived, i);
+        }
+        else
+        {
+            for (size_t iter = 0; iter < numIterations; ++iter, i += 4)
+                ConcatenateTransforms_SSE<false>::apply(parent, local, derived, i);
+        }
+
+        // Handle the remaining transforms through a temporary block, padded
+        // with identity transforms
+        size_t numLeft = numTransforms - i;
+        if (numLeft)
+        {
+            float temp[3][10][4];
+            TransformSoA t[3];
+            const TransformSoA* src[2] = { &parent, &local };
+            for (size_t s = 0; s < 3; ++s)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                    t[s].orientation[c] = temp[s][c];
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    t[s].position[c] = temp[s][4 + c];
+                    t[s].scale[c] = temp[s][7 + c];
+                }
+            }
+            for (size_t s = 0; s < 2; ++s)
+            {
+                for (size_t j = 0; j < 4; ++j)
+                {
+                    bool valid = j < numLeft;
+                    for (size_t c = 0; c < 4; ++c)
+                        t[s].orientation[c][j] = valid ? src[s]->orientation[c][i + j] : (c == 0 ? 1.0f : 0.0f);
+                    for (size_t c = 0; c < 3; ++c)
+                    {
+                        t[s].position[c][j] = valid ? src[s]->position[c][i + j] : 0.0f;
+                        t[s].scale[c][j] = valid ? src[s]->scale[c][i + j] : 1.0f;
+                    }
+                }
+            }
+
+            ConcatenateTransforms_SSE<false>::apply(t[0], t[1], t[2], 0);
+
+            for (size_t j = 0; j < numLeft; ++j)
+            {
+                for (size_t c = 0; c < 4; ++c)
+                    derived.orientation[c][i + j] = t[2].orientation[c][j];
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    derived.position[c][i + j] = t[2].position[c][j];
+                    derived.scale[c][i + j] = t[2].scale[c][j];
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    static FORCEINLINE bool _isAlignedForSSE(const OptimisedUtil::BoundsSoA& b)
+    {
+        return _isAlignedForSSE(b.centre[0]) && _isAlignedForSSE(b.centre[1]) &&
+               _isAlignedForSSE(b.centre[2]) && _isAlignedForSSE(b.halfSize[0]) &&
+               _isAlignedForSSE(b.halfSize[1]) && _isAlignedForSSE(b.halfSize[2]);
+    }
+    //---------------------------------------------------------------------
+    // Test four boxes against the planes, returning a mask with a bit set for
+    // each box culled. Mirrors Plane::getSide(centre, halfSize) exactly.
+    template <bool aligned>
+    struct CullAxisAlignedBoxes_SSE
+    {
+        static FORCEINLINE int apply(
+            const Plane* planes,
+            size_t numPlanes,
+            const OptimisedUtil::BoundsSoA& boxes,
+            size_t i)
+        {
+            typedef SSEMemoryAccessor<aligned> Accessor;
+
+            __m128 cx = Accessor::load(boxes.centre[0] + i);
+            __m128 cy = Accessor::load(boxes.centre[1] + i);
+            __m128 cz = Accessor::load(boxes.centre[2] + i);
+            __m128 hx = Accessor::load(boxes.halfSize[0] + i);
+            __m128 hy = Accessor::load(boxes.halfSize[1] + i);
+            __m128 hz = Accessor::load(boxes.halfSize[2] + i);
+
+            const __m128 signMask = _mm_load_ps1(&msSignMask);
+            __m128 culled = _mm_setzero_ps();
+            int mask = 0;
+
+            for (size_t p = 0; p < numPlanes; ++p)
+            {
+                const Plane& plane = planes[p];
+                __m128 nx = _mm_load_ps1(&plane.normal.x);
+                __m128 ny = _mm_load_ps1(&plane.normal.y);
+                __m128 nz = _mm_load_ps1(&plane.normal.z);
+                __m128 d = _mm_load_ps1(&plane.d);
+
+                // Distance between box centre and the plane
+                __m128 dist = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                    _mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_mul_ps(nz, cz)), d);
+
+                // Maximum absolute distance of the box corners from its centre
+                __m128 maxAbsDist = _mm_add_ps(_mm_add_ps(
+                    _mm_andnot_ps(signMask, _mm_mul_ps(nx, hx)),
+                    _mm_andnot_ps(signMask, _mm_mul_ps(ny, hy))),
+                    _mm_andnot_ps(signMask, _mm_mul_ps(nz, hz)));
+
+                culled = _mm_or_ps(culled,
+                    _mm_cmplt_ps(dist, _mm_xor_ps(maxAbsDist, signMask)));
+
+                // Early out once all four are culled
+                mask = _mm_movemask_ps(culled);
+                if (mask == 0xF)
+                    break;
+            }
+
+            return mask;
+        }
+
+        static const float msSignMask;
+    };
+    template <bool aligned>
+    const float CullAxisAlignedBoxes_SSE<aligned>::msSignMask = -0.0f;
+    //---------------------------------------------------------------------
+    void OptimisedUtilSSE::cullAxisAlignedBoxes(
+        const Plane* planes,
+        size_t numPlanes,
+        const BoundsSoA& boxes,
+        uchar* visible,
+        size_t numBoxes)
+    {
+        __OGRE_CHECK_STACK_ALIGNED_FOR_SSE();
+
+        size_t numIterations = numBoxes / 4;
+        size_t i = 0;
+        int mask;
+
+        if (_isAlignedForSSE(boxes))
+        {
+            for (size_t iter = 0; iter < numIterations; ++iter, i += 4)
+            {
+                mask = CullAxisAlignedBoxes_SSE<true>::apply(planes, numPlanes, boxes, i);
+                visible[i + 0] = !(mask & 1);
+                visible[i + 1] = !(mask & 2);
+                visible[i + 2] = !(mask & 4);
+                visible[i + 3] = !(mask & 8);
+            }
+        }
+        else
+        {
+            for (size_t iter = 0; iter < numIterations; ++iter, i += 4)
+            {
+                mask = CullAxisAlignedBoxes_SSE<false>::apply(planes, numPlanes, boxes, i);
+                visible[i + 0] = !(mask & 1);
+                visible[i + 1] = !(mask & 2);
+                visible[i + 2] = !(mask & 4);
+                visible[i + 3] = !(mask & 8);
+            }
+        }
+
+        // Handle the remaining boxes through a temporary block
+        size_t numLeft = numBoxes - i;
+        if (numLeft)
+        {
+            float temp[6][4] = { { 0 } };
+            BoundsSoA t;
+            for (size_t c = 0; c < 3; ++c)
+            {
+                t.centre[c] = temp[c];
+                t.halfSize[c] = temp[3 + c];
+                for (size_t j = 0; j < numLeft; ++j)
+                {
+                    temp[c][j] = boxes.centre[c][i + j];
+                    temp[3 + c][j] = boxes.halfSize[c][i + j];
+                }
+            }
+
+            mask = CullAxisAlignedBoxes_SSE<false>::apply(planes, numPlanes, t, 0);
+            for (size_t j = 0; j < numLeft; ++j)
+                visible[i + j] = !(mask & (1 << j));
+        }
+    }
+    //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     extern OptimisedUtil* _getOptimisedUtilSSE(void)
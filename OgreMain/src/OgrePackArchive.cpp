@@ -0,0 +1,674 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgrePackArchive.h"
+
+#include "OgreException.h"
+#include "OgreStringVector.h"
+#include "OgreStringConverter.h"
+#include "OgreParallelTaskGroup.h"
+
+#include <zlib.h>
+#include <fstream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace Ogre {
+
+	const uint32 PackArchive::MAGIC = 0x4B41504F;
+	const uint32 PackArchive::VERSION = 1;
+	size_t PackArchive::ms_ParallelThreshold = 256 * 1024;
+
+	//-----------------------------------------------------------------------
+	/** Decompresses a range of the blocks of a file. */
+	class PackArchive::DecompressTask : public ParallelTaskGroup::Task
+	{
+	public:
+		const PackArchive* archive;
+		const Entry* entry;
+		uint32 first;
+		uint32 count;
+		uchar* dest;
+		bool ok;
+
+		DecompressTask(const PackArchive* a, const Entry* e, uint32 f, uint32 c, uchar* d)
+			: archive(a), entry(e), first(f), count(c), dest(d), ok(false) {}
+
+		void execute(void)
+		{
+			ok = archive->decompressBlocks(*entry, first, count, dest);
+		}
+	};
+	//-----------------------------------------------------------------------
+	/// Get a name character as it is compared and hashed
+	static inline uchar normaliseNameChar(char c)
+	{
+		if (c == '\\')
+			return '/';
+		return static_cast<uchar>(tolower(static_cast<uchar>(c)));
+	}
+	//-----------------------------------------------------------------------
+	static bool namesEqual(const char* packName, uint32 packLength, const String& name)
+	{
+		if (packLength != name.length())
+			return false;
+		for (uint32 i = 0; i < packLength; ++i)
+		{
+			if (normaliseNameChar(packName[i]) != normaliseNameChar(name[i]))
+				return false;
+		}
+		return true;
+	}
+	//-----------------------------------------------------------------------
+	static uint32 getNumBuckets(size_t numEntries)
+	{
+		// Keep the table at most half full, and the entry table 8 byte aligned
+		uint32 numBuckets = 2;
+		while (numBuckets < numEntries * 2)
+			numBuckets <<= 1;
+		return numBuckets;
+	}
+	//-----------------------------------------------------------------------
+	PackArchive::PackArchive(const String& name, const String& archType )
+		: Archive(name, archType), mData(0), mHeader(0), mBuckets(0), mEntries(0), 
+		mBlocks(0), mNames(0), mTaskGroup(0)
+	{
+	}
+	//-----------------------------------------------------------------------
+	PackArchive::~PackArchive()
+	{
+		unload();
+	}
+	//-----------------------------------------------------------------------
+	uint32 PackArchive::hashName(const String& name)
+	{
+		// FNV-1a
+		uint32 hash = 2166136261U;
+		for (String::const_iterator i = name.begin(); i != name.end(); ++i)
+		{
+			hash ^= normaliseNameChar(*i);
+			hash *= 16777619U;
+		}
+		return hash;
+	}
+	//-----------------------------------------------------------------------
+	void PackArchive::load()
+	{
+		if (!mMapping.isNull())
+			return;
+
+		mMapping = DataStreamPtr(OGRE_NEW MappedFileDataStream(mName, mName));
+		try
+		{
+			mData = mMapping->getSharedMemory();
+			uint64 fileSize = mMapping->size();
+			if (fileSize < sizeof(Header))
+				throwCorrupt("file is too small");
+
+			mHeader = reinterpret_cast<const Header*>(mData);
+			if (mHeader->magic != MAGIC)
+				throwCorrupt("not a pack file, or wrong byte order");
+			if (mHeader->version != VERSION)
+				throwCorrupt("unsupported version " + StringConverter::toString(mHeader->version));
+			if (mHeader->numBuckets < 2 || (mHeader->numBuckets & (mHeader->numBuckets - 1)) ||
+				mHeader->numBuckets < mHeader->numEntries || !mHeader->blockSize ||
+				(mHeader->tableOffset & 7))
+				throwCorrupt("invalid header");
+
+			uint64 tableSize = 
+				static_cast<uint64>(mHeader->numBuckets) * sizeof(Bucket) + 
+				static_cast<uint64>(mHeader->numEntries) * sizeof(Entry) + 
+				static_cast<uint64>(mHeader->numBlocks) * sizeof(Block) + 
+				mHeader->namesSize;
+			if (mHeader->tableOffset < sizeof(Header) || 
+				mHeader->tableOffset + tableSize > fileSize)
+				throwCorrupt("tables are outside the file");
+
+			const uchar* tables = mData + mHeader->tableOffset;
+			mBuckets = reinterpret_cast<const Bucket*>(tables);
+			mEntries = reinterpret_cast<const Entry*>(mBuckets + mHeader->numBuckets);
+			mBlocks = reinterpret_cast<const Block*>(mEntries + mHeader->numEntries);
+			mNames = reinterpret_cast<const char*>(mBlocks + mHeader->numBlocks);
+
+			for (uint32 b = 0; b < mHeader->numBuckets; ++b)
+			{
+				if (mBuckets[b].entry > mHeader->numEntries)
+					throwCorrupt("invalid name table");
+			}
+
+			// Check the entries once here, so that open() can trust them
+			set<String>::type dirs;
+			mFileList.reserve(mHeader->numEntries);
+			for (uint32 e = 0; e < mHeader->numEntries; ++e)
+			{
+				const Entry& entry = mEntries[e];
+				uint32 numBlocks = getNumBlocks(entry);
+				if (static_cast<uint64>(entry.nameOffset) + entry.nameLength >= mHeader->namesSize ||
+					static_cast<uint64>(entry.firstBlock) + numBlocks > mHeader->numBlocks ||
+					entry.dataOffset < sizeof(Header) ||
+					entry.dataOffset + entry.compressedSize > mHeader->tableOffset)
+					throwCorrupt("invalid entry " + StringConverter::toString(e));
+
+				uint64 compressedSize = 0;
+				for (uint32 b = 0; b < numBlocks; ++b)
+					compressedSize += mBlocks[entry.firstBlock + b].compressedSize;
+				if (compressedSize != entry.compressedSize)
+					throwCorrupt("invalid entry " + StringConverter::toString(e));
+
+				FileInfo info;
+				info.archive = this;
+				info.filename.assign(mNames + entry.nameOffset, entry.nameLength);
+				StringUtil::splitFilename(info.filename, info.basename, info.path);
+				info.compressedSize = entry.compressedSize;
+				info.uncompressedSize = entry.size;
+				mFileList.push_back(info);
+
+				// Note the folders this file is in
+				String path = info.path;
+				while (!path.empty() && dirs.insert(path).second)
+				{
+					String::size_type pos = path.find_last_of('/', path.length() - 2);
+					path = pos == String::npos ? StringUtil::BLANK : path.substr(0, pos + 1);
+				}
+			}
+
+			// List folders as the zip archive does
+			for (set<String>::type::iterator d = dirs.begin(); d != dirs.end(); ++d)
+			{
+				FileInfo info;
+				info.archive = this;
+				info.filename = d->substr(0, d->length() - 1);
+				StringUtil::splitFilename(info.filename, info.basename, info.path);
+				info.compressedSize = size_t(-1);
+				info.uncompressedSize = 0;
+				mFileList.push_back(info);
+			}
+		}
+		catch (...)
+		{
+			unload();
+			throw;
+		}
+
+		mTaskGroup = OGRE_NEW ParallelTaskGroup("PackArchive/" + mName);
+	}
+	//-----------------------------------------------------------------------
+	void PackArchive::unload()
+	{
+		OGRE_DELETE mTaskGroup;
+		mTaskGroup = 0;
+		mFileList.clear();
+		mData = 0;
+		mHeader = 0;
+		mBuckets = 0;
+		mEntries = 0;
+		mBlocks = 0;
+		mNames = 0;
+		mMapping.setNull();
+	}
+	//-----------------------------------------------------------------------
+	uint32 PackArchive::getNumBlocks(const Entry& entry) const
+	{
+		return static_cast<uint32>(
+			(static_cast<uint64>(entry.size) + mHeader->blockSize - 1) / mHeader->blockSize);
+	}
+	//-----------------------------------------------------------------------
+	const PackArchive::Entry* PackArchive::findEntry(const String& filename) const
+	{
+		if (!mHeader)
+			return 0;
+
+		uint32 hash = hashName(filename);
+		uint32 mask = mHeader->numBuckets - 1;
+		for (uint32 b = hash & mask, probes = 0; probes < mHeader->numBuckets; 
+			b = (b + 1) & mask, ++probes)
+		{
+			const Bucket& bucket = mBuckets[b];
+			if (!bucket.entry)
+				break;
+			if (bucket.hash == hash)
+			{
+				const Entry& entry = mEntries[bucket.entry - 1];
+				if (namesEqual(mNames + entry.nameOffset, entry.nameLength, filename))
+					return &entry;
+			}
+		}
+		return 0;
+	}
+	//-----------------------------------------------------------------------
+	bool PackArchive::decompressBlocks(const Entry& entry, uint32 first, uint32 count, 
+		uchar* dest) const
+	{
+		const Block* blocks = mBlocks + entry.firstBlock;
+		const uchar* src = mData + entry.dataOffset;
+		for (uint32 b = 0; b < first; ++b)
+			src += blocks[b].compressedSize;
+
+		for (uint32 b = first; b < first + count; ++b)
+		{
+			size_t offset = static_cast<size_t>(b) * mHeader->blockSize;
+			size_t size = std::min(static_cast<size_t>(mHeader->blockSize), entry.size - offset);
+			switch (blocks[b].method)
+			{
+			case CM_STORED:
+				if (blocks[b].compressedSize != size)
+					return false;
+				memcpy(dest + offset, src, size);
+				break;
+			case CM_DEFLATE:
+				{
+					uLongf destLen = static_cast<uLongf>(size);
+					if (uncompress(dest + offset, &destLen, src, blocks[b].compressedSize) != Z_OK ||
+						destLen != size)
+						return false;
+				}
+				break;
+			default:
+				return false;
+			}
+			src += blocks[b].compressedSize;
+		}
+		return true;
+	}
+	//-----------------------------------------------------------------------
+	bool PackArchive::decompressEntry(const Entry& entry, uchar* dest) const
+	{
+		uint32 numBlocks = getNumBlocks(entry);
+		if (numBlocks < 2 || entry.size < ms_ParallelThreshold)
+			return decompressBlocks(entry, 0, numBlocks, dest);
+
+		// One group serves the whole archive; other threads opening large
+		// files at the same time wait, since the cores are busy anyway
+		OGRE_LOCK_MUTEX(mTaskGroupMutex)
+
+		// A few tasks per thread evens out blocks which decompress slowly
+		uint32 numTasks = static_cast<uint32>(
+			std::min(static_cast<size_t>(numBlocks), mTaskGroup->getMaxConcurrency() * 4));
+		vector<DecompressTask>::type tasks;
+		tasks.reserve(numTasks);
+		uint32 first = 0;
+		for (uint32 t = 0; t < numTasks; ++t)
+		{
+			uint32 end = static_cast<uint32>(static_cast<uint64>(numBlocks) * (t + 1) / numTasks);
+			tasks.push_back(DecompressTask(this, &entry, first, end - first, dest));
+			first = end;
+		}
+		for (vector<DecompressTask>::type::iterator t = tasks.begin(); t != tasks.end(); ++t)
+			mTaskGroup->addTask(&(*t));
+		mTaskGroup->run();
+
+		for (vector<DecompressTask>::type::iterator t = tasks.begin(); t != tasks.end(); ++t)
+		{
+			if (!t->ok)
+				return false;
+		}
+		return true;
+	}
+	//-----------------------------------------------------------------------
+	DataStreamPtr PackArchive::open(const String& filename, bool readOnly) const
+	{
+		const Entry* entry = findEntry(filename);
+		if (!entry)
+		{
+			OGRE_EXCEPT(Exception::ERR_FILE_NOT_FOUND,
+				"Cannot open file: " + filename + " in " + mName,
+				"PackArchive::open");
+		}
+
+		const uchar* src = mData + entry->dataOffset;
+		bool stored = true;
+		uint32 numBlocks = getNumBlocks(*entry);
+		for (uint32 b = 0; b < numBlocks && stored; ++b)
+			stored = mBlocks[entry->firstBlock + b].method == CM_STORED;
+
+		// Stored files are read straight from the mapping, which the stream 
+		// keeps open even if the archive is unloaded
+		if (stored && readOnly && entry->compressedSize == entry->size)
+		{
+			return DataStreamPtr(OGRE_NEW MemoryDataStream(filename, 
+				mMapping, src, entry->size));
+		}
+
+		uchar* data = OGRE_ALLOC_T(uchar, entry->size, MEMCATEGORY_GENERAL);
+		if (!decompressEntry(*entry, data))
+		{
+			OGRE_FREE(data, MEMCATEGORY_GENERAL);
+			throwCorrupt("error decompressing " + filename);
+		}
+		return DataStreamPtr(OGRE_NEW MemoryDataStream(filename, 
+			data, entry->size, true, readOnly));
+	}
+	//---------------------------------------------------------------------
+	DataStreamPtr PackArchive::create(const String& filename) const
+	{
+		OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED, 
+			"Modification of pack archives is not supported, use PackArchiveWriter", 
+			"PackArchive::create");
+
+	}
+	//---------------------------------------------------------------------
+	void PackArchive::remove(const String& filename) const
+	{
+	}
+	//-----------------------------------------------------------------------
+	StringVectorPtr PackArchive::list(bool recursive, bool dirs)
+	{
+		StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+
+		FileInfoList::iterator i, iend;
+		iend = mFileList.end();
+		for (i = mFileList.begin(); i != iend; ++i)
+			if ((dirs == (i->compressedSize == size_t (-1))) &&
+				(recursive || i->path.empty()))
+				ret->push_back(i->filename);
+
+		return ret;
+	}
+	//-----------------------------------------------------------------------
+	FileInfoListPtr PackArchive::listFileInfo(bool recursive, bool dirs)
+	{
+		FileInfoList* fil = OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)();
+		FileInfoList::const_iterator i, iend;
+		iend = mFileList.end();
+		for (i = mFileList.begin(); i != iend; ++i)
+			if ((dirs == (i->compressedSize == size_t (-1))) &&
+				(recursive || i->path.empty()))
+				fil->push_back(*i);
+
+		return FileInfoListPtr(fil, SPFM_DELETE_T);
+	}
+	//-----------------------------------------------------------------------
+	StringVectorPtr PackArchive::find(const String& pattern, bool recursive, bool dirs)
+	{
+		StringVectorPtr ret = StringVectorPtr(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+		// If pattern contains a directory name, do a full match
+		bool full_match = (pattern.find ('/') != String::npos) ||
+						  (pattern.find ('\\') != String::npos);
+
+		FileInfoList::iterator i, iend;
+		iend = mFileList.end();
+		for (i = mFileList.begin(); i != iend; ++i)
+			if ((dirs == (i->compressedSize == size_t (-1))) &&
+				(recursive || full_match || i->path.empty()))
+				// Check basename matches pattern (pack is case insensitive)
+				if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+					ret->push_back(i->filename);
+
+		return ret;
+	}
+	//-----------------------------------------------------------------------
+	FileInfoListPtr PackArchive::findFileInfo(const String& pattern, 
+		bool recursive, bool dirs)
+	{
+		FileInfoListPtr ret = FileInfoListPtr(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+		// If pattern contains a directory name, do a full match
+		bool full_match = (pattern.find ('/') != String::npos) ||
+						  (pattern.find ('\\') != String::npos);
+
+		FileInfoList::iterator i, iend;
+		iend = mFileList.end();
+		for (i = mFileList.begin(); i != iend; ++i)
+			if ((dirs == (i->compressedSize == size_t (-1))) &&
+				(recursive || full_match || i->path.empty()))
+				// Check name matches pattern (pack is case insensitive)
+				if (StringUtil::match(full_match ? i->filename : i->basename, pattern, false))
+					ret->push_back(*i);
+
+		return ret;
+	}
+	//-----------------------------------------------------------------------
+	bool PackArchive::exists(const String& filename)
+	{
+		return findEntry(filename) != 0;
+	}
+	//---------------------------------------------------------------------
+	time_t PackArchive::getModifiedTime(const String& filename)
+	{
+		const Entry* entry = findEntry(filename);
+		if (entry && entry->modifiedTime)
+			return static_cast<time_t>(entry->modifiedTime);
+
+		// Fall back on the mod time of the pack itself
+		struct stat tagStat;
+		if (stat(mName.c_str(), &tagStat) == 0)
+			return tagStat.st_mtime;
+		else
+			return 0;
+	}
+	//-----------------------------------------------------------------------
+	void PackArchive::throwCorrupt(const String& reason) const
+	{
+		OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+			mName + " is not a valid pack file: " + reason,
+			"PackArchive");
+	}
+	//-----------------------------------------------------------------------
+	const String& PackArchiveFactory::getType(void) const
+	{
+		static String name = "Pack";
+		return name;
+	}
+	//-----------------------------------------------------------------------
+	//-----------------------------------------------------------------------
+	PackArchiveWriter::PackArchiveWriter(uint32 blockSize, int compressionLevel)
+		: mBlockSize(blockSize ? blockSize : 65536)
+		, mCompressionLevel(compressionLevel)
+	{
+	}
+	//-----------------------------------------------------------------------
+	void PackArchiveWriter::addFile(const String& name, const DataStreamPtr& stream, 
+		time_t modifiedTime)
+	{
+		PendingFile file;
+		file.name = name;
+		file.stream = stream;
+		file.archive = 0;
+		file.modifiedTime = modifiedTime;
+		mFiles.push_back(file);
+	}
+	//-----------------------------------------------------------------------
+	void PackArchiveWriter::addFile(const String& name, Archive* archive, 
+		const String& filename)
+	{
+		PendingFile file;
+		file.name = name;
+		file.archive = archive;
+		file.sourceName = filename;
+		file.modifiedTime = 0;
+		mFiles.push_back(file);
+	}
+	//-----------------------------------------------------------------------
+	size_t PackArchiveWriter::addArchive(Archive* archive, const String& prefix)
+	{
+		FileInfoListPtr files = archive->listFileInfo(true, false);
+		for (FileInfoList::iterator i = files->begin(); i != files->end(); ++i)
+			addFile(prefix + i->filename, archive, i->filename);
+		return files->size();
+	}
+	//-----------------------------------------------------------------------
+	uint64 PackArchiveWriter::write(const String& fileName)
+	{
+		typedef PackArchive::Header Header;
+		typedef PackArchive::Bucket Bucket;
+		typedef PackArchive::Entry Entry;
+		typedef PackArchive::Block Block;
+
+		// Build the name table first, so that duplicates are found before 
+		// anything is written
+		uint32 numBuckets = getNumBuckets(mFiles.size());
+		vector<Bucket>::type buckets(numBuckets);
+		memset(&buckets[0], 0, numBuckets * sizeof(Bucket));
+		for (size_t f = 0; f < mFiles.size(); ++f)
+		{
+			uint32 hash = PackArchive::hashName(mFiles[f].name);
+			uint32 b = hash & (numBuckets - 1);
+			while (buckets[b].entry)
+			{
+				const String& other = mFiles[buckets[b].entry - 1].name;
+				if (buckets[b].hash == hash && 
+					namesEqual(other.c_str(), static_cast<uint32>(other.length()), mFiles[f].name))
+				{
+					OGRE_EXCEPT(Exception::ERR_DUPLICATE_ITEM,
+						"File " + mFiles[f].name + " has been added more than once",
+						"PackArchiveWriter::write");
+				}
+				b = (b + 1) & (numBuckets - 1);
+			}
+			buckets[b].hash = hash;
+			buckets[b].entry = static_cast<uint32>(f + 1);
+		}
+
+		std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary);
+		if (!out)
+		{
+			OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+				"Cannot open " + fileName + " for writing",
+				"PackArchiveWriter::write");
+		}
+
+		Header header;
+		memset(&header, 0, sizeof(Header));
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+		vector<Entry>::type entries;
+		entries.reserve(mFiles.size());
+		vector<Block>::type blocks;
+		String names;
+		vector<uchar>::type raw(mBlockSize);
+		vector<uchar>::type packed(compressBound(mBlockSize));
+		uint64 offset = sizeof(Header);
+		uint64 totalCompressed = 0;
+
+		for (PendingFileList::iterator f = mFiles.begin(); f != mFiles.end(); ++f)
+		{
+			DataStreamPtr stream = f->stream;
+			time_t modifiedTime = f->modifiedTime;
+			if (f->archive)
+			{
+				stream = f->archive->open(f->sourceName);
+				modifiedTime = f->archive->getModifiedTime(f->sourceName);
+			}
+
+			Entry entry;
+			entry.nameOffset = static_cast<uint32>(names.size());
+			entry.nameLength = static_cast<uint32>(f->name.length());
+			entry.dataOffset = offset;
+			entry.size = 0;
+			entry.compressedSize = 0;
+			entry.firstBlock = static_cast<uint32>(blocks.size());
+			entry.modifiedTime = static_cast<uint32>(modifiedTime);
+			names.append(f->name);
+			names.push_back('\0');
+
+			while (true)
+			{
+				// Fill a whole block, only the last one of a file may be short
+				size_t size = 0;
+				while (size < mBlockSize)
+				{
+					size_t count = stream->read(&raw[size], mBlockSize - size);
+					if (!count)
+						break;
+					size += count;
+				}
+				if (!size)
+					break;
+				if (static_cast<uint64>(entry.size) + size > 0xFFFFFFFFULL)
+				{
+					OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+						"File " + f->name + " is too large for a pack file",
+						"PackArchiveWriter::write");
+				}
+
+				Block block;
+				block.method = PackArchive::CM_STORED;
+				block.compressedSize = static_cast<uint32>(size);
+				const uchar* data = &raw[0];
+				if (mCompressionLevel > 0)
+				{
+					// Keep the block stored unless compression gains something
+					uLongf packedSize = static_cast<uLongf>(packed.size());
+					if (compress2(&packed[0], &packedSize, &raw[0], 
+							static_cast<uLong>(size), mCompressionLevel) == Z_OK &&
+						packedSize < size)
+					{
+						block.method = PackArchive::CM_DEFLATE;
+						block.compressedSize = static_cast<uint32>(packedSize);
+						data = &packed[0];
+					}
+				}
+				out.write(reinterpret_cast<const char*>(data), block.compressedSize);
+				blocks.push_back(block);
+
+				entry.size += static_cast<uint32>(size);
+				entry.compressedSize += block.compressedSize;
+				offset += block.compressedSize;
+				if (size < mBlockSize)
+					break;
+			}
+
+			totalCompressed += entry.compressedSize;
+			entries.push_back(entry);
+		}
+
+		// Align the tables, so that they can be used in place
+		while (offset & 7)
+		{
+			out.put(0);
+			++offset;
+		}
+
+		header.magic = PackArchive::MAGIC;
+		header.version = PackArchive::VERSION;
+		header.numEntries = static_cast<uint32>(entries.size());
+		header.numBuckets = numBuckets;
+		header.numBlocks = static_cast<uint32>(blocks.size());
+		header.blockSize = mBlockSize;
+		header.namesSize = static_cast<uint32>(names.size());
+		header.tableOffset = offset;
+
+		out.write(reinterpret_cast<const char*>(&buckets[0]), numBuckets * sizeof(Bucket));
+		if (!entries.empty())
+			out.write(reinterpret_cast<const char*>(&entries[0]), entries.size() * sizeof(Entry));
+		if (!blocks.empty())
+			out.write(reinterpret_cast<const char*>(&blocks[0]), blocks.size() * sizeof(Block));
+		out.write(names.c_str(), names.size());
+		out.seekp(0);
+		out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+		if (!out)
+		{
+			OGRE_EXCEPT(Exception::ERR_CANNOT_WRITE_TO_FILE,
+				"Error writing " + fileName,
+				"PackArchiveWriter::write");
+		}
+		return totalCompressed;
+	}
+
+}
@@ -0,0 +1,448 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgrePackedTransformTrack.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgreMath.h"
+#include "OgreException.h"
+
+namespace Ogre {
+
+	namespace {
+		/// The smallest three components of a unit quaternion lie within +/- this
+		const Real ROTATION_RANGE = 0.707106781f;
+		/// Number of reference samples taken per key of the source track
+		const size_t FIT_SAMPLES_PER_KEY = 4;
+
+		// Helpers which let the curve fitting treat every channel alike
+		struct VectorChannelOps
+		{
+			static Vector3 interpolate(Real t, const Vector3& a, const Vector3& b, bool)
+			{
+				return a + (b - a) * t;
+			}
+			static Real error(const Vector3& a, const Vector3& b)
+			{
+				return a.distance(b);
+			}
+		};
+		struct RotationChannelOps
+		{
+			static Quaternion interpolate(Real t, const Quaternion& a, const Quaternion& b,
+				bool spherical)
+			{
+				return spherical ? Quaternion::Slerp(t, a, b, true) :
+					Quaternion::nlerp(t, a, b, true);
+			}
+			static Real error(const Quaternion& a, const Quaternion& b)
+			{
+				// Angle between the rotations, from the chord between the unit
+				// quaternions since acos of their dot product is too imprecise
+				// for small angles
+				Quaternion na = a * (1.0f / Math::Sqrt(a.Norm()));
+				Quaternion nb = b * (1.0f / Math::Sqrt(b.Norm()));
+				Quaternion d = na.Dot(nb) < 0.0f ? na + nb : na - nb;
+				Real halfChord = Math::Sqrt(d.Norm()) * 0.5f;
+				return halfChord >= 1.0f ? Math::PI * 2.0f : 
+					4.0f * Math::ASin(halfChord).valueRadians();
+			}
+		};
+
+		/** Choose the keys needed to reproduce the reference samples.
+		@param times Time of each reference sample
+		@param samples Reference samples
+		@param keys Reference samples as they will be after quantisation
+		@param tolerance Maximum error
+		@param spherical Whether rotations are interpolated spherically
+		@param kept Receives the indexes of the samples to keep as keys
+		*/
+		template <typename T, typename Ops>
+		void fitKeys(const vector<Real>::type& times, const typename vector<T>::type& samples,
+			const typename vector<T>::type& keys, Real tolerance, bool spherical, 
+			vector<size_t>::type& kept)
+		{
+			size_t numSamples = samples.size();
+			kept.clear();
+
+			// A constant channel only needs one key
+			bool constant = true;
+			for (size_t s = 0; s < numSamples && constant; ++s)
+			{
+				constant = Ops::error(keys[0], samples[s]) <= tolerance;
+			}
+			kept.push_back(0);
+			if (constant)
+				return;
+
+			// Greedily extend each span for as long as the samples it covers 
+			// can be interpolated from its ends; the last sample is always kept
+			// so that wrapping around to the first behaves as before
+			size_t start = 0;
+			while (start + 1 < numSamples)
+			{
+				size_t end = start + 1;
+				while (end + 1 < numSamples)
+				{
+					size_t candidate = end + 1;
+					Real span = times[candidate] - times[start];
+					bool fits = true;
+					for (size_t s = start + 1; s < candidate && fits; ++s)
+					{
+						Real t = span > 0 ? (times[s] - times[start]) / span : 0;
+						T v = Ops::interpolate(t, keys[start], keys[candidate], spherical);
+						fits = Ops::error(v, samples[s]) <= tolerance;
+					}
+					if (!fits)
+						break;
+					end = candidate;
+				}
+				kept.push_back(end);
+				start = end;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	PackedTransformTrack::PackedTransformTrack()
+	{
+		for (int c = 0; c < CT_COUNT; ++c)
+		{
+			mChannels[c].base = Vector3::ZERO;
+			mChannels[c].range = Vector3::ZERO;
+		}
+	}
+	//---------------------------------------------------------------------
+	void PackedTransformTrack::build(const NodeAnimationTrack* track, 
+		Real translationTolerance, const Radian& rotationTolerance, Real scaleTolerance)
+	{
+		unsigned short numKeys = track->getNumKeyFrames();
+		if (!numKeys)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Cannot pack a track which has no keyframes.",
+				"PackedTransformTrack::build");
+		}
+		bool spherical = track->getParent()->getRotationInterpolationMode() == 
+			Animation::RIM_SPHERICAL;
+
+		// Sample the source track at its keys and in between, so that keys
+		// can be placed where a spline interpolated track needs them
+		vector<Real>::type sampleTimes;
+		sampleTimes.reserve(numKeys * FIT_SAMPLES_PER_KEY);
+		for (unsigned short k = 0; k < numKeys; ++k)
+		{
+			Real t = track->getNodeKeyFrame(k)->getTime();
+			sampleTimes.push_back(t);
+			if (k + 1 < numKeys)
+			{
+				Real next = track->getNodeKeyFrame(k + 1)->getTime();
+				for (size_t s = 1; s < FIT_SAMPLES_PER_KEY; ++s)
+				{
+					sampleTimes.push_back(t + (next - t) * s / FIT_SAMPLES_PER_KEY);
+				}
+			}
+		}
+		size_t numSamples = sampleTimes.size();
+
+		vector<Vector3>::type translateSamples, scaleSamples;
+		vector<Quaternion>::type rotateSamples;
+		translateSamples.reserve(numSamples);
+		scaleSamples.reserve(numSamples);
+		rotateSamples.reserve(numSamples);
+		for (size_t s = 0; s < numSamples; ++s)
+		{
+			TransformKeyFrame kf(0, sampleTimes[s]);
+			track->getInterpolatedKeyFrame(TimeIndex(sampleTimes[s]), &kf);
+			translateSamples.push_back(kf.getTranslate());
+			rotateSamples.push_back(kf.getRotation());
+			scaleSamples.push_back(kf.getScale());
+		}
+
+		// Quantisation ranges
+		Channel& trans = mChannels[CT_TRANSLATE];
+		Channel& rot = mChannels[CT_ROTATE];
+		Channel& scl = mChannels[CT_SCALE];
+		Vector3 transMax, scaleMax;
+		trans.base = transMax = translateSamples[0];
+		scl.base = scaleMax = scaleSamples[0];
+		for (size_t s = 1; s < numSamples; ++s)
+		{
+			trans.base.makeFloor(translateSamples[s]);
+			transMax.makeCeil(translateSamples[s]);
+			scl.base.makeFloor(scaleSamples[s]);
+			scaleMax.makeCeil(scaleSamples[s]);
+		}
+		trans.range = transMax - trans.base;
+		scl.range = scaleMax - scl.base;
+		rot.base = rot.range = Vector3::ZERO;
+
+		// Sample values as they will be once quantised
+		vector<uint16>::type transValues(numSamples * 3), rotValues(numSamples * 3), 
+			scaleValues(numSamples * 3);
+		vector<Vector3>::type transKeys, scaleKeys;
+		vector<Quaternion>::type rotKeys;
+		transKeys.reserve(numSamples);
+		scaleKeys.reserve(numSamples);
+		rotKeys.reserve(numSamples);
+		for (size_t s = 0; s < numSamples; ++s)
+		{
+			uint16* v = &transValues[s * 3];
+			packVector(translateSamples[s], trans.base, trans.range, v);
+			transKeys.push_back(trans.base + trans.range * 
+				Vector3(v[0], v[1], v[2]) / 65535.0f);
+			v = &scaleValues[s * 3];
+			packVector(scaleSamples[s], scl.base, scl.range, v);
+			scaleKeys.push_back(scl.base + scl.range * 
+				Vector3(v[0], v[1], v[2]) / 65535.0f);
+			v = &rotValues[s * 3];
+			packRotation(rotateSamples[s], v);
+			rotKeys.push_back(unpackRotation(v));
+		}
+
+		// Fit each channel and copy out the keys it needs
+		vector<size_t>::type kept;
+		for (int c = 0; c < CT_COUNT; ++c)
+		{
+			const vector<uint16>::type* values;
+			switch (c)
+			{
+			case CT_TRANSLATE:
+				fitKeys<Vector3, VectorChannelOps>(sampleTimes, translateSamples, 
+					transKeys, translationTolerance, spherical, kept);
+				values = &transValues;
+				break;
+			case CT_ROTATE:
+				fitKeys<Quaternion, RotationChannelOps>(sampleTimes, rotateSamples, 
+					rotKeys, rotationTolerance.valueRadians(), spherical, kept);
+				values = &rotValues;
+				break;
+			default:
+				fitKeys<Vector3, VectorChannelOps>(sampleTimes, scaleSamples, 
+					scaleKeys, scaleTolerance, spherical, kept);
+				values = &scaleValues;
+				break;
+			}
+
+			Channel& channel = mChannels[c];
+			vector<float>::type times;
+			vector<uint16>::type packed;
+			times.reserve(kept.size());
+			packed.reserve(kept.size() * 3);
+			for (size_t i = 0; i < kept.size(); ++i)
+			{
+				times.push_back(sampleTimes[kept[i]]);
+				packed.insert(packed.end(), values->begin() + kept[i] * 3, 
+					values->begin() + kept[i] * 3 + 3);
+			}
+			channel.times.swap(times);
+			channel.values.swap(packed);
+		}
+	}
+	//---------------------------------------------------------------------
+	void PackedTransformTrack::sample(Real timePos, Real length, 
+		Animation::RotationInterpolationMode rim, TransformKeyFrame* kf) const
+	{
+		while (timePos > length && length > 0.0f)
+		{
+			timePos -= length;
+		}
+
+		size_t k1, k2;
+		Real t = findKeys(mChannels[CT_TRANSLATE], timePos, length, k1, k2);
+		Vector3 base = getVectorKey(CT_TRANSLATE, k1);
+		kf->setTranslate(t == 0.0f ? base : base + (getVectorKey(CT_TRANSLATE, k2) - base) * t);
+
+		t = findKeys(mChannels[CT_ROTATE], timePos, length, k1, k2);
+		if (t == 0.0f)
+		{
+			kf->setRotation(getRotationKey(k1));
+		}
+		else if (rim == Animation::RIM_LINEAR)
+		{
+			kf->setRotation(Quaternion::nlerp(t, getRotationKey(k1), getRotationKey(k2), true));
+		}
+		else //if (rim == Animation::RIM_SPHERICAL)
+		{
+			kf->setRotation(Quaternion::Slerp(t, getRotationKey(k1), getRotationKey(k2), true));
+		}
+
+		t = findKeys(mChannels[CT_SCALE], timePos, length, k1, k2);
+		base = getVectorKey(CT_SCALE, k1);
+		kf->setScale(t == 0.0f ? base : base + (getVectorKey(CT_SCALE, k2) - base) * t);
+	}
+	//---------------------------------------------------------------------
+	Real PackedTransformTrack::findKeys(const Channel& channel, Real timePos, 
+		Real length, size_t& key1, size_t& key2) const
+	{
+		// Same rules as AnimationTrack::getKeyFramesAtTime
+		const vector<float>::type& times = channel.times;
+		vector<float>::type::const_iterator i = 
+			std::lower_bound(times.begin(), times.end(), static_cast<float>(timePos));
+		Real t1, t2;
+		if (i == times.end())
+		{
+			// Wrap from the last key back to the first
+			key1 = times.size() - 1;
+			key2 = 0;
+			t1 = times.back();
+			t2 = length + times.front();
+		}
+		else
+		{
+			key2 = std::distance(times.begin(), i);
+			key1 = (key2 > 0 && timePos < *i) ? key2 - 1 : key2;
+			t1 = times[key1];
+			t2 = *i;
+		}
+
+		if (t1 == t2)
+			return 0.0f;
+		return (timePos - t1) / (t2 - t1);
+	}
+	//---------------------------------------------------------------------
+	Vector3 PackedTransformTrack::getVectorKey(ChannelType type, size_t index) const
+	{
+		const Channel& channel = mChannels[type];
+		const uint16* v = &channel.values[index * 3];
+		return Vector3(
+			channel.base.x + channel.range.x * (v[0] / 65535.0f),
+			channel.base.y + channel.range.y * (v[1] / 65535.0f),
+			channel.base.z + channel.range.z * (v[2] / 65535.0f));
+	}
+	//---------------------------------------------------------------------
+	Quaternion PackedTransformTrack::getRotationKey(size_t index) const
+	{
+		return unpackRotation(&mChannels[CT_ROTATE].values[index * 3]);
+	}
+	//---------------------------------------------------------------------
+	void PackedTransformTrack::getKeyTimes(vector<Real>::type& times) const
+	{
+		times.clear();
+		for (int c = 0; c < CT_COUNT; ++c)
+			times.insert(times.end(), mChannels[c].times.begin(), mChannels[c].times.end());
+		std::sort(times.begin(), times.end());
+		times.erase(std::unique(times.begin(), times.end()), times.end());
+	}
+	//---------------------------------------------------------------------
+	bool PackedTransformTrack::hasNonZeroKeyFrames(void) const
+	{
+		Real tolerance = 1e-3f;
+		for (size_t k = 0; k < getNumKeys(CT_TRANSLATE); ++k)
+		{
+			if (!getVectorKey(CT_TRANSLATE, k).positionEquals(Vector3::ZERO, tolerance))
+				return true;
+		}
+		for (size_t k = 0; k < getNumKeys(CT_SCALE); ++k)
+		{
+			if (!getVectorKey(CT_SCALE, k).positionEquals(Vector3::UNIT_SCALE, tolerance))
+				return true;
+		}
+		for (size_t k = 0; k < getNumKeys(CT_ROTATE); ++k)
+		{
+			Vector3 axis;
+			Radian angle;
+			getRotationKey(k).ToAngleAxis(angle, axis);
+			if (!Math::RealEqual(angle.valueRadians(), 0.0f, tolerance))
+				return true;
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
+	size_t PackedTransformTrack::calculateSize(void) const
+	{
+		size_t size = sizeof(PackedTransformTrack);
+		for (int c = 0; c < CT_COUNT; ++c)
+		{
+			size += mChannels[c].times.capacity() * sizeof(float);
+			size += mChannels[c].values.capacity() * sizeof(uint16);
+		}
+		return size;
+	}
+	//---------------------------------------------------------------------
+	void PackedTransformTrack::packVector(const Vector3& v, const Vector3& base, 
+		const Vector3& range, uint16* values)
+	{
+		for (size_t i = 0; i < 3; ++i)
+		{
+			Real n = range[i] > 0.0f ? (v[i] - base[i]) / range[i] : 0.0f;
+			values[i] = static_cast<uint16>(
+				Math::Clamp(n, Real(0.0f), Real(1.0f)) * 65535.0f + 0.5f);
+		}
+	}
+	//---------------------------------------------------------------------
+	void PackedTransformTrack::packRotation(const Quaternion& rot, uint16* values)
+	{
+		Quaternion q = rot;
+		q.normalise();
+
+		// Drop the largest component, flipping the quaternion if necessary so
+		// that it's positive and can be recovered from the others
+		Real c[4] = { q.w, q.x, q.y, q.z };
+		size_t largest = 0;
+		for (size_t i = 1; i < 4; ++i)
+		{
+			if (Math::Abs(c[i]) > Math::Abs(c[largest]))
+				largest = i;
+		}
+		Real sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+		size_t j = 0;
+		for (size_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			Real n = (c[i] * sign / ROTATION_RANGE + 1.0f) * 0.5f;
+			values[j++] = static_cast<uint16>(
+				Math::Clamp(n, Real(0.0f), Real(1.0f)) * 32767.0f + 0.5f);
+		}
+
+		// Index of the dropped component goes in the top bits
+		values[0] |= static_cast<uint16>((largest & 1) << 15);
+		values[1] |= static_cast<uint16>((largest >> 1) << 15);
+	}
+	//---------------------------------------------------------------------
+	Quaternion PackedTransformTrack::unpackRotation(const uint16* values)
+	{
+		size_t largest = (values[0] >> 15) | ((values[1] >> 15) << 1);
+		Real c[4];
+		Real sum = 0.0f;
+		size_t j = 0;
+		for (size_t i = 0; i < 4; ++i)
+		{
+			if (i == largest)
+				continue;
+			Real v = ((values[j++] & 0x7fff) / 32767.0f * 2.0f - 1.0f) * ROTATION_RANGE;
+			c[i] = v;
+			sum += v * v;
+		}
+		c[largest] = sum < 1.0f ? Math::Sqrt(1.0f - sum) : 0.0f;
+
+		return Quaternion(c[0], c[1], c[2], c[3]);
+	}
+
+}
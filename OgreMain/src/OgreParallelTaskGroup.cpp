@@ -0,0 +1,196 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreRoot.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	ParallelTaskGroup::ParallelTaskGroup(const String& name, WorkQueue* queue)
+		: mName(name)
+		, mQueue(queue)
+		, mRegisteredQueue(0)
+		, mChannel(0)
+		, mMaxConcurrency(1)
+		, mNextTask(0)
+		, mCompletedTasks(0)
+		, mQueuedHelpers(0)
+		, mRunID(0)
+	{
+#if OGRE_THREAD_SUPPORT
+		mMaxConcurrency = OGRE_THREAD_HARDWARE_CONCURRENCY;
+		if (!mMaxConcurrency)
+			mMaxConcurrency = 1;
+#endif
+	}
+	//---------------------------------------------------------------------
+	ParallelTaskGroup::~ParallelTaskGroup()
+	{
+		// Only detach if the queue we registered with is still alive; if Root 
+		// has swapped its queue the old one (and our handlers) are already gone
+		Root* root = Root::getSingletonPtr();
+		if (mRegisteredQueue && 
+			(mQueue || (root && root->getWorkQueue() == mRegisteredQueue)))
+		{
+			mRegisteredQueue->removeRequestHandler(mChannel, this);
+			mRegisteredQueue->removeResponseHandler(mChannel, this);
+		}
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::init()
+	{
+		WorkQueue* queue = mQueue;
+		if (!queue && Root::getSingletonPtr())
+			queue = Root::getSingleton().getWorkQueue();
+		if (!queue || queue == mRegisteredQueue)
+			return;
+
+		mRegisteredQueue = queue;
+		// anything queued on a previous queue went with it
+		mQueuedHelpers = 0;
+		mChannel = queue->getChannel("Ogre/ParallelTaskGroup/" + mName);
+		queue->addRequestHandler(mChannel, this);
+		queue->addResponseHandler(mChannel, this);
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::addTask(Task* task)
+	{
+		OGRE_LOCK_MUTEX(mTaskMutex)
+		mTasks.push_back(task);
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::clearTasks()
+	{
+		OGRE_LOCK_MUTEX(mTaskMutex)
+		mTasks.clear();
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::run()
+	{
+		if (mTasks.empty())
+			return;
+
+		uint32 runID;
+		{
+			OGRE_LOCK_MUTEX(mTaskMutex)
+			mNextTask = 0;
+			mCompletedTasks = 0;
+			runID = ++mRunID;
+		}
+
+#if OGRE_THREAD_SUPPORT
+		size_t helpers = std::min(mMaxConcurrency, mTasks.size()) - 1;
+		if (helpers)
+		{
+			init();
+			// Helpers still queued from an earlier run will join in this one
+			// too, so only top up to the number required
+			size_t newHelpers = 0;
+			{
+				OGRE_LOCK_MUTEX(mTaskMutex)
+				if (helpers > mQueuedHelpers)
+				{
+					newHelpers = helpers - mQueuedHelpers;
+					mQueuedHelpers = helpers;
+				}
+			}
+			for (size_t i = 0; i < newHelpers; ++i)
+			{
+				if (!mRegisteredQueue || !mRegisteredQueue->addRequest(mChannel, 0, Any()))
+				{
+					// not accepted
+					OGRE_LOCK_MUTEX(mTaskMutex)
+					--mQueuedHelpers;
+				}
+			}
+		}
+#endif
+
+		// The calling thread takes part in the work too
+		executeTasks(runID);
+
+#if OGRE_THREAD_SUPPORT
+		// Wait for any tasks still in flight on worker threads; these were
+		// already started so this is at most the length of one task
+		while (true)
+		{
+			{
+				OGRE_LOCK_MUTEX(mTaskMutex)
+				if (mCompletedTasks == mTasks.size())
+					break;
+			}
+			OGRE_THREAD_SLEEP(0);
+		}
+#endif
+
+		OGRE_LOCK_MUTEX(mTaskMutex)
+		mTasks.clear();
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::executeTasks(uint32 runID)
+	{
+		Task* task = 0;
+		while (true)
+		{
+			{
+				OGRE_LOCK_MUTEX(mTaskMutex)
+				if (task)
+					++mCompletedTasks;
+				if (runID != mRunID || mNextTask >= mTasks.size())
+					break;
+				task = mTasks[mNextTask++];
+			}
+			task->execute();
+		}
+	}
+	//---------------------------------------------------------------------
+	bool ParallelTaskGroup::canHandleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ)
+	{
+		// Handle even aborted requests, so that the count of queued helpers stays right
+		return true;
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::Response* ParallelTaskGroup::handleRequest(const WorkQueue::Request* req, 
+		const WorkQueue* srcQ)
+	{
+		uint32 runID;
+		{
+			OGRE_LOCK_MUTEX(mTaskMutex)
+			--mQueuedHelpers;
+			runID = mRunID;
+		}
+		executeTasks(runID);
+		return OGRE_NEW WorkQueue::Response(req, true, Any());
+	}
+	//---------------------------------------------------------------------
+	void ParallelTaskGroup::handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ)
+	{
+		// Nothing to do, results were consumed synchronously in run()
+	}
+}
@@ -0,0 +1,861 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgrePixelConversionKernels.h"
+#include "OgreBitwise.h"
+#include "OgrePlatformInformation.h"
+
+//-------------------------------------------------------------------------
+//
+// Row kernels for the pairs of formats bulkPixelConversion sees most, picked
+// from a table indexed by the source and destination formats. Every kernel
+// gives the same result as unpackColour followed by packColour, bit for bit,
+// so which one runs (or whether one runs at all) makes no difference to the
+// pixels.
+//
+// The SSE2 kernels are the baseline. The AVX2 ones do what they can in whole
+// registers and hand the remainder to the SSE2 ones, which in turn hand
+// theirs to the general ones. As in OgreOptimisedUtilAVX.cpp, the functions
+// are compiled for their instruction set one at a time, so nothing else in
+// the engine needs any more than the usual flags, and the table only gets
+// the kernels the CPU supports.
+//
+//-------------------------------------------------------------------------
+
+#if __OGRE_HAVE_SSE && (OGRE_COMPILER == OGRE_COMPILER_MSVC || defined(__SSE2__) || __OGRE_HAVE_AVX)
+#   define __OGRE_HAVE_SSE2_KERNELS 1
+#   include <emmintrin.h>
+#   if __OGRE_HAVE_AVX2
+#       include <immintrin.h>
+#   endif
+#else
+#   define __OGRE_HAVE_SSE2_KERNELS 0
+#endif
+
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC
+#   define __OGRE_SSE2_FUNCTION __attribute__((__target__("sse2")))
+#   define __OGRE_AVX_FUNCTION  __attribute__((__target__("avx2")))
+#else
+#   define __OGRE_SSE2_FUNCTION
+#   define __OGRE_AVX_FUNCTION
+#endif
+
+namespace Ogre {
+
+    /** A row kernel, with the parameters it needs for a pair of formats.
+    */
+    struct PixelKernel
+    {
+        /// Converts count pixels from src to dst
+        typedef void (*Function)(const uint8* src, uint8* dst, size_t count,
+            const PixelKernel& kernel);
+
+        Function function;
+        /// Bytes in a source pixel for the byte kernels, or values in a pixel
+        /// for the half float ones
+        size_t size;
+        /// For each byte of the destination pixel (or its channels in RGBA
+        /// order, going to float), the source byte it comes from, or -1
+        int shuffle[4];
+        /// Or'd into each destination byte, to fill a missing alpha
+        uint8 fill[4];
+    };
+
+    /// The kinds of kernel, each of which has one function per instruction set
+    enum PixelKernelKind
+    {
+        PKK_SHUFFLE,
+        PKK_BYTES_TO_FLOAT,
+        PKK_FLOAT_TO_BYTES,
+        PKK_FLOAT_TO_HALF,
+        PKK_HALF_TO_FLOAT,
+        PKK_COUNT
+    };
+
+    /// The kernel for each pair of formats, indexed by source and destination
+    static PixelKernel msPixelKernels[PF_COUNT][PF_COUNT];
+    static PixelUtil::ConversionKernels msConversionKernels = PixelUtil::CK_NONE;
+
+//-------------------------------------------------------------------------
+// General kernels, for the remainders
+//-------------------------------------------------------------------------
+
+    static FORCEINLINE uint8 _shuffleByte(const uint8* src, const PixelKernel& kernel, size_t i)
+    {
+        return static_cast<uint8>(
+            (kernel.shuffle[i] < 0 ? 0 : src[kernel.shuffle[i]]) | kernel.fill[i]);
+    }
+    //---------------------------------------------------------------------
+    static void shuffleGeneral(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        for (size_t i = 0; i < count; ++i, src += kernel.size, dst += 4)
+        {
+            for (size_t j = 0; j < 4; ++j)
+                dst[j] = _shuffleByte(src, kernel, j);
+        }
+    }
+    //---------------------------------------------------------------------
+    static void bytesToFloatGeneral(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        float* pDst = reinterpret_cast<float*>(dst);
+        for (size_t i = 0; i < count; ++i, src += 4, pDst += 4)
+        {
+            for (size_t c = 0; c < 4; ++c)
+                pDst[c] = Bitwise::fixedToFloat(_shuffleByte(src, kernel, c), 8);
+        }
+    }
+    //---------------------------------------------------------------------
+    static void floatToBytesGeneral(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const float* pSrc = reinterpret_cast<const float*>(src);
+        for (size_t i = 0; i < count; ++i, pSrc += 4, dst += 4)
+        {
+            uint8 rgba[4];
+            for (size_t c = 0; c < 4; ++c)
+                rgba[c] = static_cast<uint8>(Bitwise::floatToFixed(pSrc[c], 8));
+            for (size_t j = 0; j < 4; ++j)
+                dst[j] = _shuffleByte(rgba, kernel, j);
+        }
+    }
+    //---------------------------------------------------------------------
+    static void floatToHalfGeneral(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t values = count * kernel.size;
+        for (size_t i = 0; i < values; ++i, src += 4, dst += 2)
+        {
+            uint32 f;
+            memcpy(&f, src, 4);
+            const uint16 h = Bitwise::floatToHalfI(f);
+            memcpy(dst, &h, 2);
+        }
+    }
+    //---------------------------------------------------------------------
+    static void halfToFloatGeneral(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t values = count * kernel.size;
+        for (size_t i = 0; i < values; ++i, src += 2, dst += 4)
+        {
+            uint16 h;
+            memcpy(&h, src, 2);
+            const uint32 f = Bitwise::halfToFloatI(h);
+            memcpy(dst, &f, 4);
+        }
+    }
+
+#if __OGRE_HAVE_SSE2_KERNELS
+
+//-------------------------------------------------------------------------
+// SSE2 kernels
+//-------------------------------------------------------------------------
+
+    /** A byte shuffle done with shifts and masks, since SSE2 has no pshufb.
+        The bytes which move the same distance share a shift.
+    */
+    struct ShufflePlanSSE2
+    {
+        size_t count;
+        bool left[7];
+        __m128i shift[7];
+        __m128i mask[7];
+        __m128i fill;
+    };
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void _makeShufflePlan(const PixelKernel& kernel,
+        ShufflePlanSSE2& plan)
+    {
+        plan.count = 0;
+        for (int distance = -3; distance <= 3; ++distance)
+        {
+            uint32 mask = 0;
+            for (int j = 0; j < 4; ++j)
+            {
+                if (kernel.shuffle[j] >= 0 && j - kernel.shuffle[j] == distance)
+                    mask |= 0xFFu << (j * 8);
+            }
+            if (mask)
+            {
+                plan.left[plan.count] = distance >= 0;
+                plan.shift[plan.count] = _mm_cvtsi32_si128((distance >= 0 ? distance : -distance) * 8);
+                plan.mask[plan.count] = _mm_set1_epi32(static_cast<int>(mask));
+                ++plan.count;
+            }
+        }
+        uint32 fill;
+        memcpy(&fill, kernel.fill, 4);
+        plan.fill = _mm_set1_epi32(static_cast<int>(fill));
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _shuffle(__m128i x, const ShufflePlanSSE2& plan)
+    {
+        __m128i r = plan.fill;
+        for (size_t n = 0; n < plan.count; ++n)
+        {
+            const __m128i t = plan.left[n] ?
+                _mm_sll_epi32(x, plan.shift[n]) : _mm_srl_epi32(x, plan.shift[n]);
+            r = _mm_or_si128(r, _mm_and_si128(t, plan.mask[n]));
+        }
+        return r;
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+    //---------------------------------------------------------------------
+    /** Loads 4 pixels of the given size, one to each 32 bit lane.
+    */
+    template <size_t size>
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _loadPixels(const uint8* src)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        switch (size)
+        {
+        case 1:
+            {
+                int v;
+                memcpy(&v, src, 4);
+                return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero), zero);
+            }
+        case 2:
+            return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)), zero);
+        case 3:
+            {
+                // Reads 16 bytes for the 12 wanted
+                const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+                const __m128i p01 = _mm_unpacklo_epi32(x, _mm_srli_si128(x, 3));
+                const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(x, 6), _mm_srli_si128(x, 9));
+                return _mm_and_si128(_mm_unpacklo_epi64(p01, p23), _mm_set1_epi32(0xFFFFFF));
+            }
+        default:
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        }
+    }
+    //---------------------------------------------------------------------
+    template <size_t size>
+    __OGRE_SSE2_FUNCTION static void _shuffleSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        ShufflePlanSSE2 plan;
+        _makeShufflePlan(kernel, plan);
+
+        const size_t loadBytes = size == 3 ? 16 : size * 4;
+        size_t i = 0;
+        for (; i * size + loadBytes <= count * size; i += 4, src += size * 4, dst += 16)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _shuffle(_loadPixels<size>(src), plan));
+        }
+        shuffleGeneral(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void shuffleSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        switch (kernel.size)
+        {
+        case 1:
+            _shuffleSSE2<1>(src, dst, count, kernel);
+            break;
+        case 2:
+            _shuffleSSE2<2>(src, dst, count, kernel);
+            break;
+        case 3:
+            _shuffleSSE2<3>(src, dst, count, kernel);
+            break;
+        default:
+            _shuffleSSE2<4>(src, dst, count, kernel);
+            break;
+        }
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void bytesToFloatSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        ShufflePlanSSE2 plan;
+        _makeShufflePlan(kernel, plan);
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(255.0f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4, src += 16, dst += 64)
+        {
+            // Bytes into RGBA order, then widened to one pixel per register
+            const __m128i x = _shuffle(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), plan);
+            const __m128i lo = _mm_unpacklo_epi8(x, zero);
+            const __m128i hi = _mm_unpackhi_epi8(x, zero);
+            float* pDst = reinterpret_cast<float*>(dst);
+            // A division, not a multiplication by the reciprocal, to round the same
+            _mm_storeu_ps(pDst + 0, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+            _mm_storeu_ps(pDst + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+            _mm_storeu_ps(pDst + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+            _mm_storeu_ps(pDst + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+        }
+        bytesToFloatGeneral(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    /** Bitwise::floatToFixed for 8 bits, of 4 values.
+    */
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _floatToByte(__m128 v)
+    {
+        // NaN goes to zero, as max returns its second operand for it
+        v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        const __m128i t = _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(256.0f)));
+        // 1.0 gives 256, which should be 255
+        return _mm_sub_epi32(t, _mm_srli_epi32(t, 8));
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void floatToBytesSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        ShufflePlanSSE2 plan;
+        _makeShufflePlan(kernel, plan);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4, src += 64, dst += 16)
+        {
+            const float* pSrc = reinterpret_cast<const float*>(src);
+            const __m128i p0 = _floatToByte(_mm_loadu_ps(pSrc + 0));
+            const __m128i p1 = _floatToByte(_mm_loadu_ps(pSrc + 4));
+            const __m128i p2 = _floatToByte(_mm_loadu_ps(pSrc + 8));
+            const __m128i p3 = _floatToByte(_mm_loadu_ps(pSrc + 12));
+            const __m128i x = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _shuffle(x, plan));
+        }
+        floatToBytesGeneral(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    /** Bitwise::floatToHalfI of 4 values, each left in the low half of its lane.
+    */
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _floatToHalf(__m128i x)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i s = _mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(0x8000));
+        const __m128i e = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(x, 23), _mm_set1_epi32(0xFF)),
+            _mm_set1_epi32(127 - 15));
+        const __m128i m = _mm_and_si128(x, _mm_set1_epi32(0x7FFFFF));
+
+        // Normalized
+        __m128i r = _mm_or_si128(_mm_or_si128(s, _mm_slli_epi32(e, 10)), _mm_srli_epi32(m, 13));
+        // Denormalized; shifting the mantissa right by 14 - e is the same as
+        // truncating the magnitude scaled by 2^24, which needs no variable shift
+        const __m128 magnitude = _mm_castsi128_ps(_mm_and_si128(x, _mm_set1_epi32(0x7FFFFFFF)));
+        const __m128i d = _mm_or_si128(s,
+            _mm_cvttps_epi32(_mm_mul_ps(magnitude, _mm_set1_ps(16777216.0f))));
+        r = _select(_mm_cmplt_epi32(e, _mm_set1_epi32(1)), d, r);
+        // Overflow, Inf and NaN
+        const __m128i mm = _mm_srli_epi32(m, 13);
+        const __m128i nan = _mm_andnot_si128(_mm_cmpeq_epi32(m, zero),
+            _mm_cmpeq_epi32(e, _mm_set1_epi32(0xFF - (127 - 15))));
+        const __m128i big = _mm_or_si128(_mm_or_si128(s, _mm_set1_epi32(0x7C00)),
+            _mm_and_si128(nan, _mm_or_si128(mm, _mm_and_si128(_mm_cmpeq_epi32(mm, zero), _mm_set1_epi32(1)))));
+        r = _select(_mm_cmpgt_epi32(e, _mm_set1_epi32(30)), big, r);
+        // Too small, which loses the sign too
+        r = _mm_andnot_si128(_mm_cmplt_epi32(e, _mm_set1_epi32(-10)), r);
+
+        // Sign extended, so that a signed pack keeps the bits
+        return _mm_srai_epi32(_mm_slli_epi32(r, 16), 16);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void floatToHalfSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t values = count * kernel.size;
+        size_t i = 0;
+        for (; i + 8 <= values; i += 8, src += 32, dst += 16)
+        {
+            const __m128i h0 = _floatToHalf(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+            const __m128i h1 = _floatToHalf(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_packs_epi32(h0, h1));
+        }
+        PixelKernel remainder = kernel;
+        remainder.size = 1;
+        floatToHalfGeneral(src, dst, values - i, remainder);
+    }
+    //---------------------------------------------------------------------
+    /** Bitwise::halfToFloatI of 4 values, each in the low half of its lane.
+    */
+    __OGRE_SSE2_FUNCTION static FORCEINLINE __m128i _halfToFloat(__m128i x)
+    {
+        const __m128i s = _mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(0x8000)), 16);
+        const __m128i e = _mm_and_si128(_mm_srli_epi32(x, 10), _mm_set1_epi32(0x1F));
+        const __m128i m = _mm_and_si128(x, _mm_set1_epi32(0x3FF));
+        const __m128i m13 = _mm_slli_epi32(m, 13);
+
+        // Normalized
+        __m128i r = _mm_or_si128(_mm_or_si128(s,
+            _mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(127 - 15)), 23)), m13);
+        // Inf and NaN
+        r = _select(_mm_cmpeq_epi32(e, _mm_set1_epi32(31)),
+            _mm_or_si128(_mm_or_si128(s, _mm_set1_epi32(0x7F800000)), m13), r);
+        // Zero and denormalized; the mantissa scaled by 2^-24 is exact, and
+        // the same as renormalizing it
+        const __m128i d = _mm_or_si128(s, _mm_castps_si128(
+            _mm_mul_ps(_mm_cvtepi32_ps(m), _mm_set1_ps(1.0f / 16777216.0f))));
+        return _select(_mm_cmpeq_epi32(e, _mm_setzero_si128()), d, r);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_SSE2_FUNCTION static void halfToFloatSSE2(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const size_t values = count * kernel.size;
+        size_t i = 0;
+        for (; i + 8 <= values; i += 8, src += 16, dst += 32)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _halfToFloat(_mm_unpacklo_epi16(x, zero)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), _halfToFloat(_mm_unpackhi_epi16(x, zero)));
+        }
+        PixelKernel remainder = kernel;
+        remainder.size = 1;
+        halfToFloatGeneral(src, dst, values - i, remainder);
+    }
+
+#if __OGRE_HAVE_AVX2
+
+//-------------------------------------------------------------------------
+// AVX2 kernels
+//-------------------------------------------------------------------------
+
+    /** The pshufb mask for a kernel's shuffle, where each 128 bit lane holds 4
+        pixels of the given size.
+    */
+    __OGRE_AVX_FUNCTION static __m256i _makeShuffleMask(const PixelKernel& kernel, size_t size)
+    {
+        char mask[32];
+        for (size_t p = 0; p < 8; ++p)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                mask[p * 4 + j] = static_cast<char>(kernel.shuffle[j] < 0 ?
+                    0x80 : (p % 4) * size + kernel.shuffle[j]);
+            }
+        }
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask));
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static __m256i _makeFill(const PixelKernel& kernel)
+    {
+        uint32 fill;
+        memcpy(&fill, kernel.fill, 4);
+        return _mm256_set1_epi32(static_cast<int>(fill));
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m256i _select(__m256i mask, __m256i a, __m256i b)
+    {
+        return _mm256_blendv_epi8(b, a, mask);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static void shuffleAVX(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t size = kernel.size;
+        const __m256i mask = _makeShuffleMask(kernel, size);
+        const __m256i fill = _makeFill(kernel);
+        size_t i = 0;
+        // Each lane loads 16 bytes, for the 4 pixels it wants
+        for (; i + 8 <= count && (i + 4) * size + 16 <= count * size;
+            i += 8, src += size * 8, dst += 32)
+        {
+            const __m256i x = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + size * 4)), 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                _mm256_or_si256(_mm256_shuffle_epi8(x, mask), fill));
+        }
+        shuffleSSE2(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static void bytesToFloatAVX(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const __m256i mask = _makeShuffleMask(kernel, 4);
+        const __m256i fill = _makeFill(kernel);
+        const __m256 scale = _mm256_set1_ps(255.0f);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, src += 32, dst += 128)
+        {
+            const __m256i x = _mm256_or_si256(_mm256_shuffle_epi8(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), mask), fill);
+            const __m128i lo = _mm256_castsi256_si128(x);
+            const __m128i hi = _mm256_extracti128_si256(x, 1);
+            float* pDst = reinterpret_cast<float*>(dst);
+            _mm256_storeu_ps(pDst + 0, _mm256_div_ps(_mm256_cvtepi32_ps(
+                _mm256_cvtepu8_epi32(lo)), scale));
+            _mm256_storeu_ps(pDst + 8, _mm256_div_ps(_mm256_cvtepi32_ps(
+                _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8))), scale));
+            _mm256_storeu_ps(pDst + 16, _mm256_div_ps(_mm256_cvtepi32_ps(
+                _mm256_cvtepu8_epi32(hi)), scale));
+            _mm256_storeu_ps(pDst + 24, _mm256_div_ps(_mm256_cvtepi32_ps(
+                _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8))), scale));
+        }
+        bytesToFloatSSE2(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m256i _floatToByte(__m256 v)
+    {
+        v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        const __m256i t = _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(256.0f)));
+        return _mm256_sub_epi32(t, _mm256_srli_epi32(t, 8));
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static void floatToBytesAVX(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const __m256i mask = _makeShuffleMask(kernel, 4);
+        // The packs interleave the lanes; this puts the pixels back in order
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8, src += 128, dst += 32)
+        {
+            const float* pSrc = reinterpret_cast<const float*>(src);
+            const __m256i p01 = _floatToByte(_mm256_loadu_ps(pSrc + 0));
+            const __m256i p23 = _floatToByte(_mm256_loadu_ps(pSrc + 8));
+            const __m256i p45 = _floatToByte(_mm256_loadu_ps(pSrc + 16));
+            const __m256i p67 = _floatToByte(_mm256_loadu_ps(pSrc + 24));
+            __m256i x = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+            x = _mm256_permutevar8x32_epi32(x, order);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_shuffle_epi8(x, mask));
+        }
+        floatToBytesSSE2(src, dst, count - i, kernel);
+    }
+    //---------------------------------------------------------------------
+    /// As the SSE2 _floatToHalf, for 8 values
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m256i _floatToHalf(__m256i x)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i s = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(0x8000));
+        const __m256i e = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(x, 23), _mm256_set1_epi32(0xFF)),
+            _mm256_set1_epi32(127 - 15));
+        const __m256i m = _mm256_and_si256(x, _mm256_set1_epi32(0x7FFFFF));
+
+        __m256i r = _mm256_or_si256(_mm256_or_si256(s, _mm256_slli_epi32(e, 10)), _mm256_srli_epi32(m, 13));
+        const __m256 magnitude = _mm256_castsi256_ps(_mm256_and_si256(x, _mm256_set1_epi32(0x7FFFFFFF)));
+        const __m256i d = _mm256_or_si256(s,
+            _mm256_cvttps_epi32(_mm256_mul_ps(magnitude, _mm256_set1_ps(16777216.0f))));
+        r = _select(_mm256_cmpgt_epi32(_mm256_set1_epi32(1), e), d, r);
+        const __m256i mm = _mm256_srli_epi32(m, 13);
+        const __m256i nan = _mm256_andnot_si256(_mm256_cmpeq_epi32(m, zero),
+            _mm256_cmpeq_epi32(e, _mm256_set1_epi32(0xFF - (127 - 15))));
+        const __m256i big = _mm256_or_si256(_mm256_or_si256(s, _mm256_set1_epi32(0x7C00)),
+            _mm256_and_si256(nan, _mm256_or_si256(mm,
+                _mm256_and_si256(_mm256_cmpeq_epi32(mm, zero), _mm256_set1_epi32(1)))));
+        r = _select(_mm256_cmpgt_epi32(e, _mm256_set1_epi32(30)), big, r);
+        r = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(-10), e), r);
+
+        return _mm256_srai_epi32(_mm256_slli_epi32(r, 16), 16);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static void floatToHalfAVX(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t values = count * kernel.size;
+        size_t i = 0;
+        for (; i + 16 <= values; i += 16, src += 64, dst += 32)
+        {
+            const __m256i h0 = _floatToHalf(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)));
+            const __m256i h1 = _floatToHalf(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32)));
+            // The pack works within lanes, so the middle quarters swap back
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                _mm256_permute4x64_epi64(_mm256_packs_epi32(h0, h1), _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        PixelKernel remainder = kernel;
+        remainder.size = 1;
+        floatToHalfSSE2(src, dst, values - i, remainder);
+    }
+    //---------------------------------------------------------------------
+    /// As the SSE2 _halfToFloat, for 8 values
+    __OGRE_AVX_FUNCTION static FORCEINLINE __m256i _halfToFloat(__m256i x)
+    {
+        const __m256i s = _mm256_slli_epi32(_mm256_and_si256(x, _mm256_set1_epi32(0x8000)), 16);
+        const __m256i e = _mm256_and_si256(_mm256_srli_epi32(x, 10), _mm256_set1_epi32(0x1F));
+        const __m256i m = _mm256_and_si256(x, _mm256_set1_epi32(0x3FF));
+        const __m256i m13 = _mm256_slli_epi32(m, 13);
+
+        __m256i r = _mm256_or_si256(_mm256_or_si256(s,
+            _mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(127 - 15)), 23)), m13);
+        r = _select(_mm256_cmpeq_epi32(e, _mm256_set1_epi32(31)),
+            _mm256_or_si256(_mm256_or_si256(s, _mm256_set1_epi32(0x7F800000)), m13), r);
+        const __m256i d = _mm256_or_si256(s, _mm256_castps_si256(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(m), _mm256_set1_ps(1.0f / 16777216.0f))));
+        return _select(_mm256_cmpeq_epi32(e, _mm256_setzero_si256()), d, r);
+    }
+    //---------------------------------------------------------------------
+    __OGRE_AVX_FUNCTION static void halfToFloatAVX(const uint8* src, uint8* dst, size_t count,
+        const PixelKernel& kernel)
+    {
+        const size_t values = count * kernel.size;
+        size_t i = 0;
+        for (; i + 8 <= values; i += 8, src += 16, dst += 32)
+        {
+            const __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _halfToFloat(x));
+        }
+        PixelKernel remainder = kernel;
+        remainder.size = 1;
+        halfToFloatSSE2(src, dst, values - i, remainder);
+    }
+
+#endif  // __OGRE_HAVE_AVX2
+
+#endif  // __OGRE_HAVE_SSE2_KERNELS
+
+//-------------------------------------------------------------------------
+// The lookup table
+//-------------------------------------------------------------------------
+
+    /** Gets the byte holding each channel (R, G, B, A) of a format made of
+        whole bytes, or -1 for the channels it lacks.
+    @returns
+        false if the format isn't made of whole bytes.
+    */
+    static bool getByteLayout(PixelFormat format, int channels[4])
+    {
+        if (format == PF_BYTE_LA)
+        {
+            channels[0] = channels[1] = channels[2] = 0;
+            channels[3] = 1;
+            return true;
+        }
+        if (!PixelUtil::isNativeEndian(format) || PixelUtil::isFloatingPoint(format) ||
+            PixelUtil::isCompressed(format) || PixelUtil::isDepth(format))
+            return false;
+
+        const size_t size = PixelUtil::getNumElemBytes(format);
+        if (size == 0 || size > 4)
+            return false;
+
+        int bits[4];
+        uint32 masks[4];
+        PixelUtil::getBitDepths(format, bits);
+        PixelUtil::getBitMasks(format, masks);
+        for (size_t c = 0; c < 4; ++c)
+        {
+            channels[c] = -1;
+            if (bits[c] == 0)
+                continue;
+            const unsigned int shift = Bitwise::getBitShift(masks[c]);
+            if (bits[c] != 8 || shift % 8 != 0 || masks[c] != (0xFFu << shift))
+                return false;
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+            channels[c] = static_cast<int>(size - 1 - shift / 8);
+#else
+            channels[c] = static_cast<int>(shift / 8);
+#endif
+        }
+        if (PixelUtil::isLuminance(format))
+            channels[1] = channels[2] = channels[0];
+        return true;
+    }
+    //---------------------------------------------------------------------
+    static bool isWholeBytesRGBA(PixelFormat format, int channels[4])
+    {
+        return getByteLayout(format, channels) && PixelUtil::getNumElemBytes(format) == 4 &&
+            channels[0] >= 0 && channels[1] >= 0 && channels[2] >= 0 && channels[3] >= 0;
+    }
+    //---------------------------------------------------------------------
+    static void fillKernelTable(const PixelKernel::Function functions[PKK_COUNT])
+    {
+        static const PixelFormat floatFormats[][2] =
+        {
+            { PF_FLOAT32_R, PF_FLOAT16_R },
+            { PF_FLOAT32_GR, PF_FLOAT16_GR },
+            { PF_FLOAT32_RGB, PF_FLOAT16_RGB },
+            { PF_FLOAT32_RGBA, PF_FLOAT16_RGBA }
+        };
+
+        memset(msPixelKernels, 0, sizeof(msPixelKernels));
+        if (!functions)
+            return;
+
+        for (int s = 0; s < PF_COUNT; ++s)
+        {
+            const PixelFormat srcFormat = static_cast<PixelFormat>(s);
+            int srcChannels[4];
+            const bool srcBytes = getByteLayout(srcFormat, srcChannels);
+
+            for (int d = 0; d < PF_COUNT; ++d)
+            {
+                const PixelFormat dstFormat = static_cast<PixelFormat>(d);
+                PixelKernel& kernel = msPixelKernels[s][d];
+                int dstChannels[4];
+                if (s == d)
+                    continue;
+
+                if (srcBytes && isWholeBytesRGBA(dstFormat, dstChannels))
+                {
+                    // Any bytes to 32 bit RGBA, in any order
+                    kernel.function = functions[PKK_SHUFFLE];
+                    kernel.size = PixelUtil::getNumElemBytes(srcFormat);
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        kernel.shuffle[dstChannels[c]] = srcChannels[c];
+                        kernel.fill[dstChannels[c]] = (c == 3 && srcChannels[c] < 0) ? 0xFF : 0;
+                    }
+                }
+                else if (srcBytes && PixelUtil::getNumElemBytes(srcFormat) == 4 &&
+                    dstFormat == PF_FLOAT32_RGBA)
+                {
+                    kernel.function = functions[PKK_BYTES_TO_FLOAT];
+                    kernel.size = 4;
+                    for (size_t c = 0; c < 4; ++c)
+                    {
+                        kernel.shuffle[c] = srcChannels[c];
+                        kernel.fill[c] = (c == 3 && srcChannels[c] < 0) ? 0xFF : 0;
+                    }
+                }
+                else if (srcFormat == PF_FLOAT32_RGBA && isWholeBytesRGBA(dstFormat, dstChannels))
+                {
+                    kernel.function = functions[PKK_FLOAT_TO_BYTES];
+                    kernel.size = 16;
+                    for (size_t c = 0; c < 4; ++c)
+                        kernel.shuffle[dstChannels[c]] = static_cast<int>(c);
+                }
+                else
+                {
+                    for (size_t f = 0; f < sizeof(floatFormats) / sizeof(floatFormats[0]); ++f)
+                    {
+                        if (srcFormat == floatFormats[f][0] && dstFormat == floatFormats[f][1])
+                            kernel.function = functions[PKK_FLOAT_TO_HALF];
+                        else if (srcFormat == floatFormats[f][1] && dstFormat == floatFormats[f][0])
+                            kernel.function = functions[PKK_HALF_TO_FLOAT];
+                        else
+                            continue;
+                        kernel.size = PixelUtil::getComponentCount(srcFormat);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    static bool selectConversionKernels(PixelUtil::ConversionKernels kernels)
+    {
+#if __OGRE_HAVE_SSE2_KERNELS
+        static const PixelKernel::Function sse2[PKK_COUNT] =
+        {
+            shuffleSSE2, bytesToFloatSSE2, floatToBytesSSE2, floatToHalfSSE2, halfToFloatSSE2
+        };
+#if __OGRE_HAVE_AVX2
+        static const PixelKernel::Function avx[PKK_COUNT] =
+        {
+            shuffleAVX, bytesToFloatAVX, floatToBytesAVX, floatToHalfAVX, halfToFloatAVX
+        };
+#endif
+#endif
+        const PixelKernel::Function* functions = 0;
+        switch (kernels)
+        {
+        case PixelUtil::CK_NONE:
+            break;
+#if __OGRE_HAVE_SSE2_KERNELS
+        case PixelUtil::CK_SSE2:
+            if (!(PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_SSE2))
+                return false;
+            functions = sse2;
+            break;
+#if __OGRE_HAVE_AVX2
+        case PixelUtil::CK_AVX2:
+            if (!(PlatformInformation::getCpuFeatures() & PlatformInformation::CPU_FEATURE_AVX2))
+                return false;
+            functions = avx;
+            break;
+#endif
+#endif
+        default:
+            return false;
+        }
+
+        fillKernelTable(functions);
+        msConversionKernels = kernels;
+        return true;
+    }
+    //---------------------------------------------------------------------
+    /** Selects the best kernels the CPU supports on start up.
+    */
+    struct _OgrePrivate PixelKernelInitialiser
+    {
+        PixelKernelInitialiser(void)
+        {
+            if (!selectConversionKernels(PixelUtil::CK_AVX2))
+                selectConversionKernels(PixelUtil::CK_SSE2);
+        }
+    };
+    static PixelKernelInitialiser msPixelKernelInitialiser;
+    //---------------------------------------------------------------------
+    bool PixelUtil::_setConversionKernels(ConversionKernels kernels)
+    {
+        return selectConversionKernels(kernels);
+    }
+    //---------------------------------------------------------------------
+    PixelUtil::ConversionKernels PixelUtil::_getConversionKernels(void)
+    {
+        return msConversionKernels;
+    }
+    //---------------------------------------------------------------------
+    bool _doKernelConversion(const PixelBox &src, const PixelBox &dst)
+    {
+        const PixelKernel& kernel = msPixelKernels[src.format][dst.format];
+        if (!kernel.function)
+            return false;
+
+        const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
+        const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+        const uint8* srcptr = static_cast<const uint8*>(src.data)
+            + (src.left + src.top * src.rowPitch + src.front * src.slicePitch) * srcPixelSize;
+        uint8* dstptr = static_cast<uint8*>(dst.data)
+            + (dst.left + dst.top * dst.rowPitch + dst.front * dst.slicePitch) * dstPixelSize;
+
+        // Everything consecutive? Then it is all one row
+        if (src.isConsecutive() && dst.isConsecutive())
+        {
+            kernel.function(srcptr, dstptr,
+                src.getWidth() * src.getHeight() * src.getDepth(), kernel);
+            return true;
+        }
+
+        const size_t width = src.getWidth();
+        for (size_t z = 0; z < src.getDepth(); ++z)
+        {
+            for (size_t y = 0; y < src.getHeight(); ++y)
+            {
+                kernel.function(
+                    srcptr + (z * src.slicePitch + y * src.rowPitch) * srcPixelSize,
+                    dstptr + (z * dst.slicePitch + y * dst.rowPitch) * dstPixelSize,
+                    width, kernel);
+            }
+        }
+        return true;
+    }
+
+}
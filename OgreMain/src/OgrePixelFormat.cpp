@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "OgreBitwise.h"
 #include "OgreColourValue.h"
 #include "OgreException.h"
+#include "OgrePixelConversionKernels.h"
+#include "OgreDXTConversion.h"
 
 
 namespace {
@@ -1250,7 +1252,8 @@ namespace Ogre {
 			   src.getHeight() == dst.getHeight() &&
 			   src.getDepth() == dst.getDepth());
 
-		// Check for compressed formats, we don't support decompression, compression or recoding
+		// Check for compressed formats, we only support compressing to and
+		// decompressing from DXT, not recoding
 		if(PixelUtil::isCompressed(src.format) || PixelUtil::isCompressed(dst.format))
 		{
 			if(src.format == dst.format)
@@ -1258,6 +1261,18 @@ namespace Ogre {
 				memcpy(dst.data, src.data, src.getConsecutiveSize());
 				return;
 			}
+			else if(!PixelUtil::isCompressed(src.format) && 
+				dst.format >= PF_DXT1 && dst.format <= PF_DXT5)
+			{
+				_compressDXT(src, dst);
+				return;
+			}
+			else if(!PixelUtil::isCompressed(dst.format) && 
+				src.format >= PF_DXT1 && src.format <= PF_DXT5)
+			{
+				_decompressDXT(src, dst);
+				return;
+			}
 			else
 			{
 				OGRE_EXCEPT(Exception::ERR_NOT_IMPLEMENTED,
@@ -1329,6 +1344,14 @@ namespace Ogre {
 			return;
 		}
 
+        // Is there a SIMD kernel for the pair? The SSE2 ones are no quicker
+        // than the inlined conversions, so those are tried first if there is one.
+        const bool wideKernels = PixelUtil::_getConversionKernels() == PixelUtil::CK_AVX2;
+        if(wideKernels && _doKernelConversion(src, dst))
+        {
+            return;
+        }
+
 // NB VC6 can't handle the templates required for optimised conversion, tough
 #if OGRE_COMPILER != OGRE_COMPILER_MSVC || OGRE_COMP_VER >= 1300
         // Is there a specialized, inlined, conversion?
@@ -1339,6 +1362,11 @@ namespace Ogre {
         }
 #endif
 
+        if(!wideKernels && _doKernelConversion(src, dst))
+        {
+            return;
+        }
+
         const size_t srcPixelSize = PixelUtil::getNumElemBytes(src.format);
         const size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
         uint8 *srcptr = static_cast<uint8*>(src.data)
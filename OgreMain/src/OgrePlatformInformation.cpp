@@ -149,7 +149,20 @@ namespace Ogre {
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
 	#if _MSC_VER >= 1400 
 		int CPUInfo[4];
+		#if _MSC_FULL_VER >= 150030729
+		// Sub-leaf 0, for the functions which have sub-leaves
+		__cpuidex(CPUInfo, query, 0);
+		#else
+		// No __cpuidex before VS2008 SP1, so the sub-leaf can't be chosen and
+		// the extended features of function 7 are not reported. Nothing
+		// built with such a compiler can use them anyway.
+		if (query == 7)
+		{
+			memset(&result, 0, sizeof(result));
+			return 0;
+		}
 		__cpuid(CPUInfo, query);
+		#endif
 		result._eax = CPUInfo[0];
 		result._ebx = CPUInfo[1];
 		result._ecx = CPUInfo[2];
@@ -172,7 +185,7 @@ namespace Ogre {
         #if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_64
         __asm__
         (
-            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query)
+            "cpuid": "=a" (result._eax), "=b" (result._ebx), "=c" (result._ecx), "=d" (result._edx) : "a" (query), "c" (0)
         );
         #else
         __asm__
@@ -182,11 +195,36 @@ namespace Ogre {
             "movl   %%ebx, %%edi    \n\t"
             "popl   %%ebx           \n\t"
             : "=a" (result._eax), "=D" (result._ebx), "=c" (result._ecx), "=d" (result._edx)
-            : "a" (query)
+            : "a" (query), "c" (0)
         );
        #endif // OGRE_ARCHITECTURE_64
         return result._eax;
 
+#else
+        // TODO: Supports other compiler
+        return 0;
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    // Reads extended control register 0, which tells which register states the
+    // OS saves on context switches. Only valid if CPUID reports OSXSAVE.
+    static uint _readXcr0(void)
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+	#if _MSC_FULL_VER >= 160040219
+        return static_cast<uint>(_xgetbv(0));
+	#else
+        return 0;
+	#endif
+#elif OGRE_COMPILER == OGRE_COMPILER_GNUC
+        uint eax, edx;
+        // xgetbv, spelt out for assemblers which don't know it
+        __asm__ __volatile__
+        (
+            ".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (0)
+        );
+        return eax;
 #else
         // TODO: Supports other compiler
         return 0;
@@ -271,6 +309,38 @@ namespace Ogre {
     // Compiler-independent routines
     //---------------------------------------------------------------------
 
+#define CPUID_STD_FMA               (1<<12)     // ECX[12] - Bit 12 of standard function 1 indicate FMA supported
+#define CPUID_STD_OSXSAVE           (1<<27)     // ECX[27] - Bit 27 of standard function 1 indicate XGETBV is enabled by the OS
+#define CPUID_STD_AVX               (1<<28)     // ECX[28] - Bit 28 of standard function 1 indicate AVX supported
+#define CPUID_STD7_AVX2             (1<<5)      // EBX[5] - Bit 5 of standard function 7 indicate AVX2 supported
+
+    //---------------------------------------------------------------------
+    // Detect AVX, AVX2 and FMA, given the results of standard function 1.
+    // These are only usable if the OS saves the YMM registers too.
+    static uint _queryAvxFeatures(const CpuidResult& std1, uint maxStdFunction)
+    {
+        uint features = 0;
+        if ((std1._ecx & CPUID_STD_OSXSAVE) && (std1._ecx & CPUID_STD_AVX))
+        {
+            // Bits 1 and 2 are the XMM and YMM states
+            if ((_readXcr0() & 0x6) == 0x6)
+            {
+                features |= PlatformInformation::CPU_FEATURE_AVX;
+                if (std1._ecx & CPUID_STD_FMA)
+                    features |= PlatformInformation::CPU_FEATURE_FMA;
+
+                if (maxStdFunction >= 7)
+                {
+                    CpuidResult std7;
+                    _performCpuid(7, std7);
+                    if (std7._ebx & CPUID_STD7_AVX2)
+                        features |= PlatformInformation::CPU_FEATURE_AVX2;
+                }
+            }
+        }
+        return features;
+    }
+    //---------------------------------------------------------------------
     static uint queryCpuFeatures(void)
     {
 #define CPUID_STD_FPU               (1<<0)
@@ -299,7 +369,8 @@ namespace Ogre {
             CpuidResult result;
 
             // Has standard feature ?
-            if (_performCpuid(0, result))
+            uint maxStdFunction = _performCpuid(0, result);
+            if (maxStdFunction)
             {
                 // Check vendor strings
                 if (memcmp(&result._ebx, "GenuineIntel", 12) == 0)
@@ -326,6 +397,8 @@ namespace Ogre {
                     if (result._ecx & CPUID_STD_SSE3)
                         features |= PlatformInformation::CPU_FEATURE_SSE3;
 
+                    features |= _queryAvxFeatures(result, maxStdFunction);
+
                     // Check to see if this is a Pentium 4 or later processor
                     if ((result._eax & CPUID_EXT_FAMILY_ID_MASK) ||
                         (result._eax & CPUID_FAMILY_ID_MASK) == CPUID_PENTIUM4_ID)
@@ -358,6 +431,8 @@ namespace Ogre {
                     if (result._ecx & CPUID_STD_SSE3)
                         features |= PlatformInformation::CPU_FEATURE_SSE3;
 
+                    features |= _queryAvxFeatures(result, maxStdFunction);
+
                     // Has extended feature ?
                     if (_performCpuid(0x80000000, result) > 0x80000000)
                     {
@@ -389,6 +464,14 @@ namespace Ogre {
             features &= ~sse_features;
         }
 
+        // AVX registers are useless without SSE ones
+        const uint avx_features = PlatformInformation::CPU_FEATURE_AVX |
+            PlatformInformation::CPU_FEATURE_AVX2 | PlatformInformation::CPU_FEATURE_FMA;
+        if (!(features & PlatformInformation::CPU_FEATURE_SSE))
+        {
+            features &= ~avx_features;
+        }
+
         return features;
     }
     //---------------------------------------------------------------------
@@ -609,6 +692,12 @@ namespace Ogre {
 				" *      PRO: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_PRO), true));
 			pLog->logMessage(
 				" *       HT: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_HTT), true));
+			pLog->logMessage(
+				" *      AVX: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX), true));
+			pLog->logMessage(
+				" *     AVX2: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_AVX2), true));
+			pLog->logMessage(
+				" *      FMA: " + StringConverter::toString(hasCpuFeature(CPU_FEATURE_FMA), true));
 		}
 #elif OGRE_CPU == OGRE_CPU_ARM
         pLog->logMessage(
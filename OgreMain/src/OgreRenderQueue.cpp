@@ -46,6 +46,7 @@ namespace Ogre {
         : mSplitPassesByLightingType(false)
 		, mSplitNoShadowPasses(false)
         , mShadowCastersCannotBeReceivers(false)
+		, mKeyedSortEnabled(false)
 		, mRenderableListener(0)
     {
         // Create the 'main' queue up-front since we'll always need that
@@ -200,6 +201,8 @@ namespace Ogre {
                 mSplitPassesByLightingType,
                 mSplitNoShadowPasses,
                 mShadowCastersCannotBeReceivers);
+			if (mKeyedSortEnabled)
+				pGroup->setKeyedSortEnabled(true);
 			mGroups.insert(RenderQueueGroupMap::value_type(groupID, pGroup));
 		}
 		else
@@ -265,6 +268,24 @@ namespace Ogre {
 		return mShadowCastersCannotBeReceivers;
 	}
 	//-----------------------------------------------------------------------
+	void RenderQueue::setKeyedSortEnabled(bool enabled)
+	{
+		mKeyedSortEnabled = enabled;
+
+		RenderQueueGroupMap::iterator i, iend;
+		i = mGroups.begin();
+		iend = mGroups.end();
+		for (; i != iend; ++i)
+		{
+			i->second->setKeyedSortEnabled(enabled);
+		}
+	}
+	//-----------------------------------------------------------------------
+	bool RenderQueue::getKeyedSortEnabled(void) const
+	{
+		return mKeyedSortEnabled;
+	}
+	//-----------------------------------------------------------------------
 	void RenderQueue::merge( const RenderQueue* rhs )
 	{
 		ConstQueueGroupIterator it = rhs->_getQueueGroupIterator( );
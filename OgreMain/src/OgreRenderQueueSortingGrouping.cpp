@@ -28,15 +28,25 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 #include "OgreRenderQueueSortingGrouping.h"
 #include "OgreException.h"
+#include "OgreCamera.h"
 
 namespace Ogre {
-    // Init statics
-    RadixSort<QueuedRenderableCollection::RenderablePassList,
-        RenderablePass, uint32> QueuedRenderableCollection::msRadixSorter1;
-    RadixSort<QueuedRenderableCollection::RenderablePassList,
-        RenderablePass, float> QueuedRenderableCollection::msRadixSorter2;
-
-
+	//-----------------------------------------------------------------------
+	/** Returns whether cam is last, seen from where it was recorded. */
+	static bool isSameView(const Camera* cam, const Camera* last, 
+		const Vector3& lastPosition, const Quaternion& lastOrientation)
+	{
+		return cam == last && (!cam ||
+			(cam->getDerivedPosition() == lastPosition &&
+			cam->getDerivedOrientation() == lastOrientation));
+	}
+	//-----------------------------------------------------------------------
+	/// Bits of the sort key holding the quantised camera distance
+	static const uint64 SORT_KEY_DEPTH_MASK = 0xFFFFF;
+	/// Shift of the material part of the sort key, which has the 12 bits above
+	static const uint SORT_KEY_MATERIAL_SHIFT = 20;
+	/// Shift of the pass hash part of the sort key, which has the top 32 bits
+	static const uint SORT_KEY_PASS_SHIFT = 32;
 	//-----------------------------------------------------------------------
 	RenderPriorityGroup::RenderPriorityGroup(RenderQueueGroup* parent, 
             bool splitPassesByLightingType,
@@ -266,6 +276,18 @@ namespace Ogre {
 		mTransparentsUnsorted.sort(cam);
 		mTransparents.sort(cam);
 	}
+	//-----------------------------------------------------------------------
+	void RenderPriorityGroup::_getCollectionsToSort(const Camera* cam, CollectionList& list)
+	{
+		QueuedRenderableCollection* collections[] = { &mSolidsBasic, &mSolidsDecal, 
+			&mSolidsDiffuseSpecular, &mSolidsNoShadowReceive, &mTransparentsUnsorted, 
+			&mTransparents };
+		for (size_t i = 0; i < sizeof(collections) / sizeof(collections[0]); ++i)
+		{
+			if (collections[i]->isSortRequired(cam))
+				list.push_back(collections[i]);
+		}
+	}
     //-----------------------------------------------------------------------
 	void RenderPriorityGroup::merge( const RenderPriorityGroup* rhs )
 	{
@@ -279,6 +301,8 @@ namespace Ogre {
 	//-----------------------------------------------------------------------
 	QueuedRenderableCollection::QueuedRenderableCollection(void)
 		:mOrganisationMode(0)
+		, mSortedCamera(0)
+		, mDepthCamera(0)
 	{
 	}
     //-----------------------------------------------------------------------
@@ -307,6 +331,11 @@ namespace Ogre {
 
 		// Clear sorted list
 		mSortedDescending.clear();
+		// Clear keyed list
+		mKeyed.clear();
+		mSortKeys.clear();
+		mSortedCamera = 0;
+		mDepthCamera = 0;
 	}
     //-----------------------------------------------------------------------
 	void QueuedRenderableCollection::removePassGroup(Pass* p)
@@ -322,21 +351,75 @@ namespace Ogre {
             mGrouped.erase(i);
         }
 	}
+    //-----------------------------------------------------------------------
+	void QueuedRenderableCollection::_calculateSortDepths(const Camera* cam)
+	{
+		if (mOrganisationMode & OM_SORT_DESCENDING)
+		{
+			size_t count = mSortedDescending.size();
+			mDepthSortEntries.resize(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				mDepthSortEntries[i].depth = 
+					mSortedDescending[i].renderable->getSquaredViewDepth(cam);
+				mDepthSortEntries[i].index = static_cast<uint32>(i);
+			}
+		}
+
+		if (mOrganisationMode & OM_SORT_KEYED)
+		{
+			// Fill in the distance part of the keys, the only part which depends
+			// on the camera. The top bits of a float are a coarse logarithmic
+			// quantisation of it, and there is no need for a depth range.
+			SortKeyList::iterator i, iend;
+			iend = mSortKeys.end();
+			for (i = mSortKeys.begin(); i != iend; ++i)
+			{
+				float depth = static_cast<float>(
+					mKeyed[i->index].renderable->getSquaredViewDepth(cam));
+				uint64 quantised = RadixSortKeyTraits<float>::toUnsigned(depth) >> 12;
+				i->key = (i->key & ~SORT_KEY_DEPTH_MASK) | quantised;
+			}
+		}
+
+		mDepthCamera = cam;
+		if (cam)
+		{
+			mDepthPosition = cam->getDerivedPosition();
+			mDepthOrientation = cam->getDerivedOrientation();
+		}
+	}
+    //-----------------------------------------------------------------------
+	bool QueuedRenderableCollection::isSortRequired(const Camera* cam) const
+	{
+		if (!((mOrganisationMode & OM_SORT_DESCENDING) && mSortedDescending.size() > 1) &&
+			!((mOrganisationMode & OM_SORT_KEYED) && mSortKeys.size() > 1))
+			return false;
+
+		return !isSameView(cam, mSortedCamera, mSortedPosition, mSortedOrientation);
+	}
     //-----------------------------------------------------------------------
 	void QueuedRenderableCollection::sort(const Camera* cam)
     {
 		// ascending and descending sort both set bit 1
 		// We always sort descending, becuase the only difference is in the
 		// acceptVisitor method, where we iterate in reverse in ascending mode
-		if (mOrganisationMode & OM_SORT_DESCENDING)
+		if (!isSortRequired(cam))
+			return;
+
+		// Renderables are only asked for their depth here, never while sorting
+		if (!isSameView(cam, mDepthCamera, mDepthPosition, mDepthOrientation))
+			_calculateSortDepths(cam);
+
+		if ((mOrganisationMode & OM_SORT_DESCENDING) && mSortedDescending.size() > 1)
 		{
-			
 			// We can either use a stable_sort and the 'less' implementation,
-			// or a 2-pass radix sort (once by pass, then by distance, since
-			// radix sorting is inherently stable this will work)
-			// We use stable_sort if the number of items is 512 or less, since
-			// the complexity of the radix sort is approximately O(10N), since 
-			// each sort is O(5N) (1 pass histograms, 4 passes sort)
+			// or a radix sort on a 64-bit key of distance then pass (radix 
+			// sorting is inherently stable, so this orders by pass within the
+			// same distance)
+			// We use stable_sort if the number of items is 2000 or less, since
+			// the complexity of the radix sort is approximately O(7N)
+			// (1 pass histograms, up to 6 passes sort with 11 bit digits)
 			// Since stable_sort has a worst-case performance of O(N(logN)^2)
 			// the performance tipping point is from about 1500 items, but in
 			// stable_sorts best-case scenario O(NlogN) it would be much higher.
@@ -344,22 +427,55 @@ namespace Ogre {
 			
 			if (mSortedDescending.size() > 2000)
 			{
-				// sort by pass
-				msRadixSorter1.sort(mSortedDescending, RadixSortFunctorPass());
-				// sort by depth
-				msRadixSorter2.sort(mSortedDescending, RadixSortFunctorDistance(cam));
+				mRadixSorter.sort(mDepthSortEntries, 
+					RadixSortFunctorDistancePass(&mSortedDescending));
 			}
 			else
 			{
 				std::stable_sort(
-					mSortedDescending.begin(), mSortedDescending.end(), 
-					DepthSortDescendingLess(cam));
+					mDepthSortEntries.begin(), mDepthSortEntries.end(), 
+					DepthSortDescendingLess(&mSortedDescending));
 			}
+
+			// Put the items themselves in that order
+			size_t count = mSortedDescending.size();
+			mSortScratch.clear();
+			mSortScratch.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+				mSortScratch.push_back(mSortedDescending[mDepthSortEntries[i].index]);
+			mSortedDescending.swap(mSortScratch);
+		}
+
+		if ((mOrganisationMode & OM_SORT_KEYED) && mSortKeys.size() > 1)
+		{
+			sortKeyed();
 		}
 
+		mSortedCamera = cam;
+		if (cam)
+		{
+			mSortedPosition = cam->getDerivedPosition();
+			mSortedOrientation = cam->getDerivedOrientation();
+		}
+		// Items are in a new order, and the camera may move before the next sort
+		mDepthCamera = 0;
+
 		// Nothing needs to be done for pass groups, they auto-organise
 
     }
+    //-----------------------------------------------------------------------
+	void QueuedRenderableCollection::sortKeyed(void)
+	{
+		// Only keys and indices move; same tipping point as the depth sort
+		if (mSortKeys.size() > 2000)
+		{
+			mKeySorter.sort(mSortKeys, RadixSortFunctorKey());
+		}
+		else
+		{
+			std::stable_sort(mSortKeys.begin(), mSortKeys.end(), SortKeyLess());
+		}
+	}
     //-----------------------------------------------------------------------
     void QueuedRenderableCollection::addRenderable(Pass* pass, Renderable* rend)
 	{
@@ -367,6 +483,24 @@ namespace Ogre {
 		if (mOrganisationMode & OM_SORT_DESCENDING)
 		{
 			mSortedDescending.push_back(RenderablePass(rend, pass));
+			mSortedCamera = 0;
+			mDepthCamera = 0;
+		}
+
+		if (mOrganisationMode & OM_SORT_KEYED)
+		{
+			// Everything but the distance can be worked out now; the material
+			// keeps apart passes whose hash is the same, which is common for
+			// passes without textures
+			SortKeyEntry entry;
+			entry.key = (static_cast<uint64>(pass->getHash()) << SORT_KEY_PASS_SHIFT) |
+				(static_cast<uint64>(pass->getParent()->getParent()->getHandle() & 0xFFF) 
+					<< SORT_KEY_MATERIAL_SHIFT);
+			entry.index = static_cast<uint32>(mKeyed.size());
+			mKeyed.push_back(RenderablePass(rend, pass));
+			mSortKeys.push_back(entry);
+			mSortedCamera = 0;
+			mDepthCamera = 0;
 		}
 
 		if (mOrganisationMode & OM_PASS_GROUP)
@@ -401,6 +535,8 @@ namespace Ogre {
 			// try to fall back
 			if (OM_PASS_GROUP & mOrganisationMode)
 				om = OM_PASS_GROUP;
+			else if (OM_SORT_KEYED & mOrganisationMode)
+				om = OM_SORT_KEYED;
 			else if (OM_SORT_ASCENDING & mOrganisationMode)
 				om = OM_SORT_ASCENDING;
 			else if (OM_SORT_DESCENDING & mOrganisationMode)
@@ -423,6 +559,9 @@ namespace Ogre {
 		case OM_SORT_ASCENDING:
 			acceptVisitorAscending(visitor);
 			break;
+		case OM_SORT_KEYED:
+			acceptVisitorKeyed(visitor);
+			break;
 		}
 		
 	}
@@ -479,10 +618,50 @@ namespace Ogre {
 		}
 
 	}
+    //-----------------------------------------------------------------------
+	void QueuedRenderableCollection::acceptVisitorKeyed(
+		QueuedRenderableVisitor* visitor) const
+	{
+		// Visit in key order, as if grouped by pass; the pass is visited again
+		// whenever it changes
+		const Pass* lastPass = 0;
+		bool skip = false;
+		SortKeyList::const_iterator i, iend;
+		iend = mSortKeys.end();
+		for (i = mSortKeys.begin(); i != iend; ++i)
+		{
+			const RenderablePass& rp = mKeyed[i->index];
+			if (rp.pass != lastPass)
+			{
+				lastPass = rp.pass;
+				// Visit Pass - allow skip
+				skip = !visitor->visit(lastPass);
+			}
+
+			if (!skip)
+			{
+				// Visit Renderable
+				visitor->visit(rp.renderable);
+			}
+		}
+	}
     //-----------------------------------------------------------------------
 	void QueuedRenderableCollection::merge( const QueuedRenderableCollection& rhs )
 	{
 		mSortedDescending.insert( mSortedDescending.end(), rhs.mSortedDescending.begin(), rhs.mSortedDescending.end() );
+		mSortedCamera = 0;
+		mDepthCamera = 0;
+
+		// Keys refer to items by index, so offset them past our own items
+		uint32 keyedOffset = static_cast<uint32>(mKeyed.size());
+		mKeyed.insert( mKeyed.end(), rhs.mKeyed.begin(), rhs.mKeyed.end() );
+		SortKeyList::const_iterator srcKey;
+		for( srcKey = rhs.mSortKeys.begin(); srcKey != rhs.mSortKeys.end(); ++srcKey )
+		{
+			SortKeyEntry entry = *srcKey;
+			entry.index += keyedOffset;
+			mSortKeys.push_back(entry);
+		}
 
 		PassGroupRenderableMap::const_iterator srcGroup;
 		for( srcGroup = rhs.mGrouped.begin(); srcGroup != rhs.mGrouped.end(); ++srcGroup )
@@ -41,7 +41,8 @@ namespace Ogre
 		const String& group, bool isManual, ManualResourceLoader* loader)
 		: mCreator(creator), mName(name), mGroup(group), mHandle(handle), 
 		mLoadingState(LOADSTATE_UNLOADED), mIsBackgroundLoaded(false),
-		mSize(0), mIsManual(isManual), mLoader(loader), mStateCount(0)
+		mSize(0), mIsManual(isManual), mLoader(loader), mStateCount(0),
+		mLastUsedFrame(0)
 	{
 	}
 	//-----------------------------------------------------------------------
@@ -334,11 +335,12 @@ namespace Ogre
 	//-----------------------------------------------------------------------
 	void Resource::touch(void) 
 	{
-        // make sure loaded
-        load();
-
+		// Notify first so that the manager can tell whether we were loaded
 		if(mCreator)
 			mCreator->_notifyResourceTouched(this);
+
+        // make sure loaded
+        load();
 	}
 	//-----------------------------------------------------------------------
 	void Resource::addListener(Resource::Listener* lis)
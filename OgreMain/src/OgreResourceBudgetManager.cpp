@@ -0,0 +1,183 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreResourceBudgetManager.h"
+#include "OgreResourceManager.h"
+#include "OgreResourceGroupManager.h"
+
+namespace Ogre {
+
+    //-----------------------------------------------------------------------
+    template<> ResourceBudgetManager* Singleton<ResourceBudgetManager>::ms_Singleton = 0;
+    ResourceBudgetManager* ResourceBudgetManager::getSingletonPtr(void)
+    {
+        return ms_Singleton;
+    }
+    ResourceBudgetManager& ResourceBudgetManager::getSingleton(void)
+    {  
+        assert( ms_Singleton );  return ( *ms_Singleton );  
+    }
+	//---------------------------------------------------------------------
+	ResourceBudgetManager::ResourceBudgetManager()
+		: mMemoryBudget(0), mCurrentFrame(1)
+	{
+	}
+	//---------------------------------------------------------------------
+	ResourceBudgetManager::~ResourceBudgetManager()
+	{
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::setMemoryBudget(size_t bytes)
+	{
+		mMemoryBudget = bytes;
+		checkUsage();
+	}
+	//---------------------------------------------------------------------
+	size_t ResourceBudgetManager::getMemoryUsage() const
+	{
+		size_t usage = 0;
+		ResourceGroupManager::ResourceManagerIterator i = 
+			ResourceGroupManager::getSingleton().getResourceManagerIterator();
+		while (i.hasMoreElements())
+			usage += i.getNext()->getMemoryUsage();
+		return usage;
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::checkUsage()
+	{
+		ResourceManagerList managers;
+		size_t usage = 0;
+		ResourceGroupManager::ResourceManagerIterator i = 
+			ResourceGroupManager::getSingleton().getResourceManagerIterator();
+		while (i.hasMoreElements())
+		{
+			ResourceManager* rm = i.getNext();
+			checkUsage(rm);
+			managers.push_back(rm);
+			usage += rm->getMemoryUsage();
+		}
+
+		if (mMemoryBudget && usage > mMemoryBudget)
+			evict(managers, usage, mMemoryBudget);
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::checkUsage(ResourceManager* rm)
+	{
+		size_t usage = rm->getMemoryUsage();
+		if (usage > rm->getMemoryBudget())
+			evict(ResourceManagerList(1, rm), usage, rm->getMemoryBudget());
+	}
+	//---------------------------------------------------------------------
+	ResourceBudgetManager::Statistics ResourceBudgetManager::getStatistics() const
+	{
+		OGRE_LOCK_MUTEX(mStatisticsMutex)
+		return mStatistics;
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::resetStatistics()
+	{
+		OGRE_LOCK_MUTEX(mStatisticsMutex)
+		mStatistics = Statistics();
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::_notifyResourceTouched(Resource* res)
+	{
+		{
+			OGRE_LOCK_MUTEX(mStatisticsMutex)
+			if (res->isLoaded())
+				++mStatistics.hits;
+			else
+				++mStatistics.misses;
+		}
+		res->_notifyUsed(mCurrentFrame);
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::_notifyFrameEnded()
+	{
+		checkUsage();
+		++mCurrentFrame;
+	}
+	//---------------------------------------------------------------------
+	void ResourceBudgetManager::evict(const ResourceManagerList& managers, 
+		size_t usage, size_t budget)
+	{
+		// Unloading a resource can release others, such as the textures of a
+		// material, so go round again while that frees anything up
+		bool evicted = true;
+		while (usage > budget && evicted)
+		{
+			evicted = false;
+
+			// Resources only the resource system refers to which weren't used 
+			// this frame; least recently used first, then the largest
+			typedef std::pair<std::pair<unsigned long, size_t>, ResourcePtr> Candidate;
+			vector<Candidate>::type candidates;
+			for (ResourceManagerList::const_iterator m = managers.begin(); m != managers.end(); ++m)
+			{
+				ResourceManager* rm = *m;
+				OGRE_LOCK_MUTEX(rm->OGRE_AUTO_MUTEX_NAME)
+				ResourceManager::ResourceMapIterator i = rm->getResourceIterator();
+				while (i.hasMoreElements())
+				{
+					const ResourcePtr* res = i.peekNextValuePtr();
+					i.moveNext();
+					if (res->useCount() == ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS &&
+						(*res)->isLoaded() && (*res)->isReloadable() && 
+						(*res)->getLastUsedFrame() != mCurrentFrame)
+					{
+						candidates.push_back(Candidate(std::make_pair(
+							(*res)->getLastUsedFrame(), ~(*res)->getSize()), *res));
+					}
+				}
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			for (vector<Candidate>::type::iterator c = candidates.begin(); 
+				c != candidates.end() && usage > budget; ++c)
+			{
+				size_t size = c->second->getSize();
+				c->second->unload();
+				usage = usage > size ? usage - size : 0;
+				{
+					OGRE_LOCK_MUTEX(mStatisticsMutex)
+					++mStatistics.evictions;
+					mStatistics.bytesEvicted += size;
+				}
+				evicted = true;
+			}
+
+			if (evicted)
+			{
+				usage = 0;
+				for (ResourceManagerList::const_iterator m = managers.begin(); m != managers.end(); ++m)
+					usage += (*m)->getMemoryUsage();
+			}
+		}
+	}
+
+}
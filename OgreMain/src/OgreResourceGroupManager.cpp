@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreScriptLoader.h"
 #include "OgreSceneManager.h"
+#include "OgreParallelTaskGroup.h"
 
 namespace Ogre {
 
@@ -53,9 +54,61 @@ namespace Ogre {
 	// RGM has one (this one) and RM has 2 (by name and by handle)
 	size_t ResourceGroupManager::RESOURCE_SYSTEM_NUM_REFERENCE_COUNTS = 3;
     //-----------------------------------------------------------------------
+	//-----------------------------------------------------------------------
+	/** Reads a script into memory and lets its loader do the threadsafe part
+		of parsing it. */
+	class ResourceGroupManager::ScriptPrepareTask : public ParallelTaskGroup::Task
+	{
+	public:
+		ScriptLoader* loader;
+		const FileInfo* fileInfo;
+		const String* groupName;
+		DataStreamPtr stream;
+		Any prepared;
+
+		void execute()
+		{
+			try
+			{
+				DataStreamPtr source = fileInfo->archive->open(fileInfo->filename);
+				if (source.isNull())
+					return;
+				stream = DataStreamPtr(OGRE_NEW MemoryDataStream(
+					source->getName(), source, true, true));
+				prepared = loader->prepareScript(stream, *groupName);
+				stream->seek(0);
+			}
+			catch (std::exception&)
+			{
+				// The script is parsed from scratch later, which reports the error
+				stream.setNull();
+			}
+		}
+	};
+	//-----------------------------------------------------------------------
+	/** Prepares one resource ahead of the serial pass in prepareResourceGroup. */
+	class ResourceGroupManager::ResourcePrepareTask : public ParallelTaskGroup::Task
+	{
+	public:
+		ResourcePtr resource;
+
+		void execute()
+		{
+			try
+			{
+				resource->prepare();
+			}
+			catch (std::exception&)
+			{
+				// The resource is left unprepared, so the error is reported
+				// when it is prepared again in order
+			}
+		}
+	};
     //-----------------------------------------------------------------------
     ResourceGroupManager::ResourceGroupManager()
-        : mLoadingListener(0), mCurrentGroup(0)
+        : mLoadingListener(0), mParallelInitialisation(false), mTaskGroup(0), 
+		mCurrentGroup(0)
     {
         // Create the 'General' group
         createResourceGroup(DEFAULT_RESOURCE_GROUP_NAME);
@@ -77,6 +130,7 @@ namespace Ogre {
 			deleteGroup(i->second);
         }
         mResourceGroupMap.clear();
+		OGRE_DELETE mTaskGroup;
     }
     //-----------------------------------------------------------------------
     void ResourceGroupManager::createResourceGroup(const String& name, const bool inGlobalPool /* = true */)
@@ -156,6 +210,11 @@ namespace Ogre {
     void ResourceGroupManager::prepareResourceGroup(const String& name, 
 		bool prepareMainResources, bool prepareWorldGeom)
     {
+		// Do the bulk of the work up front; the loop below then finds the
+		// resources already prepared, but still fires all the events in order
+		if (mParallelInitialisation && prepareMainResources)
+			prepareResourcesParallel(name);
+
 		// Can only bulk-load one group at a time (reasonable limitation I think)
 		OGRE_LOCK_AUTO_MUTEX
 
@@ -561,7 +620,7 @@ namespace Ogre {
         // Index resources
         StringVectorPtr vec = pArch->find("*", recursive);
         for( StringVector::iterator it = vec->begin(); it != vec->end(); ++it )
-			grp->addToIndex(*it, pArch);
+			addToIndex(grp, *it, pArch);
 		
 		StringUtil::StrStreamType msg;
 		msg << "Added resource location '" << name << "' of type '" << locType
@@ -593,7 +652,7 @@ namespace Ogre {
 			Archive* pArch = (*li)->archive;
 			if (pArch->getName() == name)
 			{
-				grp->removeFromIndex(pArch);
+				removeFromIndex(grp, pArch);
 				// Erase list entry
 				OGRE_DELETE_T(*li, ResourceLocation, MEMCATEGORY_RESOURCE);
 				grp->locationList.erase(li);
@@ -687,50 +746,32 @@ namespace Ogre {
 
 		OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME) // lock group mutex
 
-		Archive* pArch = 0;
-		ResourceLocationIndex::iterator rit = grp->resourceIndexCaseSensitive.find(resourceName);
-		if (rit != grp->resourceIndexCaseSensitive.end())
+		Archive* pArch = grp->findInIndex(resourceName);
+		if (pArch)
 		{
 			// Found in the index
-			pArch = rit->second;
 			DataStreamPtr stream = pArch->open(resourceName);
 			if (mLoadingListener)
 				mLoadingListener->resourceStreamOpened(resourceName, groupName, resourceBeingLoaded, stream);
 			return stream;
 		}
-        else 
-        {
-            // try case insensitive
-            String lcResourceName = resourceName;
-            StringUtil::toLowerCase(lcResourceName);
-            rit = grp->resourceIndexCaseInsensitive.find(lcResourceName);
-            if (rit != grp->resourceIndexCaseInsensitive.end())
-            {
-                // Found in the index
-                pArch = rit->second;
-				DataStreamPtr stream = pArch->open(resourceName);
-				if (mLoadingListener)
-					mLoadingListener->resourceStreamOpened(resourceName, groupName, resourceBeingLoaded, stream);
-				return stream;
-            }
-		    else
-		    {
-			    // Search the hard way
-			    LocationList::iterator li, liend;
-			    liend = grp->locationList.end();
-			    for (li = grp->locationList.begin(); li != liend; ++li)
-			    {
-				    Archive* arch = (*li)->archive;
-                    if (arch->exists(resourceName))
-				    {
-                        DataStreamPtr ptr = arch->open(resourceName);
-						if (mLoadingListener)
-							mLoadingListener->resourceStreamOpened(resourceName, groupName, resourceBeingLoaded, ptr);
-					    return ptr;
-				    }
-			    }
-		    }
-        }
+		else
+		{
+			// Search the hard way
+			LocationList::iterator li, liend;
+			liend = grp->locationList.end();
+			for (li = grp->locationList.begin(); li != liend; ++li)
+			{
+				Archive* arch = (*li)->archive;
+				if (arch->exists(resourceName))
+				{
+					DataStreamPtr ptr = arch->open(resourceName);
+					if (mLoadingListener)
+						mLoadingListener->resourceStreamOpened(resourceName, groupName, resourceBeingLoaded, ptr);
+					return ptr;
+				}
+			}
+		}
 
 		
 		// Not found
@@ -830,7 +871,7 @@ namespace Ogre {
 				
 				// create it
 				DataStreamPtr ret = arch->create(filename);
-				grp->addToIndex(filename, arch);
+				addToIndex(grp, filename, arch);
 
 
 				return ret;
@@ -869,7 +910,7 @@ namespace Ogre {
 				if (arch->exists(filename))
 				{
 					arch->remove(filename);
-					grp->removeFromIndex(filename, arch);
+					removeFromIndex(grp, filename, arch);
 
 					// only remove one file
 					break;
@@ -906,7 +947,7 @@ namespace Ogre {
 				for (StringVector::iterator f = matchingFiles->begin(); f != matchingFiles->end(); ++f)
 				{
 					arch->remove(*f);
-					grp->removeFromIndex(*f, arch);
+					removeFromIndex(grp, *f, arch);
 
 				}
 			}
@@ -1049,6 +1090,39 @@ namespace Ogre {
 		// Fire scripting event
 		fireResourceGroupScriptingStarted(grp->name, scriptCount);
 
+		// Read and prepare all the scripts concurrently, in the same order 
+		// as they are parsed below
+		vector<ScriptPrepareTask>::type prepareTasks;
+		if (mParallelInitialisation)
+		{
+			prepareTasks.reserve(scriptCount);
+			for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
+				slfli != scriptLoaderFileList.end(); ++slfli)
+			{
+				for (FileListList::iterator flli = slfli->second->begin(); flli != slfli->second->end(); ++flli)
+				{
+					for (FileInfoList::iterator fii = (*flli)->begin(); fii != (*flli)->end(); ++fii)
+					{
+						prepareTasks.push_back(ScriptPrepareTask());
+						ScriptPrepareTask& task = prepareTasks.back();
+						task.loader = slfli->first;
+						task.fileInfo = &(*fii);
+						task.groupName = &grp->name;
+					}
+				}
+			}
+
+			OGRE_LOCK_MUTEX(mTaskGroupMutex)
+			ParallelTaskGroup* taskGroup = getTaskGroup();
+			for (vector<ScriptPrepareTask>::type::iterator t = prepareTasks.begin();
+				t != prepareTasks.end(); ++t)
+			{
+				taskGroup->addTask(&(*t));
+			}
+			taskGroup->run();
+		}
+		vector<ScriptPrepareTask>::type::iterator nextPrepared = prepareTasks.begin();
+
 		// Iterate over scripts and parse
 		// Note we respect original ordering
         for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
@@ -1061,6 +1135,18 @@ namespace Ogre {
 			    // Iterate over each item in the list
 			    for (FileInfoList::iterator fii = (*flli)->begin(); fii != (*flli)->end(); ++fii)
 			    {
+					// Take over whatever was prepared for this script
+					DataStreamPtr stream;
+					Any prepared;
+					if (nextPrepared != prepareTasks.end())
+					{
+						stream = nextPrepared->stream;
+						prepared = nextPrepared->prepared;
+						nextPrepared->stream.setNull();
+						nextPrepared->prepared = Any();
+						++nextPrepared;
+					}
+
 					bool skipScript = false;
                     fireScriptStarted(fii->filename, skipScript);
 					if(skipScript)
@@ -1072,12 +1158,23 @@ namespace Ogre {
 					{
 						LogManager::getSingleton().logMessage(
 							"Parsing script " + fii->filename);
-                        DataStreamPtr stream = fii->archive->open(fii->filename);
+						bool isPrepared = !stream.isNull();
+						if (!isPrepared)
+							stream = fii->archive->open(fii->filename);
                         if (!stream.isNull())
                         {
 							if (mLoadingListener)
+							{
+								DataStream* opened = stream.get();
 								mLoadingListener->resourceStreamOpened(fii->filename, grp->name, 0, stream);
-                            su->parseScript(stream, grp->name);
+								// What was prepared doesn't apply to a replacement stream
+								if (stream.get() != opened)
+									isPrepared = false;
+							}
+							if (isPrepared)
+								su->parsePreparedScript(stream, grp->name, prepared);
+							else
+								su->parseScript(stream, grp->name);
                         }
                     }
 					fireScriptEnded(fii->filename, skipScript);
@@ -1120,6 +1217,50 @@ namespace Ogre {
 		}
 
 	}
+	//-----------------------------------------------------------------------
+	void ResourceGroupManager::prepareResourcesParallel(const String& name)
+	{
+		vector<ResourcePrepareTask>::type tasks;
+		{
+			OGRE_LOCK_AUTO_MUTEX
+			ResourceGroup* grp = getResourceGroup(name);
+			if (!grp)
+				return; // prepareResourceGroup reports this
+
+			OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME) // lock group mutex
+			for (ResourceGroup::LoadResourceOrderMap::iterator oi = grp->loadResourceOrderMap.begin(); 
+				oi != grp->loadResourceOrderMap.end(); ++oi)
+			{
+				for (LoadUnloadResourceList::iterator l = oi->second->begin(); 
+					l != oi->second->end(); ++l)
+				{
+					// Manual loaders are user code which may not be threadsafe
+					if ((*l)->isManuallyLoaded())
+						continue;
+					tasks.push_back(ResourcePrepareTask());
+					tasks.back().resource = *l;
+				}
+			}
+		}
+
+		// The locks must not be held from here, since resources open their 
+		// files through this class while they are being prepared
+		OGRE_LOCK_MUTEX(mTaskGroupMutex)
+		ParallelTaskGroup* taskGroup = getTaskGroup();
+		for (vector<ResourcePrepareTask>::type::iterator t = tasks.begin(); 
+			t != tasks.end(); ++t)
+		{
+			taskGroup->addTask(&(*t));
+		}
+		taskGroup->run();
+	}
+	//-----------------------------------------------------------------------
+	ParallelTaskGroup* ResourceGroupManager::getTaskGroup()
+	{
+		if (!mTaskGroup)
+			mTaskGroup = OGRE_NEW ParallelTaskGroup("ResourceGroupManager");
+		return mTaskGroup;
+	}
     //-----------------------------------------------------------------------
 	void ResourceGroupManager::_notifyResourceCreated(ResourcePtr& res)
 	{
@@ -1328,6 +1469,7 @@ namespace Ogre {
 	{
         {
 		    OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME)
+		    removeFromIndex(grp, 0);
 		    // delete all the load list entries
 		    ResourceGroup::LoadResourceOrderMap::iterator j, jend;
 		    jend = grp->loadResourceOrderMap.end();
@@ -1613,11 +1755,38 @@ namespace Ogre {
 
         OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME) // lock group mutex
 
+		// A plain file name which has been indexed can only be found in the 
+		// archives it was indexed in, or in the sub folders of recursive ones
+		set<Archive*>::type indexedArchives;
+		if (!dirs && pattern.find_first_of("*/\\") == String::npos)
+		{
+			String lcPattern = pattern;
+			StringUtil::toLowerCase(lcPattern);
+			OGRE_LOCK_MUTEX(mGlobalIndexMutex)
+			GlobalResourceIndex::iterator gi = mGlobalResourceIndex.find(pattern);
+			if (gi != mGlobalResourceIndex.end())
+			{
+				for (GlobalIndexEntryList::iterator e = gi->second.begin(); e != gi->second.end(); ++e)
+					if (e->group == grp)
+						indexedArchives.insert(e->archive);
+			}
+			gi = mGlobalResourceIndex.find(lcPattern);
+			if (gi != mGlobalResourceIndex.end())
+			{
+				for (GlobalIndexEntryList::iterator e = gi->second.begin(); e != gi->second.end(); ++e)
+					if (e->group == grp && !e->archive->isCaseSensitive())
+						indexedArchives.insert(e->archive);
+			}
+		}
+
             // Iterate over the archives
             LocationList::iterator i, iend;
         iend = grp->locationList.end();
         for (i = grp->locationList.begin(); i != iend; ++i)
         {
+			if (!indexedArchives.empty() && !(*i)->recursive &&
+				indexedArchives.find((*i)->archive) == indexedArchives.end())
+				continue;
             FileInfoListPtr lst = (*i)->archive->findFileInfo(pattern, (*i)->recursive, dirs);
             vec->insert(vec->end(), lst->begin(), lst->end());
         }
@@ -1647,38 +1816,25 @@ namespace Ogre {
 		OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME) // lock group mutex
 
 		// Try indexes first
-		ResourceLocationIndex::iterator rit = grp->resourceIndexCaseSensitive.find(resourceName);
-		if (rit != grp->resourceIndexCaseSensitive.end())
+		if (grp->findInIndex(resourceName))
 		{
 			// Found in the index
 			return true;
 		}
-        else 
-        {
-            // try case insensitive
-            String lcResourceName = resourceName;
-            StringUtil::toLowerCase(lcResourceName);
-            rit = grp->resourceIndexCaseInsensitive.find(lcResourceName);
-            if (rit != grp->resourceIndexCaseInsensitive.end())
-            {
-                // Found in the index
-                return true;
-            }
-		    else
-		    {
-			    // Search the hard way
-			    LocationList::iterator li, liend;
-			    liend = grp->locationList.end();
-			    for (li = grp->locationList.begin(); li != liend; ++li)
-			    {
-				    Archive* arch = (*li)->archive;
-                    if (arch->exists(resourceName))
-				    {
-						return true;
-				    }
-			    }
-		    }
-        }
+		else
+		{
+			// Search the hard way
+			LocationList::iterator li, liend;
+			liend = grp->locationList.end();
+			for (li = grp->locationList.begin(); li != liend; ++li)
+			{
+				Archive* arch = (*li)->archive;
+				if (arch->exists(resourceName))
+				{
+					return true;
+				}
+			}
+		}
 
 		return false;
 
@@ -1706,38 +1862,27 @@ namespace Ogre {
 		OGRE_LOCK_MUTEX(grp->OGRE_AUTO_MUTEX_NAME) // lock group mutex
 
 		// Try indexes first
-		ResourceLocationIndex::iterator rit = grp->resourceIndexCaseSensitive.find(resourceName);
-		if (rit != grp->resourceIndexCaseSensitive.end())
+		Archive* pArch = grp->findInIndex(resourceName);
+		if (pArch)
 		{
-			return rit->second->getModifiedTime(resourceName);
+			return pArch->getModifiedTime(resourceName);
 		}
-        else 
-        {
-            // try case insensitive
-            String lcResourceName = resourceName;
-            StringUtil::toLowerCase(lcResourceName);
-            rit = grp->resourceIndexCaseInsensitive.find(lcResourceName);
-            if (rit != grp->resourceIndexCaseInsensitive.end())
-            {
-				return rit->second->getModifiedTime(resourceName);
-            }
-		    else
-		    {
-			    // Search the hard way
-			    LocationList::iterator li, liend;
-			    liend = grp->locationList.end();
-			    for (li = grp->locationList.begin(); li != liend; ++li)
-			    {
-				    Archive* arch = (*li)->archive;
-					time_t testTime = arch->getModifiedTime(resourceName);
+		else
+		{
+			// Search the hard way
+			LocationList::iterator li, liend;
+			liend = grp->locationList.end();
+			for (li = grp->locationList.begin(); li != liend; ++li)
+			{
+				Archive* arch = (*li)->archive;
+				time_t testTime = arch->getModifiedTime(resourceName);
 
-                    if (testTime > 0)
-				    {
-						return testTime;
-				    }
-			    }
-		    }
-        }
+				if (testTime > 0)
+				{
+					return testTime;
+				}
+			}
+		}
 
 		return 0;
 	}
@@ -1747,7 +1892,42 @@ namespace Ogre {
 	{
         OGRE_LOCK_AUTO_MUTEX
 
-			// Iterate over resource groups and find
+		{
+			// Try the global index first; if the name is in several groups, 
+			// pick the one which comes first in order
+			OGRE_LOCK_MUTEX(mGlobalIndexMutex)
+			ResourceGroup* found = 0;
+			GlobalResourceIndex::iterator gi = mGlobalResourceIndex.find(filename);
+			if (gi != mGlobalResourceIndex.end())
+			{
+				for (GlobalIndexEntryList::iterator e = gi->second.begin(); e != gi->second.end(); ++e)
+				{
+					if (!found || e->group->name < found->name)
+						found = e->group;
+				}
+			}
+			String lcFilename = filename;
+			StringUtil::toLowerCase(lcFilename);
+			if (lcFilename != filename)
+			{
+				gi = mGlobalResourceIndex.find(lcFilename);
+				if (gi != mGlobalResourceIndex.end())
+				{
+					for (GlobalIndexEntryList::iterator e = gi->second.begin(); e != gi->second.end(); ++e)
+					{
+						// lower case names only match case insensitive archives
+						if (!e->archive->isCaseSensitive() &&
+							(!found || e->group->name < found->name))
+							found = e->group;
+					}
+				}
+			}
+			if (found)
+				return found;
+		}
+
+		// Not indexed anywhere, so search the groups in order for names the 
+		// archives can find but don't list
 		for (ResourceGroupMap::iterator i = mResourceGroupMap.begin();
 			i != mResourceGroupMap.end(); ++i)
 		{
@@ -1971,7 +2151,7 @@ namespace Ogre {
 		{
 			String lcase = filename;
 			StringUtil::toLowerCase(lcase);
-			i = this->resourceIndexCaseInsensitive.find(filename);
+			i = this->resourceIndexCaseInsensitive.find(lcase);
 			if (i != this->resourceIndexCaseInsensitive.end() && i->second == arch)
 				this->resourceIndexCaseInsensitive.erase(i);
 		}
@@ -2010,10 +2190,121 @@ namespace Ogre {
 
 	}
 	//---------------------------------------------------------------------
+	Archive* ResourceGroupManager::ResourceGroup::findInIndex(const String& filename) const
+	{
+		// internal, assumes mutex lock has already been obtained
+		ResourceLocationIndex::const_iterator i = this->resourceIndexCaseSensitive.find(filename);
+		if (i != this->resourceIndexCaseSensitive.end())
+			return i->second;
+
+		// only lower case the name if the exact name wasn't found
+		if (this->resourceIndexCaseInsensitive.empty())
+			return 0;
+		String lcase = filename;
+		StringUtil::toLowerCase(lcase);
+		i = this->resourceIndexCaseInsensitive.find(lcase);
+		if (i != this->resourceIndexCaseInsensitive.end())
+			return i->second;
+		return 0;
+	}
+	//---------------------------------------------------------------------
+	void ResourceGroupManager::addToIndex(ResourceGroup* grp, const String& filename, 
+		Archive* arch)
+	{
+		// internal, assumes group mutex lock has already been obtained
+		grp->addToIndex(filename, arch);
+
+		String key = filename;
+		if (!arch->isCaseSensitive())
+			StringUtil::toLowerCase(key);
+
+		OGRE_LOCK_MUTEX(mGlobalIndexMutex)
+		GlobalIndexEntryList& entries = mGlobalResourceIndex[key];
+		for (GlobalIndexEntryList::iterator e = entries.begin(); e != entries.end(); ++e)
+		{
+			if (e->group == grp && e->archive == arch)
+				return;
+		}
+		GlobalIndexEntry entry;
+		entry.group = grp;
+		entry.archive = arch;
+		entries.push_back(entry);
+	}
+	//---------------------------------------------------------------------
+	void ResourceGroupManager::removeFromIndex(ResourceGroup* grp, const String& filename, 
+		Archive* arch)
+	{
+		// internal, assumes group mutex lock has already been obtained
+		grp->removeFromIndex(filename, arch);
+
+		String key = filename;
+		if (!arch->isCaseSensitive())
+			StringUtil::toLowerCase(key);
+
+		OGRE_LOCK_MUTEX(mGlobalIndexMutex)
+		GlobalResourceIndex::iterator gi = mGlobalResourceIndex.find(key);
+		if (gi == mGlobalResourceIndex.end())
+			return;
+		GlobalIndexEntryList& entries = gi->second;
+		for (GlobalIndexEntryList::iterator e = entries.begin(); e != entries.end(); ++e)
+		{
+			if (e->group == grp && e->archive == arch)
+			{
+				entries.erase(e);
+				break;
+			}
+		}
+		if (entries.empty())
+			mGlobalResourceIndex.erase(gi);
+	}
+	//---------------------------------------------------------------------
+	void ResourceGroupManager::removeFromIndex(ResourceGroup* grp, Archive* arch)
+	{
+		// internal, assumes group mutex lock has already been obtained
+		if (arch)
+			grp->removeFromIndex(arch);
+
+		// Rare enough (removing a location or group) that a full pass is fine
+		OGRE_LOCK_MUTEX(mGlobalIndexMutex)
+		GlobalResourceIndex::iterator gi = mGlobalResourceIndex.begin();
+		while (gi != mGlobalResourceIndex.end())
+		{
+			GlobalIndexEntryList& entries = gi->second;
+			GlobalIndexEntryList::iterator e = entries.begin();
+			while (e != entries.end())
+			{
+				if (e->group == grp && (!arch || e->archive == arch))
+					e = entries.erase(e);
+				else
+					++e;
+			}
+			if (entries.empty())
+			{
+				GlobalResourceIndex::iterator del = gi++;
+				mGlobalResourceIndex.erase(del);
+			}
+			else
+			{
+				++gi;
+			}
+		}
+	}
+	//---------------------------------------------------------------------
 	//-----------------------------------------------------------------------
 	ScriptLoader::~ScriptLoader()
 	{
 	}
+	//-----------------------------------------------------------------------
+	Any ScriptLoader::prepareScript(DataStreamPtr& stream, const String& groupName)
+	{
+		return Any();
+	}
+	//-----------------------------------------------------------------------
+	void ScriptLoader::parsePreparedScript(DataStreamPtr& stream, const String& groupName, 
+		const Any& prepared)
+	{
+		parseScript(stream, groupName);
+	}
 
 
 }
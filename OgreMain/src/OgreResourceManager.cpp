@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreStringVector.h"
 #include "OgreStringConverter.h"
 #include "OgreResourceGroupManager.h"
+#include "OgreResourceBudgetManager.h"
 
 namespace Ogre {
 
@@ -470,12 +471,16 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ResourceManager::checkUsage(void)
     {
-        // TODO Page out here?
+		ResourceBudgetManager* budgetMgr = ResourceBudgetManager::getSingletonPtr();
+		if (budgetMgr)
+			budgetMgr->checkUsage(this);
     }
 	//-----------------------------------------------------------------------
 	void ResourceManager::_notifyResourceTouched(Resource* res)
 	{
-		// TODO
+		ResourceBudgetManager* budgetMgr = ResourceBudgetManager::getSingletonPtr();
+		if (budgetMgr)
+			budgetMgr->_notifyResourceTouched(res);
 	}
 	//-----------------------------------------------------------------------
 	void ResourceManager::_notifyResourceLoaded(Resource* res)
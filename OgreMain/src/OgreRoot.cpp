@@ -56,6 +56,9 @@ THE SOFTWARE.
 #include "OgreFileSystem.h"
 #include "OgreShadowVolumeExtrudeProgram.h"
 #include "OgreResourceBackgroundQueue.h"
+#include "OgreTextureStreamer.h"
+#include "OgreResourceBudgetManager.h"
+#include "OgreParallelTaskGroup.h"
 #include "OgreEntity.h"
 #include "OgreBillboardSet.h"
 #include "OgreBillboardChain.h"
@@ -79,6 +82,9 @@ THE SOFTWARE.
 #if OGRE_NO_ZIP_ARCHIVE == 0
 #include "OgreZip.h"
 #endif
+#if OGRE_NO_PACK_ARCHIVE == 0
+#include "OgrePackArchive.h"
+#endif
 
 #include "OgreFontManager.h"
 #include "OgreHardwareBufferManager.h"
@@ -125,6 +131,8 @@ namespace Ogre {
 	  , mRemoveQueueStructuresOnClear(false)
 	  , mNextMovableObjectTypeFlag(1)
 	  , mIsInitialised(false)
+	  , mTaskGroup(0)
+	  , mTaskGroupInUse(false)
     {
         // superclass will do singleton checking
         String msg;
@@ -152,6 +160,7 @@ namespace Ogre {
 
 		// ResourceGroupManager
 		mResourceGroupManager = OGRE_NEW ResourceGroupManager();
+		mResourceBudgetManager = OGRE_NEW ResourceBudgetManager();
 
 		// WorkQueue (note: users can replace this if they want)
 		DefaultWorkQueue* defaultQ = OGRE_NEW DefaultWorkQueue("Root");
@@ -174,6 +183,7 @@ namespace Ogre {
 
 		// ResourceBackgroundQueue
 		mResourceBackgroundQueue = OGRE_NEW ResourceBackgroundQueue();
+		mTextureStreamer = OGRE_NEW TextureStreamer();
 
 		// Create SceneManager enumerator (note - will be managed by singleton)
         mSceneManagerEnum = OGRE_NEW SceneManagerEnumerator();
@@ -227,6 +237,10 @@ namespace Ogre {
         mZipArchiveFactory = OGRE_NEW ZipArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mZipArchiveFactory );
 #endif
+#if OGRE_NO_PACK_ARCHIVE == 0
+        mPackArchiveFactory = OGRE_NEW PackArchiveFactory();
+        ArchiveManager::getSingleton().addArchiveFactory( mPackArchiveFactory );
+#endif
 #if OGRE_NO_DDS_CODEC == 0
 		// Register image codecs
 		DDSCodec::startup();
@@ -314,6 +328,9 @@ namespace Ogre {
         OGRE_DELETE mArchiveManager;
 #if OGRE_NO_ZIP_ARCHIVE == 0
         OGRE_DELETE mZipArchiveFactory;
+#endif
+#if OGRE_NO_PACK_ARCHIVE == 0
+        OGRE_DELETE mPackArchiveFactory;
 #endif
         OGRE_DELETE mFileSystemArchiveFactory;
         OGRE_DELETE mSkeletonManager;
@@ -332,7 +349,9 @@ namespace Ogre {
         unloadPlugins();
         OGRE_DELETE mMaterialManager;
         Pass::processPendingPassUpdates(); // make sure passes are cleaned
+		OGRE_DELETE mTextureStreamer;
 		OGRE_DELETE mResourceBackgroundQueue;
+		OGRE_DELETE mResourceBudgetManager;
         OGRE_DELETE mResourceGroupManager;
 
 		OGRE_DELETE mEntityFactory;
@@ -342,6 +361,7 @@ namespace Ogre {
 		OGRE_DELETE mBillboardChainFactory;
 		OGRE_DELETE mRibbonTrailFactory;
 
+		OGRE_DELETE mTaskGroup;
 		OGRE_DELETE mWorkQueue;
 
 		OGRE_DELETE mTimer;
@@ -863,6 +883,9 @@ namespace Ogre {
 		// Tell the queue to process responses
 		mWorkQueue->processResponses();
 
+		// Unload resources which haven't been used lately if over budget
+		mResourceBudgetManager->_notifyFrameEnded();
+
 		OgreProfileEndGroup("Frame", OGREPROF_GENERAL);
 
         return ret;
@@ -993,6 +1016,7 @@ namespace Ogre {
     {
 		// Since background thread might be access resources,
 		// ensure shutdown before destroying resource manager.
+		mTextureStreamer->shutdown();
 		mResourceBackgroundQueue->shutdown();
 		mWorkQueue->shutdown();
 
@@ -1345,6 +1369,7 @@ namespace Ogre {
         {
 			// Background loader
 			mResourceBackgroundQueue->initialise();
+			mTextureStreamer->initialise();
 			mWorkQueue->startup();
 			// Initialise material manager
 			mMaterialManager->initialise();
@@ -1570,6 +1595,25 @@ namespace Ogre {
 
 		}
 	}
+	//---------------------------------------------------------------------
+	ParallelTaskGroup* Root::_acquireTaskGroup()
+	{
+		OGRE_LOCK_MUTEX(mTaskGroupMutex)
+		if (mTaskGroupInUse)
+			return 0;
+		if (!mTaskGroup)
+			mTaskGroup = OGRE_NEW ParallelTaskGroup("Root");
+		mTaskGroupInUse = true;
+		return mTaskGroup;
+	}
+	//---------------------------------------------------------------------
+	void Root::_releaseTaskGroup(ParallelTaskGroup* group)
+	{
+		OGRE_LOCK_MUTEX(mTaskGroupMutex)
+		assert(group == mTaskGroup && mTaskGroupInUse);
+		mTaskGroupInUse = false;
+	}
+
 
 
 
@@ -194,6 +194,8 @@ __MM_DECL_OP2(sub_ss, subss, xm)
 __MM_DECL_OP2(mul_ps, mulps, xm)
 __MM_DECL_OP2(mul_ss, mulss, xm)
 
+__MM_DECL_OP2(or_ps, orps, xm)
+__MM_DECL_OP2(andnot_ps, andnps, xm)
 __MM_DECL_OP2(xor_ps, xorps, xm)
 
 __MM_DECL_OP2(unpacklo_ps, unpcklps, xm)
@@ -202,6 +204,7 @@ __MM_DECL_OP2(unpackhi_ps, unpckhps, xm)
 __MM_DECL_OP2(movehl_ps, movhlps, x)
 __MM_DECL_OP2(movelh_ps, movlhps, x)
 
+__MM_DECL_OP2(cmplt_ps, cmpltps, xm)
 __MM_DECL_OP2(cmpnle_ps, cmpnleps, xm)
 
 #undef __MM_DECL_OP2
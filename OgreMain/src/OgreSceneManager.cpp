@@ -30,11 +30,13 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 
 #include "OgreCamera.h"
+#include "OgreAxisAlignedBoxBatch.h"
 #include "OgreRenderSystem.h"
 #include "OgreMeshManager.h"
 #include "OgreMesh.h"
 #include "OgreSubMesh.h"
 #include "OgreEntity.h"
+#include "OgreSkeletonInstance.h"
 #include "OgreSubEntity.h"
 #include "OgreLight.h"
 #include "OgreMath.h"
@@ -71,6 +73,7 @@ THE SOFTWARE.
 #include "OgreProfiler.h"
 #include "OgreCompositorManager.h"
 #include "OgreCompositorChain.h"
+#include "OgreSoftwareAnimationBatch.h"
 // This class implements the most basic scene manager
 
 #include <cstdio>
@@ -151,6 +154,20 @@ mFindVisibleObjects(true),
 mSuppressRenderStateChanges(false),
 mSuppressShadows(false),
 mCameraRelativeRendering(false),
+mParallelSceneGraphUpdate(false),
+mParallelTaskGroup(0),
+mBatchedSceneGraphUpdate(false),
+mNodeTransformBatch(0),
+mBatchedFrustumCulling(false),
+mCullBatch(0),
+mMultiCameraCulling(false),
+mCameraCullBatch(0),
+mParallelRenderQueueSort(false),
+mParallelSoftwareAnimation(false),
+mSoftwareAnimationBatch(0),
+mCollectingSoftwareAnimation(false),
+mParallelSkeletalAnimation(false),
+mCollectingSkeletalAnimation(false),
 mLastLightHash(0),
 mLastLightLimit(0),
 mLastLightHashGpuProgram(0),
@@ -214,7 +231,14 @@ SceneManager::~SceneManager()
 	}
 
 	OGRE_DELETE mShadowCasterQueryListener;
+	// The batch executes outstanding work on its task group when deleted
+	OGRE_DELETE mSoftwareAnimationBatch;
+	OGRE_DELETE mParallelTaskGroup;
     OGRE_DELETE mSceneRoot;
+	// Nodes notify the batch when destroyed, so delete it afterwards
+	OGRE_DELETE mNodeTransformBatch;
+	OGRE_DELETE mCullBatch;
+	OGRE_DELETE mCameraCullBatch;
     OGRE_DELETE mFullScreenQuad;
     OGRE_DELETE mShadowCasterSphereQuery;
     OGRE_DELETE mShadowCasterAABBQuery;
@@ -348,8 +372,12 @@ void SceneManager::destroyCamera(const String& name)
 		if ( camLightIt != mShadowCamLightMapping.end() )
 			mShadowCamLightMapping.erase( camLightIt );
 
-		// Notify render system
-        mDestRenderSystem->_notifyCameraRemoved(i->second);
+		// Drop any culling results waiting for it
+		mCulledCameraIndex.erase( i->second );
+
+		// Notify render system, if there is one yet
+		if (mDestRenderSystem)
+			mDestRenderSystem->_notifyCameraRemoved(i->second);
         OGRE_DELETE i->second;
         mCameras.erase(i);
     }
@@ -1465,10 +1493,30 @@ void SceneManager::_renderScene(Camera* camera, Viewport* vp, bool includeOverla
 
 			// Parse the scene and tag visibles
 			firePreFindVisibleObjects(vp);
+			// Entities queued add their software animation to the batch
+			bool wasCollecting = mCollectingSoftwareAnimation;
+			mCollectingSoftwareAnimation = mParallelSoftwareAnimation;
+			mCollectingSkeletalAnimation = mParallelSkeletalAnimation;
 			_findVisibleObjects(camera, &(camVisObjIt->second),
 				mIlluminationStage == IRS_RENDER_TO_TEXTURE? true : false);
+			mCollectingSkeletalAnimation = false;
+			if (!mDeferredAnimations.empty())
+			{
+				OgreProfileGroup("skeletalAnimation", OGREPROF_GENERAL);
+				updateDeferredAnimation();
+			}
+			mCollectingSoftwareAnimation = wasCollecting;
+			if (mSoftwareAnimationBatch)
+			{
+				OgreProfileGroup("softwareAnimation", OGREPROF_GENERAL);
+				mSoftwareAnimationBatch->execute();
+			}
 			firePostFindVisibleObjects(vp);
 
+			// Anything culled along with the shadow cameras is stale now
+			if (mIlluminationStage != IRS_RENDER_TO_TEXTURE)
+				mCulledCameraIndex.clear();
+
 			mAutoParamDataSource->setMainCamBoundsInfo(&(camVisObjIt->second));
 		}
 		// Add overlays, if viewport deems it
@@ -2181,22 +2229,319 @@ void SceneManager::_updateSceneGraph(Camera* cam)
     // In this implementation, just update from the root
     // Smarter SceneManager subclasses may choose to update only
     //   certain scene graph branches
+#if OGRE_THREAD_SUPPORT
+	if (mParallelSceneGraphUpdate && isParallelSceneGraphUpdateSupported())
+	{
+		updateSceneGraphParallel();
+		return;
+	}
+#endif
+	if (mBatchedSceneGraphUpdate && isBatchedSceneGraphUpdateSupported())
+	{
+		updateSceneGraphBatched();
+		return;
+	}
     getRootSceneNode()->_update(true, false);
 
 
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphBatched()
+{
+	if (!mNodeTransformBatch)
+		mNodeTransformBatch = OGRE_NEW NodeTransformBatch(getRootSceneNode());
+
+	mNodeTransformBatch->update();
+
+	// Update bounds children first, as a recursive _update would
+	const NodeTransformBatch::NodeList& nodes = mNodeTransformBatch->getUpdatedNodes();
+	for (NodeTransformBatch::NodeList::const_reverse_iterator i = nodes.rbegin(); 
+		i != nodes.rend(); ++i)
+	{
+		static_cast<SceneNode*>(*i)->_updateBounds();
+	}
+}
+//-----------------------------------------------------------------------
+void SceneManager::_notifySceneNodeHierarchyChanged(void)
+{
+	if (mNodeTransformBatch)
+		mNodeTransformBatch->_notifyHierarchyChanged();
+}
+//-----------------------------------------------------------------------
+ParallelTaskGroup* SceneManager::getParallelTaskGroup()
+{
+	if (!mParallelTaskGroup)
+		mParallelTaskGroup = OGRE_NEW ParallelTaskGroup("SceneManager/" + mName);
+	return mParallelTaskGroup;
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSceneGraphParallel()
+{
+	ParallelTaskGroup* group = getParallelTaskGroup();
+	// Aim for a few subtrees per thread so uneven subtrees balance out
+	size_t targetTasks = group->getMaxConcurrency() * 4;
+	// Don't split more than this many levels deep; splitting is serial
+	const size_t maxSplitDepth = 4;
+
+	Node::PendingChildUpdateList pending, next;
+	mSceneGraphSplitNodes.clear();
+	mSceneGraphSplitNodes.push_back(getRootSceneNode());
+	getRootSceneNode()->_updateSelf(false, pending);
+
+	// Split breadth first until there are enough subtrees to go round
+	for (size_t depth = 1; depth < maxSplitDepth && pending.size() < targetTasks; ++depth)
+	{
+		bool split = false;
+		next.clear();
+		for (Node::PendingChildUpdateList::iterator i = pending.begin(); i != pending.end(); ++i)
+		{
+			if (i->first->numChildren())
+			{
+				SceneNode* sn = static_cast<SceneNode*>(i->first);
+				sn->_updateSelf(i->second, next);
+				mSceneGraphSplitNodes.push_back(sn);
+				split = true;
+			}
+			else
+			{
+				next.push_back(*i);
+			}
+		}
+		pending.swap(next);
+		if (!split)
+			break;
+	}
+
+	mSceneGraphUpdateTasks.clear();
+	mSceneGraphUpdateTasks.reserve(pending.size());
+	for (Node::PendingChildUpdateList::iterator i = pending.begin(); i != pending.end(); ++i)
+	{
+		mSceneGraphUpdateTasks.push_back(SceneGraphUpdateTask(i->first, i->second));
+	}
+	// Only add pointers once the list has stopped growing
+	for (SceneGraphUpdateTaskList::iterator i = mSceneGraphUpdateTasks.begin(); 
+		i != mSceneGraphUpdateTasks.end(); ++i)
+	{
+		group->addTask(&(*i));
+	}
+	group->run();
+
+	// Merge bounds of the split nodes bottom up; _updateBounds always merges 
+	// children in the same order so the result matches a serial update exactly
+	for (SplitSceneNodeList::reverse_iterator i = mSceneGraphSplitNodes.rbegin(); 
+		i != mSceneGraphSplitNodes.rend(); ++i)
+	{
+		(*i)->_updateBounds();
+	}
+
 }
 //-----------------------------------------------------------------------
 void SceneManager::_findVisibleObjects(
 	Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
 {
+	// Already culled along with other cameras?
+	CulledCameraIndexMap::iterator culledIt = mCulledCameraIndex.find(cam);
+	if (culledIt != mCulledCameraIndex.end())
+	{
+		const CulledCamera& culled = mCulledCameras[culledIt->second];
+		mCulledCameraIndex.erase(culledIt);
+
+		// Only usable if the camera has not moved since, listeners may move it
+		Plane planes[6];
+		size_t numPlanes = cam->getCullingPlanes(planes);
+		if (numPlanes == culled.numPlanes && 
+			std::equal(planes, planes + numPlanes, culled.planes))
+		{
+			addVisibleCandidate(0, mCameraCullCandidates, &culled.visible[0], cam, 
+				getRenderQueue(), visibleBounds, onlyShadowCasters);
+			return;
+		}
+	}
+
+	if (mBatchedFrustumCulling)
+	{
+		findVisibleObjectsBatched(cam, visibleBounds, onlyShadowCasters);
+		return;
+	}
+
     // Tell nodes to find, cascade down all nodes
     getRootSceneNode()->_findVisibleObjects(cam, getRenderQueue(), visibleBounds, true, 
         mDisplayNodes, onlyShadowCasters);
 
 }
 //-----------------------------------------------------------------------
+void SceneManager::findVisibleObjectsBatched(
+	Camera* cam, VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+{
+	if (!mCullBatch)
+		mCullBatch = OGRE_NEW AxisAlignedBoxBatch();
+
+	mCullCandidates.clear();
+	mCullVisible.clear();
+	CullCandidate root = { getRootSceneNode(), 0, 0 };
+	mCullCandidates.push_back(root);
+
+	// Cull a depth at a time; only children of visible nodes are considered.
+	// Work with indices, the list grows as we go.
+	size_t levelBegin = 0;
+	while (levelBegin < mCullCandidates.size())
+	{
+		size_t levelEnd = mCullCandidates.size();
+
+		mCullBatch->clear();
+		for (size_t i = levelBegin; i < levelEnd; ++i)
+		{
+			mCullBatch->addBox(mCullCandidates[i].node->_getWorldAABB());
+		}
+		cam->isVisible(*mCullBatch);
+
+		for (size_t i = levelBegin; i < levelEnd; ++i)
+		{
+			bool visible = mCullBatch->isVisible(i - levelBegin);
+			mCullVisible.push_back(visible);
+			mCullCandidates[i].firstChild = mCullCandidates.size();
+			mCullCandidates[i].numChildren = 0;
+			if (!visible)
+				continue;
+
+			SceneNode::ChildNodeIterator it = mCullCandidates[i].node->getChildIterator();
+			while (it.hasMoreElements())
+			{
+				CullCandidate child = { static_cast<SceneNode*>(it.getNext()), 0, 0 };
+				mCullCandidates.push_back(child);
+			}
+			mCullCandidates[i].numChildren = mCullCandidates.size() - mCullCandidates[i].firstChild;
+		}
+		levelBegin = levelEnd;
+	}
+
+	// Queue depth first, in the same order as the recursive path
+	addVisibleCandidate(0, mCullCandidates, &mCullVisible[0], cam, getRenderQueue(), 
+		visibleBounds, onlyShadowCasters);
+}
+//-----------------------------------------------------------------------
+void SceneManager::addVisibleCandidate(size_t index, const CullCandidateList& candidates, 
+	const uchar* visible, Camera* cam, RenderQueue* queue, 
+	VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+{
+	if (!visible[index])
+		return;
+
+	const CullCandidate& candidate = candidates[index];
+	candidate.node->_addVisibleObjects(cam, queue, visibleBounds, onlyShadowCasters);
+
+	for (size_t c = 0; c < candidate.numChildren; ++c)
+	{
+		addVisibleCandidate(candidate.firstChild + c, candidates, visible, cam, queue,
+			visibleBounds, onlyShadowCasters);
+	}
+
+	candidate.node->_addDebugRenderables(queue, mDisplayNodes);
+}
+//-----------------------------------------------------------------------
+void SceneManager::CameraCullTask::execute()
+{
+	batch->cull(camera->planes, camera->numPlanes, visible, first, count);
+}
+//-----------------------------------------------------------------------
+void SceneManager::cullCameras(const CameraPtrList& cameras)
+{
+	if (!mCameraCullBatch)
+		mCameraCullBatch = OGRE_NEW AxisAlignedBoxBatch();
+
+	// Gather every node breadth first, so that children are contiguous
+	mCameraCullCandidates.clear();
+	mCameraCullBatch->clear();
+	CullCandidate root = { getRootSceneNode(), 0, 0 };
+	mCameraCullCandidates.push_back(root);
+	for (size_t i = 0; i < mCameraCullCandidates.size(); ++i)
+	{
+		SceneNode* node = mCameraCullCandidates[i].node;
+		mCameraCullBatch->addBox(node->_getWorldAABB());
+
+		mCameraCullCandidates[i].firstChild = mCameraCullCandidates.size();
+		SceneNode::ChildNodeIterator it = node->getChildIterator();
+		while (it.hasMoreElements())
+		{
+			CullCandidate child = { static_cast<SceneNode*>(it.getNext()), 0, 0 };
+			mCameraCullCandidates.push_back(child);
+		}
+		mCameraCullCandidates[i].numChildren = 
+			mCameraCullCandidates.size() - mCameraCullCandidates[i].firstChild;
+	}
+	size_t numBoxes = mCameraCullBatch->getNumBoxes();
+
+	// Planes are brought up to date here, tasks must not touch the cameras
+	mCulledCameraIndex.clear();
+	if (mCulledCameras.size() < cameras.size())
+		mCulledCameras.resize(cameras.size());
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		CulledCamera& culled = mCulledCameras[c];
+		culled.numPlanes = cameras[c]->getCullingPlanes(culled.planes);
+		culled.visible.resize(numBoxes);
+		mCulledCameraIndex[cameras[c]] = c;
+	}
+
+	// Split large scenes up so that a few cameras still use every thread
+	const size_t boxesPerTask = 4096;
+	mCameraCullTasks.clear();
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		for (size_t first = 0; first < numBoxes; first += boxesPerTask)
+		{
+			mCameraCullTasks.push_back(CameraCullTask(mCameraCullBatch, &mCulledCameras[c], 
+				first, std::min(boxesPerTask, numBoxes - first)));
+		}
+	}
+	// Only add pointers once the list has stopped growing
+	ParallelTaskGroup* group = getParallelTaskGroup();
+	for (CameraCullTaskList::iterator i = mCameraCullTasks.begin(); 
+		i != mCameraCullTasks.end(); ++i)
+	{
+		group->addTask(&(*i));
+	}
+	group->run();
+}
+//-----------------------------------------------------------------------
+void SceneManager::_findVisibleObjectsMultiCamera(const CameraCullTargetList& targets)
+{
+	CameraCullTargetList::const_iterator i;
+	if (!isMultiCameraCullingSupported())
+	{
+		// Swap in each queue in turn, the usual path always uses ours
+		RenderQueue* savedQueue = getRenderQueue();
+		for (i = targets.begin(); i != targets.end(); ++i)
+		{
+			mRenderQueue = i->queue;
+			_findVisibleObjects(i->camera, i->visibleBounds, i->onlyShadowCasters);
+		}
+		mRenderQueue = savedQueue;
+		return;
+	}
+
+	CameraPtrList cameras;
+	cameras.reserve(targets.size());
+	for (i = targets.begin(); i != targets.end(); ++i)
+		cameras.push_back(i->camera);
+	cullCameras(cameras);
+
+	for (i = targets.begin(); i != targets.end(); ++i)
+	{
+		const CulledCamera& culled = mCulledCameras[mCulledCameraIndex[i->camera]];
+		addVisibleCandidate(0, mCameraCullCandidates, &culled.visible[0], i->camera, 
+			i->queue, i->visibleBounds, i->onlyShadowCasters);
+	}
+	mCulledCameraIndex.clear();
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderVisibleObjects(void)
 {
+	if (mParallelRenderQueueSort)
+	{
+		sortRenderQueueParallel();
+	}
+
 	RenderQueueInvocationSequence* invocationSequence = 
 		mCurrentViewport->_getRenderQueueInvocationSequence();
 	// Use custom sequence only if we're not doing the texture shadow render
@@ -2212,6 +2557,109 @@ void SceneManager::_renderVisibleObjects(void)
 	}
 }
 //-----------------------------------------------------------------------
+void SceneManager::sortRenderQueueParallel(void)
+{
+	mCollectionsToSort.clear();
+	RenderQueue::QueueGroupIterator groupIt = getRenderQueue()->_getQueueGroupIterator();
+	while (groupIt.hasMoreElements())
+	{
+		RenderQueueGroup::PriorityMapIterator priorityIt = groupIt.getNext()->getIterator();
+		while (priorityIt.hasMoreElements())
+		{
+			priorityIt.getNext()->_getCollectionsToSort(mCameraInProgress, mCollectionsToSort);
+		}
+	}
+	// Not worth it for one, it'll be sorted when rendered
+	if (mCollectionsToSort.size() < 2)
+		return;
+
+	// Ask the renderables for their depths here, since they may cache them
+	// and may be in several collections; the tasks then only sort
+	mRenderQueueSortTasks.clear();
+	for (RenderPriorityGroup::CollectionList::iterator i = mCollectionsToSort.begin(); 
+		i != mCollectionsToSort.end(); ++i)
+	{
+		(*i)->_calculateSortDepths(mCameraInProgress);
+		mRenderQueueSortTasks.push_back(RenderQueueSortTask(*i, mCameraInProgress));
+	}
+	// Only add pointers once the list has stopped growing
+	ParallelTaskGroup* group = getParallelTaskGroup();
+	for (RenderQueueSortTaskList::iterator i = mRenderQueueSortTasks.begin(); 
+		i != mRenderQueueSortTasks.end(); ++i)
+	{
+		group->addTask(&(*i));
+	}
+	group->run();
+}
+//-----------------------------------------------------------------------
+SoftwareAnimationBatch* SceneManager::_getSoftwareAnimationBatch(void)
+{
+	if (!mCollectingSoftwareAnimation)
+		return 0;
+
+	if (!mSoftwareAnimationBatch)
+		mSoftwareAnimationBatch = OGRE_NEW SoftwareAnimationBatch(getParallelTaskGroup());
+	return mSoftwareAnimationBatch;
+}
+//-----------------------------------------------------------------------
+bool SceneManager::_deferSkeletalAnimation(Entity* entity, Entity* displayEntity, 
+	RenderQueue* queue)
+{
+	if (!mCollectingSkeletalAnimation)
+		return false;
+
+	DeferredAnimation deferred;
+	deferred.entity = entity;
+	deferred.displayEntity = displayEntity;
+	deferred.queue = queue;
+	mDeferredAnimations.push_back(deferred);
+	return true;
+}
+//-----------------------------------------------------------------------
+void SceneManager::SkeletonUpdateTask::execute()
+{
+	entity->_updateBoneMatrices();
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateDeferredAnimation(void)
+{
+	mSkeletonUpdateTasks.clear();
+	mSkeletonsToUpdate.clear();
+	for (DeferredAnimationList::iterator i = mDeferredAnimations.begin(); 
+		i != mDeferredAnimations.end(); ++i)
+	{
+		Entity* ent = i->displayEntity;
+		// Entities sharing a skeleton instance only need it evaluating once
+		if (!mSkeletonsToUpdate.insert(ent->getSkeleton()).second)
+			continue;
+
+		// Build anything the tasks would otherwise build on demand and race for
+		ent->getSkeleton()->_prepareAnimationState(*ent->getAllAnimationStates());
+		// Tag points read the derived transform of the entity's node
+		if (ent->getParentNode())
+			ent->getParentNode()->_getDerivedPosition();
+
+		mSkeletonUpdateTasks.push_back(SkeletonUpdateTask(ent));
+	}
+	// Only add pointers once the list has stopped growing
+	ParallelTaskGroup* group = getParallelTaskGroup();
+	for (SkeletonUpdateTaskList::iterator i = mSkeletonUpdateTasks.begin(); 
+		i != mSkeletonUpdateTasks.end(); ++i)
+	{
+		group->addTask(&(*i));
+	}
+	group->run();
+
+	// The bones are up to date now, so this only does the rest of the work
+	// (which can go to the software animation batch) and queues attachments
+	for (DeferredAnimationList::iterator i = mDeferredAnimations.begin(); 
+		i != mDeferredAnimations.end(); ++i)
+	{
+		i->entity->_updateAnimationAndQueueChildren(i->displayEntity, i->queue);
+	}
+	mDeferredAnimations.clear();
+}
+//-----------------------------------------------------------------------
 void SceneManager::renderVisibleObjectsCustomSequence(RenderQueueInvocationSequence* seq)
 {
 	firePostRenderQueues();
@@ -6176,6 +6624,12 @@ void SceneManager::prepareShadowTextures(Camera* cam, Viewport* vp, const LightL
 		ci = mShadowTextureCameras.begin();
 		mShadowTextureIndexLightList.clear();
 		size_t shadowTextureIndex = 0;
+
+		// When culling the cameras together, set them all up before rendering
+		bool multiCameraCulling = mMultiCameraCulling && isMultiCameraCullingSupported();
+		CameraPtrList cullCameraList;
+		PendingShadowTargetList shadowTargets;
+
 		for (i = lightList->begin(), si = mShadowTextures.begin();
 			i != iend && si != siend; ++i)
 		{
@@ -6227,11 +6681,21 @@ void SceneManager::prepareShadowTextures(Camera* cam, Viewport* vp, const LightL
 				// Setup background colour
 				shadowView->setBackgroundColour(ColourValue::White);
 
-				// Fire shadow caster update, callee can alter camera settings
-				fireShadowTexturesPreCaster(light, texCam, j);
-
 				// Update target
-				shadowRTT->update();
+				if (multiCameraCulling)
+				{
+					// Rendered once every camera has been culled
+					cullCameraList.push_back(texCam);
+					PendingShadowTarget pending = { light, texCam, j, shadowRTT };
+					shadowTargets.push_back(pending);
+				}
+				else
+				{
+					// Fire shadow caster update, callee can alter camera settings
+					fireShadowTexturesPreCaster(light, texCam, j);
+
+					shadowRTT->update();
+				}
 
 				++si; // next shadow texture
 				++ci; // next camera
@@ -6241,6 +6705,30 @@ void SceneManager::prepareShadowTextures(Camera* cam, Viewport* vp, const LightL
 			mShadowTextureIndexLightList.push_back(shadowTextureIndex);
 			shadowTextureIndex += textureCountPerLight;
 		}
+
+		if (!shadowTargets.empty())
+		{
+			// Cull the scene for every shadow camera at once, and for the main
+			// camera too unless something is going to move before it is used
+			_updateSceneGraph(cam);
+			if (mAutoTrackingSceneNodes.empty() && !cam->getAutoTrackTarget())
+				cullCameraList.push_back(cam);
+			cullCameras(cullCameraList);
+
+			// Render one texture at a time, with its own caster light and
+			// listener call, just as the unbatched path does
+			for (PendingShadowTargetList::iterator t = shadowTargets.begin(); 
+				t != shadowTargets.end(); ++t)
+			{
+				mShadowTextureCurrentCasterLightList[0] = t->light;
+
+				// Fire shadow caster update, callee can alter camera settings;
+				// _findVisibleObjects culls again if it does
+				fireShadowTexturesPreCaster(t->light, t->camera, t->iteration);
+
+				t->target->update();
+			}
+		}
 	}
 	catch (Exception& e) 
 	{
@@ -102,6 +102,9 @@ namespace Ogre {
 		{
 			setInSceneGraph(false);
 		}
+
+		if (mCreator)
+			mCreator->_notifySceneNodeHierarchyChanged();
 	}
     //-----------------------------------------------------------------------
 	void SceneNode::setInSceneGraph(bool inGraph)
@@ -286,14 +289,7 @@ namespace Ogre {
             return;
 
         // Add all entities
-        ObjectMap::iterator iobj;
-        ObjectMap::iterator iobjend = mObjectsByName.end();
-        for (iobj = mObjectsByName.begin(); iobj != iobjend; ++iobj)
-        {
-			MovableObject* mo = iobj->second;
-
-			queue->processVisibleObject(mo, cam, onlyShadowCasters, visibleBounds);
-        }
+        _addVisibleObjects(cam, queue, visibleBounds, onlyShadowCasters);
 
         if (includeChildren)
         {
@@ -307,6 +303,24 @@ namespace Ogre {
             }
         }
 
+        _addDebugRenderables(queue, displayNodes);
+    }
+    //-----------------------------------------------------------------------
+    void SceneNode::_addVisibleObjects(Camera* cam, RenderQueue* queue, 
+        VisibleObjectsBoundsInfo* visibleBounds, bool onlyShadowCasters)
+    {
+        ObjectMap::iterator iobj;
+        ObjectMap::iterator iobjend = mObjectsByName.end();
+        for (iobj = mObjectsByName.begin(); iobj != iobjend; ++iobj)
+        {
+			MovableObject* mo = iobj->second;
+
+			queue->processVisibleObject(mo, cam, onlyShadowCasters, visibleBounds);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void SceneNode::_addDebugRenderables(RenderQueue* queue, bool displayNodes)
+    {
         if (displayNodes)
         {
             // Include self in the render queue
@@ -369,6 +383,20 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void SceneNode::_setDerivedTransform(const Quaternion& orientation,
+        const Vector3& position, const Vector3& scale)
+    {
+        Node::_setDerivedTransform(orientation, position, scale);
+
+        // Notify objects that it has been moved
+        ObjectMap::const_iterator i;
+        for (i = mObjectsByName.begin(); i != mObjectsByName.end(); ++i)
+        {
+            MovableObject* object = i->second;
+            object->_notifyMoved();
+        }
+    }
+    //-----------------------------------------------------------------------
     Node* SceneNode::createChildImpl(void)
     {
         assert(mCreator);
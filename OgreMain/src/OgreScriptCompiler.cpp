@@ -31,6 +31,10 @@ THE SOFTWARE.
 #include "OgreScriptLexer.h"
 #include "OgreScriptParser.h"
 #include "OgreScriptTranslator.h"
+#include "OgreStreamSerialiser.h"
+#include "OgreAtomicWrappers.h"
+
+#include <cstdio>
 
 namespace Ogre
 {
@@ -1640,6 +1644,46 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void ScriptCompilerManager::parseScript(DataStreamPtr& stream, const String& groupName)
     {
+		parsePreparedScript(stream, groupName, prepareScript(stream, groupName));
+    }
+	//-----------------------------------------------------------------------
+	namespace
+	{
+		/// What ScriptCompilerManager::prepareScript passes to parsePreparedScript
+		struct PreparedScript
+		{
+			ConcreteNodeListPtr nodes;
+
+			friend std::ostream& operator<<(std::ostream& o, const PreparedScript& p)
+			{
+				return o << "PreparedScript";
+			}
+		};
+	}
+	//-----------------------------------------------------------------------
+	Any ScriptCompilerManager::prepareScript(DataStreamPtr& stream, const String& groupName)
+	{
+		// Lexing and parsing only build the concrete node tree, so can be done 
+		// on any thread; translation creates the resources
+		String source = stream->getAsString();
+		PreparedScript prepared;
+		if (!mCacheLocation.empty())
+			prepared.nodes = loadCachedScript(stream->getName(), groupName, source);
+
+		if (prepared.nodes.isNull())
+		{
+			ScriptLexer lexer;
+			ScriptParser parser;
+			prepared.nodes = parser.parse(lexer.tokenize(source, stream->getName()));
+			if (!mCacheLocation.empty())
+				saveCachedScript(stream->getName(), groupName, source, prepared.nodes);
+		}
+		return Any(prepared);
+	}
+	//-----------------------------------------------------------------------
+	void ScriptCompilerManager::parsePreparedScript(DataStreamPtr& stream, 
+		const String& groupName, const Any& prepared)
+	{
 #if OGRE_THREAD_SUPPORT
 		// check we have an instance for this thread (should always have one for main thread)
 		if (!OGRE_THREAD_POINTER_GET(mScriptCompiler))
@@ -1654,8 +1698,189 @@ namespace Ogre
 			OGRE_LOCK_AUTO_MUTEX
 			OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
 		}
-        OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(stream->getAsString(), stream->getName(), groupName);
-    }
+		OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(
+			any_cast<PreparedScript>(prepared).nodes, groupName);
+	}
+
+	//-----------------------------------------------------------------------
+	namespace
+	{
+		const uint32 SCRIPTCACHE_CHUNK_ID = StreamSerialiser::makeIdentifier("SCCH");
+		const uint16 SCRIPTCACHE_CHUNK_VERSION = 1;
+
+		void writeCachedNodes(StreamSerialiser& ser, const ConcreteNodeList& nodes)
+		{
+			uint32 count = static_cast<uint32>(nodes.size());
+			ser.write(&count);
+			for (ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+			{
+				const ConcreteNode& node = **i;
+				ser.write(&node.token);
+				uint32 line = node.line;
+				ser.write(&line);
+				uint8 type = static_cast<uint8>(node.type);
+				ser.write(&type);
+				writeCachedNodes(ser, node.children);
+			}
+		}
+
+		// Smallest a cached node can be: token length, line, type, child count
+		const size_t SCRIPTCACHE_MIN_NODE_SIZE = sizeof(uint32) * 3 + sizeof(uint8);
+
+		// Counts are checked against what is left in the stream so that a 
+		// truncated or corrupt cache can't make us allocate huge amounts
+		void checkCachedCount(const DataStreamPtr& stream, size_t count, size_t itemSize)
+		{
+			size_t remaining = stream->size() - stream->tell();
+			if (count > remaining / itemSize)
+			{
+				OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
+					"Script cache data is corrupt",
+					"readCachedNodes");
+			}
+		}
+
+		void readCachedNodes(StreamSerialiser& ser, const DataStreamPtr& stream, 
+			const String& file, ConcreteNode* parent, ConcreteNodeList& nodes)
+		{
+			uint32 count;
+			ser.read(&count);
+			checkCachedCount(stream, count, SCRIPTCACHE_MIN_NODE_SIZE);
+			for (uint32 n = 0; n < count; ++n)
+			{
+				ConcreteNodePtr node(OGRE_NEW ConcreteNode());
+				uint32 len;
+				ser.read(&len);
+				checkCachedCount(stream, len, 1);
+				node->token.resize(len);
+				if (len)
+					ser.read(&(*node->token.begin()), len);
+				node->file = file;
+				uint32 line;
+				ser.read(&line);
+				node->line = line;
+				uint8 type;
+				ser.read(&type);
+				node->type = static_cast<ConcreteNodeType>(type);
+				node->parent = parent;
+				readCachedNodes(ser, stream, file, node.get(), node->children);
+				nodes.push_back(node);
+			}
+		}
+
+		// Cache files from concurrent saves get distinct temporary names
+		AtomicScalar<uint32> scriptCacheTempCount(0);
+	}
+	//-----------------------------------------------------------------------
+	void ScriptCompilerManager::setCacheLocation(const String& path)
+	{
+		mCacheLocation = path;
+	}
+	//-----------------------------------------------------------------------
+	String ScriptCompilerManager::getCacheFileName(const String& scriptName, 
+		const String& groupName) const
+	{
+		// The same name may be used in different groups
+		String key = groupName + "/" + scriptName;
+		uint32 hash = FastHash(key.c_str(), static_cast<int>(key.size()));
+		return mCacheLocation + "/" + 
+			StringConverter::toString(hash, 8, '0', std::ios::hex) + ".scriptcache";
+	}
+	//-----------------------------------------------------------------------
+	ConcreteNodeListPtr ScriptCompilerManager::loadCachedScript(const String& scriptName, 
+		const String& groupName, const String& source)
+	{
+		String fileName = getCacheFileName(scriptName, groupName);
+		std::ifstream* ifs = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+			fileName.c_str(), std::ios::in | std::ios::binary);
+		if (!*ifs)
+		{
+			OGRE_DELETE_T(ifs, basic_ifstream, MEMCATEGORY_GENERAL);
+			return ConcreteNodeListPtr();
+		}
+		DataStreamPtr file(OGRE_NEW FileStreamDataStream(fileName, ifs));
+		// Read the whole file in one go, there are many small values in it
+		DataStreamPtr stream(OGRE_NEW MemoryDataStream(file));
+		file->close();
+
+		ConcreteNodeListPtr nodes;
+		try
+		{
+			StreamSerialiser ser(stream);
+			if (!ser.readChunkBegin(SCRIPTCACHE_CHUNK_ID, SCRIPTCACHE_CHUNK_VERSION))
+				return nodes;
+
+			// Only use it if it was made by this version from the same text
+			uint32 version, hash, length;
+			String name, group;
+			ser.read(&version);
+			ser.read(&hash);
+			ser.read(&length);
+			ser.read(&name);
+			ser.read(&group);
+			if (version == OGRE_VERSION && name == scriptName && group == groupName && 
+				length == source.size() &&
+				hash == FastHash(source.c_str(), static_cast<int>(source.size())))
+			{
+				nodes.bind(OGRE_NEW_T(ConcreteNodeList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+				readCachedNodes(ser, stream, scriptName, 0, *nodes);
+				ser.readChunkEnd(SCRIPTCACHE_CHUNK_ID);
+			}
+		}
+		catch (Exception& e)
+		{
+			LogManager::getSingleton().logMessage("Ignoring unreadable script cache " + 
+				fileName + ": " + e.getDescription());
+			nodes.setNull();
+		}
+		return nodes;
+	}
+	//-----------------------------------------------------------------------
+	void ScriptCompilerManager::saveCachedScript(const String& scriptName, 
+		const String& groupName, const String& source, const ConcreteNodeListPtr& nodes)
+	{
+		// Scripts may be prepared on several threads at once, so write to a 
+		// file of our own and move it into place when it's complete; readers 
+		// never see a partly written cache
+		String fileName = getCacheFileName(scriptName, groupName);
+		String tempName = fileName + "." + 
+			StringConverter::toString(scriptCacheTempCount++) + ".tmp";
+		std::fstream* fs = OGRE_NEW_T(std::fstream, MEMCATEGORY_GENERAL)(
+			tempName.c_str(), std::ios::out | std::ios::binary);
+		if (!*fs)
+		{
+			OGRE_DELETE_T(fs, basic_fstream, MEMCATEGORY_GENERAL);
+			LogManager::getSingleton().logMessage("Can't write script cache " + fileName);
+			return;
+		}
+		DataStreamPtr stream(OGRE_NEW FileStreamDataStream(tempName, fs));
+
+		{
+			StreamSerialiser ser(stream);
+			ser.writeChunkBegin(SCRIPTCACHE_CHUNK_ID, SCRIPTCACHE_CHUNK_VERSION);
+			uint32 version = OGRE_VERSION;
+			uint32 hash = FastHash(source.c_str(), static_cast<int>(source.size()));
+			uint32 length = static_cast<uint32>(source.size());
+			ser.write(&version);
+			ser.write(&hash);
+			ser.write(&length);
+			ser.write(&scriptName);
+			ser.write(&groupName);
+			writeCachedNodes(ser, *nodes);
+			ser.writeChunkEnd(SCRIPTCACHE_CHUNK_ID);
+		}
+		stream->close();
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+		// rename won't replace an existing file here
+		std::remove(fileName.c_str());
+#endif
+		if (std::rename(tempName.c_str(), fileName.c_str()) != 0)
+		{
+			// Most likely another thread got there first with the same data
+			std::remove(tempName.c_str());
+		}
+	}
 
 	//-------------------------------------------------------------------------
 	String PreApplyTextureAliasesScriptCompilerEvent::eventType = "preApplyTextureAliases";
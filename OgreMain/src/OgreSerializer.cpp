@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreException.h"
 #include "OgreVector3.h"
 #include "OgreQuaternion.h"
+#include "OgreBitwise.h"
 
 
 namespace Ogre {
@@ -270,10 +271,15 @@ namespace Ogre {
     //---------------------------------------------------------------------
     unsigned short Serializer::readChunk(DataStreamPtr& stream)
     {
+        // Read the id and length together, there are a lot of small chunks
+        unsigned char header[STREAM_OVERHEAD_SIZE];
+        stream->read(header, STREAM_OVERHEAD_SIZE);
+
         unsigned short id;
-        readShorts(stream, &id, 1);
-        
-        readInts(stream, &mCurrentstreamLen, 1);
+        memcpy(&id, header, sizeof(unsigned short));
+        flipFromLittleEndian(&id, sizeof(unsigned short));
+        memcpy(&mCurrentstreamLen, header + sizeof(unsigned short), sizeof(uint32));
+        flipFromLittleEndian(&mCurrentstreamLen, sizeof(uint32));
         return id;
     }
     //---------------------------------------------------------------------
@@ -386,21 +392,12 @@ namespace Ogre {
     
     void Serializer::flipEndian(void * pData, size_t size, size_t count)
     {
-        for(unsigned int index = 0; index < count; index++)
-        {
-            flipEndian((void *)((size_t)pData + (index * size)), size);
-        }
+        Bitwise::bswapBuffer(pData, size, count);
     }
     
     void Serializer::flipEndian(void * pData, size_t size)
     {
-        char swapByte;
-        for(unsigned int byteIndex = 0; byteIndex < size/2; byteIndex++)
-        {
-            swapByte = *(char *)((size_t)pData + byteIndex);
-            *(char *)((size_t)pData + byteIndex) = *(char *)((size_t)pData + size - byteIndex - 1);
-            *(char *)((size_t)pData + size - byteIndex - 1) = swapByte;
-        }
+        Bitwise::bswapBuffer(pData, size, 1);
     }
     
 }
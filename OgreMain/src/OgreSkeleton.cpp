@@ -265,6 +265,18 @@ namespace Ogre {
         }
 
 
+    }
+    //---------------------------------------------------------------------
+    void Skeleton::_prepareAnimationState(const AnimationStateSet& animSet) const
+    {
+        ConstEnabledAnimationStateIterator stateIt = 
+            animSet.getEnabledAnimationStateIterator();
+        while (stateIt.hasMoreElements())
+        {
+            Animation* anim = _getAnimationImpl(stateIt.getNext()->getAnimationName());
+            if (anim)
+                anim->_prepareForApply();
+        }
     }
     //---------------------------------------------------------------------
     void Skeleton::setBindingPose(void)
@@ -685,6 +697,17 @@ namespace Ogre {
 		}
 	}
 	//---------------------------------------------------------------------
+	void Skeleton::packAllAnimations(Real translationTolerance, 
+		const Radian& rotationTolerance, Real scaleTolerance)
+	{
+        AnimationList::iterator ai, aiend;
+        aiend = mAnimationsList.end();
+        for (ai = mAnimationsList.begin(); ai != aiend; ++ai)
+        {
+			ai->second->packNodeTracks(translationTolerance, rotationTolerance, scaleTolerance);
+		}
+	}
+	//---------------------------------------------------------------------
 	void Skeleton::addLinkedSkeletonAnimationSource(const String& skelName, 
 		Real scale)
 	{
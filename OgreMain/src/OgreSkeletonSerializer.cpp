@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreAnimation.h"
 #include "OgreAnimationTrack.h"
 #include "OgreKeyFrame.h"
+#include "OgrePackedTransformTrack.h"
 #include "OgreBone.h"
 #include "OgreString.h"
 #include "OgreDataStream.h"
@@ -44,12 +45,33 @@ THE SOFTWARE.
 namespace Ogre {
     /// stream overhead = ID + size
     const long STREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+    /// Version written when there are no packed tracks, readable by older builds
+    const char* const SKELETON_VERSION_1_10 = "[Serializer_v1.10]";
+    /// Version written when there are packed tracks
+    const char* const SKELETON_VERSION_1_20 = "[Serializer_v1.20]";
+    //---------------------------------------------------------------------
+    static bool hasPackedTracks(const Skeleton* pSkel)
+    {
+        for (unsigned short a = 0; a < pSkel->getNumAnimations(); ++a)
+        {
+            Animation::NodeTrackIterator trackIt = 
+                pSkel->getAnimation(a)->getNodeTrackIterator();
+            while (trackIt.hasMoreElements())
+            {
+                if (trackIt.getNext()->isPacked())
+                    return true;
+            }
+        }
+        return false;
+    }
     //---------------------------------------------------------------------
     SkeletonSerializer::SkeletonSerializer()
     {
         // Version number
         // NB changed to include bone names in 1.1
-        mVersion = "[Serializer_v1.10]";
+        // NB changed to add packed animation tracks in 1.2, which is only 
+        // written when a skeleton has packed tracks (see exportSkeleton)
+        mVersion = SKELETON_VERSION_1_20;
     }
     //---------------------------------------------------------------------
     SkeletonSerializer::~SkeletonSerializer()
@@ -83,7 +105,12 @@ namespace Ogre {
 				"SkeletonSerializer::exportSkeleton");
 		}
 
+        // Only stamp the newer version when it's needed, so that skeletons 
+        // without packed tracks still load in older builds
+        mVersion = hasPackedTracks(pSkeleton) ? 
+            SKELETON_VERSION_1_20 : SKELETON_VERSION_1_10;
         writeFileHeader();
+        mVersion = SKELETON_VERSION_1_20;
 
         // Write main skeleton data
         LogManager::getSingleton().logMessage("Exporting bones..");
@@ -115,6 +142,27 @@ namespace Ogre {
 
     }
     //---------------------------------------------------------------------
+    void SkeletonSerializer::readFileHeader(DataStreamPtr& stream)
+    {
+        unsigned short headerID;
+        readShorts(stream, &headerID, 1);
+        if (headerID != SKELETON_HEADER)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, "Invalid file: no header", 
+                "SkeletonSerializer::readFileHeader");
+        }
+
+        // 1.1 files are the same bar the packed tracks, so read those too
+        String ver = readString(stream);
+        if (ver != SKELETON_VERSION_1_20 && ver != SKELETON_VERSION_1_10)
+        {
+            OGRE_EXCEPT(Exception::ERR_INTERNAL_ERROR, 
+                "Invalid file: version incompatible, file reports " + ver +
+                " Serializer is version " + mVersion,
+                "SkeletonSerializer::readFileHeader");
+        }
+    }
+    //---------------------------------------------------------------------
     void SkeletonSerializer::importSkeleton(DataStreamPtr& stream, Skeleton* pSkel)
     {
 		// Determine endianness (must be the first thing we do!)
@@ -220,7 +268,11 @@ namespace Ogre {
         Animation::NodeTrackIterator trackIt = anim->getNodeTrackIterator();
         while(trackIt.hasMoreElements())
         {
-            writeAnimationTrack(pSkel, trackIt.getNext());
+            const NodeAnimationTrack* track = trackIt.getNext();
+            if (track->isPacked())
+                writePackedAnimationTrack(pSkel, track);
+            else
+                writeAnimationTrack(pSkel, track);
         }
 
     }
@@ -243,6 +295,40 @@ namespace Ogre {
 
     }
     //---------------------------------------------------------------------
+    void SkeletonSerializer::writePackedAnimationTrack(const Skeleton* pSkel, 
+        const NodeAnimationTrack* track)
+    {
+        writeChunkHeader(SKELETON_ANIMATION_PACKED_TRACK, 
+            calcPackedAnimationTrackSize(pSkel, track));
+
+        // unsigned short boneIndex     : Index of bone to apply to
+        Bone* bone = (Bone*)track->getAssociatedNode();
+        unsigned short boneid = bone->getHandle();
+        writeShorts(&boneid, 1);
+
+        // Translation, rotation and scale channels
+        const PackedTransformTrack* packed = track->getPackedData();
+        for (int c = 0; c < PackedTransformTrack::CT_COUNT; ++c)
+        {
+            const PackedTransformTrack::Channel& channel = 
+                packed->getChannel(static_cast<PackedTransformTrack::ChannelType>(c));
+            // unsigned int numKeys         : Number of keys in the channel
+            uint32 numKeys = static_cast<uint32>(channel.times.size());
+            writeInts(&numKeys, 1);
+            // Vector3 base                 : Minimum of the channel
+            writeObject(channel.base);
+            // Vector3 range                : Extent of the channel
+            writeObject(channel.range);
+            if (numKeys)
+            {
+                // float times[numKeys]         : Time of each key
+                writeFloats(&channel.times[0], numKeys);
+                // unsigned short values[numKeys * 3] : Quantised value of each key
+                writeShorts(&channel.values[0], numKeys * 3);
+            }
+        }
+    }
+    //---------------------------------------------------------------------
     void SkeletonSerializer::writeKeyFrame(const Skeleton* pSkel, 
         const TransformKeyFrame* key)
     {
@@ -331,7 +417,11 @@ namespace Ogre {
 		Animation::NodeTrackIterator trackIt = pAnim->getNodeTrackIterator();
 		while(trackIt.hasMoreElements())
 		{
-            size += calcAnimationTrackSize(pSkel, trackIt.getNext());
+            const NodeAnimationTrack* track = trackIt.getNext();
+            if (track->isPacked())
+                size += calcPackedAnimationTrackSize(pSkel, track);
+            else
+                size += calcAnimationTrackSize(pSkel, track);
         }
 
         return size;
@@ -354,6 +444,31 @@ namespace Ogre {
         return size;
     }
     //---------------------------------------------------------------------
+    size_t SkeletonSerializer::calcPackedAnimationTrackSize(const Skeleton* pSkel, 
+        const NodeAnimationTrack* pTrack)
+    {
+        size_t size = STREAM_OVERHEAD_SIZE;
+
+        // unsigned short boneIndex     : Index of bone to apply to
+        size += sizeof(unsigned short);
+
+        const PackedTransformTrack* packed = pTrack->getPackedData();
+        for (int c = 0; c < PackedTransformTrack::CT_COUNT; ++c)
+        {
+            size_t numKeys = packed->getNumKeys(static_cast<PackedTransformTrack::ChannelType>(c));
+            // unsigned int numKeys         : Number of keys in the channel
+            size += sizeof(uint32);
+            // Vector3 base, range
+            size += sizeof(float) * 6;
+            // float times[numKeys]
+            size += sizeof(float) * numKeys;
+            // unsigned short values[numKeys * 3]
+            size += sizeof(unsigned short) * numKeys * 3;
+        }
+
+        return size;
+    }
+    //---------------------------------------------------------------------
     size_t SkeletonSerializer::calcKeyFrameSize(const Skeleton* pSkel, 
         const TransformKeyFrame* pKey)
     {
@@ -452,9 +567,13 @@ namespace Ogre {
         if (!stream->eof())
         {
             unsigned short streamID = readChunk(stream);
-            while(streamID == SKELETON_ANIMATION_TRACK && !stream->eof())
+            while((streamID == SKELETON_ANIMATION_TRACK || 
+                streamID == SKELETON_ANIMATION_PACKED_TRACK) && !stream->eof())
             {
-                readAnimationTrack(stream, pAnim, pSkel);
+                if (streamID == SKELETON_ANIMATION_PACKED_TRACK)
+                    readPackedAnimationTrack(stream, pAnim, pSkel);
+                else
+                    readAnimationTrack(stream, pAnim, pSkel);
 
                 if (!stream->eof())
                 {
@@ -510,6 +629,47 @@ namespace Ogre {
         }
 
 
+    }
+    //---------------------------------------------------------------------
+    void SkeletonSerializer::readPackedAnimationTrack(DataStreamPtr& stream, 
+        Animation* anim, Skeleton* pSkel)
+    {
+        // unsigned short boneIndex     : Index of bone to apply to
+        unsigned short boneHandle;
+        readShorts(stream, &boneHandle, 1);
+
+        // Find bone
+        Bone *targetBone = pSkel->getBone(boneHandle);
+
+        // Create track, which owns the packed data from now on
+        NodeAnimationTrack* pTrack = anim->createNodeTrack(boneHandle, targetBone);
+        PackedTransformTrack* packed = OGRE_NEW PackedTransformTrack();
+        pTrack->_setPackedData(packed);
+
+        for (int c = 0; c < PackedTransformTrack::CT_COUNT; ++c)
+        {
+            PackedTransformTrack::Channel& channel = 
+                packed->getChannel(static_cast<PackedTransformTrack::ChannelType>(c));
+            // unsigned int numKeys         : Number of keys in the channel
+            uint32 numKeys;
+            readInts(stream, &numKeys, 1);
+            if (!numKeys)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+                    "Packed animation track has an empty channel.",
+                    "SkeletonSerializer::readPackedAnimationTrack");
+            }
+            // Vector3 base                 : Minimum of the channel
+            readObject(stream, channel.base);
+            // Vector3 range                : Extent of the channel
+            readObject(stream, channel.range);
+            // float times[numKeys]         : Time of each key
+            channel.times.resize(numKeys);
+            readFloats(stream, &channel.times[0], numKeys);
+            // unsigned short values[numKeys * 3] : Quantised value of each key
+            channel.values.resize(numKeys * 3);
+            readShorts(stream, &channel.values[0], numKeys * 3);
+        }
     }
     //---------------------------------------------------------------------
     void SkeletonSerializer::readKeyFrame(DataStreamPtr& stream, NodeAnimationTrack* track, 
@@ -0,0 +1,242 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreSoftwareAnimationBatch.h"
+#include "OgreOptimisedUtil.h"
+#include "OgreException.h"
+
+namespace Ogre
+{
+	//---------------------------------------------------------------------
+	SoftwareAnimationBatch::SoftwareAnimationBatch(ParallelTaskGroup* taskGroup)
+		: mTaskGroup(taskGroup)
+		, mNumJobsExecuted(0)
+	{
+	}
+	//---------------------------------------------------------------------
+	SoftwareAnimationBatch::~SoftwareAnimationBatch()
+	{
+		// Don't leave anything locked
+		execute();
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::beginJob(void)
+	{
+		// Don't start another if the current one is empty
+		if (mJobStarts.empty() || mJobStarts.back() != mOperations.size())
+			mJobStarts.push_back(mOperations.size());
+	}
+	//---------------------------------------------------------------------
+	void* SoftwareAnimationBatch::lockBuffer(const HardwareVertexBufferSharedPtr& buf, 
+		HardwareBuffer::LockOptions options)
+	{
+		LockedBufferMap::iterator i = mLockedBuffers.find(buf.get());
+		if (i != mLockedBuffers.end())
+		{
+			if (i->second.readOnly && options != HardwareBuffer::HBL_READ_ONLY)
+			{
+				OGRE_EXCEPT(Exception::ERR_INVALID_STATE, 
+					"Buffer is already locked for reading by this batch, so it can't "
+					"be written to until the batch has been executed.",
+					"SoftwareAnimationBatch::lockBuffer");
+			}
+			return i->second.data;
+		}
+
+		LockedBuffer& locked = mLockedBuffers[buf.get()];
+		locked.buffer = buf;
+		locked.data = buf->lock(options);
+		locked.readOnly = options == HardwareBuffer::HBL_READ_ONLY;
+		return locked.data;
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::addSkinning(
+		const float *srcPosPtr, float *destPosPtr,
+		const float *srcNormPtr, float *destNormPtr,
+		const float *blendWeightPtr, const unsigned char* blendIndexPtr,
+		const Matrix4* const* blendMatrices, size_t numMatrices,
+		size_t srcPosStride, size_t destPosStride,
+		size_t srcNormStride, size_t destNormStride,
+		size_t blendWeightStride, size_t blendIndexStride,
+		size_t numWeightsPerVertex,
+		size_t numVertices)
+	{
+		if (mJobStarts.empty())
+			beginJob();
+
+		Operation op;
+		op.type = OT_SKINNING;
+		op.src1 = srcPosPtr;
+		op.src2 = srcNormPtr;
+		op.dst1 = destPosPtr;
+		op.dst2 = destNormPtr;
+		op.blendWeights = blendWeightPtr;
+		op.blendIndices = blendIndexPtr;
+		op.firstBlendMatrix = mBlendMatrices.size();
+		op.srcPosStride = srcPosStride;
+		op.destPosStride = destPosStride;
+		op.srcNormStride = srcNormStride;
+		op.destNormStride = destNormStride;
+		op.blendWeightStride = blendWeightStride;
+		op.blendIndexStride = blendIndexStride;
+		op.numWeightsPerVertex = numWeightsPerVertex;
+		op.count = numVertices;
+		op.t = 0;
+		mOperations.push_back(op);
+
+		mBlendMatrices.insert(mBlendMatrices.end(), blendMatrices, blendMatrices + numMatrices);
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::addMorph(Real t, const float* srcPos1, const float* srcPos2, 
+		float* dstPos, size_t numVertices)
+	{
+		if (mJobStarts.empty())
+			beginJob();
+
+		Operation op;
+		memset(&op, 0, sizeof(op));
+		op.type = OT_MORPH;
+		op.src1 = srcPos1;
+		op.src2 = srcPos2;
+		op.dst1 = dstPos;
+		op.count = numVertices;
+		op.t = t;
+		mOperations.push_back(op);
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::addPoseBlend(Real weight, 
+		const map<size_t, Vector3>::type* vertexOffsetMap, float* dstPos)
+	{
+		if (mJobStarts.empty())
+			beginJob();
+
+		Operation op;
+		memset(&op, 0, sizeof(op));
+		op.type = OT_POSE_BLEND;
+		op.src2 = vertexOffsetMap;
+		op.dst1 = dstPos;
+		op.t = weight;
+		mOperations.push_back(op);
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::addCopy(void* dst, const void* src, size_t length)
+	{
+		if (mJobStarts.empty())
+			beginJob();
+
+		Operation op;
+		memset(&op, 0, sizeof(op));
+		op.type = OT_COPY;
+		op.src1 = src;
+		op.dst1 = dst;
+		op.count = length;
+		mOperations.push_back(op);
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::execute(void)
+	{
+		mTasks.clear();
+		for (size_t j = 0; j < mJobStarts.size(); ++j)
+		{
+			size_t end = j + 1 < mJobStarts.size() ? mJobStarts[j + 1] : mOperations.size();
+			if (end > mJobStarts[j])
+				mTasks.push_back(JobTask(this, mJobStarts[j], end - mJobStarts[j]));
+		}
+		mNumJobsExecuted = mTasks.size();
+
+		if (mTasks.size() == 1)
+		{
+			mTasks.front().execute();
+		}
+		else if (!mTasks.empty())
+		{
+			// Only add pointers once the list has stopped growing
+			for (JobTaskList::iterator i = mTasks.begin(); i != mTasks.end(); ++i)
+				mTaskGroup->addTask(&(*i));
+			mTaskGroup->run();
+		}
+
+		for (LockedBufferMap::iterator i = mLockedBuffers.begin(); i != mLockedBuffers.end(); ++i)
+			i->second.buffer->unlock();
+
+		mLockedBuffers.clear();
+		mOperations.clear();
+		mJobStarts.clear();
+		mBlendMatrices.clear();
+		mTasks.clear();
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::JobTask::execute(void)
+	{
+		for (size_t i = first; i < first + count; ++i)
+			batch->executeOperation(batch->mOperations[i]);
+	}
+	//---------------------------------------------------------------------
+	void SoftwareAnimationBatch::executeOperation(const Operation& op)
+	{
+		switch (op.type)
+		{
+		case OT_SKINNING:
+			OptimisedUtil::getImplementation()->softwareVertexSkinning(
+				static_cast<const float*>(op.src1), static_cast<float*>(op.dst1),
+				static_cast<const float*>(op.src2), op.dst2,
+				op.blendWeights, op.blendIndices,
+				mBlendMatrices.empty() ? 0 : &mBlendMatrices[op.firstBlendMatrix],
+				op.srcPosStride, op.destPosStride,
+				op.srcNormStride, op.destNormStride,
+				op.blendWeightStride, op.blendIndexStride,
+				op.numWeightsPerVertex,
+				op.count);
+			break;
+		case OT_MORPH:
+			OptimisedUtil::getImplementation()->softwareVertexMorph(
+				op.t, static_cast<const float*>(op.src1), static_cast<const float*>(op.src2),
+				static_cast<float*>(op.dst1), op.count);
+			break;
+		case OT_POSE_BLEND:
+			{
+				// As Mesh::softwareVertexPoseBlend
+				const map<size_t, Vector3>::type* offsets = 
+					static_cast<const map<size_t, Vector3>::type*>(op.src2);
+				float* pBase = static_cast<float*>(op.dst1);
+				for (map<size_t, Vector3>::type::const_iterator i = offsets->begin();
+					i != offsets->end(); ++i)
+				{
+					float* pdst = pBase + i->first * 3;
+					pdst[0] = pdst[0] + (i->second.x * op.t);
+					pdst[1] = pdst[1] + (i->second.y * op.t);
+					pdst[2] = pdst[2] + (i->second.z * op.t);
+				}
+			}
+			break;
+		case OT_COPY:
+			memcpy(op.dst1, op.src1, op.count);
+			break;
+		}
+	}
+}
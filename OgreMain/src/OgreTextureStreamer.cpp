@@ -0,0 +1,462 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+#include "OgreTextureStreamer.h"
+#include "OgreTextureManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreImageCodec.h"
+#include "OgreHardwarePixelBuffer.h"
+#include "OgreLogManager.h"
+#include "OgreException.h"
+#include "OgreRoot.h"
+
+namespace Ogre {
+
+    //-----------------------------------------------------------------------
+    template<> TextureStreamer* Singleton<TextureStreamer>::ms_Singleton = 0;
+    TextureStreamer* TextureStreamer::getSingletonPtr(void)
+    {
+        return ms_Singleton;
+    }
+    TextureStreamer& TextureStreamer::getSingleton(void)
+    {  
+        assert( ms_Singleton );  return ( *ms_Singleton );  
+    }
+	//---------------------------------------------------------------------
+	TextureStreamer::TextureStreamer()
+		: mWorkQueueChannel(0)
+		, mInitialised(false)
+		, mTailSize(64)
+		, mMemoryBudget(0)
+	{
+	}
+	//---------------------------------------------------------------------
+	TextureStreamer::~TextureStreamer()
+	{
+		shutdown();
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::initialise()
+	{
+		WorkQueue* wq = Root::getSingleton().getWorkQueue();
+		mWorkQueueChannel = wq->getChannel("Ogre/TextureStreamer");
+		wq->addResponseHandler(mWorkQueueChannel, this);
+		wq->addRequestHandler(mWorkQueueChannel, this);
+		mInitialised = true;
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::shutdown()
+	{
+		// Root shuts us down and then deletes us; don't touch the queue twice,
+		// nor a channel we never registered on
+		if (!mInitialised)
+			return;
+
+		WorkQueue* wq = Root::getSingleton().getWorkQueue();
+		wq->abortRequestsByChannel(mWorkQueueChannel);
+		wq->removeRequestHandler(mWorkQueueChannel, this);
+		wq->removeResponseHandler(mWorkQueueChannel, this);
+		mTextures.clear();
+		mInitialised = false;
+	}
+	//---------------------------------------------------------------------
+	TexturePtr TextureStreamer::load(const String& name, const String& group)
+	{
+		StreamingTextureMap::iterator i = mTextures.find(name);
+		if (i != mTextures.end())
+			return i->second.texture;
+
+		// Find out what the full chain looks like without reading it
+		DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(name, group, true);
+		size_t magicLen = std::min(stream->size(), (size_t)32);
+		char magicBuf[32];
+		stream->read(magicBuf, magicLen);
+		stream->seek(0);
+		Codec* codec = Codec::getCodec(magicBuf, magicLen);
+		if (!codec || codec->getDataType() != "ImageData")
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Unable to identify the image format of " + name, 
+				"TextureStreamer::load");
+		}
+		Codec::CodecDataPtr codecData = static_cast<ImageCodec*>(codec)->decodeHeader(stream);
+		ImageCodec::ImageData* info = static_cast<ImageCodec::ImageData*>(codecData.getPointer());
+		if (info->flags & IF_3D_TEXTURE)
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Volume textures can't be streamed: " + name, 
+				"TextureStreamer::load");
+		}
+
+		StreamingTexture st;
+		st.width = info->width;
+		st.height = info->height;
+		st.numFaces = (info->flags & IF_CUBEMAP) ? 6 : 1;
+		st.numMipmaps = info->num_mipmaps;
+		st.format = info->format;
+		st.tailMip = 0;
+		while (st.tailMip < st.numMipmaps && 
+			std::max(st.width, st.height) >> st.tailMip > mTailSize)
+			++st.tailMip;
+		st.residentMip = st.wantedMip = st.tailMip;
+		st.screenSize = 0;
+		st.lastUsedFrame = 0;
+		st.requestPending = false;
+		st.requestedMip = 0;
+		st.request = 0;
+		st.texture = TextureManager::getSingleton().create(name, group, true, this);
+		st.texture->setTextureType((info->flags & IF_CUBEMAP) ? TEX_TYPE_CUBE_MAP : TEX_TYPE_2D);
+		st.texture->setUsage(TU_STATIC_WRITE_ONLY);
+
+		TexturePtr tex = st.texture;
+		mTextures[name] = st;
+		try
+		{
+			tex->load();
+		}
+		catch (...)
+		{
+			mTextures.erase(name);
+			TextureManager::getSingleton().remove(name);
+			throw;
+		}
+		return tex;
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::remove(const String& name)
+	{
+		StreamingTextureMap::iterator i = mTextures.find(name);
+		if (i != mTextures.end())
+		{
+			if (i->second.requestPending)
+				Root::getSingleton().getWorkQueue()->abortRequest(i->second.request);
+			// We created the texture, so it had no loader before us; it loads 
+			// from its file like any other texture from now on
+			i->second.texture->_notifyManualLoader(false, 0);
+			mTextures.erase(i);
+		}
+	}
+	//---------------------------------------------------------------------
+	bool TextureStreamer::isStreaming(const String& name) const
+	{
+		return mTextures.find(name) != mTextures.end();
+	}
+	//---------------------------------------------------------------------
+	const TextureStreamer::StreamingTexture& TextureStreamer::getStreamingTexture(
+		const String& name) const
+	{
+		StreamingTextureMap::const_iterator i = mTextures.find(name);
+		if (i == mTextures.end())
+		{
+			OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, 
+				"Texture " + name + " is not being streamed", 
+				"TextureStreamer::getStreamingTexture");
+		}
+		return i->second;
+	}
+	//---------------------------------------------------------------------
+	size_t TextureStreamer::getResidentMipmap(const String& name) const
+	{
+		return getStreamingTexture(name).residentMip;
+	}
+	//---------------------------------------------------------------------
+	size_t TextureStreamer::getWantedMipmap(const String& name) const
+	{
+		return getStreamingTexture(name).wantedMip;
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::notifyScreenSize(const TexturePtr& tex, Real pixels)
+	{
+		StreamingTextureMap::iterator i = mTextures.find(tex->getName());
+		if (i == mTextures.end())
+			return;
+		StreamingTexture& st = i->second;
+
+		unsigned long frame = Root::getSingleton().getNextFrameNumber();
+		if (st.lastUsedFrame != frame || pixels > st.screenSize)
+			st.screenSize = pixels;
+		st.lastUsedFrame = frame;
+
+		// The smallest level which is still at least as large as it's drawn
+		size_t largest = std::max(st.width, st.height);
+		size_t mip = 0;
+		while (mip < st.tailMip && (Real)(largest >> (mip + 1)) >= st.screenSize)
+			++mip;
+		st.wantedMip = mip;
+
+		if (st.wantedMip < st.residentMip)
+			requestMipmaps(st);
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::setMemoryBudget(size_t bytes)
+	{
+		mMemoryBudget = bytes;
+		reclaimMemory(0, 0);
+	}
+	//---------------------------------------------------------------------
+	size_t TextureStreamer::getMemoryUsage() const
+	{
+		size_t usage = 0;
+		for (StreamingTextureMap::const_iterator i = mTextures.begin(); i != mTextures.end(); ++i)
+		{
+			if (i->second.texture->isLoaded())
+				usage += getMemorySize(i->second, i->second.residentMip);
+		}
+		return usage;
+	}
+	//---------------------------------------------------------------------
+	size_t TextureStreamer::getMemorySize(const StreamingTexture& st, size_t mip)
+	{
+		return Image::calculateSize(st.numMipmaps - mip, st.numFaces, 
+			std::max((size_t)1, st.width >> mip), std::max((size_t)1, st.height >> mip), 
+			1, st.format);
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::requestMipmaps(StreamingTexture& st)
+	{
+		WorkQueue* wq = Root::getSingleton().getWorkQueue();
+		int priority = static_cast<int>(std::min(st.screenSize, (Real)std::numeric_limits<int>::max()));
+		if (st.requestPending)
+		{
+			// Let the request in progress finish first, but sooner
+			wq->setRequestPriority(st.request, priority);
+			return;
+		}
+
+		if (!st.texture->isLoaded())
+			return;
+
+		size_t growth = getMemorySize(st, st.wantedMip) - getMemorySize(st, st.residentMip);
+		if (!reclaimMemory(growth, &st))
+			return;
+
+		StreamRequest req;
+		req.name = st.texture->getName();
+		req.group = st.texture->getGroup();
+		req.firstMip = st.wantedMip;
+		st.requestPending = true;
+		st.requestedMip = st.wantedMip;
+		// The response may be handled before this returns if the queue is synchronous
+		WorkQueue::RequestID id = wq->addRequestWithPriority(
+			mWorkQueueChannel, 0, Any(req), priority);
+		if (st.requestPending && st.requestedMip == req.firstMip)
+			st.request = id;
+	}
+	//---------------------------------------------------------------------
+	bool TextureStreamer::reclaimMemory(size_t bytesNeeded, const StreamingTexture* keep)
+	{
+		if (!mMemoryBudget)
+			return true;
+
+		size_t usage = getMemoryUsage();
+		if (usage + bytesNeeded <= mMemoryBudget)
+			return true;
+
+		// Textures not used this frame, least recently used first, then smallest
+		typedef std::pair<std::pair<unsigned long, Real>, StreamingTexture*> Candidate;
+		vector<Candidate>::type candidates;
+		unsigned long frame = Root::getSingleton().getNextFrameNumber();
+		for (StreamingTextureMap::iterator i = mTextures.begin(); i != mTextures.end(); ++i)
+		{
+			StreamingTexture& st = i->second;
+			if (&st != keep && st.lastUsedFrame != frame && 
+				st.residentMip < st.tailMip && st.texture->isLoaded())
+			{
+				candidates.push_back(Candidate(
+					std::make_pair(st.lastUsedFrame, st.screenSize), &st));
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		for (vector<Candidate>::type::iterator i = candidates.begin(); 
+			i != candidates.end() && usage + bytesNeeded > mMemoryBudget; ++i)
+		{
+			StreamingTexture& st = *i->second;
+			// Drop one level at a time, the largest level is most of the memory
+			size_t mip = st.residentMip;
+			while (mip < st.tailMip && 
+				usage - (getMemorySize(st, st.residentMip) - getMemorySize(st, mip)) + bytesNeeded > mMemoryBudget)
+				++mip;
+			usage -= getMemorySize(st, st.residentMip) - getMemorySize(st, mip);
+			dropMipmaps(st, mip);
+		}
+
+		return usage + bytesNeeded <= mMemoryBudget;
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::dropMipmaps(StreamingTexture& st, size_t firstMip)
+	{
+		// Read the levels we're keeping back from the texture
+		TexturePtr& tex = st.texture;
+		size_t skip = firstMip - st.residentMip;
+		size_t numMipmaps = st.numMipmaps - firstMip;
+		size_t width = std::max((size_t)1, tex->getWidth() >> skip);
+		size_t height = std::max((size_t)1, tex->getHeight() >> skip);
+		PixelFormat format = tex->getFormat();
+		size_t size = Image::calculateSize(numMipmaps, st.numFaces, width, height, 1, format);
+		uchar* data = OGRE_ALLOC_T(uchar, size, MEMCATEGORY_GENERAL);
+		uchar* dest = data;
+		for (size_t face = 0; face < st.numFaces; ++face)
+		{
+			size_t w = width, h = height;
+			for (size_t mip = 0; mip <= numMipmaps; ++mip)
+			{
+				PixelBox box(w, h, 1, format, dest);
+				tex->getBuffer(face, skip + mip)->blitToMemory(box);
+				dest += PixelUtil::getMemorySize(w, h, 1, format);
+				if (w != 1) w /= 2;
+				if (h != 1) h /= 2;
+			}
+		}
+
+		Image image;
+		image.loadDynamicImage(data, width, height, 1, format, true, st.numFaces, numMipmaps);
+		applyImage(st, image, firstMip);
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::applyImage(StreamingTexture& st, const Image& image, size_t firstMip)
+	{
+		Texture* tex = st.texture.getPointer();
+		ResourceManager* creator = tex->getCreator();
+
+		creator->_notifyResourceUnloaded(tex);
+		{
+			OGRE_LOCK_MUTEX(tex->OGRE_AUTO_MUTEX_NAME)
+			tex->freeInternalResources();
+			tex->setNumMipmaps(image.getNumMipmaps());
+			ConstImagePtrList images;
+			images.push_back(&image);
+			tex->_loadImages(images);
+		}
+		creator->_notifyResourceLoaded(tex);
+		tex->_dirtyState();
+
+		st.residentMip = firstMip;
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::readMipmaps(const String& name, const String& group, 
+		size_t firstMip, Image& image)
+	{
+		DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(name, group, true);
+		size_t magicLen = std::min(stream->size(), (size_t)32);
+		char magicBuf[32];
+		stream->read(magicBuf, magicLen);
+		stream->seek(0);
+		Codec* codec = Codec::getCodec(magicBuf, magicLen);
+		if (!codec || codec->getDataType() != "ImageData")
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Unable to identify the image format of " + name, 
+				"TextureStreamer::readMipmaps");
+		}
+
+		Codec::DecodeResult res = static_cast<ImageCodec*>(codec)->decodeMipmaps(stream, firstMip);
+		ImageCodec::ImageData* data = static_cast<ImageCodec::ImageData*>(res.second.getPointer());
+		image.loadDynamicImage(res.first->getPtr(), data->width, data->height, data->depth, 
+			data->format, true, (data->flags & IF_CUBEMAP) ? 6 : 1, data->num_mipmaps);
+		// Image now owns the data
+		res.first->setFreeOnClose(false);
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::loadResource(Resource* resource)
+	{
+		StreamingTextureMap::iterator i = mTextures.find(resource->getName());
+		if (i == mTextures.end())
+		{
+			OGRE_EXCEPT(Exception::ERR_ITEM_NOT_FOUND, 
+				"Texture " + resource->getName() + " is not being streamed", 
+				"TextureStreamer::loadResource");
+		}
+		StreamingTexture& st = i->second;
+
+		// Start again from the tail, larger levels are requested when next used
+		Image image;
+		readMipmaps(resource->getName(), resource->getGroup(), st.tailMip, image);
+		Texture* tex = static_cast<Texture*>(resource);
+		tex->setNumMipmaps(image.getNumMipmaps());
+		ConstImagePtrList images;
+		images.push_back(&image);
+		tex->_loadImages(images);
+		st.residentMip = st.tailMip;
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::Response* TextureStreamer::handleRequest(const WorkQueue::Request* req, 
+		const WorkQueue* srcQ)
+	{
+		StreamRequest streamReq = any_cast<StreamRequest>(req->getData());
+		StreamResult result;
+		if (!req->getAborted())
+		{
+			try
+			{
+				result.image.bind(OGRE_NEW Image());
+				readMipmaps(streamReq.name, streamReq.group, streamReq.firstMip, *result.image);
+			}
+			catch (Exception& e)
+			{
+				return OGRE_NEW WorkQueue::Response(req, false, Any(), e.getFullDescription());
+			}
+		}
+		return OGRE_NEW WorkQueue::Response(req, true, Any(result));
+	}
+	//---------------------------------------------------------------------
+	void TextureStreamer::handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ)
+	{
+		StreamRequest streamReq = any_cast<StreamRequest>(res->getRequest()->getData());
+		StreamingTextureMap::iterator i = mTextures.find(streamReq.name);
+		if (i == mTextures.end())
+			return;
+		StreamingTexture& st = i->second;
+		// Ignore responses to requests we've given up on
+		if (!st.requestPending || st.requestedMip != streamReq.firstMip)
+			return;
+		st.requestPending = false;
+
+		if (!res->succeeded())
+		{
+			LogManager::getSingleton().stream() << "TextureStreamer: unable to read mipmaps of " 
+				<< streamReq.name << ": " << res->getMessages();
+			return;
+		}
+		if (res->getRequest()->getAborted() || !st.texture->isLoaded())
+			return;
+
+		// Only use the levels if they're still wanted and there's still room
+		if (streamReq.firstMip < st.residentMip && 
+			reclaimMemory(getMemorySize(st, streamReq.firstMip) - getMemorySize(st, st.residentMip), &st))
+		{
+			StreamResult result = any_cast<StreamResult>(res->getData());
+			applyImage(st, *result.image, streamReq.firstMip);
+		}
+
+		// Ask for more if the texture has grown on screen in the meantime
+		if (st.wantedMip < st.residentMip)
+			requestMipmaps(st);
+	}
+
+}
@@ -0,0 +1,295 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreTiledImage.h"
+#include "OgreImageCodec.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreException.h"
+
+namespace Ogre {
+
+	//---------------------------------------------------------------------
+	RawImageRegionReader::RawImageRegionReader(const DataStreamPtr& stream, 
+		size_t width, size_t height, PixelFormat format, size_t offset, size_t rowPitch)
+		: mStream(stream)
+		, mWidth(width)
+		, mHeight(height)
+		, mFormat(format)
+		, mOffset(offset)
+		, mRowPitch(rowPitch ? rowPitch : width * PixelUtil::getNumElemBytes(format))
+	{
+		if (!PixelUtil::isAccessible(format))
+		{
+			OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, 
+				"Raw image data must be in an accessible format",
+				"RawImageRegionReader::RawImageRegionReader");
+		}
+	}
+	//---------------------------------------------------------------------
+	void RawImageRegionReader::readRegion(const Box& region, const PixelBox& dst)
+	{
+		assert(region.right <= mWidth && region.bottom <= mHeight && region.getDepth() == 1);
+
+		size_t pixelSize = PixelUtil::getNumElemBytes(mFormat);
+		size_t width = region.getWidth();
+		size_t dstPixelSize = PixelUtil::getNumElemBytes(dst.format);
+		uchar* dstRow = static_cast<uchar*>(dst.data) + 
+			(dst.left + dst.top * dst.rowPitch + dst.front * dst.slicePitch) * dstPixelSize;
+		if (dst.format == mFormat && width == mWidth && width == dst.rowPitch && 
+			mRowPitch == width * pixelSize)
+		{
+			// Whole rows one after another at both ends, so read them all at once
+			mStream->seek(mOffset + region.top * mRowPitch);
+			mStream->read(dstRow, region.getHeight() * mRowPitch);
+			return;
+		}
+
+		MemoryDataStream row(width * pixelSize);
+		for (size_t y = region.top; y < region.bottom; ++y)
+		{
+			mStream->seek(mOffset + y * mRowPitch + region.left * pixelSize);
+			mStream->read(row.getPtr(), width * pixelSize);
+			PixelUtil::bulkPixelConversion(
+				PixelBox(width, 1, 1, mFormat, row.getPtr()),
+				PixelBox(width, 1, 1, dst.format, dstRow));
+			dstRow += dst.rowPitch * dstPixelSize;
+		}
+	}
+	//---------------------------------------------------------------------
+	MemoryImageRegionReader::MemoryImageRegionReader(DataStreamPtr& stream, const String& type)
+	{
+		mImage.load(stream, type);
+		if (!PixelUtil::isAccessible(mImage.getFormat()))
+		{
+			// Compressed, so it's decompressed once up front
+			mImage.convert(PF_BYTE_RGBA);
+		}
+	}
+	//---------------------------------------------------------------------
+	void MemoryImageRegionReader::readRegion(const Box& region, const PixelBox& dst)
+	{
+		PixelUtil::bulkPixelConversion(mImage.getPixelBox().getSubVolume(region), dst);
+	}
+	//---------------------------------------------------------------------
+	//---------------------------------------------------------------------
+	const size_t TiledImage::DEFAULT_TILE_SIZE = 256;
+	const size_t TiledImage::DEFAULT_CACHE_SIZE = 64 * 1024 * 1024;
+	//---------------------------------------------------------------------
+	TiledImage::TiledImage(ImageRegionReader* reader, size_t tileSize, size_t cacheSize)
+		: mReader(reader)
+		, mTileSize(tileSize)
+		, mCacheSize(cacheSize)
+	{
+		init();
+	}
+	//---------------------------------------------------------------------
+	TiledImage::TiledImage(const String& filename, const String& groupName, 
+		size_t tileSize, size_t cacheSize)
+		: mReader(0)
+		, mTileSize(tileSize)
+		, mCacheSize(cacheSize)
+	{
+		String ext;
+		size_t pos = filename.find_last_of(".");
+		if (pos != String::npos && pos < (filename.length() - 1))
+			ext = filename.substr(pos + 1);
+
+		DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(filename, groupName);
+		mReader = createReader(stream, ext);
+		init();
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::init()
+	{
+		assert(mReader && mTileSize > 0);
+		mWidth = mReader->getWidth();
+		mHeight = mReader->getHeight();
+		mFormat = mReader->getFormat();
+		mMemoryUsage = 0;
+		mNumTileReads = 0;
+	}
+	//---------------------------------------------------------------------
+	TiledImage::~TiledImage()
+	{
+		for (TileMap::iterator i = mTiles.begin(); i != mTiles.end(); ++i)
+			OGRE_FREE(i->second.data, MEMCATEGORY_GENERAL);
+		OGRE_DELETE mReader;
+	}
+	//---------------------------------------------------------------------
+	ImageRegionReader* TiledImage::createReader(DataStreamPtr& stream, const String& type)
+	{
+		Codec* codec = 0;
+		if (!type.empty())
+		{
+			codec = Codec::getCodec(type);
+		}
+		else
+		{
+			// derive from magic number
+			size_t magicLen = std::min(stream->size(), (size_t)32);
+			char magicBuf[32];
+			stream->read(magicBuf, magicLen);
+			stream->seek(0);
+			codec = Codec::getCodec(magicBuf, magicLen);
+		}
+		if (codec && codec->getDataType() == "ImageData")
+		{
+			ImageRegionReader* reader = static_cast<ImageCodec*>(codec)->createRegionReader(stream);
+			if (reader)
+				return reader;
+			stream->seek(0);
+		}
+		return OGRE_NEW MemoryImageRegionReader(stream, type);
+	}
+	//---------------------------------------------------------------------
+	Box TiledImage::getTileBox(size_t tileX, size_t tileY) const
+	{
+		assert(tileX < getNumTilesX() && tileY < getNumTilesY());
+		return Box(tileX * mTileSize, tileY * mTileSize, 
+			std::min(mWidth, (tileX + 1) * mTileSize), 
+			std::min(mHeight, (tileY + 1) * mTileSize));
+	}
+	//---------------------------------------------------------------------
+	PixelBox TiledImage::lockTile(size_t tileX, size_t tileY)
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		Box box = getTileBox(tileX, tileY);
+		size_t index = tileY * getNumTilesX() + tileX;
+		TileMap::iterator i = mTiles.find(index);
+		if (i == mTiles.end())
+		{
+			Tile tile;
+			tile.size = PixelUtil::getMemorySize(box.getWidth(), box.getHeight(), 1, mFormat);
+			tile.data = OGRE_ALLOC_T(uchar, tile.size, MEMCATEGORY_GENERAL);
+			tile.locks = 0;
+			mReader->readRegion(box, 
+				PixelBox(box.getWidth(), box.getHeight(), 1, mFormat, tile.data));
+			++mNumTileReads;
+
+			mRecentTiles.push_front(index);
+			tile.recent = mRecentTiles.begin();
+			i = mTiles.insert(TileMap::value_type(index, tile)).first;
+			mMemoryUsage += tile.size;
+		}
+		else
+		{
+			mRecentTiles.splice(mRecentTiles.begin(), mRecentTiles, i->second.recent);
+		}
+		++i->second.locks;
+		// Made room for after it's locked, so that it isn't dropped itself
+		evict(mCacheSize);
+
+		return PixelBox(box.getWidth(), box.getHeight(), 1, mFormat, i->second.data);
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::unlockTile(size_t tileX, size_t tileY)
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		TileMap::iterator i = mTiles.find(tileY * getNumTilesX() + tileX);
+		assert(i != mTiles.end() && i->second.locks > 0);
+		--i->second.locks;
+		evict(mCacheSize);
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::readRegion(const Box& region, const PixelBox& dst)
+	{
+		assert(region.right <= mWidth && region.bottom <= mHeight && region.getDepth() == 1);
+		assert(dst.getWidth() == region.getWidth() && dst.getHeight() == region.getHeight());
+
+		size_t lastX = (region.right + mTileSize - 1) / mTileSize;
+		size_t lastY = (region.bottom + mTileSize - 1) / mTileSize;
+		for (size_t tileY = region.top / mTileSize; tileY < lastY; ++tileY)
+		{
+			for (size_t tileX = region.left / mTileSize; tileX < lastX; ++tileX)
+			{
+				Box tileBox = getTileBox(tileX, tileY);
+				Box part(std::max(region.left, tileBox.left), std::max(region.top, tileBox.top),
+					std::min(region.right, tileBox.right), std::min(region.bottom, tileBox.bottom));
+
+				PixelBox tile = lockTile(tileX, tileY);
+				PixelUtil::bulkPixelConversion(
+					tile.getSubVolume(Box(part.left - tileBox.left, part.top - tileBox.top, 
+						part.right - tileBox.left, part.bottom - tileBox.top)),
+					dst.getSubVolume(Box(
+						dst.left + part.left - region.left, dst.top + part.top - region.top, dst.front,
+						dst.left + part.right - region.left, dst.top + part.bottom - region.top, dst.back)));
+				unlockTile(tileX, tileY);
+			}
+		}
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::setCacheSize(size_t bytes)
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		mCacheSize = bytes;
+		evict(mCacheSize);
+	}
+	//---------------------------------------------------------------------
+	size_t TiledImage::getCacheMemoryUsage() const
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		return mMemoryUsage;
+	}
+	//---------------------------------------------------------------------
+	size_t TiledImage::getNumCachedTiles() const
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		return mTiles.size();
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::clearCache()
+	{
+		OGRE_LOCK_AUTO_MUTEX
+
+		evict(0);
+	}
+	//---------------------------------------------------------------------
+	void TiledImage::evict(size_t bytes)
+	{
+		list<size_t>::type::iterator next = mRecentTiles.end();
+		while (mMemoryUsage > bytes && next != mRecentTiles.begin())
+		{
+			--next;
+			TileMap::iterator i = mTiles.find(*next);
+			if (i->second.locks)
+				continue;
+
+			mMemoryUsage -= i->second.size;
+			OGRE_FREE(i->second.data, MEMCATEGORY_GENERAL);
+			next = mRecentTiles.erase(next);
+			mTiles.erase(i);
+		}
+	}
+
+}
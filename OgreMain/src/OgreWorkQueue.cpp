@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
+#include "OgreTimer.h"
 
 namespace Ogre {
 	//---------------------------------------------------------------------
@@ -45,8 +46,10 @@ namespace Ogre {
 		return i->second;
 	}
 	//---------------------------------------------------------------------
-	WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid)
+	WorkQueue::Request::Request(uint16 channel, uint16 rtype, const Any& rData, uint8 retry, RequestID rid,
+		int priority)
 		: mChannel(channel), mType(rtype), mData(rData), mRetryCount(retry), mID(rid), mAborted(false)
+		, mPriority(priority)
 	{
 
 	}
@@ -58,7 +61,7 @@ namespace Ogre {
 	//---------------------------------------------------------------------
 	//---------------------------------------------------------------------
 	WorkQueue::Response::Response(const Request* rq, bool success, const Any& data, const String& msg)
-		: mRequest(rq), mSuccess(success), mMessages(msg), mData(data)
+		: mRequest(rq), mSuccess(success), mMessages(msg), mData(data), mYielded(false)
 	{
 		
 	}
@@ -79,7 +82,9 @@ namespace Ogre {
 		, mRequestCount(0)
 		, mPaused(false)
 		, mAcceptRequests(true)
+		, mShuttingDown(false)
 	{
+		mTimer = OGRE_NEW Timer();
 	}
 	//---------------------------------------------------------------------
 	const String& DefaultWorkQueueBase::getName() const
@@ -111,17 +116,26 @@ namespace Ogre {
 	{
 		//shutdown(); // can't call here; abstract function
 
-		for (RequestQueue::iterator i = mRequestQueue.begin(); i != mRequestQueue.end(); ++i)
+		for (PendingRequestMap::iterator i = mPendingRequests.begin(); i != mPendingRequests.end(); ++i)
 		{
-			OGRE_DELETE (*i);
+			OGRE_DELETE i->second.request;
 		}
-		mRequestQueue.clear();
+		mPendingRequests.clear();
+		mChannelStates.clear();
 
 		for (ResponseQueue::iterator i = mResponseQueue.begin(); i != mResponseQueue.end(); ++i)
 		{
 			OGRE_DELETE (*i);
 		}
 		mResponseQueue.clear();
+
+		for (YieldedResponseList::iterator i = mYieldedResponses.begin(); i != mYieldedResponses.end(); ++i)
+		{
+			OGRE_DELETE i->response;
+		}
+		mYieldedResponses.clear();
+
+		OGRE_DELETE mTimer;
 	}
 	//---------------------------------------------------------------------
 	void DefaultWorkQueueBase::addRequestHandler(uint16 channel, RequestHandler* rh)
@@ -194,13 +208,35 @@ namespace Ogre {
 				handlers.erase(j);
 
 		}
+
+		// The handler can't continue any responses it yielded on
+		OGRE_LOCK_MUTEX(mResponseMutex)
+		YieldedResponseList::iterator y = mYieldedResponses.begin();
+		while (y != mYieldedResponses.end())
+		{
+			y->handlers.remove(rh);
+			if (y->handlers.empty())
+			{
+				OGRE_DELETE y->response;
+				y = mYieldedResponses.erase(y);
+			}
+			else
+				++y;
+		}
 	}
 	//---------------------------------------------------------------------
 	WorkQueue::RequestID DefaultWorkQueueBase::addRequest(uint16 channel, uint16 requestType, 
 		const Any& rData, uint8 retryCount, bool forceSynchronous)
+	{
+		return addRequestWithPriority(channel, requestType, rData, 0, retryCount, forceSynchronous);
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::RequestID DefaultWorkQueueBase::addRequestWithPriority(uint16 channel, 
+		uint16 requestType, const Any& rData, int priority, uint8 retryCount, bool forceSynchronous)
 	{
 		Request* req = 0;
 		RequestID rid = 0;
+		bool queued = false;
 
 		{
 			// lock to acquire rid and push request to the queue
@@ -210,44 +246,54 @@ namespace Ogre {
 				return 0;
 
 			rid = ++mRequestCount;
-			req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid);
+			req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid, priority);
 
-			LogManager::getSingleton().stream(LML_TRIVIAL) << 
-				"DefaultWorkQueueBase('" << mName << "') - QUEUED(thread:" <<
-#if OGRE_THREAD_SUPPORT
-				OGRE_THREAD_CURRENT_ID
-#else
-				"main"
-#endif
-				<< "): ID=" << rid
-			    << " channel=" << channel << " requestType=" << requestType;
 #if OGRE_THREAD_SUPPORT
 			if (!forceSynchronous)
 			{
-				mRequestQueue.push_back(req);
-				notifyWorkers();
-				return rid;
+				queueRequest(req);
+				queued = true;
 			}
 #endif
 		}
-		
 
-		processRequestResponse(req, true);
+		// Log outside the lock, so that workers aren't held up by it
+		LogManager::getSingleton().stream(LML_TRIVIAL) << 
+			"DefaultWorkQueueBase('" << mName << "') - QUEUED(thread:" <<
+#if OGRE_THREAD_SUPPORT
+			OGRE_THREAD_CURRENT_ID
+#else
+			"main"
+#endif
+			<< "): ID=" << rid
+			<< " channel=" << channel << " requestType=" << requestType
+			<< " priority=" << priority;
+
+		if (queued)
+			notifyWorkers();
+		else
+			processRequestResponse(req, true);
 
 		return rid;
 
 	}
 	//---------------------------------------------------------------------
 	void DefaultWorkQueueBase::addRequestWithRID(WorkQueue::RequestID rid, uint16 channel, 
-		uint16 requestType, const Any& rData, uint8 retryCount)
+		uint16 requestType, const Any& rData, uint8 retryCount, int priority)
 	{
-		// lock to push request to the queue
-		OGRE_LOCK_MUTEX(mRequestMutex)
+		Request* req = 0;
+		{
+			// lock to push request to the queue
+			OGRE_LOCK_MUTEX(mRequestMutex)
 
-		if (mShuttingDown)
-			return;
+			if (mShuttingDown)
+				return;
 
-		Request* req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid);
+			req = OGRE_NEW Request(channel, requestType, rData, retryCount, rid, priority);
+#if OGRE_THREAD_SUPPORT
+			queueRequest(req);
+#endif
+		}
 
 		LogManager::getSingleton().stream(LML_TRIVIAL) << 
 			"DefaultWorkQueueBase('" << mName << "') - REQUEUED(thread:" <<
@@ -259,13 +305,128 @@ namespace Ogre {
 			<< "): ID=" << rid
 				   << " channel=" << channel << " requestType=" << requestType;
 #if OGRE_THREAD_SUPPORT
-		mRequestQueue.push_back(req);
 		notifyWorkers();
 #else
 		processRequestResponse(req, true);
 #endif
 	}
 	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::queueRequest(Request* r)
+	{
+		PendingRequest pending;
+		pending.request = r;
+		pending.queueTime = getStatisticsTime();
+		mPendingRequests[r->getID()] = pending;
+		mChannelStates[r->getChannel()].requests.insert(r);
+	}
+	//---------------------------------------------------------------------
+	WorkQueue::Request* DefaultWorkQueueBase::takeNextRequest()
+	{
+		// Compare the first request of each channel which may take another 
+		// worker; there are only ever a few channels
+		ChannelStateMap::iterator best = mChannelStates.end();
+		RequestPriorityLess higherPriority;
+		for (ChannelStateMap::iterator i = mChannelStates.begin(); i != mChannelStates.end(); ++i)
+		{
+			ChannelState& state = i->second;
+			if (state.requests.empty() ||
+				(state.workerLimit && state.activeRequests >= state.workerLimit))
+				continue;
+			if (best == mChannelStates.end() || 
+				higherPriority(*state.requests.begin(), *best->second.requests.begin()))
+				best = i;
+		}
+		if (best == mChannelStates.end())
+			return 0;
+
+		ChannelState& state = best->second;
+		Request* r = *state.requests.begin();
+		state.requests.erase(state.requests.begin());
+		++state.activeRequests;
+
+		PendingRequestMap::iterator p = mPendingRequests.find(r->getID());
+		unsigned long waitTime = getStatisticsTime() - p->second.queueTime;
+		mPendingRequests.erase(p);
+		state.statistics.totalWaitTime += waitTime;
+		state.statistics.maxWaitTime = std::max(state.statistics.maxWaitTime, waitTime);
+
+		return r;
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueBase::hasRunnableRequests() const
+	{
+		for (ChannelStateMap::const_iterator i = mChannelStates.begin(); i != mChannelStates.end(); ++i)
+		{
+			const ChannelState& state = i->second;
+			if (!state.requests.empty() &&
+				(!state.workerLimit || state.activeRequests < state.workerLimit))
+				return true;
+		}
+		return false;
+	}
+	//---------------------------------------------------------------------
+	unsigned long DefaultWorkQueueBase::getStatisticsTime()
+	{
+		OGRE_LOCK_MUTEX(mTimerMutex)
+		return mTimer->getMicroseconds();
+	}
+	//---------------------------------------------------------------------
+	bool DefaultWorkQueueBase::setRequestPriority(RequestID id, int priority)
+	{
+		OGRE_LOCK_MUTEX(mRequestMutex)
+
+		PendingRequestMap::iterator i = mPendingRequests.find(id);
+		if (i == mPendingRequests.end())
+			return false;
+
+		// The priority is part of the ordering, so the request must be reinserted
+		Request* r = i->second.request;
+		PriorityRequestQueue& requests = mChannelStates[r->getChannel()].requests;
+		requests.erase(r);
+		r->mPriority = priority;
+		requests.insert(r);
+		return true;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::setChannelWorkerLimit(uint16 channel, size_t maxWorkers)
+	{
+		{
+			OGRE_LOCK_MUTEX(mRequestMutex)
+			mChannelStates[channel].workerLimit = maxWorkers;
+		}
+		// Requests held back by the old limit may be runnable now
+		notifyWorkers();
+	}
+	//---------------------------------------------------------------------
+	size_t DefaultWorkQueueBase::getChannelWorkerLimit(uint16 channel) const
+	{
+		OGRE_LOCK_MUTEX(mRequestMutex)
+		ChannelStateMap::const_iterator i = mChannelStates.find(channel);
+		return i == mChannelStates.end() ? 0 : i->second.workerLimit;
+	}
+	//---------------------------------------------------------------------
+	DefaultWorkQueueBase::ChannelStatistics DefaultWorkQueueBase::getChannelStatistics(
+		uint16 channel) const
+	{
+		OGRE_LOCK_MUTEX(mRequestMutex)
+		ChannelStatistics ret;
+		ChannelStateMap::const_iterator i = mChannelStates.find(channel);
+		if (i != mChannelStates.end())
+		{
+			ret = i->second.statistics;
+			ret.queueDepth = i->second.requests.size();
+			ret.activeRequests = i->second.activeRequests;
+		}
+		return ret;
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::resetStatistics()
+	{
+		OGRE_LOCK_MUTEX(mRequestMutex)
+		for (ChannelStateMap::iterator i = mChannelStates.begin(); i != mChannelStates.end(); ++i)
+			i->second.statistics = ChannelStatistics();
+	}
+	//---------------------------------------------------------------------
 	void DefaultWorkQueueBase::abortRequest(RequestID id)
 	{
 		OGRE_LOCK_MUTEX(mProcessMutex)
@@ -285,14 +446,10 @@ namespace Ogre {
 		{
 			OGRE_LOCK_MUTEX(mRequestMutex)
 
-			for (RequestQueue::iterator i = mRequestQueue.begin(); i != mRequestQueue.end(); ++i)
-			{
-				if ((*i)->getID() == id)
-				{
-					(*i)->abortRequest();
-					break;
-				}
-			}
+			// Still delivered, so that handlers can clean up their data
+			PendingRequestMap::iterator i = mPendingRequests.find(id);
+			if (i != mPendingRequests.end())
+				i->second.request->abortRequest();
 		}
 
 		{
@@ -306,6 +463,12 @@ namespace Ogre {
 					break;
 				}
 			}
+			// Handlers which yielded still own the data, so only flag these
+			for (YieldedResponseList::iterator i = mYieldedResponses.begin(); i != mYieldedResponses.end(); ++i)
+			{
+				if (i->response->getRequest()->getID() == id)
+					i->response->getRequest()->abortRequest();
+			}
 		}
 	}
 	//---------------------------------------------------------------------
@@ -324,9 +487,11 @@ namespace Ogre {
 		{
 			OGRE_LOCK_MUTEX(mRequestMutex)
 
-			for (RequestQueue::iterator i = mRequestQueue.begin(); i != mRequestQueue.end(); ++i)
+			ChannelStateMap::iterator c = mChannelStates.find(channel);
+			if (c != mChannelStates.end())
 			{
-				if ((*i)->getChannel() == channel)
+				PriorityRequestQueue& requests = c->second.requests;
+				for (PriorityRequestQueue::iterator i = requests.begin(); i != requests.end(); ++i)
 				{
 					(*i)->abortRequest();
 				}
@@ -343,6 +508,11 @@ namespace Ogre {
 					(*i)->abortRequest();
 				}
 			}
+			for (YieldedResponseList::iterator i = mYieldedResponses.begin(); i != mYieldedResponses.end(); ++i)
+			{
+				if (i->response->getRequest()->getChannel() == channel)
+					i->response->getRequest()->abortRequest();
+			}
 		}
 	}
 	//---------------------------------------------------------------------
@@ -358,9 +528,9 @@ namespace Ogre {
 		{
 			OGRE_LOCK_MUTEX(mRequestMutex)
 
-			for (RequestQueue::iterator i = mRequestQueue.begin(); i != mRequestQueue.end(); ++i)
+			for (PendingRequestMap::iterator i = mPendingRequests.begin(); i != mPendingRequests.end(); ++i)
 			{
-				(*i)->abortRequest();
+				i->second.request->abortRequest();
 			}
 		}
 
@@ -371,6 +541,10 @@ namespace Ogre {
 			{
 				(*i)->abortRequest();
 			}
+			for (YieldedResponseList::iterator i = mYieldedResponses.begin(); i != mYieldedResponses.end(); ++i)
+			{
+				i->response->getRequest()->abortRequest();
+			}
 		}
 	}
 	//---------------------------------------------------------------------
@@ -407,12 +581,9 @@ namespace Ogre {
 			{
 				OGRE_LOCK_MUTEX(mRequestMutex)
 
-				if (!mRequestQueue.empty())
-				{
-					request = mRequestQueue.front();
-					mRequestQueue.pop_front();
+				request = takeNextRequest();
+				if (request)
 					mProcessQueue.push_back( request );
-				}
 			}
 		}
 
@@ -426,7 +597,9 @@ namespace Ogre {
 	//---------------------------------------------------------------------
 	void DefaultWorkQueueBase::processRequestResponse(Request* r, bool synchronous)
 	{
+		unsigned long startTime = getStatisticsTime();
 		Response* response = processRequest(r);
+		unsigned long serviceTime = getStatisticsTime() - startTime;
 
 		OGRE_LOCK_MUTEX(mProcessMutex)
 
@@ -440,6 +613,25 @@ namespace Ogre {
 			}
 		}
 
+		bool notify = false;
+		{
+			OGRE_LOCK_MUTEX(mRequestMutex)
+
+			ChannelState& state = mChannelStates[r->getChannel()];
+			if (!synchronous)
+			{
+				--state.activeRequests;
+				// A request held back by the channel's worker limit can go now
+				notify = state.workerLimit && !state.requests.empty();
+			}
+			ChannelStatistics& stats = state.statistics;
+			++stats.processedRequests;
+			stats.totalServiceTime += serviceTime;
+			stats.maxServiceTime = std::max(stats.maxServiceTime, serviceTime);
+		}
+		if (notify)
+			notifyWorkers();
+
 		if (response)
 		{
 			if (!response->succeeded())
@@ -449,7 +641,7 @@ namespace Ogre {
 				if (req->getRetryCount())
 				{
 					addRequestWithRID(req->getID(), req->getChannel(), req->getType(), req->getData(), 
-						req->getRetryCount() - 1);
+						req->getRetryCount() - 1, req->getPriority());
 					// discard response (this also deletes request)
 					OGRE_DELETE response;
 					return;
@@ -458,7 +650,6 @@ namespace Ogre {
 			if (synchronous)
 			{
 				processResponse(response);
-				OGRE_DELETE response;
 			}
 			else
 			{
@@ -467,9 +658,16 @@ namespace Ogre {
 					// destroy response user data
 					response->abortRequest();
 				}
-				// Queue response
+				// Queue response, after any others with the same or a higher priority
 				OGRE_LOCK_MUTEX(mResponseMutex)
-				mResponseQueue.push_back(response);
+				int priority = response->getRequest()->getPriority();
+				ResponseQueue::iterator pos = mResponseQueue.end();
+				while (pos != mResponseQueue.begin() && 
+					(*(pos - 1))->getRequest()->getPriority() < priority)
+				{
+					--pos;
+				}
+				mResponseQueue.insert(pos, response);
 				// no need to wake thread, this is processed by the main thread
 			}
 
@@ -486,42 +684,107 @@ namespace Ogre {
 
 	}
 	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::setChannelResponseTimeLimit(uint16 channel, unsigned long ms)
+	{
+		if (ms)
+			mChannelResponseTimeLimits[channel] = ms;
+		else
+			mChannelResponseTimeLimits.erase(channel);
+	}
+	//---------------------------------------------------------------------
+	unsigned long DefaultWorkQueueBase::getChannelResponseTimeLimit(uint16 channel) const
+	{
+		ChannelTimeLimitMap::const_iterator i = mChannelResponseTimeLimits.find(channel);
+		return i == mChannelResponseTimeLimits.end() ? 0 : i->second;
+	}
+	//---------------------------------------------------------------------
 	void DefaultWorkQueueBase::processResponses() 
 	{
-		unsigned long msStart = Root::getSingleton().getTimer()->getMilliseconds();
-		unsigned long msCurrent = msStart;
+		Timer* timer = Root::getSingleton().getTimer();
+		unsigned long usStart = timer->getMicroseconds();
+		unsigned long usLimit = mResposeTimeLimitMS * 1000;
+
+		// Time used by each channel with a limit of its own; once over the 
+		// limit, a channel's responses are skipped until the next frame
+		typedef map<uint16, unsigned long>::type ChannelTimeMap;
+		ChannelTimeMap channelTimes;
+		for (ChannelTimeLimitMap::iterator i = mChannelResponseTimeLimits.begin(); 
+			i != mChannelResponseTimeLimits.end(); ++i)
+		{
+			channelTimes[i->first] = 0;
+		}
+		set<uint16>::type exhaustedChannels;
+
+		// Continue the responses handlers yielded on in previous frames first;
+		// any which yield again go back on the list for the next frame
+		YieldedResponseList resumed;
+		{
+			OGRE_LOCK_MUTEX(mResponseMutex)
+			resumed.swap(mYieldedResponses);
+		}
+		bool outOfTime = false;
+		for (YieldedResponseList::iterator i = resumed.begin(); i != resumed.end(); ++i)
+		{
+			uint16 channel = i->response->getRequest()->getChannel();
+			if (outOfTime || exhaustedChannels.find(channel) != exhaustedChannels.end())
+			{
+				OGRE_LOCK_MUTEX(mResponseMutex)
+				mYieldedResponses.push_back(*i);
+				continue;
+			}
+
+			unsigned long usResponseStart = timer->getMicroseconds();
+			continueResponse(*i);
+			unsigned long usCurrent = timer->getMicroseconds();
+
+			ChannelTimeMap::iterator t = channelTimes.find(channel);
+			if (t != channelTimes.end())
+			{
+				t->second += usCurrent - usResponseStart;
+				if (t->second >= mChannelResponseTimeLimits[channel] * 1000)
+					exhaustedChannels.insert(channel);
+			}
+			outOfTime = usLimit && usCurrent - usStart > usLimit;
+		}
 
 		// keep going until we run out of responses or out of time
-		while(true)
+		while(!outOfTime)
 		{
 			Response* response = 0;
 			{
 				OGRE_LOCK_MUTEX(mResponseMutex)
 
-				if (mResponseQueue.empty())
-					break; // exit loop
-				else
+				// Take the first response from a channel which still has time
+				ResponseQueue::iterator i = mResponseQueue.begin();
+				if (!exhaustedChannels.empty())
 				{
-					response = mResponseQueue.front();
-					mResponseQueue.pop_front();
+					while (i != mResponseQueue.end() && exhaustedChannels.find(
+						(*i)->getRequest()->getChannel()) != exhaustedChannels.end())
+					{
+						++i;
+					}
 				}
+				if (i == mResponseQueue.end())
+					break; // exit loop
+				response = *i;
+				mResponseQueue.erase(i);
 			}
 
-			if (response)
-			{
-				processResponse(response);
-
-				OGRE_DELETE response;
+			uint16 channel = response->getRequest()->getChannel();
+			unsigned long usResponseStart = timer->getMicroseconds();
+			processResponse(response);
+			unsigned long usCurrent = timer->getMicroseconds();
 
+			ChannelTimeMap::iterator t = channelTimes.find(channel);
+			if (t != channelTimes.end())
+			{
+				t->second += usCurrent - usResponseStart;
+				if (t->second >= mChannelResponseTimeLimits[channel] * 1000)
+					exhaustedChannels.insert(channel);
 			}
 
 			// time limit
-			if (mResposeTimeLimitMS)
-			{
-				msCurrent = Root::getSingleton().getTimer()->getMilliseconds();
-				if (msCurrent - msStart > mResposeTimeLimitMS)
-					break;
-			}
+			outOfTime = usLimit && usCurrent - usStart > usLimit;
 		}
 	}
 	//---------------------------------------------------------------------
@@ -589,6 +852,7 @@ namespace Ogre {
 		LogManager::getSingleton().stream(LML_TRIVIAL) << 
 			"DefaultWorkQueueBase('" << mName << "') - PROCESS_RESPONSE_START(" << dbgMsg.str();
 
+		ResponseHandlerList yielded;
 		ResponseHandlerListByChannel::iterator i = mResponseHandlers.find(r->getRequest()->getChannel());
 		if (i != mResponseHandlers.end())
 		{
@@ -597,13 +861,51 @@ namespace Ogre {
 			{
 				if ((*j)->canHandleResponse(r, this))
 				{
+					r->mYielded = false;
 					(*j)->handleResponse(r, this);
+					if (r->mYielded)
+						yielded.push_back(*j);
 				}
 			}
 		}
 		LogManager::getSingleton().stream(LML_TRIVIAL) << 
-			"DefaultWorkQueueBase('" << mName << "') - PROCESS_RESPONSE_END(" << dbgMsg.str();
+			"DefaultWorkQueueBase('" << mName << "') - PROCESS_RESPONSE_END(" << dbgMsg.str()
+			<< " yielded=" << !yielded.empty();
+
+		finishResponse(r, yielded);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::continueResponse(YieldedResponse& y)
+	{
+		Response* r = y.response;
+		ResponseHandlerList yielded;
+		ResponseHandlerListByChannel::iterator i = mResponseHandlers.find(r->getRequest()->getChannel());
+		for (ResponseHandlerList::iterator j = y.handlers.begin(); j != y.handlers.end(); ++j)
+		{
+			// The handler may have been removed since it yielded
+			if (i == mResponseHandlers.end() || 
+				std::find(i->second.begin(), i->second.end(), *j) == i->second.end())
+				continue;
+			r->mYielded = false;
+			(*j)->handleResponse(r, this);
+			if (r->mYielded)
+				yielded.push_back(*j);
+		}
+		finishResponse(r, yielded);
+	}
+	//---------------------------------------------------------------------
+	void DefaultWorkQueueBase::finishResponse(Response* r, const ResponseHandlerList& yielded)
+	{
+		if (yielded.empty())
+		{
+			OGRE_DELETE r;
+			return;
+		}
 
+		OGRE_LOCK_MUTEX(mResponseMutex)
+		mYieldedResponses.push_back(YieldedResponse());
+		mYieldedResponses.back().response = r;
+		mYieldedResponses.back().handlers = yielded;
 	}
 	//---------------------------------------------------------------------
 
@@ -157,7 +157,7 @@ namespace Ogre
 #if OGRE_THREAD_SUPPORT
 		// Lock; note that OGRE_THREAD_WAIT will free the lock
 		OGRE_LOCK_MUTEX_NAMED(mRequestMutex, queueLock);
-		if (mRequestQueue.empty())
+		if (!hasRunnableRequests())
 		{
 			// frees lock and suspends the thread
 			OGRE_THREAD_WAIT(mRequestCondition, mRequestMutex, queueLock);
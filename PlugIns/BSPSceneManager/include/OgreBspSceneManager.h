@@ -65,6 +65,13 @@ namespace Ogre {
     {
     protected:
 
+        /// Nodes notify the level of object movement while updating, so can't be updated in parallel
+        bool isParallelSceneGraphUpdateSupported() const { return false; }
+        /// BspSceneNode extends _update, which a batched update would bypass
+        bool isBatchedSceneGraphUpdateSupported() const { return false; }
+        /// Visible objects are found by walking the BSP tree, not the scene graph
+        bool isMultiCameraCullingSupported() const { return false; }
+
         // World geometry
         BspLevelPtr mLevel;
 
@@ -200,6 +200,10 @@ public:
 
 protected:
 
+	/// Octree nodes relocate themselves in the octree while updating, so can't be updated in parallel
+	bool isParallelSceneGraphUpdateSupported() const { return false; }
+	/// Visible objects are found by walking the octree, not the scene graph
+	bool isMultiCameraCullingSupported() const { return false; }
 
 	Octree::NodeList mVisible;
 
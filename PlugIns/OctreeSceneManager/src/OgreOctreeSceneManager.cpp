@@ -41,6 +41,7 @@ Enhancements 2003 - 2004 (C) The OGRE Team
 #include <OgreOctreeNode.h>
 #include <OgreOctreeCamera.h>
 #include <OgreRenderSystem.h>
+#include <OgreAxisAlignedBoxBatch.h>
 
 
 extern "C"
@@ -632,6 +633,23 @@ void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue,
 
         bool vis = true;
 
+        // if batched culling is enabled, cull all the nodes at this level
+        // in one go before walking them
+        bool batched = ( v == OctreeCamera::PARTIAL ) && mBatchedFrustumCulling;
+        if ( batched )
+        {
+            if ( !mCullBatch )
+                mCullBatch = OGRE_NEW AxisAlignedBoxBatch();
+
+            mCullBatch -> clear();
+            for ( ; it != octant -> mNodes.end(); ++it )
+                mCullBatch -> addBox( ( *it ) -> _getWorldAABB() );
+            camera -> isVisible( *mCullBatch );
+
+            it = octant -> mNodes.begin();
+        }
+        size_t index = 0;
+
         while ( it != octant -> mNodes.end() )
         {
             OctreeNode * sn = *it;
@@ -639,7 +657,9 @@ void OctreeSceneManager::walkOctree( OctreeCamera *camera, RenderQueue *queue,
             // if this octree is partially visible, manually cull all
             // scene nodes attached directly to this level.
 
-            if ( v == OctreeCamera::PARTIAL )
+            if ( batched )
+                vis = mCullBatch -> isVisible( index++ );
+            else if ( v == OctreeCamera::PARTIAL )
                 vis = camera -> isVisible( sn -> _getWorldAABB() );
 
             if ( vis )
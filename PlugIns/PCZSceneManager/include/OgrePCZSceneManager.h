@@ -333,6 +333,13 @@ namespace Ogre
 		virtual void prepareShadowTextures(Camera* cam, Viewport* vp, const LightList* lightList = 0);
 
 	protected:
+		/// PCZSceneNode extends _update itself, so nodes can't be split for parallel updates
+		bool isParallelSceneGraphUpdateSupported() const { return false; }
+		/// Likewise a batched update would bypass PCZSceneNode::_update
+		bool isBatchedSceneGraphUpdateSupported() const { return false; }
+		/// Visible objects are found by walking the zones through portals
+		bool isMultiCameraCullingSupported() const { return false; }
+
 		// type of default zone to be used
 		String mDefaultZoneTypeName;
 
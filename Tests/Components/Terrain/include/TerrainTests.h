@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "OgreRoot.h"
+#include "OgreTerrain.h"
 
 using namespace Ogre; 
 
@@ -37,13 +38,16 @@ class TerrainTests : public CppUnit::TestFixture
 	// CppUnit macros for setting up the test suite
 	CPPUNIT_TEST_SUITE( TerrainTests );
 	CPPUNIT_TEST(testCreate);
+	CPPUNIT_TEST(testTiledImport);
 	CPPUNIT_TEST_SUITE_END();
 
 	Root* mRoot;
 	SceneManager* mSceneMgr;
+	TerrainGlobalOptions* mTerrainOptions;
 
 public:
 	void setUp();
 	void tearDown();
 	void testCreate();
+	void testTiledImport();
 };
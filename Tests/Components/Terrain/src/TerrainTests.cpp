@@ -27,6 +27,8 @@ THE SOFTWARE.
 */
 #include "TerrainTests.h"
 #include "OgreTerrain.h"
+#include "OgreTerrainGroup.h"
+#include "OgreTiledImage.h"
 #include "OgreConfigFile.h"
 #include "OgreResourceGroupManager.h"
 
@@ -61,11 +63,13 @@ void TerrainTests::setUp()
 	}
 
 	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	mTerrainOptions = OGRE_NEW TerrainGlobalOptions();
 
 }
 
 void TerrainTests::tearDown()
 {
+	OGRE_DELETE mTerrainOptions;
 	OGRE_DELETE mRoot;
 }
 
@@ -94,3 +98,45 @@ void TerrainTests::testCreate()
 	OGRE_DELETE t;
 }
 
+void TerrainTests::testTiledImport()
+{
+	// One heightmap for 2x2 terrains, which share the vertices along their edges
+	const size_t size = 65, imageSize = size * 2 - 1;
+	MemoryDataStream* stream = OGRE_NEW MemoryDataStream(imageSize * imageSize * sizeof(float));
+	float* heights = reinterpret_cast<float*>(stream->getPtr());
+	for (size_t y = 0; y < imageSize; ++y)
+		for (size_t x = 0; x < imageSize; ++x)
+			heights[y * imageSize + x] = x * 0.5f + y * 2.0f;
+	TiledImage image(OGRE_NEW RawImageRegionReader(DataStreamPtr(stream), 
+		imageSize, imageSize, PF_FLOAT32_R), 32);
+
+	TerrainGroup group(mSceneMgr, Terrain::ALIGN_X_Z, size, 1000);
+	for (long y = 0; y < 2; ++y)
+		for (long x = 0; x < 2; ++x)
+			group.defineTerrain(x, y, &image, 0, 0);
+	CPPUNIT_ASSERT_THROW(group.defineTerrain(2, 0, &image, 0, 0), Exception);
+	CPPUNIT_ASSERT_THROW(group.defineTerrain(0, -1, &image, 0, 0), Exception);
+
+	for (long y = 0; y < 2; ++y)
+	{
+		for (long x = 0; x < 2; ++x)
+		{
+			Terrain* t = OGRE_NEW Terrain(mSceneMgr);
+			t->prepare(*group.getTerrainDefinition(x, y)->importData);
+			// Terrains go up from the bottom of the image
+			for (long py = 0; py < (long)size; ++py)
+			{
+				for (long px = 0; px < (long)size; ++px)
+				{
+					size_t column = x * (size - 1) + px;
+					size_t row = imageSize - 1 - (y * (size - 1) + py);
+					CPPUNIT_ASSERT_DOUBLES_EQUAL(heights[row * imageSize + column], 
+						t->getHeightAtPoint(px, py), 1e-4);
+				}
+			}
+			OGRE_DELETE t;
+		}
+	}
+	// The tiles along the shared edges came from the cache the second time
+	CPPUNIT_ASSERT_EQUAL(image.getNumTilesX() * image.getNumTilesY(), image.getNumTileReads());
+}
@@ -0,0 +1,82 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreImage.h"
+
+using namespace Ogre;
+
+class DXTConversionTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( DXTConversionTests );
+	CPPUNIT_TEST(testSingleColour);
+	CPPUNIT_TEST(testPremultipliedAlpha);
+	CPPUNIT_TEST(testGradientQuality);
+	CPPUNIT_TEST(testDXT1Transparency);
+	CPPUNIT_TEST(testOddSizes);
+	CPPUNIT_TEST(testSIMDMatchesGeneral);
+	CPPUNIT_TEST(testBandsMatchSerial);
+	CPPUNIT_TEST(testConvertImage);
+	CPPUNIT_TEST(testSaveDDS);
+	CPPUNIT_TEST(testCompressBenchmark);
+	CPPUNIT_TEST(testDecompressMatchesReference);
+	CPPUNIT_TEST(testDecompressSIMDMatchesGeneral);
+	CPPUNIT_TEST(testDecompressBandsMatchSerial);
+	CPPUNIT_TEST(testDecompressBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+
+	/// Fill a PF_BYTE_RGBA box with a smooth pattern, with some noise if asked
+	void fillPattern(const PixelBox& box, int noise, bool opaque);
+	/// Decode a compressed box to PF_BYTE_RGBA the way the hardware does
+	void referenceDecode(const PixelBox& src, const PixelBox& dst);
+	/// Fill a compressed box with random blocks
+	void fillRandomBlocks(const PixelBox& box);
+	/// Root mean square difference between two PF_BYTE_RGBA boxes, in a channel
+	double rmsError(const PixelBox& a, const PixelBox& b, size_t channel);
+public:
+	void setUp();
+	void tearDown();
+	void testSingleColour();
+	void testPremultipliedAlpha();
+	void testGradientQuality();
+	void testDXT1Transparency();
+	void testOddSizes();
+	void testSIMDMatchesGeneral();
+	void testBandsMatchSerial();
+	void testConvertImage();
+	void testSaveDDS();
+	void testCompressBenchmark();
+	void testDecompressMatchesReference();
+	void testDecompressSIMDMatchesGeneral();
+	void testDecompressBandsMatchSerial();
+	void testDecompressBenchmark();
+};
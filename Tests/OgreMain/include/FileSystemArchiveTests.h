@@ -45,6 +45,8 @@ class FileSystemArchiveTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testFindFileInfoRecursive);
     CPPUNIT_TEST(testFileRead);
     CPPUNIT_TEST(testReadInterleave);
+    CPPUNIT_TEST(testFileReadMapped);
+    CPPUNIT_TEST(testMappedMemoryShared);
 	CPPUNIT_TEST(testCreateAndRemoveFile);
     CPPUNIT_TEST_SUITE_END();
 protected:
@@ -63,6 +65,8 @@ public:
     void testFindFileInfoRecursive();
     void testFileRead();
     void testReadInterleave();
+    void testFileReadMapped();
+    void testMappedMemoryShared();
 	void testCreateAndRemoveFile();
 
 };
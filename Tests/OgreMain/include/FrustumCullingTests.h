@@ -0,0 +1,71 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreHardwareBufferManager.h"
+
+using namespace Ogre;
+
+class FrustumCullingTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( FrustumCullingTests );
+	CPPUNIT_TEST(testBatchMatchesSingleBoxes);
+	CPPUNIT_TEST(testBatchInfiniteFarPlane);
+	CPPUNIT_TEST(testBatchedSceneMatchesRecursive);
+	CPPUNIT_TEST(testBatchCullingBenchmark);
+	CPPUNIT_TEST(testMultiCameraMatchesSingle);
+	CPPUNIT_TEST(testMultiCameraBenchmark);
+	CPPUNIT_TEST(testMovedCameraCulledAgain);
+	CPPUNIT_TEST(testProjectionWithoutRenderSystem);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	/// Cameras need hardware buffers, but there is no render system
+	HardwareBufferManager* mBufMgr;
+	SceneManager* mSceneMgr;
+	Camera* mCamera;
+	vector<MovableObject*>::type mObjects;
+
+	void fillRandomBoxes(vector<AxisAlignedBox>::type& boxes, size_t count);
+	void checkBatchMatchesSingleBoxes(const vector<AxisAlignedBox>::type& boxes);
+	void createScene(size_t branches, size_t depth, size_t fanout);
+	void createCameras(vector<Camera*>::type& cameras, size_t count);
+public:
+	void setUp();
+	void tearDown();
+	void testBatchMatchesSingleBoxes();
+	void testBatchInfiniteFarPlane();
+	void testBatchedSceneMatchesRecursive();
+	void testBatchCullingBenchmark();
+	void testMultiCameraMatchesSingle();
+	void testMultiCameraBenchmark();
+	void testMovedCameraCulledAgain();
+	void testProjectionWithoutRenderSystem();
+};
@@ -0,0 +1,66 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreImage.h"
+
+using namespace Ogre;
+
+class ImageResampleTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( ImageResampleTests );
+	CPPUNIT_TEST(testBandsMatchSerial);
+	CPPUNIT_TEST(testConstantColour);
+	CPPUNIT_TEST(testBoxAverage);
+	CPPUNIT_TEST(testSameSize);
+	CPPUNIT_TEST(testGammaCorrect);
+	CPPUNIT_TEST(testGenerateMipmaps);
+	CPPUNIT_TEST(testGenerateMipmapsCubeAndVolume);
+	CPPUNIT_TEST(testScaleBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+
+	/// Scale with the shared task group held, so that it's done on this thread
+	void scaleSerially(const PixelBox& src, const PixelBox& dst, Image::Filter filter);
+	/// Get a pixel of a 2D box
+	const uchar* getPixel(const PixelBox& box, size_t x, size_t y);
+public:
+	void setUp();
+	void tearDown();
+	void testBandsMatchSerial();
+	void testConstantColour();
+	void testBoxAverage();
+	void testSameSize();
+	void testGammaCorrect();
+	void testGenerateMipmaps();
+	void testGenerateMipmapsCubeAndVolume();
+	void testScaleBenchmark();
+};
@@ -0,0 +1,70 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreOptimisedUtil.h"
+
+using namespace Ogre;
+
+class OptimisedUtilTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( OptimisedUtilTests );
+	CPPUNIT_TEST(testSkinningMatchesGeneral);
+	CPPUNIT_TEST(testMorphMatchesGeneral);
+	CPPUNIT_TEST(testConcatenateAffineMatricesMatchesGeneral);
+	CPPUNIT_TEST(testFaceNormalsMatchesGeneral);
+	CPPUNIT_TEST(testLightFacingMatchesGeneral);
+	CPPUNIT_TEST(testExtrudeVerticesMatchesGeneral);
+	CPPUNIT_TEST(testKernelBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	/// Implementations to check against the general one
+	vector<std::pair<String, OptimisedUtil*> >::type mImplementations;
+	/// SIMD aligned blend matrices
+	Matrix4* mMatrices;
+	size_t mNumMatrices;
+
+	void checkFloats(const String& what, const float* expected, const float* actual, size_t count);
+	void fillFloats(vector<float>::type& data, size_t count, float range);
+	void fillBlendData(vector<float>::type& weights, vector<uchar>::type& indices,
+		size_t numVertices, size_t numWeightsPerVertex);
+	void checkSkinning(OptimisedUtil* impl, const String& name, size_t numVertices,
+		size_t numWeightsPerVertex, bool normals, bool sharedBuffer);
+public:
+	void setUp();
+	void tearDown();
+	void testSkinningMatchesGeneral();
+	void testMorphMatchesGeneral();
+	void testConcatenateAffineMatricesMatchesGeneral();
+	void testFaceNormalsMatchesGeneral();
+	void testLightFacingMatchesGeneral();
+	void testExtrudeVerticesMatchesGeneral();
+	void testKernelBenchmark();
+};
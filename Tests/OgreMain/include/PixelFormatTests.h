@@ -38,6 +38,8 @@ class PixelFormatTests : public CppUnit::TestFixture
     CPPUNIT_TEST( testIntegerPackUnpack );
     CPPUNIT_TEST( testFloatPackUnpack );
     CPPUNIT_TEST( testBulkConversion );
+    CPPUNIT_TEST( testKernelConversion );
+    CPPUNIT_TEST( testConversionBenchmark );
     CPPUNIT_TEST_SUITE_END();
 public:
     void setUp();
@@ -46,10 +48,13 @@ public:
     void testIntegerPackUnpack();
     void testFloatPackUnpack();
     void testBulkConversion();
+    void testKernelConversion();
+    void testConversionBenchmark();
 
     // Utils
     void setupBoxes(PixelFormat srcFormat, PixelFormat dstFormat);
     void testCase(PixelFormat srcFormat, PixelFormat dstFormat);
+    void testSubVolumeCase(PixelFormat srcFormat, PixelFormat dstFormat);
 private:
     int size;
     uint8 *randomData;
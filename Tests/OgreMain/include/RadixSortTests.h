@@ -38,6 +38,11 @@ class RadixSortTests : public CppUnit::TestFixture
 	CPPUNIT_TEST(testIntList);
 	CPPUNIT_TEST(testUnsignedIntVector);
 	CPPUNIT_TEST(testIntVector);
+	CPPUNIT_TEST(testRadixSort11Float);
+	CPPUNIT_TEST(testRadixSort11IntList);
+	CPPUNIT_TEST(testRadixSort11UnsignedInt);
+	CPPUNIT_TEST(testRadixSort11CombinedKey);
+	CPPUNIT_TEST(testThroughputBenchmark);
 	CPPUNIT_TEST_SUITE_END();
 protected:
 public:
@@ -49,5 +54,10 @@ public:
 	void testIntList();
 	void testUnsignedIntVector();
 	void testIntVector();
+	void testRadixSort11Float();
+	void testRadixSort11IntList();
+	void testRadixSort11UnsignedInt();
+	void testRadixSort11CombinedKey();
+	void testThroughputBenchmark();
 
 };
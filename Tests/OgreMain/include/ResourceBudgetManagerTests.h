@@ -0,0 +1,96 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreResourceManager.h"
+
+using namespace Ogre;
+
+/** Resource with a fixed size which counts how often it is loaded. */
+class SizedResource : public Resource
+{
+public:
+	size_t mDataSize;
+	size_t mLoadCount;
+
+	SizedResource(ResourceManager* creator, const String& name, ResourceHandle handle,
+		const String& group, size_t dataSize)
+		: Resource(creator, name, handle, group), mDataSize(dataSize), mLoadCount(0) {}
+protected:
+	void loadImpl() { ++mLoadCount; }
+	void unloadImpl() {}
+	size_t calculateSize(void) const { return mDataSize; }
+};
+
+class SizedResourceManager : public ResourceManager
+{
+public:
+	SizedResourceManager(const String& type);
+	~SizedResourceManager();
+	/// Create a resource of the given size in the default group
+	ResourcePtr createSized(const String& name, size_t size);
+protected:
+	size_t mNextSize;
+	Resource* createImpl(const String& name, ResourceHandle handle, 
+		const String& group, bool isManual, ManualResourceLoader* loader, 
+		const NameValuePairList* createParams);
+};
+
+class ResourceBudgetManagerTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( ResourceBudgetManagerTests );
+	CPPUNIT_TEST(testLeastRecentlyUsedEvicted);
+	CPPUNIT_TEST(testReferencedNotEvicted);
+	CPPUNIT_TEST(testCurrentFrameNotEvicted);
+	CPPUNIT_TEST(testReloadOnTouch);
+	CPPUNIT_TEST(testBudgetAcrossManagers);
+	CPPUNIT_TEST(testManagerBudget);
+	CPPUNIT_TEST(testTouchFromThreads);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	SizedResourceManager* mMeshes;
+	SizedResourceManager* mTextures;
+	/// Memory used by the resources Root creates itself
+	size_t mOtherUsage;
+
+	void nextFrame();
+	SizedResource* get(SizedResourceManager* rm, const String& name);
+public:
+	void setUp();
+	void tearDown();
+	void testLeastRecentlyUsedEvicted();
+	void testReferencedNotEvicted();
+	void testCurrentFrameNotEvicted();
+	void testReloadOnTouch();
+	void testBudgetAcrossManagers();
+	void testManagerBudget();
+	void testTouchFromThreads();
+};
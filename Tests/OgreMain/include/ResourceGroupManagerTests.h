@@ -0,0 +1,174 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreArchive.h"
+#include "OgreArchiveFactory.h"
+#include "OgreResourceManager.h"
+#include "OgreScriptLoader.h"
+
+using namespace Ogre;
+
+/** Archive with generated file names, so that large numbers of resources
+	can be indexed without touching the disk. The archive name is 
+	"first:count", giving files "res<first>.dat" to "res<first+count-1>.dat",
+	optionally followed by ":prefix" to put them in a directory. The same 
+	files in a "sub/" directory are only found by exists(), as with paths 
+	within a non-recursive location.
+*/
+class GeneratedArchive : public Archive
+{
+protected:
+	bool mCaseSensitive;
+	StringVector mNames;
+	set<String>::type mNameSet;
+public:
+	/// Number of calls to exists(), to tell index lookups from searches
+	static size_t msExistsCalls;
+
+	GeneratedArchive(const String& name, const String& archType, bool caseSensitive);
+	bool isCaseSensitive(void) const { return mCaseSensitive; }
+	void load();
+	void unload();
+	DataStreamPtr open(const String& filename, bool readOnly = true) const;
+	StringVectorPtr list(bool recursive = true, bool dirs = false);
+	FileInfoListPtr listFileInfo(bool recursive = true, bool dirs = false);
+	StringVectorPtr find(const String& pattern, bool recursive = true, bool dirs = false);
+	FileInfoListPtr findFileInfo(const String& pattern, bool recursive = true, bool dirs = false);
+	bool exists(const String& filename);
+	time_t getModifiedTime(const String& filename) { return 0; }
+};
+
+class GeneratedArchiveFactory : public ArchiveFactory
+{
+protected:
+	String mType;
+	bool mCaseSensitive;
+public:
+	GeneratedArchiveFactory(const String& type, bool caseSensitive)
+		: mType(type), mCaseSensitive(caseSensitive) {}
+	const String& getType(void) const { return mType; }
+	Archive* createInstance(const String& name) 
+	{ 
+		return OGRE_NEW GeneratedArchive(name, mType, mCaseSensitive); 
+	}
+	void destroyInstance(Archive* arch) { OGRE_DELETE arch; }
+};
+
+/** Resource which reads its file when it is prepared, optionally doing 
+	some extra work to stand in for decoding it.
+*/
+class GeneratedResource : public Resource
+{
+public:
+	String mContents;
+	/// Iterations of simulated work done by each prepare
+	static size_t msWork;
+
+	GeneratedResource(ResourceManager* creator, const String& name, ResourceHandle handle,
+		const String& group, bool isManual = false, ManualResourceLoader* loader = 0)
+		: Resource(creator, name, handle, group, isManual, loader) {}
+protected:
+	void prepareImpl();
+	void unprepareImpl() { mContents.clear(); }
+	void loadImpl() {}
+	void unloadImpl() {}
+	size_t calculateSize(void) const { return mContents.size(); }
+};
+
+class GeneratedResourceManager : public ResourceManager
+{
+public:
+	GeneratedResourceManager();
+	~GeneratedResourceManager();
+protected:
+	Resource* createImpl(const String& name, ResourceHandle handle, 
+		const String& group, bool isManual, ManualResourceLoader* loader, 
+		const NameValuePairList* createParams);
+};
+
+/** Script loader which records the order scripts are parsed in, and 
+	whether they were prepared first.
+*/
+class RecordingScriptLoader : public ScriptLoader
+{
+public:
+	StringVector mPatterns;
+	/// Names of the parsed scripts, in order
+	StringVector mParsed;
+	/// Number of scripts parsed from the result of prepareScript
+	size_t mNumPrepared;
+	/// Name of a script which fails to prepare
+	String mFailName;
+	/// Iterations of simulated work done to parse each script
+	size_t mWork;
+	/// Combined result of the simulated work on every script parsed
+	uint32 mChecksum;
+
+	RecordingScriptLoader();
+	const StringVector& getScriptPatterns(void) const { return mPatterns; }
+	void parseScript(DataStreamPtr& stream, const String& groupName);
+	Any prepareScript(DataStreamPtr& stream, const String& groupName);
+	void parsePreparedScript(DataStreamPtr& stream, const String& groupName, 
+		const Any& prepared);
+	Real getLoadingOrder(void) const { return 1000; }
+};
+
+class ResourceGroupManagerTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( ResourceGroupManagerTests );
+	CPPUNIT_TEST(testOpenResource);
+	CPPUNIT_TEST(testCaseSensitiveArchive);
+	CPPUNIT_TEST(testFindGroupContainingResource);
+	CPPUNIT_TEST(testFindResourceFileInfo);
+	CPPUNIT_TEST(testResolveBenchmark);
+	CPPUNIT_TEST(testParallelScriptParsing);
+	CPPUNIT_TEST(testParallelPrepare);
+	CPPUNIT_TEST(testParallelInitialiseBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	GeneratedArchiveFactory* mFactory;
+	GeneratedArchiveFactory* mCaseSensitiveFactory;
+
+	String readResource(const String& name, const String& group);
+	void startWorkQueue();
+public:
+	void setUp();
+	void tearDown();
+	void testOpenResource();
+	void testCaseSensitiveArchive();
+	void testFindGroupContainingResource();
+	void testFindResourceFileInfo();
+	void testResolveBenchmark();
+	void testParallelScriptParsing();
+	void testParallelPrepare();
+	void testParallelInitialiseBenchmark();
+};
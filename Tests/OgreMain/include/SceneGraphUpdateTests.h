@@ -0,0 +1,64 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+using namespace Ogre;
+
+class SceneGraphUpdateTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( SceneGraphUpdateTests );
+	CPPUNIT_TEST(testParallelMatchesSerial);
+	CPPUNIT_TEST(testParallelPartialUpdate);
+	CPPUNIT_TEST(testParallelUpdateBenchmark);
+	CPPUNIT_TEST(testBatchedMatchesSerial);
+	CPPUNIT_TEST(testBatchedPartialUpdate);
+	CPPUNIT_TEST(testBatchedUpdateBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	DefaultWorkQueue* mQueue;
+	vector<MovableObject*>::type mObjects;
+	/// Number of nodes below the root in the last scene created, named n0, n1...
+	size_t mNodeCount;
+
+	SceneManager* createScene(const String& name, size_t branches, size_t depth, size_t fanout);
+	void moveNodes(SceneManager* sm, size_t stride);
+	void checkScenesEqual(SceneManager* a, SceneManager* b);
+public:
+	void setUp();
+	void tearDown();
+	void testParallelMatchesSerial();
+	void testParallelPartialUpdate();
+	void testParallelUpdateBenchmark();
+	void testBatchedMatchesSerial();
+	void testBatchedPartialUpdate();
+	void testBatchedUpdateBenchmark();
+};
@@ -0,0 +1,72 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreScriptCompiler.h"
+
+using namespace Ogre;
+
+/** Listener which records the concrete nodes each script compiles from. */
+class RecordingCompilerListener : public ScriptCompilerListener
+{
+public:
+	/// The nodes of the last script compiled, one line per node
+	String mDump;
+	void preConversion(ScriptCompiler *compiler, ConcreteNodeListPtr nodes);
+	static void dumpNodes(const ConcreteNodeList& nodes, const ConcreteNode* parent, 
+		int depth, String& dump);
+};
+
+class ScriptCompilerTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( ScriptCompilerTests );
+	CPPUNIT_TEST(testCacheMatchesParse);
+	CPPUNIT_TEST(testCacheInvalidatedByChange);
+	CPPUNIT_TEST(testCacheKeepsGroupsApart);
+	CPPUNIT_TEST(testCorruptCacheIgnored);
+	CPPUNIT_TEST(testCacheBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	RecordingCompilerListener mListener;
+
+	/// Prepare and compile a script held in a string, returning the node dump
+	String compileScript(const String& name, const String& text, 
+		const String& group = "General");
+	void removeCacheFiles();
+public:
+	void setUp();
+	void tearDown();
+	void testCacheMatchesParse();
+	void testCacheInvalidatedByChange();
+	void testCacheKeepsGroupsApart();
+	void testCorruptCacheIgnored();
+	void testCacheBenchmark();
+};
@@ -0,0 +1,66 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreMesh.h"
+#include "OgreAnimation.h"
+
+using namespace Ogre;
+
+class SkeletalAnimationTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( SkeletalAnimationTests );
+	CPPUNIT_TEST(testParallelMatchesSerial);
+	CPPUNIT_TEST(testSharedSkeletonInstance);
+	CPPUNIT_TEST(testParallelSkeletonBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	DefaultWorkQueue* mQueue;
+	/// Entities need hardware buffers, but there is no render system
+	HardwareBufferManager* mBufMgr;
+	SceneManager* mSceneMgr;
+	MeshPtr mMesh;
+
+	/// Create a skeleton of chains of bones, with a looping animation, and a mesh using it
+	void createSkeletalMesh(size_t numChains, size_t chainLength, Animation::InterpolationMode im);
+	/// Create entities with the animation enabled, each at a different time position
+	void createEntities(const String& prefix, size_t count, vector<Entity*>::type& entities);
+	/// Evaluate the skeletons of entities as the scene manager does when parallel
+	void updateParallel(vector<Entity*>::type& entities);
+	void checkBoneMatricesEqual(Entity* a, Entity* b);
+public:
+	void setUp();
+	void tearDown();
+	void testParallelMatchesSerial();
+	void testSharedSkeletonInstance();
+	void testParallelSkeletonBenchmark();
+};
@@ -0,0 +1,65 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreMatrix4.h"
+
+using namespace Ogre;
+
+class SoftwareAnimationBatchTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( SoftwareAnimationBatchTests );
+	CPPUNIT_TEST(testSkinningMatchesImmediate);
+	CPPUNIT_TEST(testMorphAndPoseMatchImmediate);
+	CPPUNIT_TEST(testReadOnlyLockConflict);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	DefaultWorkQueue* mQueue;
+	/// Vertex buffers without a render system
+	HardwareBufferManager* mBufMgr;
+	ParallelTaskGroup* mTaskGroup;
+	vector<VertexData*>::type mVertexData;
+	Matrix4 mMatrices[4];
+
+	/// Create positions and normals in one buffer, optionally with blend data in another
+	VertexData* createVertexData(size_t numVertices, bool normals, bool blendData);
+	/// Create a buffer of VET_FLOAT3 positions
+	HardwareVertexBufferSharedPtr createPositionBuffer(size_t numVertices, Real offset);
+	void checkBuffersEqual(const HardwareVertexBufferSharedPtr& a, 
+		const HardwareVertexBufferSharedPtr& b);
+public:
+	void setUp();
+	void tearDown();
+	void testSkinningMatchesImmediate();
+	void testMorphAndPoseMatchImmediate();
+	void testReadOnlyLockConflict();
+};
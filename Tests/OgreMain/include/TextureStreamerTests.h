@@ -0,0 +1,118 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreTexture.h"
+#include "OgreTextureManager.h"
+#include "OgreHardwarePixelBuffer.h"
+
+using namespace Ogre;
+
+/// Pixel buffer kept in system memory, as there is no render system
+class StubPixelBuffer : public HardwarePixelBuffer
+{
+protected:
+	vector<uchar>::type mData;
+	PixelBox lockImpl(const Image::Box lockBox, LockOptions options);
+	void unlockImpl(void) {}
+public:
+	StubPixelBuffer(size_t width, size_t height, PixelFormat format);
+	void blitFromMemory(const PixelBox& src, const Image::Box& dstBox);
+	void blitToMemory(const Image::Box& srcBox, const PixelBox& dst);
+	void readData(size_t offset, size_t length, void* pDest);
+	void writeData(size_t offset, size_t length, const void* pSource, bool discardWholeBuffer = false);
+};
+
+/// Texture made of StubPixelBuffers
+class StubTexture : public Texture
+{
+protected:
+	vector<HardwarePixelBufferSharedPtr>::type mBuffers;
+	void loadImpl(void) {}
+	void createInternalResourcesImpl(void);
+	void freeInternalResourcesImpl(void);
+public:
+	StubTexture(ResourceManager* creator, const String& name, ResourceHandle handle,
+		const String& group, bool isManual, ManualResourceLoader* loader);
+	~StubTexture();
+	HardwarePixelBufferSharedPtr getBuffer(size_t face, size_t mipmap);
+};
+
+/// Manager of StubTextures
+class StubTextureManager : public TextureManager
+{
+protected:
+	Resource* createImpl(const String& name, ResourceHandle handle, 
+		const String& group, bool isManual, ManualResourceLoader* loader, 
+		const NameValuePairList* createParams);
+public:
+	StubTextureManager();
+	~StubTextureManager();
+	PixelFormat getNativeFormat(TextureType ttype, PixelFormat format, int usage) { return format; }
+	bool isHardwareFilteringSupported(TextureType ttype, PixelFormat format, int usage,
+		bool preciseFormatOnly = false) { return true; }
+};
+
+class TextureStreamerTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( TextureStreamerTests );
+	CPPUNIT_TEST(testDecodeMipmaps);
+	CPPUNIT_TEST(testDecodeUncompressedMipmaps);
+	CPPUNIT_TEST(testLoadTail);
+	CPPUNIT_TEST(testStreamOnDemand);
+	CPPUNIT_TEST(testScreenSizePriority);
+	CPPUNIT_TEST(testMemoryBudget);
+	CPPUNIT_TEST(testReload);
+	CPPUNIT_TEST(testShutdownTwice);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	StubTextureManager* mTextureManager;
+	StringVector mFileNames;
+
+	/** Write an uncompressed DDS with a full mipmap chain, each level filled with its index + 1, 
+		optionally giving the pitch of the top level in the header */
+	void writeDDS(const String& name, size_t width, size_t height, bool withPitch = false);
+	/// Run the requests queued so far and handle their responses
+	void processStreamRequests(size_t maxRequests = ~(size_t)0);
+	/// First texel of a mipmap level of a texture
+	uint32 getTexel(const TexturePtr& tex, size_t mip);
+public:
+	void setUp();
+	void tearDown();
+	void testDecodeMipmaps();
+	void testDecodeUncompressedMipmaps();
+	void testLoadTail();
+	void testStreamOnDemand();
+	void testScreenSizePriority();
+	void testMemoryBudget();
+	void testReload();
+	void testShutdownTwice();
+};
@@ -0,0 +1,64 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreTiledImage.h"
+
+using namespace Ogre;
+
+class TiledImageTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( TiledImageTests );
+	CPPUNIT_TEST(testRawRegions);
+	CPPUNIT_TEST(testRawOffsetAndPitch);
+	CPPUNIT_TEST(testTileCache);
+	CPPUNIT_TEST(testLockedTilesKept);
+	CPPUNIT_TEST(testDDSRegions);
+	CPPUNIT_TEST(testMemoryReader);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+
+	/// The value of a pixel of the test heightmap
+	uint16 heightAt(size_t x, size_t y);
+	/// A raw PF_L16 heightmap as a stream
+	DataStreamPtr createRawHeightmap(size_t width, size_t height);
+	/// Save an image as DDS, and open the file again
+	DataStreamPtr saveAndOpenDDS(Image& image, const String& fileName);
+public:
+	void setUp();
+	void tearDown();
+	void testRawRegions();
+	void testRawOffsetAndPitch();
+	void testTileCache();
+	void testLockedTilesKept();
+	void testDDSRegions();
+	void testMemoryReader();
+};
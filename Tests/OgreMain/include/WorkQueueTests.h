@@ -0,0 +1,110 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+#include "OgreWorkQueue.h"
+
+using namespace Ogre;
+
+/** Handles requests and responses, recording what it was given. */
+class RecordingRequestHandler : public WorkQueue::RequestHandler, 
+	public WorkQueue::ResponseHandler
+{
+public:
+	/// The data of each request handled, in order
+	vector<int>::type mHandled;
+	/// The data of the request of each response handled, in order
+	vector<int>::type mResponded;
+	/// The data of each aborted request given to the handler, in order
+	vector<int>::type mAbortedHandled;
+	/// The data of the request of each aborted response given to the handler, in order
+	vector<int>::type mAbortedResponded;
+	/// Number of responses which have been completely handled
+	size_t mNumResponses;
+	/// Number of calls to handleResponse for requests which weren't aborted
+	size_t mResponseCalls;
+	/// Time to spend on each call to handleResponse, in microseconds
+	unsigned long mResponseSpinUS;
+	/// Number of calls needed to handle each response, yielding after all but the last
+	int mResponseSlices;
+	/// Number of calls made so far for each response
+	map<WorkQueue::RequestID, int>::type mSlicesDone;
+	/// Time to spend on each request, in milliseconds
+	unsigned long mSleepMS;
+	/// Number of requests being handled right now
+	size_t mActive;
+	/// Largest number of requests handled at the same time
+	size_t mMaxActive;
+	OGRE_MUTEX(mMutex)
+
+	RecordingRequestHandler();
+	/// Take aborted requests and responses too, as a handler which owns data must
+	bool canHandleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ) { return true; }
+	bool canHandleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ) { return true; }
+	WorkQueue::Response* handleRequest(const WorkQueue::Request* req, const WorkQueue* srcQ);
+	void handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ);
+};
+
+class WorkQueueTests : public CppUnit::TestFixture
+{
+	// CppUnit macros for setting up the test suite
+	CPPUNIT_TEST_SUITE( WorkQueueTests );
+	CPPUNIT_TEST(testPriorityOrder);
+	CPPUNIT_TEST(testAbortWaitingRequest);
+	CPPUNIT_TEST(testStatistics);
+	CPPUNIT_TEST(testChannelWorkerLimit);
+	CPPUNIT_TEST(testResponsePriority);
+	CPPUNIT_TEST(testResponseYield);
+	CPPUNIT_TEST(testChannelResponseTimeLimit);
+	CPPUNIT_TEST(testResponseBudgetBenchmark);
+	CPPUNIT_TEST_SUITE_END();
+protected:
+	Root* mRoot;
+	DefaultWorkQueueBase* mQueue;
+	RecordingRequestHandler mHandler;
+	uint16 mChannel;
+	uint16 mOtherChannel;
+	uint16 mHeavyChannel;
+
+	/// Process requests on this thread until there are none left
+	void processAllRequests();
+	/// Wait for the worker threads to process a number of requests on a channel
+	void waitForProcessed(uint16 channel, size_t count);
+public:
+	void setUp();
+	void tearDown();
+	void testPriorityOrder();
+	void testAbortWaitingRequest();
+	void testStatistics();
+	void testChannelWorkerLimit();
+	void testResponsePriority();
+	void testResponseYield();
+	void testChannelResponseTimeLimit();
+	void testResponseBudgetBenchmark();
+};
@@ -0,0 +1,740 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "DXTConversionTests.h"
+#include "OgreRoot.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "OgreDataStream.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+#include <fstream>
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( DXTConversionTests );
+
+void DXTConversionTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	DefaultWorkQueue* queue = OGRE_NEW DefaultWorkQueue("DXTConversionTests");
+	queue->setWorkersCanAccessRenderSystem(false);
+	queue->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(queue);
+	queue->startup();
+
+	// Split into bands even on a machine with one core
+	ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+	group->setMaxConcurrency(4);
+	mRoot->_releaseTaskGroup(group);
+}
+void DXTConversionTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+void DXTConversionTests::fillPattern(const PixelBox& box, int noise, bool opaque)
+{
+	size_t width = box.getWidth(), height = box.getHeight();
+	for (size_t z = 0; z < box.getDepth(); ++z)
+	{
+		for (size_t y = 0; y < height; ++y)
+		{
+			uchar* p = static_cast<uchar*>(box.data) + (z * box.slicePitch + y * box.rowPitch) * 4;
+			for (size_t x = 0; x < width; ++x, p += 4)
+			{
+				int values[4];
+				values[0] = static_cast<int>(x * 255 / std::max((size_t)1, width - 1));
+				values[1] = static_cast<int>(y * 255 / std::max((size_t)1, height - 1));
+				values[2] = (values[0] + 255 - values[1]) / 2;
+				values[3] = opaque ? 255 : 255 - (values[0] + values[1]) / 2;
+				for (size_t c = 0; c < 4; ++c)
+				{
+					if (noise && (c < 3 || !opaque))
+						values[c] += rand() % (2 * noise + 1) - noise;
+					p[c] = static_cast<uchar>(std::min(255, std::max(0, values[c])));
+				}
+			}
+		}
+	}
+}
+
+static void unpack565(uint16 colour, int* rgba)
+{
+	int r = (colour >> 11) & 0x1F, g = (colour >> 5) & 0x3F, b = colour & 0x1F;
+	rgba[0] = (r << 3) | (r >> 2);
+	rgba[1] = (g << 2) | (g >> 4);
+	rgba[2] = (b << 3) | (b >> 2);
+	rgba[3] = 255;
+}
+
+void DXTConversionTests::referenceDecode(const PixelBox& src, const PixelBox& dst)
+{
+	size_t width = dst.getWidth(), height = dst.getHeight();
+	size_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+	size_t blockSize = src.format == PF_DXT1 ? 8 : 16;
+	const uchar* block = static_cast<const uchar*>(src.data);
+	for (size_t z = 0; z < dst.getDepth(); ++z)
+	{
+		for (size_t by = 0; by < blocksY; ++by)
+		{
+			for (size_t bx = 0; bx < blocksX; ++bx, block += blockSize)
+			{
+				const uchar* colour = block + blockSize - 8;
+				uint16 c0 = static_cast<uint16>(colour[0] | (colour[1] << 8));
+				uint16 c1 = static_cast<uint16>(colour[2] | (colour[3] << 8));
+				int palette[4][4];
+				unpack565(c0, palette[0]);
+				unpack565(c1, palette[1]);
+				for (size_t c = 0; c < 3; ++c)
+				{
+					if (src.format == PF_DXT1 && c0 <= c1)
+					{
+						palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+						palette[3][c] = 0;
+					}
+					else
+					{
+						palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+						palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+					}
+				}
+				palette[2][3] = 255;
+				palette[3][3] = (src.format == PF_DXT1 && c0 <= c1) ? 0 : 255;
+
+				int alphas[8];
+				uint64 alphaBits = 0;
+				if (src.format == PF_DXT4 || src.format == PF_DXT5)
+				{
+					alphas[0] = block[0];
+					alphas[1] = block[1];
+					if (alphas[0] > alphas[1])
+					{
+						for (int k = 1; k < 7; ++k)
+							alphas[k + 1] = ((7 - k) * alphas[0] + k * alphas[1] + 3) / 7;
+					}
+					else
+					{
+						for (int k = 1; k < 5; ++k)
+							alphas[k + 1] = ((5 - k) * alphas[0] + k * alphas[1] + 2) / 5;
+						alphas[6] = 0;
+						alphas[7] = 255;
+					}
+					for (size_t b = 0; b < 6; ++b)
+						alphaBits |= static_cast<uint64>(block[2 + b]) << (b * 8);
+				}
+
+				for (size_t i = 0; i < 16; ++i)
+				{
+					size_t x = bx * 4 + i % 4, y = by * 4 + i / 4;
+					if (x >= width || y >= height)
+						continue;
+					uchar* p = static_cast<uchar*>(dst.data) + (z * dst.slicePitch + y * dst.rowPitch + x) * 4;
+					int index = (colour[4 + i / 4] >> ((i % 4) * 2)) & 3;
+					for (size_t c = 0; c < 4; ++c)
+						p[c] = static_cast<uchar>(palette[index][c]);
+					if (src.format == PF_DXT2 || src.format == PF_DXT3)
+						p[3] = static_cast<uchar>(((block[i / 2] >> ((i % 2) * 4)) & 0xF) * 17);
+					else if (src.format == PF_DXT4 || src.format == PF_DXT5)
+						p[3] = static_cast<uchar>(alphas[(alphaBits >> (i * 3)) & 7]);
+				}
+			}
+		}
+	}
+}
+
+void DXTConversionTests::fillRandomBlocks(const PixelBox& box)
+{
+	uchar* data = static_cast<uchar*>(box.data);
+	for (size_t i = 0; i < box.getConsecutiveSize(); ++i)
+		data[i] = static_cast<uchar>(rand());
+}
+
+double DXTConversionTests::rmsError(const PixelBox& a, const PixelBox& b, size_t channel)
+{
+	double sum = 0;
+	size_t count = 0;
+	for (size_t z = 0; z < a.getDepth(); ++z)
+	{
+		for (size_t y = 0; y < a.getHeight(); ++y)
+		{
+			for (size_t x = 0; x < a.getWidth(); ++x, ++count)
+			{
+				int va = static_cast<const uchar*>(a.data)[(z * a.slicePitch + y * a.rowPitch + x) * 4 + channel];
+				int vb = static_cast<const uchar*>(b.data)[(z * b.slicePitch + y * b.rowPitch + x) * 4 + channel];
+				sum += (va - vb) * (va - vb);
+			}
+		}
+	}
+	return std::sqrt(sum / count);
+}
+
+void DXTConversionTests::testSingleColour()
+{
+	const uchar colour[4] = { 10, 100, 200, 200 };
+	PixelBox src(8, 8, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	for (size_t i = 0; i < srcData.size(); ++i)
+		srcData[i] = colour[i % 4];
+	src.data = &srcData[0];
+
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT3, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox compressed(8, 8, 1, formats[f]);
+		vector<uchar>::type compressedData(compressed.getConsecutiveSize());
+		compressed.data = &compressedData[0];
+		PixelUtil::bulkPixelConversion(src, compressed);
+
+		PixelBox decoded(8, 8, 1, PF_BYTE_RGBA);
+		vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+		decoded.data = &decodedData[0];
+		referenceDecode(compressed, decoded);
+		for (size_t i = 0; i < decodedData.size(); i += 4)
+		{
+			// 5 bits of red and blue, 6 of green
+			CPPUNIT_ASSERT(std::abs(decodedData[i] - colour[0]) <= 4);
+			CPPUNIT_ASSERT(std::abs(decodedData[i + 1] - colour[1]) <= 2);
+			CPPUNIT_ASSERT(std::abs(decodedData[i + 2] - colour[2]) <= 4);
+		}
+		switch (formats[f])
+		{
+		case PF_DXT1:
+			CPPUNIT_ASSERT_EQUAL(255, (int)decodedData[3]);
+			break;
+		case PF_DXT3:
+			CPPUNIT_ASSERT(std::abs(decodedData[3] - colour[3]) <= 8);
+			break;
+		default:
+			CPPUNIT_ASSERT_EQUAL((int)colour[3], (int)decodedData[3]);
+			break;
+		}
+	}
+}
+
+void DXTConversionTests::testPremultipliedAlpha()
+{
+	const uchar colour[4] = { 200, 100, 40, 128 };
+	PixelBox src(4, 4, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	for (size_t i = 0; i < srcData.size(); ++i)
+		srcData[i] = colour[i % 4];
+	src.data = &srcData[0];
+
+	// DXT2 and DXT4 store the colour multiplied by alpha, DXT3 and DXT5 as it is
+	const PixelFormat formats[] = { PF_DXT2, PF_DXT3, PF_DXT4, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox compressed(4, 4, 1, formats[f]);
+		vector<uchar>::type compressedData(compressed.getConsecutiveSize());
+		compressed.data = &compressedData[0];
+		PixelUtil::bulkPixelConversion(src, compressed);
+
+		PixelBox decoded(4, 4, 1, PF_BYTE_RGBA);
+		vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+		decoded.data = &decodedData[0];
+		referenceDecode(compressed, decoded);
+
+		bool premultiplied = formats[f] == PF_DXT2 || formats[f] == PF_DXT4;
+		for (size_t i = 0; i < decodedData.size(); i += 4)
+		{
+			for (size_t c = 0; c < 3; ++c)
+			{
+				int expected = premultiplied ? (colour[c] * colour[3] + 127) / 255 : colour[c];
+				CPPUNIT_ASSERT(std::abs(decodedData[i + c] - expected) <= 4);
+			}
+			CPPUNIT_ASSERT(std::abs(decodedData[i + 3] - colour[3]) <= 8);
+		}
+	}
+}
+
+void DXTConversionTests::testGradientQuality()
+{
+	const size_t size = 256;
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT3, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox src(size, size, 1, PF_BYTE_RGBA);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		src.data = &srcData[0];
+		fillPattern(src, 0, formats[f] == PF_DXT1);
+
+		PixelBox compressed(size, size, 1, formats[f]);
+		vector<uchar>::type compressedData(compressed.getConsecutiveSize());
+		compressed.data = &compressedData[0];
+		PixelUtil::bulkPixelConversion(src, compressed);
+
+		PixelBox decoded(size, size, 1, PF_BYTE_RGBA);
+		vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+		decoded.data = &decodedData[0];
+		referenceDecode(compressed, decoded);
+
+		for (size_t c = 0; c < 3; ++c)
+			CPPUNIT_ASSERT(rmsError(src, decoded, c) < 3.0);
+		double alphaLimit = formats[f] == PF_DXT5 ? 1.5 : formats[f] == PF_DXT3 ? 5.0 : 0.0;
+		CPPUNIT_ASSERT(rmsError(src, decoded, 3) <= alphaLimit);
+	}
+}
+
+void DXTConversionTests::testDXT1Transparency()
+{
+	// Left half transparent, right half opaque
+	PixelBox src(8, 8, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	for (size_t i = 0; i < 64; ++i)
+	{
+		uchar* p = &srcData[i * 4];
+		p[0] = 250; p[1] = static_cast<uchar>(i * 4); p[2] = 20;
+		p[3] = (i % 8) < 4 ? 10 : 255;
+	}
+	src.data = &srcData[0];
+
+	PixelBox compressed(8, 8, 1, PF_DXT1);
+	vector<uchar>::type compressedData(compressed.getConsecutiveSize());
+	compressed.data = &compressedData[0];
+	PixelUtil::bulkPixelConversion(src, compressed);
+
+	PixelBox decoded(8, 8, 1, PF_BYTE_RGBA);
+	vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+	decoded.data = &decodedData[0];
+	referenceDecode(compressed, decoded);
+	for (size_t i = 0; i < 64; ++i)
+	{
+		const uchar* p = &decodedData[i * 4];
+		if ((i % 8) < 4)
+		{
+			CPPUNIT_ASSERT_EQUAL(0, (int)p[3]);
+		}
+		else
+		{
+			CPPUNIT_ASSERT_EQUAL(255, (int)p[3]);
+			CPPUNIT_ASSERT(std::abs(p[0] - 250) <= 4);
+			CPPUNIT_ASSERT(std::abs(p[1] - (int)(i * 4)) <= 12);
+		}
+	}
+}
+
+void DXTConversionTests::testOddSizes()
+{
+	const size_t sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 5 }, { 13, 7 }, { 17, 1 } };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		size_t width = sizes[s][0], height = sizes[s][1];
+		// A gradient along x only, which every block can follow
+		PixelBox src(width, height, 1, PF_BYTE_RGBA);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		for (size_t y = 0; y < height; ++y)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				uchar* p = &srcData[(y * width + x) * 4];
+				p[0] = static_cast<uchar>(x * 15);
+				p[1] = 100;
+				p[2] = static_cast<uchar>(250 - x * 15);
+				p[3] = static_cast<uchar>(x * 10);
+			}
+		}
+		src.data = &srcData[0];
+
+		PixelBox compressed(width, height, 1, PF_DXT5);
+		size_t compressedSize = compressed.getConsecutiveSize();
+		CPPUNIT_ASSERT_EQUAL(((width + 3) / 4) * ((height + 3) / 4) * 16, compressedSize);
+		// With a guard after the end, which must be left alone
+		vector<uchar>::type compressedData(compressedSize + 16, 0xCD);
+		compressed.data = &compressedData[0];
+		PixelUtil::bulkPixelConversion(src, compressed);
+		for (size_t i = compressedSize; i < compressedData.size(); ++i)
+			CPPUNIT_ASSERT_EQUAL(0xCD, (int)compressedData[i]);
+
+		PixelBox decoded(width, height, 1, PF_BYTE_RGBA);
+		vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+		decoded.data = &decodedData[0];
+		referenceDecode(compressed, decoded);
+		for (size_t i = 0; i < decodedData.size(); ++i)
+			CPPUNIT_ASSERT(std::abs(decodedData[i] - srcData[i]) <= 8);
+	}
+}
+
+void DXTConversionTests::testSIMDMatchesGeneral()
+{
+	PixelUtil::ConversionKernels kernels = PixelUtil::_getConversionKernels();
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT2, PF_DXT3, PF_DXT4, PF_DXT5 };
+	for (int noise = 0; noise <= 128; noise += 32)
+	{
+		PixelBox src(64, 40, 1, PF_BYTE_RGBA);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		src.data = &srcData[0];
+		fillPattern(src, noise, false);
+		for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+		{
+			PixelBox general(64, 40, 1, formats[f]), simd(64, 40, 1, formats[f]);
+			vector<uchar>::type generalData(general.getConsecutiveSize(), 0);
+			vector<uchar>::type simdData(simd.getConsecutiveSize(), 0xCD);
+			general.data = &generalData[0];
+			simd.data = &simdData[0];
+
+			PixelUtil::_setConversionKernels(PixelUtil::CK_NONE);
+			PixelUtil::bulkPixelConversion(src, general);
+			PixelUtil::_setConversionKernels(kernels);
+			PixelUtil::bulkPixelConversion(src, simd);
+			CPPUNIT_ASSERT(generalData == simdData);
+		}
+	}
+}
+
+void DXTConversionTests::testBandsMatchSerial()
+{
+	const size_t width = 512, height = 300;
+	PixelBox src(width, height, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	src.data = &srcData[0];
+	fillPattern(src, 40, false);
+
+	PixelBox serial(width, height, 1, PF_DXT5), parallel(width, height, 1, PF_DXT5);
+	vector<uchar>::type serialData(serial.getConsecutiveSize(), 0);
+	vector<uchar>::type parallelData(parallel.getConsecutiveSize(), 0xCD);
+	serial.data = &serialData[0];
+	parallel.data = &parallelData[0];
+
+	// With the shared group held it's all done on this thread
+	ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+	CPPUNIT_ASSERT(group);
+	PixelUtil::bulkPixelConversion(src, serial);
+	mRoot->_releaseTaskGroup(group);
+
+	PixelUtil::bulkPixelConversion(src, parallel);
+	CPPUNIT_ASSERT(serialData == parallelData);
+}
+
+void DXTConversionTests::testConvertImage()
+{
+	const size_t width = 64, height = 32;
+	uchar* data = OGRE_ALLOC_T(uchar, width * height * 4, MEMCATEGORY_GENERAL);
+	PixelBox box(width, height, 1, PF_BYTE_RGBA, data);
+	fillPattern(box, 0, false);
+	Image image;
+	image.loadDynamicImage(data, width, height, 1, PF_BYTE_RGBA, true);
+	image.generateMipmaps();
+	Image original;
+	original.loadDynamicImage(const_cast<uchar*>(image.getData()), width, height, 1, 
+		PF_BYTE_RGBA, false, 1, image.getNumMipmaps());
+
+	Image compressed;
+	uchar* copy = OGRE_ALLOC_T(uchar, image.getSize(), MEMCATEGORY_GENERAL);
+	memcpy(copy, image.getData(), image.getSize());
+	compressed.loadDynamicImage(copy, width, height, 1, PF_BYTE_RGBA, true, 1, image.getNumMipmaps());
+	compressed.convert(PF_DXT5);
+
+	CPPUNIT_ASSERT_EQUAL(PF_DXT5, compressed.getFormat());
+	CPPUNIT_ASSERT(compressed.hasFlag(IF_COMPRESSED));
+	CPPUNIT_ASSERT_EQUAL(image.getNumMipmaps(), compressed.getNumMipmaps());
+	CPPUNIT_ASSERT_EQUAL(Image::calculateSize(image.getNumMipmaps(), 1, width, height, 1, PF_DXT5),
+		compressed.getSize());
+
+	for (size_t mip = 0; mip <= image.getNumMipmaps(); ++mip)
+	{
+		PixelBox level = original.getPixelBox(0, mip);
+		PixelBox decoded(level.getWidth(), level.getHeight(), 1, PF_BYTE_RGBA);
+		vector<uchar>::type decodedData(decoded.getConsecutiveSize());
+		decoded.data = &decodedData[0];
+		referenceDecode(compressed.getPixelBox(0, mip), decoded);
+		// The gradient is twice as steep across a block at each level
+		for (size_t c = 0; c < 4; ++c)
+			CPPUNIT_ASSERT(rmsError(level, decoded, c) < 6.0 * (1 << mip));
+	}
+
+	// Converting to the same format leaves it alone
+	const uchar* before = compressed.getData();
+	compressed.convert(PF_DXT5);
+	CPPUNIT_ASSERT(before == compressed.getData());
+}
+
+void DXTConversionTests::testSaveDDS()
+{
+	const size_t size = 64;
+	const String fileName = "DXTConversionTests.dds";
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT3, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		uchar* data = OGRE_ALLOC_T(uchar, size * size * 4, MEMCATEGORY_GENERAL);
+		PixelBox box(size, size, 1, PF_BYTE_RGBA, data);
+		fillPattern(box, 20, formats[f] == PF_DXT1);
+		Image image;
+		image.loadDynamicImage(data, size, size, 1, PF_BYTE_RGBA, true);
+		image.generateMipmaps();
+		image.convert(formats[f]);
+		image.save(fileName);
+
+		// There's no render system, so the codec decompresses it
+		std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+			fileName.c_str(), std::ios::in | std::ios::binary);
+		CPPUNIT_ASSERT(file->is_open());
+		DataStreamPtr stream(OGRE_NEW FileStreamDataStream(fileName, file));
+		Image loaded;
+		loaded.load(stream, "dds");
+		stream->close();
+		std::remove(fileName.c_str());
+
+		CPPUNIT_ASSERT_EQUAL(size, loaded.getWidth());
+		CPPUNIT_ASSERT_EQUAL(size, loaded.getHeight());
+		CPPUNIT_ASSERT_EQUAL(image.getNumMipmaps(), loaded.getNumMipmaps());
+		CPPUNIT_ASSERT(!PixelUtil::isCompressed(loaded.getFormat()));
+
+		for (size_t mip = 0; mip <= image.getNumMipmaps(); ++mip)
+		{
+			PixelBox expected(size >> mip, size >> mip, 1, PF_BYTE_RGBA);
+			vector<uchar>::type expectedData(expected.getConsecutiveSize());
+			expected.data = &expectedData[0];
+			referenceDecode(image.getPixelBox(0, mip), expected);
+
+			PixelBox actual(size >> mip, size >> mip, 1, PF_BYTE_RGBA);
+			vector<uchar>::type actualData(actual.getConsecutiveSize());
+			actual.data = &actualData[0];
+			PixelUtil::bulkPixelConversion(loaded.getPixelBox(0, mip), actual);
+
+			CPPUNIT_ASSERT(actualData == expectedData);
+		}
+	}
+}
+
+void DXTConversionTests::testCompressBenchmark()
+{
+	const size_t size = 2048;
+	PixelBox src(size, size, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	src.data = &srcData[0];
+	fillPattern(src, 24, false);
+
+	PixelUtil::ConversionKernels kernels = PixelUtil::_getConversionKernels();
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox dst(size, size, 1, formats[f]);
+		vector<uchar>::type dstData(dst.getConsecutiveSize());
+		dst.data = &dstData[0];
+		unsigned long times[3];
+
+		ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+		Timer timer;
+		PixelUtil::_setConversionKernels(PixelUtil::CK_NONE);
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[0] = timer.getMilliseconds();
+		PixelUtil::_setConversionKernels(kernels);
+		timer.reset();
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[1] = timer.getMilliseconds();
+		mRoot->_releaseTaskGroup(group);
+
+		timer.reset();
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[2] = timer.getMilliseconds();
+
+		LogManager::getSingleton().stream() << "DXTConversionTests: " << size << "x" << size 
+			<< " PF_BYTE_RGBA to " << PixelUtil::getFormatName(formats[f]) 
+			<< ": general " << times[0] << "ms, SIMD " << times[1] 
+			<< "ms, SIMD in parallel " << times[2] << "ms";
+	}
+}
+
+void DXTConversionTests::testDecompressMatchesReference()
+{
+	const size_t sizes[][3] = { { 1, 1, 1 }, { 3, 5, 1 }, { 16, 8, 1 }, { 13, 7, 2 } };
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT2, PF_DXT3, PF_DXT4, PF_DXT5 };
+	// Ones decoded straight to, and ones converted to from PF_BYTE_RGBA
+	const PixelFormat dstFormats[] = { PF_BYTE_RGBA, PF_BYTE_BGRA, PF_A8R8G8B8, 
+		PF_X8R8G8B8, PF_BYTE_RGB, PF_R5G6B5, PF_FLOAT32_RGBA };
+	for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+	{
+		size_t width = sizes[s][0], height = sizes[s][1], depth = sizes[s][2];
+		for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+		{
+			PixelBox src(width, height, depth, formats[f]);
+			vector<uchar>::type srcData(src.getConsecutiveSize());
+			src.data = &srcData[0];
+			fillRandomBlocks(src);
+
+			PixelBox reference(width, height, depth, PF_BYTE_RGBA);
+			vector<uchar>::type referenceData(reference.getConsecutiveSize());
+			reference.data = &referenceData[0];
+			referenceDecode(src, reference);
+
+			for (size_t d = 0; d < sizeof(dstFormats) / sizeof(dstFormats[0]); ++d)
+			{
+				PixelBox expected(width, height, depth, dstFormats[d]);
+				vector<uchar>::type expectedData(expected.getConsecutiveSize());
+				expected.data = &expectedData[0];
+				PixelUtil::bulkPixelConversion(reference, expected);
+
+				// With a guard after the end, which must be left alone
+				PixelBox actual(width, height, depth, dstFormats[d]);
+				size_t actualSize = actual.getConsecutiveSize();
+				vector<uchar>::type actualData(actualSize + 16, 0xCD);
+				actual.data = &actualData[0];
+				PixelUtil::bulkPixelConversion(src, actual);
+				for (size_t i = actualSize; i < actualData.size(); ++i)
+					CPPUNIT_ASSERT_EQUAL(0xCD, (int)actualData[i]);
+				actualData.resize(actualSize);
+				CPPUNIT_ASSERT(actualData == expectedData);
+			}
+		}
+	}
+
+	// Into a box within a larger image
+	PixelBox src(8, 8, 1, PF_DXT5);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	src.data = &srcData[0];
+	fillRandomBlocks(src);
+	PixelBox reference(8, 8, 1, PF_BYTE_RGBA);
+	vector<uchar>::type referenceData(reference.getConsecutiveSize());
+	reference.data = &referenceData[0];
+	referenceDecode(src, reference);
+
+	vector<uint32>::type imageData(16 * 16, 0xCDCDCDCD);
+	PixelBox image(16, 16, 1, PF_BYTE_RGBA, &imageData[0]);
+	PixelBox part = image.getSubVolume(Box(5, 3, 13, 11));
+	PixelUtil::bulkPixelConversion(src, part);
+	for (size_t y = 0; y < 16; ++y)
+	{
+		for (size_t x = 0; x < 16; ++x)
+		{
+			const uchar* p = reinterpret_cast<const uchar*>(&imageData[y * 16 + x]);
+			if (x >= 5 && x < 13 && y >= 3 && y < 11)
+				CPPUNIT_ASSERT(memcmp(p, &referenceData[((y - 3) * 8 + x - 5) * 4], 4) == 0);
+			else
+				CPPUNIT_ASSERT_EQUAL(0xCDCDCDCD, imageData[y * 16 + x]);
+		}
+	}
+}
+
+void DXTConversionTests::testDecompressSIMDMatchesGeneral()
+{
+	PixelUtil::ConversionKernels kernels = PixelUtil::_getConversionKernels();
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT2, PF_DXT3, PF_DXT4, PF_DXT5 };
+	const PixelFormat dstFormats[] = { PF_A8B8G8R8, PF_X8B8G8R8, PF_BYTE_RGB };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox src(30, 22, 1, formats[f]);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		src.data = &srcData[0];
+		fillRandomBlocks(src);
+		for (size_t d = 0; d < sizeof(dstFormats) / sizeof(dstFormats[0]); ++d)
+		{
+			PixelBox general(30, 22, 1, dstFormats[d]), simd(30, 22, 1, dstFormats[d]);
+			vector<uchar>::type generalData(general.getConsecutiveSize(), 0);
+			vector<uchar>::type simdData(simd.getConsecutiveSize(), 0xCD);
+			general.data = &generalData[0];
+			simd.data = &simdData[0];
+
+			PixelUtil::_setConversionKernels(PixelUtil::CK_NONE);
+			PixelUtil::bulkPixelConversion(src, general);
+			PixelUtil::_setConversionKernels(kernels);
+			PixelUtil::bulkPixelConversion(src, simd);
+			CPPUNIT_ASSERT(generalData == simdData);
+		}
+	}
+}
+
+void DXTConversionTests::testDecompressBandsMatchSerial()
+{
+	const size_t width = 512, height = 300;
+	PixelBox src(width, height, 1, PF_DXT5);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	src.data = &srcData[0];
+	fillRandomBlocks(src);
+
+	PixelBox serial(width, height, 1, PF_A8R8G8B8), parallel(width, height, 1, PF_A8R8G8B8);
+	vector<uchar>::type serialData(serial.getConsecutiveSize(), 0);
+	vector<uchar>::type parallelData(parallel.getConsecutiveSize(), 0xCD);
+	serial.data = &serialData[0];
+	parallel.data = &parallelData[0];
+
+	// With the shared group held it's all done on this thread
+	ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+	CPPUNIT_ASSERT(group);
+	PixelUtil::bulkPixelConversion(src, serial);
+	mRoot->_releaseTaskGroup(group);
+
+	PixelUtil::bulkPixelConversion(src, parallel);
+	CPPUNIT_ASSERT(serialData == parallelData);
+}
+
+void DXTConversionTests::testDecompressBenchmark()
+{
+	const size_t size = 2048;
+	PixelBox rgba(size, size, 1, PF_BYTE_RGBA);
+	vector<uchar>::type rgbaData(rgba.getConsecutiveSize());
+	rgba.data = &rgbaData[0];
+	fillPattern(rgba, 24, false);
+
+	PixelUtil::ConversionKernels kernels = PixelUtil::_getConversionKernels();
+	const PixelFormat formats[] = { PF_DXT1, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		PixelBox src(size, size, 1, formats[f]);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		src.data = &srcData[0];
+		PixelUtil::bulkPixelConversion(rgba, src);
+
+		PixelBox dst(size, size, 1, PF_A8R8G8B8);
+		vector<uchar>::type dstData(dst.getConsecutiveSize());
+		dst.data = &dstData[0];
+		unsigned long times[4];
+
+		// Per pixel through ColourValue, as the DDS codec used to
+		Timer timer;
+		referenceDecode(src, rgba);
+		uchar* in = &rgbaData[0];
+		uchar* out = &dstData[0];
+		for (size_t i = 0; i < size * size; ++i, in += 4, out += 4)
+		{
+			ColourValue colour;
+			PixelUtil::unpackColour(&colour, PF_BYTE_RGBA, in);
+			PixelUtil::packColour(colour, PF_A8R8G8B8, out);
+		}
+		times[0] = timer.getMilliseconds();
+
+		ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+		timer.reset();
+		PixelUtil::_setConversionKernels(PixelUtil::CK_NONE);
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[1] = timer.getMilliseconds();
+		PixelUtil::_setConversionKernels(kernels);
+		timer.reset();
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[2] = timer.getMilliseconds();
+		mRoot->_releaseTaskGroup(group);
+
+		timer.reset();
+		PixelUtil::bulkPixelConversion(src, dst);
+		times[3] = timer.getMilliseconds();
+
+		LogManager::getSingleton().stream() << "DXTConversionTests: " << size << "x" << size 
+			<< " " << PixelUtil::getFormatName(formats[f]) << " to PF_A8R8G8B8: through ColourValue "
+			<< times[0] << "ms, general " << times[1] << "ms, SIMD " << times[2] 
+			<< "ms, SIMD in parallel " << times[3] << "ms";
+	}
+}
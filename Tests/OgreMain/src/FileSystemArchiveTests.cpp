@@ -240,6 +240,59 @@ void FileSystemArchiveTests::testFileRead()
     CPPUNIT_ASSERT_EQUAL(StringUtil::BLANK, stream->getLine()); // blank at end of file
     CPPUNIT_ASSERT(stream->eof());
 
+}
+void FileSystemArchiveTests::testFileReadMapped()
+{
+    FileSystemArchive::setUseMappedFiles(true);
+    FileSystemArchive arch(testPath, "FileSystem");
+    arch.load();
+
+    DataStreamPtr stream = arch.open("rootfile.txt");
+    FileSystemArchive::setUseMappedFiles(false);
+    CPPUNIT_ASSERT(stream->getSharedMemory() != 0);
+    CPPUNIT_ASSERT_EQUAL(String("this is line 1 in file 1"), stream->getLine());
+    CPPUNIT_ASSERT_EQUAL(String("this is line 2 in file 1"), stream->getLine());
+    CPPUNIT_ASSERT_EQUAL(String("this is line 3 in file 1"), stream->getLine());
+    CPPUNIT_ASSERT_EQUAL(String("this is line 4 in file 1"), stream->getLine());
+    CPPUNIT_ASSERT_EQUAL(String("this is line 5 in file 1"), stream->getLine());
+    CPPUNIT_ASSERT_EQUAL(StringUtil::BLANK, stream->getLine()); // blank at end of file
+    CPPUNIT_ASSERT(stream->eof());
+
+    // Writeable access still goes through a file stream
+    DataStreamPtr rwStream = arch.open("rootfile.txt", false);
+    CPPUNIT_ASSERT(rwStream->getSharedMemory() == 0);
+
+}
+void FileSystemArchiveTests::testMappedMemoryShared()
+{
+    FileSystemArchive::setUseMappedFiles(true);
+    FileSystemArchive arch(testPath, "FileSystem");
+    arch.load();
+
+    DataStreamPtr stream = arch.open("rootfile.txt");
+    FileSystemArchive::setUseMappedFiles(false);
+    const uchar* mapped = stream->getSharedMemory();
+    size_t size = stream->size();
+    CPPUNIT_ASSERT_EQUAL(String("this is line 1 in file 1"), stream->getLine());
+    size_t offset = stream->tell();
+
+    // A read-only memory stream borrows the remainder of the mapping
+    MemoryDataStream* borrowed = OGRE_NEW MemoryDataStream(stream, true, true);
+    DataStreamPtr borrowedPtr(borrowed);
+    CPPUNIT_ASSERT(stream->eof());
+    CPPUNIT_ASSERT(borrowed->getPtr() == mapped + offset);
+    CPPUNIT_ASSERT_EQUAL(size - offset, borrowed->size());
+
+    // The mapping must outlive the stream it was opened through
+    stream.setNull();
+    CPPUNIT_ASSERT_EQUAL(String("this is line 2 in file 1"), borrowedPtr->getLine());
+
+    // A writeable copy never aliases the mapping
+    MemoryDataStream copy(borrowedPtr, true, false);
+    CPPUNIT_ASSERT(copy.getPtr() != mapped + offset);
+    CPPUNIT_ASSERT(copy.getSharedMemory() == 0);
+    CPPUNIT_ASSERT_EQUAL(String("this is line 3 in file 1"), copy.getLine());
+
 }
 void FileSystemArchiveTests::testReadInterleave()
 {
@@ -0,0 +1,446 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "FrustumCullingTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMovableObject.h"
+#include "OgreRenderQueue.h"
+#include "OgreAxisAlignedBoxBatch.h"
+#include "OgreShadowCameraSetup.h"
+#include "OgreTimer.h"
+#include "OgreLogManager.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( FrustumCullingTests );
+
+/// Object with fixed local bounds which records when it is queued
+class QueueRecordingObject : public MovableObject
+{
+protected:
+	AxisAlignedBox mBox;
+	static String msType;
+public:
+	/// Objects queued, with the queue they were added to
+	typedef vector<std::pair<RenderQueue*, MovableObject*> >::type ObjectList;
+	static ObjectList msQueued;
+
+	QueueRecordingObject(const String& name, const AxisAlignedBox& box)
+		: MovableObject(name), mBox(box) {}
+	const String& getMovableType(void) const { return msType; }
+	const AxisAlignedBox& getBoundingBox(void) const { return mBox; }
+	Real getBoundingRadius(void) const { return mBox.getHalfSize().length(); }
+	void _updateRenderQueue(RenderQueue* queue) { msQueued.push_back(std::make_pair(queue, this)); }
+	void visitRenderables(Renderable::Visitor* visitor, bool debugRenderables = false) {}
+};
+String QueueRecordingObject::msType = "QueueRecordingObject";
+QueueRecordingObject::ObjectList QueueRecordingObject::msQueued;
+
+/// Gives access to the pending results of SceneManager::cullCameras
+class CullCamerasSceneManager : public SceneManager
+{
+protected:
+	static String msTypeName;
+public:
+	CullCamerasSceneManager() : SceneManager("CullCamerasSceneManager") {}
+	const String& getTypeName(void) const { return msTypeName; }
+	using SceneManager::CameraPtrList;
+	using SceneManager::cullCameras;
+};
+String CullCamerasSceneManager::msTypeName = "CullCamerasSceneManager";
+
+void FrustumCullingTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mBufMgr = OGRE_NEW DefaultHardwareBufferManager();
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	mCamera = mSceneMgr->createCamera("cam");
+	mCamera->setPosition(0, 0, 0);
+	mCamera->lookAt(0.3, 0.1, -1);
+	mCamera->setNearClipDistance(1);
+	mCamera->setFarClipDistance(500);
+	mCamera->setAspectRatio(1.6);
+	// Same seed every time so that failures can be reproduced
+	srand(12345);
+}
+void FrustumCullingTests::tearDown()
+{
+	for (vector<MovableObject*>::type::iterator i = mObjects.begin(); i != mObjects.end(); ++i)
+		OGRE_DELETE *i;
+	mObjects.clear();
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mBufMgr;
+	QueueRecordingObject::msQueued.clear();
+}
+
+void FrustumCullingTests::fillRandomBoxes(vector<AxisAlignedBox>::type& boxes, size_t count)
+{
+	boxes.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		// Some null and infinite boxes in amongst the rest, and an odd count
+		// so that the tail of the batch is exercised
+		if (i % 97 == 13)
+		{
+			boxes.push_back(AxisAlignedBox::BOX_NULL);
+			continue;
+		}
+		if (i % 101 == 7)
+		{
+			boxes.push_back(AxisAlignedBox::BOX_INFINITE);
+			continue;
+		}
+		Vector3 centre(Math::RangeRandom(-600, 600), Math::RangeRandom(-600, 600), Math::RangeRandom(-600, 600));
+		Vector3 half(Math::RangeRandom(0, 50), Math::RangeRandom(0, 50), Math::RangeRandom(0, 50));
+		boxes.push_back(AxisAlignedBox(centre - half, centre + half));
+	}
+}
+
+void FrustumCullingTests::checkBatchMatchesSingleBoxes(const vector<AxisAlignedBox>::type& boxes)
+{
+	AxisAlignedBoxBatch batch;
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(i, batch.addBox(boxes[i]));
+	}
+	mCamera->isVisible(batch);
+
+	size_t numVisible = 0;
+	for (size_t i = 0; i < boxes.size(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(mCamera->isVisible(boxes[i]), batch.isVisible(i));
+		if (batch.isVisible(i))
+			++numVisible;
+	}
+	// Make sure the test means something
+	CPPUNIT_ASSERT(numVisible > 0 && numVisible < boxes.size());
+}
+
+void FrustumCullingTests::testBatchMatchesSingleBoxes()
+{
+	vector<AxisAlignedBox>::type boxes;
+	fillRandomBoxes(boxes, 10001);
+	checkBatchMatchesSingleBoxes(boxes);
+
+	// Reusing the batch with fewer boxes must not use stale results
+	AxisAlignedBoxBatch batch;
+	for (size_t i = 0; i < boxes.size(); ++i)
+		batch.addBox(boxes[i]);
+	mCamera->isVisible(batch);
+	batch.clear();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, batch.getNumBoxes());
+	for (size_t i = 0; i < 3; ++i)
+		batch.addBox(boxes[i]);
+	mCamera->isVisible(batch);
+	for (size_t i = 0; i < 3; ++i)
+		CPPUNIT_ASSERT_EQUAL(mCamera->isVisible(boxes[i]), batch.isVisible(i));
+}
+
+void FrustumCullingTests::testBatchInfiniteFarPlane()
+{
+	mCamera->setFarClipDistance(0);
+	vector<AxisAlignedBox>::type boxes;
+	fillRandomBoxes(boxes, 2049);
+	checkBatchMatchesSingleBoxes(boxes);
+}
+
+void FrustumCullingTests::createScene(size_t branches, size_t depth, size_t fanout)
+{
+	vector<SceneNode*>::type level, nextLevel;
+	level.push_back(mSceneMgr->getRootSceneNode());
+	size_t count = 0;
+	for (size_t d = 0; d < depth; ++d)
+	{
+		nextLevel.clear();
+		size_t children = d ? fanout : branches;
+		for (size_t i = 0; i < level.size(); ++i)
+		{
+			for (size_t c = 0; c < children; ++c)
+			{
+				SceneNode* n = level[i]->createChildSceneNode(
+					Vector3(Math::RangeRandom(-200, 200), Math::RangeRandom(-200, 200), Math::RangeRandom(-200, 200)));
+				MovableObject* obj = OGRE_NEW QueueRecordingObject("o" + StringConverter::toString(count),
+					AxisAlignedBox(-Vector3::UNIT_SCALE * 5, Vector3::UNIT_SCALE * 5));
+				n->attachObject(obj);
+				mObjects.push_back(obj);
+				nextLevel.push_back(n);
+				++count;
+			}
+		}
+		level.swap(nextLevel);
+	}
+	mSceneMgr->_updateSceneGraph(mCamera);
+}
+
+void FrustumCullingTests::testBatchedSceneMatchesRecursive()
+{
+	createScene(5, 4, 4);
+
+	VisibleObjectsBoundsInfo recursiveBounds, batchedBounds;
+	recursiveBounds.reset();
+	batchedBounds.reset();
+
+	mSceneMgr->setBatchedFrustumCulling(false);
+	mSceneMgr->_findVisibleObjects(mCamera, &recursiveBounds, false);
+	QueueRecordingObject::ObjectList recursive;
+	recursive.swap(QueueRecordingObject::msQueued);
+
+	mSceneMgr->setBatchedFrustumCulling(true);
+	mSceneMgr->_findVisibleObjects(mCamera, &batchedBounds, false);
+	QueueRecordingObject::ObjectList batched;
+	batched.swap(QueueRecordingObject::msQueued);
+
+	// Same objects, in the same order
+	CPPUNIT_ASSERT(!recursive.empty() && recursive.size() < mObjects.size());
+	CPPUNIT_ASSERT(recursive == batched);
+	CPPUNIT_ASSERT(recursiveBounds.aabb == batchedBounds.aabb);
+	CPPUNIT_ASSERT_EQUAL(recursiveBounds.minDistance, batchedBounds.minDistance);
+	CPPUNIT_ASSERT_EQUAL(recursiveBounds.maxDistance, batchedBounds.maxDistance);
+}
+
+void FrustumCullingTests::testBatchCullingBenchmark()
+{
+	const int iterations = 20;
+	Timer timer;
+
+	vector<AxisAlignedBox>::type boxes;
+	fillRandomBoxes(boxes, 100000);
+
+	timer.reset();
+	size_t numVisible = 0;
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (size_t b = 0; b < boxes.size(); ++b)
+			numVisible += mCamera->isVisible(boxes[b]);
+	}
+	unsigned long singleUs = timer.getMicroseconds();
+
+	AxisAlignedBoxBatch batch;
+	for (size_t b = 0; b < boxes.size(); ++b)
+		batch.addBox(boxes[b]);
+	timer.reset();
+	for (int i = 0; i < iterations; ++i)
+	{
+		mCamera->isVisible(batch);
+	}
+	unsigned long batchUs = timer.getMicroseconds();
+
+	LogManager::getSingleton().stream() << "FrustumCullingTests: " << boxes.size()
+		<< " boxes: " << (singleUs / iterations) << " us one at a time, " 
+		<< (batchUs / iterations) << " us batched";
+
+	// ~20k nodes
+	createScene(20, 3, 31);
+	VisibleObjectsBoundsInfo bounds;
+	for (int batched = 0; batched < 2; ++batched)
+	{
+		mSceneMgr->setBatchedFrustumCulling(batched != 0);
+		timer.reset();
+		for (int i = 0; i < iterations; ++i)
+		{
+			bounds.reset();
+			mSceneMgr->_findVisibleObjects(mCamera, &bounds, false);
+			QueueRecordingObject::msQueued.clear();
+		}
+		unsigned long us = timer.getMicroseconds();
+
+		LogManager::getSingleton().stream() << "FrustumCullingTests: scene "
+			<< (batched ? "batched" : "recursive") << ": " << (us / iterations) << " us per cull";
+	}
+}
+
+void FrustumCullingTests::createCameras(vector<Camera*>::type& cameras, size_t count)
+{
+	cameras.clear();
+	for (size_t i = 0; i < count; ++i)
+	{
+		Camera* cam = mSceneMgr->createCamera("multi" + StringConverter::toString(i));
+		cam->setPosition(Math::RangeRandom(-100, 100), 0, Math::RangeRandom(-100, 100));
+		cam->setDirection(Math::RangeRandom(-1, 1), Math::RangeRandom(-0.2, 0.2), Math::RangeRandom(-1, 1));
+		cam->setNearClipDistance(1);
+		// One with an infinite far plane
+		cam->setFarClipDistance(i == 1 ? 0 : 300);
+		cameras.push_back(cam);
+	}
+}
+
+void FrustumCullingTests::testMultiCameraMatchesSingle()
+{
+	createScene(5, 4, 4);
+	vector<Camera*>::type cameras;
+	createCameras(cameras, 4);
+
+	// One at a time, the usual way
+	vector<QueueRecordingObject::ObjectList>::type single(cameras.size());
+	vector<VisibleObjectsBoundsInfo>::type singleBounds(cameras.size());
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		singleBounds[c].reset();
+		mSceneMgr->_findVisibleObjects(cameras[c], &singleBounds[c], c == 2);
+		single[c].swap(QueueRecordingObject::msQueued);
+	}
+
+	// All at once, into separate queues
+	vector<RenderQueue*>::type queues;
+	vector<VisibleObjectsBoundsInfo>::type multiBounds(cameras.size());
+	SceneManager::CameraCullTargetList targets;
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		queues.push_back(OGRE_NEW RenderQueue());
+		multiBounds[c].reset();
+		SceneManager::CameraCullTarget target = { cameras[c], queues[c], &multiBounds[c], c == 2 };
+		targets.push_back(target);
+	}
+	mSceneMgr->_findVisibleObjectsMultiCamera(targets);
+
+	size_t total = 0;
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		QueueRecordingObject::ObjectList multi;
+		for (size_t i = 0; i < QueueRecordingObject::msQueued.size(); ++i)
+		{
+			if (QueueRecordingObject::msQueued[i].first == queues[c])
+				multi.push_back(std::make_pair(mSceneMgr->getRenderQueue(), 
+					QueueRecordingObject::msQueued[i].second));
+		}
+		// Same objects, in the same order
+		CPPUNIT_ASSERT(multi == single[c]);
+		CPPUNIT_ASSERT(multiBounds[c].aabb == singleBounds[c].aabb);
+		CPPUNIT_ASSERT_EQUAL(singleBounds[c].minDistance, multiBounds[c].minDistance);
+		CPPUNIT_ASSERT_EQUAL(singleBounds[c].maxDistance, multiBounds[c].maxDistance);
+		total += multi.size();
+	}
+	CPPUNIT_ASSERT_EQUAL(QueueRecordingObject::msQueued.size(), total);
+	CPPUNIT_ASSERT(total > 0);
+
+	for (size_t c = 0; c < queues.size(); ++c)
+		OGRE_DELETE queues[c];
+}
+
+void FrustumCullingTests::testMultiCameraBenchmark()
+{
+	// ~20k nodes, a main camera plus 3 shadow splits and a couple of reflections
+	createScene(20, 3, 31);
+	vector<Camera*>::type cameras;
+	createCameras(cameras, 6);
+	const int iterations = 20;
+	Timer timer;
+
+	vector<VisibleObjectsBoundsInfo>::type bounds(cameras.size());
+	timer.reset();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (size_t c = 0; c < cameras.size(); ++c)
+		{
+			bounds[c].reset();
+			mSceneMgr->_findVisibleObjects(cameras[c], &bounds[c], false);
+		}
+		QueueRecordingObject::msQueued.clear();
+	}
+	unsigned long singleUs = timer.getMicroseconds();
+
+	SceneManager::CameraCullTargetList targets;
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		SceneManager::CameraCullTarget target = { cameras[c], mSceneMgr->getRenderQueue(), &bounds[c], false };
+		targets.push_back(target);
+	}
+	timer.reset();
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (size_t c = 0; c < cameras.size(); ++c)
+			bounds[c].reset();
+		mSceneMgr->_findVisibleObjectsMultiCamera(targets);
+		QueueRecordingObject::msQueued.clear();
+	}
+	unsigned long multiUs = timer.getMicroseconds();
+
+	LogManager::getSingleton().stream() << "FrustumCullingTests: " << cameras.size()
+		<< " cameras: " << (singleUs / iterations) << " us one at a time, " 
+		<< (multiUs / iterations) << " us together";
+}
+
+void FrustumCullingTests::testMovedCameraCulledAgain()
+{
+	// Culled results kept for a camera must not be used once it has moved,
+	// since shadow texture listeners can change a camera after culling
+	CullCamerasSceneManager* sceneMgr = OGRE_NEW CullCamerasSceneManager();
+	SceneManager* savedSceneMgr = mSceneMgr;
+	mSceneMgr = sceneMgr;
+	createScene(5, 4, 4);
+	vector<Camera*>::type cameras;
+	createCameras(cameras, 2);
+	mSceneMgr = savedSceneMgr;
+
+	sceneMgr->cullCameras(cameras);
+	cameras[0]->yaw(Degree(90));
+	cameras[0]->move(Vector3(40, 0, -20));
+
+	VisibleObjectsBoundsInfo bounds;
+	bounds.reset();
+	sceneMgr->_findVisibleObjects(cameras[0], &bounds, false);
+	QueueRecordingObject::ObjectList pending;
+	pending.swap(QueueRecordingObject::msQueued);
+	// The other camera has not moved, so its results are still used
+	sceneMgr->_findVisibleObjects(cameras[1], &bounds, false);
+	QueueRecordingObject::ObjectList unmoved;
+	unmoved.swap(QueueRecordingObject::msQueued);
+
+	// Same as culling them again now
+	sceneMgr->_findVisibleObjects(cameras[0], &bounds, false);
+	CPPUNIT_ASSERT(pending == QueueRecordingObject::msQueued);
+	QueueRecordingObject::msQueued.clear();
+	sceneMgr->_findVisibleObjects(cameras[1], &bounds, false);
+	CPPUNIT_ASSERT(unmoved == QueueRecordingObject::msQueued);
+	CPPUNIT_ASSERT(!pending.empty());
+
+	OGRE_DELETE sceneMgr;
+}
+
+void FrustumCullingTests::testProjectionWithoutRenderSystem()
+{
+	CPPUNIT_ASSERT(!mRoot->getRenderSystem());
+
+	// The render system forms fall back to the generic matrix
+	CPPUNIT_ASSERT(mCamera->getProjectionMatrixRS() == mCamera->getProjectionMatrix());
+	CPPUNIT_ASSERT(mCamera->getProjectionMatrixWithRSDepth() == mCamera->getProjectionMatrix());
+
+	// and follow it when the projection changes
+	Matrix4 before = mCamera->getProjectionMatrix();
+	mCamera->setFOVy(Degree(30));
+	CPPUNIT_ASSERT(mCamera->getProjectionMatrix() != before);
+	CPPUNIT_ASSERT(mCamera->getProjectionMatrixRS() == mCamera->getProjectionMatrix());
+	mCamera->setProjectionType(PT_ORTHOGRAPHIC);
+	mCamera->setOrthoWindow(100, 60);
+	CPPUNIT_ASSERT(mCamera->getProjectionMatrixWithRSDepth() == mCamera->getProjectionMatrix());
+
+	// Culling only needs the generic matrix
+	CPPUNIT_ASSERT(mCamera->isVisible(AxisAlignedBox(Vector3(-1, -1, -20), Vector3(1, 1, -10))));
+	CPPUNIT_ASSERT(!mCamera->isVisible(AxisAlignedBox(Vector3(-1, -1, 10), Vector3(1, 1, 20))));
+}
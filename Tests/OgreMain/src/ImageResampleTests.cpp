@@ -0,0 +1,343 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ImageResampleTests.h"
+#include "OgreRoot.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ImageResampleTests );
+
+void ImageResampleTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	DefaultWorkQueue* queue = OGRE_NEW DefaultWorkQueue("ImageResampleTests");
+	queue->setWorkersCanAccessRenderSystem(false);
+	queue->setWorkerThreadCount(3);
+	mRoot->setWorkQueue(queue);
+	queue->startup();
+
+	// Split into bands even on a machine with one core
+	ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+	group->setMaxConcurrency(4);
+	mRoot->_releaseTaskGroup(group);
+}
+void ImageResampleTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+void ImageResampleTests::scaleSerially(const PixelBox& src, const PixelBox& dst, 
+	Image::Filter filter)
+{
+	ParallelTaskGroup* group = mRoot->_acquireTaskGroup();
+	CPPUNIT_ASSERT(group);
+	Image::scale(src, dst, filter);
+	mRoot->_releaseTaskGroup(group);
+}
+
+const uchar* ImageResampleTests::getPixel(const PixelBox& box, size_t x, size_t y)
+{
+	return static_cast<const uchar*>(box.data) + 
+		(y * box.rowPitch + x) * PixelUtil::getNumElemBytes(box.format);
+}
+
+void ImageResampleTests::testBandsMatchSerial()
+{
+	struct Case { PixelFormat srcFormat; PixelFormat dstFormat; Image::Filter filter; };
+	const Case cases[] = {
+		{ PF_BYTE_RGBA, PF_BYTE_RGBA, Image::FILTER_NEAREST },
+		{ PF_BYTE_RGB, PF_BYTE_RGBA, Image::FILTER_NEAREST },
+		{ PF_BYTE_RGBA, PF_BYTE_RGBA, Image::FILTER_BILINEAR },
+		{ PF_L8, PF_L8, Image::FILTER_BILINEAR },
+		{ PF_FLOAT32_RGBA, PF_FLOAT32_RGB, Image::FILTER_BILINEAR },
+		{ PF_R5G6B5, PF_BYTE_RGBA, Image::FILTER_BILINEAR },
+		{ PF_BYTE_RGBA, PF_BYTE_RGBA, Image::FILTER_BOX },
+		{ PF_BYTE_RGBA, PF_FLOAT16_RGBA, Image::FILTER_LANCZOS },
+	};
+	const size_t srcWidth = 400, srcHeight = 300, dstWidth = 613, dstHeight = 257;
+
+	for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); ++c)
+	{
+		PixelBox src(srcWidth, srcHeight, 1, cases[c].srcFormat);
+		vector<uchar>::type srcData(src.getConsecutiveSize());
+		for (size_t i = 0; i < srcData.size(); ++i)
+			srcData[i] = static_cast<uchar>(rand());
+		if (cases[c].srcFormat == PF_FLOAT32_RGBA)
+		{
+			float* f = reinterpret_cast<float*>(&srcData[0]);
+			for (size_t i = 0; i < srcData.size() / sizeof(float); ++i)
+				f[i] = static_cast<float>(rand()) / RAND_MAX;
+		}
+		src.data = &srcData[0];
+
+		PixelBox serial(dstWidth, dstHeight, 1, cases[c].dstFormat);
+		PixelBox parallel(dstWidth, dstHeight, 1, cases[c].dstFormat);
+		vector<uchar>::type serialData(serial.getConsecutiveSize(), 0);
+		vector<uchar>::type parallelData(parallel.getConsecutiveSize(), 0xCD);
+		serial.data = &serialData[0];
+		parallel.data = &parallelData[0];
+
+		scaleSerially(src, serial, cases[c].filter);
+		Image::scale(src, parallel, cases[c].filter);
+		CPPUNIT_ASSERT(serialData == parallelData);
+	}
+}
+
+void ImageResampleTests::testConstantColour()
+{
+	const Image::Filter filters[] = { Image::FILTER_BOX, Image::FILTER_TRIANGLE, 
+		Image::FILTER_BICUBIC, Image::FILTER_KAISER, Image::FILTER_LANCZOS };
+	const uchar colour[4] = { 10, 100, 200, 255 };
+
+	PixelBox src(37, 23, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	for (size_t i = 0; i < srcData.size(); ++i)
+		srcData[i] = colour[i % 4];
+	src.data = &srcData[0];
+
+	for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); ++f)
+	{
+		for (int gamma = 0; gamma < 2; ++gamma)
+		{
+			// Shrinking one way and enlarging the other
+			PixelBox dst(16, 50, 1, PF_BYTE_RGBA);
+			vector<uchar>::type dstData(dst.getConsecutiveSize());
+			dst.data = &dstData[0];
+			Image::scale(src, dst, filters[f], gamma != 0);
+			for (size_t i = 0; i < dstData.size(); ++i)
+			{
+				// The sRGB tables are interpolated, so can be out a little
+				int diff = static_cast<int>(dstData[i]) - colour[i % 4];
+				CPPUNIT_ASSERT(diff >= -1 && diff <= 1);
+			}
+		}
+	}
+}
+
+void ImageResampleTests::testBoxAverage()
+{
+	PixelBox src(8, 6, 1, PF_FLOAT32_RGBA);
+	vector<float>::type srcData(8 * 6 * 4);
+	for (size_t i = 0; i < srcData.size(); ++i)
+		srcData[i] = static_cast<float>(rand()) / RAND_MAX;
+	src.data = &srcData[0];
+
+	PixelBox dst(4, 3, 1, PF_FLOAT32_RGBA);
+	vector<float>::type dstData(4 * 3 * 4);
+	dst.data = &dstData[0];
+	Image::scale(src, dst, Image::FILTER_BOX);
+
+	for (size_t y = 0; y < 3; ++y)
+	{
+		for (size_t x = 0; x < 4; ++x)
+		{
+			for (size_t c = 0; c < 4; ++c)
+			{
+				float expected = (srcData[((2*y) * 8 + 2*x) * 4 + c] + 
+					srcData[((2*y) * 8 + 2*x + 1) * 4 + c] +
+					srcData[((2*y + 1) * 8 + 2*x) * 4 + c] + 
+					srcData[((2*y + 1) * 8 + 2*x + 1) * 4 + c]) * 0.25f;
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, dstData[(y * 4 + x) * 4 + c], 1e-5);
+			}
+		}
+	}
+}
+
+void ImageResampleTests::testSameSize()
+{
+	// Every filter passes the source pixels through when the size doesn't change
+	const Image::Filter filters[] = { Image::FILTER_BOX, Image::FILTER_TRIANGLE, 
+		Image::FILTER_BICUBIC, Image::FILTER_KAISER, Image::FILTER_LANCZOS };
+
+	PixelBox src(19, 7, 1, PF_BYTE_RGBA);
+	vector<uchar>::type srcData(src.getConsecutiveSize());
+	for (size_t i = 0; i < srcData.size(); ++i)
+		srcData[i] = static_cast<uchar>(rand());
+	src.data = &srcData[0];
+
+	for (size_t f = 0; f < sizeof(filters) / sizeof(filters[0]); ++f)
+	{
+		PixelBox dst(19, 7, 1, PF_BYTE_RGBA);
+		vector<uchar>::type dstData(dst.getConsecutiveSize());
+		dst.data = &dstData[0];
+		Image::scale(src, dst, filters[f]);
+		CPPUNIT_ASSERT(srcData == dstData);
+	}
+}
+
+void ImageResampleTests::testGammaCorrect()
+{
+	// Black and white, averaged
+	const uchar srcData[8] = { 0, 0, 0, 255, 255, 255, 255, 255 };
+	PixelBox src(2, 1, 1, PF_BYTE_RGBA, const_cast<uchar*>(srcData));
+	uchar dstData[4];
+	PixelBox dst(1, 1, 1, PF_BYTE_RGBA, dstData);
+
+	// Half way between the encoded values
+	Image::scale(src, dst, Image::FILTER_BOX);
+	CPPUNIT_ASSERT_EQUAL(128, (int)dstData[0]);
+	CPPUNIT_ASSERT_EQUAL(255, (int)dstData[3]);
+
+	// Half the light, which is 0.735 encoded
+	Image::scale(src, dst, Image::FILTER_BOX, true);
+	CPPUNIT_ASSERT_EQUAL(188, (int)dstData[0]);
+	CPPUNIT_ASSERT_EQUAL(188, (int)dstData[2]);
+	// alpha is linear anyway
+	CPPUNIT_ASSERT_EQUAL(255, (int)dstData[3]);
+
+	// Linear filters take the same path when gamma correcting
+	Image::scale(src, dst, Image::FILTER_BILINEAR, true);
+	CPPUNIT_ASSERT_EQUAL(188, (int)dstData[0]);
+}
+
+void ImageResampleTests::testGenerateMipmaps()
+{
+	// A checkerboard, which averages to grey at every level
+	const size_t width = 64, height = 16;
+	for (int gamma = 0; gamma < 2; ++gamma)
+	{
+		uchar* data = OGRE_ALLOC_T(uchar, width * height * 4, MEMCATEGORY_GENERAL);
+		for (size_t y = 0; y < height; ++y)
+		{
+			for (size_t x = 0; x < width; ++x)
+			{
+				uchar v = ((x + y) & 1) ? 255 : 0;
+				uchar* p = data + (y * width + x) * 4;
+				p[0] = p[1] = p[2] = v;
+				p[3] = 255;
+			}
+		}
+		Image image;
+		image.loadDynamicImage(data, width, height, 1, PF_BYTE_RGBA, true);
+		image.generateMipmaps(gamma != 0);
+
+		CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumMipmaps());
+		CPPUNIT_ASSERT_EQUAL(Image::calculateSize(6, 1, width, height, 1, PF_BYTE_RGBA), 
+			image.getSize());
+		// The top level is left alone
+		CPPUNIT_ASSERT_EQUAL(0, (int)*getPixel(image.getPixelBox(0, 0), 0, 0));
+		CPPUNIT_ASSERT_EQUAL(255, (int)*getPixel(image.getPixelBox(0, 0), 1, 0));
+
+		PixelBox level = image.getPixelBox(0, 2);
+		CPPUNIT_ASSERT_EQUAL((size_t)16, level.getWidth());
+		CPPUNIT_ASSERT_EQUAL((size_t)4, level.getHeight());
+		int expected = gamma ? 188 : 128;
+		for (size_t mip = 1; mip <= 6; ++mip)
+		{
+			level = image.getPixelBox(0, mip);
+			const uchar* p = getPixel(level, level.getWidth() - 1, level.getHeight() - 1);
+			CPPUNIT_ASSERT(std::abs(expected - p[0]) <= 1);
+			CPPUNIT_ASSERT_EQUAL(255, (int)p[3]);
+		}
+		level = image.getPixelBox(0, 6);
+		CPPUNIT_ASSERT_EQUAL((size_t)1, level.getWidth());
+		CPPUNIT_ASSERT_EQUAL((size_t)1, level.getHeight());
+	}
+}
+
+void ImageResampleTests::testGenerateMipmapsCubeAndVolume()
+{
+	// Each face of a cube a different grey
+	const size_t size = 8;
+	size_t faceSize = size * size;
+	uchar* data = OGRE_ALLOC_T(uchar, faceSize * 6, MEMCATEGORY_GENERAL);
+	for (size_t face = 0; face < 6; ++face)
+		memset(data + face * faceSize, static_cast<int>(face * 40), faceSize);
+	Image cube;
+	cube.loadDynamicImage(data, size, size, 1, PF_L8, true, 6);
+	cube.generateMipmaps();
+	CPPUNIT_ASSERT_EQUAL((size_t)3, cube.getNumMipmaps());
+	for (size_t face = 0; face < 6; ++face)
+	{
+		for (size_t mip = 0; mip <= 3; ++mip)
+		{
+			PixelBox level = cube.getPixelBox(face, mip);
+			CPPUNIT_ASSERT_EQUAL(size >> mip, level.getWidth());
+			CPPUNIT_ASSERT_EQUAL((int)(face * 40), (int)*getPixel(level, 0, 0));
+		}
+	}
+
+	// The depth of a volume is halved along with the rest, until it's 1
+	data = OGRE_ALLOC_T(uchar, size * size * 2, MEMCATEGORY_GENERAL);
+	memset(data, 100, size * size * 2);
+	Image volume;
+	volume.loadDynamicImage(data, size, size, 2, PF_L8, true);
+	volume.generateMipmaps();
+	CPPUNIT_ASSERT_EQUAL((size_t)3, volume.getNumMipmaps());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, volume.getPixelBox(0, 1).getDepth());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, volume.getPixelBox(0, 3).getWidth());
+	CPPUNIT_ASSERT_EQUAL(100, (int)*getPixel(volume.getPixelBox(0, 3), 0, 0));
+}
+
+void ImageResampleTests::testScaleBenchmark()
+{
+	const size_t size = 8192;
+	Image image;
+	uchar* data = OGRE_ALLOC_T(uchar, size * size * 4, MEMCATEGORY_GENERAL);
+	uint32 seed = 12345;
+	for (size_t i = 0; i < size * size * 4; ++i)
+	{
+		seed = seed * 1664525 + 1013904223;
+		data[i] = static_cast<uchar>(seed >> 24);
+	}
+	image.loadDynamicImage(data, size, size, 1, PF_BYTE_RGBA, true);
+
+	PixelBox half(size / 2, size / 2, 1, PF_BYTE_RGBA);
+	vector<uchar>::type halfData(half.getConsecutiveSize());
+	half.data = &halfData[0];
+
+	Timer timer;
+	scaleSerially(image.getPixelBox(), half, Image::FILTER_BILINEAR);
+	unsigned long serialBilinear = timer.getMilliseconds();
+
+	timer.reset();
+	Image::scale(image.getPixelBox(), half, Image::FILTER_BILINEAR);
+	unsigned long bilinear = timer.getMilliseconds();
+
+	timer.reset();
+	Image::scale(image.getPixelBox(), half, Image::FILTER_BOX);
+	unsigned long box = timer.getMilliseconds();
+
+	timer.reset();
+	Image::scale(image.getPixelBox(), half, Image::FILTER_LANCZOS);
+	unsigned long lanczos = timer.getMilliseconds();
+
+	timer.reset();
+	image.generateMipmaps(true);
+	unsigned long mipmaps = timer.getMilliseconds();
+	CPPUNIT_ASSERT_EQUAL((size_t)13, image.getNumMipmaps());
+
+	LogManager::getSingleton().stream() << "ImageResampleTests: " << size << "x" << size 
+		<< " PF_BYTE_RGBA to half size: bilinear serial " << serialBilinear 
+		<< "ms, bilinear " << bilinear << "ms, box " << box << "ms, lanczos " << lanczos 
+		<< "ms; gamma correct box mip chain " << mipmaps << "ms";
+}
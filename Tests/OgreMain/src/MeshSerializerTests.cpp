@@ -0,0 +1,323 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <stdio.h>
+#include "MeshSerializerTests.h"
+#include "OgreRoot.h"
+#include "OgreMeshManager.h"
+#include "OgreSubMesh.h"
+#include "OgrePose.h"
+#include "OgreManualObject.h"
+#include "OgreEdgeListBuilder.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( MeshSerializerTests );
+
+void MeshSerializerTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mBufMgr = OGRE_NEW DefaultHardwareBufferManager();
+}
+void MeshSerializerTests::tearDown()
+{
+	MeshManager::getSingleton().removeAll();
+	OGRE_DELETE mBufMgr;
+	OGRE_DELETE mRoot;
+}
+
+MeshPtr MeshSerializerTests::createGridMesh(const String& name, size_t size)
+{
+	ManualObject* grid = OGRE_NEW ManualObject(name);
+	grid->begin("BaseWhiteNoLighting", RenderOperation::OT_TRIANGLE_LIST);
+	for (size_t y = 0; y <= size; ++y)
+	{
+		for (size_t x = 0; x <= size; ++x)
+		{
+			grid->position((Real)x, (Real)y, Math::Sin((Real)(x * y)));
+			grid->normal(Vector3::UNIT_Z);
+			grid->textureCoord((Real)x / size, (Real)y / size);
+		}
+	}
+	for (size_t y = 0; y < size; ++y)
+	{
+		for (size_t x = 0; x < size; ++x)
+		{
+			uint32 i = static_cast<uint32>(y * (size + 1) + x);
+			grid->quad(i, i + 1, i + (uint32)size + 2, i + (uint32)size + 1);
+		}
+	}
+	grid->end();
+	MeshPtr mesh = grid->convertToMesh(name);
+	OGRE_DELETE grid;
+
+	SubMesh* sub = mesh->getSubMesh(0);
+	Pose* pose = mesh->createPose(1, "bulge");
+	for (size_t v = 0; v < sub->vertexData->vertexCount; ++v)
+	{
+		VertexBoneAssignment assign;
+		assign.vertexIndex = static_cast<unsigned int>(v);
+		assign.boneIndex = static_cast<unsigned short>(v % 7);
+		assign.weight = 1.0f / (1 + v % 3);
+		sub->addBoneAssignment(assign);
+		if (v % 5 == 0)
+			pose->addVertex(v, Vector3((Real)v, -(Real)v, 0.5f));
+	}
+	mesh->buildEdgeList();
+	return mesh;
+}
+
+MeshPtr MeshSerializerTests::roundTrip(const MeshPtr& mesh, const String& name, 
+	MeshSerializer::Endian endian)
+{
+	String fileName = name + ".mesh";
+	MeshSerializer serializer;
+	serializer.exportMesh(mesh.get(), fileName, endian);
+
+	MeshPtr result = MeshManager::getSingleton().createManual(name, 
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+		fileName.c_str(), std::ios::in | std::ios::binary);
+	DataStreamPtr stream(OGRE_NEW FileStreamDataStream(file));
+	serializer.importMesh(stream, result.get());
+	stream->close();
+	remove(fileName.c_str());
+	return result;
+}
+
+void MeshSerializerTests::checkMeshesEqual(const MeshPtr& a, const MeshPtr& b)
+{
+	CPPUNIT_ASSERT_EQUAL(a->getNumSubMeshes(), b->getNumSubMeshes());
+	SubMesh* subA = a->getSubMesh(0);
+	SubMesh* subB = b->getSubMesh(0);
+
+	// Vertex data, flipped a buffer at a time
+	CPPUNIT_ASSERT_EQUAL(subA->vertexData->vertexCount, subB->vertexData->vertexCount);
+	HardwareVertexBufferSharedPtr vbufA = subA->vertexData->vertexBufferBinding->getBuffer(0);
+	HardwareVertexBufferSharedPtr vbufB = subB->vertexData->vertexBufferBinding->getBuffer(0);
+	CPPUNIT_ASSERT_EQUAL(vbufA->getSizeInBytes(), vbufB->getSizeInBytes());
+	const void* pA = vbufA->lock(HardwareBuffer::HBL_READ_ONLY);
+	const void* pB = vbufB->lock(HardwareBuffer::HBL_READ_ONLY);
+	CPPUNIT_ASSERT(memcmp(pA, pB, vbufA->getSizeInBytes()) == 0);
+	vbufA->unlock();
+	vbufB->unlock();
+
+	// Index data
+	CPPUNIT_ASSERT_EQUAL(subA->indexData->indexCount, subB->indexData->indexCount);
+	HardwareIndexBufferSharedPtr ibufA = subA->indexData->indexBuffer;
+	HardwareIndexBufferSharedPtr ibufB = subB->indexData->indexBuffer;
+	CPPUNIT_ASSERT_EQUAL(ibufA->getType(), ibufB->getType());
+	pA = ibufA->lock(HardwareBuffer::HBL_READ_ONLY);
+	pB = ibufB->lock(HardwareBuffer::HBL_READ_ONLY);
+	CPPUNIT_ASSERT(memcmp(pA, pB, ibufA->getSizeInBytes()) == 0);
+	ibufA->unlock();
+	ibufB->unlock();
+
+	// Bone assignments, one chunk each
+	CPPUNIT_ASSERT_EQUAL(subA->getBoneAssignments().size(), subB->getBoneAssignments().size());
+	SubMesh::VertexBoneAssignmentList::const_iterator ia = subA->getBoneAssignments().begin();
+	SubMesh::VertexBoneAssignmentList::const_iterator ib = subB->getBoneAssignments().begin();
+	for (; ia != subA->getBoneAssignments().end(); ++ia, ++ib)
+	{
+		CPPUNIT_ASSERT_EQUAL(ia->second.vertexIndex, ib->second.vertexIndex);
+		CPPUNIT_ASSERT_EQUAL(ia->second.boneIndex, ib->second.boneIndex);
+		CPPUNIT_ASSERT_EQUAL(ia->second.weight, ib->second.weight);
+	}
+
+	// Pose vertices
+	CPPUNIT_ASSERT_EQUAL(a->getPoseCount(), b->getPoseCount());
+	const Pose::VertexOffsetMap& offsetsA = a->getPose(0)->getVertexOffsets();
+	const Pose::VertexOffsetMap& offsetsB = b->getPose(0)->getVertexOffsets();
+	CPPUNIT_ASSERT_EQUAL(offsetsA.size(), offsetsB.size());
+	CPPUNIT_ASSERT(offsetsA == offsetsB);
+
+	// Edge list, read in blocks
+	const EdgeData* edgesA = a->getEdgeList();
+	const EdgeData* edgesB = b->getEdgeList();
+	CPPUNIT_ASSERT_EQUAL(edgesA->isClosed, edgesB->isClosed);
+	CPPUNIT_ASSERT_EQUAL(edgesA->triangles.size(), edgesB->triangles.size());
+	for (size_t t = 0; t < edgesA->triangles.size(); ++t)
+	{
+		const EdgeData::Triangle& triA = edgesA->triangles[t];
+		const EdgeData::Triangle& triB = edgesB->triangles[t];
+		CPPUNIT_ASSERT_EQUAL(triA.indexSet, triB.indexSet);
+		CPPUNIT_ASSERT_EQUAL(triA.vertexSet, triB.vertexSet);
+		for (int i = 0; i < 3; ++i)
+		{
+			CPPUNIT_ASSERT_EQUAL(triA.vertIndex[i], triB.vertIndex[i]);
+			CPPUNIT_ASSERT_EQUAL(triA.sharedVertIndex[i], triB.sharedVertIndex[i]);
+		}
+		CPPUNIT_ASSERT(edgesA->triangleFaceNormals[t] == edgesB->triangleFaceNormals[t]);
+	}
+	CPPUNIT_ASSERT_EQUAL(edgesA->edgeGroups.size(), edgesB->edgeGroups.size());
+	for (size_t g = 0; g < edgesA->edgeGroups.size(); ++g)
+	{
+		const EdgeData::EdgeList& listA = edgesA->edgeGroups[g].edges;
+		const EdgeData::EdgeList& listB = edgesB->edgeGroups[g].edges;
+		CPPUNIT_ASSERT_EQUAL(listA.size(), listB.size());
+		for (size_t e = 0; e < listA.size(); ++e)
+		{
+			for (int i = 0; i < 2; ++i)
+			{
+				// Stored as 32 bits, which matters for the ~0 of a degenerate edge
+				CPPUNIT_ASSERT_EQUAL((uint32)listA[e].triIndex[i], (uint32)listB[e].triIndex[i]);
+				CPPUNIT_ASSERT_EQUAL(listA[e].vertIndex[i], listB[e].vertIndex[i]);
+				CPPUNIT_ASSERT_EQUAL(listA[e].sharedVertIndex[i], listB[e].sharedVertIndex[i]);
+			}
+			CPPUNIT_ASSERT_EQUAL(listA[e].degenerate, listB[e].degenerate);
+		}
+	}
+}
+
+void MeshSerializerTests::testRoundTripLittleEndian()
+{
+	// Big enough for several blocks of edge list triangles and edges
+	MeshPtr mesh = createGridMesh("grid", 30);
+	CPPUNIT_ASSERT(mesh->getEdgeList()->triangles.size() > 1000);
+	MeshPtr loaded = roundTrip(mesh, "gridLittle", MeshSerializer::ENDIAN_LITTLE);
+	checkMeshesEqual(mesh, loaded);
+}
+
+void MeshSerializerTests::testRoundTripBigEndian()
+{
+	MeshPtr mesh = createGridMesh("grid", 30);
+	MeshPtr loaded = roundTrip(mesh, "gridBig", MeshSerializer::ENDIAN_BIG);
+	checkMeshesEqual(mesh, loaded);
+}
+
+void MeshSerializerTests::testManyVertexElements()
+{
+	// Lots of elements in one buffer, with a UBYTE4 among them so that each
+	// element is flipped on its own
+	MeshPtr mesh = MeshManager::getSingleton().createManual("wide", 
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	SubMesh* sub = mesh->createSubMesh();
+	sub->useSharedVertices = false;
+	sub->vertexData = OGRE_NEW VertexData();
+	VertexDeclaration* decl = sub->vertexData->vertexDeclaration;
+	size_t offset = 0;
+	offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+	offset += decl->addElement(0, offset, VET_UBYTE4, VES_DIFFUSE).getSize();
+	for (unsigned short i = 0; i < 40; ++i)
+		offset += decl->addElement(0, offset, VET_SHORT2, VES_TEXTURE_COORDINATES, i).getSize();
+
+	const size_t vertexCount = 16;
+	HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+		offset, vertexCount, HardwareBuffer::HBU_STATIC_WRITE_ONLY, true);
+	uint8* pData = static_cast<uint8*>(vbuf->lock(HardwareBuffer::HBL_DISCARD));
+	for (size_t i = 0; i < vbuf->getSizeInBytes(); ++i)
+		pData[i] = static_cast<uint8>(i * 7);
+	vbuf->unlock();
+	sub->vertexData->vertexBufferBinding->setBinding(0, vbuf);
+	sub->vertexData->vertexCount = vertexCount;
+	// The contents are not real positions, but the exporter wants bounds
+	mesh->_setBounds(AxisAlignedBox(-Vector3::UNIT_SCALE, Vector3::UNIT_SCALE));
+
+	MeshPtr loaded = roundTrip(mesh, "wideBig", MeshSerializer::ENDIAN_BIG);
+	HardwareVertexBufferSharedPtr loadedBuf = 
+		loaded->getSubMesh(0)->vertexData->vertexBufferBinding->getBuffer(0);
+	CPPUNIT_ASSERT_EQUAL(vbuf->getSizeInBytes(), loadedBuf->getSizeInBytes());
+	const void* pA = vbuf->lock(HardwareBuffer::HBL_READ_ONLY);
+	const void* pB = loadedBuf->lock(HardwareBuffer::HBL_READ_ONLY);
+	CPPUNIT_ASSERT(memcmp(pA, pB, vbuf->getSizeInBytes()) == 0);
+	vbuf->unlock();
+	loadedBuf->unlock();
+}
+
+void MeshSerializerTests::testImportBenchmark()
+{
+	// The sample meshes, preloaded into memory so only parsing is timed
+	const String mediaPath = "../../../Samples/Media/models";
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	rgm.addResourceLocation(mediaPath, "FileSystem", "MeshSerializerTests");
+	StringVectorPtr names = rgm.findResourceNames("MeshSerializerTests", "*.mesh");
+	if (names->empty())
+	{
+		LogManager::getSingleton().logMessage(
+			"MeshSerializerTests: no meshes found in " + mediaPath + ", skipping benchmark");
+		return;
+	}
+
+	MeshSerializer serializer;
+	const int iterations = 5;
+	size_t totalBytes = 0;
+	unsigned long nativeUs = 0, flippedUs = 0;
+	for (StringVector::iterator i = names->begin(); i != names->end(); ++i)
+	{
+		DataStreamPtr file = rgm.openResource(*i, "MeshSerializerTests");
+		DataStreamPtr native(OGRE_NEW MemoryDataStream(*i, file));
+		totalBytes += native->size();
+
+		// The same mesh written with the other endianness, so every value
+		// has to be flipped as it's read
+		MeshPtr mesh = MeshManager::getSingleton().createManual(*i + ".native", "MeshSerializerTests");
+		serializer.importMesh(native, mesh.get());
+		String flippedName = "flipped.mesh";
+		serializer.exportMesh(mesh.get(), flippedName, 
+			OGRE_ENDIAN == OGRE_ENDIAN_BIG ? MeshSerializer::ENDIAN_LITTLE : MeshSerializer::ENDIAN_BIG);
+		std::ifstream* flippedFile = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+			flippedName.c_str(), std::ios::in | std::ios::binary);
+		DataStreamPtr flippedStream(OGRE_NEW FileStreamDataStream(flippedFile));
+		DataStreamPtr flipped(OGRE_NEW MemoryDataStream(*i, flippedStream));
+		remove(flippedName.c_str());
+
+		Timer timer;
+		for (int n = 0; n < iterations; ++n)
+		{
+			native->seek(0);
+			MeshPtr copy = MeshManager::getSingleton().createManual(*i + ".copy", "MeshSerializerTests");
+			serializer.importMesh(native, copy.get());
+			MeshManager::getSingleton().remove(copy->getHandle());
+		}
+		nativeUs += timer.getMicroseconds();
+
+		timer.reset();
+		for (int n = 0; n < iterations; ++n)
+		{
+			flipped->seek(0);
+			MeshPtr copy = MeshManager::getSingleton().createManual(*i + ".copy", "MeshSerializerTests");
+			serializer.importMesh(flipped, copy.get());
+			CPPUNIT_ASSERT_EQUAL(mesh->getNumSubMeshes(), copy->getNumSubMeshes());
+			MeshManager::getSingleton().remove(copy->getHandle());
+		}
+		flippedUs += timer.getMicroseconds();
+
+		MeshManager::getSingleton().remove(mesh->getHandle());
+	}
+
+	double megabytes = (double)(totalBytes * iterations) / (1024 * 1024);
+	LogManager::getSingleton().stream() 
+		<< "MeshSerializerTests: imported " << names->size() << " meshes ("
+		<< totalBytes << " bytes) " << iterations << " times: native "
+		<< nativeUs / 1000 << "ms (" << megabytes * 1000000 / std::max(nativeUs, 1ul) 
+		<< "MB/s), byte swapped " << flippedUs / 1000 << "ms (" 
+		<< megabytes * 1000000 / std::max(flippedUs, 1ul) << "MB/s)";
+}
@@ -0,0 +1,393 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OptimisedUtilTests.h"
+#include "OgreMatrix4.h"
+#include "OgreVector4.h"
+#include "OgreEdgeListBuilder.h"
+#include "OgreAlignedAllocator.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( OptimisedUtilTests );
+
+void OptimisedUtilTests::setUp()
+{
+	// Same seed every time so that failures can be reproduced
+	srand(12345);
+
+	// The implementations which should give the same results as the 
+	// general one; not available ones are skipped
+	OptimisedUtil* avx = OptimisedUtil::_getImplementation(OptimisedUtil::IT_AVX);
+	if (avx)
+		mImplementations.push_back(std::make_pair(String("AVX"), avx));
+
+	// Random affine blend matrices, aligned as the SSE version requires
+	mNumMatrices = 40;
+	mMatrices = static_cast<Matrix4*>(AlignedMemory::allocate(sizeof(Matrix4) * mNumMatrices));
+	for (size_t i = 0; i < mNumMatrices; ++i)
+	{
+		Quaternion q(Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1), 
+			Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1));
+		q.normalise();
+		Vector3 scale(Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2));
+		Vector3 pos(Math::RangeRandom(-50, 50), Math::RangeRandom(-50, 50), Math::RangeRandom(-50, 50));
+		mMatrices[i].makeTransform(pos, scale, q);
+	}
+
+}
+void OptimisedUtilTests::tearDown()
+{
+	AlignedMemory::deallocate(mMatrices);
+	mImplementations.clear();
+}
+
+void OptimisedUtilTests::checkFloats(const String& what, 
+	const float* expected, const float* actual, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+#if OGRE_COMPILER == OGRE_COMPILER_GNUC && OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_32
+		// The general version may use extended precision x87 arithmetic here
+		CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(what + " " + StringConverter::toString(i),
+			expected[i], actual[i], 1e-5 * std::max(1.0f, Math::Abs(expected[i])));
+#else
+		// Otherwise the results should be identical
+		CPPUNIT_ASSERT_EQUAL_MESSAGE(what + " " + StringConverter::toString(i),
+			expected[i], actual[i]);
+#endif
+	}
+}
+
+void OptimisedUtilTests::fillFloats(vector<float>::type& data, size_t count, float range)
+{
+	data.resize(count);
+	for (size_t i = 0; i < count; ++i)
+		data[i] = Math::RangeRandom(-range, range);
+}
+
+void OptimisedUtilTests::fillBlendData(vector<float>::type& weights, vector<uchar>::type& indices,
+	size_t numVertices, size_t numWeightsPerVertex)
+{
+	weights.resize(numVertices * numWeightsPerVertex);
+	indices.resize(numVertices * numWeightsPerVertex);
+	for (size_t v = 0; v < numVertices; ++v)
+	{
+		float total = 0;
+		for (size_t w = 0; w < numWeightsPerVertex; ++w)
+		{
+			size_t i = v * numWeightsPerVertex + w;
+			// Some zero weights, whose index mustn't be used
+			if (w > 0 && rand() % 4 == 0)
+			{
+				weights[i] = 0;
+				indices[i] = 255;
+			}
+			else
+			{
+				weights[i] = Math::RangeRandom(0.1, 1);
+				indices[i] = (uchar)(rand() % mNumMatrices);
+			}
+			total += weights[i];
+		}
+		for (size_t w = 0; w < numWeightsPerVertex; ++w)
+			weights[v * numWeightsPerVertex + w] /= total;
+	}
+}
+
+void OptimisedUtilTests::checkSkinning(OptimisedUtil* impl, const String& name, size_t numVertices,
+	size_t numWeightsPerVertex, bool normals, bool sharedBuffer)
+{
+	String what = name + " skinning " + StringConverter::toString(numVertices) + "x" +
+		StringConverter::toString(numWeightsPerVertex) + (normals ? " normals" : "") +
+		(sharedBuffer ? " shared" : "");
+
+	// Only the matrices in use are valid
+	const Matrix4* blendMatrices[256] = { 0 };
+	for (size_t i = 0; i < mNumMatrices; ++i)
+		blendMatrices[i] = &mMatrices[i];
+
+	vector<float>::type weights;
+	vector<uchar>::type indices;
+	fillBlendData(weights, indices, numVertices, numWeightsPerVertex);
+
+	// Positions and normals interleaved in one buffer, or in separate ones
+	vector<float>::type src, expected, actual;
+	fillFloats(src, numVertices * 6, 100);
+	expected.resize(src.size(), -1);
+	actual.resize(src.size(), -1);
+	size_t stride = sharedBuffer ? 24 : 12;
+	size_t normOffset = sharedBuffer ? 3 : numVertices * 3;
+
+	OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->softwareVertexSkinning(
+		&src[0], &expected[0], normals ? &src[normOffset] : 0, &expected[normOffset],
+		&weights[0], &indices[0], blendMatrices, stride, stride, stride, stride,
+		numWeightsPerVertex * sizeof(float), numWeightsPerVertex, numWeightsPerVertex, numVertices);
+	impl->softwareVertexSkinning(
+		&src[0], &actual[0], normals ? &src[normOffset] : 0, &actual[normOffset],
+		&weights[0], &indices[0], blendMatrices, stride, stride, stride, stride,
+		numWeightsPerVertex * sizeof(float), numWeightsPerVertex, numWeightsPerVertex, numVertices);
+
+	// Also checks that nothing else was written
+	checkFloats(what, &expected[0], &actual[0], expected.size());
+}
+
+void OptimisedUtilTests::testSkinningMatchesGeneral()
+{
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		for (size_t weights = 1; weights <= 4; ++weights)
+		{
+			// Odd counts to exercise the remainders
+			checkSkinning(mImplementations[i].second, mImplementations[i].first, 101, weights, false, false);
+			checkSkinning(mImplementations[i].second, mImplementations[i].first, 101, weights, true, false);
+			checkSkinning(mImplementations[i].second, mImplementations[i].first, 100, weights, true, true);
+			checkSkinning(mImplementations[i].second, mImplementations[i].first, 1, weights, true, true);
+		}
+	}
+}
+
+void OptimisedUtilTests::testMorphMatchesGeneral()
+{
+	vector<float>::type src1, src2;
+	fillFloats(src1, 103 * 3, 100);
+	fillFloats(src2, 103 * 3, 100);
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		for (size_t numVertices = 0; numVertices <= 103; numVertices += 17)
+		{
+			vector<float>::type expected(src1.size(), -1), actual(src1.size(), -1);
+			OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->softwareVertexMorph(
+				0.3f, &src1[0], &src2[0], &expected[0], numVertices);
+			mImplementations[i].second->softwareVertexMorph(
+				0.3f, &src1[0], &src2[0], &actual[0], numVertices);
+			checkFloats(mImplementations[i].first + " morph", &expected[0], &actual[0], expected.size());
+		}
+	}
+}
+
+void OptimisedUtilTests::testConcatenateAffineMatricesMatchesGeneral()
+{
+	Matrix4 base = mMatrices[0];
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		for (size_t numMatrices = 1; numMatrices < mNumMatrices; numMatrices += 6)
+		{
+			vector<Matrix4>::type expected(numMatrices, Matrix4::ZERO), actual(numMatrices, Matrix4::ZERO);
+			OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->concatenateAffineMatrices(
+				base, mMatrices + 1, &expected[0], numMatrices);
+			mImplementations[i].second->concatenateAffineMatrices(
+				base, mMatrices + 1, &actual[0], numMatrices);
+			checkFloats(mImplementations[i].first + " concatenate", 
+				&expected[0][0][0], &actual[0][0][0], numMatrices * 16);
+		}
+	}
+}
+
+void OptimisedUtilTests::testFaceNormalsMatchesGeneral()
+{
+	const size_t numVertices = 500;
+	const size_t numTriangles = 301;
+	vector<float>::type positions;
+	fillFloats(positions, numVertices * 3, 100);
+	vector<EdgeData::Triangle>::type triangles(numTriangles);
+	for (size_t t = 0; t < numTriangles; ++t)
+	{
+		for (size_t c = 0; c < 3; ++c)
+			triangles[t].vertIndex[c] = rand() % numVertices;
+	}
+
+	Vector4* expected = static_cast<Vector4*>(AlignedMemory::allocate(sizeof(Vector4) * numTriangles));
+	Vector4* actual = static_cast<Vector4*>(AlignedMemory::allocate(sizeof(Vector4) * numTriangles));
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->calculateFaceNormals(
+			&positions[0], &triangles[0], expected, numTriangles);
+		mImplementations[i].second->calculateFaceNormals(
+			&positions[0], &triangles[0], actual, numTriangles);
+		checkFloats(mImplementations[i].first + " face normals",
+			expected->ptr(), actual->ptr(), numTriangles * 4);
+	}
+	AlignedMemory::deallocate(expected);
+	AlignedMemory::deallocate(actual);
+}
+
+void OptimisedUtilTests::testLightFacingMatchesGeneral()
+{
+	const size_t numFaces = 301;
+	Vector4* faceNormals = static_cast<Vector4*>(AlignedMemory::allocate(sizeof(Vector4) * numFaces));
+	for (size_t f = 0; f < numFaces; ++f)
+	{
+		faceNormals[f] = Vector4(Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1),
+			Math::RangeRandom(-1, 1), Math::RangeRandom(-100, 100));
+	}
+	// Point and directional lights
+	Vector4 lights[] = { Vector4(10, 20, -30, 1), Vector4(0.5, -0.7, 0.1, 0) };
+
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		for (size_t l = 0; l < 2; ++l)
+		{
+			vector<char>::type expected(numFaces, 2), actual(numFaces, 2);
+			OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->calculateLightFacing(
+				lights[l], faceNormals, &expected[0], numFaces);
+			mImplementations[i].second->calculateLightFacing(
+				lights[l], faceNormals, &actual[0], numFaces);
+			for (size_t f = 0; f < numFaces; ++f)
+			{
+				CPPUNIT_ASSERT_EQUAL((int)expected[f], (int)actual[f]);
+			}
+		}
+	}
+	AlignedMemory::deallocate(faceNormals);
+}
+
+void OptimisedUtilTests::testExtrudeVerticesMatchesGeneral()
+{
+	const size_t numVertices = 203;
+	vector<float>::type src;
+	fillFloats(src, numVertices * 3, 100);
+	// Put a vertex right on the point light, which mustn't be normalised
+	src[33] = 10; src[34] = 20; src[35] = -30;
+	Vector4 lights[] = { Vector4(10, 20, -30, 1), Vector4(0.5, -0.7, 0.1, 0) };
+
+	for (size_t i = 0; i < mImplementations.size(); ++i)
+	{
+		for (size_t l = 0; l < 2; ++l)
+		{
+			vector<float>::type expected(src.size(), -1), actual(src.size(), -1);
+			OptimisedUtil::_getImplementation(OptimisedUtil::IT_GENERAL)->extrudeVertices(
+				lights[l], 1000, &src[0], &expected[0], numVertices);
+			mImplementations[i].second->extrudeVertices(
+				lights[l], 1000, &src[0], &actual[0], numVertices);
+			checkFloats(mImplementations[i].first + " extrude", &expected[0], &actual[0], expected.size());
+		}
+	}
+}
+
+void OptimisedUtilTests::testKernelBenchmark()
+{
+	LogManager* logMgr = 0;
+	if (!LogManager::getSingletonPtr())
+	{
+		logMgr = OGRE_NEW LogManager();
+		logMgr->createLog("OptimisedUtilTests.log", true, false);
+	}
+
+	// All the implementations this time, including the general one
+	const char* names[] = { "General", "SSE", "AVX" };
+	OptimisedUtil::ImplementationType types[] = 
+		{ OptimisedUtil::IT_GENERAL, OptimisedUtil::IT_SSE, OptimisedUtil::IT_AVX };
+
+	const size_t numVertices = 20000;
+	const size_t numWeights = 4;
+	const size_t iterations = 20;
+
+	// No zero weights, so that every implementation does the same work
+	const Matrix4* blendMatrices[256];
+	vector<float>::type weights(numVertices * numWeights);
+	vector<uchar>::type indices(numVertices * numWeights);
+	for (size_t i = 0; i < weights.size(); ++i)
+	{
+		weights[i] = 1.0f / numWeights;
+		indices[i] = (uchar)(rand() % mNumMatrices);
+	}
+	for (size_t i = 0; i < 256; ++i)
+		blendMatrices[i] = &mMatrices[i % mNumMatrices];
+
+	vector<float>::type src, src2, dest(numVertices * 6);
+	fillFloats(src, numVertices * 6, 100);
+	fillFloats(src2, numVertices * 3, 100);
+	const size_t numTriangles = numVertices;
+	vector<EdgeData::Triangle>::type triangles(numTriangles);
+	for (size_t t = 0; t < numTriangles; ++t)
+	{
+		for (size_t c = 0; c < 3; ++c)
+			triangles[t].vertIndex[c] = rand() % numVertices;
+	}
+	Vector4* faceNormals = static_cast<Vector4*>(AlignedMemory::allocate(sizeof(Vector4) * numTriangles));
+	vector<char>::type lightFacings(numTriangles);
+	Matrix4* concatenated = static_cast<Matrix4*>(AlignedMemory::allocate(sizeof(Matrix4) * mNumMatrices));
+
+	Timer timer;
+	for (size_t impl = 0; impl < 3; ++impl)
+	{
+		OptimisedUtil* util = OptimisedUtil::_getImplementation(types[impl]);
+		if (!util)
+			continue;
+
+		// Microseconds per kernel
+		unsigned long skinUs = 0, morphUs = 0, concatUs = 0, faceUs = 0, facingUs = 0, extrudeUs = 0;
+		for (size_t it = 0; it < iterations; ++it)
+		{
+			timer.reset();
+			util->softwareVertexSkinning(&src[0], &dest[0], &src[3], &dest[3],
+				&weights[0], &indices[0], blendMatrices, 24, 24, 24, 24,
+				numWeights * sizeof(float), numWeights, numWeights, numVertices);
+			skinUs += timer.getMicroseconds();
+
+			timer.reset();
+			util->softwareVertexMorph(0.3f, &src[0], &src2[0], &dest[0], numVertices);
+			morphUs += timer.getMicroseconds();
+
+			// Several batches of bones, to make it measurable
+			timer.reset();
+			for (size_t b = 0; b < numVertices / mNumMatrices; ++b)
+				util->concatenateAffineMatrices(mMatrices[b % mNumMatrices], mMatrices, concatenated, mNumMatrices);
+			concatUs += timer.getMicroseconds();
+
+			timer.reset();
+			util->calculateFaceNormals(&src[0], &triangles[0], faceNormals, numTriangles);
+			faceUs += timer.getMicroseconds();
+
+			timer.reset();
+			util->calculateLightFacing(Vector4(10, 20, -30, 1), faceNormals, &lightFacings[0], numTriangles);
+			facingUs += timer.getMicroseconds();
+
+			timer.reset();
+			util->extrudeVertices(Vector4(10, 20, -30, 1), 1000, &src[0], &dest[0], numVertices);
+			extrudeUs += timer.getMicroseconds();
+		}
+
+		// Millions of vertices (or triangles, or matrices) per second
+		double count = (double)numVertices * iterations;
+		LogManager::getSingleton().stream() << "OptimisedUtilTests: " << names[impl] 
+			<< " Mverts/s: skinning " << count / std::max(1ul, skinUs)
+			<< ", morph " << count / std::max(1ul, morphUs)
+			<< ", concatenate " << count / std::max(1ul, concatUs)
+			<< ", face normals " << count / std::max(1ul, faceUs)
+			<< ", light facing " << count / std::max(1ul, facingUs)
+			<< ", extrude " << count / std::max(1ul, extrudeUs);
+	}
+
+	AlignedMemory::deallocate(faceNormals);
+	AlignedMemory::deallocate(concatenated);
+	if (logMgr)
+		OGRE_DELETE logMgr;
+}
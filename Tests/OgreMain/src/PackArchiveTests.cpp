@@ -0,0 +1,275 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "PackArchiveTests.h"
+#include "OgreRoot.h"
+#include "OgrePackArchive.h"
+#include "OgreException.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( PackArchiveTests );
+
+void PackArchiveTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	DefaultWorkQueue* queue = OGRE_NEW DefaultWorkQueue("PackArchiveTests");
+	queue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(queue);
+	queue->startup();
+
+	mPackName = "PackArchiveTests.pack";
+
+	// Text compresses, random bytes don't
+	mText.clear();
+	for (int i = 0; i < 200; ++i)
+		mText += "this is line " + StringConverter::toString(i) + " of the text file\n";
+	mBinary.clear();
+	for (int i = 0; i < 5000; ++i)
+		mBinary.push_back(static_cast<char>(rand() & 0xFF));
+}
+void PackArchiveTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+	::remove(mPackName.c_str());
+}
+
+DataStreamPtr PackArchiveTests::createStream(const String& contents)
+{
+	MemoryDataStream* stream = OGRE_NEW MemoryDataStream(contents.size());
+	memcpy(stream->getPtr(), contents.c_str(), contents.size());
+	return DataStreamPtr(stream);
+}
+
+String PackArchiveTests::readStream(const DataStreamPtr& stream)
+{
+	String ret(stream->size(), '\0');
+	if (!ret.empty())
+		CPPUNIT_ASSERT_EQUAL(ret.size(), stream->read(&ret[0], ret.size()));
+	return ret;
+}
+
+void PackArchiveTests::writeTestPack(uint32 blockSize, int level)
+{
+	PackArchiveWriter writer(blockSize, level);
+	writer.addFile("text.txt", createStream(mText), 1234);
+	writer.addFile("random.bin", createStream(mBinary));
+	writer.addFile("empty.txt", createStream(StringUtil::BLANK));
+	writer.addFile("level1/level2/nested.txt", createStream("nested file"));
+	CPPUNIT_ASSERT_EQUAL((size_t)4, writer.getNumFiles());
+	writer.write(mPackName);
+}
+
+void PackArchiveTests::testFileRead()
+{
+	// Compressed, and entirely stored
+	for (int level = 6; level >= 0; level -= 6)
+	{
+		writeTestPack(1024, level);
+		PackArchive arch(mPackName, "Pack");
+		arch.load();
+
+		DataStreamPtr stream = arch.open("text.txt");
+		CPPUNIT_ASSERT_EQUAL(mText.size(), stream->size());
+		CPPUNIT_ASSERT_EQUAL(String("this is line 0 of the text file"), stream->getLine());
+		stream->seek(0);
+		CPPUNIT_ASSERT(mText == readStream(stream));
+		CPPUNIT_ASSERT(mBinary == readStream(arch.open("random.bin")));
+		CPPUNIT_ASSERT(readStream(arch.open("empty.txt")).empty());
+		CPPUNIT_ASSERT_EQUAL(String("nested file"), readStream(arch.open("level1/level2/nested.txt")));
+		CPPUNIT_ASSERT_EQUAL((time_t)1234, arch.getModifiedTime("text.txt"));
+
+		// Writeable streams are always copies
+		DataStreamPtr rwStream = arch.open("random.bin", false);
+		CPPUNIT_ASSERT(rwStream->isWriteable());
+		CPPUNIT_ASSERT(mBinary == readStream(rwStream));
+
+		FileInfoListPtr files = arch.listFileInfo();
+		for (FileInfoList::iterator i = files->begin(); i != files->end(); ++i)
+		{
+			if (i->filename == "text.txt")
+			{
+				CPPUNIT_ASSERT_EQUAL(mText.size(), i->uncompressedSize);
+				if (level)
+					CPPUNIT_ASSERT(i->compressedSize < mText.size() / 2);
+				else
+					CPPUNIT_ASSERT_EQUAL(mText.size(), i->compressedSize);
+			}
+			else if (i->filename == "random.bin")
+			{
+				CPPUNIT_ASSERT_EQUAL(mBinary.size(), i->compressedSize);
+			}
+		}
+	}
+}
+
+void PackArchiveTests::testStoredFileSharesMapping()
+{
+	writeTestPack(1024, 6);
+	PackArchive* arch = OGRE_NEW PackArchive(mPackName, "Pack");
+	arch->load();
+
+	// Random data doesn't compress, so it is stored and read from the mapping
+	DataStreamPtr stream = arch->open("random.bin");
+	const uchar* shared = stream->getSharedMemory();
+	CPPUNIT_ASSERT(shared);
+	// so a read-only prebuffer, as Mesh makes, is not a copy
+	MemoryDataStream prebuffer("random.bin", stream, true, true);
+	CPPUNIT_ASSERT(prebuffer.getPtr() == shared);
+	CPPUNIT_ASSERT(!arch->open("text.txt")->getSharedMemory());
+
+	// The streams keep the mapping open after the archive has gone
+	DataStreamPtr other = arch->open("random.bin");
+	arch->unload();
+	OGRE_DELETE arch;
+	CPPUNIT_ASSERT(mBinary == readStream(other));
+	CPPUNIT_ASSERT(0 == memcmp(prebuffer.getPtr(), mBinary.c_str(), mBinary.size()));
+}
+
+void PackArchiveTests::testListAndFind()
+{
+	writeTestPack(1024, 6);
+	PackArchive arch(mPackName, "Pack");
+	arch.load();
+
+	StringVectorPtr vec = arch.list(false);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, vec->size());
+	CPPUNIT_ASSERT_EQUAL(String("text.txt"), vec->at(0));
+	CPPUNIT_ASSERT_EQUAL(String("random.bin"), vec->at(1));
+	CPPUNIT_ASSERT_EQUAL(String("empty.txt"), vec->at(2));
+
+	vec = arch.list(true);
+	CPPUNIT_ASSERT_EQUAL((size_t)4, vec->size());
+	CPPUNIT_ASSERT_EQUAL(String("level1/level2/nested.txt"), vec->at(3));
+
+	vec = arch.list(true, true);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, vec->size());
+	CPPUNIT_ASSERT_EQUAL(String("level1"), vec->at(0));
+	CPPUNIT_ASSERT_EQUAL(String("level1/level2"), vec->at(1));
+
+	vec = arch.find("*.txt", false);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, vec->size());
+	vec = arch.find("*.TXT", true);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, vec->size());
+	FileInfoListPtr files = arch.findFileInfo("level1/level2/*", false);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, files->size());
+	CPPUNIT_ASSERT_EQUAL(String("nested.txt"), files->at(0).basename);
+	CPPUNIT_ASSERT_EQUAL(String("level1/level2/"), files->at(0).path);
+}
+
+void PackArchiveTests::testNameLookup()
+{
+	// Enough files for plenty of hash collisions between them
+	PackArchiveWriter writer;
+	for (int i = 0; i < 500; ++i)
+	{
+		String name = "dir" + StringConverter::toString(i % 7) + "/file" + 
+			StringConverter::toString(i) + ".txt";
+		writer.addFile(name, createStream(name));
+	}
+	writer.write(mPackName);
+
+	PackArchive arch(mPackName, "Pack");
+	arch.load();
+	for (int i = 0; i < 500; ++i)
+	{
+		String name = "dir" + StringConverter::toString(i % 7) + "/file" + 
+			StringConverter::toString(i) + ".txt";
+		CPPUNIT_ASSERT(arch.exists(name));
+		CPPUNIT_ASSERT_EQUAL(name, readStream(arch.open(name)));
+	}
+	CPPUNIT_ASSERT(!arch.exists("dir0/file500.txt"));
+	CPPUNIT_ASSERT(!arch.exists("file0.txt"));
+
+	// Names are matched case insensitively, with either slash
+	CPPUNIT_ASSERT(arch.exists("DIR3\\File3.TXT"));
+	CPPUNIT_ASSERT_EQUAL(String("dir3/file3.txt"), readStream(arch.open("Dir3/FILE3.txt")));
+	CPPUNIT_ASSERT_THROW(arch.open("dir3/file4.txt"), Exception);
+}
+
+void PackArchiveTests::testParallelDecompress()
+{
+	// A file of many blocks, some of which compress and some don't
+	String contents;
+	for (int i = 0; i < 200; ++i)
+		contents += i % 3 ? mText : mBinary;
+
+	PackArchiveWriter writer(4096, 6);
+	writer.addFile("large.bin", createStream(contents));
+	writer.addFile("small.txt", createStream(mText));
+	writer.write(mPackName);
+
+	PackArchive arch(mPackName, "Pack");
+	arch.load();
+
+	size_t threshold = PackArchive::getParallelThreshold();
+	PackArchive::setParallelThreshold(0);
+	for (int i = 0; i < 4; ++i)
+	{
+		CPPUNIT_ASSERT(contents == readStream(arch.open("large.bin")));
+		CPPUNIT_ASSERT(mText == readStream(arch.open("small.txt")));
+	}
+	PackArchive::setParallelThreshold(threshold);
+	CPPUNIT_ASSERT(contents == readStream(arch.open("large.bin")));
+}
+
+void PackArchiveTests::testDuplicateName()
+{
+	PackArchiveWriter writer;
+	writer.addFile("file.txt", createStream(mText));
+	writer.addFile("FILE.TXT", createStream(mText));
+	CPPUNIT_ASSERT_THROW(writer.write(mPackName), Exception);
+}
+
+void PackArchiveTests::testInvalidFile()
+{
+	{
+		std::ofstream out(mPackName.c_str(), std::ios::binary);
+		out << "this is not a pack file, but it is long enough to hold a header";
+	}
+	PackArchive arch(mPackName, "Pack");
+	CPPUNIT_ASSERT_THROW(arch.load(), Exception);
+	CPPUNIT_ASSERT(!arch.exists("file.txt"));
+
+	// A truncated pack
+	writeTestPack(1024, 6);
+	String data;
+	{
+		std::ifstream in(mPackName.c_str(), std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	{
+		std::ofstream out(mPackName.c_str(), std::ios::binary);
+		out.write(data.c_str(), data.size() - 16);
+	}
+	CPPUNIT_ASSERT_THROW(arch.load(), Exception);
+}
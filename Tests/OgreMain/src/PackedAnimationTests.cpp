@@ -0,0 +1,331 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "PackedAnimationTests.h"
+#include "OgreRoot.h"
+#include "OgreSkeletonManager.h"
+#include "OgreSkeletonSerializer.h"
+#include "OgreBone.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "OgrePackedTransformTrack.h"
+#include "OgreDataStream.h"
+#include "OgreLogManager.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( PackedAnimationTests );
+
+/// Angle between 2 rotations, precise for small angles unlike Quaternion::equals
+static Real rotationError(const Quaternion& a, const Quaternion& b)
+{
+	Quaternion d = a.Dot(b) < 0 ? a + b : a - b;
+	return 4 * Math::ASin(std::min(Real(1), Math::Sqrt(d.Norm()) * 0.5f)).valueRadians();
+}
+
+/// Version string from the header of an exported skeleton file
+static String readSkeletonVersion(const String& fileName)
+{
+	std::ifstream f(fileName.c_str(), std::ios::binary);
+	f.ignore(sizeof(uint16));
+	String version;
+	std::getline(f, version);
+	return version;
+}
+
+void PackedAnimationTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+}
+void PackedAnimationTests::tearDown()
+{
+	mSkeleton.setNull();
+	OGRE_DELETE mRoot;
+}
+
+void PackedAnimationTests::createSkeleton(Animation::InterpolationMode im)
+{
+	mSkeleton = SkeletonManager::getSingleton().create("PackedTestSkeleton",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+
+	const unsigned short numBones = 4;
+	const Real length = 4.0f;
+	const size_t numKeys = 121;
+	Animation* anim = mSkeleton->createAnimation("Walk", length);
+	anim->setInterpolationMode(im);
+	for (unsigned short b = 0; b < numBones; ++b)
+	{
+		Bone* bone = mSkeleton->createBone(b);
+		NodeAnimationTrack* track = anim->createNodeTrack(b, bone);
+		// Smooth, looping motion sampled every frame, as exporters do
+		Real phase = b * 0.7f;
+		for (size_t k = 0; k < numKeys; ++k)
+		{
+			Real t = length * k / (numKeys - 1);
+			Real w = Math::TWO_PI * t / length;
+			TransformKeyFrame* kf = track->createNodeKeyFrame(t);
+			kf->setTranslate(Vector3(Math::Sin(w + phase), 
+				0.5f * Math::Cos(2 * w + phase), 0.25f * Math::Sin(w)));
+			kf->setRotation(
+				Quaternion(Radian(Math::Sin(w + phase) * 1.2f), Vector3::UNIT_Y) *
+				Quaternion(Radian(0.3f * Math::Cos(w)), Vector3::UNIT_X));
+			// Bone 0 scales, the others don't
+			kf->setScale(b == 0 ? Vector3::UNIT_SCALE * (1.0f + 0.2f * Math::Sin(w)) : 
+				Vector3::UNIT_SCALE);
+		}
+	}
+}
+
+void PackedAnimationTests::checkAnimationsMatch(const Animation* a, const Animation* b,
+	Real translationTolerance, Real rotationTolerance, Real scaleTolerance)
+{
+	Animation::NodeTrackIterator it = a->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		NodeAnimationTrack* ta = it.getNext();
+		NodeAnimationTrack* tb = b->getNodeTrack(ta->getHandle());
+		for (Real t = 0; t <= a->getLength(); t += 0.0123f)
+		{
+			TransformKeyFrame ka(0, t), kb(0, t);
+			ta->getInterpolatedKeyFrame(TimeIndex(t), &ka);
+			tb->getInterpolatedKeyFrame(TimeIndex(t), &kb);
+
+			CPPUNIT_ASSERT(ka.getTranslate().distance(kb.getTranslate()) <= translationTolerance);
+			CPPUNIT_ASSERT(ka.getScale().distance(kb.getScale()) <= scaleTolerance);
+			CPPUNIT_ASSERT(rotationError(ka.getRotation(), kb.getRotation()) <= rotationTolerance);
+		}
+	}
+}
+
+void PackedAnimationTests::testRotationEncoding()
+{
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		Vector3 axis(Math::SymmetricRandom(), Math::SymmetricRandom(), Math::SymmetricRandom());
+		if (axis.isZeroLength())
+			axis = Vector3::UNIT_Z;
+		axis.normalise();
+		Quaternion q(Radian(Math::RangeRandom(-Math::PI, Math::PI)), axis);
+
+		uint16 values[3];
+		PackedTransformTrack::packRotation(q, values);
+		Quaternion r = PackedTransformTrack::unpackRotation(values);
+
+		// Same rotation, though possibly the negated quaternion
+		CPPUNIT_ASSERT(Math::Abs(r.Norm() - 1.0f) < 1e-4f);
+		CPPUNIT_ASSERT(rotationError(q, r) < 2e-4f);
+	}
+}
+
+void PackedAnimationTests::checkPackedWithinTolerance(Animation::InterpolationMode im)
+{
+	createSkeleton(im);
+	Animation* anim = mSkeleton->getAnimation("Walk");
+	Animation* original = anim->clone("Original");
+
+	const Real tolerance = 0.001f;
+	mSkeleton->packAllAnimations(tolerance, Radian(tolerance), tolerance);
+
+	Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		NodeAnimationTrack* track = it.getNext();
+		CPPUNIT_ASSERT(track->isPacked());
+		CPPUNIT_ASSERT_EQUAL((unsigned short)0, track->getNumKeyFrames());
+		// Constant scale needs only one key
+		if (track->getHandle() != 0)
+		{
+			CPPUNIT_ASSERT_EQUAL((size_t)1, 
+				track->getPackedData()->getNumKeys(PackedTransformTrack::CT_SCALE));
+		}
+	}
+
+	// Packing is checked at and between the keys; allow a little more 
+	// between the points it checked
+	checkAnimationsMatch(original, anim, tolerance * 2, tolerance * 2, tolerance * 2);
+
+	// Applying a packed track works as before
+	Bone* bone = mSkeleton->getBone(1);
+	bone->reset();
+	anim->getNodeTrack(1)->applyToNode(bone, TimeIndex(1.3f));
+	Vector3 packedPos = bone->getPosition();
+	Quaternion packedRot = bone->getOrientation();
+	bone->reset();
+	original->getNodeTrack(1)->applyToNode(bone, TimeIndex(1.3f));
+	CPPUNIT_ASSERT(packedPos.positionEquals(bone->getPosition(), tolerance * 2));
+	CPPUNIT_ASSERT(rotationError(packedRot, bone->getOrientation()) <= tolerance * 2);
+
+	OGRE_DELETE original;
+}
+
+void PackedAnimationTests::testPackedWithinTolerance()
+{
+	checkPackedWithinTolerance(Animation::IM_LINEAR);
+}
+
+void PackedAnimationTests::testPackedSplineWithinTolerance()
+{
+	checkPackedWithinTolerance(Animation::IM_SPLINE);
+}
+
+void PackedAnimationTests::testMemoryReduction()
+{
+	createSkeleton(Animation::IM_LINEAR);
+	Animation* anim = mSkeleton->getAnimation("Walk");
+
+	size_t originalSize = 0;
+	Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		// Heap overheads aside, each key is an object and a pointer to it
+		originalSize += it.getNext()->getNumKeyFrames() * 
+			(sizeof(TransformKeyFrame) + sizeof(KeyFrame*));
+	}
+
+	mSkeleton->packAllAnimations(0.005f, Radian(0.005f), 0.005f);
+
+	size_t packedSize = 0;
+	it = anim->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		packedSize += it.getNext()->getPackedData()->calculateSize();
+	}
+
+	StringUtil::StrStreamType str;
+	str << "Packed animation: " << originalSize << " bytes down to " << packedSize;
+	LogManager::getSingleton().logMessage(str.str());
+
+	CPPUNIT_ASSERT(packedSize * 5 <= originalSize);
+}
+
+void PackedAnimationTests::testSerializerRoundTrip()
+{
+	createSkeleton(Animation::IM_LINEAR);
+	mSkeleton->packAllAnimations();
+
+	String fileName = "PackedAnimationTests.skeleton";
+	SkeletonSerializer serializer;
+	serializer.exportSkeleton(mSkeleton.get(), fileName);
+
+	SkeletonPtr loaded = SkeletonManager::getSingleton().create("PackedTestSkeletonLoaded",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+	std::ifstream* f = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+		fileName.c_str(), std::ios::binary);
+	DataStreamPtr stream(OGRE_NEW FileStreamDataStream(f));
+	serializer.importSkeleton(stream, loaded.get());
+	stream->close();
+	remove(fileName.c_str());
+
+	Animation* anim = mSkeleton->getAnimation("Walk");
+	Animation* loadedAnim = loaded->getAnimation("Walk");
+	CPPUNIT_ASSERT_EQUAL(anim->getNumNodeTracks(), loadedAnim->getNumNodeTracks());
+
+	Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		NodeAnimationTrack* track = it.getNext();
+		NodeAnimationTrack* loadedTrack = loadedAnim->getNodeTrack(track->getHandle());
+		CPPUNIT_ASSERT(loadedTrack->isPacked());
+		for (int c = 0; c < PackedTransformTrack::CT_COUNT; ++c)
+		{
+			PackedTransformTrack::ChannelType type = 
+				static_cast<PackedTransformTrack::ChannelType>(c);
+			const PackedTransformTrack::Channel& a = track->getPackedData()->getChannel(type);
+			const PackedTransformTrack::Channel& b = loadedTrack->getPackedData()->getChannel(type);
+			CPPUNIT_ASSERT(a.times == b.times);
+			CPPUNIT_ASSERT(a.values == b.values);
+			CPPUNIT_ASSERT(a.base == b.base);
+			CPPUNIT_ASSERT(a.range == b.range);
+		}
+	}
+
+	checkAnimationsMatch(anim, loadedAnim, 0, 0, 0);
+
+	SkeletonManager::getSingleton().remove(loaded->getHandle());
+}
+
+void PackedAnimationTests::testSerializerVersion()
+{
+	createSkeleton(Animation::IM_LINEAR);
+	String fileName = "PackedAnimationTests.skeleton";
+	SkeletonSerializer serializer;
+
+	// Without packed tracks older builds must still be able to read it
+	serializer.exportSkeleton(mSkeleton.get(), fileName);
+	CPPUNIT_ASSERT_EQUAL(String("[Serializer_v1.10]"), readSkeletonVersion(fileName));
+
+	SkeletonPtr loaded = SkeletonManager::getSingleton().create("PackedTestSkeletonLoaded",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+	std::ifstream* f = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+		fileName.c_str(), std::ios::binary);
+	DataStreamPtr stream(OGRE_NEW FileStreamDataStream(f));
+	serializer.importSkeleton(stream, loaded.get());
+	stream->close();
+	CPPUNIT_ASSERT_EQUAL(mSkeleton->getNumAnimations(), loaded->getNumAnimations());
+	SkeletonManager::getSingleton().remove(loaded->getHandle());
+
+	mSkeleton->packAllAnimations();
+	serializer.exportSkeleton(mSkeleton.get(), fileName);
+	CPPUNIT_ASSERT_EQUAL(String("[Serializer_v1.20]"), readSkeletonVersion(fileName));
+	remove(fileName.c_str());
+}
+
+void PackedAnimationTests::testKeyTimesReproduceTrack()
+{
+	createSkeleton(Animation::IM_LINEAR);
+	mSkeleton->packAllAnimations(0.005f, Radian(0.005f), 0.005f);
+	Animation* anim = mSkeleton->getAnimation("Walk");
+
+	// Turn the packed tracks back into keyframes, as the XML exporter does
+	Animation* unpacked = mSkeleton->createAnimation("Unpacked", anim->getLength());
+	Animation::NodeTrackIterator it = anim->getNodeTrackIterator();
+	while (it.hasMoreElements())
+	{
+		NodeAnimationTrack* track = it.getNext();
+		NodeAnimationTrack* unpackedTrack = unpacked->createNodeTrack(
+			track->getHandle(), track->getAssociatedNode());
+		const PackedTransformTrack* packed = track->getPackedData();
+		vector<Real>::type times;
+		packed->getKeyTimes(times);
+		CPPUNIT_ASSERT(!times.empty());
+		for (size_t i = 0; i < times.size(); ++i)
+		{
+			if (i)
+				CPPUNIT_ASSERT(times[i - 1] < times[i]);
+			TransformKeyFrame key(0, times[i]);
+			packed->sample(times[i], anim->getLength(), 
+				anim->getRotationInterpolationMode(), &key);
+			TransformKeyFrame* kf = unpackedTrack->createNodeKeyFrame(times[i]);
+			kf->setTranslate(key.getTranslate());
+			kf->setRotation(key.getRotation());
+			kf->setScale(key.getScale());
+		}
+	}
+
+	// Only the rotations differ, as they are normalised along the way
+	checkAnimationsMatch(anim, unpacked, 1e-4f, 1e-3f, 1e-4f);
+}
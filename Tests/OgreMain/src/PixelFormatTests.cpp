@@ -26,7 +26,11 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 #include "PixelFormatTests.h"
+#include "OgreBitwise.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
 #include <cstdlib>
+#include <limits>
 
 // Register the suite
 CPPUNIT_TEST_SUITE_REGISTRATION( PixelFormatTests );
@@ -227,3 +231,161 @@ void PixelFormatTests::testBulkConversion()
     //CPPUNIT_ASSERT_MESSAGE("Conversion mismatch", false);
 }
 
+
+// Pairs with a SIMD kernel, and the kernel sets to try them with
+static const PixelFormat kernelPairs[][2] =
+{
+    { PF_A8R8G8B8, PF_A8B8G8R8 },
+    { PF_A8B8G8R8, PF_A8R8G8B8 },
+    { PF_R8G8B8A8, PF_B8G8R8A8 },
+    { PF_A8R8G8B8, PF_R8G8B8A8 },
+    { PF_X8R8G8B8, PF_A8B8G8R8 },
+    { PF_R8G8B8, PF_A8R8G8B8 },
+    { PF_B8G8R8, PF_A8B8G8R8 },
+    { PF_R8G8B8, PF_B8G8R8A8 },
+    { PF_L8, PF_A8R8G8B8 },
+    { PF_L8, PF_R8G8B8A8 },
+    { PF_A8, PF_A8B8G8R8 },
+    { PF_BYTE_LA, PF_A8R8G8B8 },
+    { PF_A8R8G8B8, PF_FLOAT32_RGBA },
+    { PF_X8B8G8R8, PF_FLOAT32_RGBA },
+    { PF_FLOAT32_RGBA, PF_A8B8G8R8 },
+    { PF_FLOAT32_RGBA, PF_B8G8R8A8 },
+    { PF_FLOAT32_R, PF_FLOAT16_R },
+    { PF_FLOAT32_GR, PF_FLOAT16_GR },
+    { PF_FLOAT32_RGB, PF_FLOAT16_RGB },
+    { PF_FLOAT32_RGBA, PF_FLOAT16_RGBA },
+    { PF_FLOAT16_R, PF_FLOAT32_R },
+    { PF_FLOAT16_RGB, PF_FLOAT32_RGB },
+    { PF_FLOAT16_RGBA, PF_FLOAT32_RGBA }
+};
+static const size_t numKernelPairs = sizeof(kernelPairs) / sizeof(kernelPairs[0]);
+static const char* kernelNames[] = { "None", "SSE2", "AVX2" };
+static const PixelUtil::ConversionKernels kernelSets[] =
+    { PixelUtil::CK_NONE, PixelUtil::CK_SSE2, PixelUtil::CK_AVX2 };
+
+void PixelFormatTests::testSubVolumeCase(PixelFormat srcFormat, PixelFormat dstFormat)
+{
+    // A box which is neither at the origin nor a whole row long, in a
+    // buffer full of random data, so that the kernels go a row at a time
+    const size_t width = 23, height = 5, depth = 2;
+    const size_t srcBytes = width * height * depth * PixelUtil::getNumElemBytes(srcFormat);
+    const size_t dstBytes = width * height * depth * PixelUtil::getNumElemBytes(dstFormat);
+    CPPUNIT_ASSERT(srcBytes <= (size_t)size && dstBytes <= (size_t)size);
+    memcpy(temp, randomData, size);
+    memcpy(temp2, randomData, size);
+
+    const Box box(3, 1, 0, 20, 4, 2);
+    PixelBox srcBox(width, height, depth, srcFormat, randomData);
+    PixelBox dstBox(width, height, depth, dstFormat, temp);
+    PixelUtil::bulkPixelConversion(srcBox.getSubVolume(box), dstBox.getSubVolume(box));
+
+    const PixelUtil::ConversionKernels kernels = PixelUtil::_getConversionKernels();
+    PixelUtil::_setConversionKernels(PixelUtil::CK_NONE);
+    dstBox.data = temp2;
+    PixelUtil::bulkPixelConversion(srcBox.getSubVolume(box), dstBox.getSubVolume(box));
+    PixelUtil::_setConversionKernels(kernels);
+
+    StringUtil::StrStreamType msg;
+    msg << "Sub volume mismatch [" << PixelUtil::getFormatName(srcFormat) <<
+        "->" << PixelUtil::getFormatName(dstFormat) << "]";
+    CPPUNIT_ASSERT_MESSAGE(msg.str().c_str(), memcmp(temp, temp2, size) == 0);
+}
+
+void PixelFormatTests::testKernelConversion()
+{
+    const PixelUtil::ConversionKernels best = PixelUtil::_getConversionKernels();
+    for (size_t k = 0; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+    {
+        if (!PixelUtil::_setConversionKernels(kernelSets[k]))
+            continue;
+
+        for (size_t p = 0; p < numKernelPairs; ++p)
+        {
+            testCase(kernelPairs[p][0], kernelPairs[p][1]);
+            testSubVolumeCase(kernelPairs[p][0], kernelPairs[p][1]);
+        }
+
+        // The values which need care going to half floats, and every half
+        // float coming back
+        float special[] = { 0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65520.0f, 1e10f,
+            -1e-5f, 6e-8f, 3e-8f, 1e-20f, 5.96046448e-08f, 6.10351562e-05f,
+            std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+            std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min() };
+        const size_t numSpecial = sizeof(special) / sizeof(special[0]);
+        uint16 halves[numSpecial];
+        PixelUtil::bulkPixelConversion(special, PF_FLOAT32_R, halves, PF_FLOAT16_R, numSpecial);
+        for (size_t i = 0; i < numSpecial; ++i)
+            CPPUNIT_ASSERT_EQUAL(Bitwise::floatToHalf(special[i]), halves[i]);
+
+        vector<uint16>::type allHalves(65536);
+        vector<uint32>::type floats(65536);
+        for (size_t i = 0; i < 65536; ++i)
+            allHalves[i] = (uint16)i;
+        PixelUtil::bulkPixelConversion(&allHalves[0], PF_FLOAT16_R, &floats[0], PF_FLOAT32_R, 65536);
+        for (size_t i = 0; i < 65536; ++i)
+            CPPUNIT_ASSERT_EQUAL(Bitwise::halfToFloatI((uint16)i), floats[i]);
+    }
+    PixelUtil::_setConversionKernels(best);
+}
+
+void PixelFormatTests::testConversionBenchmark()
+{
+    LogManager* logMgr = 0;
+    if (!LogManager::getSingletonPtr())
+    {
+        logMgr = OGRE_NEW LogManager();
+        logMgr->createLog("PixelFormatTests.log", true, false);
+    }
+
+    const size_t width = 1024, height = 1024;
+    const size_t iterations = 4;
+    // Big enough for the largest format, 4 floats a pixel
+    vector<uint8>::type srcData(width * height * 16), dstData(width * height * 16);
+    for (size_t i = 0; i < srcData.size(); ++i)
+        srcData[i] = (uint8)rand();
+
+    const PixelUtil::ConversionKernels best = PixelUtil::_getConversionKernels();
+    Timer timer;
+    for (size_t p = 0; p < numKernelPairs; ++p)
+    {
+        const PixelFormat srcFormat = kernelPairs[p][0], dstFormat = kernelPairs[p][1];
+        // Floats in range, so that no kernel takes a shortcut over the others
+        if (PixelUtil::isFloatingPoint(srcFormat))
+        {
+            const bool halves = PixelUtil::getComponentType(srcFormat) == PCT_FLOAT16;
+            const size_t count = width * height * PixelUtil::getComponentCount(srcFormat);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const float f = (float)rand() / RAND_MAX;
+                if (!halves)
+                    ((float*)&srcData[0])[i] = f;
+                else
+                    ((uint16*)&srcData[0])[i] = Bitwise::floatToHalf(f);
+            }
+        }
+        const PixelBox src(width, height, 1, srcFormat, &srcData[0]);
+        const PixelBox dst(width, height, 1, dstFormat, &dstData[0]);
+
+        StringUtil::StrStreamType msg;
+        msg << "PixelFormatTests: " << PixelUtil::getFormatName(srcFormat) << "->" <<
+            PixelUtil::getFormatName(dstFormat) << " MB/s (source):";
+        for (size_t k = 0; k < sizeof(kernelSets) / sizeof(kernelSets[0]); ++k)
+        {
+            if (!PixelUtil::_setConversionKernels(kernelSets[k]))
+                continue;
+
+            timer.reset();
+            for (size_t it = 0; it < iterations; ++it)
+                PixelUtil::bulkPixelConversion(src, dst);
+            const unsigned long us = std::max(1ul, timer.getMicroseconds());
+            msg << " " << kernelNames[k] << " " <<
+                (double)src.getConsecutiveSize() * iterations / us;
+        }
+        LogManager::getSingleton().stream() << msg.str();
+    }
+    PixelUtil::_setConversionKernels(best);
+
+    if (logMgr)
+        OGRE_DELETE logMgr;
+}
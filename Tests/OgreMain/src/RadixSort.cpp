@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include "RadixSortTests.h"
 #include "OgreRadixSort.h"
 #include "OgreMath.h"
+#include "OgreTimer.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
 
 using namespace Ogre;
 
@@ -202,3 +205,218 @@ void RadixSortTests::testIntVector()
 }
 
 
+
+/// Stand-in for a queued renderable: a pass hash and a view depth
+struct SortItem
+{
+	uint32 hash;
+	float depth;
+	/// Position in the original list, to check stability
+	int index;
+};
+class SortItemHashFunctor
+{
+public:
+	uint32 operator()(const SortItem& p) const
+	{
+		return p.hash;
+	}
+};
+class SortItemDepthFunctor
+{
+public:
+	float operator()(const SortItem& p) const
+	{
+		return -p.depth;
+	}
+};
+class SortItemCombinedFunctor
+{
+public:
+	uint64 operator()(const SortItem& p) const
+	{
+		uint64 depth = RadixSortKeyTraits<float>::toUnsigned(-p.depth);
+		return (depth << 32) | p.hash;
+	}
+};
+/// Descending depth, then ascending hash
+struct SortItemLess
+{
+	bool operator()(const SortItem& a, const SortItem& b) const
+	{
+		if (a.depth != b.depth)
+			return a.depth > b.depth;
+		return a.hash < b.hash;
+	}
+};
+typedef std::vector<SortItem> SortItemList;
+
+static void fillSortItems(SortItemList& items, size_t count)
+{
+	items.resize(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		// Few distinct hashes and depths, so there are plenty of ties. Zero
+		// is avoided since -0 and +0 compare equal but have different keys.
+		items[i].hash = (uint32)Math::RangeRandom(0, 64) * 0x01000193;
+		items[i].depth = (float)(int)Math::RangeRandom(1, 1000) * 0.5f;
+		items[i].index = (int)i;
+	}
+}
+
+void RadixSortTests::testRadixSort11Float()
+{
+	std::vector<float> container;
+	FloatSortFunctor func;
+	RadixSort11<std::vector<float>, float, float> sorter;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		container.push_back((float)Math::RangeRandom(-1e10, 1e10));
+	}
+	// Signed zeroes and small values either side of zero
+	container.push_back(0.0f);
+	container.push_back(-0.0f);
+	container.push_back(1e-30f);
+	container.push_back(-1e-30f);
+
+	sorter.sort(container, func);
+
+	std::vector<float>::iterator v = container.begin();
+	float lastValue = *v++;
+	for (;v != container.end(); ++v)
+	{
+		CPPUNIT_ASSERT(*v >= lastValue);
+		lastValue = *v;
+	}
+}
+void RadixSortTests::testRadixSort11IntList()
+{
+	std::list<int> container;
+	IntSortFunctor func;
+	RadixSort11<std::list<int>, int, int> sorter;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		container.push_back((int)Math::RangeRandom(-1e10, 1e10));
+	}
+
+	sorter.sort(container, func);
+
+	std::list<int>::iterator v = container.begin();
+	int lastValue = *v++;
+	for (;v != container.end(); ++v)
+	{
+		CPPUNIT_ASSERT(*v >= lastValue);
+		lastValue = *v;
+	}
+}
+void RadixSortTests::testRadixSort11UnsignedInt()
+{
+	std::vector<unsigned int> container;
+	UnsignedIntSortFunctor func;
+	RadixSort11<std::vector<unsigned int>, unsigned int, unsigned int> sorter;
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		container.push_back((unsigned int)Math::RangeRandom(0, 1e10));
+	}
+	std::vector<unsigned int> expected = container;
+	std::stable_sort(expected.begin(), expected.end());
+
+	sorter.sort(container, func);
+	CPPUNIT_ASSERT(container == expected);
+
+	// Already sorted is left alone
+	sorter.sort(container, func);
+	CPPUNIT_ASSERT(container == expected);
+}
+void RadixSortTests::testRadixSort11CombinedKey()
+{
+	SortItemList items;
+	fillSortItems(items, 5000);
+	// Include negative depths too
+	for (size_t i = 0; i < items.size(); i += 7)
+		items[i].depth = -items[i].depth;
+
+	SortItemList expected = items;
+	std::stable_sort(expected.begin(), expected.end(), SortItemLess());
+
+	RadixSort11<SortItemList, SortItem, uint64> sorter;
+	sorter.sort(items, SortItemCombinedFunctor());
+
+	// One stable sort on the combined key is the same as a stable sort on 
+	// depth then hash, including the order of equal items
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		CPPUNIT_ASSERT_EQUAL(expected[i].index, items[i].index);
+	}
+}
+void RadixSortTests::testThroughputBenchmark()
+{
+	LogManager* logMgr = 0;
+	if (!LogManager::getSingletonPtr())
+	{
+		logMgr = OGRE_NEW LogManager();
+		logMgr->createLog("RadixSortTests.log", true, false);
+	}
+
+	const size_t count = 100000;
+	const int iterations = 20;
+	SortItemList source, items;
+	fillSortItems(source, count);
+	Timer timer;
+
+	// Two keys: what QueuedRenderableCollection used to do, then what it does now
+	unsigned long stableUs = 0, twoPassUs = 0, combinedUs = 0;
+	RadixSort<SortItemList, SortItem, uint32> hashSorter;
+	RadixSort<SortItemList, SortItem, float> depthSorter;
+	RadixSort11<SortItemList, SortItem, uint64> combinedSorter;
+	for (int i = 0; i < iterations; ++i)
+	{
+		items = source;
+		timer.reset();
+		std::stable_sort(items.begin(), items.end(), SortItemLess());
+		stableUs += timer.getMicroseconds();
+
+		items = source;
+		timer.reset();
+		hashSorter.sort(items, SortItemHashFunctor());
+		depthSorter.sort(items, SortItemDepthFunctor());
+		twoPassUs += timer.getMicroseconds();
+
+		items = source;
+		timer.reset();
+		combinedSorter.sort(items, SortItemCombinedFunctor());
+		combinedUs += timer.getMicroseconds();
+	}
+	LogManager::getSingleton().stream() << "RadixSortTests: " << count 
+		<< " items by depth then pass: stable_sort " << (stableUs / iterations)
+		<< " us, 2 x RadixSort " << (twoPassUs / iterations) 
+		<< " us, RadixSort11 64-bit key " << (combinedUs / iterations) << " us";
+
+	// One 32-bit key
+	std::vector<unsigned int> uintSource, uints;
+	for (size_t i = 0; i < count; ++i)
+		uintSource.push_back((unsigned int)Math::RangeRandom(0, 1e10));
+	unsigned long radix8Us = 0, radix11Us = 0;
+	RadixSort<std::vector<unsigned int>, unsigned int, unsigned int> sorter8;
+	RadixSort11<std::vector<unsigned int>, unsigned int, unsigned int> sorter11;
+	for (int i = 0; i < iterations; ++i)
+	{
+		uints = uintSource;
+		timer.reset();
+		sorter8.sort(uints, UnsignedIntSortFunctor());
+		radix8Us += timer.getMicroseconds();
+
+		uints = uintSource;
+		timer.reset();
+		sorter11.sort(uints, UnsignedIntSortFunctor());
+		radix11Us += timer.getMicroseconds();
+	}
+	LogManager::getSingleton().stream() << "RadixSortTests: " << count 
+		<< " 32-bit keys: RadixSort " << (radix8Us / iterations)
+		<< " us, RadixSort11 " << (radix11Us / iterations) << " us";
+
+	OGRE_DELETE logMgr;
+}
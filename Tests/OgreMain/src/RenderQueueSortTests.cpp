@@ -0,0 +1,469 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "RenderQueueSortTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreMaterialManager.h"
+#include "OgreRenderQueue.h"
+#include "OgreRenderQueueSortingGrouping.h"
+#include "OgreTimer.h"
+#include "OgreLogManager.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( RenderQueueSortTests );
+
+/// Renderable at a fixed view depth
+class FixedDepthRenderable : public Renderable, public RenderQueueAlloc
+{
+protected:
+	MaterialPtr mMaterial;
+	Real mDepth;
+	LightList mLights;
+public:
+	/// Number of calls to getSquaredViewDepth, which must all be on one thread
+	mutable size_t mDepthQueries;
+
+	FixedDepthRenderable(const MaterialPtr& mat, Real depth)
+		: mMaterial(mat), mDepth(depth), mDepthQueries(0) {}
+	const MaterialPtr& getMaterial(void) const { return mMaterial; }
+	void getRenderOperation(RenderOperation& op) {}
+	void getWorldTransforms(Matrix4* xform) const { *xform = Matrix4::IDENTITY; }
+	Real getSquaredViewDepth(const Camera* cam) const { ++mDepthQueries; return mDepth; }
+	const LightList& getLights(void) const { return mLights; }
+};
+
+/// Visitor which records what it is called with
+class RecordingVisitor : public QueuedRenderableVisitor
+{
+public:
+	typedef vector<RenderablePass>::type VisitList;
+	VisitList visits;
+	size_t passVisits;
+	const Pass* skipPass;
+	Pass* currentPass;
+
+	RecordingVisitor() : passVisits(0), skipPass(0), currentPass(0) {}
+	void visit(RenderablePass* rp)
+	{
+		visits.push_back(*rp);
+	}
+	bool visit(const Pass* p)
+	{
+		++passVisits;
+		currentPass = const_cast<Pass*>(p);
+		return p != skipPass;
+	}
+	void visit(Renderable* r)
+	{
+		visits.push_back(RenderablePass(r, currentPass));
+	}
+};
+
+/// Order items by pointers, to compare what was visited
+struct RenderablePassPointerLess
+{
+	bool operator()(const RenderablePass& a, const RenderablePass& b) const
+	{
+		if (a.renderable != b.renderable)
+			return a.renderable < b.renderable;
+		return a.pass < b.pass;
+	}
+};
+
+void RenderQueueSortTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mBufMgr = OGRE_NEW DefaultHardwareBufferManager();
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+	mCamera = mSceneMgr->createCamera("cam");
+	// Same seed every time so that failures can be reproduced
+	srand(12345);
+}
+void RenderQueueSortTests::tearDown()
+{
+	for (vector<Renderable*>::type::iterator i = mRenderables.begin(); i != mRenderables.end(); ++i)
+		OGRE_DELETE static_cast<FixedDepthRenderable*>(*i);
+	mRenderables.clear();
+	mPasses.clear();
+	mMaterials.clear();
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mBufMgr;
+}
+
+void RenderQueueSortTests::createPasses(size_t numMaterials)
+{
+	// Passes without textures, so that many share a hash and only the 
+	// material tells them apart
+	for (size_t i = 0; i < numMaterials; ++i)
+	{
+		MaterialPtr mat = MaterialManager::getSingleton().create(
+			"RenderQueueSortTests" + StringConverter::toString(i), 
+			ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+		mMaterials.push_back(mat);
+		// No defaults are applied without Root::initialise
+		Technique* tech = mat->createTechnique();
+		tech->createPass();
+		if (i % 3 == 0)
+			tech->createPass();
+		for (unsigned short p = 0; p < tech->getNumPasses(); ++p)
+			mPasses.push_back(tech->getPass(p));
+	}
+}
+
+void RenderQueueSortTests::createRenderables(size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		// Plenty of items at the same depth
+		Real depth = (Real)(int)Math::RangeRandom(0, 100) * 25.0f;
+		mRenderables.push_back(OGRE_NEW FixedDepthRenderable(
+			mMaterials[rand() % mMaterials.size()], depth));
+	}
+}
+
+void RenderQueueSortTests::testKeyedOrder()
+{
+	createPasses(50);
+	createRenderables(3000);
+
+	QueuedRenderableCollection keyed;
+	keyed.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	RecordingVisitor::VisitList added;
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+	{
+		// All the passes of the renderable's material, as the queue does
+		Technique* tech = mRenderables[i]->getMaterial()->getTechnique(0);
+		for (unsigned short p = 0; p < tech->getNumPasses(); ++p)
+		{
+			keyed.addRenderable(tech->getPass(p), mRenderables[i]);
+			added.push_back(RenderablePass(mRenderables[i], tech->getPass(p)));
+		}
+	}
+	keyed.sort(mCamera);
+	CPPUNIT_ASSERT(!keyed.isSortRequired(mCamera));
+
+	RecordingVisitor visitor;
+	keyed.acceptVisitor(&visitor, QueuedRenderableCollection::OM_SORT_KEYED);
+
+	// Every item visited exactly once
+	CPPUNIT_ASSERT_EQUAL(added.size(), visitor.visits.size());
+	RecordingVisitor::VisitList visited = visitor.visits;
+	std::sort(added.begin(), added.end(), RenderablePassPointerLess());
+	std::sort(visited.begin(), visited.end(), RenderablePassPointerLess());
+	for (size_t i = 0; i < added.size(); ++i)
+	{
+		CPPUNIT_ASSERT(added[i].renderable == visited[i].renderable);
+		CPPUNIT_ASSERT(added[i].pass == visited[i].pass);
+	}
+
+	// Each pass visited once, with its renderables nearest first
+	CPPUNIT_ASSERT_EQUAL(mPasses.size(), visitor.passVisits);
+	for (size_t i = 1; i < visitor.visits.size(); ++i)
+	{
+		const RenderablePass& prev = visitor.visits[i - 1];
+		const RenderablePass& cur = visitor.visits[i];
+		if (prev.pass == cur.pass)
+		{
+			CPPUNIT_ASSERT(prev.renderable->getSquaredViewDepth(mCamera) <= 
+				cur.renderable->getSquaredViewDepth(mCamera));
+		}
+		else
+		{
+			CPPUNIT_ASSERT(prev.pass->getHash() <= cur.pass->getHash());
+		}
+	}
+}
+
+void RenderQueueSortTests::testDepthsCalculatedUpFront()
+{
+	createPasses(10);
+	// Sizes either side of the switch from stable_sort to the radix sort
+	size_t counts[] = { 300, 2500 };
+	for (size_t c = 0; c < 2; ++c)
+	{
+		createRenderables(counts[c]);
+		QueuedRenderableCollection sorted;
+		sorted.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+		sorted.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+			sorted.addRenderable(mRenderables[i]->getMaterial()->getTechnique(0)->getPass(0), mRenderables[i]);
+
+		// Sorting on another thread must not call the renderables at all
+		sorted._calculateSortDepths(mCamera);
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+		{
+			FixedDepthRenderable* r = static_cast<FixedDepthRenderable*>(mRenderables[i]);
+			CPPUNIT_ASSERT_EQUAL((size_t)2, r->mDepthQueries);
+			r->mDepthQueries = 0;
+		}
+		sorted.sort(mCamera);
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+			CPPUNIT_ASSERT_EQUAL((size_t)0, static_cast<FixedDepthRenderable*>(mRenderables[i])->mDepthQueries);
+
+		RecordingVisitor visitor;
+		sorted.acceptVisitor(&visitor, QueuedRenderableCollection::OM_SORT_DESCENDING);
+		CPPUNIT_ASSERT_EQUAL(mRenderables.size(), visitor.visits.size());
+		for (size_t i = 1; i < visitor.visits.size(); ++i)
+		{
+			const RenderablePass& prev = visitor.visits[i - 1];
+			const RenderablePass& cur = visitor.visits[i];
+			Real prevDepth = prev.renderable->getSquaredViewDepth(mCamera);
+			Real curDepth = cur.renderable->getSquaredViewDepth(mCamera);
+			CPPUNIT_ASSERT(prevDepth >= curDepth);
+			if (prevDepth == curDepth && c == 1)
+				CPPUNIT_ASSERT(prev.pass->getHash() <= cur.pass->getHash());
+		}
+
+		// Adding an item means the depths are asked for again
+		sorted.addRenderable(mPasses[0], mRenderables[0]);
+		FixedDepthRenderable* first = static_cast<FixedDepthRenderable*>(mRenderables[0]);
+		first->mDepthQueries = 0;
+		sorted.sort(mCamera);
+		CPPUNIT_ASSERT(first->mDepthQueries > 0);
+
+		for (vector<Renderable*>::type::iterator i = mRenderables.begin(); i != mRenderables.end(); ++i)
+			OGRE_DELETE static_cast<FixedDepthRenderable*>(*i);
+		mRenderables.clear();
+	}
+}
+
+void RenderQueueSortTests::testKeyedFallback()
+{
+	createPasses(5);
+	createRenderables(100);
+
+	QueuedRenderableCollection keyed;
+	keyed.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+		keyed.addRenderable(mRenderables[i]->getMaterial()->getTechnique(0)->getPass(0), mRenderables[i]);
+	keyed.sort(mCamera);
+
+	// Scene managers ask for pass groups, and get the keyed order instead
+	RecordingVisitor keyedVisitor, groupVisitor;
+	keyed.acceptVisitor(&keyedVisitor, QueuedRenderableCollection::OM_SORT_KEYED);
+	keyed.acceptVisitor(&groupVisitor, QueuedRenderableCollection::OM_PASS_GROUP);
+	CPPUNIT_ASSERT_EQUAL(keyedVisitor.visits.size(), groupVisitor.visits.size());
+	CPPUNIT_ASSERT_EQUAL(keyedVisitor.passVisits, groupVisitor.passVisits);
+	for (size_t i = 0; i < keyedVisitor.visits.size(); ++i)
+	{
+		CPPUNIT_ASSERT(keyedVisitor.visits[i].renderable == groupVisitor.visits[i].renderable);
+	}
+
+	// Skipping a pass skips its renderables
+	RecordingVisitor skipVisitor;
+	skipVisitor.skipPass = keyedVisitor.visits[0].pass;
+	keyed.acceptVisitor(&skipVisitor, QueuedRenderableCollection::OM_SORT_KEYED);
+	for (size_t i = 0; i < skipVisitor.visits.size(); ++i)
+	{
+		CPPUNIT_ASSERT(skipVisitor.visits[i].pass != skipVisitor.skipPass);
+	}
+	CPPUNIT_ASSERT(skipVisitor.visits.size() < keyedVisitor.visits.size());
+}
+
+void RenderQueueSortTests::testKeyedMerge()
+{
+	createPasses(10);
+	createRenderables(500);
+
+	QueuedRenderableCollection first, second, all;
+	first.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	second.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	all.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+	{
+		Pass* pass = mRenderables[i]->getMaterial()->getTechnique(0)->getPass(0);
+		(i < 200 ? first : second).addRenderable(pass, mRenderables[i]);
+		all.addRenderable(pass, mRenderables[i]);
+	}
+	// Sorting the source first must not matter to the merged result
+	second.sort(mCamera);
+	first.merge(second);
+	first.sort(mCamera);
+	all.sort(mCamera);
+
+	RecordingVisitor mergedVisitor, allVisitor;
+	first.acceptVisitor(&mergedVisitor, QueuedRenderableCollection::OM_SORT_KEYED);
+	all.acceptVisitor(&allVisitor, QueuedRenderableCollection::OM_SORT_KEYED);
+	CPPUNIT_ASSERT_EQUAL(allVisitor.visits.size(), mergedVisitor.visits.size());
+	for (size_t i = 0; i < allVisitor.visits.size(); ++i)
+	{
+		CPPUNIT_ASSERT(allVisitor.visits[i].renderable == mergedVisitor.visits[i].renderable);
+		CPPUNIT_ASSERT(allVisitor.visits[i].pass == mergedVisitor.visits[i].pass);
+	}
+}
+
+void RenderQueueSortTests::testKeyedQueueOption()
+{
+	createPasses(10);
+	createRenderables(200);
+
+	// The main group exists before the option is set, the other is created after
+	RenderQueue queue;
+	queue.setKeyedSortEnabled(true);
+	RenderQueueGroup* groups[] = { 
+		queue.getQueueGroup(RENDER_QUEUE_MAIN), queue.getQueueGroup(RENDER_QUEUE_6) };
+	for (size_t g = 0; g < 2; ++g)
+	{
+		CPPUNIT_ASSERT(groups[g]->getKeyedSortEnabled());
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+		{
+			groups[g]->addRenderable(mRenderables[i], 
+				mRenderables[i]->getMaterial()->getTechnique(0), OGRE_RENDERABLE_DEFAULT_PRIORITY);
+		}
+		RenderPriorityGroup* priorityGroup = groups[g]->getIterator().getNext();
+		CPPUNIT_ASSERT(priorityGroup->getSolidsBasic().isSortRequired(mCamera));
+		priorityGroup->sort(mCamera);
+
+		// Scene managers ask for pass groups, and get each pass nearest first
+		RecordingVisitor visitor;
+		priorityGroup->getSolidsBasic().acceptVisitor(&visitor, 
+			QueuedRenderableCollection::OM_PASS_GROUP);
+		CPPUNIT_ASSERT_EQUAL(mPasses.size(), visitor.passVisits);
+		for (size_t i = 1; i < visitor.visits.size(); ++i)
+		{
+			const RenderablePass& prev = visitor.visits[i - 1];
+			const RenderablePass& cur = visitor.visits[i];
+			if (prev.pass == cur.pass)
+			{
+				CPPUNIT_ASSERT(prev.renderable->getSquaredViewDepth(mCamera) <= 
+					cur.renderable->getSquaredViewDepth(mCamera));
+			}
+		}
+	}
+
+	// Back to grouping by pass, which never needs sorting
+	queue.clear();
+	queue.setKeyedSortEnabled(false);
+	CPPUNIT_ASSERT(!groups[0]->getKeyedSortEnabled());
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+	{
+		groups[0]->addRenderable(mRenderables[i], 
+			mRenderables[i]->getMaterial()->getTechnique(0), OGRE_RENDERABLE_DEFAULT_PRIORITY);
+	}
+	RenderPriorityGroup* priorityGroup = groups[0]->getIterator().getNext();
+	CPPUNIT_ASSERT(!priorityGroup->getSolidsBasic().isSortRequired(mCamera));
+	RecordingVisitor visitor;
+	priorityGroup->getSolidsBasic().acceptVisitor(&visitor, 
+		QueuedRenderableCollection::OM_PASS_GROUP);
+	CPPUNIT_ASSERT_EQUAL(mPasses.size(), visitor.passVisits);
+}
+
+void RenderQueueSortTests::testCameraMoved()
+{
+	createPasses(4);
+	createRenderables(50);
+	QueuedRenderableCollection sorted;
+	sorted.addOrganisationMode(QueuedRenderableCollection::OM_SORT_DESCENDING);
+	sorted.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+		sorted.addRenderable(mRenderables[i]->getMaterial()->getTechnique(0)->getPass(0), mRenderables[i]);
+	sorted.sort(mCamera);
+	CPPUNIT_ASSERT(!sorted.isSortRequired(mCamera));
+
+	FixedDepthRenderable* first = static_cast<FixedDepthRenderable*>(mRenderables[0]);
+	first->mDepthQueries = 0;
+
+	// The same camera in the same place can reuse the last sort
+	sorted.sort(mCamera);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, first->mDepthQueries);
+
+	// Once it moves, the depths are asked for again
+	mCamera->setPosition(Vector3(10, 0, 0));
+	CPPUNIT_ASSERT(sorted.isSortRequired(mCamera));
+	sorted.sort(mCamera);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, first->mDepthQueries);
+	CPPUNIT_ASSERT(!sorted.isSortRequired(mCamera));
+
+	// And once it turns
+	first->mDepthQueries = 0;
+	mCamera->yaw(Degree(30));
+	CPPUNIT_ASSERT(sorted.isSortRequired(mCamera));
+	sorted.sort(mCamera);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, first->mDepthQueries);
+
+	// As well as when the node it is attached to moves
+	first->mDepthQueries = 0;
+	SceneNode* node = mSceneMgr->getRootSceneNode()->createChildSceneNode();
+	node->attachObject(mCamera);
+	node->translate(Vector3(0, 5, 0));
+	mSceneMgr->getRootSceneNode()->_update(true, false);
+	CPPUNIT_ASSERT(sorted.isSortRequired(mCamera));
+	sorted.sort(mCamera);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, first->mDepthQueries);
+}
+
+void RenderQueueSortTests::testKeyedBenchmark()
+{
+	createPasses(300);
+	createRenderables(20000);
+
+	QueuedRenderableCollection grouped, keyed;
+	grouped.addOrganisationMode(QueuedRenderableCollection::OM_PASS_GROUP);
+	keyed.addOrganisationMode(QueuedRenderableCollection::OM_SORT_KEYED);
+
+	vector<Pass*>::type passes;
+	for (size_t i = 0; i < mRenderables.size(); ++i)
+		passes.push_back(mRenderables[i]->getMaterial()->getTechnique(0)->getPass(0));
+
+	Timer timer;
+	const size_t iterations = 20;
+	unsigned long groupedUs = 0, keyedUs = 0;
+	size_t groupedVisits = 0, keyedVisits = 0;
+	for (size_t it = 0; it < iterations; ++it)
+	{
+		// Queue, sort and visit, as a frame would
+		RecordingVisitor groupVisitor, keyedVisitor;
+
+		timer.reset();
+		grouped.clear();
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+			grouped.addRenderable(passes[i], mRenderables[i]);
+		grouped.sort(mCamera);
+		grouped.acceptVisitor(&groupVisitor, QueuedRenderableCollection::OM_PASS_GROUP);
+		groupedUs += timer.getMicroseconds();
+
+		timer.reset();
+		keyed.clear();
+		for (size_t i = 0; i < mRenderables.size(); ++i)
+			keyed.addRenderable(passes[i], mRenderables[i]);
+		keyed.sort(mCamera);
+		keyed.acceptVisitor(&keyedVisitor, QueuedRenderableCollection::OM_SORT_KEYED);
+		keyedUs += timer.getMicroseconds();
+
+		groupedVisits = groupVisitor.passVisits;
+		keyedVisits = keyedVisitor.passVisits;
+	}
+	CPPUNIT_ASSERT_EQUAL(groupedVisits, keyedVisits);
+
+	LogManager::getSingleton().stream() << "RenderQueueSortTests: "
+		<< mRenderables.size() << " renderables over " << mPasses.size() 
+		<< " passes: pass groups " << (groupedUs / iterations) 
+		<< "us, sort keys " << (keyedUs / iterations) << "us";
+}
@@ -0,0 +1,249 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ResourceBudgetManagerTests.h"
+#include "OgreRoot.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreResourceBudgetManager.h"
+#include "OgreStringConverter.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ResourceBudgetManagerTests );
+
+SizedResourceManager::SizedResourceManager(const String& type)
+	: mNextSize(0)
+{
+	mResourceType = type;
+	mLoadOrder = 100;
+	ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this);
+}
+SizedResourceManager::~SizedResourceManager()
+{
+	ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
+}
+ResourcePtr SizedResourceManager::createSized(const String& name, size_t size)
+{
+	mNextSize = size;
+	return create(name, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+}
+Resource* SizedResourceManager::createImpl(const String& name, ResourceHandle handle, 
+	const String& group, bool isManual, ManualResourceLoader* loader, 
+	const NameValuePairList* createParams)
+{
+	return OGRE_NEW SizedResource(this, name, handle, group, mNextSize);
+}
+
+#if OGRE_THREAD_SUPPORT
+/// Touches a resource over and over, as background loading threads do
+struct TouchWorker
+{
+	Resource* res;
+	size_t count;
+	void operator()()
+	{
+		for (size_t i = 0; i < count; ++i)
+			res->touch();
+	}
+};
+#endif
+
+void ResourceBudgetManagerTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mMeshes = OGRE_NEW SizedResourceManager("SizedMesh");
+	mTextures = OGRE_NEW SizedResourceManager("SizedTexture");
+	mOtherUsage = ResourceBudgetManager::getSingleton().getMemoryUsage();
+}
+void ResourceBudgetManagerTests::tearDown()
+{
+	OGRE_DELETE mMeshes;
+	OGRE_DELETE mTextures;
+	OGRE_DELETE mRoot;
+}
+
+void ResourceBudgetManagerTests::nextFrame()
+{
+	mRoot->_fireFrameStarted();
+	mRoot->_fireFrameRenderingQueued();
+	mRoot->_fireFrameEnded();
+}
+
+SizedResource* ResourceBudgetManagerTests::get(SizedResourceManager* rm, const String& name)
+{
+	return static_cast<SizedResource*>(rm->getByName(name).get());
+}
+
+void ResourceBudgetManagerTests::testLeastRecentlyUsedEvicted()
+{
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	for (int i = 0; i < 4; ++i)
+	{
+		mMeshes->createSized("mesh" + StringConverter::toString(i), 100);
+		get(mMeshes, "mesh" + StringConverter::toString(i))->touch();
+		nextFrame();
+	}
+	// Use the oldest again so that mesh1 becomes the least recently used
+	get(mMeshes, "mesh0")->touch();
+	nextFrame();
+	CPPUNIT_ASSERT_EQUAL(mOtherUsage + 400, budgetMgr.getMemoryUsage());
+
+	budgetMgr.setMemoryBudget(mOtherUsage + 250);
+	CPPUNIT_ASSERT(get(mMeshes, "mesh0")->isLoaded());
+	CPPUNIT_ASSERT(!get(mMeshes, "mesh1")->isLoaded());
+	CPPUNIT_ASSERT(!get(mMeshes, "mesh2")->isLoaded());
+	CPPUNIT_ASSERT(get(mMeshes, "mesh3")->isLoaded());
+	CPPUNIT_ASSERT_EQUAL(mOtherUsage + 200, budgetMgr.getMemoryUsage());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, budgetMgr.getStatistics().evictions);
+	CPPUNIT_ASSERT_EQUAL((size_t)200, budgetMgr.getStatistics().bytesEvicted);
+
+	// Unloaded, not destroyed
+	CPPUNIT_ASSERT(mMeshes->resourceExists("mesh1"));
+}
+
+void ResourceBudgetManagerTests::testReferencedNotEvicted()
+{
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	ResourcePtr held = mMeshes->createSized("held", 100);
+	held->touch();
+	mMeshes->createSized("free", 100)->touch();
+	nextFrame();
+	nextFrame();
+
+	// The held resource is older but something else is using it
+	budgetMgr.setMemoryBudget(mOtherUsage + 50);
+	CPPUNIT_ASSERT(held->isLoaded());
+	CPPUNIT_ASSERT(!get(mMeshes, "free")->isLoaded());
+	CPPUNIT_ASSERT_EQUAL(mOtherUsage + 100, budgetMgr.getMemoryUsage());
+
+	held.setNull();
+	nextFrame();
+	CPPUNIT_ASSERT(!get(mMeshes, "held")->isLoaded());
+	CPPUNIT_ASSERT_EQUAL(mOtherUsage, budgetMgr.getMemoryUsage());
+}
+
+void ResourceBudgetManagerTests::testCurrentFrameNotEvicted()
+{
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	budgetMgr.setMemoryBudget(mOtherUsage + 150);
+	mMeshes->createSized("a", 100)->touch();
+	mMeshes->createSized("b", 100)->touch();
+
+	// Both were used in this frame so the budget is overrun for now
+	nextFrame();
+	CPPUNIT_ASSERT(get(mMeshes, "a")->isLoaded());
+	CPPUNIT_ASSERT(get(mMeshes, "b")->isLoaded());
+
+	get(mMeshes, "b")->touch();
+	nextFrame();
+	CPPUNIT_ASSERT(!get(mMeshes, "a")->isLoaded());
+	CPPUNIT_ASSERT(get(mMeshes, "b")->isLoaded());
+}
+
+void ResourceBudgetManagerTests::testReloadOnTouch()
+{
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	mMeshes->createSized("a", 100)->touch();
+	mMeshes->createSized("b", 100)->touch();
+	nextFrame();
+	get(mMeshes, "a")->touch();
+	nextFrame();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, budgetMgr.getStatistics().hits);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, budgetMgr.getStatistics().misses);
+
+	budgetMgr.setMemoryBudget(mOtherUsage + 100);
+	CPPUNIT_ASSERT(!get(mMeshes, "b")->isLoaded());
+	budgetMgr.resetStatistics();
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		// Alternate between the two, each one evicting the other
+		get(mMeshes, frame % 2 ? "a" : "b")->touch();
+		nextFrame();
+	}
+	get(mMeshes, "a")->touch();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, budgetMgr.getStatistics().hits);
+	CPPUNIT_ASSERT_EQUAL((size_t)4, budgetMgr.getStatistics().misses);
+	CPPUNIT_ASSERT_EQUAL((size_t)4, budgetMgr.getStatistics().evictions);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, get(mMeshes, "a")->mLoadCount);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, get(mMeshes, "b")->mLoadCount);
+	CPPUNIT_ASSERT(get(mMeshes, "a")->isLoaded());
+	CPPUNIT_ASSERT(!get(mMeshes, "b")->isLoaded());
+}
+
+void ResourceBudgetManagerTests::testBudgetAcrossManagers()
+{
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	mTextures->createSized("oldTexture", 300)->touch();
+	nextFrame();
+	mMeshes->createSized("mesh", 100)->touch();
+	nextFrame();
+	mTextures->createSized("newTexture", 300)->touch();
+	nextFrame();
+
+	// Each manager is within its own budget, but the old texture has to go
+	// to fit the mesh in too
+	budgetMgr.setMemoryBudget(mOtherUsage + 500);
+	CPPUNIT_ASSERT(!get(mTextures, "oldTexture")->isLoaded());
+	CPPUNIT_ASSERT(get(mTextures, "newTexture")->isLoaded());
+	CPPUNIT_ASSERT(get(mMeshes, "mesh")->isLoaded());
+	CPPUNIT_ASSERT_EQUAL((size_t)300, mTextures->getMemoryUsage());
+	CPPUNIT_ASSERT_EQUAL((size_t)100, mMeshes->getMemoryUsage());
+}
+
+void ResourceBudgetManagerTests::testManagerBudget()
+{
+	mTextures->createSized("texture", 300)->touch();
+	mMeshes->createSized("mesh0", 100)->touch();
+	nextFrame();
+	mMeshes->createSized("mesh1", 100)->touch();
+	nextFrame();
+
+	// Only the meshes are over their budget
+	mMeshes->setMemoryBudget(150);
+	nextFrame();
+	CPPUNIT_ASSERT(!get(mMeshes, "mesh0")->isLoaded());
+	CPPUNIT_ASSERT(get(mMeshes, "mesh1")->isLoaded());
+	CPPUNIT_ASSERT(get(mTextures, "texture")->isLoaded());
+}
+
+void ResourceBudgetManagerTests::testTouchFromThreads()
+{
+#if OGRE_THREAD_SUPPORT
+	ResourceBudgetManager& budgetMgr = ResourceBudgetManager::getSingleton();
+	mMeshes->createSized("a", 100)->touch();
+	budgetMgr.resetStatistics();
+
+	// No touches are lost
+	TouchWorker worker = { get(mMeshes, "a"), 20000 };
+	OGRE_THREAD_TYPE t0(worker), t1(worker), t2(worker), t3(worker);
+	t0.join();
+	t1.join();
+	t2.join();
+	t3.join();
+	CPPUNIT_ASSERT_EQUAL((size_t)80000, budgetMgr.getStatistics().hits);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, budgetMgr.getStatistics().misses);
+#endif
+}
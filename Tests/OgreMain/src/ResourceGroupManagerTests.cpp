@@ -0,0 +1,451 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ResourceGroupManagerTests.h"
+#include "OgreRoot.h"
+#include "OgreArchiveManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ResourceGroupManagerTests );
+
+size_t GeneratedArchive::msExistsCalls = 0;
+
+GeneratedArchive::GeneratedArchive(const String& name, const String& archType, 
+	bool caseSensitive)
+	: Archive(name, archType), mCaseSensitive(caseSensitive)
+{
+}
+void GeneratedArchive::load()
+{
+	StringVector range = StringUtil::split(mName, ":");
+	size_t first = StringConverter::parseUnsignedInt(range[0]);
+	size_t count = StringConverter::parseUnsignedInt(range[1]);
+	String prefix = range.size() > 2 ? range[2] : StringUtil::BLANK;
+	for (size_t i = first; i < first + count; ++i)
+		mNames.push_back(prefix + "res" + StringConverter::toString(i) + ".dat");
+	mNameSet.insert(mNames.begin(), mNames.end());
+}
+void GeneratedArchive::unload()
+{
+	mNames.clear();
+	mNameSet.clear();
+}
+DataStreamPtr GeneratedArchive::open(const String& filename, bool readOnly) const
+{
+	// The contents say where the file was opened from
+	String contents = mName + "/" + filename;
+	MemoryDataStream* stream = OGRE_NEW MemoryDataStream(filename, contents.size());
+	memcpy(stream->getPtr(), contents.c_str(), contents.size());
+	return DataStreamPtr(stream);
+}
+StringVectorPtr GeneratedArchive::list(bool recursive, bool dirs)
+{
+	return find("*", recursive, dirs);
+}
+FileInfoListPtr GeneratedArchive::listFileInfo(bool recursive, bool dirs)
+{
+	return findFileInfo("*", recursive, dirs);
+}
+StringVectorPtr GeneratedArchive::find(const String& pattern, bool recursive, bool dirs)
+{
+	StringVectorPtr ret(OGRE_NEW_T(StringVector, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+	if (!dirs)
+	{
+		for (StringVector::iterator i = mNames.begin(); i != mNames.end(); ++i)
+			if (StringUtil::match(*i, pattern, mCaseSensitive))
+				ret->push_back(*i);
+	}
+	return ret;
+}
+FileInfoListPtr GeneratedArchive::findFileInfo(const String& pattern, bool recursive, bool dirs)
+{
+	FileInfoListPtr ret(OGRE_NEW_T(FileInfoList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
+	StringVectorPtr names = find(pattern, recursive, dirs);
+	for (StringVector::iterator i = names->begin(); i != names->end(); ++i)
+	{
+		FileInfo info;
+		info.archive = this;
+		info.filename = info.basename = *i;
+		info.compressedSize = info.uncompressedSize = 0;
+		ret->push_back(info);
+	}
+	return ret;
+}
+bool GeneratedArchive::exists(const String& filename)
+{
+	++msExistsCalls;
+	String name = filename;
+	if (!mCaseSensitive)
+		StringUtil::toLowerCase(name);
+	if (mNameSet.find(name) != mNameSet.end())
+		return true;
+	return StringUtil::startsWith(name, "sub/") && 
+		mNameSet.find(name.substr(4)) != mNameSet.end();
+}
+
+/// Stands in for the cost of decoding a file
+static uint32 simulateWork(const String& contents, size_t iterations)
+{
+	uint32 hash = 2166136261u;
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		for (String::const_iterator c = contents.begin(); c != contents.end(); ++c)
+			hash = (hash ^ static_cast<uint8>(*c)) * 16777619u;
+	}
+	return hash;
+}
+
+size_t GeneratedResource::msWork = 0;
+
+void GeneratedResource::prepareImpl()
+{
+	mContents = ResourceGroupManager::getSingleton().openResource(
+		mName, mGroup, true, this)->getAsString();
+	if (simulateWork(mContents, msWork) == 0)
+		mContents.clear();
+}
+
+GeneratedResourceManager::GeneratedResourceManager()
+{
+	mResourceType = "GeneratedResource";
+	mLoadOrder = 100;
+	ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this);
+}
+GeneratedResourceManager::~GeneratedResourceManager()
+{
+	ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
+}
+Resource* GeneratedResourceManager::createImpl(const String& name, ResourceHandle handle, 
+	const String& group, bool isManual, ManualResourceLoader* loader, 
+	const NameValuePairList* createParams)
+{
+	return OGRE_NEW GeneratedResource(this, name, handle, group, isManual, loader);
+}
+
+RecordingScriptLoader::RecordingScriptLoader()
+	: mNumPrepared(0), mWork(0), mChecksum(0)
+{
+	mPatterns.push_back("*.dat");
+}
+void RecordingScriptLoader::parseScript(DataStreamPtr& stream, const String& groupName)
+{
+	String contents = stream->getAsString();
+	mChecksum += simulateWork(contents, mWork);
+	mParsed.push_back(contents);
+}
+Any RecordingScriptLoader::prepareScript(DataStreamPtr& stream, const String& groupName)
+{
+	if (stream->getName() == mFailName)
+	{
+		OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS, "Failing as requested", 
+			"RecordingScriptLoader::prepareScript");
+	}
+	return Any(simulateWork(stream->getAsString(), mWork));
+}
+void RecordingScriptLoader::parsePreparedScript(DataStreamPtr& stream, 
+	const String& groupName, const Any& prepared)
+{
+	// The stream must have been rewound
+	mChecksum += any_cast<uint32>(prepared);
+	++mNumPrepared;
+	mParsed.push_back(stream->getAsString());
+}
+
+void ResourceGroupManagerTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mFactory = OGRE_NEW GeneratedArchiveFactory("Generated", false);
+	mCaseSensitiveFactory = OGRE_NEW GeneratedArchiveFactory("GeneratedCS", true);
+	ArchiveManager::getSingleton().addArchiveFactory(mFactory);
+	ArchiveManager::getSingleton().addArchiveFactory(mCaseSensitiveFactory);
+	GeneratedArchive::msExistsCalls = 0;
+}
+void ResourceGroupManagerTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mFactory;
+	OGRE_DELETE mCaseSensitiveFactory;
+}
+
+void ResourceGroupManagerTests::startWorkQueue()
+{
+	DefaultWorkQueue* queue = OGRE_NEW DefaultWorkQueue("ResourceGroupManagerTests");
+	queue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(queue);
+	queue->startup();
+}
+
+String ResourceGroupManagerTests::readResource(const String& name, const String& group)
+{
+	return ResourceGroupManager::getSingleton().openResource(name, group)->getAsString();
+}
+
+void ResourceGroupManagerTests::testOpenResource()
+{
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	rgm.addResourceLocation("0:100", "Generated", "GroupA");
+	rgm.addResourceLocation("100:100", "Generated", "GroupA");
+
+	CPPUNIT_ASSERT_EQUAL(String("0:100/res5.dat"), readResource("res5.dat", "GroupA"));
+	CPPUNIT_ASSERT_EQUAL(String("100:100/res150.dat"), readResource("res150.dat", "GroupA"));
+	// Case insensitive archives match any case
+	CPPUNIT_ASSERT_EQUAL(String("0:100/RES5.DAT"), readResource("RES5.DAT", "GroupA"));
+	CPPUNIT_ASSERT(rgm.resourceExists("GroupA", "Res99.Dat"));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, GeneratedArchive::msExistsCalls);
+
+	// Files which aren't indexed are still searched for
+	CPPUNIT_ASSERT(!rgm.resourceExists("GroupA", "res200.dat"));
+	CPPUNIT_ASSERT_EQUAL((size_t)2, GeneratedArchive::msExistsCalls);
+	CPPUNIT_ASSERT_THROW(rgm.openResource("res200.dat", "GroupA", false), Exception);
+}
+
+void ResourceGroupManagerTests::testCaseSensitiveArchive()
+{
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	rgm.addResourceLocation("0:100", "GeneratedCS", "GroupA");
+
+	CPPUNIT_ASSERT(rgm.resourceExists("GroupA", "res5.dat"));
+	CPPUNIT_ASSERT(!rgm.resourceExists("GroupA", "RES5.DAT"));
+	CPPUNIT_ASSERT(rgm.resourceExistsInAnyGroup("res5.dat"));
+	CPPUNIT_ASSERT(!rgm.resourceExistsInAnyGroup("RES5.DAT"));
+
+	// A case insensitive archive in another group can still match
+	rgm.addResourceLocation("0:10", "Generated", "GroupB");
+	CPPUNIT_ASSERT_EQUAL(String("GroupB"), rgm.findGroupContainingResource("RES5.DAT"));
+	CPPUNIT_ASSERT_EQUAL(String("GroupA"), rgm.findGroupContainingResource("res50.dat"));
+}
+
+void ResourceGroupManagerTests::testFindGroupContainingResource()
+{
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	rgm.addResourceLocation("0:100", "Generated", "GroupB");
+	rgm.addResourceLocation("50:100", "Generated", "GroupA");
+
+	// Groups are searched in order of name
+	CPPUNIT_ASSERT_EQUAL(String("GroupB"), rgm.findGroupContainingResource("res10.dat"));
+	CPPUNIT_ASSERT_EQUAL(String("GroupA"), rgm.findGroupContainingResource("res60.dat"));
+	CPPUNIT_ASSERT_EQUAL(String("GroupA"), rgm.findGroupContainingResource("RES120.dat"));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, GeneratedArchive::msExistsCalls);
+
+	// A group which lists a file comes before one which can only find it 
+	// when asked, otherwise the groups are searched in order
+	rgm.addResourceLocation("0:100:sub/", "Generated", "GroupC");
+	CPPUNIT_ASSERT_EQUAL(String("GroupC"), rgm.findGroupContainingResource("sub/res60.dat"));
+	CPPUNIT_ASSERT_EQUAL(String("GroupA"), rgm.findGroupContainingResource("sub/res120.dat"));
+	CPPUNIT_ASSERT(GeneratedArchive::msExistsCalls > 0);
+	rgm.destroyResourceGroup("GroupC");
+
+	// Opening from the wrong group finds the right one
+	CPPUNIT_ASSERT_EQUAL(String("50:100/res120.dat"), readResource("res120.dat", "GroupB"));
+
+	rgm.removeResourceLocation("50:100", "GroupA");
+	CPPUNIT_ASSERT_EQUAL(String("GroupB"), rgm.findGroupContainingResource("res60.dat"));
+	CPPUNIT_ASSERT(!rgm.resourceExistsInAnyGroup("res120.dat"));
+
+	rgm.destroyResourceGroup("GroupB");
+	CPPUNIT_ASSERT(!rgm.resourceExistsInAnyGroup("res10.dat"));
+	CPPUNIT_ASSERT_THROW(rgm.findGroupContainingResource("res10.dat"), Exception);
+}
+
+void ResourceGroupManagerTests::testFindResourceFileInfo()
+{
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	rgm.addResourceLocation("0:100", "Generated", "GroupA");
+	rgm.addResourceLocation("50:100", "Generated", "GroupA");
+	rgm.addResourceLocation("200:100", "Generated", "GroupA");
+
+	FileInfoListPtr files = rgm.findResourceFileInfo("GroupA", "res10.dat");
+	CPPUNIT_ASSERT_EQUAL((size_t)1, files->size());
+	CPPUNIT_ASSERT_EQUAL(String("0:100"), files->at(0).archive->getName());
+
+	// In two locations
+	files = rgm.findResourceFileInfo("GroupA", "RES70.DAT");
+	CPPUNIT_ASSERT_EQUAL((size_t)2, files->size());
+
+	files = rgm.findResourceFileInfo("GroupA", "res2*.dat");
+	// res2, res20-29, res200-299
+	CPPUNIT_ASSERT_EQUAL((size_t)111, files->size());
+
+	files = rgm.findResourceFileInfo("GroupA", "res300.dat");
+	CPPUNIT_ASSERT_EQUAL((size_t)0, files->size());
+}
+
+void ResourceGroupManagerTests::testResolveBenchmark()
+{
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	const size_t numGroups = 20, locationsPerGroup = 5, namesPerLocation = 1000;
+	const size_t numNames = numGroups * locationsPerGroup * namesPerLocation;
+
+	Timer timer;
+	for (size_t g = 0; g < numGroups; ++g)
+	{
+		String group = "Group" + StringConverter::toString(g, 2, '0');
+		for (size_t l = 0; l < locationsPerGroup; ++l)
+		{
+			size_t first = (g * locationsPerGroup + l) * namesPerLocation;
+			rgm.addResourceLocation(StringConverter::toString(first) + ":" + 
+				StringConverter::toString(namesPerLocation), "Generated", group);
+		}
+	}
+	unsigned long indexUs = timer.getMicroseconds();
+
+	// Resolve every name, in mixed case for half of them
+	vector<String>::type names;
+	names.reserve(numNames);
+	for (size_t i = 0; i < numNames; ++i)
+		names.push_back((i & 1 ? "RES" : "res") + StringConverter::toString(i) + ".dat");
+
+	timer.reset();
+	size_t found = 0;
+	for (size_t i = 0; i < numNames; ++i)
+	{
+		const String& group = rgm.findGroupContainingResource(names[i]);
+		if (group.length() == 7)
+			++found;
+	}
+	unsigned long resolveUs = timer.getMicroseconds();
+
+	timer.reset();
+	for (size_t i = 0; i < numNames; i += 10)
+	{
+		String group = "Group" + StringConverter::toString(i / (locationsPerGroup * namesPerLocation), 2, '0');
+		CPPUNIT_ASSERT(rgm.resourceExists(group, names[i]));
+	}
+	unsigned long existsUs = timer.getMicroseconds();
+
+	CPPUNIT_ASSERT_EQUAL(numNames, found);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, GeneratedArchive::msExistsCalls);
+
+	LogManager::getSingleton().stream() << "ResourceGroupManagerTests: "
+		<< numNames << " names in " << numGroups << " groups: indexed in "
+		<< indexUs << "us, resolved in " << resolveUs << "us, "
+		<< numNames / 10 << " lookups in their group in " << existsUs << "us";
+}
+
+void ResourceGroupManagerTests::testParallelScriptParsing()
+{
+	startWorkQueue();
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	RecordingScriptLoader loader;
+	loader.mFailName = "res13.dat";
+	loader.mWork = 1;
+	rgm._registerScriptLoader(&loader);
+	rgm.addResourceLocation("0:50", "Generated", "GroupA");
+	rgm.addResourceLocation("50:50", "Generated", "GroupA");
+	rgm.addResourceLocation("0:50", "Generated", "GroupB");
+	rgm.addResourceLocation("50:50", "Generated", "GroupB");
+
+	rgm.initialiseResourceGroup("GroupA");
+	StringVector serialOrder = loader.mParsed;
+	uint32 serialChecksum = loader.mChecksum;
+	CPPUNIT_ASSERT_EQUAL((size_t)100, serialOrder.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)0, loader.mNumPrepared);
+
+	loader.mParsed.clear();
+	loader.mChecksum = 0;
+	rgm.setParallelInitialisation(true);
+	rgm.initialiseResourceGroup("GroupB");
+	// Parsed in the same order with the same results, and all but the 
+	// failing script were prepared first
+	CPPUNIT_ASSERT(serialOrder == loader.mParsed);
+	CPPUNIT_ASSERT_EQUAL(serialChecksum, loader.mChecksum);
+	CPPUNIT_ASSERT_EQUAL((size_t)99, loader.mNumPrepared);
+
+	rgm._unregisterScriptLoader(&loader);
+}
+
+void ResourceGroupManagerTests::testParallelPrepare()
+{
+	startWorkQueue();
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	GeneratedResourceManager mgr;
+	rgm.addResourceLocation("0:200", "Generated", "GroupA");
+	for (size_t i = 0; i < 200; ++i)
+		rgm.declareResource("res" + StringConverter::toString(i) + ".dat", "GeneratedResource", "GroupA");
+
+	rgm.setParallelInitialisation(true);
+	rgm.initialiseResourceGroup("GroupA");
+	rgm.prepareResourceGroup("GroupA");
+
+	for (size_t i = 0; i < 200; ++i)
+	{
+		String name = "res" + StringConverter::toString(i) + ".dat";
+		ResourcePtr res = mgr.getByName(name);
+		CPPUNIT_ASSERT(!res.isNull());
+		CPPUNIT_ASSERT(res->isPrepared());
+		CPPUNIT_ASSERT_EQUAL("0:200/" + name, static_cast<GeneratedResource*>(res.get())->mContents);
+	}
+
+	rgm.destroyResourceGroup("GroupA");
+}
+
+void ResourceGroupManagerTests::testParallelInitialiseBenchmark()
+{
+	startWorkQueue();
+	ResourceGroupManager& rgm = ResourceGroupManager::getSingleton();
+	const size_t numFiles = 2000, work = 2000;
+	RecordingScriptLoader loader;
+	loader.mWork = work;
+	rgm._registerScriptLoader(&loader);
+	GeneratedResourceManager mgr;
+	GeneratedResource::msWork = work;
+
+	unsigned long parseUs[2], prepareUs[2];
+	Timer timer;
+	for (int parallel = 0; parallel < 2; ++parallel)
+	{
+		rgm.addResourceLocation("0:" + StringConverter::toString(numFiles), "Generated", "GroupA");
+		for (size_t i = 0; i < numFiles; ++i)
+			rgm.declareResource("res" + StringConverter::toString(i) + ".dat", "GeneratedResource", "GroupA");
+		rgm.setParallelInitialisation(parallel != 0);
+
+		timer.reset();
+		rgm.initialiseResourceGroup("GroupA");
+		parseUs[parallel] = timer.getMicroseconds();
+		timer.reset();
+		rgm.prepareResourceGroup("GroupA");
+		prepareUs[parallel] = timer.getMicroseconds();
+
+		CPPUNIT_ASSERT_EQUAL(numFiles, loader.mParsed.size());
+		loader.mParsed.clear();
+		rgm.destroyResourceGroup("GroupA");
+	}
+	CPPUNIT_ASSERT_EQUAL(numFiles, loader.mNumPrepared);
+
+	rgm._unregisterScriptLoader(&loader);
+	GeneratedResource::msWork = 0;
+
+	LogManager::getSingleton().stream() << "ResourceGroupManagerTests: "
+		<< numFiles << " scripts parsed in " << parseUs[0] << "us serially, "
+		<< parseUs[1] << "us in parallel; " << numFiles << " resources prepared in "
+		<< prepareUs[0] << "us serially, " << prepareUs[1] << "us in parallel";
+}
@@ -0,0 +1,288 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SceneGraphUpdateTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreMovableObject.h"
+#include "OgreTimer.h"
+#include "OgreLogManager.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( SceneGraphUpdateTests );
+
+/// Minimal object with fixed local bounds, so nodes have world bounds to merge
+class BoundsOnlyObject : public MovableObject
+{
+protected:
+	AxisAlignedBox mBox;
+	static String msType;
+public:
+	BoundsOnlyObject(const String& name, const AxisAlignedBox& box)
+		: MovableObject(name), mBox(box) {}
+	const String& getMovableType(void) const { return msType; }
+	const AxisAlignedBox& getBoundingBox(void) const { return mBox; }
+	Real getBoundingRadius(void) const { return mBox.getHalfSize().length(); }
+	void _updateRenderQueue(RenderQueue* queue) {}
+	void visitRenderables(Renderable::Visitor* visitor, bool debugRenderables = false) {}
+};
+String BoundsOnlyObject::msType = "BoundsOnlyObject";
+
+void SceneGraphUpdateTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	// No render system here, so workers must not try to use it
+	mQueue = OGRE_NEW DefaultWorkQueue("SceneGraphUpdateTests");
+	mQueue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(mQueue);
+	mQueue->startup();
+}
+void SceneGraphUpdateTests::tearDown()
+{
+	for (vector<MovableObject*>::type::iterator i = mObjects.begin(); i != mObjects.end(); ++i)
+		OGRE_DELETE *i;
+	mObjects.clear();
+	OGRE_DELETE mRoot;
+}
+
+SceneManager* SceneGraphUpdateTests::createScene(const String& name, 
+	size_t branches, size_t depth, size_t fanout)
+{
+	SceneManager* sm = mRoot->createSceneManager(ST_GENERIC, name);
+	// Same seed every time so that scenes built with the same parameters match
+	srand(12345);
+
+	vector<SceneNode*>::type level, nextLevel;
+	level.push_back(sm->getRootSceneNode());
+	size_t count = 0;
+	for (size_t d = 0; d < depth; ++d)
+	{
+		nextLevel.clear();
+		size_t children = d ? fanout : branches;
+		for (size_t i = 0; i < level.size(); ++i)
+		{
+			for (size_t c = 0; c < children; ++c)
+			{
+				SceneNode* n = level[i]->createChildSceneNode(
+					"n" + StringConverter::toString(count),
+					Vector3(Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100), Math::RangeRandom(-100, 100)),
+					Quaternion(Degree(Math::RangeRandom(0, 360)), Vector3::UNIT_Y));
+				n->setScale(Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2));
+				MovableObject* obj = OGRE_NEW BoundsOnlyObject("o" + StringConverter::toString(count),
+					AxisAlignedBox(-Vector3::UNIT_SCALE, Vector3::UNIT_SCALE));
+				n->attachObject(obj);
+				mObjects.push_back(obj);
+				nextLevel.push_back(n);
+				++count;
+			}
+		}
+		level.swap(nextLevel);
+	}
+	mNodeCount = count;
+	return sm;
+}
+
+void SceneGraphUpdateTests::moveNodes(SceneManager* sm, size_t stride)
+{
+	for (size_t i = 0; i < mNodeCount; i += stride)
+	{
+		sm->getSceneNode("n" + StringConverter::toString(i))->translate(Vector3(1, 2, 3));
+	}
+}
+
+void SceneGraphUpdateTests::checkScenesEqual(SceneManager* a, SceneManager* b)
+{
+	for (size_t i = 0; i < mNodeCount; ++i)
+	{
+		String name = "n" + StringConverter::toString(i);
+		SceneNode* na = a->getSceneNode(name);
+		SceneNode* nb = b->getSceneNode(name);
+		// Exact comparisons intended; the same operations are performed in both
+		CPPUNIT_ASSERT(na->_getDerivedPosition() == nb->_getDerivedPosition());
+		CPPUNIT_ASSERT(na->_getDerivedOrientation() == nb->_getDerivedOrientation());
+		CPPUNIT_ASSERT(na->_getDerivedScale() == nb->_getDerivedScale());
+		CPPUNIT_ASSERT(na->_getWorldAABB() == nb->_getWorldAABB());
+	}
+	CPPUNIT_ASSERT(a->getRootSceneNode()->_getWorldAABB() == b->getRootSceneNode()->_getWorldAABB());
+}
+
+void SceneGraphUpdateTests::testParallelMatchesSerial()
+{
+	SceneManager* serial = createScene("serial", 7, 3, 5);
+	SceneManager* parallel = createScene("parallel", 7, 3, 5);
+	parallel->setParallelSceneGraphUpdate(true);
+
+	serial->_updateSceneGraph(0);
+	parallel->_updateSceneGraph(0);
+
+	checkScenesEqual(serial, parallel);
+}
+
+void SceneGraphUpdateTests::testParallelPartialUpdate()
+{
+	SceneManager* serial = createScene("serial", 3, 4, 4);
+	SceneManager* parallel = createScene("parallel", 3, 4, 4);
+	parallel->setParallelSceneGraphUpdate(true);
+
+	serial->_updateSceneGraph(0);
+	parallel->_updateSceneGraph(0);
+
+	// Only some branches are dirty now
+	moveNodes(serial, 17);
+	moveNodes(parallel, 17);
+	serial->_updateSceneGraph(0);
+	parallel->_updateSceneGraph(0);
+
+	checkScenesEqual(serial, parallel);
+}
+
+void SceneGraphUpdateTests::testParallelUpdateBenchmark()
+{
+	// ~50k nodes
+	SceneManager* sm = createScene("bench", 50, 3, 31);
+	const int iterations = 20;
+	Timer timer;
+
+#if OGRE_THREAD_SUPPORT
+	size_t maxThreads = OGRE_THREAD_HARDWARE_CONCURRENCY;
+#else
+	size_t maxThreads = 1;
+#endif
+	for (size_t threads = 0; threads <= maxThreads; threads = threads ? threads * 2 : 1)
+	{
+		// 0 means the standard serial update
+		sm->setParallelSceneGraphUpdate(threads != 0);
+		if (threads)
+		{
+			// The calling thread makes up the numbers
+			mQueue->shutdown();
+			mQueue->setWorkerThreadCount(threads - 1);
+			mQueue->startup();
+		}
+
+		timer.reset();
+		for (int i = 0; i < iterations; ++i)
+		{
+			sm->getRootSceneNode()->needUpdate();
+			sm->_updateSceneGraph(0);
+		}
+		unsigned long us = timer.getMicroseconds();
+
+		LogManager::getSingleton().stream() << "SceneGraphUpdateTests: "
+			<< (threads ? StringConverter::toString(threads) + " thread(s)" : String("serial"))
+			<< ": " << (us / iterations) << " us per update";
+	}
+}
+
+void SceneGraphUpdateTests::testBatchedMatchesSerial()
+{
+	SceneManager* serial = createScene("serial", 7, 3, 5);
+	SceneManager* batched = createScene("batched", 7, 3, 5);
+	batched->setBatchedSceneGraphUpdate(true);
+
+	// Exercise the non-inheriting paths too
+	const char* names[] = { "n3", "n40", "n101" };
+	for (size_t i = 0; i < 3; ++i)
+	{
+		serial->getSceneNode(names[i])->setInheritOrientation(false);
+		batched->getSceneNode(names[i])->setInheritOrientation(false);
+		serial->getSceneNode(names[i])->setInheritScale(false);
+		batched->getSceneNode(names[i])->setInheritScale(false);
+	}
+
+	serial->_updateSceneGraph(0);
+	batched->_updateSceneGraph(0);
+
+	checkScenesEqual(serial, batched);
+}
+
+void SceneGraphUpdateTests::testBatchedPartialUpdate()
+{
+	SceneManager* serial = createScene("serial", 3, 4, 4);
+	SceneManager* batched = createScene("batched", 3, 4, 4);
+	batched->setBatchedSceneGraphUpdate(true);
+
+	serial->_updateSceneGraph(0);
+	batched->_updateSceneGraph(0);
+
+	// Only some branches are dirty now
+	moveNodes(serial, 17);
+	moveNodes(batched, 17);
+	serial->_updateSceneGraph(0);
+	batched->_updateSceneGraph(0);
+	checkScenesEqual(serial, batched);
+
+	// A parent brought up to date on demand between updates
+	serial->getSceneNode("n1")->translate(Vector3(5, 0, 0));
+	batched->getSceneNode("n1")->translate(Vector3(5, 0, 0));
+	serial->getSceneNode("n1")->_getDerivedPosition();
+	batched->getSceneNode("n1")->_getDerivedPosition();
+	serial->_updateSceneGraph(0);
+	batched->_updateSceneGraph(0);
+	checkScenesEqual(serial, batched);
+
+	// Hierarchy changes rebuild the layout
+	SceneManager* scenes[2] = { serial, batched };
+	for (size_t i = 0; i < 2; ++i)
+	{
+		SceneNode* node = scenes[i]->getSceneNode("n20");
+		node->getParentSceneNode()->removeChild(node);
+		scenes[i]->getSceneNode("n2")->addChild(node);
+	}
+	serial->_updateSceneGraph(0);
+	batched->_updateSceneGraph(0);
+	checkScenesEqual(serial, batched);
+}
+
+void SceneGraphUpdateTests::testBatchedUpdateBenchmark()
+{
+	// ~50k nodes
+	SceneManager* sm = createScene("bench", 50, 3, 31);
+	const int iterations = 20;
+	Timer timer;
+
+	for (int batched = 0; batched < 2; ++batched)
+	{
+		sm->setBatchedSceneGraphUpdate(batched != 0);
+		// The first batched update builds the layout
+		sm->getRootSceneNode()->needUpdate();
+		sm->_updateSceneGraph(0);
+
+		timer.reset();
+		for (int i = 0; i < iterations; ++i)
+		{
+			sm->getRootSceneNode()->needUpdate();
+			sm->_updateSceneGraph(0);
+		}
+		unsigned long us = timer.getMicroseconds();
+
+		LogManager::getSingleton().stream() << "SceneGraphUpdateTests: "
+			<< (batched ? "batched" : "recursive")
+			<< ": " << (us / iterations) << " us per update";
+	}
+}
@@ -0,0 +1,252 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include "ScriptCompilerTests.h"
+#include "OgreRoot.h"
+#include "OgreArchiveManager.h"
+#include "OgreArchive.h"
+#include "OgreMaterialManager.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+#include "OgreTimer.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( ScriptCompilerTests );
+
+void RecordingCompilerListener::preConversion(ScriptCompiler *compiler, ConcreteNodeListPtr nodes)
+{
+	mDump.clear();
+	dumpNodes(*nodes, 0, 0, mDump);
+}
+void RecordingCompilerListener::dumpNodes(const ConcreteNodeList& nodes, 
+	const ConcreteNode* parent, int depth, String& dump)
+{
+	for (ConcreteNodeList::const_iterator i = nodes.begin(); i != nodes.end(); ++i)
+	{
+		const ConcreteNode& node = **i;
+		CPPUNIT_ASSERT(node.parent == parent);
+		dump += StringConverter::toString(depth) + " " + node.file + ":" + 
+			StringConverter::toString(node.line) + " " + 
+			StringConverter::toString((int)node.type) + " " + node.token + "\n";
+		dumpNodes(node.children, &node, depth + 1, dump);
+	}
+}
+
+void ScriptCompilerTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	ScriptCompilerManager::getSingleton().setListener(&mListener);
+	ScriptCompilerManager::getSingleton().setCacheLocation(".");
+	removeCacheFiles();
+}
+void ScriptCompilerTests::tearDown()
+{
+	removeCacheFiles();
+	OGRE_DELETE mRoot;
+}
+
+void ScriptCompilerTests::removeCacheFiles()
+{
+	Archive* arch = ArchiveManager::getSingleton().load(".", "FileSystem");
+	StringVectorPtr files = arch->find("*.scriptcache", false);
+	for (StringVector::iterator i = files->begin(); i != files->end(); ++i)
+		remove(i->c_str());
+	ArchiveManager::getSingleton().unload(arch);
+}
+
+String ScriptCompilerTests::compileScript(const String& name, const String& text, 
+	const String& group)
+{
+	DataStreamPtr stream(OGRE_NEW MemoryDataStream(name, 
+		const_cast<char*>(text.c_str()), text.size()));
+	ScriptCompilerManager& mgr = ScriptCompilerManager::getSingleton();
+	Any prepared = mgr.prepareScript(stream, group);
+	mListener.mDump.clear();
+	mgr.parsePreparedScript(stream, group, prepared);
+	return mListener.mDump;
+}
+
+static const char* TEST_SCRIPT =
+	"// A comment\n"
+	"abstract material Base\n"
+	"{\n"
+	"	technique\n"
+	"	{\n"
+	"		pass\n"
+	"		{\n"
+	"			diffuse $colour\n"
+	"		}\n"
+	"	}\n"
+	"}\n"
+	"material \"Quoted Name\" : Base\n"
+	"{\n"
+	"	set $colour \"1 0.5 0.25 1\"\n"
+	"	receive_shadows off\n"
+	"}\n";
+
+void ScriptCompilerTests::testCacheMatchesParse()
+{
+	ScriptCompilerManager& mgr = ScriptCompilerManager::getSingleton();
+	mgr.setCacheLocation(StringUtil::BLANK);
+	String parsed = compileScript("test.material", TEST_SCRIPT);
+	MaterialManager::getSingleton().removeAll();
+
+	// Write the cache, then read it back
+	mgr.setCacheLocation(".");
+	String cold = compileScript("test.material", TEST_SCRIPT);
+	MaterialManager::getSingleton().removeAll();
+	String warm = compileScript("test.material", TEST_SCRIPT);
+
+	CPPUNIT_ASSERT(!parsed.empty());
+	CPPUNIT_ASSERT_EQUAL(parsed, cold);
+	CPPUNIT_ASSERT_EQUAL(parsed, warm);
+	MaterialPtr mat = MaterialManager::getSingleton().getByName("Quoted Name");
+	CPPUNIT_ASSERT(!mat.isNull());
+	CPPUNIT_ASSERT(!mat->getReceiveShadows());
+	CPPUNIT_ASSERT_EQUAL(ColourValue(1, 0.5f, 0.25f, 1), 
+		mat->getTechnique(0)->getPass(0)->getDiffuse());
+}
+
+void ScriptCompilerTests::testCacheInvalidatedByChange()
+{
+	String first = compileScript("test.material", TEST_SCRIPT);
+	MaterialManager::getSingleton().removeAll();
+
+	// Same length, different text
+	String changed = StringUtil::replaceAll(TEST_SCRIPT, "off", "on ");
+	String second = compileScript("test.material", changed);
+	CPPUNIT_ASSERT(first != second);
+	MaterialPtr mat = MaterialManager::getSingleton().getByName("Quoted Name");
+	CPPUNIT_ASSERT(mat->getReceiveShadows());
+	MaterialManager::getSingleton().removeAll();
+
+	// Different length
+	changed += "material Extra\n{\n}\n";
+	compileScript("test.material", changed);
+	CPPUNIT_ASSERT(!MaterialManager::getSingleton().getByName("Extra").isNull());
+	MaterialManager::getSingleton().removeAll();
+
+	// And back again
+	String third = compileScript("test.material", TEST_SCRIPT);
+	CPPUNIT_ASSERT_EQUAL(first, third);
+}
+
+void ScriptCompilerTests::testCacheKeepsGroupsApart()
+{
+	ResourceGroupManager::getSingleton().createResourceGroup("Other");
+	String general = compileScript("test.material", TEST_SCRIPT, "General");
+	String other = compileScript("test.material", "material OtherMaterial\n{\n}\n", "Other");
+	MaterialManager::getSingleton().removeAll();
+
+	CPPUNIT_ASSERT_EQUAL(general, compileScript("test.material", TEST_SCRIPT, "General"));
+	CPPUNIT_ASSERT_EQUAL(other, compileScript("test.material", 
+		"material OtherMaterial\n{\n}\n", "Other"));
+}
+
+void ScriptCompilerTests::testCorruptCacheIgnored()
+{
+	String parsed = compileScript("test.material", TEST_SCRIPT);
+	MaterialManager::getSingleton().removeAll();
+
+	// Only the finished cache file should be left behind
+	Archive* arch = ArchiveManager::getSingleton().load(".", "FileSystem");
+	StringVectorPtr files = arch->find("*.scriptcache", false);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, files->size());
+	CPPUNIT_ASSERT(arch->find("*.tmp", false)->empty());
+	ArchiveManager::getSingleton().unload(arch);
+
+	// Scribble over the node data, giving huge counts and string lengths
+	String fileName = files->front();
+	std::ifstream ifs(fileName.c_str(), std::ios::in | std::ios::binary);
+	String data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+	ifs.close();
+	CPPUNIT_ASSERT(data.size() > 200);
+	std::fill(data.begin() + data.size() / 2, data.end(), (char)0xff);
+	std::ofstream ofs(fileName.c_str(), std::ios::out | std::ios::binary);
+	ofs.write(data.c_str(), data.size() / 2 + 16);
+	ofs.close();
+
+	// Falls back to parsing the script, and rewrites the cache
+	CPPUNIT_ASSERT_EQUAL(parsed, compileScript("test.material", TEST_SCRIPT));
+	MaterialManager::getSingleton().removeAll();
+	CPPUNIT_ASSERT_EQUAL(parsed, compileScript("test.material", TEST_SCRIPT));
+}
+
+void ScriptCompilerTests::testCacheBenchmark()
+{
+	// A script with a lot of materials in it
+	const size_t numMaterials = 2000;
+	StringUtil::StrStreamType str;
+	for (size_t i = 0; i < numMaterials; ++i)
+	{
+		str << "material Generated/" << i << "\n{\n"
+			<< "	technique\n	{\n		pass\n		{\n"
+			<< "			ambient 0.5 0.5 0.5\n"
+			<< "			diffuse " << (i % 10) * 0.1f << " 0.2 0.3 1\n"
+			<< "			scene_blend alpha_blend\n"
+			<< "			depth_write off\n"
+			<< "		}\n	}\n}\n";
+	}
+	String text = str.str();
+	ScriptCompilerManager& mgr = ScriptCompilerManager::getSingleton();
+	DataStreamPtr stream(OGRE_NEW MemoryDataStream("generated.material", 
+		const_cast<char*>(text.c_str()), text.size()));
+
+	mgr.setCacheLocation(StringUtil::BLANK);
+	Timer timer;
+	Any parsed = mgr.prepareScript(stream, "General");
+	unsigned long parseUs = timer.getMicroseconds();
+
+	mgr.setCacheLocation(".");
+	stream->seek(0);
+	timer.reset();
+	mgr.prepareScript(stream, "General");
+	unsigned long writeUs = timer.getMicroseconds();
+	Archive* arch = ArchiveManager::getSingleton().load(".", "FileSystem");
+	CPPUNIT_ASSERT_EQUAL((size_t)1, arch->find("*.scriptcache", false)->size());
+	ArchiveManager::getSingleton().unload(arch);
+
+	stream->seek(0);
+	timer.reset();
+	Any cached = mgr.prepareScript(stream, "General");
+	unsigned long readUs = timer.getMicroseconds();
+
+	mgr.parsePreparedScript(stream, "General", cached);
+	String cachedDump = mListener.mDump;
+	CPPUNIT_ASSERT(!MaterialManager::getSingleton().getByName("Generated/1999").isNull());
+	MaterialManager::getSingleton().removeAll();
+	mgr.parsePreparedScript(stream, "General", parsed);
+	CPPUNIT_ASSERT_EQUAL(mListener.mDump, cachedDump);
+
+	LogManager::getSingleton().stream() << "ScriptCompilerTests: " << numMaterials 
+		<< " materials (" << text.size() << " bytes) lexed and parsed in " << parseUs 
+		<< "us, parsed and cached in " << writeUs << "us, read from cache in " << readUs << "us";
+}
@@ -0,0 +1,238 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SkeletalAnimationTests.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreEntity.h"
+#include "OgreSkeletonManager.h"
+#include "OgreSkeletonInstance.h"
+#include "OgreBone.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationState.h"
+#include "OgreKeyFrame.h"
+#include "OgreMeshManager.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "OgreParallelTaskGroup.h"
+#include "OgreTimer.h"
+#include "OgreLogManager.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( SkeletalAnimationTests );
+
+/// Evaluates one skeleton, as the scene manager's tasks do
+class BoneMatricesTask : public ParallelTaskGroup::Task
+{
+public:
+	Entity* entity;
+	BoneMatricesTask(Entity* e) : entity(e) {}
+	void execute() { entity->_updateBoneMatrices(); }
+};
+
+void SkeletalAnimationTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mBufMgr = OGRE_NEW DefaultHardwareBufferManager();
+	// No render system here, so workers must not try to use it
+	mQueue = OGRE_NEW DefaultWorkQueue("SkeletalAnimationTests");
+	mQueue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(mQueue);
+	mQueue->startup();
+	mSceneMgr = mRoot->createSceneManager(ST_GENERIC);
+}
+void SkeletalAnimationTests::tearDown()
+{
+	mMesh.setNull();
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mBufMgr;
+}
+
+void SkeletalAnimationTests::createSkeletalMesh(size_t numChains, size_t chainLength,
+	Animation::InterpolationMode im)
+{
+	SkeletonPtr skel = SkeletonManager::getSingleton().create("TestSkeleton",
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true);
+	Bone* root = skel->createBone("root");
+	for (size_t c = 0; c < numChains; ++c)
+	{
+		Bone* parent = root;
+		for (size_t b = 0; b < chainLength; ++b)
+		{
+			Bone* bone = parent->createChild(skel->getNumBones(), 
+				Vector3(Math::RangeRandom(-1, 1), 1, Math::RangeRandom(-1, 1)));
+			parent = bone;
+		}
+	}
+	skel->setBindingPose();
+
+	Animation* anim = skel->createAnimation("Walk", 2.0f);
+	anim->setInterpolationMode(im);
+	for (unsigned short h = 0; h < skel->getNumBones(); ++h)
+	{
+		NodeAnimationTrack* track = anim->createNodeTrack(h, skel->getBone(h));
+		for (size_t k = 0; k <= 8; ++k)
+		{
+			TransformKeyFrame* kf = track->createNodeKeyFrame(k * 0.25f);
+			kf->setRotation(Quaternion(Degree(Math::RangeRandom(-45, 45)), Vector3::UNIT_X) *
+				Quaternion(Degree(Math::RangeRandom(-45, 45)), Vector3::UNIT_Z));
+			kf->setTranslate(Vector3(0, Math::RangeRandom(-0.1f, 0.1f), 0));
+		}
+	}
+
+	mMesh = MeshManager::getSingleton().createManual("TestMesh", 
+		ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+	mMesh->_notifySkeleton(skel);
+	mMesh->_setBounds(AxisAlignedBox(-Vector3::UNIT_SCALE, Vector3::UNIT_SCALE));
+	mMesh->load();
+}
+
+void SkeletalAnimationTests::createEntities(const String& prefix, size_t count, 
+	vector<Entity*>::type& entities)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Entity* ent = mSceneMgr->createEntity(prefix + StringConverter::toString(i), mMesh->getName());
+		mSceneMgr->getRootSceneNode()->createChildSceneNode()->attachObject(ent);
+		AnimationState* state = ent->getAnimationState("Walk");
+		state->setEnabled(true);
+		state->setTimePosition(i * 0.0137f);
+		entities.push_back(ent);
+	}
+}
+
+void SkeletalAnimationTests::updateParallel(vector<Entity*>::type& entities)
+{
+	vector<BoneMatricesTask>::type tasks;
+	set<SkeletonInstance*>::type skeletons;
+	for (vector<Entity*>::type::iterator i = entities.begin(); i != entities.end(); ++i)
+	{
+		if (!skeletons.insert((*i)->getSkeleton()).second)
+			continue;
+		(*i)->getSkeleton()->_prepareAnimationState(*(*i)->getAllAnimationStates());
+		tasks.push_back(BoneMatricesTask(*i));
+	}
+	ParallelTaskGroup group("SkeletalAnimationTests");
+	for (vector<BoneMatricesTask>::type::iterator i = tasks.begin(); i != tasks.end(); ++i)
+		group.addTask(&(*i));
+	group.run();
+	// Anything else updateAnimation does, the bones are already up to date
+	for (vector<Entity*>::type::iterator i = entities.begin(); i != entities.end(); ++i)
+		(*i)->_updateAnimation();
+}
+
+void SkeletalAnimationTests::checkBoneMatricesEqual(Entity* a, Entity* b)
+{
+	CPPUNIT_ASSERT_EQUAL(a->_getNumBoneMatrices(), b->_getNumBoneMatrices());
+	CPPUNIT_ASSERT(memcmp(a->_getBoneMatrices(), b->_getBoneMatrices(), 
+		sizeof(Matrix4) * a->_getNumBoneMatrices()) == 0);
+}
+
+void SkeletalAnimationTests::testParallelMatchesSerial()
+{
+	// Spline interpolation is built on demand, so must be prepared first
+	createSkeletalMesh(4, 6, Animation::IM_SPLINE);
+	vector<Entity*>::type serial, parallel;
+	createEntities("s", 64, serial);
+	createEntities("p", 64, parallel);
+
+	for (size_t i = 0; i < serial.size(); ++i)
+		serial[i]->_updateAnimation();
+	updateParallel(parallel);
+
+	for (size_t i = 0; i < serial.size(); ++i)
+	{
+		checkBoneMatricesEqual(serial[i], parallel[i]);
+	}
+	// Different times must give different poses
+	CPPUNIT_ASSERT(memcmp(serial[0]->_getBoneMatrices(), serial[1]->_getBoneMatrices(),
+		sizeof(Matrix4) * serial[0]->_getNumBoneMatrices()) != 0);
+}
+
+void SkeletalAnimationTests::testSharedSkeletonInstance()
+{
+	createSkeletalMesh(2, 4, Animation::IM_LINEAR);
+	vector<Entity*>::type expected, entities;
+	createEntities("e", 1, expected);
+	createEntities("p", 4, entities);
+	// Entities sharing a skeleton instance share its animation states too
+	for (size_t i = 1; i < entities.size(); ++i)
+		entities[i]->shareSkeletonInstanceWith(entities[0]);
+	entities[0]->getAnimationState("Walk")->setTimePosition(0.5f);
+	expected[0]->getAnimationState("Walk")->setTimePosition(0.5f);
+
+	expected[0]->_updateAnimation();
+	updateParallel(entities);
+
+	for (size_t i = 0; i < entities.size(); ++i)
+	{
+		checkBoneMatricesEqual(expected[0], entities[i]);
+	}
+}
+
+void SkeletalAnimationTests::testParallelSkeletonBenchmark()
+{
+	createSkeletalMesh(5, 10, Animation::IM_LINEAR);
+	vector<Entity*>::type entities;
+	createEntities("e", 500, entities);
+	const size_t frames = 20;
+
+	Timer timer;
+	unsigned long serialTime, parallelTime;
+	timer.reset();
+	for (size_t f = 0; f < frames; ++f)
+	{
+		// Bones are only evaluated once per frame number
+		mRoot->_fireFrameStarted();
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			entities[i]->getAnimationState("Walk")->addTime(0.016f);
+			entities[i]->_updateAnimation();
+		}
+		mRoot->_fireFrameRenderingQueued();
+		mRoot->_fireFrameEnded();
+	}
+	serialTime = timer.getMicroseconds();
+
+	timer.reset();
+	for (size_t f = 0; f < frames; ++f)
+	{
+		mRoot->_fireFrameStarted();
+		for (size_t i = 0; i < entities.size(); ++i)
+			entities[i]->getAnimationState("Walk")->addTime(0.016f);
+		updateParallel(entities);
+		mRoot->_fireFrameRenderingQueued();
+		mRoot->_fireFrameEnded();
+	}
+	parallelTime = timer.getMicroseconds();
+
+	LogManager::getSingleton().stream() << "Skeletal animation of " << entities.size() 
+		<< " entities with " << entities[0]->getSkeleton()->getNumBones() 
+		<< " bones: serial " << serialTime / frames << "us/frame, parallel " 
+		<< parallelTime / frames << "us/frame";
+}
@@ -0,0 +1,220 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "SoftwareAnimationBatchTests.h"
+#include "OgreRoot.h"
+#include "OgreMesh.h"
+#include "OgreSoftwareAnimationBatch.h"
+#include "OgreDefaultHardwareBufferManager.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( SoftwareAnimationBatchTests );
+
+void SoftwareAnimationBatchTests::setUp()
+{
+	srand(12345);
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mBufMgr = OGRE_NEW DefaultHardwareBufferManager();
+	// No render system here, so workers must not try to use it
+	mQueue = OGRE_NEW DefaultWorkQueue("SoftwareAnimationBatchTests");
+	mQueue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(mQueue);
+	mQueue->startup();
+	mTaskGroup = OGRE_NEW ParallelTaskGroup("SoftwareAnimationBatchTests");
+
+	for (size_t i = 0; i < 4; ++i)
+	{
+		mMatrices[i].makeTransform(
+			Vector3(Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10), Math::RangeRandom(-10, 10)),
+			Vector3(Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2), Math::RangeRandom(0.5, 2)),
+			Quaternion(Degree(Math::RangeRandom(0, 360)), Vector3::UNIT_Z));
+	}
+}
+void SoftwareAnimationBatchTests::tearDown()
+{
+	for (vector<VertexData*>::type::iterator i = mVertexData.begin(); i != mVertexData.end(); ++i)
+		OGRE_DELETE *i;
+	mVertexData.clear();
+	OGRE_DELETE mTaskGroup;
+	OGRE_DELETE mRoot;
+	OGRE_DELETE mBufMgr;
+}
+
+VertexData* SoftwareAnimationBatchTests::createVertexData(size_t numVertices, 
+	bool normals, bool blendData)
+{
+	VertexData* data = OGRE_NEW VertexData();
+	mVertexData.push_back(data);
+	data->vertexCount = numVertices;
+
+	VertexDeclaration* decl = data->vertexDeclaration;
+	size_t offset = 0;
+	offset += decl->addElement(0, offset, VET_FLOAT3, VES_POSITION).getSize();
+	if (normals)
+		offset += decl->addElement(0, offset, VET_FLOAT3, VES_NORMAL).getSize();
+	HardwareVertexBufferSharedPtr buf = mBufMgr->createVertexBuffer(
+		offset, numVertices, HardwareBuffer::HBU_DYNAMIC);
+	data->vertexBufferBinding->setBinding(0, buf);
+	float* pFloat = static_cast<float*>(buf->lock(HardwareBuffer::HBL_DISCARD));
+	for (size_t i = 0; i < numVertices * offset / sizeof(float); ++i)
+		*pFloat++ = Math::RangeRandom(-100, 100);
+	buf->unlock();
+
+	if (blendData)
+	{
+		offset = 0;
+		offset += decl->addElement(1, offset, VET_UBYTE4, VES_BLEND_INDICES).getSize();
+		offset += decl->addElement(1, offset, VET_FLOAT2, VES_BLEND_WEIGHTS).getSize();
+		buf = mBufMgr->createVertexBuffer(offset, numVertices, HardwareBuffer::HBU_STATIC);
+		data->vertexBufferBinding->setBinding(1, buf);
+		unsigned char* pBase = static_cast<unsigned char*>(buf->lock(HardwareBuffer::HBL_DISCARD));
+		for (size_t i = 0; i < numVertices; ++i, pBase += offset)
+		{
+			for (size_t b = 0; b < 4; ++b)
+				pBase[b] = static_cast<unsigned char>(rand() % 4);
+			float* pWeight = reinterpret_cast<float*>(pBase + 4);
+			pWeight[0] = Math::UnitRandom();
+			pWeight[1] = 1.0f - pWeight[0];
+		}
+		buf->unlock();
+	}
+	return data;
+}
+
+HardwareVertexBufferSharedPtr SoftwareAnimationBatchTests::createPositionBuffer(
+	size_t numVertices, Real offset)
+{
+	HardwareVertexBufferSharedPtr buf = mBufMgr->createVertexBuffer(
+		sizeof(float) * 3, numVertices, HardwareBuffer::HBU_STATIC);
+	float* pFloat = static_cast<float*>(buf->lock(HardwareBuffer::HBL_DISCARD));
+	for (size_t i = 0; i < numVertices * 3; ++i)
+		*pFloat++ = Math::RangeRandom(-100, 100) + offset;
+	buf->unlock();
+	return buf;
+}
+
+void SoftwareAnimationBatchTests::checkBuffersEqual(const HardwareVertexBufferSharedPtr& a,
+	const HardwareVertexBufferSharedPtr& b)
+{
+	CPPUNIT_ASSERT(!a->isLocked() && !b->isLocked());
+	CPPUNIT_ASSERT_EQUAL(a->getSizeInBytes(), b->getSizeInBytes());
+	const void* pA = a->lock(HardwareBuffer::HBL_READ_ONLY);
+	const void* pB = b->lock(HardwareBuffer::HBL_READ_ONLY);
+	bool equal = memcmp(pA, pB, a->getSizeInBytes()) == 0;
+	a->unlock();
+	b->unlock();
+	CPPUNIT_ASSERT(equal);
+}
+
+void SoftwareAnimationBatchTests::testSkinningMatchesImmediate()
+{
+	const size_t numVertices = 1000;
+	const size_t numJobs = 8;
+	const Matrix4* blendMatrices[4] = { &mMatrices[0], &mMatrices[1], &mMatrices[2], &mMatrices[3] };
+
+	// Every job skins the same source, as entities sharing a mesh do
+	VertexData* src = createVertexData(numVertices, true, true);
+	VertexData* expected = createVertexData(numVertices, true, false);
+	Mesh::softwareVertexBlend(src, expected, blendMatrices, 4, true);
+
+	SoftwareAnimationBatch batch(mTaskGroup);
+	vector<VertexData*>::type targets;
+	for (size_t j = 0; j < numJobs; ++j)
+	{
+		VertexData* target = createVertexData(numVertices, true, false);
+		targets.push_back(target);
+		batch.beginJob();
+		Mesh::softwareVertexBlend(src, target, blendMatrices, 4, true, &batch);
+	}
+	// Nothing is done until the batch is executed
+	CPPUNIT_ASSERT(!batch.isEmpty());
+	CPPUNIT_ASSERT(src->vertexBufferBinding->getBuffer(0)->isLocked());
+	batch.execute();
+	CPPUNIT_ASSERT(batch.isEmpty());
+	CPPUNIT_ASSERT_EQUAL(numJobs, batch.getNumJobsExecuted());
+
+	CPPUNIT_ASSERT(!src->vertexBufferBinding->getBuffer(0)->isLocked());
+	CPPUNIT_ASSERT(!src->vertexBufferBinding->getBuffer(1)->isLocked());
+	for (size_t j = 0; j < numJobs; ++j)
+	{
+		checkBuffersEqual(expected->vertexBufferBinding->getBuffer(0),
+			targets[j]->vertexBufferBinding->getBuffer(0));
+	}
+}
+
+void SoftwareAnimationBatchTests::testMorphAndPoseMatchImmediate()
+{
+	const size_t numVertices = 500;
+	const size_t numJobs = 4;
+	HardwareVertexBufferSharedPtr key1 = createPositionBuffer(numVertices, 0);
+	HardwareVertexBufferSharedPtr key2 = createPositionBuffer(numVertices, 50);
+	map<size_t, Vector3>::type offsets;
+	for (size_t i = 0; i < numVertices; i += 3)
+		offsets[i] = Vector3(Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1), Math::RangeRandom(-1, 1));
+
+	// The pose blend must see the result of the morph before it
+	VertexData* expected = createVertexData(numVertices, false, false);
+	Mesh::softwareVertexMorph(0.3f, key1, key2, expected);
+	Mesh::softwareVertexPoseBlend(0.7f, offsets, expected);
+
+	SoftwareAnimationBatch batch(mTaskGroup);
+	vector<VertexData*>::type targets;
+	for (size_t j = 0; j < numJobs; ++j)
+	{
+		VertexData* target = createVertexData(numVertices, false, false);
+		targets.push_back(target);
+		batch.beginJob();
+		Mesh::softwareVertexMorph(0.3f, key1, key2, target, &batch);
+		Mesh::softwareVertexPoseBlend(0.7f, offsets, target, &batch);
+	}
+	batch.execute();
+	CPPUNIT_ASSERT_EQUAL(numJobs, batch.getNumJobsExecuted());
+
+	CPPUNIT_ASSERT(!key1->isLocked() && !key2->isLocked());
+	for (size_t j = 0; j < numJobs; ++j)
+	{
+		checkBuffersEqual(expected->vertexBufferBinding->getBuffer(0),
+			targets[j]->vertexBufferBinding->getBuffer(0));
+	}
+}
+
+void SoftwareAnimationBatchTests::testReadOnlyLockConflict()
+{
+	HardwareVertexBufferSharedPtr buf = createPositionBuffer(10, 0);
+	SoftwareAnimationBatch batch(mTaskGroup);
+
+	void* pRead = batch.lockBuffer(buf, HardwareBuffer::HBL_READ_ONLY);
+	// Locking again gives the same data
+	CPPUNIT_ASSERT_EQUAL(pRead, batch.lockBuffer(buf, HardwareBuffer::HBL_READ_ONLY));
+	// But other jobs may be reading it, so it can't be written
+	CPPUNIT_ASSERT_THROW(batch.lockBuffer(buf, HardwareBuffer::HBL_NORMAL), Exception);
+
+	batch.execute();
+	CPPUNIT_ASSERT(!buf->isLocked());
+	CPPUNIT_ASSERT(batch.isEmpty());
+}
@@ -0,0 +1,403 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "TextureStreamerTests.h"
+#include "OgreRoot.h"
+#include "OgreTextureStreamer.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreImageCodec.h"
+#include "OgreImage.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+#include <cstdio>
+#include <fstream>
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( TextureStreamerTests );
+
+StubPixelBuffer::StubPixelBuffer(size_t width, size_t height, PixelFormat format)
+	: HardwarePixelBuffer(width, height, 1, format, HBU_STATIC_WRITE_ONLY, true, false)
+	, mData(PixelUtil::getMemorySize(width, height, 1, format))
+{
+}
+PixelBox StubPixelBuffer::lockImpl(const Image::Box lockBox, LockOptions options)
+{
+	return PixelBox(mWidth, mHeight, mDepth, mFormat, &mData[0]).getSubVolume(lockBox);
+}
+void StubPixelBuffer::blitFromMemory(const PixelBox& src, const Image::Box& dstBox)
+{
+	PixelUtil::bulkPixelConversion(src, lockImpl(dstBox, HBL_NORMAL));
+}
+void StubPixelBuffer::blitToMemory(const Image::Box& srcBox, const PixelBox& dst)
+{
+	PixelUtil::bulkPixelConversion(lockImpl(srcBox, HBL_READ_ONLY), dst);
+}
+void StubPixelBuffer::readData(size_t offset, size_t length, void* pDest)
+{
+	memcpy(pDest, &mData[offset], length);
+}
+void StubPixelBuffer::writeData(size_t offset, size_t length, const void* pSource, bool discardWholeBuffer)
+{
+	memcpy(&mData[offset], pSource, length);
+}
+
+StubTexture::StubTexture(ResourceManager* creator, const String& name, ResourceHandle handle,
+	const String& group, bool isManual, ManualResourceLoader* loader)
+	: Texture(creator, name, handle, group, isManual, loader)
+{
+}
+StubTexture::~StubTexture()
+{
+	if (isLoaded())
+		unload();
+	else
+		freeInternalResources();
+}
+void StubTexture::createInternalResourcesImpl(void)
+{
+	for (size_t face = 0; face < getNumFaces(); ++face)
+	{
+		size_t width = mWidth, height = mHeight;
+		for (size_t mip = 0; mip <= mNumMipmaps; ++mip)
+		{
+			mBuffers.push_back(HardwarePixelBufferSharedPtr(
+				OGRE_NEW StubPixelBuffer(width, height, mFormat)));
+			if (width != 1) width /= 2;
+			if (height != 1) height /= 2;
+		}
+	}
+}
+void StubTexture::freeInternalResourcesImpl(void)
+{
+	mBuffers.clear();
+}
+HardwarePixelBufferSharedPtr StubTexture::getBuffer(size_t face, size_t mipmap)
+{
+	return mBuffers[face * (mNumMipmaps + 1) + mipmap];
+}
+
+StubTextureManager::StubTextureManager()
+{
+	ResourceGroupManager::getSingleton()._registerResourceManager(mResourceType, this);
+}
+StubTextureManager::~StubTextureManager()
+{
+	ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
+}
+Resource* StubTextureManager::createImpl(const String& name, ResourceHandle handle, 
+	const String& group, bool isManual, ManualResourceLoader* loader, 
+	const NameValuePairList* createParams)
+{
+	return OGRE_NEW StubTexture(this, name, handle, group, isManual, loader);
+}
+
+void TextureStreamerTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	mTextureManager = OGRE_NEW StubTextureManager();
+	ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem", "TextureStreamerTests");
+	// The work queue isn't started, requests are run by processStreamRequests
+	TextureStreamer::getSingleton().initialise();
+}
+void TextureStreamerTests::tearDown()
+{
+	TextureStreamer::getSingleton().shutdown();
+	OGRE_DELETE mTextureManager;
+	OGRE_DELETE mRoot;
+	for (StringVector::iterator i = mFileNames.begin(); i != mFileNames.end(); ++i)
+		::remove(i->c_str());
+	mFileNames.clear();
+}
+
+void TextureStreamerTests::writeDDS(const String& name, size_t width, size_t height, 
+	bool withPitch)
+{
+	size_t numMipmaps = 1;
+	while (std::max(width, height) >> numMipmaps)
+		++numMipmaps;
+
+	// A8R8G8B8 with a mipmap chain
+	uint32 header[32];
+	memset(header, 0, sizeof(header));
+	header[0] = 0x20534444; // 'DDS '
+	header[1] = 124;
+	header[2] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+	header[3] = static_cast<uint32>(height);
+	header[4] = static_cast<uint32>(width);
+	header[7] = static_cast<uint32>(numMipmaps);
+	if (withPitch)
+	{
+		header[2] |= 0x8;
+		header[5] = static_cast<uint32>(width * 4);
+	}
+	header[19] = 32;
+	header[20] = 0x41;
+	header[22] = 32;
+	header[23] = 0x00FF0000;
+	header[24] = 0x0000FF00;
+	header[25] = 0x000000FF;
+	header[26] = 0xFF000000;
+	header[27] = 0x1000 | 0x400000 | 0x8;
+
+	std::ofstream file(name.c_str(), std::ios::binary);
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	for (size_t mip = 0; mip < numMipmaps; ++mip)
+	{
+		vector<uint32>::type level(std::max((size_t)1, width >> mip) * 
+			std::max((size_t)1, height >> mip), 0x01010101 * static_cast<uint32>(mip + 1));
+		file.write(reinterpret_cast<const char*>(&level[0]), level.size() * sizeof(uint32));
+	}
+	mFileNames.push_back(name);
+}
+
+void TextureStreamerTests::processStreamRequests(size_t maxRequests)
+{
+	DefaultWorkQueue* queue = static_cast<DefaultWorkQueue*>(mRoot->getWorkQueue());
+	uint16 channel = queue->getChannel("Ogre/TextureStreamer");
+	for (size_t i = 0; i < maxRequests && queue->getChannelStatistics(channel).queueDepth; ++i)
+		queue->_processNextRequest();
+	queue->processResponses();
+}
+
+uint32 TextureStreamerTests::getTexel(const TexturePtr& tex, size_t mip)
+{
+	HardwarePixelBufferSharedPtr buf = tex->getBuffer(0, mip);
+	vector<uint32>::type data(buf->getWidth() * buf->getHeight());
+	buf->blitToMemory(PixelBox(buf->getWidth(), buf->getHeight(), 1, PF_A8R8G8B8, &data[0]));
+	return data[0];
+}
+
+void TextureStreamerTests::testDecodeMipmaps()
+{
+	writeDDS("TextureStreamerTests_a.dds", 64, 32);
+	DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(
+		"TextureStreamerTests_a.dds", "TextureStreamerTests");
+	ImageCodec* codec = static_cast<ImageCodec*>(Codec::getCodec("dds"));
+
+	Codec::CodecDataPtr header = codec->decodeHeader(stream);
+	ImageCodec::ImageData* info = static_cast<ImageCodec::ImageData*>(header.getPointer());
+	CPPUNIT_ASSERT_EQUAL((size_t)64, info->width);
+	CPPUNIT_ASSERT_EQUAL((size_t)32, info->height);
+	CPPUNIT_ASSERT_EQUAL((ushort)6, info->num_mipmaps);
+	CPPUNIT_ASSERT_EQUAL(PF_A8R8G8B8, info->format);
+
+	// Only the levels from 16x8 down are decoded
+	stream->seek(0);
+	Codec::DecodeResult res = codec->decodeMipmaps(stream, 2);
+	info = static_cast<ImageCodec::ImageData*>(res.second.getPointer());
+	CPPUNIT_ASSERT_EQUAL((size_t)16, info->width);
+	CPPUNIT_ASSERT_EQUAL((size_t)8, info->height);
+	CPPUNIT_ASSERT_EQUAL((ushort)4, info->num_mipmaps);
+	CPPUNIT_ASSERT_EQUAL(Image::calculateSize(4, 1, 16, 8, 1, PF_A8R8G8B8), info->size);
+	const uint32* texels = reinterpret_cast<const uint32*>(res.first->getPtr());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x03030303, texels[0]);
+	CPPUNIT_ASSERT_EQUAL((uint32)0x07070707, texels[info->size / sizeof(uint32) - 1]);
+
+	// A full decode still has every level in the right place
+	stream->seek(0);
+	Image image;
+	image.load(stream, "dds");
+	CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumMipmaps());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x01010101, *static_cast<uint32*>(image.getPixelBox(0, 0).data));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x05050505, *static_cast<uint32*>(image.getPixelBox(0, 4).data));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x07070707, *static_cast<uint32*>(image.getPixelBox(0, 6).data));
+}
+
+void TextureStreamerTests::testDecodeUncompressedMipmaps()
+{
+	// Each level has its own height, and a pitch which halves from the 
+	// one in the header
+	writeDDS("TextureStreamerTests_a.dds", 64, 32, true);
+	DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(
+		"TextureStreamerTests_a.dds", "TextureStreamerTests");
+	Image image;
+	image.load(stream, "dds");
+	CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumMipmaps());
+	for (size_t mip = 0; mip <= image.getNumMipmaps(); ++mip)
+	{
+		PixelBox box = image.getPixelBox(0, mip);
+		CPPUNIT_ASSERT_EQUAL(std::max((size_t)1, (size_t)64 >> mip), box.getWidth());
+		CPPUNIT_ASSERT_EQUAL(std::max((size_t)1, (size_t)32 >> mip), box.getHeight());
+		const uint32* texels = static_cast<const uint32*>(box.data);
+		uint32 expected = 0x01010101 * static_cast<uint32>(mip + 1);
+		CPPUNIT_ASSERT_EQUAL(expected, texels[0]);
+		CPPUNIT_ASSERT_EQUAL(expected, texels[box.getWidth() * box.getHeight() - 1]);
+	}
+
+	// Skipping to a level finds the same data
+	stream->seek(0);
+	ImageCodec* codec = static_cast<ImageCodec*>(Codec::getCodec("dds"));
+	Codec::DecodeResult res = codec->decodeMipmaps(stream, 3);
+	const uint32* texels = reinterpret_cast<const uint32*>(res.first->getPtr());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x04040404, texels[0]);
+	CPPUNIT_ASSERT_EQUAL((uint32)0x07070707, texels[res.first->size() / sizeof(uint32) - 1]);
+}
+
+void TextureStreamerTests::testLoadTail()
+{
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	TexturePtr tex = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+
+	// Only the levels up to 64x64 are read
+	CPPUNIT_ASSERT(tex->isLoaded());
+	CPPUNIT_ASSERT(streamer.isStreaming(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)64, tex->getWidth());
+	CPPUNIT_ASSERT_EQUAL((size_t)6, tex->getNumMipmaps());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer.getResidentMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x03030303, getTexel(tex, 0));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x09090909, getTexel(tex, 6));
+	CPPUNIT_ASSERT_EQUAL(Image::calculateSize(6, 1, 64, 64, 1, PF_A8R8G8B8), 
+		streamer.getMemoryUsage());
+
+	// Loading again gives the same texture
+	CPPUNIT_ASSERT(tex == streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests"));
+}
+
+void TextureStreamerTests::testStreamOnDemand()
+{
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	TexturePtr tex = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+
+	// Drawn small, the tail is enough
+	streamer.notifyScreenSize(tex, 40);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer.getWantedMipmap(tex->getName()));
+
+	// Drawn at 100 pixels it needs the 128x128 level, which arrives once read
+	streamer.notifyScreenSize(tex, 100);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getWantedMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer.getResidentMipmap(tex->getName()));
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getResidentMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)128, tex->getWidth());
+	CPPUNIT_ASSERT_EQUAL((size_t)7, tex->getNumMipmaps());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x02020202, getTexel(tex, 0));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x09090909, getTexel(tex, 7));
+
+	streamer.notifyScreenSize(tex, 1000);
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer.getResidentMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)256, tex->getWidth());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x01010101, getTexel(tex, 0));
+	CPPUNIT_ASSERT_EQUAL(Image::calculateSize(8, 1, 256, 256, 1, PF_A8R8G8B8), 
+		streamer.getMemoryUsage());
+}
+
+void TextureStreamerTests::testScreenSizePriority()
+{
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	writeDDS("TextureStreamerTests_b.dds", 256, 256);
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	TexturePtr a = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+	TexturePtr b = streamer.load("TextureStreamerTests_b.dds", "TextureStreamerTests");
+
+	// The texture covering more of the screen is read first
+	streamer.notifyScreenSize(a, 100);
+	streamer.notifyScreenSize(b, 250);
+	processStreamRequests(1);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer.getResidentMipmap(a->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer.getResidentMipmap(b->getName()));
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getResidentMipmap(a->getName()));
+}
+
+void TextureStreamerTests::testMemoryBudget()
+{
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	writeDDS("TextureStreamerTests_b.dds", 256, 256);
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	TexturePtr a = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+	TexturePtr b = streamer.load("TextureStreamerTests_b.dds", "TextureStreamerTests");
+	streamer.notifyScreenSize(a, 256);
+	streamer.notifyScreenSize(b, 256);
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer.getResidentMipmap(a->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer.getResidentMipmap(b->getName()));
+
+	// Next frame only b is drawn, so a gives up its largest level to fit the budget
+	mRoot->_fireFrameRenderingQueued();
+	streamer.notifyScreenSize(b, 256);
+	size_t budget = Image::calculateSize(8, 1, 256, 256, 1, PF_A8R8G8B8) + 
+		Image::calculateSize(7, 1, 128, 128, 1, PF_A8R8G8B8);
+	streamer.setMemoryBudget(budget);
+	CPPUNIT_ASSERT_EQUAL(budget, streamer.getMemoryUsage());
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getResidentMipmap(a->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, streamer.getResidentMipmap(b->getName()));
+	// The levels kept are read back from the texture
+	CPPUNIT_ASSERT_EQUAL((size_t)128, a->getWidth());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x02020202, getTexel(a, 0));
+	CPPUNIT_ASSERT_EQUAL((uint32)0x09090909, getTexel(a, 7));
+
+	// Both are drawn now, and nothing else can be reduced, so a has to wait
+	streamer.notifyScreenSize(a, 256);
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getResidentMipmap(a->getName()));
+	CPPUNIT_ASSERT(streamer.getMemoryUsage() <= budget);
+}
+
+void TextureStreamerTests::testReload()
+{
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	TexturePtr tex = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+	streamer.notifyScreenSize(tex, 256);
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)256, tex->getWidth());
+
+	// A reloaded texture starts again from its tail
+	tex->reload();
+	CPPUNIT_ASSERT(tex->isLoaded());
+	CPPUNIT_ASSERT_EQUAL((size_t)2, streamer.getResidentMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)64, tex->getWidth());
+	CPPUNIT_ASSERT_EQUAL((uint32)0x03030303, getTexel(tex, 0));
+
+	streamer.remove(tex->getName());
+	CPPUNIT_ASSERT(!streamer.isStreaming(tex->getName()));
+
+	// No longer ours to load
+	CPPUNIT_ASSERT(!tex->isManuallyLoaded());
+	tex->reload();
+	CPPUNIT_ASSERT(tex->isLoaded());
+}
+
+void TextureStreamerTests::testShutdownTwice()
+{
+	// Root shuts the streamer down and then deletes it, which shuts it down again
+	TextureStreamer& streamer = TextureStreamer::getSingleton();
+	streamer.shutdown();
+	streamer.shutdown();
+
+	// It still registers and streams as usual afterwards
+	streamer.initialise();
+	writeDDS("TextureStreamerTests_a.dds", 256, 256);
+	TexturePtr tex = streamer.load("TextureStreamerTests_a.dds", "TextureStreamerTests");
+	streamer.notifyScreenSize(tex, 100);
+	processStreamRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)1, streamer.getResidentMipmap(tex->getName()));
+	CPPUNIT_ASSERT_EQUAL((size_t)128, tex->getWidth());
+}
@@ -0,0 +1,306 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "TiledImageTests.h"
+#include "OgreRoot.h"
+#include "OgreDataStream.h"
+#include <fstream>
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( TiledImageTests );
+
+void TiledImageTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+}
+void TiledImageTests::tearDown()
+{
+	OGRE_DELETE mRoot;
+}
+
+uint16 TiledImageTests::heightAt(size_t x, size_t y)
+{
+	return static_cast<uint16>(x * 257 + y * 31);
+}
+
+DataStreamPtr TiledImageTests::createRawHeightmap(size_t width, size_t height)
+{
+	MemoryDataStream* stream = OGRE_NEW MemoryDataStream(width * height * sizeof(uint16));
+	uint16* data = reinterpret_cast<uint16*>(stream->getPtr());
+	for (size_t y = 0; y < height; ++y)
+		for (size_t x = 0; x < width; ++x)
+			data[y * width + x] = heightAt(x, y);
+	return DataStreamPtr(stream);
+}
+
+DataStreamPtr TiledImageTests::saveAndOpenDDS(Image& image, const String& fileName)
+{
+	image.save(fileName);
+	std::ifstream* file = OGRE_NEW_T(std::ifstream, MEMCATEGORY_GENERAL)(
+		fileName.c_str(), std::ios::in | std::ios::binary);
+	CPPUNIT_ASSERT(file->is_open());
+	return DataStreamPtr(OGRE_NEW FileStreamDataStream(fileName, file));
+}
+
+void TiledImageTests::testRawRegions()
+{
+	const size_t width = 300, height = 200;
+	TiledImage image(OGRE_NEW RawImageRegionReader(createRawHeightmap(width, height), 
+		width, height, PF_L16), 64);
+	CPPUNIT_ASSERT_EQUAL(width, image.getWidth());
+	CPPUNIT_ASSERT_EQUAL(height, image.getHeight());
+	CPPUNIT_ASSERT_EQUAL(PF_L16, image.getFormat());
+	CPPUNIT_ASSERT_EQUAL((size_t)5, image.getNumTilesX());
+	CPPUNIT_ASSERT_EQUAL((size_t)4, image.getNumTilesY());
+	Box edge = image.getTileBox(4, 3);
+	CPPUNIT_ASSERT_EQUAL((size_t)256, edge.left);
+	CPPUNIT_ASSERT_EQUAL((size_t)300, edge.right);
+	CPPUNIT_ASSERT_EQUAL((size_t)192, edge.top);
+	CPPUNIT_ASSERT_EQUAL((size_t)200, edge.bottom);
+
+	// Regions within a tile, across tiles, and the whole image
+	const Box regions[] = { Box(3, 5, 20, 9), Box(50, 60, 190, 170), Box(0, 0, width, height) };
+	for (size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); ++r)
+	{
+		const Box& region = regions[r];
+		vector<uint16>::type data(region.getWidth() * region.getHeight());
+		image.readRegion(region, PixelBox(region.getWidth(), region.getHeight(), 1, PF_L16, &data[0]));
+		vector<float>::type floats(data.size());
+		image.readRegion(region, PixelBox(region.getWidth(), region.getHeight(), 1, PF_FLOAT32_R, &floats[0]));
+
+		for (size_t y = 0; y < region.getHeight(); ++y)
+		{
+			for (size_t x = 0; x < region.getWidth(); ++x)
+			{
+				uint16 expected = heightAt(region.left + x, region.top + y);
+				CPPUNIT_ASSERT_EQUAL(expected, data[y * region.getWidth() + x]);
+				CPPUNIT_ASSERT_DOUBLES_EQUAL(expected / 65535.0, floats[y * region.getWidth() + x], 1e-6);
+			}
+		}
+	}
+
+	// Into a box within a larger one
+	vector<uint16>::type larger(40 * 30, 0xCDCD);
+	PixelBox dst = PixelBox(40, 30, 1, PF_L16, &larger[0]).getSubVolume(Box(10, 5, 30, 25));
+	image.readRegion(Box(120, 110, 140, 130), dst);
+	for (size_t y = 0; y < 30; ++y)
+	{
+		for (size_t x = 0; x < 40; ++x)
+		{
+			if (x >= 10 && x < 30 && y >= 5 && y < 25)
+				CPPUNIT_ASSERT_EQUAL(heightAt(x + 110, y + 105), larger[y * 40 + x]);
+			else
+				CPPUNIT_ASSERT_EQUAL((uint16)0xCDCD, larger[y * 40 + x]);
+		}
+	}
+}
+
+void TiledImageTests::testRawOffsetAndPitch()
+{
+	// A header of 12 bytes, and 5 pixels of padding on each row
+	const size_t width = 50, height = 40, header = 12, pitch = (width + 5) * 2;
+	MemoryDataStream* stream = OGRE_NEW MemoryDataStream(header + pitch * height);
+	memset(stream->getPtr(), 0xFF, header + pitch * height);
+	for (size_t y = 0; y < height; ++y)
+		for (size_t x = 0; x < width; ++x)
+			reinterpret_cast<uint16*>(stream->getPtr() + header + y * pitch)[x] = heightAt(x, y);
+
+	RawImageRegionReader reader(DataStreamPtr(stream), width, height, PF_L16, header, pitch);
+	const Box regions[] = { Box(7, 3, 31, 29), Box(0, 10, width, 20) };
+	for (size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); ++r)
+	{
+		const Box& region = regions[r];
+		vector<uint16>::type data(region.getWidth() * region.getHeight());
+		reader.readRegion(region, PixelBox(region.getWidth(), region.getHeight(), 1, PF_L16, &data[0]));
+		for (size_t y = 0; y < region.getHeight(); ++y)
+			for (size_t x = 0; x < region.getWidth(); ++x)
+				CPPUNIT_ASSERT_EQUAL(heightAt(region.left + x, region.top + y), data[y * region.getWidth() + x]);
+	}
+}
+
+void TiledImageTests::testTileCache()
+{
+	const size_t width = 256, height = 256, tileSize = 32;
+	const size_t tileBytes = tileSize * tileSize * 2;
+	TiledImage image(OGRE_NEW RawImageRegionReader(createRawHeightmap(width, height), 
+		width, height, PF_L16), tileSize, tileBytes * 6);
+
+	// A region 3x2 tiles in size, read twice, is only read from the stream once
+	Box region(32, 64, 128, 128);
+	vector<uint16>::type data(region.getWidth() * region.getHeight());
+	PixelBox dst(region.getWidth(), region.getHeight(), 1, PF_L16, &data[0]);
+	image.readRegion(region, dst);
+	CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumTileReads());
+	image.readRegion(region, dst);
+	CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumTileReads());
+	CPPUNIT_ASSERT_EQUAL((size_t)6, image.getNumCachedTiles());
+	CPPUNIT_ASSERT_EQUAL(tileBytes * 6, image.getCacheMemoryUsage());
+
+	// Reading the whole image never holds more than the cache size
+	vector<uint16>::type all(width * height);
+	image.readRegion(Box(0, 0, width, height), PixelBox(width, height, 1, PF_L16, &all[0]));
+	CPPUNIT_ASSERT(image.getCacheMemoryUsage() <= tileBytes * 6);
+	for (size_t y = 0; y < height; ++y)
+		for (size_t x = 0; x < width; ++x)
+			CPPUNIT_ASSERT_EQUAL(heightAt(x, y), all[y * width + x]);
+
+	// The tiles used last are the ones kept
+	size_t reads = image.getNumTileReads();
+	image.readRegion(Box(192, 224, 256, 256), PixelBox(64, 32, 1, PF_L16, &all[0]));
+	CPPUNIT_ASSERT_EQUAL(reads, image.getNumTileReads());
+	image.readRegion(Box(0, 0, 32, 32), PixelBox(32, 32, 1, PF_L16, &all[0]));
+	CPPUNIT_ASSERT_EQUAL(reads + 1, image.getNumTileReads());
+
+	image.setCacheSize(tileBytes * 2);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, image.getNumCachedTiles());
+	image.clearCache();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, image.getNumCachedTiles());
+	CPPUNIT_ASSERT_EQUAL((size_t)0, image.getCacheMemoryUsage());
+}
+
+void TiledImageTests::testLockedTilesKept()
+{
+	const size_t width = 128, height = 128, tileSize = 32;
+	TiledImage image(OGRE_NEW RawImageRegionReader(createRawHeightmap(width, height), 
+		width, height, PF_L16), tileSize, 0);
+
+	PixelBox a = image.lockTile(1, 2);
+	PixelBox b = image.lockTile(3, 0);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, image.getNumCachedTiles());
+	CPPUNIT_ASSERT_EQUAL(tileSize, a.getWidth());
+	CPPUNIT_ASSERT_EQUAL(tileSize, a.getHeight());
+	// Locking again doesn't read it again
+	PixelBox again = image.lockTile(1, 2);
+	CPPUNIT_ASSERT(again.data == a.data);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, image.getNumTileReads());
+	image.clearCache();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, image.getNumCachedTiles());
+
+	for (size_t y = 0; y < tileSize; ++y)
+	{
+		for (size_t x = 0; x < tileSize; ++x)
+		{
+			CPPUNIT_ASSERT_EQUAL(heightAt(x + 32, y + 64), static_cast<uint16*>(a.data)[y * tileSize + x]);
+			CPPUNIT_ASSERT_EQUAL(heightAt(x + 96, y), static_cast<uint16*>(b.data)[y * tileSize + x]);
+		}
+	}
+
+	image.unlockTile(3, 0);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, image.getNumCachedTiles());
+	image.unlockTile(1, 2);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, image.getNumCachedTiles());
+	image.unlockTile(1, 2);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, image.getNumCachedTiles());
+}
+
+void TiledImageTests::testDDSRegions()
+{
+	// The codec only writes power of two sizes
+	const size_t width = 128, height = 64;
+	const String fileName = "TiledImageTests.dds";
+	const PixelFormat formats[] = { PF_A8R8G8B8, PF_R8G8B8, PF_FLOAT32_R, PF_DXT1, PF_DXT5 };
+	for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); ++f)
+	{
+		uchar* data = OGRE_ALLOC_T(uchar, width * height * 4, MEMCATEGORY_GENERAL);
+		for (size_t i = 0; i < width * height * 4; ++i)
+			data[i] = static_cast<uchar>(i * 7 + i / 500);
+		Image source;
+		source.loadDynamicImage(data, width, height, 1, PF_BYTE_RGBA, true);
+		source.generateMipmaps();
+		source.convert(formats[f]);
+
+		// What the codec decodes it to in full
+		DataStreamPtr stream = saveAndOpenDDS(source, fileName);
+		Image full;
+		full.load(stream, "dds");
+		stream->close();
+
+		stream = saveAndOpenDDS(source, fileName);
+		ImageRegionReader* reader = TiledImage::createReader(stream, "dds");
+		CPPUNIT_ASSERT(!dynamic_cast<MemoryImageRegionReader*>(reader));
+		CPPUNIT_ASSERT_EQUAL(width, reader->getWidth());
+		CPPUNIT_ASSERT_EQUAL(height, reader->getHeight());
+		TiledImage tiled(reader, 32);
+
+		const Box regions[] = { Box(1, 2, 3, 5), Box(30, 17, 121, 63), Box(0, 0, width, height) };
+		for (size_t r = 0; r < sizeof(regions) / sizeof(regions[0]); ++r)
+		{
+			const Box& region = regions[r];
+			PixelBox expected(region.getWidth(), region.getHeight(), 1, PF_BYTE_RGBA);
+			vector<uchar>::type expectedData(expected.getConsecutiveSize());
+			expected.data = &expectedData[0];
+			PixelUtil::bulkPixelConversion(full.getPixelBox().getSubVolume(region), expected);
+
+			PixelBox actual(region.getWidth(), region.getHeight(), 1, PF_BYTE_RGBA);
+			vector<uchar>::type actualData(actual.getConsecutiveSize());
+			actual.data = &actualData[0];
+			tiled.readRegion(region, actual);
+			// The codec decodes DXT1 without alpha if the first block has none
+			if (formats[f] == PF_DXT1 && !PixelUtil::hasAlpha(full.getFormat()))
+			{
+				for (size_t i = 3; i < actualData.size(); i += 4)
+					actualData[i] = 255;
+			}
+			CPPUNIT_ASSERT(actualData == expectedData);
+		}
+		stream->close();
+	}
+	std::remove(fileName.c_str());
+}
+
+void TiledImageTests::testMemoryReader()
+{
+	const size_t width = 32, height = 16;
+	const String fileName = "TiledImageTests.dds";
+	uchar* data = OGRE_ALLOC_T(uchar, width * height * 4, MEMCATEGORY_GENERAL);
+	for (size_t i = 0; i < width * height * 4; ++i)
+		data[i] = static_cast<uchar>(i * 13);
+	Image source;
+	source.loadDynamicImage(data, width, height, 1, PF_BYTE_RGBA, true);
+	source.convert(PF_DXT5);
+
+	DataStreamPtr stream = saveAndOpenDDS(source, fileName);
+	MemoryImageRegionReader reader(stream, "dds");
+	stream->close();
+	std::remove(fileName.c_str());
+	CPPUNIT_ASSERT(PixelUtil::isAccessible(reader.getFormat()));
+
+	// The same as decompressing it ourselves
+	PixelBox expected(width, height, 1, PF_BYTE_RGBA);
+	vector<uchar>::type expectedData(expected.getConsecutiveSize());
+	expected.data = &expectedData[0];
+	PixelUtil::bulkPixelConversion(source.getPixelBox(), expected);
+
+	Box region(5, 3, 30, 14);
+	PixelBox actual(region.getWidth(), region.getHeight(), 1, PF_BYTE_RGBA);
+	vector<uchar>::type actualData(actual.getConsecutiveSize());
+	actual.data = &actualData[0];
+	reader.readRegion(region, actual);
+	for (size_t y = 0; y < region.getHeight(); ++y)
+		CPPUNIT_ASSERT(memcmp(&actualData[y * region.getWidth() * 4], 
+			&expectedData[((y + region.top) * width + region.left) * 4], region.getWidth() * 4) == 0);
+}
@@ -0,0 +1,402 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "WorkQueueTests.h"
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
+#include "Threading/OgreDefaultWorkQueue.h"
+
+// Register the suite
+CPPUNIT_TEST_SUITE_REGISTRATION( WorkQueueTests );
+
+/// Keep the CPU busy for a while, as an expensive handler would
+static void spin(unsigned long us)
+{
+	Timer timer;
+	while (timer.getMicroseconds() < us)
+	{
+	}
+}
+
+/// Get a percentile of a set of frame times
+static unsigned long percentile(vector<unsigned long>::type times, size_t percent)
+{
+	std::sort(times.begin(), times.end());
+	return times[std::min(times.size() - 1, times.size() * percent / 100)];
+}
+
+RecordingRequestHandler::RecordingRequestHandler()
+	: mNumResponses(0), mResponseCalls(0), mResponseSpinUS(0), mResponseSlices(1), mSleepMS(0)
+	, mActive(0), mMaxActive(0)
+{
+}
+WorkQueue::Response* RecordingRequestHandler::handleRequest(const WorkQueue::Request* req, 
+	const WorkQueue* srcQ)
+{
+	if (req->getAborted())
+	{
+		OGRE_LOCK_MUTEX(mMutex)
+		mAbortedHandled.push_back(any_cast<int>(req->getData()));
+		return OGRE_NEW WorkQueue::Response(req, true, Any());
+	}
+	{
+		OGRE_LOCK_MUTEX(mMutex)
+		mHandled.push_back(any_cast<int>(req->getData()));
+		mMaxActive = std::max(mMaxActive, ++mActive);
+	}
+	if (mSleepMS)
+	{
+		OGRE_THREAD_SLEEP(mSleepMS)
+	}
+	{
+		OGRE_LOCK_MUTEX(mMutex)
+		--mActive;
+	}
+	return OGRE_NEW WorkQueue::Response(req, true, Any());
+}
+void RecordingRequestHandler::handleResponse(const WorkQueue::Response* res, const WorkQueue* srcQ)
+{
+	if (res->getRequest()->getAborted())
+	{
+		mAbortedResponded.push_back(any_cast<int>(res->getRequest()->getData()));
+		return;
+	}
+	++mResponseCalls;
+	spin(mResponseSpinUS);
+
+	WorkQueue::RequestID id = res->getRequest()->getID();
+	if (++mSlicesDone[id] < mResponseSlices)
+	{
+		res->yield();
+		return;
+	}
+	mSlicesDone.erase(id);
+	mResponded.push_back(any_cast<int>(res->getRequest()->getData()));
+	++mNumResponses;
+}
+
+void WorkQueueTests::setUp()
+{
+	mRoot = OGRE_NEW Root(StringUtil::BLANK);
+	// Not started, so that tests can process requests one at a time
+	mQueue = OGRE_NEW DefaultWorkQueue("WorkQueueTests");
+	mQueue->setWorkersCanAccessRenderSystem(false);
+	mRoot->setWorkQueue(mQueue);
+
+	mChannel = mQueue->getChannel("Test");
+	mOtherChannel = mQueue->getChannel("Other");
+	mHeavyChannel = mQueue->getChannel("Heavy");
+	mQueue->addRequestHandler(mChannel, &mHandler);
+	mQueue->addRequestHandler(mOtherChannel, &mHandler);
+	mQueue->addResponseHandler(mChannel, &mHandler);
+	mQueue->addResponseHandler(mOtherChannel, &mHandler);
+}
+void WorkQueueTests::tearDown()
+{
+	mQueue->shutdown();
+	mQueue->removeRequestHandler(mChannel, &mHandler);
+	mQueue->removeRequestHandler(mOtherChannel, &mHandler);
+	mQueue->removeResponseHandler(mChannel, &mHandler);
+	mQueue->removeResponseHandler(mOtherChannel, &mHandler);
+	// Deletes the queue
+	OGRE_DELETE mRoot;
+}
+
+void WorkQueueTests::processAllRequests()
+{
+	while (mQueue->getChannelStatistics(mChannel).queueDepth ||
+		mQueue->getChannelStatistics(mOtherChannel).queueDepth ||
+		mQueue->getChannelStatistics(mHeavyChannel).queueDepth)
+	{
+		mQueue->_processNextRequest();
+	}
+}
+
+void WorkQueueTests::waitForProcessed(uint16 channel, size_t count)
+{
+	for (int i = 0; i < 5000; ++i)
+	{
+		if (mQueue->getChannelStatistics(channel).processedRequests >= count)
+			return;
+		OGRE_THREAD_SLEEP(1)
+	}
+	CPPUNIT_FAIL("Timed out waiting for requests to be processed");
+}
+
+void WorkQueueTests::testPriorityOrder()
+{
+	mQueue->addRequest(mChannel, 0, Any(1));
+	mQueue->addRequestWithPriority(mChannel, 0, Any(2), 10);
+	mQueue->addRequestWithPriority(mChannel, 0, Any(3), -5);
+	WorkQueue::RequestID id4 = mQueue->addRequest(mChannel, 0, Any(4));
+	// Priorities are compared across channels too
+	mQueue->addRequestWithPriority(mOtherChannel, 0, Any(5), 5);
+	CPPUNIT_ASSERT(mQueue->setRequestPriority(id4, 20));
+
+	processAllRequests();
+
+	CPPUNIT_ASSERT_EQUAL((size_t)5, mHandler.mHandled.size());
+	CPPUNIT_ASSERT_EQUAL(4, mHandler.mHandled[0]);
+	CPPUNIT_ASSERT_EQUAL(2, mHandler.mHandled[1]);
+	CPPUNIT_ASSERT_EQUAL(5, mHandler.mHandled[2]);
+	CPPUNIT_ASSERT_EQUAL(1, mHandler.mHandled[3]);
+	CPPUNIT_ASSERT_EQUAL(3, mHandler.mHandled[4]);
+
+	// Too late to change once processed
+	CPPUNIT_ASSERT(!mQueue->setRequestPriority(id4, 0));
+
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)5, mHandler.mNumResponses);
+}
+
+void WorkQueueTests::testAbortWaitingRequest()
+{
+	mQueue->addRequest(mChannel, 0, Any(1));
+	WorkQueue::RequestID id2 = mQueue->addRequest(mChannel, 0, Any(2));
+	mQueue->addRequest(mOtherChannel, 0, Any(3));
+	mQueue->abortRequest(id2);
+
+	// Aborted requests are still delivered, flagged, so handlers can clean up
+	processAllRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mHandler.mHandled.size());
+	CPPUNIT_ASSERT_EQUAL(1, mHandler.mHandled[0]);
+	CPPUNIT_ASSERT_EQUAL(3, mHandler.mHandled[1]);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mHandler.mAbortedHandled.size());
+	CPPUNIT_ASSERT_EQUAL(2, mHandler.mAbortedHandled[0]);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mHandler.mNumResponses);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mHandler.mAbortedResponded.size());
+	CPPUNIT_ASSERT_EQUAL(2, mHandler.mAbortedResponded[0]);
+
+	mQueue->addRequest(mChannel, 0, Any(4));
+	mQueue->addRequest(mOtherChannel, 0, Any(5));
+	mQueue->abortRequestsByChannel(mChannel);
+	processAllRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)3, mHandler.mHandled.size());
+	CPPUNIT_ASSERT_EQUAL(5, mHandler.mHandled[2]);
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mHandler.mAbortedHandled.size());
+	CPPUNIT_ASSERT_EQUAL(4, mHandler.mAbortedHandled[1]);
+
+	mQueue->addRequest(mChannel, 0, Any(6));
+	mQueue->addRequest(mOtherChannel, 0, Any(7));
+	mQueue->abortAllRequests();
+	processAllRequests();
+	CPPUNIT_ASSERT_EQUAL((size_t)3, mHandler.mHandled.size());
+	CPPUNIT_ASSERT_EQUAL((size_t)4, mHandler.mAbortedHandled.size());
+
+	// The response to 5 was still queued, so it was aborted too
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mHandler.mNumResponses);
+	CPPUNIT_ASSERT_EQUAL((size_t)5, mHandler.mAbortedResponded.size());
+	CPPUNIT_ASSERT(std::find(mHandler.mAbortedResponded.begin(), 
+		mHandler.mAbortedResponded.end(), 5) != mHandler.mAbortedResponded.end());
+}
+
+void WorkQueueTests::testStatistics()
+{
+	for (int i = 0; i < 3; ++i)
+		mQueue->addRequest(mChannel, 0, Any(i));
+	DefaultWorkQueueBase::ChannelStatistics stats = mQueue->getChannelStatistics(mChannel);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, stats.queueDepth);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, stats.processedRequests);
+
+	mHandler.mSleepMS = 2;
+	processAllRequests();
+	stats = mQueue->getChannelStatistics(mChannel);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, stats.queueDepth);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, stats.activeRequests);
+	CPPUNIT_ASSERT_EQUAL((size_t)3, stats.processedRequests);
+	// The times themselves depend on the machine
+	LogManager::getSingleton().stream() << "WorkQueueTests: 3 requests of 2ms, "
+		<< "service time max " << stats.maxServiceTime << "us total " << stats.totalServiceTime
+		<< "us, wait time max " << stats.maxWaitTime << "us total " << stats.totalWaitTime << "us";
+	CPPUNIT_ASSERT(stats.totalServiceTime >= stats.maxServiceTime);
+	CPPUNIT_ASSERT(stats.totalWaitTime >= stats.maxWaitTime);
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mQueue->getChannelStatistics(mOtherChannel).processedRequests);
+
+	mQueue->resetStatistics();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mQueue->getChannelStatistics(mChannel).processedRequests);
+}
+
+void WorkQueueTests::testChannelWorkerLimit()
+{
+	mQueue->setWorkerThreadCount(4);
+	mQueue->setChannelWorkerLimit(mChannel, 1);
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mQueue->getChannelWorkerLimit(mChannel));
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mQueue->getChannelWorkerLimit(mOtherChannel));
+	mHandler.mSleepMS = 5;
+	mQueue->startup();
+
+	for (int i = 0; i < 8; ++i)
+		mQueue->addRequest(mChannel, 0, Any(i));
+	waitForProcessed(mChannel, 8);
+	// Only one request from the channel was ever processed at a time
+	CPPUNIT_ASSERT_EQUAL((size_t)1, mHandler.mMaxActive);
+
+	// Other channels aren't held up by the limit
+	for (int i = 0; i < 8; ++i)
+		mQueue->addRequest(mChannel, 0, Any(i));
+	for (int i = 0; i < 8; ++i)
+		mQueue->addRequest(mOtherChannel, 0, Any(i));
+	waitForProcessed(mOtherChannel, 8);
+	waitForProcessed(mChannel, 16);
+}
+
+void WorkQueueTests::testResponsePriority()
+{
+	mQueue->addRequest(mChannel, 0, Any(1));
+	mQueue->addRequestWithPriority(mChannel, 0, Any(2), -1);
+	processAllRequests();
+	mQueue->addRequestWithPriority(mOtherChannel, 0, Any(3), 5);
+	mQueue->addRequest(mOtherChannel, 0, Any(4));
+	processAllRequests();
+
+	// Responses are handled in order of priority, not the order they arrived in
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)4, mHandler.mResponded.size());
+	CPPUNIT_ASSERT_EQUAL(3, mHandler.mResponded[0]);
+	CPPUNIT_ASSERT_EQUAL(1, mHandler.mResponded[1]);
+	CPPUNIT_ASSERT_EQUAL(4, mHandler.mResponded[2]);
+	CPPUNIT_ASSERT_EQUAL(2, mHandler.mResponded[3]);
+}
+
+void WorkQueueTests::testResponseYield()
+{
+	mHandler.mResponseSlices = 3;
+	mQueue->addRequest(mChannel, 0, Any(1));
+	mQueue->addRequest(mChannel, 0, Any(2));
+	processAllRequests();
+
+	// Each response is continued once per frame until the handler is done
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mHandler.mNumResponses);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)0, mHandler.mNumResponses);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)2, mHandler.mNumResponses);
+	CPPUNIT_ASSERT(mHandler.mSlicesDone.empty());
+
+	// A handler which is removed isn't called again
+	WorkQueue::RequestID id = mQueue->addRequest(mChannel, 0, Any(3));
+	processAllRequests();
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL(1, mHandler.mSlicesDone[id]);
+	mQueue->removeResponseHandler(mChannel, &mHandler);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL(1, mHandler.mSlicesDone[id]);
+}
+
+void WorkQueueTests::testChannelResponseTimeLimit()
+{
+	mQueue->setChannelResponseTimeLimit(mChannel, 1);
+	CPPUNIT_ASSERT_EQUAL(1UL, mQueue->getChannelResponseTimeLimit(mChannel));
+	CPPUNIT_ASSERT_EQUAL(0UL, mQueue->getChannelResponseTimeLimit(mOtherChannel));
+	mQueue->setResponseProcessingTimeLimit(0);
+	mHandler.mResponseSpinUS = 1500;
+
+	for (int i = 0; i < 3; ++i)
+		mQueue->addRequest(mChannel, 0, Any(i));
+	for (int i = 10; i < 13; ++i)
+		mQueue->addRequest(mOtherChannel, 0, Any(i));
+	processAllRequests();
+
+	// The limited channel gets one response a frame, the other isn't held up
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)4, mHandler.mNumResponses);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)5, mHandler.mNumResponses);
+	mQueue->processResponses();
+	CPPUNIT_ASSERT_EQUAL((size_t)6, mHandler.mNumResponses);
+}
+
+void WorkQueueTests::testResponseBudgetBenchmark()
+{
+	// Every fourth frame brings a response which takes 8ms, like a terrain 
+	// page upload, and every frame brings a few cheap ones
+	RecordingRequestHandler heavy;
+	mQueue->addRequestHandler(mHeavyChannel, &heavy);
+	mQueue->addResponseHandler(mHeavyChannel, &heavy);
+	mHandler.mResponseSpinUS = 200;
+	const size_t numFrames = 120, lightPerFrame = 5;
+	const unsigned long heavyUS = 8000;
+
+	vector<unsigned long>::type frameTimes[2];
+	size_t maxSlicesPerFrame[2] = { 0, 0 };
+	Timer timer;
+	for (int budgeted = 0; budgeted < 2; ++budgeted)
+	{
+		// Either all in one go, or in 1ms slices with 3ms of the frame for the channel
+		heavy.mResponseSlices = budgeted ? 8 : 1;
+		heavy.mResponseSpinUS = heavyUS / heavy.mResponseSlices;
+		heavy.mNumResponses = 0;
+		mHandler.mNumResponses = 0;
+		mQueue->setChannelResponseTimeLimit(mHeavyChannel, budgeted ? 3 : 0);
+
+		size_t numHeavy = 0;
+		for (size_t frame = 0; frame < numFrames || heavy.mNumResponses < numHeavy; ++frame)
+		{
+			if (frame < numFrames)
+			{
+				if (frame % 4 == 0)
+				{
+					mQueue->addRequest(mHeavyChannel, 0, Any((int)frame));
+					++numHeavy;
+				}
+				for (size_t i = 0; i < lightPerFrame; ++i)
+					mQueue->addRequest(mChannel, 0, Any((int)i));
+			}
+			processAllRequests();
+
+			size_t callsBefore = heavy.mResponseCalls;
+			timer.reset();
+			mQueue->processResponses();
+			frameTimes[budgeted].push_back(timer.getMicroseconds());
+			maxSlicesPerFrame[budgeted] = std::max(maxSlicesPerFrame[budgeted], 
+				heavy.mResponseCalls - callsBefore);
+		}
+		CPPUNIT_ASSERT_EQUAL(numFrames * lightPerFrame, mHandler.mNumResponses);
+		CPPUNIT_ASSERT_EQUAL(numHeavy, heavy.mNumResponses);
+	}
+
+	mQueue->removeRequestHandler(mHeavyChannel, &heavy);
+	mQueue->removeResponseHandler(mHeavyChannel, &heavy);
+
+	for (int budgeted = 0; budgeted < 2; ++budgeted)
+	{
+		LogManager::getSingleton().stream() << "WorkQueueTests: response time per frame "
+			<< (budgeted ? "with a channel budget and yielding" : "without budgets") 
+			<< ": p50 " << percentile(frameTimes[budgeted], 50) 
+			<< "us, p95 " << percentile(frameTimes[budgeted], 95)
+			<< "us, p99 " << percentile(frameTimes[budgeted], 99)
+			<< "us, max " << percentile(frameTimes[budgeted], 100) << "us";
+	}
+	// Each slice takes at least 1ms, so the 3ms budget stops the channel after
+	// at most 3 of them in a frame, however slow the machine is
+	CPPUNIT_ASSERT(maxSlicesPerFrame[1] >= 1);
+	CPPUNIT_ASSERT(maxSlicesPerFrame[1] <= 3);
+}
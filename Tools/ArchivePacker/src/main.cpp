@@ -0,0 +1,114 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2009 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "Ogre.h"
+#include "OgreFileSystem.h"
+#include "OgrePackArchive.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace Ogre;
+
+void help(void)
+{
+	// Print help message
+	cout << endl << "OgreArchivePacker: Builds .pack files from folders." << endl << endl;
+	cout << "Usage: OgreArchivePacker [-b blocksize] [-l level] destfile sourcedir [sourcedir...]" << endl;
+	cout << "-b blocksize   = Uncompressed size of each block in KB (default 64)" << endl;
+	cout << "-l level       = zlib compression level, 0 (store) to 9 (default 6)" << endl;
+	cout << "destfile       = name of the .pack file to write" << endl;
+	cout << "sourcedir      = folder to pack, including all sub-folders. Files" << endl;
+	cout << "                 are named relative to the folder they came from." << endl;
+
+	cout << endl;
+}
+
+int main(int numargs, char** args)
+{
+	if (numargs < 3)
+	{
+		help();
+		return -1;
+	}
+
+	int retCode = 0;
+	LogManager* logMgr = new LogManager();
+	logMgr->createLog("OgreArchivePacker.log", true, false);
+
+	Ogre::vector<Archive*>::type sources;
+	try 
+	{
+		UnaryOptionList unOptList;
+		BinaryOptionList binOptList;
+
+		binOptList["-b"] = "64";
+		binOptList["-l"] = "6";
+
+		int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
+		if (numargs - startIdx < 2)
+		{
+			help();
+			delete logMgr;
+			return -1;
+		}
+
+		uint32 blockSize = StringConverter::parseUnsignedInt(binOptList["-b"]) * 1024;
+		int level = StringConverter::parseInt(binOptList["-l"]);
+		PackArchiveWriter writer(blockSize, level);
+
+		String dest(args[startIdx]);
+		for (int i = startIdx + 1; i < numargs; ++i)
+		{
+			Archive* arch = new FileSystemArchive(args[i], "FileSystem");
+			sources.push_back(arch);
+			arch->load();
+			size_t numFiles = writer.addArchive(arch);
+			cout << "Adding " << numFiles << " files from " << args[i] << endl;
+		}
+
+		cout << "Writing " << dest << "..." << endl;
+		uint64 packedSize = writer.write(dest);
+		cout << "Packed " << writer.getNumFiles() << " files, " << 
+			packedSize << " bytes of data." << endl;
+	}
+	catch (Exception& e)
+	{
+		cout << "Exception caught: " << e.getDescription() << endl;
+		retCode = 1;
+	}
+
+	for (Ogre::vector<Archive*>::type::iterator i = sources.begin(); i != sources.end(); ++i)
+		delete *i;
+	delete logMgr;
+
+	return retCode;
+
+}
+
@@ -64,7 +64,11 @@ void help(void)
 	cout << "-srcgl     = Interpret ambiguous colours as GL style" << endl;
 	cout << "-E endian  = Set endian mode 'big' 'little' or 'native' (default)" << endl;
 	cout << "-b         = Recalculate bounding box (static meshes only)" << endl;
-    cout << "sourcefile = name of file to convert" << endl;
+	cout << "-pa        = Pack animation tracks (skeletons only)" << endl;
+	cout << "-pt dist   = Translation tolerance when packing (default 0.001)" << endl;
+	cout << "-pr angle  = Rotation tolerance when packing, degrees (default 0.05)" << endl;
+	cout << "-ps scale  = Scale tolerance when packing (default 0.001)" << endl;
+    cout << "sourcefile = name of .mesh or .skeleton file to convert" << endl;
     cout << "destfile   = optional name of file to write to. If you don't" << endl;
     cout << "             specify this OGRE overwrites the existing file." << endl;
 
@@ -92,6 +96,10 @@ struct UpgradeOptions
 	bool usePercent;
 	Serializer::Endian endian;
 	bool recalcBounds;
+	bool packAnimations;
+	Real packTranslationTolerance;
+	Real packRotationTolerance;
+	Real packScaleTolerance;
 
 };
 
@@ -131,6 +139,10 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 	opts.numLods = 0;
 	opts.usePercent = true;
 	opts.recalcBounds = false;
+	opts.packAnimations = false;
+	opts.packTranslationTolerance = 0.001f;
+	opts.packRotationTolerance = 0.05f;
+	opts.packScaleTolerance = 0.001f;
 
 
 	UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -175,6 +187,8 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 	{
 		opts.recalcBounds = true;
 	}
+	ui = unOpts.find("-pa");
+	opts.packAnimations = ui->second;
 
 
 	BinaryOptionList::iterator bi = binOpts.find("-l");
@@ -228,6 +242,21 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
 		if (bi->second == "4")
 			opts.tangentUseParity = true;
 	}
+	bi = binOpts.find("-pt");
+	if (!bi->second.empty())
+	{
+		opts.packTranslationTolerance = StringConverter::parseReal(bi->second);
+	}
+	bi = binOpts.find("-pr");
+	if (!bi->second.empty())
+	{
+		opts.packRotationTolerance = StringConverter::parseReal(bi->second);
+	}
+	bi = binOpts.find("-ps");
+	if (!bi->second.empty())
+	{
+		opts.packScaleTolerance = StringConverter::parseReal(bi->second);
+	}
 }
 
 String describeSemantic(VertexElementSemantic sem)
@@ -886,6 +915,101 @@ void recalcBounds(Mesh* mesh)
 	mesh->_setBoundingSphereRadius(radius);
 }
 
+void upgradeMesh(DataStreamPtr& stream, const String& dest)
+{
+	Mesh mesh(meshMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+	meshSerializer->importMesh(stream, &mesh);
+
+	String response;
+
+	vertexBufferReorg(mesh);
+
+	// Deal with VET_COLOUR ambiguities
+	resolveColourAmbiguities(&mesh);
+	
+	buildLod(&mesh);
+
+	// Make sure we generate edge lists, provided they are not deliberately disabled
+	if (!opts.suppressEdgeLists)
+	{
+		cout << "\nGenerating edge lists.." << std::endl;
+		mesh.buildEdgeList();
+	}
+	else
+	{
+		mesh.freeEdgeList();
+	}
+
+	// Generate tangents?
+	if (opts.generateTangents)
+	{
+		unsigned short srcTex, destTex;
+		bool existing = mesh.suggestTangentVectorBuildParams(opts.tangentSemantic, srcTex, destTex);
+		if (existing)
+		{
+			if (opts.interactive)
+			{
+				std::cout << "\nThis mesh appears to already have a set of tangents, " <<
+					"which would suggest tangent vectors have already been calculated. Do you really " <<
+					"want to generate new tangent vectors (may duplicate)? (y/n)";
+				while (response == "")
+				{
+					cin >> response;
+					StringUtil::toLowerCase(response);
+					if (response == "y")
+					{
+						// Do nothing
+					}
+					else if (response == "n")
+					{
+						opts.generateTangents = false;
+					}
+					else
+					{
+						response = "";
+					}
+				}
+			}
+			else
+			{
+				// safe
+				opts.generateTangents = false;
+			}
+
+		}
+		if (opts.generateTangents)
+		{
+			cout << "Generating tangent vectors...." << std::endl;
+			mesh.buildTangentVectors(opts.tangentSemantic, srcTex, destTex, 
+				opts.tangentSplitMirrored, opts.tangentSplitRotated, 
+				opts.tangentUseParity);
+		}
+	}
+
+
+	if (opts.recalcBounds)
+		recalcBounds(&mesh);
+
+	meshSerializer->exportMesh(&mesh, dest, opts.endian);
+}
+
+void upgradeSkeleton(DataStreamPtr& stream, const String& dest)
+{
+	Skeleton skel(skelMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
+
+	skeletonSerializer->importSkeleton(stream, &skel);
+
+	if (opts.packAnimations)
+	{
+		cout << "\nPacking animations.." << std::endl;
+		skel.packAllAnimations(opts.packTranslationTolerance, 
+			Degree(opts.packRotationTolerance), opts.packScaleTolerance);
+	}
+
+	skeletonSerializer->exportSkeleton(&skel, dest, opts.endian);
+}
+
 int main(int numargs, char** args)
 {
     if (numargs < 2)
@@ -927,6 +1051,7 @@ int main(int numargs, char** args)
 		unOptList["-srcgl"] = false;
 		unOptList["-srcd3d"] = false;
 		unOptList["-b"] = false;
+		unOptList["-pa"] = false;
 		binOptList["-l"] = "";
 		binOptList["-d"] = "";
 		binOptList["-p"] = "";
@@ -934,6 +1059,9 @@ int main(int numargs, char** args)
 		binOptList["-E"] = "";
 		binOptList["-td"] = "";
 		binOptList["-ts"] = "";
+		binOptList["-pt"] = "";
+		binOptList["-pr"] = "";
+		binOptList["-ps"] = "";
 
 		int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
 		parseOpts(unOptList, binOptList);
@@ -941,7 +1069,7 @@ int main(int numargs, char** args)
 		String source(args[startIdx]);
 
 
-		// Load the mesh
+		// Load the file
 		struct stat tagStat;
 
 		FILE* pFile = fopen( source.c_str(), "rb" );
@@ -955,12 +1083,9 @@ int main(int numargs, char** args)
 		fread( (void*)memstream->getPtr(), tagStat.st_size, 1, pFile );
 		fclose( pFile );
 
-		Mesh mesh(meshMgr, "conversion", 0, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME);
-
 		DataStreamPtr stream(memstream);
-		meshSerializer->importMesh(stream, &mesh);
 
-		// Write out the converted mesh
+		// Write out the converted file
 		String dest;
 		if (numargs == startIdx + 2)
 		{
@@ -971,77 +1096,14 @@ int main(int numargs, char** args)
 			dest = source;
 		}
 
-		String response;
-
-		vertexBufferReorg(mesh);
-
-		// Deal with VET_COLOUR ambiguities
-		resolveColourAmbiguities(&mesh);
-		
-		buildLod(&mesh);
-
-		// Make sure we generate edge lists, provided they are not deliberately disabled
-		if (!opts.suppressEdgeLists)
+		if (StringUtil::endsWith(source, ".skeleton"))
 		{
-			cout << "\nGenerating edge lists.." << std::endl;
-			mesh.buildEdgeList();
+			upgradeSkeleton(stream, dest);
 		}
 		else
 		{
-			mesh.freeEdgeList();
+			upgradeMesh(stream, dest);
 		}
-
-		// Generate tangents?
-		if (opts.generateTangents)
-		{
-			unsigned short srcTex, destTex;
-			bool existing = mesh.suggestTangentVectorBuildParams(opts.tangentSemantic, srcTex, destTex);
-			if (existing)
-			{
-				if (opts.interactive)
-				{
-					std::cout << "\nThis mesh appears to already have a set of tangents, " <<
-						"which would suggest tangent vectors have already been calculated. Do you really " <<
-						"want to generate new tangent vectors (may duplicate)? (y/n)";
-					while (response == "")
-					{
-						cin >> response;
-						StringUtil::toLowerCase(response);
-						if (response == "y")
-						{
-							// Do nothing
-						}
-						else if (response == "n")
-						{
-							opts.generateTangents = false;
-						}
-						else
-						{
-							response = "";
-						}
-					}
-				}
-				else
-				{
-					// safe
-					opts.generateTangents = false;
-				}
-
-			}
-			if (opts.generateTangents)
-			{
-				cout << "Generating tangent vectors...." << std::endl;
-				mesh.buildTangentVectors(opts.tangentSemantic, srcTex, destTex, 
-					opts.tangentSplitMirrored, opts.tangentSplitRotated, 
-					opts.tangentUseParity);
-			}
-		}
-
-
-		if (opts.recalcBounds)
-			recalcBounds(&mesh);
-
-		meshSerializer->exportMesh(&mesh, dest, opts.endian);
     
 	}
 	catch (Exception& e)
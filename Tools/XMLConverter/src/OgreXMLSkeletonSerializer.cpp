@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgreAnimation.h"
 #include "OgreAnimationTrack.h"
 #include "OgreKeyFrame.h"
+#include "OgrePackedTransformTrack.h"
 #include "OgreBone.h"
 #include "OgreString.h"
 #include "OgreLogManager.h"
@@ -558,9 +559,28 @@ namespace Ogre {
         // Write all keyframes
         TiXmlElement* keysNode = 
             trackNode->InsertEndChild(TiXmlElement("keyframes"))->ToElement();
-        for (unsigned short i = 0; i < track->getNumKeyFrames(); ++i)
+        if (track->isPacked())
         {
-            writeKeyFrame(keysNode, track->getNodeKeyFrame(i));
+            // Packed tracks have no keyframes, so write out the ones which 
+            // reproduce the packed keys
+            const PackedTransformTrack* packed = track->getPackedData();
+            const Animation* anim = track->getParent();
+            vector<Real>::type times;
+            packed->getKeyTimes(times);
+            for (vector<Real>::type::iterator t = times.begin(); t != times.end(); ++t)
+            {
+                TransformKeyFrame key(0, *t);
+                packed->sample(*t, anim->getLength(), 
+                    anim->getRotationInterpolationMode(), &key);
+                writeKeyFrame(keysNode, &key);
+            }
+        }
+        else
+        {
+            for (unsigned short i = 0; i < track->getNumKeyFrames(); ++i)
+            {
+                writeKeyFrame(keysNode, track->getNodeKeyFrame(i));
+            }
         }
     }
     //---------------------------------------------------------------------